@@ -35,7 +35,10 @@
 // STL headers
 // std headers
 #include <atomic>
+#include <map>
+#include <mutex>
 #include <stdexcept>
+#include <vector>
 // external library headers
 #include <boost/bind.hpp>
 #include <boost/fiber/fiber.hpp>
@@ -61,6 +64,168 @@
 #include <excpt.h>
 #endif
 
+namespace
+{
+
+/**
+ * Process-wide pool of guarded coroutine stacks, one free list per
+ * power-of-two size class. A coroutine may terminate on whichever thread
+ * runs its fiber, so the pool is shared under a mutex. It is never
+ * destroyed: detached fibers can still be handing back stacks during static
+ * destruction.
+ *
+ * A recycled stack keeps whatever pages its last coroutine touched, which is
+ * the point -- the next coroutine doesn't fault them in again -- but it's
+ * also why the idle total is capped.
+ */
+class StackPool
+{
+public:
+    static const size_t MIN_SIZE_CLASS = 64 * 1024;
+    static const size_t DEFAULT_LIMIT = 32 * 1024 * 1024;
+
+    static StackPool& instance()
+    {
+        static StackPool* sInstance = new StackPool;
+        return *sInstance;
+    }
+
+    static size_t sizeClass(size_t size)
+    {
+        size_t size_class = MIN_SIZE_CLASS;
+        while (size_class < size)
+        {
+            size_class <<= 1;
+        }
+        return size_class;
+    }
+
+    boost::context::stack_context allocate(size_t size_class)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            auto found = mIdle.find(size_class);
+            if (found != mIdle.end() && ! found->second.empty())
+            {
+                boost::context::stack_context sctx = found->second.back();
+                found->second.pop_back();
+                --mStats.mPooled;
+                mStats.mPooledBytes -= size_class;
+                ++mStats.mReused;
+                addLive();
+                return sctx;
+            }
+            ++mStats.mAllocated;
+            addLive();
+        }
+        try
+        {
+            // protected_fixedsize_stack puts a guard page past the end of
+            // the stack so that overflow faults instead of stomping memory.
+            return boost::fibers::protected_fixedsize_stack(size_class).allocate();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            --mStats.mAllocated;
+            --mStats.mLive;
+            throw;
+        }
+    }
+
+    void release(boost::context::stack_context& sctx, size_t size_class)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            --mStats.mLive;
+            if (mStats.mPooledBytes + size_class <= mLimit)
+            {
+                mIdle[size_class].push_back(sctx);
+                ++mStats.mPooled;
+                mStats.mPooledBytes += size_class;
+                return;
+            }
+        }
+        boost::fibers::protected_fixedsize_stack(size_class).deallocate(sctx);
+    }
+
+    void setLimit(size_t bytes)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mLimit = bytes;
+        }
+        trim(bytes);
+    }
+
+    // release idle stacks until no more than 'keep' bytes remain
+    void trim(size_t keep)
+    {
+        std::vector<std::pair<boost::context::stack_context, size_t>> doomed;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            // mIdle is keyed by stack size: walking it backwards gets under
+            // 'keep' while unmapping as few stacks as possible
+            for (auto it = mIdle.rbegin(); it != mIdle.rend() && mStats.mPooledBytes > keep; ++it)
+            {
+                while (! it->second.empty() && mStats.mPooledBytes > keep)
+                {
+                    doomed.emplace_back(it->second.back(), it->first);
+                    it->second.pop_back();
+                    --mStats.mPooled;
+                    mStats.mPooledBytes -= it->first;
+                }
+            }
+        }
+        for (auto& pair : doomed)
+        {
+            boost::fibers::protected_fixedsize_stack(pair.second).deallocate(pair.first);
+        }
+    }
+
+    LLCoros::StackStats getStats()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStats;
+    }
+
+private:
+    void addLive()
+    {
+        mStats.mPeak = llmax(mStats.mPeak, ++mStats.mLive);
+    }
+
+    std::mutex mMutex;
+    std::map<size_t, std::vector<boost::context::stack_context>> mIdle;
+    LLCoros::StackStats mStats;
+    size_t mLimit{ DEFAULT_LIMIT };
+};
+
+// StackAllocator handed to each fiber. The fiber keeps a copy and calls
+// deallocate() on it when the coroutine ends.
+class PooledStackAllocator
+{
+public:
+    PooledStackAllocator(size_t size):
+        mSizeClass(StackPool::sizeClass(size))
+    {}
+
+    boost::context::stack_context allocate()
+    {
+        return StackPool::instance().allocate(mSizeClass);
+    }
+
+    void deallocate(boost::context::stack_context& sctx)
+    {
+        StackPool::instance().release(sctx, mSizeClass);
+    }
+
+private:
+    size_t mSizeClass;
+};
+
+} // anonymous namespace
+
 // static
 bool LLCoros::on_main_coro()
 {
@@ -250,10 +415,33 @@ void LLCoros::setStackSize(S32 stacksize)
     mStackSize = stacksize;
 }
 
+// static
+LLCoros::StackStats LLCoros::getStackStats()
+{
+    return StackPool::instance().getStats();
+}
+
+// static
+void LLCoros::setStackPoolLimit(size_t bytes)
+{
+    StackPool::instance().setLimit(bytes);
+}
+
+// static
+void LLCoros::trimStackPool()
+{
+    StackPool::instance().trim(0);
+}
+
 void LLCoros::printActiveCoroutines(const std::string& when)
 {
     LL_INFOS("LLCoros") << "Number of active coroutines " << when
                         << ": " << CoroData::instanceCount() << LL_ENDL;
+    StackStats stacks(getStackStats());
+    LL_INFOS("LLCoros") << "Coroutine stacks: " << stacks.mLive << " live, "
+                        << stacks.mPooled << " pooled (" << stacks.mPooledBytes << " bytes), peak "
+                        << stacks.mPeak << ", " << stacks.mReused << " reused, "
+                        << stacks.mAllocated << " allocated" << LL_ENDL;
     if (CoroData::instanceCount() > 0)
     {
         LL_INFOS("LLCoros") << "-------------- List of active coroutines ------------";
@@ -276,15 +464,14 @@ std::string LLCoros::launch(const std::string& prefix, const callable_t& callabl
     // when the fiber yields for whatever reason.
     // std::allocator_arg is a flag to indicate that the following argument is
     // a StackAllocator.
-    // protected_fixedsize_stack sets a guard page past the end of the new
-    // stack so that stack underflow will result in an access violation
-    // instead of weird, subtle, possibly undiagnosed memory stomps.
+    // PooledStackAllocator reuses a guarded stack left by an earlier
+    // coroutine when one of the right size class is idle (see StackPool).
 
     try
     {
         boost::fibers::fiber newCoro(boost::fibers::launch::dispatch,
             std::allocator_arg,
-            boost::fibers::protected_fixedsize_stack(mStackSize),
+            PooledStackAllocator(mStackSize),
             [this, &name, &callable]() { toplevel(name, callable); });
 
         // You have two choices with a fiber instance: you can join() it or you
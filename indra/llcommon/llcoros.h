@@ -197,6 +197,35 @@ public:
      */
     void setStackSize(S32 stacksize);
 
+    /**
+     * Coroutine stacks come from a process-wide pool. Each requested size is
+     * rounded up to a power-of-two size class, and each stack has a guard
+     * page below it. A terminated coroutine's stack goes back to the pool
+     * for the next launch() in that class instead of being unmapped, up to
+     * setStackPoolLimit() bytes of idle stacks across all classes.
+     */
+    struct StackStats
+    {
+        // fibers launched and not yet finished, each on its own stack
+        size_t mLive{ 0 };
+        // stacks of finished coroutines kept for the next launch(), and
+        // their total size, bounded by setStackPoolLimit()
+        size_t mPooled{ 0 };
+        size_t mPooledBytes{ 0 };
+        // most coroutines ever running at once
+        size_t mPeak{ 0 };
+        // launches that took a pooled stack, and those that had to map a
+        // new guarded stack
+        U64 mReused{ 0 };
+        U64 mAllocated{ 0 };
+    };
+    static StackStats getStackStats();
+
+    /// cap on bytes of idle stacks kept for reuse (0 disables pooling)
+    static void setStackPoolLimit(size_t bytes);
+    /// release all idle stacks
+    static void trimStackPool();
+
     /// diagnostic
     void printActiveCoroutines(const std::string& when=std::string());
 
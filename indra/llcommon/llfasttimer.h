@@ -29,6 +29,7 @@
 
 #include "llinstancetracker.h"
 #include "lltrace.h"
+#include "lltracecapture.h"
 #include "lltreeiterators.h"
 
 #if LL_WINDOWS
@@ -330,6 +331,11 @@ LL_FORCE_INLINE BlockTimer::~BlockTimer()
     accumulator.mSelfTimeCounter += total_time - cur_timer_data->mChildTime;
     accumulator.mActiveCount--;
 
+    if (TraceCapture::isRecording())
+    {
+        TraceCapture::record(cur_timer_data->mTimeBlock->getName().c_str(), mStartTime, total_time);
+    }
+
     // store last caller to bootstrap tree creation
     // do this in the destructor in case of recursion to get topmost caller
     accumulator.mLastCaller = mParentTimerData.mTimeBlock;
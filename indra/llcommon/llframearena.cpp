@@ -0,0 +1,160 @@
+/**
+ * @file   llframearena.cpp
+ * @date   2026-10-18
+ * @brief  Implementation for llframearena.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llframearena.h"
+// STL headers
+// std headers
+#include <cstring>
+// external library headers
+// other Linden headers
+
+LLFrameArena gFrameArena;
+
+namespace
+{
+    const U8 FRESH_FILL = 0xCD;
+    const U8 RELEASED_FILL = 0xDD;
+    // consolidated blocks are rounded up to this
+    const size_t BLOCK_GRANULE = 64 * 1024;
+
+    // Block sizes are kept to whole MAX_ALIGNMENT units, so that every
+    // block also ends aligned.
+    size_t round_block(size_t size)
+    {
+        const size_t granule = LLFrameArena::MAX_ALIGNMENT;
+        return (size + granule - 1) / granule * granule;
+    }
+}
+
+LLFrameArena::LLFrameArena(size_t block_size):
+    mCurrent(0),
+    mTop(NULL),
+    mEnd(NULL),
+    mSpilled(0),
+    mBlockSize(block_size),
+    mLastFrameBytes(0),
+    mHighWater(0),
+    mAllocations(0),
+    mOverflows(0),
+    mPoison(LL_FRAME_ARENA_POISON)
+{
+}
+
+LLFrameArena::~LLFrameArena()
+{
+    for (const Block& block : mBlocks)
+    {
+        ll_aligned_free<MAX_ALIGNMENT>(block.mBase);
+    }
+}
+
+void* LLFrameArena::allocateSlow(size_t size, size_t alignment)
+{
+    // Blocks are MAX_ALIGNMENT aligned, so a fresh one needs no padding.
+    const size_t wanted = round_block(llmax(mBlockSize, size));
+    if (mBlocks.empty())
+    {
+        // first use: blocks are only allocated on demand
+        mBlocks.push_back({ (char*)ll_aligned_malloc<MAX_ALIGNMENT>(wanted), wanted });
+    }
+    else
+    {
+        if (! mCurrent)
+        {
+            ++mOverflows;
+        }
+        mSpilled += mTop - mBlocks[mCurrent].mBase;
+        mBlocks.push_back({ (char*)ll_aligned_malloc<MAX_ALIGNMENT>(wanted), wanted });
+    }
+    useBlock(mBlocks.size() - 1);
+    return allocate(size, alignment);
+}
+
+void LLFrameArena::useBlock(size_t index)
+{
+    mCurrent = index;
+    mTop = mBlocks[index].mBase;
+    mEnd = mTop + mBlocks[index].mSize;
+}
+
+void LLFrameArena::poisonAllocation(char* ptr, size_t size)
+{
+    memset(ptr, FRESH_FILL, size);
+}
+
+size_t LLFrameArena::getBytesUsed() const
+{
+    return mBlocks.empty()? 0 : mSpilled + (mTop - mBlocks[mCurrent].mBase);
+}
+
+size_t LLFrameArena::getCapacity() const
+{
+    size_t capacity = 0;
+    for (const Block& block : mBlocks)
+    {
+        capacity += block.mSize;
+    }
+    return capacity;
+}
+
+void LLFrameArena::reset()
+{
+    if (mBlocks.empty())
+    {
+        return;
+    }
+
+    mLastFrameBytes = getBytesUsed();
+    mHighWater = llmax(mHighWater, mLastFrameBytes);
+    mAllocations = 0;
+
+    if (mCurrent)
+    {
+        // This frame spilled into extra blocks: swap them all for a single
+        // block that would have held it.
+        const size_t wanted = round_block(llmax(mBlockSize,
+                                                (mHighWater + BLOCK_GRANULE - 1) / BLOCK_GRANULE * BLOCK_GRANULE));
+        LL_INFOS("FrameArena") << "Frame arena used " << mLastFrameBytes << " bytes in "
+                               << mBlocks.size() << " blocks, growing to " << wanted << LL_ENDL;
+        for (const Block& block : mBlocks)
+        {
+            ll_aligned_free<MAX_ALIGNMENT>(block.mBase);
+        }
+        mBlocks.clear();
+        mBlocks.push_back({ (char*)ll_aligned_malloc<MAX_ALIGNMENT>(wanted), wanted });
+    }
+    else if (mPoison)
+    {
+        char* base = mBlocks[0].mBase;
+        memset(base, RELEASED_FILL, mTop - base);
+    }
+    mSpilled = 0;
+    useBlock(0);
+}
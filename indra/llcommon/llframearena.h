@@ -0,0 +1,185 @@
+/**
+ * @file   llframearena.h
+ * @date   2026-10-18
+ * @brief  Bump allocator for temporaries that live no longer than a frame.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFRAMEARENA_H
+#define LL_LLFRAMEARENA_H
+
+#include "llmemory.h"
+#include <vector>
+
+#if ! defined(LL_FRAME_ARENA_POISON)
+#if LL_DEBUG
+#define LL_FRAME_ARENA_POISON 1
+#else
+#define LL_FRAME_ARENA_POISON 0
+#endif
+#endif
+
+/**
+ * LLFrameArena hands out memory by bumping a pointer through a block, and
+ * takes it all back at once in reset(). Nothing is freed individually, so
+ * per-frame scratch containers cost neither heap locks nor fragmentation.
+ *
+ * When a frame needs more than the block holds, further blocks are chained
+ * on; the next reset() replaces them all with a single block big enough for
+ * the high-water mark, so a steady workload settles into one block.
+ *
+ * An arena is not thread safe. gFrameArena belongs to the main thread and is
+ * reset by LLAppViewer::frame() once per frame: anything allocated from it
+ * must be gone by then. With poisoning on (LL_FRAME_ARENA_POISON, by default
+ * in debug builds, or setPoison(true)), new allocations are filled with 0xCD and reset() fills
+ * everything handed out with 0xDD, so a container that outlives its frame
+ * shows up quickly.
+ */
+class LL_COMMON_API LLFrameArena
+{
+public:
+    static const size_t MAX_ALIGNMENT = 64;
+
+    LLFrameArena(size_t block_size = 1024 * 1024);
+    ~LLFrameArena();
+
+    LLFrameArena(const LLFrameArena&) = delete;
+    LLFrameArena& operator=(const LLFrameArena&) = delete;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t))
+    {
+        llassert(alignment && alignment <= MAX_ALIGNMENT && ! (alignment & (alignment - 1)));
+        char* ptr = (char*)(((uintptr_t)mTop + alignment - 1) & ~(uintptr_t)(alignment - 1));
+        // ptr can round up past mEnd when the block is full
+        if (! mTop || ptr > mEnd || size > size_t(mEnd - ptr))
+        {
+            return allocateSlow(size, alignment);
+        }
+        mTop = ptr + size;
+        ++mAllocations;
+        if (mPoison)
+        {
+            poisonAllocation(ptr, size);
+        }
+        return ptr;
+    }
+
+    // Memory only comes back in reset(), except that releasing the most
+    // recent allocation rewinds over it: a growing vector's old buffer is
+    // usually just below its new one, not on top, but a shrinking or
+    // short-lived one at the top is reclaimed.
+    void deallocate(void* ptr, size_t size)
+    {
+        if ((char*)ptr + size == mTop)
+        {
+            mTop = (char*)ptr;
+        }
+    }
+
+    // Reclaim everything allocated since the last reset().
+    void reset();
+
+    void setPoison(bool poison) { mPoison = poison; }
+
+    // bytes handed out since the last reset(), including alignment padding
+    size_t getBytesUsed() const;
+    // bytes used in the frame before the last reset()
+    size_t getLastFrameBytes() const { return mLastFrameBytes; }
+    // most bytes used in any one frame
+    size_t getHighWater() const { return mHighWater; }
+    // bytes reserved in blocks
+    size_t getCapacity() const;
+    // allocations since the last reset()
+    size_t getAllocationCount() const { return mAllocations; }
+    // frames that needed more than one block
+    U32 getOverflowCount() const { return mOverflows; }
+
+private:
+    struct Block
+    {
+        char* mBase;
+        size_t mSize;
+    };
+
+    void* allocateSlow(size_t size, size_t alignment);
+    void useBlock(size_t index);
+    void poisonAllocation(char* ptr, size_t size);
+
+    std::vector<Block> mBlocks;
+    size_t mCurrent;
+    char* mTop;
+    char* mEnd;
+    // bytes used in blocks before mCurrent
+    size_t mSpilled;
+    size_t mBlockSize;
+    size_t mLastFrameBytes;
+    size_t mHighWater;
+    size_t mAllocations;
+    U32 mOverflows;
+    bool mPoison;
+};
+
+extern LL_COMMON_API LLFrameArena gFrameArena;
+
+/**
+ * STL allocator drawing from an LLFrameArena (by default gFrameArena).
+ */
+template <typename T>
+class LLFrameAllocator
+{
+public:
+    typedef T value_type;
+
+    LLFrameAllocator(LLFrameArena& arena = gFrameArena) noexcept:
+        mArena(&arena)
+    {}
+    template <typename U>
+    LLFrameAllocator(const LLFrameAllocator<U>& other) noexcept:
+        mArena(other.mArena)
+    {}
+
+    T* allocate(size_t count)
+    {
+        static_assert(alignof(T) <= LLFrameArena::MAX_ALIGNMENT, "over-aligned type");
+        return static_cast<T*>(mArena->allocate(count * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* ptr, size_t count) noexcept
+    {
+        mArena->deallocate(ptr, count * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const LLFrameAllocator<U>& other) const { return mArena == other.mArena; }
+    template <typename U>
+    bool operator!=(const LLFrameAllocator<U>& other) const { return mArena != other.mArena; }
+
+private:
+    template <typename U> friend class LLFrameAllocator;
+    LLFrameArena* mArena;
+};
+
+/// scratch vector for use within a single frame
+template <typename T>
+using LLFrameVector = std::vector<T, LLFrameAllocator<T>>;
+
+#endif /* ! defined(LL_LLFRAMEARENA_H) */
@@ -0,0 +1,422 @@
+/**
+ * @file   lllockfreequeue.h
+ * @date   2026-10-18
+ * @brief  LLThreadSafeQueue work-alike built on moodycamel::ConcurrentQueue
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLLOCKFREEQUEUE_H
+#define LL_LLLOCKFREEQUEUE_H
+
+#include "llthreadsafequeue.h"      // LLThreadSafeQueueInterrupt
+#include "llcoros.h"
+#include LLCOROS_MUTEX_HEADER
+#include LLCOROS_CONDVAR_HEADER
+#include "concurrentqueue.h"
+#include <atomic>
+#include <chrono>
+
+/**
+ * LLLockFreeQueue offers the same API and close() semantics as
+ * LLThreadSafeQueue, but producers and consumers never contend for a lock:
+ * items pass through a moodycamel::ConcurrentQueue. Choose it per queue, in
+ * place of LLThreadSafeQueue, where many threads push at once.
+ *
+ * Differences from LLThreadSafeQueue:
+ * - Order is FIFO per producer. Items pushed by different producers may be
+ *   popped in either order, even when one push finished before the other
+ *   began.
+ * - There is no canPop() hook and no QueueT parameter, so it can't stand in
+ *   for ThreadSafeSchedule or a prioritized queue. (WorkQueue's lock-free
+ *   mode keeps one per priority class instead.)
+ * - Capacity is approximate: producers racing for the last free slot may
+ *   overshoot it by one item each.
+ *
+ * Threads only lock a mutex to sleep when they can make no progress, and
+ * wake sleepers only when someone is actually asleep. As with
+ * LLThreadSafeQueue, a coroutine blocked in pop() or push() yields to other
+ * coroutines on its thread.
+ */
+template <typename ElementT>
+class LLLockFreeQueue
+{
+public:
+    typedef ElementT value_type;
+
+    LLLockFreeQueue(size_t capacity = 1024);
+
+    // Add an element to the queue (will block if the queue has reached
+    // capacity). Throws LLThreadSafeQueueInterrupt if the queue is closed.
+    template <typename T>
+    void push(T&& element);
+    // legacy name
+    void pushFront(ElementT const & element) { return push(element); }
+
+    // Add an element to the queue (will block if the queue has reached
+    // capacity). Return false if the queue is closed before push is possible.
+    template <typename T>
+    bool pushIfOpen(T&& element);
+
+    // Add an element to the queue without blocking. Returns true only if the
+    // element was actually added.
+    template <typename T>
+    bool tryPush(T&& element);
+    // legacy name
+    bool tryPushFront(ElementT const & element) { return tryPush(element); }
+
+    // Add an element, blocking while full but giving up after the specified
+    // duration or at the specified time_point. Returns true if added.
+    template <typename Rep, typename Period, typename T>
+    bool tryPushFor(const std::chrono::duration<Rep, Period>& timeout,
+                    T&& element);
+    template <typename Clock, typename Duration, typename T>
+    bool tryPushUntil(const std::chrono::time_point<Clock, Duration>& until,
+                      T&& element);
+
+    // Pop the element at the head of the queue (will block if the queue is
+    // empty). Throws LLThreadSafeQueueInterrupt once the queue is closed and
+    // drained.
+    ElementT pop(void);
+    // legacy name
+    ElementT popBack(void) { return pop(); }
+
+    // Pop an element if one is available. Returns true only if an element
+    // was popped.
+    bool tryPop(ElementT & element);
+    // legacy name
+    bool tryPopBack(ElementT & element) { return tryPop(element); }
+
+    // Pop an element, blocking while empty but giving up after the specified
+    // duration or at the specified time_point. Returns true if popped.
+    template <typename Rep, typename Period>
+    bool tryPopFor(const std::chrono::duration<Rep, Period>& timeout, ElementT& element);
+    template <typename Clock, typename Duration>
+    bool tryPopUntil(const std::chrono::time_point<Clock, Duration>& until,
+                     ElementT& element);
+
+    // Returns the approximate size of the queue.
+    size_t size();
+
+    //Returns the capacity of the queue.
+    U32 capacity() { return (U32)mCapacity; }
+
+    // closes the queue, with the same effects as LLThreadSafeQueue::close()
+    void close();
+
+    // producer end: are we prevented from pushing any additional items?
+    bool isClosed();
+    // consumer end: are we done, is the queue entirely drained?
+    bool done();
+
+private:
+    enum push_result { PUSHED, FULL, CLOSED };
+    enum pop_result { EMPTY, DONE, POPPED };
+
+    template <typename T>
+    push_result push_(T&& element);
+    pop_result pop_(ElementT& element);
+    // wake one (or all) of the threads sleeping on cond, if there are any
+    void wake(LLCoros::ConditionVariable& cond, const std::atomic<U32>& sleepers, bool all);
+    bool full() const { return mSize.load() >= (S64)mCapacity; }
+
+    moodycamel::ConcurrentQueue<ElementT> mStorage;
+    size_t mCapacity;
+    // Incremented after an item is enqueued and decremented after one is
+    // dequeued, so it may briefly dip below the true count, never above.
+    std::atomic<S64> mSize{ 0 };
+    // producers between checking mClosed and publishing their item: done()
+    // must not report true while any of them might still enqueue
+    std::atomic<U32> mPushing{ 0 };
+    std::atomic<bool> mClosed{ false };
+
+    std::atomic<U32> mPopSleepers{ 0 };
+    std::atomic<U32> mPushSleepers{ 0 };
+    LLCoros::Mutex mSleepMutex;
+    LLCoros::ConditionVariable mNotEmpty;
+    LLCoros::ConditionVariable mNotFull;
+};
+
+/*****************************************************************************
+*   LLLockFreeQueue implementation
+*****************************************************************************/
+template <typename ElementT>
+LLLockFreeQueue<ElementT>::LLLockFreeQueue(size_t capacity):
+    mCapacity(capacity)
+{
+}
+
+
+template <typename ElementT>
+void LLLockFreeQueue<ElementT>::wake(LLCoros::ConditionVariable& cond,
+                                     const std::atomic<U32>& sleepers, bool all)
+{
+    // A sleeper registers in sleepers, under mSleepMutex, before testing its
+    // wait condition; we changed that condition before testing sleepers. So
+    // either we see the sleeper, or it sees our change. Locking before
+    // notifying ensures a sleeper we see has actually started waiting.
+    if (sleepers.load())
+    {
+        LLCoros::LockType lock(mSleepMutex);
+        if (all)
+            cond.notify_all();
+        else
+            cond.notify_one();
+    }
+}
+
+
+// push the passed element if the queue is open and not full
+template <typename ElementT>
+template <typename T>
+typename LLLockFreeQueue<ElementT>::push_result
+LLLockFreeQueue<ElementT>::push_(T&& element)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    ++mPushing;
+    push_result result = CLOSED;
+    if (! mClosed)
+    {
+        // enqueue() only fails if it can't allocate a block
+        if (! full() && mStorage.enqueue(std::forward<T>(element)))
+        {
+            ++mSize;
+            result = PUSHED;
+        }
+        else
+        {
+            result = FULL;
+        }
+    }
+    if (--mPushing == 0 && mClosed)
+    {
+        // a consumer waiting for done() may have been waiting on us
+        wake(mNotEmpty, mPopSleepers, true);
+    }
+    else if (result == PUSHED)
+    {
+        wake(mNotEmpty, mPopSleepers, false);
+    }
+    return result;
+}
+
+
+template <typename ElementT>
+template <typename T>
+bool LLLockFreeQueue<ElementT>::pushIfOpen(T&& element)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    while (true)
+    {
+        // push_() only consumes element when it returns PUSHED
+        push_result pushed = push_(std::forward<T>(element));
+        if (pushed != FULL)
+            return pushed == PUSHED;
+
+        // Storage Full. Wait for signal.
+        LLCoros::LockType lock(mSleepMutex);
+        ++mPushSleepers;
+        mNotFull.wait(lock, [this](){ return ! full() || mClosed; });
+        --mPushSleepers;
+    }
+}
+
+
+template <typename ElementT>
+template <typename T>
+void LLLockFreeQueue<ElementT>::push(T&& element)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    if (! pushIfOpen(std::forward<T>(element)))
+    {
+        LLTHROW(LLThreadSafeQueueInterrupt());
+    }
+}
+
+
+template <typename ElementT>
+template <typename T>
+bool LLLockFreeQueue<ElementT>::tryPush(T&& element)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    return push_(std::forward<T>(element)) == PUSHED;
+}
+
+
+template <typename ElementT>
+template <typename Rep, typename Period, typename T>
+bool LLLockFreeQueue<ElementT>::tryPushFor(
+    const std::chrono::duration<Rep, Period>& timeout,
+    T&& element)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    return tryPushUntil(std::chrono::steady_clock::now() + timeout,
+                        std::forward<T>(element));
+}
+
+
+template <typename ElementT>
+template <typename Clock, typename Duration, typename T>
+bool LLLockFreeQueue<ElementT>::tryPushUntil(
+    const std::chrono::time_point<Clock, Duration>& until,
+    T&& element)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    while (true)
+    {
+        push_result pushed = push_(std::forward<T>(element));
+        if (pushed != FULL)
+            return pushed == PUSHED;
+
+        LLCoros::LockType lock(mSleepMutex);
+        ++mPushSleepers;
+        bool ready = mNotFull.wait_until(lock, until,
+                                         [this](){ return ! full() || mClosed; });
+        --mPushSleepers;
+        if (! ready)
+            return false;
+    }
+}
+
+
+// pop the head element, if there is one
+template <typename ElementT>
+typename LLLockFreeQueue<ElementT>::pop_result
+LLLockFreeQueue<ElementT>::pop_(ElementT& element)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    if (mStorage.try_dequeue(element))
+    {
+        --mSize;
+        // now that we've popped, if somebody's been waiting to push, signal them
+        wake(mNotFull, mPushSleepers, false);
+        return POPPED;
+    }
+    return done()? DONE : EMPTY;
+}
+
+
+template <typename ElementT>
+ElementT LLLockFreeQueue<ElementT>::pop(void)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    ElementT value;
+    while (true)
+    {
+        pop_result popped = pop_(value);
+        if (popped == POPPED)
+            return value;
+
+        // Once the queue is DONE, there will never be any more coming.
+        if (popped == DONE)
+        {
+            LLTHROW(LLThreadSafeQueueInterrupt());
+        }
+
+        LLCoros::LockType lock(mSleepMutex);
+        ++mPopSleepers;
+        mNotEmpty.wait(lock, [this](){ return mSize.load() > 0 || done(); });
+        --mPopSleepers;
+    }
+}
+
+
+template <typename ElementT>
+bool LLLockFreeQueue<ElementT>::tryPop(ElementT & element)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    return pop_(element) == POPPED;
+}
+
+
+template <typename ElementT>
+template <typename Rep, typename Period>
+bool LLLockFreeQueue<ElementT>::tryPopFor(
+    const std::chrono::duration<Rep, Period>& timeout,
+    ElementT& element)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    return tryPopUntil(std::chrono::steady_clock::now() + timeout, element);
+}
+
+
+template <typename ElementT>
+template <typename Clock, typename Duration>
+bool LLLockFreeQueue<ElementT>::tryPopUntil(
+    const std::chrono::time_point<Clock, Duration>& until,
+    ElementT& element)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    while (true)
+    {
+        pop_result popped = pop_(element);
+        if (popped != EMPTY)
+            return popped == POPPED;
+
+        LLCoros::LockType lock(mSleepMutex);
+        ++mPopSleepers;
+        bool ready = mNotEmpty.wait_until(lock, until,
+                                          [this](){ return mSize.load() > 0 || done(); });
+        --mPopSleepers;
+        if (! ready)
+            return false;
+    }
+}
+
+
+template <typename ElementT>
+size_t LLLockFreeQueue<ElementT>::size()
+{
+    S64 size = mSize.load();
+    return size > 0? size_t(size) : 0;
+}
+
+
+template <typename ElementT>
+void LLLockFreeQueue<ElementT>::close()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    mClosed = true;
+    LLCoros::LockType lock(mSleepMutex);
+    // wake up any blocked pop() calls
+    mNotEmpty.notify_all();
+    // wake up any blocked push() calls
+    mNotFull.notify_all();
+}
+
+
+template <typename ElementT>
+bool LLLockFreeQueue<ElementT>::isClosed()
+{
+    return mClosed;
+}
+
+
+template <typename ElementT>
+bool LLLockFreeQueue<ElementT>::done()
+{
+    // Read in the reverse of the order push_() writes: a producer increments
+    // mSize before it decrements mPushing.
+    return mClosed && mPushing.load() == 0 && mSize.load() <= 0;
+}
+
+#endif /* ! defined(LL_LLLOCKFREEQUEUE_H) */
@@ -0,0 +1,225 @@
+/**
+ * @file   llmappedfile.cpp
+ * @date   2026-10-18
+ * @brief  Implementation for llmappedfile.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llmappedfile.h"
+// STL headers
+// std headers
+#if LL_WINDOWS
+#include "llwin32headers.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+// external library headers
+// other Linden headers
+#include "llstring.h"
+
+LLMappedFile::~LLMappedFile()
+{
+    unmap();
+}
+
+bool LLMappedFile::map(const std::string& filename)
+{
+    unmap();
+#if LL_WINDOWS
+    llutf16string utf16filename = utf8str_to_utf16str(filename);
+    HANDLE file = CreateFileW((LPCWSTR)utf16filename.c_str(), GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    mFile = file;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0)
+    {
+        unmap();
+        return false;
+    }
+    mMap = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mMap)
+    {
+        unmap();
+        return false;
+    }
+    mData = (const U8*)MapViewOfFile((HANDLE)mMap, FILE_MAP_READ, 0, 0, 0);
+    if (!mData)
+    {
+        unmap();
+        return false;
+    }
+    mSize = (size_t)file_size.QuadPart;
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return false;
+    }
+    void* address = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping keeps the file referenced
+    close(fd);
+    if (address == MAP_FAILED)
+    {
+        return false;
+    }
+    mData = (const U8*)address;
+    mSize = (size_t)st.st_size;
+#endif
+    return true;
+}
+
+bool LLMappedFile::mapWritable(const std::string& filename, size_t size)
+{
+    unmap();
+    if (!size)
+    {
+        return false;
+    }
+#if LL_WINDOWS
+    llutf16string utf16filename = utf8str_to_utf16str(filename);
+    HANDLE file = CreateFileW((LPCWSTR)utf16filename.c_str(), GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    mFile = file;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size))
+    {
+        unmap();
+        return false;
+    }
+    if ((U64)file_size.QuadPart > (U64)size)
+    {
+        size = (size_t)file_size.QuadPart;
+    }
+    // mapping past the end of the file extends it
+    const U64 map_size = (U64)size;
+    mMap = CreateFileMappingW(file, NULL, PAGE_READWRITE,
+                              (DWORD)(map_size >> 32), (DWORD)(map_size & 0xffffffff), NULL);
+    if (!mMap)
+    {
+        unmap();
+        return false;
+    }
+    mData = (const U8*)MapViewOfFile((HANDLE)mMap, FILE_MAP_WRITE, 0, 0, 0);
+    if (!mData)
+    {
+        unmap();
+        return false;
+    }
+#else
+    int fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    if ((U64)st.st_size > (U64)size)
+    {
+        size = (size_t)st.st_size;
+    }
+    // a truncated extension reads as zeroes and is sparse where the
+    // filesystem allows
+    else if ((U64)st.st_size < (U64)size && ftruncate(fd, (off_t)size) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    void* address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED)
+    {
+        return false;
+    }
+    mData = (const U8*)address;
+#endif
+    mSize = size;
+    mWritable = true;
+    return true;
+}
+
+bool LLMappedFile::flush()
+{
+    if (!mData || !mWritable)
+    {
+        return false;
+    }
+#if LL_WINDOWS
+    return FlushViewOfFile(mData, 0) && FlushFileBuffers((HANDLE)mFile);
+#else
+    return msync((void*)mData, mSize, MS_SYNC) == 0;
+#endif
+}
+
+void LLMappedFile::unmap()
+{
+#if LL_WINDOWS
+    if (mData)
+    {
+        UnmapViewOfFile(mData);
+    }
+    if (mMap)
+    {
+        CloseHandle((HANDLE)mMap);
+    }
+    if (mFile)
+    {
+        CloseHandle((HANDLE)mFile);
+    }
+    mMap = nullptr;
+    mFile = nullptr;
+#else
+    if (mData)
+    {
+        munmap((void*)mData, mSize);
+    }
+#endif
+    mData = nullptr;
+    mSize = 0;
+    mWritable = false;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file   llmappedfile.h
+ * @date   2026-10-18
+ * @brief  Read-only memory mapping of a whole file.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#if ! defined(LL_LLMAPPEDFILE_H)
+#define LL_LLMAPPEDFILE_H
+
+#include <string>
+
+/**
+ * LLMappedFile maps a file read-only, from its start to its size at the time
+ * of map(). The file stays open to other readers and writers (and, on
+ * Windows, to deletion), so a file that is still being appended to can be
+ * mapped and mapped again once it has grown.
+ *
+ * mapWritable() instead maps a file of a fixed size for reading and writing;
+ * stores through writableData() reach the file as the OS pages them out, or
+ * at flush().
+ */
+class LL_COMMON_API LLMappedFile
+{
+public:
+    LLMappedFile() = default;
+    ~LLMappedFile();
+
+    LLMappedFile(const LLMappedFile&) = delete;
+    LLMappedFile& operator=(const LLMappedFile&) = delete;
+
+    /// Map filename, replacing any current mapping. False if the file can't
+    /// be opened or is empty.
+    bool map(const std::string& filename);
+    /// Map filename shared and writable, creating it or growing it (with
+    /// zeroes) to at least size bytes first. False on any failure.
+    bool mapWritable(const std::string& filename, size_t size);
+    void unmap();
+    /// Write dirty pages of a writable mapping back to the file, waiting
+    /// until they are written.
+    bool flush();
+
+    bool isMapped() const { return mData != nullptr; }
+    bool isWritable() const { return mWritable; }
+    const U8* data() const { return mData; }
+    U8* writableData() const { return mWritable ? const_cast<U8*>(mData) : nullptr; }
+    size_t size() const { return mSize; }
+
+private:
+    const U8* mData{ nullptr };
+    size_t mSize{ 0 };
+    bool mWritable{ false };
+#if LL_WINDOWS
+    void* mFile{ nullptr };
+    void* mMap{ nullptr };
+#endif
+};
+
+#endif /* ! defined(LL_LLMAPPEDFILE_H) */
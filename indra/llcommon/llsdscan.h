@@ -0,0 +1,135 @@
+/**
+ * @file   llsdscan.h
+ * @date   2026-10-18
+ * @brief  Vectorized byte scanning used by the text LLSD parsers.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSDSCAN_H
+#define LL_LLSDSCAN_H
+
+#include <istream>
+#include <streambuf>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include <emmintrin.h>
+
+#if LL_WINDOWS
+#include <intrin.h>
+#endif
+
+namespace LLSDScanDetail
+{
+    inline U32 lowest_set_bit(U32 mask)
+    {
+#if LL_WINDOWS
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (U32)index;
+#else
+        return (U32)__builtin_ctz(mask);
+#endif
+    }
+
+    // Gives the parsers a look at a streambuf's get area without being a
+    // streambuf. Forming the member pointer through the derived class is
+    // the sanctioned way to reach a protected base member.
+    class StreamBufAccess : public std::streambuf
+    {
+    public:
+        static std::pair<const char*, const char*> getArea(std::streambuf* sb)
+        {
+            if (!sb)
+            {
+                return { nullptr, nullptr };
+            }
+            char* (std::streambuf::*gptr_fn)() const = &StreamBufAccess::gptr;
+            char* (std::streambuf::*egptr_fn)() const = &StreamBufAccess::egptr;
+            return { (sb->*gptr_fn)(), (sb->*egptr_fn)() };
+        }
+    };
+}
+
+/**
+ * Offset of the first byte in [begin, end) equal to a or b, or (end - begin)
+ * if there is none. Compares 32 bytes at a time on AVX2 builds and 16 at a
+ * time otherwise.
+ */
+inline size_t ll_scan_for(const char* begin, const char* end, char a, char b)
+{
+    const char* p = begin;
+#if defined(__AVX2__)
+    const __m256i va32 = _mm256_set1_epi8(a);
+    const __m256i vb32 = _mm256_set1_epi8(b);
+    for (; end - p >= 32; p += 32)
+    {
+        const __m256i chunk = _mm256_loadu_si256((const __m256i*)p);
+        const U32 mask = (U32)_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, va32), _mm256_cmpeq_epi8(chunk, vb32)));
+        if (mask)
+        {
+            return (p - begin) + LLSDScanDetail::lowest_set_bit(mask);
+        }
+    }
+#endif
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    for (; end - p >= 16; p += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128((const __m128i*)p);
+        const U32 mask = (U32)_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+        if (mask)
+        {
+            return (p - begin) + LLSDScanDetail::lowest_set_bit(mask);
+        }
+    }
+    for (; p < end; ++p)
+    {
+        if (*p == a || *p == b)
+        {
+            break;
+        }
+    }
+    return p - begin;
+}
+
+/**
+ * Bytes of istr that are already buffered and can be consumed with
+ * istr.rdbuf()->sgetn() without touching the underlying device. Empty when
+ * nothing is buffered (or the stream isn't good), in which case callers fall
+ * back to reading a character at a time.
+ */
+inline std::pair<const char*, const char*> ll_buffered_input(std::istream& istr)
+{
+    if (!istr.good())
+    {
+        return { nullptr, nullptr };
+    }
+    return LLSDScanDetail::StreamBufAccess::getArea(istr.rdbuf());
+}
+
+#endif // LL_LLSDSCAN_H
@@ -29,6 +29,7 @@
 #include "linden_common.h"
 #include "llsdserialize.h"
 #include "llpointer.h"
+#include "llsdscan.h"
 #include "llstreamtools.h" // for fullread
 
 #include <iostream>
@@ -1692,7 +1693,7 @@ llssize deserialize_string_delim(
     std::string& value,
     char delim)
 {
-    std::ostringstream write_buffer;
+    std::string write_buffer;
     bool found_escape = false;
     bool found_hex = false;
     bool found_digit = false;
@@ -1701,13 +1702,29 @@ llssize deserialize_string_delim(
 
     while (true)
     {
+        if (!found_escape)
+        {
+            // Fast path: copy the run of ordinary characters up to the next
+            // delimiter or escape straight out of the stream buffer. Whatever
+            // stops the run is then handled one character at a time below.
+            auto [begin, end] = ll_buffered_input(istr);
+            size_t run = ll_scan_for(begin, end, delim, '\\');
+            if (run)
+            {
+                const size_t old_size = write_buffer.size();
+                write_buffer.resize(old_size + run);
+                istr.rdbuf()->sgetn(&write_buffer[old_size], run);
+                count += run;
+            }
+        }
+
         int next_byte = istr.get();
         ++count;
 
         if(istr.fail())
         {
             // If our stream is empty, break out
-            value = write_buffer.str();
+            value = write_buffer;
             return LLSDParser::PARSE_FAILURE;
         }
 
@@ -1725,7 +1742,7 @@ llssize deserialize_string_delim(
                     found_escape = false;
                     byte = byte << 4;
                     byte |= hex_as_nybble(next_char);
-                    write_buffer << byte;
+                    write_buffer.push_back((char)byte);
                     byte = 0;
                 }
                 else
@@ -1745,28 +1762,28 @@ llssize deserialize_string_delim(
                 switch(next_char)
                 {
                 case 'a':
-                    write_buffer << '\a';
+                    write_buffer.push_back('\a');
                     break;
                 case 'b':
-                    write_buffer << '\b';
+                    write_buffer.push_back('\b');
                     break;
                 case 'f':
-                    write_buffer << '\f';
+                    write_buffer.push_back('\f');
                     break;
                 case 'n':
-                    write_buffer << '\n';
+                    write_buffer.push_back('\n');
                     break;
                 case 'r':
-                    write_buffer << '\r';
+                    write_buffer.push_back('\r');
                     break;
                 case 't':
-                    write_buffer << '\t';
+                    write_buffer.push_back('\t');
                     break;
                 case 'v':
-                    write_buffer << '\v';
+                    write_buffer.push_back('\v');
                     break;
                 default:
-                    write_buffer << next_char;
+                    write_buffer.push_back(next_char);
                     break;
                 }
                 found_escape = false;
@@ -1782,11 +1799,11 @@ llssize deserialize_string_delim(
         }
         else
         {
-            write_buffer << next_char;
+            write_buffer.push_back(next_char);
         }
     }
 
-    value = write_buffer.str();
+    value.swap(write_buffer);
     return count;
 }
 
@@ -26,6 +26,7 @@
 
 #include "linden_common.h"
 #include "llsdserialize_xml.h"
+#include "llsdscan.h"
 
 #include <iostream>
 #include <deque>
@@ -363,6 +364,28 @@ static unsigned get_till_eol(std::istream& input, char *buf, unsigned bufsize)
     unsigned count = 0;
     while (count < bufsize && input.good())
     {
+        // Fast path: find the end of line in whatever the stream has already
+        // buffered and copy up to and including it in one go. Falls back to
+        // a character at a time when nothing is buffered.
+        auto [begin, end] = ll_buffered_input(input);
+        if (begin != end)
+        {
+            const size_t avail = llmin(size_t(end - begin), size_t(bufsize - count));
+            size_t run = ll_scan_for(begin, begin + avail, '\n', '\r');
+            const bool found_eol = run < avail;
+            if (found_eol)
+            {
+                ++run;
+            }
+            input.rdbuf()->sgetn(buf + count, run);
+            count += (unsigned)run;
+            if (found_eol)
+            {
+                break;
+            }
+            continue;
+        }
+
         char c = input.get();
         buf[count++] = c;
         if (is_eol(c))
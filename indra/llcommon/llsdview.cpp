@@ -0,0 +1,722 @@
+/**
+ * @file   llsdview.cpp
+ * @date   2026-10-18
+ * @brief  Implementation of LLSDViewBuffer and LLSDView.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llsdview.h"
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include "lldate.h"
+#include "llsdserialize.h"
+#include "llstring.h"
+#include "lluri.h"
+
+// defined in llsdserialize.cpp
+llssize deserialize_string_delim(std::istream& istr, std::string& value, char d);
+
+namespace
+{
+    // binary LLSD stores counts, lengths and integers in network byte order
+    U32 read_u32_nbo(const U8* p)
+    {
+        return (U32(p[0]) << 24) | (U32(p[1]) << 16) | (U32(p[2]) << 8) | U32(p[3]);
+    }
+
+    F64 read_f64_nbo(const U8* p)
+    {
+        U64 bits = 0;
+        for (S32 i = 0; i < 8; ++i)
+        {
+            bits = (bits << 8) | p[i];
+        }
+        F64 value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // dates are written in host byte order by LLSDBinaryFormatter
+    F64 read_f64_raw(const U8* p)
+    {
+        F64 value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    // Decode a notation-style quoted string; start points at the delimiter.
+    bool decode_quoted(const U8* start, size_t length, std::string& value)
+    {
+        boost::iostreams::stream<boost::iostreams::array_source>
+            istr((const char*)start + 1, length - 1);
+        return deserialize_string_delim(istr, value, (char)start[0]) != LLSDParser::PARSE_FAILURE;
+    }
+}
+
+/**
+ * LLSDViewBuffer
+ */
+LLSDViewBuffer::LLSDViewBuffer(const U8* data, size_t size):
+    mData(data),
+    mSize(data ? size : 0),
+    mIndexed(false)
+{
+}
+
+LLSDViewBuffer::LLSDViewBuffer(std::vector<U8>&& data):
+    mOwned(std::move(data)),
+    mIndexed(false)
+{
+    mData = mOwned.data();
+    mSize = mOwned.size();
+}
+
+LLSDViewBuffer::~LLSDViewBuffer()
+{
+}
+
+// static
+LLPointer<LLSDViewBuffer> LLSDViewBuffer::mapFile(const std::string& filename)
+{
+    auto mapping = std::make_unique<LLMappedFile>();
+    if (!mapping->map(filename))
+    {
+        return NULL;
+    }
+    LLPointer<LLSDViewBuffer> buffer = new LLSDViewBuffer(mapping->data(), mapping->size());
+    buffer->mMapping = std::move(mapping);
+    return buffer;
+}
+
+LLSDView LLSDViewBuffer::root() const
+{
+    return LLSDView(this, 0);
+}
+
+bool LLSDViewBuffer::index() const
+{
+    if (!mIndexed && skip(0) != npos)
+    {
+        mIndexed = true;
+    }
+    return mIndexed;
+}
+
+bool LLSDViewBuffer::readCount(size_t offset, U32& count) const
+{
+    if (offset > mSize || mSize - offset < sizeof(U32))
+    {
+        return false;
+    }
+    count = read_u32_nbo(mData + offset);
+    return true;
+}
+
+size_t LLSDViewBuffer::skipQuoted(size_t offset) const
+{
+    const U8 delim = mData[offset];
+    size_t pos = offset + 1;
+    while (pos < mSize)
+    {
+        U8 c = mData[pos];
+        if (c == '\\')
+        {
+            // "\xNN" consumes both nybbles whatever they are
+            pos += (pos + 1 < mSize && mData[pos + 1] == 'x') ? 4 : 2;
+        }
+        else if (c == delim)
+        {
+            return pos + 1;
+        }
+        else
+        {
+            ++pos;
+        }
+    }
+    return npos;
+}
+
+size_t LLSDViewBuffer::skipScalar(size_t offset) const
+{
+    if (offset >= mSize)
+    {
+        return npos;
+    }
+    size_t end = npos;
+    switch (mData[offset])
+    {
+    case '!':
+    case '0':
+    case '1':
+        end = offset + 1;
+        break;
+    case 'i':
+        end = offset + 1 + sizeof(U32);
+        break;
+    case 'r':
+    case 'd':
+        end = offset + 1 + sizeof(F64);
+        break;
+    case 'u':
+        end = offset + 1 + UUID_BYTES;
+        break;
+    case 's':
+    case 'l':
+    case 'b':
+    {
+        U32 length;
+        if (!readCount(offset + 1, length))
+        {
+            return npos;
+        }
+        end = offset + 1 + sizeof(U32) + length;
+        break;
+    }
+    case '\'':
+    case '"':
+        return skipQuoted(offset);
+    default:
+        return npos;
+    }
+    return end <= mSize ? end : npos;
+}
+
+size_t LLSDViewBuffer::skipKey(size_t offset) const
+{
+    if (offset >= mSize)
+    {
+        return npos;
+    }
+    switch (mData[offset])
+    {
+    case 'k':
+    {
+        U32 length;
+        if (!readCount(offset + 1, length))
+        {
+            return npos;
+        }
+        size_t end = offset + 1 + sizeof(U32) + length;
+        return end <= mSize ? end : npos;
+    }
+    case '\'':
+    case '"':
+        return skipQuoted(offset);
+    default:
+        return npos;
+    }
+}
+
+size_t LLSDViewBuffer::skip(size_t offset) const
+{
+    // Iterative so that hostile nesting can't exhaust the stack.
+    struct Frame
+    {
+        size_t mStart;
+        U32 mRemaining;
+        bool mIsMap;
+    };
+    std::vector<Frame> stack;
+    size_t pos = offset;
+    while (true)
+    {
+        // pos is at the start of a value
+        size_t end = npos;
+        const char c = pos < mSize ? (char)mData[pos] : 0;
+        if (c == '{' || c == '[')
+        {
+            auto found = mContainerEnds.find(pos);
+            if (found != mContainerEnds.end())
+            {
+                end = found->second;
+            }
+            else if (mIndexed)
+            {
+                // a complete index that doesn't know this container means
+                // we were handed an offset that isn't a value boundary
+                return npos;
+            }
+            else
+            {
+                U32 count;
+                if (!readCount(pos + 1, count))
+                {
+                    return npos;
+                }
+                stack.push_back({ pos, count, c == '{' });
+                pos += 1 + sizeof(U32);
+            }
+        }
+        else
+        {
+            end = skipScalar(pos);
+            if (end == npos)
+            {
+                return npos;
+            }
+        }
+
+        if (end != npos)
+        {
+            if (stack.empty())
+            {
+                return end;
+            }
+            pos = end;
+            --stack.back().mRemaining;
+        }
+
+        // close every container whose elements are exhausted
+        while (!stack.back().mRemaining)
+        {
+            const Frame& top = stack.back();
+            if (pos >= mSize || mData[pos] != (top.mIsMap ? '}' : ']'))
+            {
+                return npos;
+            }
+            ++pos;
+            mContainerEnds[top.mStart] = pos;
+            stack.pop_back();
+            if (stack.empty())
+            {
+                return pos;
+            }
+            --stack.back().mRemaining;
+        }
+
+        if (stack.back().mIsMap)
+        {
+            pos = skipKey(pos);
+            if (pos == npos)
+            {
+                return npos;
+            }
+        }
+    }
+}
+
+/**
+ * LLSDView
+ */
+char LLSDView::marker() const
+{
+    if (!mBuffer || mOffset >= mBuffer->mSize)
+    {
+        return 0;
+    }
+    return (char)mBuffer->mData[mOffset];
+}
+
+LLSD::Type LLSDView::type() const
+{
+    const char c = marker();
+    switch (c)
+    {
+    case '{':
+        return LLSD::TypeMap;
+    case '[':
+        return LLSD::TypeArray;
+    default:
+        break;
+    }
+    if (!c || mBuffer->skipScalar(mOffset) == LLSDViewBuffer::npos)
+    {
+        return LLSD::TypeUndefined;
+    }
+    switch (c)
+    {
+    case '0':
+    case '1':
+        return LLSD::TypeBoolean;
+    case 'i':
+        return LLSD::TypeInteger;
+    case 'r':
+        return LLSD::TypeReal;
+    case 'u':
+        return LLSD::TypeUUID;
+    case 's':
+    case '\'':
+    case '"':
+        return LLSD::TypeString;
+    case 'l':
+        return LLSD::TypeURI;
+    case 'd':
+        return LLSD::TypeDate;
+    case 'b':
+        return LLSD::TypeBinary;
+    default:
+        return LLSD::TypeUndefined;
+    }
+}
+
+LLSD LLSDView::scalarToLLSD() const
+{
+    const char c = marker();
+    if (!c || c == '{' || c == '[')
+    {
+        return LLSD();
+    }
+    const size_t end = mBuffer->skipScalar(mOffset);
+    if (end == LLSDViewBuffer::npos)
+    {
+        return LLSD();
+    }
+    const U8* p = mBuffer->mData + mOffset + 1;
+    switch (c)
+    {
+    case '0':
+        return LLSD(false);
+    case '1':
+        return LLSD(true);
+    case 'i':
+        return LLSD((LLSD::Integer)read_u32_nbo(p));
+    case 'r':
+        return LLSD(read_f64_nbo(p));
+    case 'u':
+    {
+        LLUUID id;
+        memcpy(id.mData, p, UUID_BYTES);
+        return LLSD(id);
+    }
+    case 'd':
+        return LLSD(LLDate(read_f64_raw(p)));
+    case 's':
+        return LLSD(std::string(asStringView()));
+    case 'l':
+        return LLSD(LLURI(std::string(asStringView())));
+    case 'b':
+    {
+        std::string_view bytes = asStringView();
+        return LLSD(LLSD::Binary(bytes.begin(), bytes.end()));
+    }
+    case '\'':
+    case '"':
+    {
+        std::string value;
+        if (decode_quoted(mBuffer->mData + mOffset, end - mOffset, value))
+        {
+            return LLSD(value);
+        }
+        return LLSD();
+    }
+    default:
+        return LLSD();
+    }
+}
+
+LLSD::Boolean LLSDView::asBoolean() const
+{
+    switch (marker())
+    {
+    case '0':
+        return false;
+    case '1':
+        return true;
+    default:
+        return scalarToLLSD().asBoolean();
+    }
+}
+
+LLSD::Integer LLSDView::asInteger() const
+{
+    if (marker() == 'i' && mBuffer->skipScalar(mOffset) != LLSDViewBuffer::npos)
+    {
+        return (LLSD::Integer)read_u32_nbo(mBuffer->mData + mOffset + 1);
+    }
+    return scalarToLLSD().asInteger();
+}
+
+LLSD::Real LLSDView::asReal() const
+{
+    if (marker() == 'r' && mBuffer->skipScalar(mOffset) != LLSDViewBuffer::npos)
+    {
+        return read_f64_nbo(mBuffer->mData + mOffset + 1);
+    }
+    return scalarToLLSD().asReal();
+}
+
+LLSD::String LLSDView::asString() const
+{
+    if (marker() == 's')
+    {
+        return std::string(asStringView());
+    }
+    return scalarToLLSD().asString();
+}
+
+LLSD::UUID LLSDView::asUUID() const
+{
+    if (marker() == 'u' && mBuffer->skipScalar(mOffset) != LLSDViewBuffer::npos)
+    {
+        LLUUID id;
+        memcpy(id.mData, mBuffer->mData + mOffset + 1, UUID_BYTES);
+        return id;
+    }
+    return scalarToLLSD().asUUID();
+}
+
+LLSD::Date LLSDView::asDate() const
+{
+    return scalarToLLSD().asDate();
+}
+
+LLSD::URI LLSDView::asURI() const
+{
+    return scalarToLLSD().asURI();
+}
+
+LLSD::Binary LLSDView::asBinary() const
+{
+    if (marker() == 'b')
+    {
+        std::string_view bytes = asStringView();
+        return LLSD::Binary(bytes.begin(), bytes.end());
+    }
+    return scalarToLLSD().asBinary();
+}
+
+std::string_view LLSDView::asStringView() const
+{
+    const char c = marker();
+    if (c != 's' && c != 'l' && c != 'b')
+    {
+        return std::string_view();
+    }
+    const size_t end = mBuffer->skipScalar(mOffset);
+    if (end == LLSDViewBuffer::npos)
+    {
+        return std::string_view();
+    }
+    const size_t start = mOffset + 1 + sizeof(U32);
+    return std::string_view((const char*)mBuffer->mData + start, end - start);
+}
+
+size_t LLSDView::size() const
+{
+    const char c = marker();
+    U32 count = 0;
+    if ((c == '{' || c == '[') && mBuffer->readCount(mOffset + 1, count))
+    {
+        return count;
+    }
+    return 0;
+}
+
+bool LLSDView::has(std::string_view key) const
+{
+    for (const_iterator it = beginMap(), end = endMap(); it != end; ++it)
+    {
+        if (it.key() == key)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+LLSDView LLSDView::get(std::string_view key) const
+{
+    for (const_iterator it = beginMap(), end = endMap(); it != end; ++it)
+    {
+        if (it.key() == key)
+        {
+            return it.value();
+        }
+    }
+    return LLSDView();
+}
+
+LLSDView LLSDView::get(size_t index) const
+{
+    const_iterator it = beginArray(), end = endArray();
+    for (; it != end && index; --index)
+    {
+        ++it;
+    }
+    return it != end ? it.value() : LLSDView();
+}
+
+size_t LLSDView::byteSize() const
+{
+    if (!mBuffer)
+    {
+        return 0;
+    }
+    const size_t end = mBuffer->skip(mOffset);
+    return end == LLSDViewBuffer::npos ? 0 : end - mOffset;
+}
+
+LLSDView::const_iterator LLSDView::beginMap() const
+{
+    if (marker() != '{')
+    {
+        return const_iterator();
+    }
+    return const_iterator(mBuffer, mOffset + 1 + sizeof(U32), size(), true);
+}
+
+LLSDView::const_iterator LLSDView::beginArray() const
+{
+    if (marker() != '[')
+    {
+        return const_iterator();
+    }
+    return const_iterator(mBuffer, mOffset + 1 + sizeof(U32), size(), false);
+}
+
+LLSD LLSDView::toLLSD(S32 max_depth) const
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_LLSD;
+    // Validating the whole value first records every nested container's
+    // extent, so the recursive decode below never rescans anything.
+    if (!byteSize())
+    {
+        return LLSD();
+    }
+    bool ok = true;
+    LLSD result = toLLSD(max_depth, ok);
+    return ok ? result : LLSD();
+}
+
+LLSD LLSDView::toLLSD(S32 max_depth, bool& ok) const
+{
+    if (max_depth == 0)
+    {
+        ok = false;
+        return LLSD();
+    }
+    switch (marker())
+    {
+    case '{':
+    {
+        LLSD map = LLSD::emptyMap();
+        for (const_iterator it = beginMap(), end = endMap(); ok && it != end; ++it)
+        {
+            map.insert(it.key(), it.value().toLLSD(max_depth - 1, ok));
+        }
+        return map;
+    }
+    case '[':
+    {
+        LLSD array = LLSD::emptyArray();
+        for (const_iterator it = beginArray(), end = endArray(); ok && it != end; ++it)
+        {
+            array.append(it.value().toLLSD(max_depth - 1, ok));
+        }
+        return array;
+    }
+    default:
+        return scalarToLLSD();
+    }
+}
+
+/**
+ * LLSDView::const_iterator
+ */
+LLSDView::const_iterator::const_iterator(const LLSDViewBuffer* buffer, size_t offset,
+                                         size_t remaining, bool is_map):
+    mBuffer(buffer),
+    mOffset(offset),
+    mValueOffset(offset),
+    mRemaining(remaining),
+    mIsMap(is_map)
+{
+    if (mRemaining)
+    {
+        load();
+    }
+}
+
+void LLSDView::const_iterator::load()
+{
+    if (!mIsMap)
+    {
+        mValueOffset = mOffset;
+        return;
+    }
+    mValueOffset = mBuffer->skipKey(mOffset);
+    if (mValueOffset == LLSDViewBuffer::npos)
+    {
+        mRemaining = 0;
+        return;
+    }
+    mKeyEscaped = mBuffer->mData[mOffset] != 'k';
+    if (mKeyEscaped)
+    {
+        mEscapedKey.clear();
+        if (!decode_quoted(mBuffer->mData + mOffset, mValueOffset - mOffset, mEscapedKey))
+        {
+            mRemaining = 0;
+        }
+    }
+    else
+    {
+        mKeyOffset = mOffset + 1 + sizeof(U32);
+        mKeyLength = mValueOffset - mKeyOffset;
+    }
+}
+
+std::string_view LLSDView::const_iterator::key() const
+{
+    if (!mIsMap || !mRemaining)
+    {
+        return std::string_view();
+    }
+    if (mKeyEscaped)
+    {
+        return mEscapedKey;
+    }
+    return std::string_view((const char*)mBuffer->mData + mKeyOffset, mKeyLength);
+}
+
+LLSDView LLSDView::const_iterator::value() const
+{
+    if (!mRemaining)
+    {
+        return LLSDView();
+    }
+    return LLSDView(mBuffer, mValueOffset);
+}
+
+LLSDView::const_iterator& LLSDView::const_iterator::operator++()
+{
+    if (!mRemaining)
+    {
+        return *this;
+    }
+    const size_t next = mBuffer->skip(mValueOffset);
+    if (next == LLSDViewBuffer::npos)
+    {
+        mRemaining = 0;
+        return *this;
+    }
+    mOffset = next;
+    if (--mRemaining)
+    {
+        load();
+    }
+    return *this;
+}
@@ -0,0 +1,241 @@
+/**
+ * @file   llsdview.h
+ * @date   2026-10-18
+ * @brief  Read-only view over binary-serialized LLSD that decodes lazily.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSDVIEW_H
+#define LL_LLSDVIEW_H
+
+#include "llmappedfile.h"
+#include "llpointer.h"
+#include "llrefcount.h"
+#include "llsd.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class LLSDView;
+
+/**
+ * @class LLSDViewBuffer
+ * @brief Contiguous block of binary LLSD, as written by LLSDBinaryFormatter,
+ * that LLSDView indexes in place.
+ *
+ * The buffer either borrows caller memory, takes ownership of a byte
+ * vector, or maps a file read-only. The bytes must not carry the deprecated
+ * "<? LLSD/Binary ?>" header; use strip_deprecated_header() first.
+ *
+ * Nothing is decoded up front. Whenever a map or array has to be stepped
+ * over, its end offset is remembered so later lookups in the enclosing
+ * container never rescan it. Because that cache is filled on demand, a
+ * buffer must only be read from one thread at a time unless index() has
+ * already been called.
+ */
+class LL_COMMON_API LLSDViewBuffer : public LLRefCount
+{
+public:
+    /// Borrow size bytes at data; the caller keeps them alive.
+    LLSDViewBuffer(const U8* data, size_t size);
+    /// Take ownership of data.
+    LLSDViewBuffer(std::vector<U8>&& data);
+
+    /// Map filename read-only. Returns NULL if it cannot be opened or is empty.
+    static LLPointer<LLSDViewBuffer> mapFile(const std::string& filename);
+
+    /// View of the top-level value.
+    LLSDView root() const;
+
+    /**
+     * Walk the whole buffer once, recording the extent of every container.
+     * Returns false if the data is malformed. Afterwards the buffer may be
+     * read concurrently.
+     */
+    bool index() const;
+
+    const U8* data() const { return mData; }
+    size_t size() const { return mSize; }
+
+    static constexpr size_t npos = std::string_view::npos;
+
+protected:
+    ~LLSDViewBuffer();
+
+private:
+    friend class LLSDView;
+
+    // Offset one past the value starting at offset, or npos if malformed.
+    size_t skip(size_t offset) const;
+    // Same for the map key starting at offset.
+    size_t skipKey(size_t offset) const;
+    // Offset one past a scalar, npos if malformed or not a scalar.
+    size_t skipScalar(size_t offset) const;
+    // Offset one past a quoted (notation-style) string starting at offset.
+    size_t skipQuoted(size_t offset) const;
+    // Reads a network byte order U32 at offset, false if out of range.
+    bool readCount(size_t offset, U32& count) const;
+
+    const U8* mData;
+    size_t mSize;
+    std::vector<U8> mOwned;
+    std::unique_ptr<LLMappedFile> mMapping;
+    mutable std::unordered_map<size_t, size_t> mContainerEnds;
+    mutable bool mIndexed;
+};
+
+/**
+ * @class LLSDView
+ * @brief Lightweight handle on one value inside an LLSDViewBuffer.
+ *
+ * The accessors mirror LLSD's so that code templated on the container type
+ * (or simply rewritten against LLSDView) reads the same. Scalars are decoded
+ * on each call; strings, URIs and binary blobs can be read without copying
+ * through asStringView(). Missing keys, out of range indices and malformed
+ * data all yield an undefined view, just as LLSD yields an undefined value.
+ *
+ * A view is only valid while its LLSDViewBuffer is alive.
+ */
+class LL_COMMON_API LLSDView
+{
+public:
+    /// Undefined view.
+    LLSDView() = default;
+
+    LLSD::Type type() const;
+
+    bool isUndefined() const { return type() == LLSD::TypeUndefined; }
+    bool isDefined() const   { return type() != LLSD::TypeUndefined; }
+    bool isMap() const       { return type() == LLSD::TypeMap; }
+    bool isArray() const     { return type() == LLSD::TypeArray; }
+    bool isBoolean() const   { return type() == LLSD::TypeBoolean; }
+    bool isInteger() const   { return type() == LLSD::TypeInteger; }
+    bool isReal() const      { return type() == LLSD::TypeReal; }
+    bool isString() const    { return type() == LLSD::TypeString; }
+    bool isUUID() const      { return type() == LLSD::TypeUUID; }
+    bool isDate() const      { return type() == LLSD::TypeDate; }
+    bool isURI() const       { return type() == LLSD::TypeURI; }
+    bool isBinary() const    { return type() == LLSD::TypeBinary; }
+
+    /// Conversions follow the same rules as the LLSD accessors.
+    LLSD::Boolean asBoolean() const;
+    LLSD::Integer asInteger() const;
+    LLSD::Real asReal() const;
+    LLSD::String asString() const;
+    LLSD::UUID asUUID() const;
+    LLSD::Date asDate() const;
+    LLSD::URI asURI() const;
+    LLSD::Binary asBinary() const;
+
+    /**
+     * Raw bytes of a length-prefixed string, URI or binary value, pointing
+     * into the buffer. Empty for anything else, including strings stored in
+     * the escaped notation form.
+     */
+    std::string_view asStringView() const;
+
+    /// Number of elements declared by a map or array, 0 otherwise.
+    size_t size() const;
+
+    /// Map lookup. First match wins, as with LLSDBinaryParser.
+    bool has(std::string_view key) const;
+    LLSDView get(std::string_view key) const;
+    LLSDView operator[](std::string_view key) const { return get(key); }
+    LLSDView operator[](const std::string& key) const { return get(std::string_view(key)); }
+    LLSDView operator[](const char* key) const { return get(std::string_view(key)); }
+
+    /// Array lookup, linear in index.
+    LLSDView get(size_t index) const;
+    LLSDView operator[](S32 index) const { return index < 0 ? LLSDView() : get(size_t(index)); }
+
+    /// Number of bytes this value occupies in the buffer, 0 if malformed.
+    size_t byteSize() const;
+
+    /**
+     * Fully decode this value into an LLSD. Produces the same result as
+     * LLSDSerialize::fromBinary() on the same bytes, or undefined if the
+     * data is malformed or nested deeper than max_depth.
+     */
+    LLSD toLLSD(S32 max_depth = -1) const;
+
+    /**
+     * Forward iterator over the elements of a map or an array. key() is
+     * only meaningful for maps.
+     */
+    class LL_COMMON_API const_iterator
+    {
+    public:
+        const_iterator() = default;
+
+        std::string_view key() const;
+        LLSDView value() const;
+        LLSDView operator*() const { return value(); }
+
+        const_iterator& operator++();
+        bool operator==(const const_iterator& other) const
+        {
+            return mRemaining == other.mRemaining && (!mRemaining || mOffset == other.mOffset);
+        }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class LLSDView;
+        const_iterator(const LLSDViewBuffer* buffer, size_t offset, size_t remaining, bool is_map);
+        // decode the key (for maps) at mOffset, ending iteration if malformed
+        void load();
+
+        const LLSDViewBuffer* mBuffer = nullptr;
+        size_t mOffset = 0;             // start of current key or value
+        size_t mValueOffset = 0;        // start of current value
+        size_t mRemaining = 0;
+        size_t mKeyOffset = 0;
+        size_t mKeyLength = 0;
+        std::string mEscapedKey;        // decoded notation-style key
+        bool mIsMap = false;
+        bool mKeyEscaped = false;
+    };
+
+    const_iterator beginMap() const;
+    const_iterator endMap() const { return const_iterator(); }
+    const_iterator beginArray() const;
+    const_iterator endArray() const { return const_iterator(); }
+
+private:
+    friend class LLSDViewBuffer;
+    LLSDView(const LLSDViewBuffer* buffer, size_t offset):
+        mBuffer(buffer),
+        mOffset(offset)
+    {}
+
+    // type marker character, or 0 if this view is undefined
+    char marker() const;
+    LLSD scalarToLLSD() const;
+    LLSD toLLSD(S32 max_depth, bool& ok) const;
+
+    const LLSDViewBuffer* mBuffer = nullptr;
+    size_t mOffset = 0;
+};
+
+#endif // LL_LLSDVIEW_H
@@ -30,6 +30,10 @@
 #include "llstringtable.h"
 #include "llstl.h"
 
+#include <atomic>
+#include <deque>
+#include <mutex>
+
 LLStringTable gStringTable(32768);
 
 LLStringTableEntry::LLStringTableEntry(const char *str)
@@ -349,3 +353,168 @@ void LLStringTable::removeString(const char *str)
     }
 }
 
+
+//============================================================================
+// LLConcurrentStringTable
+
+namespace
+{
+    struct InternEntry
+    {
+        InternEntry(size_t hash, std::string_view str):
+            mHash(hash),
+            mString(str)
+        {}
+
+        size_t mHash;
+        std::string mString;
+    };
+
+    // Power-of-two array of entry pointers, never more than half full, so
+    // every probe sequence ends at a NULL.
+    struct InternSlots
+    {
+        InternSlots(size_t size):
+            mMask(size - 1),
+            mSlots(new std::atomic<const InternEntry*>[size])
+        {
+            for (size_t i = 0; i < size; ++i)
+            {
+                mSlots[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        const InternEntry* find(size_t hash, std::string_view str) const
+        {
+            for (size_t i = hash & mMask; ; i = (i + 1) & mMask)
+            {
+                const InternEntry* entry = mSlots[i].load(std::memory_order_acquire);
+                if (!entry)
+                {
+                    return nullptr;
+                }
+                if (entry->mHash == hash && entry->mString == str)
+                {
+                    return entry;
+                }
+            }
+        }
+
+        void place(const InternEntry* entry)
+        {
+            size_t i = entry->mHash & mMask;
+            while (mSlots[i].load(std::memory_order_relaxed))
+            {
+                i = (i + 1) & mMask;
+            }
+            mSlots[i].store(entry, std::memory_order_release);
+        }
+
+        size_t mMask;
+        std::unique_ptr<std::atomic<const InternEntry*>[]> mSlots;
+    };
+}
+
+struct LLConcurrentStringTable::Shard
+{
+    std::atomic<InternSlots*> mSlots{ nullptr };
+    // everything below is only touched with mMutex locked
+    std::mutex mMutex;
+    // std::deque never moves its elements, so handles stay valid
+    std::deque<InternEntry> mEntries;
+    // the current mSlots and every array it replaced
+    std::vector<std::unique_ptr<InternSlots>> mAllSlots;
+};
+
+LLConcurrentStringTable::LLConcurrentStringTable(size_t expected):
+    mShards(new Shard[SHARDS])
+{
+    size_t size = 16;
+    while (size < expected * 2 / SHARDS)
+    {
+        size <<= 1;
+    }
+    for (U32 i = 0; i < SHARDS; ++i)
+    {
+        mShards[i].mAllSlots.emplace_back(new InternSlots(size));
+        mShards[i].mSlots.store(mShards[i].mAllSlots.back().get(), std::memory_order_release);
+    }
+}
+
+LLConcurrentStringTable::~LLConcurrentStringTable()
+{
+}
+
+LLConcurrentStringTable::Shard& LLConcurrentStringTable::shardFor(size_t hash) const
+{
+    // the low bits pick the slot, so pick the shard with the high ones
+    return mShards[(hash >> (sizeof(size_t) * 8 - SHARD_BITS)) & (SHARDS - 1)];
+}
+
+LLStdStringHandle LLConcurrentStringTable::lookup(std::string_view s) const
+{
+    const size_t hash = std::hash<std::string_view>()(s);
+    const InternEntry* entry =
+        shardFor(hash).mSlots.load(std::memory_order_acquire)->find(hash, s);
+    return entry ? &entry->mString : NULL;
+}
+
+LLStdStringHandle LLConcurrentStringTable::insert(std::string_view s)
+{
+    const size_t hash = std::hash<std::string_view>()(s);
+    Shard& shard = shardFor(hash);
+    const InternEntry* entry = shard.mSlots.load(std::memory_order_acquire)->find(hash, s);
+    if (entry)
+    {
+        return &entry->mString;
+    }
+
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+    InternSlots* slots = shard.mSlots.load(std::memory_order_relaxed);
+    // another thread may have added it, or grown the array, since we looked
+    entry = slots->find(hash, s);
+    if (entry)
+    {
+        return &entry->mString;
+    }
+
+    if ((shard.mEntries.size() + 1) * 2 > slots->mMask + 1)
+    {
+        shard.mAllSlots.emplace_back(new InternSlots((slots->mMask + 1) * 2));
+        slots = shard.mAllSlots.back().get();
+        for (const InternEntry& existing : shard.mEntries)
+        {
+            slots->place(&existing);
+        }
+        shard.mSlots.store(slots, std::memory_order_release);
+    }
+    shard.mEntries.emplace_back(hash, s);
+    entry = &shard.mEntries.back();
+    slots->place(entry);
+    return &entry->mString;
+}
+
+size_t LLConcurrentStringTable::size() const
+{
+    size_t total = 0;
+    for (U32 i = 0; i < SHARDS; ++i)
+    {
+        std::lock_guard<std::mutex> lock(mShards[i].mMutex);
+        total += mShards[i].mEntries.size();
+    }
+    return total;
+}
+
+std::vector<LLStdStringHandle> LLConcurrentStringTable::getHandles() const
+{
+    std::vector<LLStdStringHandle> handles;
+    for (U32 i = 0; i < SHARDS; ++i)
+    {
+        std::lock_guard<std::mutex> lock(mShards[i].mMutex);
+        for (const InternEntry& entry : mShards[i].mEntries)
+        {
+            handles.push_back(&entry.mString);
+        }
+    }
+    return handles;
+}
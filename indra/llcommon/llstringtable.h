@@ -32,7 +32,10 @@
 #include "llformat.h"
 #include "llstl.h"
 #include <list>
+#include <memory>
 #include <set>
+#include <string_view>
+#include <vector>
 
 #if LL_WINDOWS
 # if (_MSC_VER >= 1300 && _MSC_VER < 1400)
@@ -205,5 +208,49 @@ private:
     string_set_t* mStringList; // [mTableSize]
 };
 
+//============================================================================
+
+// LLConcurrentStringTable interns strings for any number of threads at once.
+// Handles are LLStdStringHandles, stable for the life of the table, so code
+// using an LLStdStringTable can switch to it without other changes.
+//
+// Lookups take no lock: each of the SHARDS shards publishes an open-addressed
+// array of entry pointers that readers probe with acquire loads. Inserts lock
+// only the shard the string hashes to. When a shard's array passes half full
+// it's replaced by one twice the size; the old array is kept until the table
+// is destroyed, since a reader may still be probing it. Strings are never
+// removed.
+
+class LL_COMMON_API LLConcurrentStringTable
+{
+public:
+    // expected is a hint for the number of distinct strings
+    LLConcurrentStringTable(size_t expected = 0);
+    ~LLConcurrentStringTable();
+
+    LLConcurrentStringTable(const LLConcurrentStringTable&) = delete;
+    LLConcurrentStringTable& operator=(const LLConcurrentStringTable&) = delete;
+
+    // NULL if s has not been inserted
+    LLStdStringHandle lookup(std::string_view s) const;
+    LLStdStringHandle checkString(std::string_view s) const { return lookup(s); }
+
+    LLStdStringHandle insert(std::string_view s);
+    LLStdStringHandle addString(std::string_view s) { return insert(s); }
+
+    // number of distinct strings
+    size_t size() const;
+    // every handle, in no particular order
+    std::vector<LLStdStringHandle> getHandles() const;
+
+    static const U32 SHARD_BITS = 6;
+    static const U32 SHARDS = 1 << SHARD_BITS;
+
+private:
+    struct Shard;
+    Shard& shardFor(size_t hash) const;
+
+    std::unique_ptr<Shard[]> mShards;
+};
 
 #endif
@@ -70,7 +70,9 @@ public:
 };
 
 /**
- * Implements a thread safe FIFO.
+ * Implements a thread safe FIFO. For a plain FIFO with many concurrent
+ * producers, LLLockFreeQueue (lllockfreequeue.h) offers the same API without
+ * a lock.
  */
 // Let the default std::queue default to underlying std::deque. Override if
 // desired.
@@ -255,6 +257,134 @@ namespace LL
     private:
         queue_type mQ;
     };
+
+/*****************************************************************************
+*   LaneQueueAdapter
+*****************************************************************************/
+    /**
+     * Given a bit mask of the lanes that have an item ready to serve, and how
+     * many times in a row each lane has been passed over, return the lane to
+     * serve next: normally the lowest-numbered candidate, but the
+     * highest-priority candidate passed over at least starvation_limit times
+     * takes precedence. Returns lanes if there are no candidates.
+     */
+    template <typename SKIPPED>
+    size_t choose_lane(size_t lanes, U32 candidates, const SKIPPED& skipped,
+                       U32 starvation_limit)
+    {
+        size_t first = lanes;
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+            if (! (candidates & (1 << lane)))
+                continue;
+            if (first == lanes)
+                first = lane;
+            else if (skipped[lane] >= starvation_limit)
+                return lane;
+        }
+        return first;
+    }
+
+    /**
+     * LaneQueueAdapter splits the storage of an LLThreadSafeQueue into LANES
+     * separate QueueTs, lane 0 being the most urgent. front() reports the
+     * head of the most urgent lane with an item ready to serve, subject to
+     * starvation protection: a lane passed over STARVATION_LIMIT times in a
+     * row is served next regardless (see choose_lane()).
+     *
+     * TRAITS must provide these static methods:
+     * - size_t lane(const value_type&): the lane in which to store an item
+     * - bool ready(const value_type&): whether a lane head may be served yet
+     * - bool before(const value_type&, const value_type&): when no head is
+     *   ready, whether the first will become ready before the second
+     */
+    template <typename QueueT, size_t LANES, typename TRAITS, U32 STARVATION_LIMIT=8>
+    class LaneQueueAdapter
+    {
+    public:
+        typedef typename QueueT::value_type      value_type;
+        typedef typename QueueT::size_type       size_type;
+        typedef typename QueueT::const_reference const_reference;
+
+        static_assert(LANES <= 32, "LaneQueueAdapter tracks lanes in a U32 mask");
+
+        // LLThreadSafeQueue always calls front() immediately before pop(),
+        // under the same lock. The lane chosen by front() is remembered so
+        // pop() removes the very item front() reported, even if the clock
+        // has since made some other lane's head ready.
+        const_reference front() const { return mLanes[pick()].front(); }
+        bool empty() const            { return mSize == 0; }
+        size_type size() const        { return mSize; }
+        size_type size(size_t lane) const { return mLanes[lane].size(); }
+
+        void push(const value_type& value)
+        {
+            mLanes[TRAITS::lane(value)].push(value);
+            pushed();
+        }
+        void push(value_type&& value)
+        {
+            size_t lane = TRAITS::lane(value);
+            mLanes[lane].push(std::move(value));
+            pushed();
+        }
+
+        void pop()
+        {
+            size_t lane = pick();
+            for (size_t other = 0; other < LANES; ++other)
+            {
+                if (mCandidates & (1 << other))
+                {
+                    mSkipped[other] = (other == lane)? 0 : mSkipped[other] + 1;
+                }
+            }
+            mLanes[lane].pop();
+            --mSize;
+            mPicked = LANES;
+        }
+
+    private:
+        void pushed()
+        {
+            ++mSize;
+            mPicked = LANES;
+        }
+
+        size_t pick() const
+        {
+            if (mPicked < LANES && mPickedReady)
+                return mPicked;
+            mCandidates = 0;
+            size_t earliest = LANES;
+            for (size_t lane = 0; lane < LANES; ++lane)
+            {
+                if (mLanes[lane].empty())
+                    continue;
+                const value_type& head = mLanes[lane].front();
+                if (TRAITS::ready(head))
+                    mCandidates |= (1 << lane);
+                if (earliest == LANES || TRAITS::before(head, mLanes[earliest].front()))
+                    earliest = lane;
+            }
+            mPicked = choose_lane(LANES, mCandidates, mSkipped, STARVATION_LIMIT);
+            mPickedReady = (mPicked < LANES);
+            if (! mPickedReady)
+            {
+                // nothing is ready: report whichever head will be first, so
+                // the caller knows how long to wait
+                mPicked = earliest;
+            }
+            return mPicked;
+        }
+
+        QueueT mLanes[LANES];
+        U32 mSkipped[LANES]{};
+        size_type mSize{ 0 };
+        mutable size_t mPicked{ LANES };
+        mutable bool mPickedReady{ false };
+        mutable U32 mCandidates{ 0 };
+    };
 } // namespace LL
 
 
@@ -0,0 +1,294 @@
+/**
+ * @file lltracecapture.cpp
+ * @brief Ring buffer of timed intervals exported as Chrome Trace Event JSON.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lltracecapture.h"
+#include "llfasttimer.h"
+#include "llfile.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+    // One slot of the ring. mSeq is the index the slot was written for plus
+    // one, or zero while a writer owns it, so a reader can discard slots
+    // that were being overwritten as it copied them.
+    struct Event
+    {
+        std::atomic<U64> mSeq{ 0 };
+        const char* mName{ nullptr };
+        U64 mStart{ 0 };
+        U64 mDuration{ 0 };
+        U32 mThread{ 0 };
+    };
+
+    struct Buffer
+    {
+        Buffer(size_t capacity):
+            mEvents(new Event[capacity]),
+            mMask(capacity - 1)
+        {}
+
+        std::unique_ptr<Event[]> mEvents;
+        U64 mMask;
+        std::atomic<U64> mNext{ 0 };
+    };
+
+    struct Snapshot
+    {
+        const char* mName;
+        U64 mStart;
+        U64 mDuration;
+        U32 mThread;
+    };
+
+    // A buffer, once published, is never freed: a thread that checked
+    // isRecording() just before stop() may still be writing into it.
+    std::atomic<Buffer*> sBuffer{ nullptr };
+    std::vector<std::unique_ptr<Buffer>> sBuffers;
+
+    std::mutex sMutex;
+    std::map<U32, std::string> sThreadNames;
+    std::unordered_set<std::string> sNames;
+
+    std::atomic<U32> sThreadCount{ 0 };
+    thread_local U32 sThreadId = 0;
+
+    U32 thread_id()
+    {
+        if (!sThreadId)
+        {
+            sThreadId = ++sThreadCount;
+        }
+        return sThreadId;
+    }
+
+    void write_json_string(std::ostream& out, const char* str)
+    {
+        out << '"';
+        for (const char* p = str; *p; ++p)
+        {
+            const unsigned char c = (unsigned char)*p;
+            if (c == '"' || c == '\\')
+            {
+                out << '\\' << (char)c;
+            }
+            else if (c < 0x20)
+            {
+                out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (U32)c
+                    << std::dec << std::setfill(' ');
+            }
+            else
+            {
+                out << (char)c;
+            }
+        }
+        out << '"';
+    }
+}
+
+namespace LLTrace
+{
+
+std::atomic<bool> TraceCapture::sRecording{ false };
+
+//static
+void TraceCapture::start(size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    std::lock_guard<std::mutex> lock(sMutex);
+    sRecording.store(false, std::memory_order_relaxed);
+    Buffer* buffer = sBuffer.load(std::memory_order_relaxed);
+    if (buffer && buffer->mMask == size - 1)
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            buffer->mEvents[i].mSeq.store(0, std::memory_order_relaxed);
+        }
+        buffer->mNext.store(0, std::memory_order_relaxed);
+    }
+    else
+    {
+        sBuffers.emplace_back(new Buffer(size));
+        buffer = sBuffers.back().get();
+    }
+    sBuffer.store(buffer, std::memory_order_release);
+    sRecording.store(true, std::memory_order_release);
+    LL_INFOS("TraceCapture") << "Recording up to " << size << " events" << LL_ENDL;
+}
+
+//static
+void TraceCapture::stop()
+{
+    if (sRecording.exchange(false))
+    {
+        LL_INFOS("TraceCapture") << "Stopped after " << getRecordedCount() << " events" << LL_ENDL;
+    }
+}
+
+//static
+U64 TraceCapture::getRecordedCount()
+{
+    Buffer* buffer = sBuffer.load(std::memory_order_acquire);
+    return buffer ? buffer->mNext.load(std::memory_order_relaxed) : 0;
+}
+
+//static
+void TraceCapture::setThreadName(const std::string& name)
+{
+    const U32 id = thread_id();
+    std::lock_guard<std::mutex> lock(sMutex);
+    sThreadNames[id] = name;
+}
+
+//static
+const char* TraceCapture::intern(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(sMutex);
+    // unordered_set nodes don't move, so c_str() stays valid
+    return sNames.insert(name).first->c_str();
+}
+
+//static
+U64 TraceCapture::now()
+{
+    return BlockTimer::getCPUClockCount64();
+}
+
+//static
+void TraceCapture::record(const char* name, U64 start, U64 duration)
+{
+    Buffer* buffer = sBuffer.load(std::memory_order_acquire);
+    if (!buffer)
+    {
+        return;
+    }
+    const U64 index = buffer->mNext.fetch_add(1, std::memory_order_relaxed);
+    Event& event = buffer->mEvents[index & buffer->mMask];
+    event.mSeq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.mName = name;
+    event.mStart = start;
+    event.mDuration = duration;
+    event.mThread = thread_id();
+    event.mSeq.store(index + 1, std::memory_order_release);
+}
+
+//static
+size_t TraceCapture::writeChromeTrace(std::ostream& out)
+{
+    std::vector<Snapshot> events;
+    std::map<U32, std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(sMutex);
+        names = sThreadNames;
+    }
+
+    Buffer* buffer = sBuffer.load(std::memory_order_acquire);
+    if (buffer)
+    {
+        const U64 next = buffer->mNext.load(std::memory_order_acquire);
+        const U64 size = buffer->mMask + 1;
+        const U64 first = next > size ? next - size : 0;
+        events.reserve(next - first);
+        for (U64 i = 0; i < size; ++i)
+        {
+            Event& event = buffer->mEvents[i];
+            const U64 seq = event.mSeq.load(std::memory_order_acquire);
+            if (seq <= first || seq > next)
+            {
+                continue;
+            }
+            Snapshot copy{ event.mName, event.mStart, event.mDuration, event.mThread };
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (event.mSeq.load(std::memory_order_relaxed) == seq && copy.mName)
+            {
+                events.push_back(copy);
+            }
+        }
+    }
+    std::sort(events.begin(), events.end(),
+              [](const Snapshot& a, const Snapshot& b) { return a.mStart < b.mStart; });
+
+    // Chrome Trace Event timestamps are in microseconds.
+    const F64 usec_per_count = 1000000.0 / (F64)BlockTimer::countsPerSecond();
+    const U64 base = events.empty() ? 0 : events.front().mStart;
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first_event = true;
+    for (const auto& pair : names)
+    {
+        out << (first_event ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pair.first
+            << ",\"args\":{\"name\":";
+        write_json_string(out, pair.second.c_str());
+        out << "}}";
+        first_event = false;
+    }
+    out << std::fixed << std::setprecision(3);
+    for (const auto& event : events)
+    {
+        out << (first_event ? "" : ",\n") << "{\"name\":";
+        write_json_string(out, event.mName);
+        out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.mThread
+            << ",\"ts\":" << (F64)(event.mStart - base) * usec_per_count
+            << ",\"dur\":" << (F64)event.mDuration * usec_per_count << '}';
+        first_event = false;
+    }
+    out << "\n]}\n";
+    return events.size();
+}
+
+//static
+bool TraceCapture::writeChromeTrace(const std::string& filename)
+{
+    llofstream out(filename.c_str());
+    if (!out.is_open())
+    {
+        LL_WARNS("TraceCapture") << "Unable to open " << filename << LL_ENDL;
+        return false;
+    }
+    const size_t written = writeChromeTrace(out);
+    out.close();
+    LL_INFOS("TraceCapture") << "Wrote " << written << " of " << getRecordedCount()
+                             << " recorded events to " << filename << LL_ENDL;
+    return !out.fail();
+}
+
+}
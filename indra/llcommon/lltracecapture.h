@@ -0,0 +1,112 @@
+/**
+ * @file lltracecapture.h
+ * @brief Records BlockTimer and work-item intervals into a bounded ring
+ *        buffer and writes them out as a Chrome Trace Event file.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTRACECAPTURE_H
+#define LL_LLTRACECAPTURE_H
+
+#include "stdtypes.h"
+#include "llpreprocessor.h"
+
+#include <atomic>
+#include <iosfwd>
+#include <string>
+
+namespace LLTrace
+{
+    /**
+     * TraceCapture keeps the most recent intervals recorded on any thread --
+     * every BlockTimer, plus each work item run by a WorkQueue -- so a
+     * stretch of a session can be inspected as per-thread timelines in
+     * chrome://tracing or ui.perfetto.dev, in builds without Tracy.
+     *
+     * Recording is off until start() is called and costs a single relaxed
+     * load per interval while off. Once started, the buffer holds a fixed
+     * number of events; older events are overwritten by newer ones.
+     */
+    class LL_COMMON_API TraceCapture
+    {
+    public:
+        /// Begin recording into a ring buffer of at least 'capacity' events
+        /// (rounded up to a power of two). Discards any earlier capture.
+        static void start(size_t capacity = 256 * 1024);
+        /// Stop recording. The captured events remain available to write.
+        static void stop();
+        static bool isRecording() { return sRecording.load(std::memory_order_relaxed); }
+
+        /// Write the captured events as Chrome Trace Event JSON. Returns the
+        /// number of events written.
+        static size_t writeChromeTrace(std::ostream& out);
+        static bool writeChromeTrace(const std::string& filename);
+
+        /// Number of events recorded since start(), including any that
+        /// have since been overwritten.
+        static U64 getRecordedCount();
+
+        /// Label the calling thread's timeline.
+        static void setThreadName(const std::string& name);
+
+        /// Return a pointer to a copy of name that lives as long as the
+        /// process, suitable for passing to record().
+        static const char* intern(const std::string& name);
+
+        /// Record an interval on the calling thread. name must outlive the
+        /// capture; start and duration are in BlockTimer clock counts.
+        static void record(const char* name, U64 start, U64 duration);
+
+        /// Current time in BlockTimer clock counts.
+        static U64 now();
+
+    private:
+        static std::atomic<bool> sRecording;
+    };
+
+    /// Records the enclosing scope's duration while a capture is running.
+    class TraceCaptureScope
+    {
+    public:
+        TraceCaptureScope(const char* name):
+            mName(name),
+            mStart(TraceCapture::isRecording() ? TraceCapture::now() : 0)
+        {}
+
+        ~TraceCaptureScope()
+        {
+            if (mStart)
+            {
+                TraceCapture::record(mName, mStart, TraceCapture::now() - mStart);
+            }
+        }
+
+    private:
+        const char* mName;
+        U64 mStart;
+    };
+}
+
+#define LL_TRACE_CAPTURE_SCOPE(name) LLTrace::TraceCaptureScope LL_GLUE_TOKENS(trace_capture_scope, __LINE__)(name)
+
+#endif // LL_LLTRACECAPTURE_H
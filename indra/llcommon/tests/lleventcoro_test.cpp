@@ -333,4 +333,47 @@ namespace tut
         set_test_name("LLEventLogProxyFor<LLEventMailDrop>");
         tut::test< LLEventLogProxyFor<LLEventMailDrop> >();
     }
+
+    template<> template<>
+    void object::test<8>()
+    {
+        set_test_name("coroutine stack reuse");
+        LLCoros::instance().setStackSize(256*1024);
+        // drain the pool so counts below start from a known state
+        LLCoros::trimStackPool();
+        LLCoros::StackStats before(LLCoros::getStackStats());
+        ensure_equals("pool empty", before.mPooled, 0);
+
+        int ran = 0;
+        auto launch = [&ran]()
+        {
+            LLCoros::instance().launch("stackpool", [&ran]() { ++ran; });
+            // let the scheduler reap the terminated fiber
+            llcoro::suspend();
+            llcoro::suspend();
+        };
+        launch();
+        LLCoros::StackStats first(LLCoros::getStackStats());
+        ensure_equals("ran", ran, 1);
+        ensure_equals("fresh stack", first.mAllocated, before.mAllocated + 1);
+        ensure_equals("no longer live", first.mLive, before.mLive);
+        ensure_equals("kept for reuse", first.mPooled, 1);
+        ensure("peak", first.mPeak > before.mLive);
+
+        launch();
+        LLCoros::StackStats second(LLCoros::getStackStats());
+        ensure_equals("ran again", ran, 2);
+        ensure_equals("reused", second.mReused, first.mReused + 1);
+        ensure_equals("no new stack", second.mAllocated, first.mAllocated);
+        ensure_equals("returned", second.mPooled, 1);
+
+        // with pooling off, stacks are released as coroutines end
+        LLCoros::setStackPoolLimit(0);
+        ensure_equals("limit trims", LLCoros::getStackStats().mPooled, 0);
+        launch();
+        LLCoros::StackStats third(LLCoros::getStackStats());
+        ensure_equals("fresh again", third.mAllocated, second.mAllocated + 1);
+        ensure_equals("not pooled", third.mPooled, 0);
+        LLCoros::setStackPoolLimit(32*1024*1024);
+    }
 }
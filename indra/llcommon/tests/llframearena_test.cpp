@@ -0,0 +1,171 @@
+/**
+ * @file   llframearena_test.cpp
+ * @date   2026-10-18
+ * @brief  Test for llframearena.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llframearena.h"
+// STL headers
+#include <string>
+// std headers
+#include <cstring>
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct llframearena_data
+    {
+    };
+    typedef test_group<llframearena_data> llframearena_group;
+    typedef llframearena_group::object object;
+    llframearena_group llframearenagrp("llframearena");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("bump allocation and reset");
+        LLFrameArena arena(4096);
+        ensure_equals("no block until used", arena.getCapacity(), 0);
+        char* a = (char*)arena.allocate(10, 1);
+        char* b = (char*)arena.allocate(8, 8);
+        ensure("contiguous", b >= a + 10 && b < a + 24);
+        ensure_equals("aligned", (uintptr_t)b % 8, 0);
+        void* c = arena.allocate(1, 64);
+        ensure_equals("aligned 64", (uintptr_t)c % 64, 0);
+        ensure_equals("allocations", arena.getAllocationCount(), 3);
+        ensure_equals("capacity", arena.getCapacity(), 4096);
+
+        // releasing the top allocation rewinds over it
+        size_t used = arena.getBytesUsed();
+        void* d = arena.allocate(100, 1);
+        arena.deallocate(d, 100);
+        ensure_equals("rewound", arena.getBytesUsed(), used);
+
+        arena.reset();
+        ensure_equals("reset", arena.getBytesUsed(), 0);
+        ensure_equals("last frame", arena.getLastFrameBytes(), used);
+        ensure("reused", arena.allocate(10, 1) == a);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("overflow consolidates into one block");
+        LLFrameArena arena(1024);
+        for (int i = 0; i < 10; ++i)
+        {
+            arena.allocate(512);
+        }
+        void* big = arena.allocate(5000);
+        ensure("oversized allocation", big != NULL);
+        ensure_equals("overflows", arena.getOverflowCount(), 1);
+        ensure("multiple blocks", arena.getCapacity() > 5000);
+        const size_t used = arena.getBytesUsed();
+        ensure("used", used >= 10 * 512 + 5000);
+
+        arena.reset();
+        ensure_equals("high water", arena.getHighWater(), used);
+        ensure("one block holds a frame", arena.getCapacity() >= used);
+        const size_t capacity = arena.getCapacity();
+        for (int i = 0; i < 10; ++i)
+        {
+            arena.allocate(512);
+        }
+        arena.allocate(5000);
+        ensure_equals("no further overflow", arena.getOverflowCount(), 1);
+        arena.reset();
+        ensure_equals("capacity stable", arena.getCapacity(), capacity);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("poisoning");
+        LLFrameArena arena(1024);
+        arena.setPoison(true);
+        U8* p = (U8*)arena.allocate(16, 1);
+        ensure_equals("fresh fill", p[0], 0xCD);
+        ensure_equals("fresh fill end", p[15], 0xCD);
+        p[0] = 1;
+        arena.reset();
+        ensure_equals("released fill", p[0], 0xDD);
+        ensure_equals("released fill end", p[15], 0xDD);
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("LLFrameVector");
+        LLFrameArena arena(64 * 1024);
+        LLFrameVector<std::string> strings{ LLFrameAllocator<std::string>(arena) };
+        LLFrameVector<U32> numbers{ LLFrameAllocator<U32>(arena) };
+        for (U32 i = 0; i < 1000; ++i)
+        {
+            numbers.push_back(i);
+            strings.push_back(std::string(40, 'a' + i % 26));
+        }
+        ensure("drawn from arena", arena.getBytesUsed() >= 1000 * (sizeof(U32) + sizeof(std::string)));
+        U64 sum = 0;
+        for (U32 n : numbers)
+        {
+            sum += n;
+        }
+        ensure_equals("contents", sum, 999 * 1000 / 2);
+        ensure_equals("strings", strings[27], std::string(40, 'b'));
+        ensure("rebound allocators compare equal",
+               LLFrameAllocator<U32>(arena) == LLFrameAllocator<std::string>(arena));
+        ensure("different arenas", LLFrameAllocator<U32>(arena) != LLFrameAllocator<U32>());
+        strings.clear();
+        strings.shrink_to_fit();
+        numbers.clear();
+        numbers.shrink_to_fit();
+        arena.reset();
+    }
+
+    template<> template<>
+    void object::test<5>()
+    {
+        set_test_name("aligned allocation after a full odd-sized block");
+        LLFrameArena arena(1000);
+        arena.allocate(8);
+        char* big = (char*)arena.allocate(5001, 1);
+        ensure("oversized allocation", big != NULL);
+        const size_t capacity = arena.getCapacity();
+        char* next = (char*)arena.allocate(64, 64);
+        ensure_equals("aligned", (uintptr_t)next % 64, 0);
+        ensure("past the big allocation", next >= big + 5001 || next + 64 <= big);
+        ensure("from a new block", arena.getCapacity() > capacity);
+        memset(next, 0, 64);
+        arena.reset();
+        ensure_equals("block size rounded", arena.getCapacity() % LLFrameArena::MAX_ALIGNMENT, 0);
+    }
+} // namespace tut
@@ -0,0 +1,200 @@
+/**
+ * @file   lllockfreequeue_test.cpp
+ * @date   2026-10-18
+ * @brief  Test for lllockfreequeue.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "lllockfreequeue.h"
+// STL headers
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+// std headers
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct lllockfreequeue_data
+    {
+    };
+    typedef test_group<lllockfreequeue_data> lllockfreequeue_group;
+    typedef lllockfreequeue_group::object object;
+    lllockfreequeue_group lllockfreequeuegrp("lllockfreequeue");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("push, pop, capacity");
+        LLLockFreeQueue<std::string> queue(3);
+        queue.push("one");
+        ensure("tryPush", queue.tryPush(std::string("two")));
+        ensure("pushIfOpen", queue.pushIfOpen(std::string("three")));
+        ensure_equals("size", queue.size(), 3);
+        ensure_not("tryPush when full", queue.tryPush(std::string("four")));
+        ensure_not("tryPushFor when full",
+                   queue.tryPushFor(std::chrono::milliseconds(10), std::string("four")));
+        // a single producer's items come out in order
+        ensure_equals("pop", queue.pop(), "one");
+        std::string item;
+        ensure("tryPop", queue.tryPop(item));
+        ensure_equals("tryPop item", item, "two");
+        ensure("tryPopFor", queue.tryPopFor(std::chrono::milliseconds(10), item));
+        ensure_equals("tryPopFor item", item, "three");
+        ensure_not("tryPop when empty", queue.tryPop(item));
+        ensure_not("tryPopFor when empty", queue.tryPopFor(std::chrono::milliseconds(10), item));
+        ensure_equals("empty", queue.size(), 0);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("close");
+        LLLockFreeQueue<int> queue;
+        queue.push(1);
+        queue.push(2);
+        queue.close();
+        ensure("isClosed", queue.isClosed());
+        ensure_not("done with items left", queue.done());
+        ensure_not("tryPush after close", queue.tryPush(3));
+        ensure_not("pushIfOpen after close", queue.pushIfOpen(3));
+        bool threw = false;
+        try
+        {
+            queue.push(3);
+        }
+        catch (const LLThreadSafeQueueInterrupt&)
+        {
+            threw = true;
+        }
+        ensure("push after close throws", threw);
+        // consumers still drain what was queued
+        ensure_equals("drain 1", queue.pop(), 1);
+        int item = 0;
+        ensure("drain 2", queue.tryPop(item));
+        ensure_equals("drain 2 item", item, 2);
+        ensure("done", queue.done());
+        threw = false;
+        try
+        {
+            queue.pop();
+        }
+        catch (const LLThreadSafeQueueInterrupt&)
+        {
+            threw = true;
+        }
+        ensure("pop when done throws", threw);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("close wakes blocked consumers");
+        LLLockFreeQueue<int> queue;
+        std::atomic<int> interrupted{ 0 };
+        std::vector<std::thread> consumers;
+        for (int i = 0; i < 3; ++i)
+        {
+            consumers.emplace_back([&queue, &interrupted]()
+                {
+                    try
+                    {
+                        queue.pop();
+                    }
+                    catch (const LLThreadSafeQueueInterrupt&)
+                    {
+                        ++interrupted;
+                    }
+                });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        queue.close();
+        for (auto& consumer : consumers)
+        {
+            consumer.join();
+        }
+        ensure_equals("interrupted", interrupted.load(), 3);
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("many producers, many consumers");
+        // small capacity so producers also block on a full queue
+        LLLockFreeQueue<U64> queue(64);
+        const U64 per_producer = 20000;
+        const int producers = 6, consumers = 3;
+        std::atomic<U64> sum{ 0 }, count{ 0 };
+        std::vector<std::thread> threads;
+        for (int c = 0; c < consumers; ++c)
+        {
+            threads.emplace_back([&]()
+                {
+                    try
+                    {
+                        for (;;)
+                        {
+                            sum += queue.pop();
+                            ++count;
+                        }
+                    }
+                    catch (const LLThreadSafeQueueInterrupt&)
+                    {
+                    }
+                });
+        }
+        std::vector<std::thread> pushers;
+        for (int p = 0; p < producers; ++p)
+        {
+            pushers.emplace_back([&queue, p, per_producer]()
+                {
+                    for (U64 i = 1; i <= per_producer; ++i)
+                    {
+                        queue.push(U64(p) * per_producer + i);
+                    }
+                });
+        }
+        for (auto& pusher : pushers)
+        {
+            pusher.join();
+        }
+        queue.close();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        const U64 total = producers * per_producer;
+        ensure_equals("count", count.load(), total);
+        ensure_equals("sum", sum.load(), total * (total + 1) / 2);
+        ensure("done", queue.done());
+    }
+} // namespace tut
@@ -27,6 +27,7 @@
 // other Linden headers
 #include "../test/lltut.h"
 #include "../test/namedtempfile.h"
+#include "../test/namedtempdir.h"
 #include "../test/catch_and_store_what_in.h"
 #include "stringize.h"
 #include "llsdutil.h"
@@ -239,32 +240,6 @@ static std::string python_out(const std::string& desc, const CONTENT& script)
     return py.run_read();
 }
 
-/// Create a temporary directory and clean it up later.
-class NamedTempDir: public boost::noncopyable
-{
-public:
-    NamedTempDir():
-        mPath(NamedTempFile::temp_path()),
-        mCreated(boost::filesystem::create_directories(mPath))
-    {
-        mPath = boost::filesystem::canonical(mPath);
-    }
-
-    ~NamedTempDir()
-    {
-        if (mCreated)
-        {
-            boost::filesystem::remove_all(mPath);
-        }
-    }
-
-    std::string getName() const { return mPath.string(); }
-
-private:
-    boost::filesystem::path mPath;
-    bool mCreated;
-};
-
 /*****************************************************************************
 *   TUT
 *****************************************************************************/
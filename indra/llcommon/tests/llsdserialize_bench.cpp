@@ -0,0 +1,547 @@
+/**
+ * @file   llsdserialize_bench.cpp
+ * @date   2026-10-18
+ * @brief  Throughput and allocation benchmark for the LLSD serialization formats.
+ *
+ * Not a regression test: build the llsdserialize_bench target and run it by
+ * hand before and after touching a parser or formatter. Every corpus is
+ * generated from a fixed seed, so numbers are comparable between builds.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "lldate.h"
+#include "llsd.h"
+#include "llsdjson.h"
+#include "llsdserialize.h"
+#include "llsdutil.h"
+#include "llsdview.h"
+#include "lluuid.h"
+
+/*****************************************************************************
+*   Allocation counting
+*****************************************************************************/
+// Tracy memory profiling builds replace the global operators in llcommon.
+#if (TRACY_ENABLE) && LL_PROFILER_ENABLE_TRACY_MEMORY
+#define LL_BENCH_COUNT_ALLOCATIONS 0
+#else
+#define LL_BENCH_COUNT_ALLOCATIONS 1
+#endif
+
+static std::atomic<U64> sAllocations{ 0 };
+
+#if LL_BENCH_COUNT_ALLOCATIONS
+void* operator new(size_t size)
+{
+    ++sAllocations;
+    if (void* ptr = malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+#endif
+
+/*****************************************************************************
+*   Corpora
+*****************************************************************************/
+namespace
+{
+    typedef std::mt19937 Random;
+
+    LLUUID random_uuid(Random& rng)
+    {
+        LLUUID id;
+        for (S32 i = 0; i < UUID_BYTES; i += 4)
+        {
+            U32 bits = rng();
+            memcpy(&id.mData[i], &bits, 4);
+        }
+        return id;
+    }
+
+    std::string random_name(Random& rng, size_t min_len, size_t max_len)
+    {
+        static const char letters[] = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_'&<>\"";
+        std::uniform_int_distribution<size_t> length(min_len, max_len);
+        std::uniform_int_distribution<size_t> letter(0, sizeof(letters) - 2);
+        std::string name(length(rng), ' ');
+        for (char& c : name)
+        {
+            c = letters[letter(rng)];
+        }
+        return name;
+    }
+
+    // Shaped like the login response's inventory-skeleton array.
+    LLSD make_inventory_skeleton(Random& rng, S32 scale)
+    {
+        LLSD skeleton = LLSD::emptyArray();
+        std::vector<LLUUID> folders{ random_uuid(rng) };
+        for (S32 i = 0; i < 2000 * scale; ++i)
+        {
+            LLSD folder;
+            folder["folder_id"] = random_uuid(rng);
+            folder["parent_id"] = folders[rng() % folders.size()];
+            folder["name"] = random_name(rng, 4, 40);
+            folder["type_default"] = S32(rng() % 60) - 1;
+            folder["version"] = S32(rng() % 5000);
+            folders.push_back(folder["folder_id"].asUUID());
+            skeleton.append(folder);
+        }
+        return skeleton;
+    }
+
+    // Shaped like the binary headers at the front of every mesh asset.
+    LLSD make_mesh_headers(Random& rng, S32 scale)
+    {
+        static const char* blocks[] =
+        {
+            "lowest_lod", "low_lod", "medium_lod", "high_lod",
+            "skin", "physics_convex", "physics_mesh"
+        };
+        LLSD headers = LLSD::emptyArray();
+        for (S32 i = 0; i < 500 * scale; ++i)
+        {
+            LLSD header;
+            header["version"] = 1;
+            header["creator"] = random_uuid(rng);
+            header["date"] = LLDate(1.6e9 + (rng() % 100000000));
+            S32 offset = 0;
+            for (const char* block : blocks)
+            {
+                S32 size = 64 + S32(rng() % 65536);
+                header[block]["offset"] = offset;
+                header[block]["size"] = size;
+                offset += size;
+            }
+            headers.append(header);
+        }
+        return headers;
+    }
+
+    // Shaped like a batch of ObjectProperties capability results.
+    LLSD make_object_properties(Random& rng, S32 scale)
+    {
+        LLSD properties;
+        LLSD& objects = properties["ObjectData"];
+        for (S32 i = 0; i < 500 * scale; ++i)
+        {
+            LLSD object;
+            object["ObjectID"] = random_uuid(rng);
+            object["OwnerID"] = random_uuid(rng);
+            object["CreatorID"] = random_uuid(rng);
+            object["GroupID"] = random_uuid(rng);
+            object["LastOwnerID"] = random_uuid(rng);
+            object["Name"] = random_name(rng, 6, 63);
+            object["Description"] = random_name(rng, 0, 127);
+            object["TouchName"] = random_name(rng, 0, 9);
+            object["SitName"] = random_name(rng, 0, 9);
+            object["CreationDate"] = LLDate(1.3e9 + (rng() % 400000000));
+            object["BaseMask"] = S32(rng());
+            object["OwnerMask"] = S32(rng());
+            object["GroupMask"] = S32(rng());
+            object["EveryoneMask"] = S32(rng());
+            object["NextOwnerMask"] = S32(rng());
+            object["OwnershipCost"] = 0;
+            object["SaleType"] = S32(rng() % 4);
+            object["SalePrice"] = S32(rng() % 1000);
+            object["AggregatePerms"] = S32(rng() % 256);
+            object["Category"] = 0;
+            object["InventorySerial"] = S32(rng() % 100);
+            object["ItemID"] = LLUUID::null;
+            object["FolderID"] = LLUUID::null;
+            object["FromTaskID"] = LLUUID::null;
+            LLSD::Binary texture_entry(40 + rng() % 400);
+            for (U8& byte : texture_entry)
+            {
+                byte = U8(rng());
+            }
+            object["TextureEntry"] = texture_entry;
+            objects.append(object);
+        }
+        return properties;
+    }
+
+    struct Corpus
+    {
+        const char* mName;
+        bool mHasBinary;
+        std::function<LLSD(Random&, S32)> mMake;
+    };
+
+    const std::vector<Corpus>& corpora()
+    {
+        static const std::vector<Corpus> sCorpora
+        {
+            { "inventory", false, make_inventory_skeleton },
+            { "meshheader", false, make_mesh_headers },
+            { "objectprops", true, make_object_properties }
+        };
+        return sCorpora;
+    }
+
+    S32 count_nodes(const LLSD& sd)
+    {
+        S32 count = 1;
+        if (sd.isMap())
+        {
+            for (const auto& pair : llsd::inMap(sd))
+            {
+                count += count_nodes(pair.second);
+            }
+        }
+        else if (sd.isArray())
+        {
+            for (const auto& child : llsd::inArray(sd))
+            {
+                count += count_nodes(child);
+            }
+        }
+        return count;
+    }
+
+/*****************************************************************************
+*   Formats
+*****************************************************************************/
+    struct Format
+    {
+        const char* mName;
+        bool mSupportsBinary;
+        // false when parse() only indexes and doesn't produce an LLSD to compare
+        bool mRoundTrips;
+        std::function<void(const LLSD&, std::string&)> mFormat;
+        std::function<bool(const std::string&, LLSD&)> mParse;
+    };
+
+    const std::vector<Format>& formats()
+    {
+        static const std::vector<Format> sFormats
+        {
+            { "xml", true, true,
+              [](const LLSD& sd, std::string& out)
+              {
+                  std::ostringstream ostr;
+                  LLSDSerialize::toXML(sd, ostr);
+                  out = ostr.str();
+              },
+              [](const std::string& in, LLSD& sd)
+              {
+                  std::istringstream istr(in);
+                  return LLSDSerialize::fromXML(sd, istr) > 0;
+              } },
+            { "notation", true, true,
+              [](const LLSD& sd, std::string& out)
+              {
+                  std::ostringstream ostr;
+                  LLSDSerialize::toNotation(sd, ostr);
+                  out = ostr.str();
+              },
+              [](const std::string& in, LLSD& sd)
+              {
+                  std::istringstream istr(in);
+                  return LLSDSerialize::fromNotation(sd, istr, in.size()) > 0;
+              } },
+            { "binary", true, true,
+              [](const LLSD& sd, std::string& out)
+              {
+                  std::ostringstream ostr;
+                  LLSDSerialize::toBinary(sd, ostr);
+                  out = ostr.str();
+              },
+              [](const std::string& in, LLSD& sd)
+              {
+                  std::istringstream istr(in);
+                  return LLSDSerialize::fromBinary(sd, istr, in.size()) > 0;
+              } },
+            { "binaryview", true, true,
+              [](const LLSD& sd, std::string& out)
+              {
+                  std::ostringstream ostr;
+                  LLSDSerialize::toBinary(sd, ostr);
+                  out = ostr.str();
+              },
+              [](const std::string& in, LLSD& sd)
+              {
+                  LLPointer<LLSDViewBuffer> buffer =
+                      new LLSDViewBuffer((const U8*)in.data(), in.size());
+                  sd = buffer->root().toLLSD();
+                  return sd.isDefined();
+              } },
+            { "binaryindex", true, false,
+              [](const LLSD& sd, std::string& out)
+              {
+                  std::ostringstream ostr;
+                  LLSDSerialize::toBinary(sd, ostr);
+                  out = ostr.str();
+              },
+              [](const std::string& in, LLSD&)
+              {
+                  LLPointer<LLSDViewBuffer> buffer =
+                      new LLSDViewBuffer((const U8*)in.data(), in.size());
+                  return buffer->index();
+              } },
+            { "json", false, false,
+              [](const LLSD& sd, std::string& out)
+              {
+                  out = boost::json::serialize(LlsdToJson(sd));
+              },
+              [](const std::string& in, LLSD& sd)
+              {
+                  boost::json::error_code ec;
+                  boost::json::value value = boost::json::parse(in, ec);
+                  if (ec)
+                  {
+                      return false;
+                  }
+                  sd = LlsdFromJson(value);
+                  return true;
+              } },
+            { "zip", true, true,
+              [](const LLSD& sd, std::string& out)
+              {
+                  LLSD copy(sd);
+                  out = zip_llsd(copy);
+              },
+              [](const std::string& in, LLSD& sd)
+              {
+                  return LLUZipHelper::unzip_llsd(sd, (const U8*)in.data(), (S32)in.size())
+                      == LLUZipHelper::ZR_OK;
+              } }
+        };
+        return sFormats;
+    }
+
+/*****************************************************************************
+*   Driver
+*****************************************************************************/
+    struct Options
+    {
+        S32 mIterations = 20;
+        S32 mScale = 1;
+        U32 mSeed = 1;
+        std::string mCorpus;
+        std::string mFormat;
+        bool mCSV = false;
+    };
+
+    struct Result
+    {
+        F64 mSeconds = 0.0;
+        U64 mAllocations = 0;
+        bool mOK = true;
+    };
+
+    Result measure(S32 iterations, const std::function<bool()>& step)
+    {
+        // one untimed pass to settle caches and lazily initialized statics
+        Result result;
+        result.mOK = step();
+        const U64 allocations = sAllocations;
+        const auto start = std::chrono::steady_clock::now();
+        for (S32 i = 0; i < iterations && result.mOK; ++i)
+        {
+            result.mOK = step();
+        }
+        const auto stop = std::chrono::steady_clock::now();
+        result.mSeconds = std::chrono::duration<F64>(stop - start).count();
+        result.mAllocations = (sAllocations - allocations) / std::max(iterations, 1);
+        return result;
+    }
+
+    void report(const Options& options, const char* corpus, const char* format,
+                const char* direction, size_t bytes, S32 nodes, const Result& result)
+    {
+        const F64 per_iteration = result.mSeconds / std::max(options.mIterations, 1);
+        const F64 mb_per_sec = per_iteration > 0.0 ? (bytes / 1048576.0) / per_iteration : 0.0;
+        const F64 knodes_per_sec = per_iteration > 0.0 ? (nodes / 1000.0) / per_iteration : 0.0;
+        if (options.mCSV)
+        {
+            std::cout << corpus << ',' << format << ',' << direction << ',' << bytes << ','
+                      << nodes << ',' << per_iteration * 1000.0 << ',' << mb_per_sec << ','
+                      << knodes_per_sec << ',';
+            if (LL_BENCH_COUNT_ALLOCATIONS)
+            {
+                std::cout << result.mAllocations;
+            }
+            std::cout << ',' << (result.mOK ? "ok" : "FAILED") << '\n';
+            return;
+        }
+        std::cout << std::left << std::setw(12) << corpus << std::setw(12) << format
+                  << std::setw(7) << direction << std::right << std::fixed
+                  << std::setprecision(1) << std::setw(10) << bytes / 1024.0 << " KB"
+                  << std::setprecision(3) << std::setw(10) << per_iteration * 1000.0 << " ms"
+                  << std::setprecision(1) << std::setw(9) << mb_per_sec << " MB/s"
+                  << std::setw(10) << knodes_per_sec << " Knodes/s";
+        if (LL_BENCH_COUNT_ALLOCATIONS)
+        {
+            std::cout << std::setw(10) << result.mAllocations << " allocs";
+        }
+        if (!result.mOK)
+        {
+            std::cout << "  FAILED";
+        }
+        std::cout << '\n';
+    }
+
+    void usage(std::ostream& out, const char* program)
+    {
+        out << "usage: " << program << " [options]\n"
+            << "  --iterations N   timed passes per measurement (default 20)\n"
+            << "  --scale N        corpus size multiplier (default 1)\n"
+            << "  --seed N         corpus generator seed (default 1)\n"
+            << "  --corpus NAME    only this corpus:";
+        for (const Corpus& corpus : corpora())
+        {
+            out << ' ' << corpus.mName;
+        }
+        out << "\n  --format NAME    only this format:";
+        for (const Format& format : formats())
+        {
+            out << ' ' << format.mName;
+        }
+        out << "\n  --csv            comma separated output\n";
+    }
+
+    bool parse_options(int argc, char** argv, Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg(argv[i]);
+            const bool has_value = i + 1 < argc;
+            if (arg == "--iterations" && has_value)
+            {
+                options.mIterations = atoi(argv[++i]);
+            }
+            else if (arg == "--scale" && has_value)
+            {
+                options.mScale = atoi(argv[++i]);
+            }
+            else if (arg == "--seed" && has_value)
+            {
+                options.mSeed = (U32)strtoul(argv[++i], NULL, 10);
+            }
+            else if (arg == "--corpus" && has_value)
+            {
+                options.mCorpus = argv[++i];
+            }
+            else if (arg == "--format" && has_value)
+            {
+                options.mFormat = argv[++i];
+            }
+            else if (arg == "--csv")
+            {
+                options.mCSV = true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return options.mIterations > 0 && options.mScale > 0;
+    }
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parse_options(argc, argv, options))
+    {
+        usage(std::cerr, argv[0]);
+        return 1;
+    }
+
+    if (options.mCSV)
+    {
+        std::cout << "corpus,format,direction,bytes,nodes,ms,MB/s,Knodes/s,allocs,status\n";
+    }
+
+    bool all_ok = true;
+    for (const Corpus& corpus : corpora())
+    {
+        if (!options.mCorpus.empty() && options.mCorpus != corpus.mName)
+        {
+            continue;
+        }
+        Random rng(options.mSeed);
+        const LLSD data = corpus.mMake(rng, options.mScale);
+        const S32 nodes = count_nodes(data);
+
+        for (const Format& format : formats())
+        {
+            if (!options.mFormat.empty() && options.mFormat != format.mName)
+            {
+                continue;
+            }
+            if (corpus.mHasBinary && !format.mSupportsBinary)
+            {
+                continue;
+            }
+
+            std::string serialized;
+            Result formatted = measure(options.mIterations, [&]()
+                {
+                    format.mFormat(data, serialized);
+                    return !serialized.empty();
+                });
+            report(options, corpus.mName, format.mName, "format", serialized.size(), nodes, formatted);
+
+            LLSD parsed;
+            Result parse_result = measure(options.mIterations, [&]()
+                {
+                    parsed.clear();
+                    return format.mParse(serialized, parsed);
+                });
+            if (parse_result.mOK && format.mRoundTrips && !llsd_equals(parsed, data))
+            {
+                parse_result.mOK = false;
+            }
+            report(options, corpus.mName, format.mName, "parse", serialized.size(), nodes, parse_result);
+            all_ok = all_ok && formatted.mOK && parse_result.mOK;
+        }
+    }
+    return all_ok ? 0 : 1;
+}
@@ -858,6 +858,30 @@ namespace tut
     }
 
 
+    template<> template<>
+    void TestLLSDXMLParsingObject::test<6>()
+    {
+        // lines longer than the parser's read buffer, mixed line endings,
+        // and text after the document that must be left on the stream
+        std::string long_text(3000, 'x');
+        long_text[1500] = '&';
+        LLSD v;
+        v["long"] = long_text;
+        v["short"] = "y";
+        std::string escaped(long_text);
+        escaped.replace(1500, 1, "&amp;");
+        std::stringstream input;
+        input << "<llsd><map><key>long</key><string>" << escaped << "</string>\r\n"
+              << "<key>short</key>\r<string>y</string>\n</map></llsd>\n"
+              << "trailing";
+        LLSD parsed;
+        ensure("parse", LLSDSerialize::fromXMLEmbedded(parsed, input) > 0);
+        ensure_equals("long lines", parsed, v);
+        std::string rest;
+        std::getline(input, rest);
+        ensure_equals("stream left after document", rest, "trailing");
+    }
+
     /*
     TODO:
         test XML parsing
@@ -1259,6 +1283,39 @@ namespace tut
             9);
     }
 
+    template<> template<>
+    void TestLLSDNotationParsingObject::test<22>()
+    {
+        // strings long enough to exercise the vectorized scan, with escapes
+        // and delimiters landing on and around the 16 and 32 byte boundaries
+        for (size_t pos = 0; pos < 70; ++pos)
+        {
+            std::string plain(70, 'a');
+            std::string quoted(plain);
+            plain[pos] = '\'';
+            quoted.replace(pos, 1, "\\'");
+            std::string hex(plain);
+            hex[pos] = '\n';
+            std::string hex_quoted(std::string(70, 'a').replace(pos, 1, "\\x0a"));
+
+            LLSD val;
+            val[plain] = hex;
+            ensureParse(
+                llformat("escapes at %d", (S32)pos),
+                "{'" + quoted + "':'" + hex_quoted + "'}",
+                val,
+                2);
+        }
+
+        std::string long_string(100000, 'z');
+        ensureParse("long string", "\"" + long_string + "\"", LLSD(long_string), 1);
+        ensureParse(
+            "unterminated long string",
+            "\"" + long_string,
+            LLSD(),
+            LLSDParser::PARSE_FAILURE);
+    }
+
     /**
      * @class TestLLSDBinaryParsing
      * @brief Concrete instance of a parse tester.
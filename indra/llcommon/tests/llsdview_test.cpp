@@ -0,0 +1,208 @@
+/**
+ * @file   llsdview_test.cpp
+ * @date   2026-10-18
+ * @brief  Test for llsdview.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llsdview.h"
+// STL headers
+#include <sstream>
+// std headers
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+#include "../test/namedtempfile.h"
+#include "llsdserialize.h"
+#include "llsdutil.h"
+
+namespace
+{
+    std::vector<U8> to_binary(const LLSD& sd)
+    {
+        std::ostringstream ostr;
+        LLSDSerialize::toBinary(sd, ostr);
+        std::string str(ostr.str());
+        return std::vector<U8>(str.begin(), str.end());
+    }
+
+    LLSD sample()
+    {
+        LLSD sd;
+        sd["version"] = 1;
+        sd["name"] = "mesh";
+        sd["scale"] = 2.5;
+        sd["enabled"] = true;
+        sd["creator"] = LLUUID("c96f9b1e-f589-4100-9774-d98643ce0bed");
+        sd["when"] = LLDate(1234567890.0);
+        sd["where"] = LLURI("http://example.com/path");
+        sd["blob"] = LLSD::Binary{ 0, 1, 2, 3, 255 };
+        sd["nothing"] = LLSD();
+        sd["high_lod"]["offset"] = 40;
+        sd["high_lod"]["size"] = 1024;
+        sd["list"].append(3);
+        sd["list"].append("four");
+        sd["list"].append(LLSD::emptyMap());
+        sd["list"][3]["deep"]["deeper"] = LLSD::emptyArray();
+        return sd;
+    }
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct llsdview_data
+    {
+    };
+    typedef test_group<llsdview_data> llsdview_group;
+    typedef llsdview_group::object object;
+    llsdview_group llsdviewgrp("llsdview");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("scalar access");
+        std::vector<U8> bytes = to_binary(sample());
+        LLPointer<LLSDViewBuffer> buffer = new LLSDViewBuffer(bytes.data(), bytes.size());
+        LLSDView root = buffer->root();
+        ensure("root not map", root.isMap());
+        ensure_equals("size", root.size(), sample().size());
+        ensure_equals("integer", root["version"].asInteger(), 1);
+        ensure_equals("string", root["name"].asString(), "mesh");
+        ensure_equals("string view", std::string(root["name"].asStringView()), "mesh");
+        ensure_equals("real", root["scale"].asReal(), 2.5);
+        ensure("boolean", root["enabled"].asBoolean());
+        ensure_equals("uuid", root["creator"].asUUID(), LLUUID("c96f9b1e-f589-4100-9774-d98643ce0bed"));
+        ensure_equals("date", root["when"].asDate().secondsSinceEpoch(), 1234567890.0);
+        ensure_equals("uri", root["where"].asURI().asString(), "http://example.com/path");
+        ensure("binary", root["blob"].asBinary() == LLSD::Binary({ 0, 1, 2, 3, 255 }));
+        ensure("explicit undef", root.has("nothing") && root["nothing"].isUndefined());
+        ensure("missing key", !root.has("missing") && root["missing"].isUndefined());
+        // conversions match LLSD's
+        ensure_equals("integer as string", root["version"].asString(), "1");
+        ensure_equals("real as integer", root["scale"].asInteger(), 2);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("nested access");
+        std::vector<U8> bytes = to_binary(sample());
+        LLPointer<LLSDViewBuffer> buffer = new LLSDViewBuffer(std::move(bytes));
+        LLSDView root = buffer->root();
+        ensure_equals("nested map", root["high_lod"]["size"].asInteger(), 1024);
+        LLSDView list = root["list"];
+        ensure("array", list.isArray());
+        ensure_equals("array size", list.size(), 4);
+        ensure_equals("array integer", list[0].asInteger(), 3);
+        ensure_equals("array string", list[1].asString(), "four");
+        ensure("empty map", list[2].isMap() && list[2].size() == 0);
+        ensure("deep", list[3]["deep"]["deeper"].isArray());
+        ensure("out of range", list[4].isUndefined());
+        ensure("index into map", root[0].isUndefined());
+        ensure("key into array", list["deep"].isUndefined());
+
+        S32 count = 0;
+        for (LLSDView::const_iterator it = root.beginMap(), end = root.endMap(); it != end; ++it)
+        {
+            ensure(std::string(it.key()), sample().has(std::string(it.key())));
+            ++count;
+        }
+        ensure_equals("map iteration", count, sample().size());
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("toLLSD round trip");
+        LLSD expected = sample();
+        std::vector<U8> bytes = to_binary(expected);
+        LLPointer<LLSDViewBuffer> buffer = new LLSDViewBuffer(bytes.data(), bytes.size());
+        ensure("index", buffer->index());
+        ensure_equals("byte size", buffer->root().byteSize(), bytes.size());
+        ensure("whole", llsd_equals(buffer->root().toLLSD(), expected));
+        ensure("subtree", llsd_equals(buffer->root()["list"].toLLSD(), expected["list"]));
+        ensure("too deep", buffer->root().toLLSD(3).isUndefined());
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("notation-style strings");
+        // Binary LLSD secretly accepts quoted notation strings for keys and
+        // values; LLSDBinaryParser handles escapes in both.
+        static const char raw_bytes[] = "{\0\0\0\x02'a\\'b'\"x\\x41y\"k\0\0\0\x01z'q'}";
+        const std::string raw(raw_bytes, sizeof(raw_bytes) - 1);
+        LLPointer<LLSDViewBuffer> buffer =
+            new LLSDViewBuffer((const U8*)raw.data(), raw.size());
+        LLSDView root = buffer->root();
+        ensure_equals("escaped key and value", root["a'b"].asString(), "xAy");
+        ensure_equals("plain key, quoted value", root["z"].asString(), "q");
+
+        std::istringstream istr(raw);
+        LLSD parsed;
+        LLSDSerialize::fromBinary(parsed, istr, raw.size());
+        ensure("matches parser", llsd_equals(root.toLLSD(), parsed));
+    }
+
+    template<> template<>
+    void object::test<5>()
+    {
+        set_test_name("malformed data");
+        std::vector<U8> bytes = to_binary(sample());
+        // every truncation must be rejected without reading past the end
+        for (size_t length = 0; length < bytes.size(); ++length)
+        {
+            LLPointer<LLSDViewBuffer> buffer = new LLSDViewBuffer(bytes.data(), length);
+            ensure("truncated index", !buffer->index());
+            ensure("truncated toLLSD", buffer->root().toLLSD().isUndefined());
+            ensure_equals("truncated byte size", buffer->root().byteSize(), 0);
+        }
+
+        // a huge declared element count with nothing behind it
+        static const char huge_bytes[] = "[\x7f\xff\xff\xff]";
+        const std::string huge(huge_bytes, sizeof(huge_bytes) - 1);
+        LLPointer<LLSDViewBuffer> buffer =
+            new LLSDViewBuffer((const U8*)huge.data(), huge.size());
+        ensure("bogus count", !buffer->index());
+        ensure("bogus element", buffer->root()[1].isUndefined());
+    }
+
+    template<> template<>
+    void object::test<6>()
+    {
+        set_test_name("mapped file");
+        std::vector<U8> bytes = to_binary(sample());
+        NamedTempFile file("llsdview", std::string(bytes.begin(), bytes.end()));
+        LLPointer<LLSDViewBuffer> buffer = LLSDViewBuffer::mapFile(file.getName());
+        ensure("mapped", buffer.notNull());
+        ensure_equals("size", buffer->size(), bytes.size());
+        ensure_equals("value", buffer->root()["high_lod"]["offset"].asInteger(), 40);
+        ensure("missing file", LLSDViewBuffer::mapFile(file.getName() + ".missing").isNull());
+    }
+} // namespace tut
@@ -0,0 +1,124 @@
+/**
+ * @file   llstringtable_test.cpp
+ * @date   2026-10-18
+ * @brief  Test for llstringtable.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "llstringtable.h"
+// STL headers
+#include <string>
+#include <thread>
+#include <vector>
+// std headers
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+#include "stringize.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct llstringtable_data
+    {
+    };
+    typedef test_group<llstringtable_data> llstringtable_group;
+    typedef llstringtable_group::object object;
+    llstringtable_group llstringtablegrp("llstringtable");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("LLConcurrentStringTable insert and lookup");
+        LLConcurrentStringTable table;
+        ensure("absent", table.lookup("Position") == NULL);
+        LLStdStringHandle handle = table.insert("Position");
+        ensure_equals("contents", *handle, "Position");
+        ensure("same handle", table.insert(std::string("Position")) == handle);
+        ensure("lookup", table.checkString("Position") == handle);
+        ensure("distinct", table.addString("Rotation") != handle);
+        ensure_equals("empty string", *table.insert(""), "");
+        ensure_equals("size", table.size(), 3);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("LLConcurrentStringTable handles survive growth");
+        LLConcurrentStringTable table(16);
+        std::vector<LLStdStringHandle> handles;
+        for (int i = 0; i < 20000; ++i)
+        {
+            handles.push_back(table.insert(stringize("name", i)));
+        }
+        ensure_equals("size", table.size(), 20000);
+        ensure_equals("getHandles", table.getHandles().size(), 20000);
+        for (int i = 0; i < 20000; ++i)
+        {
+            const std::string name(stringize("name", i));
+            ensure_equals(name, *handles[i], name);
+            ensure(name, table.lookup(name) == handles[i]);
+        }
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("LLConcurrentStringTable interning from many threads");
+        LLConcurrentStringTable table;
+        const int threads = 8, names = 5000;
+        std::vector<std::vector<LLStdStringHandle>> results(threads);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&table, &results, t, names]()
+                {
+                    // every thread interns the same names, in different orders
+                    for (int i = 0; i < names; ++i)
+                    {
+                        const int n = (i * 7 + t * 613) % names;
+                        results[t].push_back(table.insert(stringize("attr", n)));
+                        table.lookup(stringize("attr", (n + 1) % names));
+                    }
+                });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        ensure_equals("size", table.size(), names);
+        for (int t = 0; t < threads; ++t)
+        {
+            for (int i = 0; i < names; ++i)
+            {
+                const int n = (i * 7 + t * 613) % names;
+                ensure("same handle", results[t][i] == table.lookup(stringize("attr", n)));
+            }
+        }
+    }
+} // namespace tut
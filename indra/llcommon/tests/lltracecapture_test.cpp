@@ -0,0 +1,153 @@
+/**
+ * @file   lltracecapture_test.cpp
+ * @date   2026-10-18
+ * @brief  Test for lltracecapture.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "lltracecapture.h"
+// STL headers
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+// std headers
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+#include "stringize.h"
+
+namespace
+{
+    size_t count(const std::string& haystack, const std::string& needle)
+    {
+        size_t found = 0;
+        for (size_t pos = haystack.find(needle); pos != std::string::npos;
+             pos = haystack.find(needle, pos + needle.length()))
+        {
+            ++found;
+        }
+        return found;
+    }
+
+    std::string capture()
+    {
+        std::ostringstream out;
+        LLTrace::TraceCapture::writeChromeTrace(out);
+        return out.str();
+    }
+}
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct lltracecapture_data
+    {
+        ~lltracecapture_data()
+        {
+            LLTrace::TraceCapture::stop();
+        }
+    };
+    typedef test_group<lltracecapture_data> lltracecapture_group;
+    typedef lltracecapture_group::object object;
+    lltracecapture_group lltracecapturegrp("lltracecapture");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("nothing recorded until started");
+        LLTrace::TraceCapture::stop();
+        {
+            LL_TRACE_CAPTURE_SCOPE("idle");
+        }
+        ensure_equals("events", count(capture(), "\"ph\":\"X\""), 0);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("per-thread timelines");
+        LLTrace::TraceCapture::start(1024);
+        LLTrace::TraceCapture::setThreadName("Main");
+        {
+            LL_TRACE_CAPTURE_SCOPE("outer");
+            LL_TRACE_CAPTURE_SCOPE("inner \"quoted\"");
+        }
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 3; ++i)
+        {
+            threads.emplace_back([i]()
+                {
+                    LLTrace::TraceCapture::setThreadName(stringize("worker ", i));
+                    const char* name = LLTrace::TraceCapture::intern(stringize("task ", i));
+                    for (int j = 0; j < 10; ++j)
+                    {
+                        LL_TRACE_CAPTURE_SCOPE(name);
+                    }
+                });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        LLTrace::TraceCapture::stop();
+        {
+            LL_TRACE_CAPTURE_SCOPE("after stop");
+        }
+
+        const std::string json(capture());
+        ensure_equals("events", count(json, "\"ph\":\"X\""), 32);
+        ensure_equals("recorded", LLTrace::TraceCapture::getRecordedCount(), 32);
+        ensure_equals("thread names", count(json, "\"name\":\"thread_name\""), 4);
+        ensure_contains("main", json, "\"args\":{\"name\":\"Main\"}");
+        ensure_contains("worker", json, "\"args\":{\"name\":\"worker 2\"}");
+        ensure_equals("task 1", count(json, "\"name\":\"task 1\""), 10);
+        ensure_contains("escaped", json, "\"name\":\"inner \\\"quoted\\\"\"");
+        ensure_equals("after stop", count(json, "after stop"), 0);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("ring buffer keeps the newest events");
+        LLTrace::TraceCapture::start(8);
+        const char* names[] = { "old", "new" };
+        for (int i = 0; i < 20; ++i)
+        {
+            LLTrace::TraceCapture::record(names[i >= 12], 1000 + i, 10);
+        }
+        const std::string json(capture());
+        ensure_equals("events", count(json, "\"ph\":\"X\""), 8);
+        ensure_equals("new", count(json, "\"name\":\"new\""), 8);
+        ensure_equals("recorded", LLTrace::TraceCapture::getRecordedCount(), 20);
+
+        // restarting discards the earlier capture
+        LLTrace::TraceCapture::start(8);
+        ensure_equals("restarted", count(capture(), "\"ph\":\"X\""), 0);
+    }
+} // namespace tut
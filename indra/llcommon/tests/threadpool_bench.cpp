@@ -0,0 +1,187 @@
+/**
+ * @file   threadpool_bench.cpp
+ * @date   2026-10-18
+ * @brief  Task throughput of a shared WorkQueue versus its work-stealing
+ *         and lock-free modes.
+ *
+ * Not a regression test: build the threadpool_bench target and run it by
+ * hand. For 1 to 16 worker threads it measures how many small tasks per
+ * second a WorkQueue can dispatch, first with all work posted from outside
+ * the pool (as the main thread does during a region crossing), then with
+ * each task fanning out follow-on tasks from inside the pool.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "workqueue.h"
+
+namespace
+{
+    // Roughly the cost of the smallest tasks we post: a few hundred cycles.
+    void busy_work(std::atomic<U64>& sink, U32 seed)
+    {
+        U32 x = seed | 1;
+        for (S32 i = 0; i < 64; ++i)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+        }
+        sink.fetch_add(x & 1, std::memory_order_relaxed);
+    }
+
+    enum Mode { SHARED, STEALING, LOCK_FREE };
+
+    struct Run
+    {
+        std::atomic<U64> mCompleted{ 0 };
+        std::atomic<U64> mSink{ 0 };
+    };
+
+    // Returns tasks per second.
+    F64 measure(size_t threads, Mode mode, bool fan_out, U64 tasks)
+    {
+        LL::WorkQueue queue(std::string(), 1024 * 1024);
+        if (mode == STEALING)
+        {
+            queue.enableWorkStealing(threads);
+        }
+        else if (mode == LOCK_FREE)
+        {
+            queue.enableLockFree();
+        }
+        Run run;
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < threads; ++i)
+        {
+            workers.emplace_back([&queue, i]()
+                {
+                    queue.bindWorker(i);
+                    queue.runUntilClose();
+                });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        if (fan_out)
+        {
+            // each root task posts 15 leaves from inside the pool
+            const U64 roots = tasks / 16;
+            for (U64 i = 0; i < roots; ++i)
+            {
+                queue.post([&queue, &run, i]()
+                    {
+                        for (U32 leaf = 0; leaf < 15; ++leaf)
+                        {
+                            queue.post([&run, i, leaf]()
+                                {
+                                    busy_work(run.mSink, U32(i * 16 + leaf));
+                                    ++run.mCompleted;
+                                });
+                        }
+                        busy_work(run.mSink, U32(i));
+                        ++run.mCompleted;
+                    });
+            }
+            tasks = roots * 16;
+        }
+        else
+        {
+            for (U64 i = 0; i < tasks; ++i)
+            {
+                queue.post([&run, i]()
+                    {
+                        busy_work(run.mSink, U32(i));
+                        ++run.mCompleted;
+                    });
+            }
+        }
+        while (run.mCompleted < tasks)
+        {
+            std::this_thread::yield();
+        }
+        const auto stop = std::chrono::steady_clock::now();
+
+        queue.close();
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        const F64 seconds = std::chrono::duration<F64>(stop - start).count();
+        return seconds > 0.0 ? tasks / seconds : 0.0;
+    }
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    U64 tasks = 200000;
+    size_t max_threads = 16;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        if (arg == "--tasks" && i + 1 < argc)
+        {
+            tasks = strtoull(argv[++i], NULL, 10);
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            max_threads = strtoul(argv[++i], NULL, 10);
+        }
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--tasks N] [--threads MAX]\n";
+            return 1;
+        }
+    }
+
+    std::cout << std::setw(8) << "threads"
+              << std::setw(16) << "shared ext"
+              << std::setw(16) << "stealing ext"
+              << std::setw(16) << "lockfree ext"
+              << std::setw(16) << "shared fan"
+              << std::setw(16) << "stealing fan"
+              << std::setw(16) << "lockfree fan"
+              << "   (Ktasks/s)\n";
+    for (size_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::cout << std::setw(8) << threads << std::fixed << std::setprecision(0);
+        for (bool fan_out : { false, true })
+        {
+            for (Mode mode : { SHARED, STEALING, LOCK_FREE })
+            {
+                std::cout << std::setw(16) << measure(threads, mode, fan_out, tasks) / 1000.0;
+            }
+        }
+        std::cout << std::endl;
+    }
+    return 0;
+}
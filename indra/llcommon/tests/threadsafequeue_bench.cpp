@@ -0,0 +1,160 @@
+/**
+ * @file   threadsafequeue_bench.cpp
+ * @date   2026-10-18
+ * @brief  Contention benchmark: LLThreadSafeQueue versus LLLockFreeQueue.
+ *
+ * Not a regression test: build the threadsafequeue_bench target and run it
+ * by hand. For 1 to 16 producer threads pushing into one queue drained by a
+ * fixed set of consumers, it reports items per second through the mutex
+ * based LLThreadSafeQueue and the lock-free LLLockFreeQueue, once with room
+ * for everything and once with a small capacity so producers also block.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "llthreadsafequeue.h"
+#include "lllockfreequeue.h"
+
+namespace
+{
+    // Returns items per second.
+    template <typename QUEUE>
+    F64 measure(size_t producers, size_t consumers, size_t capacity, U64 items)
+    {
+        QUEUE queue(capacity);
+        std::atomic<U64> popped{ 0 };
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < consumers; ++i)
+        {
+            threads.emplace_back([&queue, &popped]()
+                {
+                    U64 local = 0;
+                    try
+                    {
+                        for (;;)
+                        {
+                            queue.pop();
+                            ++local;
+                        }
+                    }
+                    catch (const LLThreadSafeQueueInterrupt&)
+                    {
+                    }
+                    popped += local;
+                });
+        }
+
+        const U64 per_producer = items / producers;
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> pushers;
+        for (size_t i = 0; i < producers; ++i)
+        {
+            pushers.emplace_back([&queue, per_producer]()
+                {
+                    for (U64 n = 0; n < per_producer; ++n)
+                    {
+                        queue.push(n);
+                    }
+                });
+        }
+        for (auto& pusher : pushers)
+        {
+            pusher.join();
+        }
+        queue.close();
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        const auto stop = std::chrono::steady_clock::now();
+
+        const F64 seconds = std::chrono::duration<F64>(stop - start).count();
+        return seconds > 0.0 ? popped / seconds : 0.0;
+    }
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    U64 items = 1000000;
+    size_t max_producers = 16;
+    size_t consumers = 2;
+    size_t small_capacity = 256;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        if (arg == "--items" && i + 1 < argc)
+        {
+            items = strtoull(argv[++i], NULL, 10);
+        }
+        else if (arg == "--producers" && i + 1 < argc)
+        {
+            max_producers = strtoul(argv[++i], NULL, 10);
+        }
+        else if (arg == "--consumers" && i + 1 < argc)
+        {
+            consumers = strtoul(argv[++i], NULL, 10);
+        }
+        else if (arg == "--capacity" && i + 1 < argc)
+        {
+            small_capacity = strtoul(argv[++i], NULL, 10);
+        }
+        else
+        {
+            std::cerr << "usage: " << argv[0]
+                      << " [--items N] [--producers MAX] [--consumers N] [--capacity N]\n";
+            return 1;
+        }
+    }
+
+    using Mutexed = LLThreadSafeQueue<U64>;
+    using LockFree = LLLockFreeQueue<U64>;
+    const size_t unbounded = size_t(items) + 1;
+
+    std::cout << consumers << " consumers, small capacity " << small_capacity << '\n';
+    std::cout << std::setw(10) << "producers"
+              << std::setw(14) << "mutex"
+              << std::setw(14) << "lock-free"
+              << std::setw(14) << "mutex small"
+              << std::setw(14) << "lf small"
+              << "   (Mitems/s)\n";
+    for (size_t producers = 1; producers <= max_producers; producers *= 2)
+    {
+        std::cout << std::setw(10) << producers << std::fixed << std::setprecision(2)
+                  << std::setw(14) << measure<Mutexed>(producers, consumers, unbounded, items) / 1e6
+                  << std::setw(14) << measure<LockFree>(producers, consumers, unbounded, items) / 1e6
+                  << std::setw(14) << measure<Mutexed>(producers, consumers, small_capacity, items) / 1e6
+                  << std::setw(14) << measure<LockFree>(producers, consumers, small_capacity, items) / 1e6
+                  << std::endl;
+    }
+    return 0;
+}
@@ -15,8 +15,11 @@
 #include "workqueue.h"
 // STL headers
 // std headers
+#include <atomic>
 #include <chrono>
 #include <deque>
+#include <thread>
+#include <vector>
 // external library headers
 // other Linden headers
 #include "../test/lltut.h"
@@ -236,4 +239,145 @@ namespace tut
         ensure_equals("didn't run coroutine", stored, "ran");
         ensure("void waitForResult() didn't return", done);
     }
+
+    template<> template<>
+    void object::test<7>()
+    {
+        set_test_name("work stealing");
+        WorkQueue stealing("stealing");
+        // work posted before the switch is carried over
+        std::atomic<int> ran{ 0 };
+        stealing.post([&ran](){ ++ran; });
+        stealing.enableWorkStealing(4);
+        ensure("not stealing", stealing.isWorkStealing());
+        ensure_equals("lost early work", stealing.size(), 1);
+
+        // each worker posts follow-on work to its own deque, which the
+        // others must be able to steal
+        const int count = 1000;
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < 4; ++i)
+        {
+            workers.emplace_back([&stealing, i](){
+                stealing.bindWorker(i);
+                stealing.runUntilClose();
+            });
+        }
+        for (int i = 0; i < count; ++i)
+        {
+            stealing.post([&stealing, &ran](){
+                ++ran;
+                stealing.post([&ran](){ ++ran; });
+            });
+        }
+        // close() only once the queue has drained, else follow-on posts
+        // could be refused
+        while (ran < 2 * count + 1)
+        {
+            std::this_thread::yield();
+        }
+        stealing.close();
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        ensure_equals("didn't run everything", ran.load(), 2 * count + 1);
+        ensure("not done", stealing.done());
+        ensure_not("posted after close", stealing.post([](){}));
+    }
+
+    template<> template<>
+    void object::test<8>()
+    {
+        set_test_name("priority classes");
+        WorkQueue lanes("lanes");
+        std::string order;
+        for (int i = 0; i < 4; ++i)
+        {
+            lanes.post([&order](){ order += 'b'; }, WorkQueue::PRIORITY_BACKGROUND);
+            lanes.post([&order](){ order += 'n'; });
+            lanes.post([&order](){ order += 'u'; }, WorkQueue::PRIORITY_URGENT);
+        }
+        ensure_equals("urgent depth", lanes.getDepth(WorkQueue::PRIORITY_URGENT), 4);
+        ensure_equals("background depth", lanes.getDepth(WorkQueue::PRIORITY_BACKGROUND), 4);
+        lanes.close();
+        lanes.runUntilClose();
+        ensure_equals("wrong order", order, "uuuunnnnbbbb");
+        ensure_equals("urgent not drained", lanes.getDepth(WorkQueue::PRIORITY_URGENT), 0);
+
+        // a steady stream of urgent work can't starve background work
+        WorkQueue flood("flood");
+        order.clear();
+        flood.post([&order](){ order += 'b'; }, WorkQueue::PRIORITY_BACKGROUND);
+        for (int i = 0; i < 20; ++i)
+        {
+            flood.post([&order](){ order += 'u'; }, WorkQueue::PRIORITY_URGENT);
+        }
+        flood.close();
+        flood.runUntilClose();
+        ensure_equals("background starved", order.find('b'), WorkQueue::STARVATION_LIMIT);
+
+        // WorkSchedule: among ready items, urgent first; future items wait
+        order.clear();
+        auto now{ WorkSchedule::TimePoint::clock::now() };
+        queue.post([&order](){ order += 'n'; }, now);
+        queue.post([&order](){ order += 'f'; }, now + 20ms, WorkSchedule::PRIORITY_URGENT);
+        queue.post([&order](){ order += 'u'; }, now, WorkSchedule::PRIORITY_URGENT);
+        queue.close();
+        queue.runUntilClose();
+        ensure_equals("wrong schedule order", order, "unf");
+    }
+
+    template<> template<>
+    void object::test<9>()
+    {
+        set_test_name("lock-free");
+        WorkQueue lockfree("lockfree");
+        // work posted before the switch is carried over, and priority
+        // classes are still served in order
+        std::string order;
+        lockfree.post([&order](){ order += 'b'; }, WorkQueue::PRIORITY_BACKGROUND);
+        lockfree.post([&order](){ order += 'n'; });
+        lockfree.enableLockFree();
+        ensure("not lock-free", lockfree.isLockFree());
+        lockfree.enableWorkStealing(4);
+        ensure_not("stealing too", lockfree.isWorkStealing());
+        lockfree.post([&order](){ order += 'u'; }, WorkQueue::PRIORITY_URGENT);
+        ensure_equals("lost early work", lockfree.size(), 3);
+        lockfree.runPending();
+        ensure_equals("wrong order", order, "unb");
+
+        // many producers, many consumers
+        const int producers = 8, count = 1000;
+        std::atomic<int> ran{ 0 };
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < 4; ++i)
+        {
+            workers.emplace_back([&lockfree](){ lockfree.runUntilClose(); });
+        }
+        std::vector<std::thread> posters;
+        for (int p = 0; p < producers; ++p)
+        {
+            posters.emplace_back([&lockfree, &ran, p](){
+                for (int i = 0; i < count; ++i)
+                {
+                    lockfree.post([&ran](){ ++ran; }, WorkQueue::Priority(i % 3));
+                }
+            });
+        }
+        for (auto& poster : posters)
+        {
+            poster.join();
+        }
+        // close() drains what's left before the workers quit
+        lockfree.close();
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        ensure_equals("didn't run everything", ran.load(), producers * count);
+        ensure("not done", lockfree.done());
+        ensure_equals("urgent not drained", lockfree.getDepth(WorkQueue::PRIORITY_URGENT), 0);
+        ensure_not("posted after close", lockfree.post([](){}));
+    }
 } // namespace tut
@@ -21,6 +21,7 @@
 #include "llerror.h"
 #include "llevents.h"
 #include "llsd.h"
+#include "lltracecapture.h"
 #include "stringize.h"
 
 #include <boost/fiber/algo/round_robin.hpp>
@@ -67,19 +68,54 @@ LL::ThreadPoolBase::ThreadPoolBase(const std::string& name,
     super(name),
     mName("ThreadPool:" + name),
     mThreadCount(getConfiguredWidth(name, threads)),
+    mWorkStealing(false),
     mQueue(queue),
     mAutomaticShutdown(auto_shutdown)
-{}
+{
+    if (getConfiguredWorkStealing(name))
+    {
+        // Only the plain WorkQueue has a work-stealing mode: WorkSchedule
+        // must keep its items ordered by timestamp.
+        auto workqueue = dynamic_cast<WorkQueue*>(mQueue.get());
+        if (workqueue && mThreadCount)
+        {
+            workqueue->enableWorkStealing(mThreadCount);
+            mWorkStealing = true;
+        }
+        else
+        {
+            LL_WARNS("ThreadPool") << mName << " can't use work stealing" << LL_ENDL;
+        }
+    }
+    else if (getConfiguredLockFree(name))
+    {
+        // likewise, WorkSchedule needs its lock to pick among timestamps
+        auto workqueue = dynamic_cast<WorkQueue*>(mQueue.get());
+        if (workqueue)
+        {
+            workqueue->enableLockFree();
+        }
+        else
+        {
+            LL_WARNS("ThreadPool") << mName << " can't use lock-free queues" << LL_ENDL;
+        }
+    }
+}
 
 void LL::ThreadPoolBase::start()
 {
     for (size_t i = 0; i < mThreadCount; ++i)
     {
         std::string tname{ stringize(mName, ':', (i+1), '/', mThreadCount) };
-        mThreads.emplace_back(tname, [this, tname]()
+        mThreads.emplace_back(tname, [this, tname, i]()
             {
                 LL_PROFILER_SET_THREAD_NAME(tname.c_str());
+                LLTrace::TraceCapture::setThreadName(tname);
                 LL_INFOS("THREAD") << "Started thread " << tname << LL_ENDL;
+                if (mWorkStealing)
+                {
+                    static_cast<WorkQueue&>(*mQueue).bindWorker(i);
+                }
                 run(tname);
             });
     }
@@ -154,6 +190,34 @@ void LL::ThreadPoolBase::run()
 
 //static
 size_t LL::ThreadPoolBase::getConfiguredWidth(const std::string& name, size_t dft)
+{
+    LLSD sizeSpec{ getConfiguredSpec(name) };
+    // The entry may be a map carrying other options as well as the width.
+    if (sizeSpec.isMap())
+    {
+        sizeSpec = sizeSpec["width"];
+    }
+    // We retrieve sizeSpec as LLSD, rather than immediately as LLSD::Integer,
+    // so we can distinguish the case when it's undefined.
+    return sizeSpec.isInteger() ? sizeSpec.asInteger() : dft;
+}
+
+//static
+bool LL::ThreadPoolBase::getConfiguredWorkStealing(const std::string& name)
+{
+    LLSD sizeSpec{ getConfiguredSpec(name) };
+    return sizeSpec.isMap() && sizeSpec["work_stealing"].asBoolean();
+}
+
+//static
+bool LL::ThreadPoolBase::getConfiguredLockFree(const std::string& name)
+{
+    LLSD sizeSpec{ getConfiguredSpec(name) };
+    return sizeSpec.isMap() && sizeSpec["lock_free"].asBoolean();
+}
+
+//static
+LLSD LL::ThreadPoolBase::getConfiguredSpec(const std::string& name)
 {
     LLSD poolSizes;
     try
@@ -187,10 +251,7 @@ size_t LL::ThreadPoolBase::getConfiguredWidth(const std::string& name, size_t df
     LL_DEBUGS("ThreadPool") << "ThreadPoolSizes = " << poolSizes << LL_ENDL;
     // LLSD treats an undefined value as an empty map when asked to retrieve a
     // key, so we don't need this to be conditional.
-    LLSD sizeSpec{ poolSizes[name] };
-    // We retrieve sizeSpec as LLSD, rather than immediately as LLSD::Integer,
-    // so we can distinguish the case when it's undefined.
-    return sizeSpec.isInteger() ? sizeSpec.asInteger() : dft;
+    return poolSizes[name];
 }
 
 //static
@@ -38,6 +38,12 @@ namespace LL
          * if the user has overridden the LLSD map in the "ThreadPoolSizes"
          * setting with a key matching this ThreadPool name, that setting
          * overrides this parameter.
+         *
+         * The "ThreadPoolSizes" entry may be either an integer width or a
+         * map such as {"width": 3, "work_stealing": true}. work_stealing
+         * switches a plain WorkQueue to per-worker deques (see
+         * WorkQueue::enableWorkStealing()); failing that, lock_free switches
+         * it to lock-free queues (see WorkQueue::enableLockFree()).
          */
         ThreadPoolBase(const std::string& name, size_t threads,
                        WorkQueueBase* queue, bool auto_shutdown = true);
@@ -59,6 +65,7 @@ namespace LL
 
         std::string getName() const { return mName; }
         size_t getWidth() const { return mThreads.size(); }
+        bool isWorkStealing() const { return mWorkStealing; }
 
         /**
          * Override run() if you need special processing. The default run()
@@ -74,6 +81,20 @@ namespace LL
         static
         size_t getConfiguredWidth(const std::string& name, size_t dft=0);
 
+        /**
+         * getConfiguredWorkStealing() returns true if the "ThreadPoolSizes"
+         * entry for the specified ThreadPool name requests work stealing.
+         */
+        static
+        bool getConfiguredWorkStealing(const std::string& name);
+
+        /**
+         * getConfiguredLockFree() returns true if the "ThreadPoolSizes"
+         * entry for the specified ThreadPool name requests lock-free queues.
+         */
+        static
+        bool getConfiguredLockFree(const std::string& name);
+
         /**
          * This getWidth() returns the width of the instantiated ThreadPool
          * with the specified name, if any. If no instance exists, returns its
@@ -92,9 +113,11 @@ namespace LL
 
     private:
         void run(const std::string& name);
+        static LLSD getConfiguredSpec(const std::string& name);
 
         std::string mName;
         size_t mThreadCount;
+        bool mWorkStealing;
     };
 
     /**
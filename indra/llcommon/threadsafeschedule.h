@@ -53,25 +53,25 @@ namespace LL
     } // namespace ThreadSafeSchedulePrivate
 
     /**
-     * ThreadSafeSchedule is an ordered LLThreadSafeQueue in which every item
-     * is given an associated timestamp. That is, TimePoint is implicitly
+     * ThreadSafeScheduleUsing is an ordered LLThreadSafeQueue in which every
+     * item is given an associated timestamp. That is, TimePoint is implicitly
      * prepended to the std::tuple with the specified types.
      *
-     * Items are popped in increasing chronological order. Moreover, any item
-     * with a timestamp in the future is held back until
-     * std::chrono::steady_clock reaches that timestamp.
+     * Any item with a timestamp in the future is held back until
+     * std::chrono::steady_clock reaches that timestamp. QUEUE stores the
+     * items and decides which of those that are ready to pop comes first;
+     * ThreadSafeSchedule, below, simply pops them in chronological order.
      */
-    template <typename... Args>
-    class ThreadSafeSchedule:
-        public LLThreadSafeQueue<ThreadSafeSchedulePrivate::TimestampedTuple<Args...>,
-                                 ThreadSafeSchedulePrivate::TimedQueue<Args...>>
+    template <typename QUEUE, typename... Args>
+    class ThreadSafeScheduleUsing:
+        public LLThreadSafeQueue<ThreadSafeSchedulePrivate::TimestampedTuple<Args...>, QUEUE>
     {
     public:
         using DataTuple = std::tuple<Args...>;
         using TimeTuple = ThreadSafeSchedulePrivate::TimestampedTuple<Args...>;
 
     private:
-        using super = LLThreadSafeQueue<TimeTuple, ThreadSafeSchedulePrivate::TimedQueue<Args...>>;
+        using super = LLThreadSafeQueue<TimeTuple, QUEUE>;
         using lock_t = typename super::lock_t;
         // VS 2017 needs this due to a bug:
         // https://developercommunity.visualstudio.com/t/cannot-access-protected-enumerator-of-enclosing-cl/203430
@@ -82,7 +82,7 @@ namespace LL
         using TimePoint = ThreadSafeSchedulePrivate::TimePoint;
         using Clock = TimePoint::clock;
 
-        ThreadSafeSchedule(size_t capacity=1024):
+        ThreadSafeScheduleUsing(size_t capacity=1024):
             super(capacity)
         {}
 
@@ -394,6 +394,19 @@ namespace LL
         }
     };
 
+    /**
+     * ThreadSafeSchedule pops items in increasing chronological order.
+     */
+    template <typename... Args>
+    class ThreadSafeSchedule:
+        public ThreadSafeScheduleUsing<ThreadSafeSchedulePrivate::TimedQueue<Args...>, Args...>
+    {
+        using super = ThreadSafeScheduleUsing<ThreadSafeSchedulePrivate::TimedQueue<Args...>, Args...>;
+
+    public:
+        using super::super;
+    };
+
 } // namespace LL
 
 #endif /* ! defined(LL_THREADSAFESCHEDULE_H) */
@@ -14,14 +14,23 @@
 // associated header
 #include "workqueue.h"
 // STL headers
+#include <deque>
+#include <vector>
 // std headers
+#include <atomic>
+#include <thread>
 // external library headers
 // other Linden headers
 #include "llapp.h"
 #include "llcoros.h"
 #include LLCOROS_MUTEX_HEADER
+#include LLCOROS_CONDVAR_HEADER
+#include "mutex.h"
 #include "llerror.h"
 #include "llexception.h"
+#include "lllockfreequeue.h"
+#include "lltrace.h"
+#include "lltracecapture.h"
 #include "stringize.h"
 
 using Mutex = LLCoros::Mutex;
@@ -31,7 +40,8 @@ using Lock  = LLCoros::LockType;
 *   WorkQueueBase
 *****************************************************************************/
 LL::WorkQueueBase::WorkQueueBase(const std::string& name):
-    super(makeName(name))
+    super(makeName(name)),
+    mTraceName(LLTrace::TraceCapture::intern(getKey()))
 {
     // TODO: register for "LLApp" events so we can implicitly close() on
     // viewer shutdown.
@@ -167,6 +177,7 @@ namespace
 void LL::WorkQueueBase::callWork(const Work& work)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_THREAD;
+    LL_TRACE_CAPTURE_SCOPE(mTraceName);
 
 #ifdef LL_WINDOWS
     // can not use __try directly, toplevel requires unwinding, thus use of a wrapper
@@ -194,6 +205,35 @@ void LL::WorkQueueBase::callWork(const Work& work)
 #endif // else LL_WINDOWS
 }
 
+namespace
+{
+    // Depth of each priority class over every WorkQueue and WorkSchedule,
+    // sampled by sampleDepthStats().
+    LLTrace::SampleStatHandle<> sDepthStats[LL::WorkQueueBase::PRIORITY_COUNT] =
+    {
+        { "workqueue_urgent_depth", "Urgent items waiting in all WorkQueues" },
+        { "workqueue_normal_depth", "Normal items waiting in all WorkQueues" },
+        { "workqueue_background_depth", "Background items waiting in all WorkQueues" }
+    };
+} // anonymous namespace
+
+//static
+void LL::WorkQueueBase::sampleDepthStats()
+{
+    size_t depth[PRIORITY_COUNT]{};
+    for (auto& queue : instance_snapshot())
+    {
+        for (size_t priority = 0; priority < PRIORITY_COUNT; ++priority)
+        {
+            depth[priority] += queue.getDepth(Priority(priority));
+        }
+    }
+    for (size_t priority = 0; priority < PRIORITY_COUNT; ++priority)
+    {
+        LLTrace::sample(sDepthStats[priority], F64(depth[priority]));
+    }
+}
+
 void LL::WorkQueueBase::error(const std::string& msg)
 {
     LL_ERRS("WorkQueue") << msg << LL_ENDL;
@@ -209,53 +249,517 @@ void LL::WorkQueueBase::checkCoroutine(const std::string& method)
     }
 }
 
+/*****************************************************************************
+*   WorkQueue::Lanes: per-worker deques for work-stealing mode
+*****************************************************************************/
+namespace
+{
+    // The work-stealing WorkQueue, if any, served by the current thread, and
+    // which of its workers this thread is.
+    thread_local const LL::WorkQueue* sWorkerQueue = nullptr;
+    thread_local size_t sWorkerIndex = 0;
+
+    // Cheap per-thread xorshift generator for picking a victim to steal from.
+    size_t random_victim(size_t count)
+    {
+        thread_local U32 state =
+            U32(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state % count;
+    }
+
+    // Pick a priority class from the candidates mask the way
+    // LaneQueueAdapter does, and pop from it with try_class(cls, work); if
+    // the chosen class was drained meanwhile, settle for any other. skipped
+    // is shared by all workers without a lock, so the starvation limit is
+    // only approximate.
+    template <typename TRY_CLASS>
+    bool pop_by_class(U32 candidates,
+                      std::atomic<U32> (&skipped)[LL::WorkQueue::PRIORITY_COUNT],
+                      LL::WorkQueue::Work& work, LL::WorkQueue::Priority& priority,
+                      TRY_CLASS&& try_class)
+    {
+        constexpr size_t classes = LL::WorkQueue::PRIORITY_COUNT;
+        const size_t chosen = LL::choose_lane(classes, candidates, skipped,
+                                              LL::WorkQueue::STARVATION_LIMIT);
+        for (size_t n = 0; n <= classes; ++n)
+        {
+            const size_t cls = n ? n - 1 : chosen;
+            if (cls >= classes || (n && cls == chosen))
+            {
+                continue;
+            }
+            if (try_class(cls, work))
+            {
+                for (size_t other = 0; other < classes; ++other)
+                {
+                    if (other == cls)
+                    {
+                        skipped[other] = 0;
+                    }
+                    else if (candidates & (1 << other))
+                    {
+                        ++skipped[other];
+                    }
+                }
+                priority = LL::WorkQueue::Priority(cls);
+                return true;
+            }
+        }
+        return false;
+    }
+} // anonymous namespace
+
+struct LL::WorkQueue::Lanes
+{
+    // Each lane has its own cache line so that workers hammering their own
+    // lanes don't false-share.
+    struct alignas(64) Lane
+    {
+        // Lane locks are only ever held for a push or a pop, never across a
+        // fiber switch, so a plain std::mutex suffices.
+        std::mutex mMutex;
+        std::deque<Work> mWork[PRIORITY_COUNT];
+    };
+
+    Lanes(size_t workers):
+        mLanes(workers)
+    {}
+
+    bool push(const WorkQueue* queue, const Work& work, Priority priority)
+    {
+        if (mClosed)
+        {
+            return false;
+        }
+        const size_t index = (sWorkerQueue == queue) ? sWorkerIndex
+                                                     : mNextLane++ % mLanes.size();
+        {
+            std::lock_guard<std::mutex> lk(mLanes[index].mMutex);
+            mLanes[index].mWork[priority].push_back(work);
+        }
+        // Increment only once the item can actually be found, so that mPending
+        // never overstates what's in the lanes for longer than a pop takes.
+        ++mClassPending[priority];
+        ++mPending;
+        // Only touch the sleep mutex when somebody might be asleep: sleep()
+        // registers in mSleepers before checking mPending, we incremented
+        // mPending before checking mSleepers, so one of us sees the other.
+        if (mSleepers)
+        {
+            Lock lk(mSleepMutex);
+            mSleepCondition.notify_one();
+        }
+        return true;
+    }
+
+    bool tryPop(const WorkQueue* queue, Work& work, Priority& priority)
+    {
+        if (! mPending)
+        {
+            return false;
+        }
+        U32 candidates = 0;
+        for (size_t cls = 0; cls < PRIORITY_COUNT; ++cls)
+        {
+            if (mClassPending[cls])
+            {
+                candidates |= (1 << cls);
+            }
+        }
+        return pop_by_class(candidates, mSkipped, work, priority,
+                            [this, queue](size_t cls, Work& item)
+                            { return tryPopClass(queue, cls, item); });
+    }
+
+    bool tryPopClass(const WorkQueue* queue, size_t cls, Work& work)
+    {
+        if (! mClassPending[cls])
+        {
+            return false;
+        }
+        // own lane first, newest first
+        if (sWorkerQueue == queue)
+        {
+            Lane& lane = mLanes[sWorkerIndex];
+            std::lock_guard<std::mutex> lk(lane.mMutex);
+            if (! lane.mWork[cls].empty())
+            {
+                work = std::move(lane.mWork[cls].back());
+                lane.mWork[cls].pop_back();
+                popped(cls);
+                return true;
+            }
+        }
+        // then steal the oldest item from whichever lane we happen upon
+        const size_t count = mLanes.size();
+        const size_t start = random_victim(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            Lane& lane = mLanes[(start + i) % count];
+            std::lock_guard<std::mutex> lk(lane.mMutex);
+            if (! lane.mWork[cls].empty())
+            {
+                work = std::move(lane.mWork[cls].front());
+                lane.mWork[cls].pop_front();
+                popped(cls);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void popped(size_t cls)
+    {
+        --mClassPending[cls];
+        --mPending;
+    }
+
+    Work pop(const WorkQueue* queue, Priority& priority)
+    {
+        for (;;)
+        {
+            Work work;
+            if (tryPop(queue, work, priority))
+            {
+                return work;
+            }
+            if (done())
+            {
+                LLTHROW(Closed());
+            }
+            Lock lk(mSleepMutex);
+            ++mSleepers;
+            mSleepCondition.wait(lk, [this](){ return mPending || mClosed; });
+            --mSleepers;
+        }
+    }
+
+    void close()
+    {
+        mClosed = true;
+        Lock lk(mSleepMutex);
+        mSleepCondition.notify_all();
+    }
+
+    bool done() const { return mClosed && ! mPending; }
+
+    std::vector<Lane> mLanes;
+    std::atomic<size_t> mPending{ 0 };
+    std::atomic<size_t> mClassPending[PRIORITY_COUNT]{};
+    std::atomic<U32> mSkipped[PRIORITY_COUNT]{};
+    std::atomic<size_t> mNextLane{ 0 };
+    std::atomic<size_t> mSleepers{ 0 };
+    std::atomic<bool> mClosed{ false };
+    Mutex mSleepMutex;
+    LLCoros::ConditionVariable mSleepCondition;
+};
+
+/*****************************************************************************
+*   WorkQueue::LockFree: per-class LLLockFreeQueues for lock-free mode
+*****************************************************************************/
+struct LL::WorkQueue::LockFree
+{
+    LockFree(size_t capacity)
+    {
+        for (auto& cls : mClasses)
+        {
+            cls = std::make_unique<LLLockFreeQueue<Work>>(capacity);
+        }
+    }
+
+    bool push(const Work& work, Priority priority, bool block)
+    {
+        LLLockFreeQueue<Work>& cls = *mClasses[priority];
+        const bool pushed = block ? cls.pushIfOpen(work) : cls.tryPush(work);
+        // Workers sleep on our condition, not the class queue's, so wake one
+        // for the new item -- or all of them if the class turned out to be
+        // closed, since done() may only now have become true. Only touch the
+        // sleep mutex when somebody might be asleep: pop() registers in
+        // mSleepers before checking the classes, the push counted the item
+        // before we check mSleepers, so one of us sees the other.
+        if ((pushed || cls.isClosed()) && mSleepers)
+        {
+            Lock lk(mSleepMutex);
+            if (pushed)
+            {
+                mSleepCondition.notify_one();
+            }
+            else
+            {
+                mSleepCondition.notify_all();
+            }
+        }
+        return pushed;
+    }
+
+    bool tryPop(Work& work, Priority& priority)
+    {
+        U32 candidates = 0;
+        for (size_t cls = 0; cls < PRIORITY_COUNT; ++cls)
+        {
+            if (mClasses[cls]->size())
+            {
+                candidates |= (1 << cls);
+            }
+        }
+        if (! candidates)
+        {
+            return false;
+        }
+        return pop_by_class(candidates, mSkipped, work, priority,
+                            [this](size_t cls, Work& item)
+                            { return mClasses[cls]->tryPop(item); });
+    }
+
+    Work pop(Priority& priority)
+    {
+        for (;;)
+        {
+            Work work;
+            if (tryPop(work, priority))
+            {
+                return work;
+            }
+            if (done())
+            {
+                LLTHROW(Closed());
+            }
+            Lock lk(mSleepMutex);
+            ++mSleepers;
+            mSleepCondition.wait(lk, [this](){ return size() || done(); });
+            --mSleepers;
+        }
+    }
+
+    void close()
+    {
+        for (auto& cls : mClasses)
+        {
+            cls->close();
+        }
+        Lock lk(mSleepMutex);
+        mSleepCondition.notify_all();
+    }
+
+    size_t size() const
+    {
+        size_t total = 0;
+        for (const auto& cls : mClasses)
+        {
+            total += cls->size();
+        }
+        return total;
+    }
+
+    bool isClosed() const { return mClasses[0]->isClosed(); }
+
+    bool done() const
+    {
+        for (const auto& cls : mClasses)
+        {
+            if (! cls->done())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::unique_ptr<LLLockFreeQueue<Work>> mClasses[PRIORITY_COUNT];
+    std::atomic<U32> mSkipped[PRIORITY_COUNT]{};
+    std::atomic<size_t> mSleepers{ 0 };
+    Mutex mSleepMutex;
+    LLCoros::ConditionVariable mSleepCondition;
+};
+
 /*****************************************************************************
 *   WorkQueue
 *****************************************************************************/
 LL::WorkQueue::WorkQueue(const std::string& name, size_t capacity):
     super(name),
-    mQueue(capacity)
+    mQueue(capacity),
+    mCapacity(capacity)
 {
 }
 
+// out of line so ~unique_ptr sees the complete Lanes and LockFree types
+LL::WorkQueue::~WorkQueue() {}
+
+void LL::WorkQueue::enableWorkStealing(size_t workers)
+{
+    if (mLanes || mLockFree || ! workers)
+    {
+        return;
+    }
+    auto lanes = std::make_unique<Lanes>(workers);
+    // carry over anything posted before the switch
+    for (PrioritizedWork item; mQueue.tryPop(item); )
+    {
+        lanes->push(this, std::get<0>(item), std::get<1>(item));
+    }
+    if (mQueue.isClosed())
+    {
+        lanes->close();
+    }
+    mLanes = std::move(lanes);
+}
+
+void LL::WorkQueue::enableLockFree()
+{
+    if (mLanes || mLockFree)
+    {
+        return;
+    }
+    auto lock_free = std::make_unique<LockFree>(mCapacity);
+    // carry over anything posted before the switch
+    for (PrioritizedWork item; mQueue.tryPop(item); )
+    {
+        lock_free->push(std::get<0>(item), std::get<1>(item), false);
+    }
+    if (mQueue.isClosed())
+    {
+        lock_free->close();
+    }
+    mLockFree = std::move(lock_free);
+}
+
+void LL::WorkQueue::bindWorker(size_t index)
+{
+    if (mLanes && index < mLanes->mLanes.size())
+    {
+        sWorkerQueue = this;
+        sWorkerIndex = index;
+    }
+}
+
 void LL::WorkQueue::close()
 {
+    if (mLanes)
+    {
+        mLanes->close();
+    }
+    if (mLockFree)
+    {
+        mLockFree->close();
+    }
     mQueue.close();
 }
 
 size_t LL::WorkQueue::size()
 {
-    return mQueue.size();
+    return mLanes ? mLanes->mPending.load()
+        : mLockFree ? mLockFree->size()
+        : mQueue.size();
 }
 
 bool LL::WorkQueue::isClosed()
 {
-    return mQueue.isClosed();
+    return mLanes ? mLanes->mClosed.load()
+        : mLockFree ? mLockFree->isClosed()
+        : mQueue.isClosed();
 }
 
 bool LL::WorkQueue::done()
 {
-    return mQueue.done();
+    return mLanes ? mLanes->done()
+        : mLockFree ? mLockFree->done()
+        : mQueue.done();
 }
 
 bool LL::WorkQueue::post(const Work& callable)
 {
-    return mQueue.pushIfOpen(callable);
+    return post(callable, PRIORITY_NORMAL);
+}
+
+bool LL::WorkQueue::post(const Work& callable, Priority priority)
+{
+    // count it first: a worker could pop it before we get to posted()
+    posted(priority);
+    bool ok = mLanes ? mLanes->push(this, callable, priority)
+        : mLockFree ? mLockFree->push(callable, priority, true)
+        : mQueue.pushIfOpen(PrioritizedWork(callable, priority));
+    if (! ok)
+    {
+        popped(priority);
+    }
+    return ok;
 }
 
 bool LL::WorkQueue::tryPost(const Work& callable)
 {
-    return mQueue.tryPush(callable);
+    return tryPost(callable, PRIORITY_NORMAL);
+}
+
+bool LL::WorkQueue::tryPost(const Work& callable, Priority priority)
+{
+    if (mLanes && mLanes->mPending >= mCapacity)
+    {
+        return false;
+    }
+    posted(priority);
+    bool ok = mLanes ? mLanes->push(this, callable, priority)
+        : mLockFree ? mLockFree->push(callable, priority, false)
+        : mQueue.tryPush(PrioritizedWork(callable, priority));
+    if (! ok)
+    {
+        popped(priority);
+    }
+    return ok;
 }
 
 LL::WorkQueue::Work LL::WorkQueue::pop_()
 {
-    return mQueue.pop();
+    if (mLanes)
+    {
+        Priority priority;
+        Work work{ mLanes->pop(this, priority) };
+        popped(priority);
+        return work;
+    }
+    if (mLockFree)
+    {
+        Priority priority;
+        Work work{ mLockFree->pop(priority) };
+        popped(priority);
+        return work;
+    }
+    PrioritizedWork item{ mQueue.pop() };
+    popped(std::get<1>(item));
+    return std::get<0>(std::move(item));
 }
 
 bool LL::WorkQueue::tryPop_(Work& work)
 {
-    return mQueue.tryPop(work);
+    Priority priority;
+    if (mLanes)
+    {
+        if (! mLanes->tryPop(this, work, priority))
+        {
+            return false;
+        }
+    }
+    else if (mLockFree)
+    {
+        if (! mLockFree->tryPop(work, priority))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        PrioritizedWork item;
+        if (! mQueue.tryPop(item))
+        {
+            return false;
+        }
+        work = std::get<0>(std::move(item));
+        priority = std::get<1>(item);
+    }
+    popped(priority);
+    return true;
 }
 
 /*****************************************************************************
@@ -296,9 +800,20 @@ bool LL::WorkSchedule::post(const Work& callable)
     return post(callable, TimePoint::clock::now());
 }
 
-bool LL::WorkSchedule::post(const Work& callable, const TimePoint& time)
+bool LL::WorkSchedule::post(const Work& callable, Priority priority)
 {
-    return mQueue.pushIfOpen(TimedWork(time, callable));
+    return post(callable, TimePoint::clock::now(), priority);
+}
+
+bool LL::WorkSchedule::post(const Work& callable, const TimePoint& time, Priority priority)
+{
+    posted(priority);
+    bool ok = mQueue.pushIfOpen(TimedWork(time, callable, priority));
+    if (! ok)
+    {
+        popped(priority);
+    }
+    return ok;
 }
 
 bool LL::WorkSchedule::tryPost(const Work& callable)
@@ -306,17 +821,37 @@ bool LL::WorkSchedule::tryPost(const Work& callable)
     return tryPost(callable, TimePoint::clock::now());
 }
 
-bool LL::WorkSchedule::tryPost(const Work& callable, const TimePoint& time)
+bool LL::WorkSchedule::tryPost(const Work& callable, Priority priority)
 {
-    return mQueue.tryPush(TimedWork(time, callable));
+    return tryPost(callable, TimePoint::clock::now(), priority);
+}
+
+bool LL::WorkSchedule::tryPost(const Work& callable, const TimePoint& time, Priority priority)
+{
+    posted(priority);
+    bool ok = mQueue.tryPush(TimedWork(time, callable, priority));
+    if (! ok)
+    {
+        popped(priority);
+    }
+    return ok;
 }
 
 LL::WorkSchedule::Work LL::WorkSchedule::pop_()
 {
-    return std::get<0>(mQueue.pop());
+    Queue::DataTuple item{ mQueue.pop() };
+    popped(std::get<1>(item));
+    return std::get<0>(std::move(item));
 }
 
 bool LL::WorkSchedule::tryPop_(Work& work)
 {
-    return mQueue.tryPop(work);
+    Queue::DataTuple item;
+    if (! mQueue.tryPop(item))
+    {
+        return false;
+    }
+    work = std::get<0>(std::move(item));
+    popped(std::get<1>(item));
+    return true;
 }
@@ -17,10 +17,14 @@
 #include "llinstancetracker.h"
 #include "llinstancetrackersubclass.h"
 #include "threadsafeschedule.h"
+#include <atomic>
 #include <chrono>
 #include <exception>                // std::current_exception
 #include <functional>               // std::function
+#include <memory>                   // std::unique_ptr
+#include <queue>
 #include <string>
+#include <tuple>
 
 namespace LL
 {
@@ -47,6 +51,23 @@ namespace LL
             Error(const std::string& what): LLException(what) {}
         };
 
+        /**
+         * Every work item belongs to a priority class. Consumers serve all
+         * ready URGENT work before any NORMAL work, and all NORMAL work
+         * before any BACKGROUND work; within a class, work runs in posting
+         * order (or timestamp order, for WorkSchedule). So that a flood of
+         * urgent work can't stall the rest indefinitely, a class that has
+         * been passed over STARVATION_LIMIT times in a row gets the next turn.
+         */
+        enum Priority
+        {
+            PRIORITY_URGENT,
+            PRIORITY_NORMAL,
+            PRIORITY_BACKGROUND,
+            PRIORITY_COUNT
+        };
+        static constexpr U32 STARVATION_LIMIT = 8;
+
         /**
          * You may omit the WorkQueueBase name, in which case a unique name is
          * synthesized; for practical purposes that makes it anonymous.
@@ -76,6 +97,14 @@ namespace LL
          *   meaningful.
          */
         virtual size_t size() = 0;
+        /// how many items of the specified priority class are waiting, with
+        /// the same caveats as size()
+        size_t getDepth(Priority priority) const { return mDepth[priority]; }
+        /// Record getDepth() of each class, summed over all queues, in the
+        /// workqueue_{urgent,normal,background}_depth LLTrace stats. Call
+        /// once a frame from the main thread: posting threads have no
+        /// LLTrace recorder to take the records.
+        static void sampleDepthStats();
         /// producer end: are we prevented from pushing any additional items?
         virtual bool isClosed() = 0;
         /// consumer end: are we done, is the queue entirely drained?
@@ -88,11 +117,22 @@ namespace LL
          */
         virtual bool post(const Work&) = 0;
 
+        /**
+         * post work in the specified priority class, unless the queue is
+         * closed before we can post
+         */
+        virtual bool post(const Work&, Priority) = 0;
+
         /**
          * post work, unless the queue is full
          */
         virtual bool tryPost(const Work&) = 0;
 
+        /**
+         * post work in the specified priority class, unless the queue is full
+         */
+        virtual bool tryPost(const Work&, Priority) = 0;
+
         /**
          * Post work to another WorkQueue, which may or may not still exist
          * and be open. Support any post() overload. Return true if we were
@@ -194,11 +234,50 @@ namespace LL
         static std::string makeName(const std::string& name);
         void callWork(const Work& work);
 
+        // maintain per-class depth, see sampleDepthStats()
+        void posted(Priority priority) { ++mDepth[priority]; }
+        void popped(Priority priority) { --mDepth[priority]; }
+
     private:
         virtual Work pop_() = 0;
         virtual bool tryPop_(Work&) = 0;
+
+        std::atomic<size_t> mDepth[PRIORITY_COUNT]{};
+        // our key, interned for LLTrace::TraceCapture
+        const char* mTraceName;
     };
 
+    namespace WorkQueuePrivate
+    {
+        /// LaneQueueAdapter traits for (Work, Priority) tuples
+        struct WorkLanes
+        {
+            template <typename Tuple>
+            static size_t lane(const Tuple& item) { return std::get<1>(item); }
+            template <typename Tuple>
+            static bool ready(const Tuple&) { return true; }
+            template <typename Tuple>
+            static bool before(const Tuple&, const Tuple&) { return false; }
+        };
+
+        /// LaneQueueAdapter traits for (TimePoint, Work, Priority) tuples
+        struct TimedWorkLanes
+        {
+            template <typename Tuple>
+            static size_t lane(const Tuple& item) { return std::get<2>(item); }
+            template <typename Tuple>
+            static bool ready(const Tuple& item)
+            {
+                return std::get<0>(item) <= std::chrono::steady_clock::now();
+            }
+            template <typename Tuple>
+            static bool before(const Tuple& left, const Tuple& right)
+            {
+                return std::get<0>(left) < std::get<0>(right);
+            }
+        };
+    } // namespace WorkQueuePrivate
+
 /*****************************************************************************
 *   WorkQueue: no timestamped task support
 *****************************************************************************/
@@ -213,6 +292,7 @@ namespace LL
          * synthesized; for practical purposes that makes it anonymous.
          */
         WorkQueue(const std::string& name = std::string(), size_t capacity=1024);
+        ~WorkQueue() override;
 
         /**
          * Since the point of WorkQueue is to pass work to some other worker
@@ -222,6 +302,44 @@ namespace LL
          */
         void close() override;
 
+        /**
+         * Switch to work-stealing mode for the specified number of worker
+         * threads. Instead of every worker contending for the lock on one
+         * shared queue, each worker owns a deque. Work posted by a worker
+         * goes onto its own deque (and runs LIFO, while its data are still
+         * hot); work posted by any other thread is dealt round-robin. A
+         * worker whose deque is empty steals the oldest item from a randomly
+         * chosen victim.
+         *
+         * Call this once, before starting the workers. Anything already
+         * posted is carried over. In this mode capacity only constrains
+         * tryPost(): post() never blocks.
+         */
+        void enableWorkStealing(size_t workers);
+        bool isWorkStealing() const { return bool(mLanes); }
+
+        /**
+         * Switch to lock-free storage: one LLLockFreeQueue per priority
+         * class, so that threads posting at the same time never contend for
+         * a lock, either with each other or with the workers. Priority
+         * classes are served as usual, but within a class, work posted by
+         * different threads may run in either order.
+         *
+         * Call this once, before starting the workers. Anything already
+         * posted is carried over. A work-stealing WorkQueue ignores it, as
+         * enableWorkStealing() ignores a lock-free one.
+         */
+        void enableLockFree();
+        bool isLockFree() const { return bool(mLockFree); }
+
+        /**
+         * Identify the calling thread as worker 'index' (0-based) of this
+         * work-stealing WorkQueue. ThreadPool does this for each of its
+         * threads. Threads that never call it can still post and run work,
+         * they just have no deque of their own.
+         */
+        void bindWorker(size_t index);
+
         /**
          * WorkQueue supports multiple producers and multiple consumers. In
          * the general case it's misleading to test size(), since any other
@@ -249,14 +367,36 @@ namespace LL
          */
         bool post(const Work&) override;
 
+        /**
+         * post work in the specified priority class, unless the queue is
+         * closed before we can post
+         */
+        bool post(const Work&, Priority) override;
+
         /**
          * post work, unless the queue is full
          */
         bool tryPost(const Work&) override;
 
+        /**
+         * post work in the specified priority class, unless the queue is full
+         */
+        bool tryPost(const Work&, Priority) override;
+
     private:
-        using Queue = LLThreadSafeQueue<Work>;
+        using PrioritizedWork = std::tuple<Work, Priority>;
+        using Queue = LLThreadSafeQueue<
+            PrioritizedWork,
+            LaneQueueAdapter<std::queue<PrioritizedWork>, PRIORITY_COUNT,
+                             WorkQueuePrivate::WorkLanes, STARVATION_LIMIT>>;
         Queue mQueue;
+        // per-worker deques, only in work-stealing mode
+        struct Lanes;
+        std::unique_ptr<Lanes> mLanes;
+        // per-class lock-free queues, only in lock-free mode
+        struct LockFree;
+        std::unique_ptr<LockFree> mLockFree;
+        size_t mCapacity;
 
         Work pop_() override;
         bool tryPop_(Work&) override;
@@ -269,7 +409,11 @@ namespace LL
     {
     private:
         using super = LLInstanceTrackerSubclass<WorkSchedule, WorkQueueBase>;
-        using Queue = ThreadSafeSchedule<Work>;
+        using Queue = ThreadSafeScheduleUsing<
+            LaneQueueAdapter<ThreadSafeSchedulePrivate::TimedQueue<Work, Priority>,
+                             PRIORITY_COUNT, WorkQueuePrivate::TimedWorkLanes,
+                             STARVATION_LIMIT>,
+            Work, Priority>;
         // helper for postEvery()
         template <typename Rep, typename Period, typename CALLABLE>
         class BackJack;
@@ -319,21 +463,34 @@ namespace LL
          */
         bool post(const Work& callable) override;
 
+        /**
+         * post work in the specified priority class, unless the queue is
+         * closed before we can post
+         */
+        bool post(const Work& callable, Priority priority) override;
+
         /**
          * post work for a particular time, unless the queue is closed before
          * we can post
          */
-        bool post(const Work& callable, const TimePoint& time);
+        bool post(const Work& callable, const TimePoint& time,
+                  Priority priority=PRIORITY_NORMAL);
 
         /**
          * post work, unless the queue is full
          */
         bool tryPost(const Work& callable) override;
 
+        /**
+         * post work in the specified priority class, unless the queue is full
+         */
+        bool tryPost(const Work& callable, Priority priority) override;
+
         /**
          * post work for a particular time, unless the queue is full
          */
-        bool tryPost(const Work& callable, const TimePoint& time);
+        bool tryPost(const Work& callable, const TimePoint& time,
+                     Priority priority=PRIORITY_NORMAL);
 
         /**
          * Launch a callable returning bool that will trigger repeatedly at
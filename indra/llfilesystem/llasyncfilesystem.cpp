@@ -0,0 +1,263 @@
+/**
+ * @file   llasyncfilesystem.cpp
+ * @date   2026-10-18
+ * @brief  Implementation for llasyncfilesystem.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llasyncfilesystem.h"
+
+#include "llfilesystem.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <map>
+
+struct LLAsyncFileSystem::Batch
+{
+    batch_t mRequests;
+    // each read request's range, clipped to its file; groups only touch
+    // their own requests' entries
+    std::vector<std::pair<S32, S32>> mRanges;
+    std::atomic<size_t> mRemaining{ 0 };
+    LL::WorkQueue::weak_t mReply;
+    bool mHasReply{ false };
+    callback_t mCallback;
+
+    // called by whichever group of requests finishes last
+    void finish()
+    {
+        if (! mHasReply)
+        {
+            mCallback(std::move(mRequests));
+        }
+        else
+        {
+            // Batch is shared by the lambdas that are still unwinding, so
+            // hand over the results rather than the Batch.
+            auto requests = std::make_shared<batch_t>(std::move(mRequests));
+            LL::WorkQueue::postMaybe(mReply,
+                                     [requests, callback = std::move(mCallback)]()
+                                     {
+                                         callback(std::move(*requests));
+                                     });
+        }
+    }
+};
+
+LLAsyncFileSystem::LLAsyncFileSystem(size_t threads)
+{
+    mThreadPool.reset(new LL::ThreadPool("FileSystemIO", threads));
+    mThreadPool->start();
+}
+
+LLAsyncFileSystem::~LLAsyncFileSystem()
+{
+    mThreadPool->close();
+}
+
+bool LLAsyncFileSystem::read(batch_t&& batch, const LL::WorkQueue::weak_t& reply, callback_t callback)
+{
+    return post(std::move(batch), false, true, reply, std::move(callback));
+}
+
+bool LLAsyncFileSystem::read(batch_t&& batch, callback_t callback)
+{
+    return post(std::move(batch), false, false, {}, std::move(callback));
+}
+
+bool LLAsyncFileSystem::write(batch_t&& batch, const LL::WorkQueue::weak_t& reply, callback_t callback)
+{
+    return post(std::move(batch), true, true, reply, std::move(callback));
+}
+
+bool LLAsyncFileSystem::write(batch_t&& batch, callback_t callback)
+{
+    return post(std::move(batch), true, false, {}, std::move(callback));
+}
+
+size_t LLAsyncFileSystem::getPending() const
+{
+    return mThreadPool->getQueue().size();
+}
+
+bool LLAsyncFileSystem::post(batch_t&& requests, bool writing, bool has_reply,
+                             const LL::WorkQueue::weak_t& reply, callback_t callback)
+{
+    auto batch = std::make_shared<Batch>();
+    batch->mRequests = std::move(requests);
+    batch->mReply = reply;
+    batch->mHasReply = has_reply;
+    batch->mCallback = std::move(callback);
+
+    // one group per asset, keeping each asset's requests in order
+    std::map<std::pair<LLUUID, S32>, std::vector<size_t>> groups;
+    for (size_t i = 0; i < batch->mRequests.size(); ++i)
+    {
+        const Request& request = batch->mRequests[i];
+        groups[{ request.mFileID, (S32)request.mFileType }].push_back(i);
+    }
+    if (groups.empty())
+    {
+        batch->mRemaining = 1;
+        if (! mThreadPool->getQueue().post([batch]() { batch->finish(); }))
+        {
+            requests = std::move(batch->mRequests);
+            return false;
+        }
+        return true;
+    }
+    if (! writing)
+    {
+        batch->mRanges.resize(batch->mRequests.size());
+    }
+
+    batch->mRemaining = groups.size();
+    size_t posted = 0;
+    for (auto& group : groups)
+    {
+        auto indices = std::make_shared<std::vector<size_t>>(std::move(group.second));
+        const bool ok = mThreadPool->getQueue().post(
+            [this, batch, indices, writing]()
+            {
+                if (writing)
+                {
+                    writeAsset(*batch, *indices);
+                }
+                else
+                {
+                    readAsset(*batch, *indices);
+                }
+                if (--batch->mRemaining == 0)
+                {
+                    batch->finish();
+                }
+            });
+        if (! ok)
+        {
+            break;
+        }
+        ++posted;
+    }
+    if (posted == 0)
+    {
+        // nothing reached the pool, so the caller can have the batch back
+        requests = std::move(batch->mRequests);
+        return false;
+    }
+    if (posted < groups.size())
+    {
+        // The pool is shutting down. The groups already posted may or may
+        // not run, so the callback can't be promised either way: drop it.
+        batch->mCallback = [](batch_t&&) {};
+        batch->mRemaining -= groups.size() - posted;
+        return false;
+    }
+    return true;
+}
+
+void LLAsyncFileSystem::readAsset(Batch& batch, std::vector<size_t>& indices)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    batch_t& requests = batch.mRequests;
+    const Request& first = requests[indices.front()];
+    LLFileSystem file(first.mFileID, first.mFileType, LLFileSystem::READ);
+    const S32 size = file.getSize();
+
+    // each request's range, clipped to the file
+    std::vector<std::pair<S32, S32>>& ranges = batch.mRanges;
+    for (size_t index : indices)
+    {
+        Request& request = requests[index];
+        request.mData.clear();
+        if (request.mOffset < 0 || request.mOffset >= size)
+        {
+            request.mResult = size > 0 ? 0 : -1;
+            continue;
+        }
+        const S32 available = size - request.mOffset;
+        const S32 bytes = request.mBytes < 0 ? available : llmin(request.mBytes, available);
+        ranges[index] = { request.mOffset, request.mOffset + bytes };
+    }
+    indices.erase(std::remove_if(indices.begin(), indices.end(),
+                                 [&ranges](size_t index) { return ranges[index].second <= ranges[index].first; }),
+                  indices.end());
+    std::sort(indices.begin(), indices.end(),
+              [&ranges](size_t a, size_t b) { return ranges[a].first < ranges[b].first; });
+
+    std::vector<U8> span;
+    for (size_t begin = 0; begin < indices.size(); )
+    {
+        // grow the span over every following range near enough to it
+        const S32 start = ranges[indices[begin]].first;
+        S32 end = ranges[indices[begin]].second;
+        size_t stop = begin + 1;
+        for (; stop < indices.size(); ++stop)
+        {
+            const std::pair<S32, S32>& next = ranges[indices[stop]];
+            if (next.first > end + COALESCE_GAP || llmax(end, next.second) - start > COALESCE_MAX)
+            {
+                break;
+            }
+            end = llmax(end, next.second);
+        }
+
+        S32 bytes_read = 0;
+        span.resize(end - start);
+        if (file.seek(start, 0) && file.read(span.data(), end - start))
+        {
+            bytes_read = file.getLastBytesRead();
+        }
+        mCoalesced += stop - begin - 1;
+
+        for (size_t i = begin; i < stop; ++i)
+        {
+            Request& request = requests[indices[i]];
+            const S32 from = ranges[indices[i]].first - start;
+            const S32 count = llclamp(bytes_read - from, 0, ranges[indices[i]].second - ranges[indices[i]].first);
+            request.mData.assign(span.data() + from, span.data() + from + count);
+            request.mResult = count;
+        }
+        begin = stop;
+    }
+}
+
+// static
+void LLAsyncFileSystem::writeAsset(Batch& batch, const std::vector<size_t>& indices)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    for (size_t index : indices)
+    {
+        Request& request = batch.mRequests[index];
+        const S32 mode = request.mMode ? request.mMode : LLFileSystem::READ_WRITE;
+        LLFileSystem file(request.mFileID, request.mFileType, mode);
+        if (mode == LLFileSystem::READ_WRITE && request.mOffset > 0 && ! file.seek(request.mOffset, 0))
+        {
+            request.mResult = -1;
+            continue;
+        }
+        const S32 bytes = (S32)request.mData.size();
+        request.mResult = file.write(request.mData.data(), bytes) ? bytes : -1;
+    }
+}
@@ -0,0 +1,125 @@
+/**
+ * @file   llasyncfilesystem.h
+ * @date   2026-10-18
+ * @brief  Batched cache reads and writes on a thread pool.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLASYNCFILESYSTEM_H
+#define LL_LLASYNCFILESYSTEM_H
+
+#include "llassettype.h"
+#include "llsingleton.h"
+#include "lluuid.h"
+#include "threadpool_fwd.h"
+#include "workqueue.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * LLAsyncFileSystem runs batches of LLFileSystem reads and writes on the
+ * "FileSystemIO" LL::ThreadPool (its width can be set in the usual
+ * "ThreadPoolSizes" setting) and hands the completed batch to a callback on
+ * the caller's choice of WorkQueue.
+ *
+ * A batch is split up by asset, so different assets are read in parallel
+ * while the requests for any one asset run in order on one thread. Reads of
+ * the same asset whose ranges overlap or nearly touch are coalesced into a
+ * single read, which matters for the mesh LODs of one asset lying end to end
+ * in its cache file.
+ *
+ * Everything still goes through LLFileSystem, so the cache index, the pack
+ * store and the loose files behave exactly as they do for synchronous use.
+ */
+class LLAsyncFileSystem : public LLSimpleton<LLAsyncFileSystem>
+{
+public:
+    struct Request
+    {
+        Request() = default;
+        Request(const LLUUID& file_id, LLAssetType::EType file_type, S32 offset = 0, S32 bytes = -1):
+            mFileID(file_id),
+            mFileType(file_type),
+            mOffset(offset),
+            mBytes(bytes)
+        {}
+
+        LLUUID mFileID;
+        LLAssetType::EType mFileType{ LLAssetType::AT_NONE };
+        S32 mOffset{ 0 };
+        // for reads, -1 means through the end of the file
+        S32 mBytes{ -1 };
+        // for writes, an LLFileSystem mode; APPEND ignores mOffset
+        S32 mMode{ 0 };
+        // the data to write, or that was read
+        std::vector<U8> mData;
+        // bytes read or written, or -1 if the file couldn't be opened
+        S32 mResult{ 0 };
+    };
+    typedef std::vector<Request> batch_t;
+    typedef std::function<void(batch_t&&)> callback_t;
+
+    LLAsyncFileSystem(size_t threads = 4);
+    ~LLAsyncFileSystem();
+
+    /**
+     * Queue a batch of reads. Once all of them are done, callback is called
+     * on reply with the batch, each request's mData and mResult filled in.
+     * Without a reply queue, callback runs on the I/O thread that finished
+     * last. Returns false if the pool has shut down, in which case callback
+     * won't be called; nor is it if reply goes away first. When none of the
+     * batch reached the pool, it's left in batch for the caller to handle.
+     */
+    bool read(batch_t&& batch, const LL::WorkQueue::weak_t& reply, callback_t callback);
+    bool read(batch_t&& batch, callback_t callback);
+
+    /**
+     * Queue a batch of writes, as for read(). A request with mMode 0 is
+     * written with LLFileSystem::READ_WRITE.
+     */
+    bool write(batch_t&& batch, const LL::WorkQueue::weak_t& reply, callback_t callback);
+    bool write(batch_t&& batch, callback_t callback);
+
+    size_t getPending() const;
+    /// reads saved by coalescing since startup
+    U64 getCoalescedCount() const { return mCoalesced; }
+
+    /// ranges of one asset closer than this are read as one
+    static const S32 COALESCE_GAP = 16 * 1024;
+    /// but no single read grows past this
+    static const S32 COALESCE_MAX = 4 * 1024 * 1024;
+
+private:
+    struct Batch;
+    bool post(batch_t&& batch, bool writing, bool has_reply,
+              const LL::WorkQueue::weak_t& reply, callback_t callback);
+    void readAsset(Batch& batch, std::vector<size_t>& indices);
+    static void writeAsset(Batch& batch, const std::vector<size_t>& indices);
+
+    std::unique_ptr<LL::ThreadPool> mThreadPool;
+    std::atomic<U64> mCoalesced{ 0 };
+};
+
+#endif // LL_LLASYNCFILESYSTEM_H
@@ -0,0 +1,592 @@
+/**
+ * @file   llcachecompressor.cpp
+ * @date   2026-10-18
+ * @brief  Dictionary compression for cache entries.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llcachecompressor.h"
+
+#include "llfile.h"
+#include "workqueue.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <queue>
+
+#ifdef LL_USESYSTEMLIBS
+# include <zlib.h>
+#else
+# include "zlib-ng/zlib.h"
+#endif
+
+namespace
+{
+    const U8 FRAME_MAGIC[8] = { 0x89, 'L', 'L', 'C', 'Z', '\r', '\n', 0x1a };
+    const char DICTIONARY_MAGIC[8] = { 'L', 'L', 'C', 'D', 'I', 'C', 'T', '1' };
+
+    // Higher levels cost more time for little gain on entries this small:
+    // the dictionary does most of the work.
+    const int COMPRESSION_LEVEL = 3;
+    // smaller entries aren't worth the bother
+    const size_t MIN_ENTRY_SIZE = 64;
+    const size_t MAX_ENTRY_SIZE = 64 * 1024 * 1024;
+    // an entry must shrink by at least 1/MIN_SAVING to be stored compressed
+    const size_t MIN_SAVING = 8;
+
+    // Train on this many times the dictionary size of samples, each no more
+    // than a quarter of the dictionary, and no fewer than MIN_SAMPLES.
+    const size_t SAMPLE_BYTES_FACTOR = 32;
+    const size_t MIN_SAMPLES = 32;
+
+    typedef std::chrono::steady_clock steady_clock_t;
+
+    U64 micros_since(const steady_clock_t::time_point& start)
+    {
+        return (U64)std::chrono::duration_cast<std::chrono::microseconds>(steady_clock_t::now() - start).count();
+    }
+
+    U32 dictionary_id(const std::string& data)
+    {
+        const U32 id = (U32)adler32(adler32(0L, Z_NULL, 0), (const Bytef*)data.data(), (uInt)data.size());
+        // 0 means no dictionary
+        return id ? id : 1;
+    }
+
+    // Deflate and inflate state runs to a few hundred KB: keep one of each
+    // per thread rather than set them up for every entry.
+    class ZStreams
+    {
+    public:
+        ~ZStreams()
+        {
+            if (mDeflateReady)
+            {
+                deflateEnd(&mDeflate);
+            }
+            if (mInflateReady)
+            {
+                inflateEnd(&mInflate);
+            }
+        }
+
+        z_stream* deflater()
+        {
+            if (mDeflateReady)
+            {
+                deflateReset(&mDeflate);
+                return &mDeflate;
+            }
+            memset(&mDeflate, 0, sizeof(mDeflate));
+            // raw deflate: the caller's framing knows the size and dictionary
+            mDeflateReady = deflateInit2(&mDeflate, COMPRESSION_LEVEL, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+            return mDeflateReady ? &mDeflate : nullptr;
+        }
+
+        z_stream* inflater()
+        {
+            if (mInflateReady)
+            {
+                inflateReset(&mInflate);
+                return &mInflate;
+            }
+            memset(&mInflate, 0, sizeof(mInflate));
+            mInflateReady = inflateInit2(&mInflate, -MAX_WBITS) == Z_OK;
+            return mInflateReady ? &mInflate : nullptr;
+        }
+
+    private:
+        z_stream mDeflate;
+        z_stream mInflate;
+        bool mDeflateReady{ false };
+        bool mInflateReady{ false };
+    };
+    thread_local ZStreams sZStreams;
+
+    struct FrameHeader
+    {
+        U8 mMagic[8];
+        U32 mRawSize;
+        U32 mDictionaryID;
+    };
+}
+
+LLCacheCompressor::LLCacheCompressor(size_t dictionary_size, bool require_dictionary):
+    mDictionarySize(llclamp(dictionary_size, size_t(1024), MAX_DICTIONARY_SIZE)),
+    mRequireDictionary(require_dictionary),
+    mState(std::make_shared<State>())
+{
+    static_assert(sizeof(FrameHeader) == FRAME_HEADER_SIZE, "frame header layout changed");
+}
+
+LLCacheCompressor::~LLCacheCompressor()
+{
+}
+
+void LLCacheCompressor::setDictionaryFile(const std::string& filename)
+{
+    std::shared_ptr<Dictionary> dictionary;
+    LLFILE* file = LLFile::fopen(filename, "rb");
+    if (file)
+    {
+        char magic[sizeof(DICTIONARY_MAGIC)];
+        U32 id = 0;
+        std::string data(mDictionarySize + 1, '\0');
+        if (fread(magic, 1, sizeof(magic), file) == sizeof(magic)
+            && ! memcmp(magic, DICTIONARY_MAGIC, sizeof(magic))
+            && fread(&id, 1, sizeof(id), file) == sizeof(id))
+        {
+            data.resize(fread(&data[0], 1, data.size(), file));
+            if (! data.empty() && data.size() <= mDictionarySize && dictionary_id(data) == id)
+            {
+                dictionary = std::make_shared<Dictionary>();
+                dictionary->mData.swap(data);
+                dictionary->mID = id;
+            }
+        }
+        fclose(file);
+        if (! dictionary)
+        {
+            LL_WARNS() << "Ignoring damaged cache dictionary " << filename << LL_ENDL;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mState->mMutex);
+    mState->mFilename = filename;
+    mState->mDictionary = dictionary;
+    mState->mSamples.clear();
+    mState->mSampleBytes = 0;
+}
+
+U32 LLCacheCompressor::getDictionaryID() const
+{
+    std::shared_ptr<const Dictionary> dictionary = getDictionary();
+    return dictionary ? dictionary->mID : 0;
+}
+
+std::shared_ptr<const LLCacheCompressor::Dictionary> LLCacheCompressor::getDictionary() const
+{
+    std::lock_guard<std::mutex> lock(mState->mMutex);
+    return mState->mDictionary;
+}
+
+bool LLCacheCompressor::compress(const U8* data, size_t size, std::vector<U8>& out, U32& dictionary_id)
+{
+    out.clear();
+    return encode(data, size, 0, out, dictionary_id);
+}
+
+bool LLCacheCompressor::compressFrame(const U8* data, size_t size, std::vector<U8>& out)
+{
+    out.resize(FRAME_HEADER_SIZE);
+    FrameHeader header;
+    if (! encode(data, size, FRAME_HEADER_SIZE, out, header.mDictionaryID))
+    {
+        return false;
+    }
+    memcpy(header.mMagic, FRAME_MAGIC, sizeof(header.mMagic));
+    header.mRawSize = (U32)size;
+    memcpy(out.data(), &header, FRAME_HEADER_SIZE);
+    return true;
+}
+
+bool LLCacheCompressor::encode(const U8* data, size_t size, size_t offset, std::vector<U8>& out, U32& dictionary_id)
+{
+    if (! mEnabled || ! data || size < MIN_ENTRY_SIZE || size > MAX_ENTRY_SIZE)
+    {
+        return false;
+    }
+    std::shared_ptr<const Dictionary> dictionary = getDictionary();
+    if (! dictionary)
+    {
+        addSample(data, size);
+        if (mRequireDictionary)
+        {
+            return false;
+        }
+    }
+
+    LL_PROFILE_ZONE_SCOPED;
+    const steady_clock_t::time_point start = steady_clock_t::now();
+    z_stream* stream = sZStreams.deflater();
+    if (! stream
+        || (dictionary && deflateSetDictionary(stream, (const Bytef*)dictionary->mData.data(), (uInt)dictionary->mData.size()) != Z_OK))
+    {
+        return false;
+    }
+
+    // give deflate only as much room as would make it worthwhile, so that it
+    // gives up early on data that doesn't compress
+    const size_t limit = size - size / MIN_SAVING;
+    if (limit <= offset)
+    {
+        return false;
+    }
+    out.resize(limit);
+    stream->next_in = const_cast<Bytef*>(data);
+    stream->avail_in = (uInt)size;
+    stream->next_out = out.data() + offset;
+    stream->avail_out = (uInt)(limit - offset);
+    const bool success = deflate(stream, Z_FINISH) == Z_STREAM_END;
+    mEncodeMicros += micros_since(start);
+    if (! success)
+    {
+        ++mStored;
+        return false;
+    }
+
+    out.resize(limit - stream->avail_out);
+    dictionary_id = dictionary ? dictionary->mID : 0;
+    ++mCompressed;
+    mRawBytes += size;
+    mCompressedBytes += out.size();
+    return true;
+}
+
+bool LLCacheCompressor::decompress(const U8* data, size_t size, U32 dictionary_id, U8* out, size_t raw_size)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    const steady_clock_t::time_point start = steady_clock_t::now();
+    std::shared_ptr<const Dictionary> dictionary;
+    if (dictionary_id)
+    {
+        dictionary = getDictionary();
+    }
+
+    z_stream* stream = (! dictionary_id || (dictionary && dictionary->mID == dictionary_id)) ? sZStreams.inflater() : nullptr;
+    bool success = stream && data && out && raw_size > 0 && raw_size <= MAX_ENTRY_SIZE;
+    if (success && dictionary)
+    {
+        success = inflateSetDictionary(stream, (const Bytef*)dictionary->mData.data(), (uInt)dictionary->mData.size()) == Z_OK;
+    }
+    if (success)
+    {
+        stream->next_in = const_cast<Bytef*>(data);
+        stream->avail_in = (uInt)size;
+        stream->next_out = out;
+        stream->avail_out = (uInt)raw_size;
+        success = inflate(stream, Z_FINISH) == Z_STREAM_END && stream->avail_out == 0;
+    }
+
+    mDecodeMicros += micros_since(start);
+    if (success)
+    {
+        ++mDecoded;
+        mDecodedBytes += raw_size;
+    }
+    else
+    {
+        ++mFailed;
+    }
+    return success;
+}
+
+// static
+bool LLCacheCompressor::readFrameHeader(const U8* header, size_t size, U32& raw_size)
+{
+    if (! header || size < FRAME_HEADER_SIZE || memcmp(header, FRAME_MAGIC, sizeof(FRAME_MAGIC)))
+    {
+        return false;
+    }
+    FrameHeader frame;
+    memcpy(&frame, header, FRAME_HEADER_SIZE);
+    raw_size = frame.mRawSize;
+    return true;
+}
+
+bool LLCacheCompressor::decompressFrame(const U8* data, size_t size, std::vector<U8>& out)
+{
+    U32 raw_size = 0;
+    if (! readFrameHeader(data, size, raw_size))
+    {
+        return false;
+    }
+    FrameHeader frame;
+    memcpy(&frame, data, FRAME_HEADER_SIZE);
+    if (raw_size > MAX_ENTRY_SIZE)
+    {
+        ++mFailed;
+        return false;
+    }
+    out.resize(raw_size);
+    return decompress(data + FRAME_HEADER_SIZE, size - FRAME_HEADER_SIZE, frame.mDictionaryID, out.data(), raw_size);
+}
+
+void LLCacheCompressor::reset()
+{
+    std::string filename;
+    {
+        std::lock_guard<std::mutex> lock(mState->mMutex);
+        mState->mDictionary.reset();
+        mState->mSamples.clear();
+        mState->mSampleBytes = 0;
+        mState->mTraining = false;
+        ++mState->mGeneration;
+        filename = mState->mFilename;
+    }
+    if (! filename.empty())
+    {
+        LLFile::remove(filename, ENOENT);
+    }
+}
+
+LLCacheCompressor::Stats LLCacheCompressor::getStats() const
+{
+    Stats stats;
+    stats.mCompressed = mCompressed;
+    stats.mRawBytes = mRawBytes;
+    stats.mCompressedBytes = mCompressedBytes;
+    stats.mStored = mStored;
+    stats.mEncodeMicros = mEncodeMicros;
+    stats.mDecoded = mDecoded;
+    stats.mDecodedBytes = mDecodedBytes;
+    stats.mDecodeMicros = mDecodeMicros;
+    stats.mFailed = mFailed;
+    return stats;
+}
+
+void LLCacheCompressor::addSample(const U8* data, size_t size)
+{
+    std::vector<std::string> samples;
+    U32 generation;
+    {
+        std::lock_guard<std::mutex> lock(mState->mMutex);
+        if (mState->mDictionary || mState->mTraining)
+        {
+            return;
+        }
+        mState->mSamples.emplace_back((const char*)data, llmin(size, mDictionarySize / 4));
+        mState->mSampleBytes += mState->mSamples.back().size();
+        if (mState->mSampleBytes < mDictionarySize * SAMPLE_BYTES_FACTOR || mState->mSamples.size() < MIN_SAMPLES)
+        {
+            return;
+        }
+        samples.swap(mState->mSamples);
+        mState->mSampleBytes = 0;
+        mState->mTraining = true;
+        generation = mState->mGeneration;
+    }
+
+    const size_t capacity = mDictionarySize;
+    const size_t segment_size = llclamp(mDictionarySize / 128, size_t(64), size_t(1024));
+    std::weak_ptr<State> weak_state(mState);
+    auto train = [weak_state, samples, capacity, segment_size, generation]()
+        {
+            std::string dictionary = trainDictionary(samples, capacity, segment_size);
+            if (std::shared_ptr<State> state = weak_state.lock())
+            {
+                install(*state, std::move(dictionary), generation);
+            }
+        };
+    LL::WorkQueue::ptr_t queue = LL::WorkQueue::getInstance("General");
+    if (! queue || ! queue->post(train))
+    {
+        train();
+    }
+}
+
+// static
+void LLCacheCompressor::install(State& state, std::string&& dictionary, U32 generation)
+{
+    std::lock_guard<std::mutex> lock(state.mMutex);
+    if (generation != state.mGeneration)
+    {
+        return;
+    }
+    // with too little in common, gather another round of samples
+    state.mTraining = false;
+    if (dictionary.empty())
+    {
+        return;
+    }
+
+    std::shared_ptr<Dictionary> installed = std::make_shared<Dictionary>();
+    installed->mData.swap(dictionary);
+    installed->mID = dictionary_id(installed->mData);
+    state.mDictionary = installed;
+    state.mSamples.clear();
+    state.mSampleBytes = 0;
+    LL_INFOS() << "Trained a " << installed->mData.size() << " byte cache dictionary for " << state.mFilename << LL_ENDL;
+
+    if (state.mFilename.empty())
+    {
+        return;
+    }
+    LLFILE* file = LLFile::fopen(state.mFilename, "wb");
+    bool saved = false;
+    if (file)
+    {
+        saved = fwrite(DICTIONARY_MAGIC, 1, sizeof(DICTIONARY_MAGIC), file) == sizeof(DICTIONARY_MAGIC)
+            && fwrite(&installed->mID, 1, sizeof(installed->mID), file) == sizeof(installed->mID)
+            && fwrite(installed->mData.data(), 1, installed->mData.size(), file) == installed->mData.size();
+        saved = (fclose(file) == 0) && saved;
+    }
+    if (! saved)
+    {
+        // whatever is compressed with it this session would be unreadable
+        // next time; carry on without one rather than train again
+        LL_WARNS() << "Failed to save cache dictionary " << state.mFilename << LL_ENDL;
+        LLFile::remove(state.mFilename, ENOENT);
+        state.mDictionary.reset();
+        state.mTraining = true;
+    }
+}
+
+// static
+std::string LLCacheCompressor::trainDictionary(const std::vector<std::string>& samples, size_t capacity, size_t segment_size)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    // Score every run of DMER bytes by the number of samples it turns up in.
+    // Runs are hashed into a fixed table: a collision only makes a run look
+    // a little more common than it is.
+    const size_t DMER = 8;
+    const U32 TABLE_BITS = 20;
+    auto hash_at = [](const char* data) -> U32
+        {
+            U64 value;
+            memcpy(&value, data, sizeof(value));
+            return (U32)((value * 0x9E3779B97F4A7C15ULL) >> (64 - TABLE_BITS));
+        };
+    segment_size = llmax(segment_size, DMER * 2);
+
+    std::vector<U32> frequency(size_t(1) << TABLE_BITS, 0);
+    {
+        std::vector<U32> last_sample(size_t(1) << TABLE_BITS, 0);
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            const std::string& sample = samples[i];
+            for (size_t pos = 0; pos + DMER <= sample.size(); ++pos)
+            {
+                const U32 hash = hash_at(sample.data() + pos);
+                if (last_sample[hash] != i + 1)
+                {
+                    last_sample[hash] = (U32)(i + 1);
+                    ++frequency[hash];
+                }
+            }
+        }
+    }
+
+    // candidate segments overlap by three quarters
+    struct Segment
+    {
+        U32 mSample;
+        U32 mOffset;
+        U32 mSize;
+    };
+    std::vector<Segment> segments;
+    for (size_t i = 0; i < samples.size(); ++i)
+    {
+        const size_t size = samples[i].size();
+        if (size < DMER * 2)
+        {
+            continue;
+        }
+        if (size <= segment_size)
+        {
+            segments.push_back({ (U32)i, 0, (U32)size });
+            continue;
+        }
+        for (size_t pos = 0; pos + segment_size <= size; pos += segment_size / 4)
+        {
+            segments.push_back({ (U32)i, (U32)pos, (U32)segment_size });
+        }
+    }
+
+    // A segment is worth the runs in it that more than one sample shares,
+    // each counted once.
+    std::vector<U32> hashes;
+    auto score = [&](const Segment& segment) -> U64
+        {
+            const char* data = samples[segment.mSample].data() + segment.mOffset;
+            hashes.clear();
+            for (size_t pos = 0; pos + DMER <= segment.mSize; ++pos)
+            {
+                hashes.push_back(hash_at(data + pos));
+            }
+            std::sort(hashes.begin(), hashes.end());
+            hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+            U64 total = 0;
+            for (U32 hash : hashes)
+            {
+                if (frequency[hash] > 1)
+                {
+                    total += frequency[hash];
+                }
+            }
+            return total;
+        };
+
+    std::priority_queue<std::pair<U64, U32>> queue;
+    for (size_t i = 0; i < segments.size(); ++i)
+    {
+        const U64 value = score(segments[i]);
+        if (value)
+        {
+            queue.emplace(value, (U32)i);
+        }
+    }
+
+    // Greedily take the best segment, then stop counting the runs it covers.
+    // Scores only ever fall, so a queued score is an upper bound: one that
+    // still holds once recomputed is the best there is.
+    std::vector<U32> chosen;
+    size_t used = 0;
+    while (! queue.empty() && used < capacity)
+    {
+        const std::pair<U64, U32> top = queue.top();
+        queue.pop();
+        const Segment& segment = segments[top.second];
+        const U64 value = score(segment);
+        if (! value)
+        {
+            continue;
+        }
+        if (value < top.first)
+        {
+            queue.emplace(value, top.second);
+            continue;
+        }
+        if (used + segment.mSize > capacity)
+        {
+            continue;
+        }
+        chosen.push_back(top.second);
+        used += segment.mSize;
+        for (U32 hash : hashes)
+        {
+            frequency[hash] = 0;
+        }
+    }
+
+    std::string dictionary;
+    dictionary.reserve(used);
+    for (auto it = chosen.rbegin(); it != chosen.rend(); ++it)
+    {
+        const Segment& segment = segments[*it];
+        dictionary.append(samples[segment.mSample], segment.mOffset, segment.mSize);
+    }
+    return dictionary;
+}
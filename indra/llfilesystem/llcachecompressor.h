@@ -0,0 +1,175 @@
+/**
+ * @file   llcachecompressor.h
+ * @date   2026-10-18
+ * @brief  Dictionary compression for cache entries.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLCACHECOMPRESSOR_H
+#define LL_LLCACHECOMPRESSOR_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * LLCacheCompressor deflates cache entries for storage, priming zlib with a
+ * dictionary trained on the cache's own contents. Cache entries are small
+ * and much alike, so most of what one holds is already in the dictionary and
+ * even a few hundred bytes compress well, which plain deflate can't manage
+ * with no history to refer back to.
+ *
+ * Until there is a dictionary, what compress() is given is also kept as
+ * training samples. Once enough has been seen, a dictionary is built from
+ * them on the "General" work queue (inline if there is none) and saved in
+ * the dictionary file. It is never retrained after that, so whatever the
+ * cache holds stays readable; reset() when the cache is emptied starts over.
+ * Compressed entries name their dictionary, and decompress() won't use any
+ * other.
+ *
+ * Decoding happens on the caller's thread, so readers on worker threads pay
+ * for their own. All methods are thread safe.
+ */
+class LLCacheCompressor
+{
+public:
+    struct Stats
+    {
+        // entries stored compressed, with their sizes before and after
+        U64 mCompressed{ 0 };
+        U64 mRawBytes{ 0 };
+        U64 mCompressedBytes{ 0 };
+        // entries that wouldn't compress well enough and were stored as is
+        U64 mStored{ 0 };
+        U64 mEncodeMicros{ 0 };
+        // entries inflated, their inflated size and the time it took
+        U64 mDecoded{ 0 };
+        U64 mDecodedBytes{ 0 };
+        U64 mDecodeMicros{ 0 };
+        // entries that couldn't be inflated
+        U64 mFailed{ 0 };
+
+        F32 getRatio() const { return mCompressedBytes ? (F32)mRawBytes / (F32)mCompressedBytes : 1.f; }
+        F32 getDecodeMicrosPerKB() const { return mDecodedBytes ? (F32)mDecodeMicros * 1024.f / (F32)mDecodedBytes : 0.f; }
+    };
+
+    /**
+     * A dictionary holds at most dictionary_size bytes. With
+     * require_dictionary, nothing is compressed before there is one: for
+     * entries too small to compress on their own.
+     */
+    LLCacheCompressor(size_t dictionary_size = MAX_DICTIONARY_SIZE, bool require_dictionary = false);
+    ~LLCacheCompressor();
+
+    LLCacheCompressor(const LLCacheCompressor&) = delete;
+    LLCacheCompressor& operator=(const LLCacheCompressor&) = delete;
+
+    /// keep the dictionary in filename, loading it if it is there
+    void setDictionaryFile(const std::string& filename);
+
+    /// when off, compress() declines everything; decompress() works regardless
+    void setEnabled(bool enabled) { mEnabled = enabled; }
+    bool isEnabled() const { return mEnabled; }
+
+    /// 0 until a dictionary has been trained or loaded
+    U32 getDictionaryID() const;
+
+    /**
+     * Deflate size bytes of data into out, returning the dictionary that
+     * decompress() will need in dictionary_id (0 for none). False if
+     * compression is off or wouldn't save enough to be worth decoding
+     * later: store the entry as is.
+     */
+    bool compress(const U8* data, size_t size, std::vector<U8>& out, U32& dictionary_id);
+    /// inflate exactly raw_size bytes into out
+    bool decompress(const U8* data, size_t size, U32 dictionary_id, U8* out, size_t raw_size);
+
+    /**
+     * For whole files: a compressed file starts with a header giving its
+     * size and dictionary, so it can be told apart from one stored as is.
+     */
+    bool compressFrame(const U8* data, size_t size, std::vector<U8>& out);
+    bool decompressFrame(const U8* data, size_t size, std::vector<U8>& out);
+    /// true if header, of size bytes, starts a frame of raw_size once inflated
+    static bool readFrameHeader(const U8* header, size_t size, U32& raw_size);
+
+    /// forget the dictionary and any samples, and delete the dictionary file
+    void reset();
+
+    Stats getStats() const;
+
+    /**
+     * Choose the segment_size pieces of the samples whose 8 byte runs turn
+     * up in the most samples, and string them together into no more than
+     * capacity bytes, best last, where deflate finds them cheapest to refer
+     * to. Empty if the samples have little in common.
+     */
+    static std::string trainDictionary(const std::vector<std::string>& samples, size_t capacity, size_t segment_size);
+
+    /// deflate can't refer back quite a whole 32KB window
+    static constexpr size_t MAX_DICTIONARY_SIZE = 32 * 1024 - 512;
+    static constexpr size_t FRAME_HEADER_SIZE = 16;
+
+private:
+    struct Dictionary
+    {
+        std::string mData;
+        U32 mID;
+    };
+    // shared with a training job, which may outlive us
+    struct State
+    {
+        std::mutex mMutex;
+        std::shared_ptr<const Dictionary> mDictionary;
+        std::string mFilename;
+        std::vector<std::string> mSamples;
+        size_t mSampleBytes{ 0 };
+        bool mTraining{ false };
+        // bumped by reset() to turn away training that started before it
+        U32 mGeneration{ 0 };
+    };
+
+    std::shared_ptr<const Dictionary> getDictionary() const;
+    void addSample(const U8* data, size_t size);
+    bool encode(const U8* data, size_t size, size_t offset, std::vector<U8>& out, U32& dictionary_id);
+    static void install(State& state, std::string&& dictionary, U32 generation);
+
+    const size_t mDictionarySize;
+    const bool mRequireDictionary;
+    std::atomic<bool> mEnabled{ false };
+    std::shared_ptr<State> mState;
+
+    std::atomic<U64> mCompressed{ 0 };
+    std::atomic<U64> mRawBytes{ 0 };
+    std::atomic<U64> mCompressedBytes{ 0 };
+    std::atomic<U64> mStored{ 0 };
+    std::atomic<U64> mEncodeMicros{ 0 };
+    std::atomic<U64> mDecoded{ 0 };
+    std::atomic<U64> mDecodedBytes{ 0 };
+    std::atomic<U64> mDecodeMicros{ 0 };
+    std::atomic<U64> mFailed{ 0 };
+};
+
+#endif // LL_LLCACHECOMPRESSOR_H
@@ -0,0 +1,101 @@
+/**
+ * @file   llcachestats.cpp
+ * @date   2026-10-18
+ * @brief  Hit, miss, traffic, latency and eviction counts for every cache tier.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llcachestats.h"
+
+const F32 LLCacheStats::LATENCY_BUCKET_MS[NUM_LATENCY_BUCKETS - 1] = { 0.1f, 0.3f, 1.f, 3.f, 10.f, 30.f, 100.f, 300.f };
+
+LLCacheStats::Tier LLCacheStats::sTiers[NUM_TIERS];
+
+LLCacheStats::Counts LLCacheStats::Counts::operator-(const Counts& other) const
+{
+    Counts diff;
+    diff.mHits = mHits - other.mHits;
+    diff.mMisses = mMisses - other.mMisses;
+    diff.mBytesRead = mBytesRead - other.mBytesRead;
+    diff.mBytesWritten = mBytesWritten - other.mBytesWritten;
+    diff.mEvictions = mEvictions - other.mEvictions;
+    diff.mReads = mReads - other.mReads;
+    diff.mReadMicros = mReadMicros - other.mReadMicros;
+    for (S32 i = 0; i < NUM_LATENCY_BUCKETS; ++i)
+    {
+        diff.mLatency[i] = mLatency[i] - other.mLatency[i];
+    }
+    return diff;
+}
+
+// static
+void LLCacheStats::read(ETier tier, U64 bytes, U64 micros)
+{
+    Tier& stats = sTiers[tier];
+    stats.mBytesRead.fetch_add(bytes, std::memory_order_relaxed);
+    stats.mReads.fetch_add(1, std::memory_order_relaxed);
+    stats.mReadMicros.fetch_add(micros, std::memory_order_relaxed);
+
+    const F32 ms = (F32)micros / 1000.f;
+    S32 bucket = 0;
+    while (bucket < NUM_LATENCY_BUCKETS - 1 && ms > LATENCY_BUCKET_MS[bucket])
+    {
+        ++bucket;
+    }
+    stats.mLatency[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+// static
+LLCacheStats::Counts LLCacheStats::get(ETier tier)
+{
+    const Tier& stats = sTiers[tier];
+    Counts counts;
+    counts.mHits = stats.mHits.load(std::memory_order_relaxed);
+    counts.mMisses = stats.mMisses.load(std::memory_order_relaxed);
+    counts.mBytesRead = stats.mBytesRead.load(std::memory_order_relaxed);
+    counts.mBytesWritten = stats.mBytesWritten.load(std::memory_order_relaxed);
+    counts.mEvictions = stats.mEvictions.load(std::memory_order_relaxed);
+    counts.mReads = stats.mReads.load(std::memory_order_relaxed);
+    counts.mReadMicros = stats.mReadMicros.load(std::memory_order_relaxed);
+    for (S32 i = 0; i < NUM_LATENCY_BUCKETS; ++i)
+    {
+        counts.mLatency[i] = stats.mLatency[i].load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+// static
+const char* LLCacheStats::getName(ETier tier)
+{
+    static const char* names[NUM_TIERS] = { "texture_header", "texture_body", "texture_fast", "object", "asset", "mesh" };
+    return names[tier];
+}
+
+// static
+const char* LLCacheStats::getLabel(ETier tier)
+{
+    static const char* labels[NUM_TIERS] = { "Texture Header", "Texture Body", "Fast Cache", "Object", "Asset", "Mesh" };
+    return labels[tier];
+}
@@ -0,0 +1,125 @@
+/**
+ * @file   llcachestats.h
+ * @date   2026-10-18
+ * @brief  Hit, miss, traffic, latency and eviction counts for every cache tier.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLCACHESTATS_H
+#define LL_LLCACHESTATS_H
+
+#include <atomic>
+#include <chrono>
+
+/**
+ * LLCacheStats keeps the same figures for every cache tier: hits, misses,
+ * bytes read and written, evictions, and how long reads took, both as a
+ * total and as a histogram. The caches record into it from whatever thread
+ * they run on; the viewer turns the running totals into LLTrace stats once
+ * a frame (see LLStatViewer) and LLViewerStatsRecorder writes them to its
+ * CSV log.
+ *
+ * Everything is a running total since startup: take differences between
+ * two get() calls for figures over an interval.
+ */
+class LLCacheStats
+{
+public:
+    enum ETier
+    {
+        TEXTURE_HEADER, // first chunk of a texture, from the texture cache
+        TEXTURE_BODY,   // rest of a texture, from the texture cache
+        TEXTURE_FAST,   // low resolution preview from the fast cache
+        OBJECT,         // region object cache entries
+        ASSET,          // LLFileSystem files in the disk cache
+        MESH,           // mesh headers and LODs from the disk cache
+        NUM_TIERS
+    };
+
+    // upper bounds, in milliseconds, of every latency bucket but the last,
+    // which takes everything slower
+    static constexpr S32 NUM_LATENCY_BUCKETS = 9;
+    static const F32 LATENCY_BUCKET_MS[NUM_LATENCY_BUCKETS - 1];
+
+    struct Counts
+    {
+        U64 mHits{ 0 };
+        U64 mMisses{ 0 };
+        U64 mBytesRead{ 0 };
+        U64 mBytesWritten{ 0 };
+        U64 mEvictions{ 0 };
+        // timed reads, their total latency and how it was spread
+        U64 mReads{ 0 };
+        U64 mReadMicros{ 0 };
+        U64 mLatency[NUM_LATENCY_BUCKETS]{};
+
+        Counts operator-(const Counts& other) const;
+
+        F32 getHitRate() const { return (mHits + mMisses) ? (F32)mHits / (F32)(mHits + mMisses) : 0.f; }
+        F32 getMeanLatencyMs() const { return mReads ? (F32)mReadMicros / (F32)mReads / 1000.f : 0.f; }
+    };
+
+    /// measures one read, from construction to getMicros()
+    class Timer
+    {
+    public:
+        Timer() : mStart(std::chrono::steady_clock::now()) {}
+        U64 getMicros() const
+        {
+            return (U64)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - mStart).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point mStart;
+    };
+
+    static void hit(ETier tier, U64 count = 1)      { sTiers[tier].mHits.fetch_add(count, std::memory_order_relaxed); }
+    static void miss(ETier tier, U64 count = 1)     { sTiers[tier].mMisses.fetch_add(count, std::memory_order_relaxed); }
+    static void wrote(ETier tier, U64 bytes)        { sTiers[tier].mBytesWritten.fetch_add(bytes, std::memory_order_relaxed); }
+    static void evicted(ETier tier, U64 count = 1)  { sTiers[tier].mEvictions.fetch_add(count, std::memory_order_relaxed); }
+    /// bytes came from the cache in one read taking micros
+    static void read(ETier tier, U64 bytes, U64 micros);
+
+    static Counts get(ETier tier);
+    /// for stat names: "texture_header"
+    static const char* getName(ETier tier);
+    /// for people: "Texture Header"
+    static const char* getLabel(ETier tier);
+
+private:
+    struct Tier
+    {
+        std::atomic<U64> mHits{ 0 };
+        std::atomic<U64> mMisses{ 0 };
+        std::atomic<U64> mBytesRead{ 0 };
+        std::atomic<U64> mBytesWritten{ 0 };
+        std::atomic<U64> mEvictions{ 0 };
+        std::atomic<U64> mReads{ 0 };
+        std::atomic<U64> mReadMicros{ 0 };
+        std::atomic<U64> mLatency[NUM_LATENCY_BUCKETS]{};
+    };
+
+    static Tier sTiers[NUM_TIERS];
+};
+
+#endif // LL_LLCACHESTATS_H
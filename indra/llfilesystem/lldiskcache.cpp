@@ -36,8 +36,10 @@
 #include "lldir.h"
 #include <boost/filesystem.hpp>
 #include <chrono>
+#include <cstring>
 
 #include "lldiskcache.h"
+#include "llcachestats.h"
 
  /**
   * The prefix inserted at the start of a cache file filename to
@@ -54,6 +56,513 @@ std::string LLDiskCache::sCacheDir;
 // <FS:Ansariel> Optimize asset simple disk cache
 static const char* subdirs = "0123456789abcdef";
 
+/**
+ * The index journal lives in the cache folder. Its name must not contain
+ * CACHE_FILENAME_PREFIX so that scans and purges leave it alone.
+ */
+static const std::string CACHE_INDEX_FILENAME("cache_index.journal");
+
+/**
+ * The compression dictionary lives beside it, and for the same reason
+ * mustn't contain CACHE_FILENAME_PREFIX either.
+ */
+static const std::string CACHE_DICTIONARY_FILENAME("cache_compress.dict");
+
+namespace
+{
+    // Journal layout: JOURNAL_MAGIC, then records of an op byte followed by
+    // the fields that op needs. Names are a U16 length and the bytes.
+    const char JOURNAL_MAGIC[8] = { 'L', 'L', 'D', 'C', 'I', 'D', 'X', '1' };
+    enum : U8
+    {
+        OP_SET = 1,     // name, U64 size, S64 access time
+        OP_TOUCH,       // name, S64 access time
+        OP_REMOVE,      // name
+        OP_CLEAN,       // index closed cleanly; must be the last record
+        OP_OPEN         // journal reopened after a clean load
+    };
+
+    // Skip re-journalling reads of a file more often than this. The in-memory
+    // LRU order is always updated; this only affects order after a restart.
+    const S64 TOUCH_JOURNAL_INTERVAL = 60;
+
+    // Rewrite the journal as a snapshot once it has this many more records
+    // than twice the number of entries.
+    const size_t JOURNAL_COMPACT_SLACK = 4096;
+
+    template <typename T>
+    void put(std::string& out, T value)
+    {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void put_name(std::string& out, const std::string& name)
+    {
+        const U16 length = (U16)llmin(name.size(), size_t(0xffff));
+        put(out, length);
+        out.append(name.data(), length);
+    }
+
+    struct JournalReader
+    {
+        const char* mPos;
+        const char* mEnd;
+
+        template <typename T>
+        bool get(T& value)
+        {
+            if (size_t(mEnd - mPos) < sizeof(value))
+            {
+                return false;
+            }
+            memcpy(&value, mPos, sizeof(value));
+            mPos += sizeof(value);
+            return true;
+        }
+
+        bool getName(std::string& name)
+        {
+            U16 length;
+            if (! get(length) || size_t(mEnd - mPos) < length)
+            {
+                return false;
+            }
+            name.assign(mPos, length);
+            mPos += length;
+            return true;
+        }
+    };
+
+    S64 now()
+    {
+        return (S64)std::time(nullptr);
+    }
+} // anonymous namespace
+
+LLDiskCacheIndex::LLDiskCacheIndex(const std::string& cache_dir, const std::string& prefix) :
+    mCacheDir(cache_dir),
+    mPrefix(prefix),
+    mJournalPath(cache_dir + gDirUtilp->getDirDelimiter() + CACHE_INDEX_FILENAME)
+{
+}
+
+bool LLDiskCacheIndex::load()
+{
+    std::lock_guard<std::mutex> journal_lock(mJournalMutex);
+
+    std::string journal;
+    LLFILE* file = LLFile::fopen(mJournalPath, "rb");
+    if (! file)
+    {
+        return false;
+    }
+    if (fseek(file, 0, SEEK_END) == 0)
+    {
+        long length = ftell(file);
+        if (length > 0 && fseek(file, 0, SEEK_SET) == 0)
+        {
+            journal.resize(length);
+            journal.resize(fread(&journal[0], 1, length, file));
+        }
+    }
+    fclose(file);
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mEntries.clear();
+    mLRU.clear();
+    mTotalBytes = 0;
+    mPending.clear();
+
+    JournalReader reader{ journal.data(), journal.data() + journal.size() };
+    char magic[sizeof(JOURNAL_MAGIC)];
+    bool ok = reader.get(magic) && ! memcmp(magic, JOURNAL_MAGIC, sizeof(magic));
+    bool clean = false;
+    size_t records = 0;
+    std::string name;
+    while (ok && reader.mPos < reader.mEnd)
+    {
+        U8 op = 0;
+        U64 size = 0;
+        S64 access_time = 0;
+        reader.get(op);
+        clean = false;
+        ++records;
+        switch (op)
+        {
+        case OP_SET:
+            ok = reader.getName(name) && reader.get(size) && reader.get(access_time);
+            if (ok)
+            {
+                set(name, size, access_time);
+            }
+            break;
+
+        case OP_TOUCH:
+            ok = reader.getName(name) && reader.get(access_time);
+            if (ok)
+            {
+                auto found = mEntries.find(name);
+                if (found != mEntries.end())
+                {
+                    touch(found, access_time);
+                }
+            }
+            break;
+
+        case OP_REMOVE:
+            ok = reader.getName(name);
+            if (ok)
+            {
+                auto found = mEntries.find(name);
+                if (found != mEntries.end())
+                {
+                    erase(found);
+                }
+            }
+            break;
+
+        case OP_CLEAN:
+            clean = true;
+            break;
+
+        case OP_OPEN:
+            break;
+
+        default:
+            ok = false;
+            break;
+        }
+    }
+
+    if (! (ok && clean))
+    {
+        LL_INFOS("LLDiskCache") << "Cache index " << mJournalPath
+                                << (ok ? " was not closed cleanly" : " is damaged") << LL_ENDL;
+        mEntries.clear();
+        mLRU.clear();
+        mTotalBytes = 0;
+        return false;
+    }
+    mJournalRecords = records;
+
+    // From here on the journal must not look clean until close() says so,
+    // or a crash before the next flush() would leave it trusted but stale.
+    file = LLFile::fopen(mJournalPath, "ab");
+    if (! file)
+    {
+        return false;
+    }
+    const U8 op = OP_OPEN;
+    const bool opened = fwrite(&op, 1, 1, file) == 1;
+    fclose(file);
+
+    LL_INFOS("LLDiskCache") << "Loaded cache index: " << mEntries.size() << " files, "
+                            << mTotalBytes << " bytes" << LL_ENDL;
+    return opened;
+}
+
+void LLDiskCacheIndex::rescan()
+{
+    typedef std::pair<std::time_t, file_t> scanned_t;
+    std::vector<scanned_t> scanned;
+
+    boost::system::error_code ec;
+#if LL_WINDOWS
+    std::wstring cache_path(utf8str_to_utf16str(mCacheDir));
+#else
+    std::string cache_path(mCacheDir);
+#endif
+    if (boost::filesystem::is_directory(cache_path, ec) && !ec.failed())
+    {
+        boost::filesystem::recursive_directory_iterator iter(cache_path, ec);
+        while (iter != boost::filesystem::recursive_directory_iterator() && !ec.failed())
+        {
+            if (boost::filesystem::is_regular_file(*iter, ec) && !ec.failed())
+            {
+                const std::string file_path = (*iter).path().string();
+                if (file_path.find(mPrefix) != std::string::npos)
+                {
+                    uintmax_t file_size = boost::filesystem::file_size(*iter, ec);
+                    if (!ec.failed())
+                    {
+                        const std::time_t file_time = boost::filesystem::last_write_time(*iter, ec);
+                        if (!ec.failed())
+                        {
+                            // Key on the file name, as metaDataToFilename()
+                            // does, in UTF-8: on Windows, file_path is in
+                            // the ANSI code page, so slicing it by the
+                            // length of the UTF-8 mCacheDir can go wrong.
+#if LL_WINDOWS
+                            const std::string name(utf16str_to_utf8str((*iter).path().filename().wstring()));
+#else
+                            const std::string name((*iter).path().filename().string());
+#endif
+                            scanned.emplace_back(file_time, file_t(name, file_size));
+                        }
+                    }
+                }
+            }
+            iter.increment(ec);
+        }
+    }
+
+    // oldest first, so the LRU order matches the files' write times
+    std::sort(scanned.begin(), scanned.end(),
+              [](const scanned_t& x, const scanned_t& y) { return x.first < y.first; });
+
+    std::lock_guard<std::mutex> journal_lock(mJournalMutex);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mEntries.clear();
+        mLRU.clear();
+        mTotalBytes = 0;
+        for (const scanned_t& file : scanned)
+        {
+            set(file.second.first, file.second.second, file.first);
+        }
+        LL_INFOS("LLDiskCache") << "Rebuilt cache index from " << mEntries.size() << " files, "
+                                << mTotalBytes << " bytes" << LL_ENDL;
+    }
+    writeSnapshot(false);
+}
+
+void LLDiskCacheIndex::noteWrite(const std::string& name, uintmax_t end_offset, bool truncated)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    uintmax_t size = end_offset;
+    auto found = mEntries.find(name);
+    if (found != mEntries.end() && ! truncated)
+    {
+        size = llmax(size, found->second.mSize);
+    }
+    const S64 access_time = now();
+    set(name, size, access_time);
+    put(mPending, OP_SET);
+    put_name(mPending, name);
+    put(mPending, U64(size));
+    put(mPending, access_time);
+    ++mJournalRecords;
+}
+
+void LLDiskCacheIndex::noteRead(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto found = mEntries.find(name);
+    if (found == mEntries.end())
+    {
+        return;
+    }
+    const S64 access_time = now();
+    const bool journal = access_time - found->second.mAccessTime >= TOUCH_JOURNAL_INTERVAL;
+    touch(found, access_time);
+    if (journal)
+    {
+        put(mPending, OP_TOUCH);
+        put_name(mPending, name);
+        put(mPending, access_time);
+        ++mJournalRecords;
+    }
+}
+
+void LLDiskCacheIndex::noteRemove(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto found = mEntries.find(name);
+    if (found != mEntries.end())
+    {
+        erase(found);
+        put(mPending, OP_REMOVE);
+        put_name(mPending, name);
+        ++mJournalRecords;
+    }
+}
+
+void LLDiskCacheIndex::noteRename(const std::string& old_name, const std::string& new_name)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto found = mEntries.find(old_name);
+    if (found == mEntries.end())
+    {
+        return;
+    }
+    const uintmax_t size = found->second.mSize;
+    erase(found);
+    put(mPending, OP_REMOVE);
+    put_name(mPending, old_name);
+
+    const S64 access_time = now();
+    set(new_name, size, access_time);
+    put(mPending, OP_SET);
+    put_name(mPending, new_name);
+    put(mPending, U64(size));
+    put(mPending, access_time);
+    mJournalRecords += 2;
+}
+
+void LLDiskCacheIndex::clear()
+{
+    std::lock_guard<std::mutex> journal_lock(mJournalMutex);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mEntries.clear();
+        mLRU.clear();
+        mTotalBytes = 0;
+    }
+    writeSnapshot(false);
+}
+
+std::vector<LLDiskCacheIndex::file_t> LLDiskCacheIndex::evict(uintmax_t target_bytes,
+                                                              const std::function<bool(const std::string&)>& spare,
+                                                              U32& spared)
+{
+    std::vector<file_t> evicted;
+    spared = 0;
+    std::lock_guard<std::mutex> lock(mMutex);
+    const S64 access_time = now();
+    // each entry is looked at no more than once, even if all are spared
+    for (size_t remaining = mLRU.size(); remaining && mTotalBytes > target_bytes; --remaining)
+    {
+        auto found = mEntries.find(*mLRU.front());
+        if (spare && spare(found->first))
+        {
+            touch(found, access_time);
+            put(mPending, OP_TOUCH);
+            put_name(mPending, found->first);
+            put(mPending, access_time);
+            ++mJournalRecords;
+            ++spared;
+            continue;
+        }
+        evicted.emplace_back(found->first, found->second.mSize);
+        put(mPending, OP_REMOVE);
+        put_name(mPending, found->first);
+        ++mJournalRecords;
+        erase(found);
+    }
+    return evicted;
+}
+
+uintmax_t LLDiskCacheIndex::getTotalBytes() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mTotalBytes;
+}
+
+size_t LLDiskCacheIndex::size() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+void LLDiskCacheIndex::flush()
+{
+    std::lock_guard<std::mutex> journal_lock(mJournalMutex);
+    std::string pending;
+    bool compact;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        pending.swap(mPending);
+        compact = mJournalRecords > 2 * mEntries.size() + JOURNAL_COMPACT_SLACK;
+    }
+    if (compact)
+    {
+        writeSnapshot(false);
+    }
+    else if (! pending.empty())
+    {
+        LLFILE* file = LLFile::fopen(mJournalPath, "ab");
+        if (! file || fwrite(pending.data(), 1, pending.size(), file) != pending.size())
+        {
+            LL_WARNS("LLDiskCache") << "Failed to append to cache index " << mJournalPath << LL_ENDL;
+        }
+        if (file)
+        {
+            fclose(file);
+        }
+    }
+}
+
+void LLDiskCacheIndex::close()
+{
+    std::lock_guard<std::mutex> journal_lock(mJournalMutex);
+    writeSnapshot(true);
+}
+
+void LLDiskCacheIndex::set(const std::string& name, uintmax_t size, S64 access_time)
+{
+    auto found = mEntries.find(name);
+    if (found != mEntries.end())
+    {
+        mTotalBytes -= found->second.mSize;
+        found->second.mSize = size;
+        touch(found, access_time);
+    }
+    else
+    {
+        found = mEntries.emplace(name, Entry{ size, access_time, mLRU.end() }).first;
+        found->second.mLRU = mLRU.insert(mLRU.end(), &found->first);
+    }
+    mTotalBytes += size;
+}
+
+void LLDiskCacheIndex::touch(entries_t::iterator it, S64 access_time)
+{
+    it->second.mAccessTime = access_time;
+    mLRU.splice(mLRU.end(), mLRU, it->second.mLRU);
+}
+
+void LLDiskCacheIndex::erase(entries_t::iterator it)
+{
+    mTotalBytes -= it->second.mSize;
+    mLRU.erase(it->second.mLRU);
+    mEntries.erase(it);
+}
+
+void LLDiskCacheIndex::writeSnapshot(bool clean)
+{
+    std::string snapshot(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        snapshot.reserve(snapshot.size() + mEntries.size() * 64);
+        for (const std::string* name : mLRU)
+        {
+            const Entry& entry = mEntries.find(*name)->second;
+            put(snapshot, OP_SET);
+            put_name(snapshot, *name);
+            put(snapshot, U64(entry.mSize));
+            put(snapshot, entry.mAccessTime);
+        }
+        // everything pending is in the snapshot
+        mPending.clear();
+        mJournalRecords = mEntries.size();
+    }
+    if (clean)
+    {
+        put(snapshot, OP_CLEAN);
+    }
+
+    // write aside and swap in, so a crash leaves either the old journal or
+    // the new one -- or none, which only costs a rescan
+    const std::string temp_path = mJournalPath + ".tmp";
+    LLFILE* file = LLFile::fopen(temp_path, "wb");
+    bool written = file && fwrite(snapshot.data(), 1, snapshot.size(), file) == snapshot.size();
+    if (file)
+    {
+        written = (fclose(file) == 0) && written;
+    }
+    if (! written)
+    {
+        LL_WARNS("LLDiskCache") << "Failed to write cache index " << temp_path << LL_ENDL;
+        LLFile::remove(temp_path, ENOENT);
+        return;
+    }
+    LLFile::remove(mJournalPath, ENOENT);
+    if (LLFile::rename(temp_path, mJournalPath) != 0)
+    {
+        LL_WARNS("LLDiskCache") << "Failed to replace cache index " << mJournalPath << LL_ENDL;
+    }
+}
+
 LLDiskCache::LLDiskCache(const std::string& cache_dir,
                          const uintmax_t max_size_bytes,
                          const bool enable_cache_debug_info
@@ -62,6 +571,8 @@ LLDiskCache::LLDiskCache(const std::string& cache_dir,
                          ,const F32 lowwater_mark_percent
 // </FS:Beq>
                          ) :
+    mIndex(cache_dir, CACHE_FILENAME_PREFIX),
+    mPack(cache_dir),
     mMaxSizeBytes(max_size_bytes),
     mEnableCacheDebugInfo(enable_cache_debug_info)
 {
@@ -75,6 +586,14 @@ LLDiskCache::LLDiskCache(const std::string& cache_dir,
         LLFile::mkdir(dirname);
     }
     // </FS:Ansariel>
+
+    // Only walk the whole cache when the saved index can't be trusted.
+    if (!mIndex.load())
+    {
+        mIndex.rescan();
+    }
+    mPack.open();
+    mCompressor.setDictionaryFile(cache_dir + gDirUtilp->getDirDelimiter() + CACHE_DICTIONARY_FILENAME);
     // <FS:Beq> add static assets into the new cache after clear.
     // Only missing entries are copied on init, skiplist is setup
     // For everything we populate FS specific assets to allow future updates
@@ -82,6 +601,11 @@ LLDiskCache::LLDiskCache(const std::string& cache_dir,
     // </FS:Beq>
 }
 
+LLDiskCache::~LLDiskCache()
+{
+    mIndex.close();
+}
+
 // WARNING: purge() is called by LLPurgeDiskCacheThread. As such it must
 // NOT touch any LLDiskCache data without introducing and locking a mutex!
 
@@ -114,216 +638,113 @@ void LLDiskCache::purge()
 {
     if (mEnableCacheDebugInfo)
     {
-        LL_INFOS() << "Total dir size before purge is " << dirFileSize(sCacheDir) << LL_ENDL;
+        LL_INFOS() << "Total dir size before purge is " << dirFileSize(sCacheDir, true)
+                   << ", index says " << mIndex.getTotalBytes() << LL_ENDL;
     }
 
-    boost::system::error_code ec;
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    typedef std::pair<std::time_t, std::pair<uintmax_t, std::string>> file_info_t;
-    std::vector<file_info_t> file_info;
-
-#if LL_WINDOWS
-    std::wstring cache_path(utf8str_to_utf16str(sCacheDir));
-#else
-    std::string cache_path(sCacheDir);
-#endif
-    uintmax_t file_size_total = 0; // <FS:Beq/> try to make simple cache less naive.
-    
-    if (boost::filesystem::is_directory(cache_path, ec) && !ec.failed())
-    {
-        // <FS:Ansariel> Optimize asset simple disk cache
-        //boost::filesystem::directory_iterator iter(cache_path, ec);
-        //while (iter != boost::filesystem::directory_iterator() && !ec.failed())
-        boost::filesystem::recursive_directory_iterator iter(cache_path, ec);
-        while (iter != boost::filesystem::recursive_directory_iterator() && !ec.failed())
-        // </FS:Ansariel>
-        {
-            if (boost::filesystem::is_regular_file(*iter, ec) && !ec.failed())
-            {
-                if ((*iter).path().string().find(CACHE_FILENAME_PREFIX) != std::string::npos)
-                {
-                    uintmax_t file_size = boost::filesystem::file_size(*iter, ec);
-                    if (ec.failed())
-                    {
-                        continue;
-                    }
-                    const std::string file_path = (*iter).path().string();
-                    const std::time_t file_time = boost::filesystem::last_write_time(*iter, ec);
-                    if (ec.failed())
-                    {
-                        continue;
-                    }
-                    file_size_total += file_size; // <FS:Beq/> try to make simple cache less naive.
-
-                    file_info.push_back(file_info_t(file_time, { file_size, file_path }));
-                }
-            }
-            iter.increment(ec);
-        }
-    }
+    // whether or not we purge, save what has changed since last time
+    mIndex.flush();
+    // reclaim the space of replaced and removed packed assets
+    mPack.compact();
 
     // <FS:Beq> add high water/low water thresholds to reduce the churn in the cache.
+    uintmax_t file_size_total = mIndex.getTotalBytes() + mPack.getFileBytes();
+    updateCacheSize(file_size_total);
     LL_DEBUGS("LLDiskCache") << "Cache is " << (int)(((F32)file_size_total)/mMaxSizeBytes*100.0) << "% full" << LL_ENDL;
     if( file_size_total < mMaxSizeBytes * (mHighPercent/100) )
     {
-        // Nothing to do here 
+        // Nothing to do here
         LL_DEBUGS("LLDiskCache") << "Not exceded high water - do nothing" << LL_ENDL;
         return;
     }
     // If we reach here we are above the trigger level so we must purge until we've removed enough to take us down to the low water mark.
-    // </FS:Beq>
-    std::sort(file_info.begin(), file_info.end(), [](file_info_t& x, file_info_t& y)
-    {
-        return x.first < y.first; // <FS:Beq/> sort oldest to newest, to we can remove the oldest files first.
-    });
-
-
-    // <FS:Beq> add high water/low water thresholds to reduce the churn in the cache.
     auto target_size = (uintmax_t)(mMaxSizeBytes * (mLowPercent/100));
     LL_INFOS() << "Purging cache to a maximum of " << target_size << " bytes" << LL_ENDL;
     // </FS:Beq>
 
-    // <FS:Beq> Extra accounting to track the retention of static assets
-    //std::vector<bool> file_removed;
-    enum class purge_action { delete_file=0, keep_file, skip_file };
-    std::map<std::string,purge_action> file_removed;
-    auto keep{file_info.size()};
-    auto del{0};
-    auto skip{0};
-    // </FS:Beq>
-    // <FS:Beq> revised purge logic to track amount removed not retained to shortern loop
-    // uintmax_t file_size_total = 0;
-    // if (mEnableCacheDebugInfo)
-    // {
-    //     file_removed.reserve(file_info.size());
-    // }
-    // uintmax_t file_size_total = 0;
-    // for (file_info_t& entry : file_info)
-    // {
-    //     file_size_total += entry.second.first;
-
-    //     bool should_remove = file_size_total > mMaxSizeBytes;
-    //     if (mEnableCacheDebugInfo)
-    //     {
-    //         file_removed.push_back(should_remove);
-    //     }
-    uintmax_t deleted_size_total = 0;
-    for (const file_info_t& entry : file_info)
+    // Packed assets are dropped a whole segment at a time, oldest first,
+    // and may use no more than their share of the target.
+    const size_t packed_count = mPack.size();
+    mPack.trim(target_size / 4);
+    const size_t packed_left = mPack.size();
+    if (packed_left < packed_count)
     {
-        // first check if we still need to delete more files
-        bool should_remove = (file_size_total - deleted_size_total) > target_size;
-
-        // <FS> Make sure static assets are not eliminated
-        auto action{ should_remove ? purge_action::delete_file : purge_action::keep_file };
-        if (!should_remove)
-        {
-            break;
-        }
+        LLCacheStats::evicted(LLCacheStats::ASSET, packed_count - packed_left);
+    }
+    const uintmax_t packed_size = mPack.getFileBytes();
+    target_size = target_size > packed_size ? target_size - packed_size : 0;
 
-        auto this_file_size = entry.second.first;
-        deleted_size_total += this_file_size;
-        auto uuid_as_string = gDirUtilp->getBaseFileName(entry.second.second, true);
-        uuid_as_string      = uuid_as_string.substr(CACHE_FILENAME_PREFIX.size() + 1, 36);  // skip "sl_cache_" and trailing "_N"
-        // LL_INFOS() << "checking UUID=" <<uuid_as_string<< LL_ENDL;
-        if (std::find(mSkipList.begin(), mSkipList.end(), uuid_as_string) != mSkipList.end())
-        {
-            // this is one of our protected items so no purging
-            should_remove = false;
-            action = purge_action::skip_file;
-            boost::filesystem::last_write_time(entry.second.second, ec);  // force these to the front of the list next time so that purge size works 
-            skip++;
-        }
-        else{
-            del++;
-        }
-        keep--;
-        if (mEnableCacheDebugInfo)
+    // The index hands back the least recently used files, oldest first.
+    // <FS> Make sure static assets are not eliminated: those are moved to
+    // the recent end of the index instead.
+    U32 skip{ 0 };
+    const std::vector<LLDiskCacheIndex::file_t> doomed = mIndex.evict(target_size,
+        [this](const std::string& name)
         {
-            file_removed.emplace(entry.second.second, action);
-        }
-    // </FS>
-        if (should_remove)
-        {
-            boost::filesystem::remove(entry.second.second, ec);
-            if (ec.failed())
+            auto uuid_as_string = gDirUtilp->getBaseFileName(name, true);
+            if (uuid_as_string.size() < CACHE_FILENAME_PREFIX.size() + 1 + 36)
             {
-                LL_WARNS() << "Failed to delete cache file " << entry.second.second << ": " << ec.message() << LL_ENDL;
+                return false;
             }
+            uuid_as_string = uuid_as_string.substr(CACHE_FILENAME_PREFIX.size() + 1, 36);  // skip "sl_cache_" and trailing "_N"
+            return std::find(mSkipList.begin(), mSkipList.end(), uuid_as_string) != mSkipList.end();
+        },
+        skip);
+
+    boost::system::error_code ec;
+    uintmax_t deleted_size_total = 0;
+    U32 del{ 0 };
+    for (const LLDiskCacheIndex::file_t& entry : doomed)
+    {
+        const std::string file_path = sCacheDir + gDirUtilp->getDirDelimiter() + entry.first;
+#if LL_WINDOWS
+        boost::filesystem::remove(utf8str_to_utf16str(file_path), ec);
+#else
+        boost::filesystem::remove(file_path, ec);
+#endif
+        if (ec.failed())
+        {
+            LL_WARNS() << "Failed to delete cache file " << file_path << ": " << ec.message() << LL_ENDL;
+            // still there: keep it in the index so it gets another chance
+            mIndex.noteWrite(entry.first, entry.second, true);
+            continue;
         }
+        deleted_size_total += entry.second;
+        del++;
     }
+    LLCacheStats::evicted(LLCacheStats::ASSET, del);
+    mIndex.flush();
+
 // <FS:Beq> update the debug logging to be more useful
     auto end_time = std::chrono::high_resolution_clock::now();
     auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
 // </FS:Beq>
     if (mEnableCacheDebugInfo)
     {
-        // <FS:Beq> update the debug logging to be more useful
-        // auto end_time = std::chrono::high_resolution_clock::now();
-        // auto execute_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-        // </FS:Beq>
-
         // Log afterward so it doesn't affect the time measurement
         // Logging thousands of file results can take hundreds of milliseconds
         uintmax_t deleted_so_far{ 0 }; // <FS:Beq/> update the debug logging to be more useful
-        for (size_t i = 0; i < file_info.size(); ++i)
+        for (const LLDiskCacheIndex::file_t& entry : doomed)
         {
-            const file_info_t& entry = file_info[i];
-            // <FS> Static asset stuff
-            deleted_so_far += entry.second.first; // <FS:Beq/> update the debug logging to be more useful
-            //const bool removed = file_removed[i];
-            //const std::string action = removed ? "DELETE:" : "KEEP:";
-            std::string action{};
-
-            // Check if the file exists in the map
-            auto& filename{ entry.second.second };
-            if (file_removed.find(filename) != file_removed.end()) {
-            // File found in the map, retrieve the corresponding enum value
-            switch (file_removed[filename])
-            {
-                case purge_action::delete_file:
-                    action = "DELETE";
-                    del++;
-                break;
-                case purge_action::skip_file:
-                    action = "STATIC";
-                    skip++;
-                break;
-                default:
-                // Handle any unexpected enum value
-                    action = "UNKNOWN";
-                break;
-            }
-            }
-            else 
-            {
-                action = "KEEP";
-            }            
-            // </FS>
-
+            deleted_so_far += entry.second;
             // have to do this because of LL_INFO/LL_END weirdness
             std::ostringstream line;
 
-            line << action << "  ";
-            line << entry.first << "  ";
-            line << entry.second.first << "  ";
-            line << entry.second.second;
+            line << "DELETE  ";
+            line << entry.second << "  ";
+            line << entry.first;
             line << " (" << file_size_total - deleted_so_far << "/" << mMaxSizeBytes << ")"; // <FS:Beq/> update the debug logging to be more useful
             LL_INFOS() << line.str() << LL_ENDL;
         }
-// <FS:Beq> make the summary stats more easily enabled.
     }
-    // <FS:Beq> update the debug logging to be more useful
-        // LL_INFOS() << "Total dir size after purge is " << dirFileSize(sCacheDir) << LL_ENDL;
-        // LL_INFOS() << "Cache purge took " << execute_time << " ms to execute for " << file_info.size() << " files" << LL_ENDL;
 
-    auto newCacheSize = updateCacheSize(file_size_total - deleted_size_total); 
-    LL_INFOS("LLDiskCache") << "Total dir size after purge is " << newCacheSize << LL_ENDL; 
-    LL_INFOS("LLDiskCache") << "Cache purge took " << execute_time << " ms to execute for " << file_info.size() << " files" << LL_ENDL;
-// </FS:Beq>
-    LL_INFOS("LLDiskCache") << "Deleted: " << del << " Skipped: " << skip << " Kept: " << keep << LL_ENDL;    // <FS:Beq/> Extra accounting to track the retention of static assets
+    auto newCacheSize = updateCacheSize(mIndex.getTotalBytes() + mPack.getFileBytes());
+    LL_INFOS("LLDiskCache") << "Total dir size after purge is " << newCacheSize << LL_ENDL;
+    LL_INFOS("LLDiskCache") << "Cache purge took " << execute_time << " ms to execute for " << doomed.size() << " files" << LL_ENDL;
+    LL_INFOS("LLDiskCache") << "Deleted: " << del << " Skipped: " << skip << " Kept: " << mIndex.size() << LL_ENDL;    // <FS:Beq/> Extra accounting to track the retention of static assets
     LL_INFOS("LLDiskCache") << "Total of " << deleted_size_total << " bytes removed." << LL_ENDL;    // <FS:Beq/> Extra accounting to track the retention of static assets
-    // } <FS:Beq/> this bracket was moved up a few lines.
 }
 
 const std::string LLDiskCache::metaDataToFilepath(const LLUUID& id, LLAssetType::EType at)
@@ -331,6 +752,76 @@ const std::string LLDiskCache::metaDataToFilepath(const LLUUID& id, LLAssetType:
     return llformat("%s%s%s_%s_0.asset", sCacheDir.c_str(), gDirUtilp->getDirDelimiter().c_str(), CACHE_FILENAME_PREFIX.c_str(), id.asString().c_str());
 }
 
+// static
+std::string LLDiskCache::metaDataToFilename(const LLUUID& id, LLAssetType::EType at)
+{
+    return llformat("%s_%s_0.asset", CACHE_FILENAME_PREFIX.c_str(), id.asString().c_str());
+}
+
+// static
+void LLDiskCache::noteWrite(const LLUUID& id, LLAssetType::EType at, uintmax_t end_offset, bool truncated)
+{
+    if (instanceExists())
+    {
+        getInstance()->mIndex.noteWrite(metaDataToFilename(id, at), end_offset, truncated);
+    }
+}
+
+// static
+void LLDiskCache::noteRead(const LLUUID& id, LLAssetType::EType at)
+{
+    if (instanceExists())
+    {
+        getInstance()->mIndex.noteRead(metaDataToFilename(id, at));
+    }
+}
+
+// static
+void LLDiskCache::noteRemove(const LLUUID& id, LLAssetType::EType at)
+{
+    if (instanceExists())
+    {
+        getInstance()->mIndex.noteRemove(metaDataToFilename(id, at));
+    }
+}
+
+// static
+void LLDiskCache::noteRename(const LLUUID& old_id, LLAssetType::EType old_at,
+                             const LLUUID& new_id, LLAssetType::EType new_at)
+{
+    if (instanceExists())
+    {
+        getInstance()->mIndex.noteRename(metaDataToFilename(old_id, old_at), metaDataToFilename(new_id, new_at));
+    }
+}
+
+// static
+LLDiskCachePack* LLDiskCache::getPack()
+{
+    return instanceExists() ? &getInstance()->mPack : nullptr;
+}
+
+// static
+LLCacheCompressor* LLDiskCache::getCompressor()
+{
+    return instanceExists() ? &getInstance()->mCompressor : nullptr;
+}
+
+// static
+bool LLDiskCache::isCompressible(LLAssetType::EType at)
+{
+    switch (at)
+    {
+        case LLAssetType::AT_TEXTURE:
+        case LLAssetType::AT_SOUND:
+        case LLAssetType::AT_SOUND_WAV:
+        case LLAssetType::AT_IMAGE_JPEG:
+            return false;
+        default:
+            return true;
+    }
+}
+
 const std::string LLDiskCache::getCacheInfo()
 {
     LL_PROFILE_ZONE_SCOPED; // <FS:Beq/> add some instrumentation
@@ -338,21 +829,20 @@ const std::string LLDiskCache::getCacheInfo()
 
     F32 max_in_mb = (F32)mMaxSizeBytes / (1024.0f * 1024.0f);
     // <FS:Beq> stall prevention. We still need to make sure this initialised when called at startup.
-    F32 percent_used;
-    if (mStoredCacheSize > 0)
-    {
-        percent_used = ((F32)mStoredCacheSize / (F32)mMaxSizeBytes) * 100.0f;
-    }
-    else
-    {
-        percent_used = ((F32)dirFileSize(sCacheDir) / (F32)mMaxSizeBytes) * 100.0f; 
-    }
+    // The index keeps the total current, so there's no need to scan.
+    F32 percent_used = ((F32)(mIndex.getTotalBytes() + mPack.getFileBytes()) / (F32)mMaxSizeBytes) * 100.0f;
     // </FS:Beq>
     cache_info << std::fixed;
     cache_info << std::setprecision(1);
     cache_info << "Max size " << max_in_mb << " MB ";
     cache_info << "(" << percent_used << "% used)";
 
+    const LLCacheCompressor::Stats stats = mCompressor.getStats();
+    if (stats.mCompressed)
+    {
+        cache_info << ", compressed " << stats.getRatio() << ":1";
+    }
+
     return cache_info.str();
 }
 
@@ -390,6 +880,14 @@ void LLDiskCache::prepopulateCacheWithStatic()
                     {
                         LL_WARNS("LLDiskCache") << "Failed to copy " << from_asset_file << " to " << to_asset_file << LL_ENDL;
                     }
+                    else
+                    {
+                        llstat file_stat;
+                        if (LLFile::stat(to_asset_file, &file_stat) == 0)
+                        {
+                            mIndex.noteWrite(metaDataToFilename(uuid, LLAssetType::AT_UNKNOWN), file_stat.st_size, true);
+                        }
+                    }
                 }
                 if (std::find(mSkipList.begin(), mSkipList.end(), uuid_as_string) == mSkipList.end())
                 {
@@ -442,6 +940,8 @@ void LLDiskCache::clearCache()
             }
             iter.increment(ec);
         }
+        mIndex.clear();
+        mPack.clear();
         // <FS:Beq> add static assets into the new cache after clear
     LL_INFOS() << "prepopulating new cache " << LL_ENDL;
         prepopulateCacheWithStatic();
@@ -24,13 +24,21 @@
                     identify this as a Viewer asset file
  * 2/ The time of last access for a file can be updated instantly
  *    for file reads and automatically as part of the file writes.
- * 3/ The purge algorithm collects a list of all files in the
- *    directory, sorts them by date of last access (write) and then
- *    deletes any files based on age until the total size of all
- *    the files is less than the maximum size specified.
- * 4/ An LLSingleton idiom is used since there will only ever be
+ * 3/ An index of every cache file's size and last access, kept in
+ *    least-recently-used order, is updated as LLFileSystem reads,
+ *    writes and removes files, and persisted as a journal in the
+ *    cache folder (see LLDiskCacheIndex). The purge pops the oldest
+ *    entries off the index and deletes those files until the total
+ *    size is under the low water mark. The directory is only scanned
+ *    when the journal is missing, damaged or was not closed cleanly.
+ * 4/ Optionally, LLFileSystem deflates whole files written in one go
+ *    with a dictionary trained on the cache's contents (see
+ *    LLCacheCompressor), and inflates them again as they are read.
+ *    Compressed files start with a frame header, so the two kinds can
+ *    share the folder, and the index counts their size on disk.
+ * 5/ An LLSingleton idiom is used since there will only ever be
  *    a single cache and we want to access it from numerous places.
- * 5/ Performance on my modest system seems very acceptable. For
+ * 6/ Performance on my modest system seems very acceptable. For
  *    example, in testing, I was able to purge a directory of
  *    10,000 files, deleting about half of them in ~ 1700ms. For
  *    the same sized directory of files, writing the last updated
@@ -62,10 +70,106 @@
 #ifndef _LLDISKCACHE
 #define _LLDISKCACHE
 
+#include "llassettype.h"
 #include "llsingleton.h"
+#include "lluuid.h"
+#include "lldiskcachepack.h"
+#include "llcachecompressor.h"
 #include <chrono>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 using namespace std::chrono;
 
+/**
+ * Sizes and access times of the files in a disk cache folder, in least
+ * recently used order, keyed by path relative to the folder.
+ *
+ * Changes are queued as journal records and appended to the journal file
+ * by flush(); once the journal is much longer than the index it is
+ * rewritten as a snapshot. close() writes a snapshot ending in a "clean"
+ * record. load() only trusts a journal that ends that way: after a crash,
+ * the caller rebuilds the index with rescan().
+ *
+ * All methods are thread safe.
+ */
+class LLDiskCacheIndex
+{
+    public:
+        typedef std::pair<std::string, uintmax_t> file_t;
+
+        LLDiskCacheIndex(const std::string& cache_dir, const std::string& prefix);
+
+        /// replay the journal; false if it is missing, damaged or unclean
+        bool load();
+
+        /// rebuild from a scan of every file in the folder with our prefix
+        void rescan();
+
+        /**
+         * Record a write ending at end_offset. A truncating write sets the
+         * size; otherwise the file can only have grown.
+         */
+        void noteWrite(const std::string& name, uintmax_t end_offset, bool truncated);
+        void noteRead(const std::string& name);
+        void noteRemove(const std::string& name);
+        void noteRename(const std::string& old_name, const std::string& new_name);
+        void clear();
+
+        /**
+         * Take the least recently used entries off the index until the total
+         * is no more than target_bytes, and return them oldest first for the
+         * caller to delete. Entries for which spare() returns true are kept
+         * and moved to the most recently used end instead.
+         */
+        std::vector<file_t> evict(uintmax_t target_bytes,
+                                  const std::function<bool(const std::string&)>& spare,
+                                  U32& spared);
+
+        uintmax_t getTotalBytes() const;
+        size_t size() const;
+
+        /// append queued records to the journal, compacting it if need be
+        void flush();
+        /// write a clean snapshot; the index remains usable
+        void close();
+
+        const std::string& getJournalPath() const { return mJournalPath; }
+
+    private:
+        struct Entry
+        {
+            uintmax_t mSize;
+            S64 mAccessTime;
+            std::list<const std::string*>::iterator mLRU;
+        };
+        typedef std::unordered_map<std::string, Entry> entries_t;
+
+        // the caller holds mMutex for all of these
+        void set(const std::string& name, uintmax_t size, S64 access_time);
+        void touch(entries_t::iterator it, S64 access_time);
+        void erase(entries_t::iterator it);
+        void writeSnapshot(bool clean);
+
+        const std::string mCacheDir;
+        const std::string mPrefix;
+        const std::string mJournalPath;
+
+        mutable std::mutex mMutex;
+        entries_t mEntries;
+        // oldest first; points at the keys of mEntries
+        std::list<const std::string*> mLRU;
+        uintmax_t mTotalBytes{ 0 };
+        // records not yet appended to the journal
+        std::string mPending;
+        // records in the journal file, including pending ones
+        size_t mJournalRecords{ 0 };
+
+        // serializes journal file writes; taken before mMutex
+        std::mutex mJournalMutex;
+};
+
 
 class LLDiskCache :
     public LLParamSingleton<LLDiskCache>
@@ -108,7 +212,7 @@ class LLDiskCache :
                     // </FS:Beq>
                     );
 
-        virtual ~LLDiskCache() = default;
+        virtual ~LLDiskCache();
 
     public:
         /**
@@ -120,6 +224,34 @@ class LLDiskCache :
          */
         static const std::string metaDataToFilepath(const LLUUID& id, LLAssetType::EType at);
 
+        /**
+         * Keep the cache index up to date. LLFileSystem calls these after it
+         * writes, reads, removes or renames a cache file; they do nothing if
+         * the cache has not been initialized.
+         */
+        static void noteWrite(const LLUUID& id, LLAssetType::EType at, uintmax_t end_offset, bool truncated);
+        static void noteRead(const LLUUID& id, LLAssetType::EType at);
+        static void noteRemove(const LLUUID& id, LLAssetType::EType at);
+        static void noteRename(const LLUUID& old_id, LLAssetType::EType old_at,
+                               const LLUUID& new_id, LLAssetType::EType new_at);
+
+        /**
+         * The pack file store for small assets, or nullptr if the cache has
+         * not been initialized. See LLDiskCachePack.
+         */
+        static LLDiskCachePack* getPack();
+        void setPackMaxAssetSize(U32 bytes) { mPack.setMaxAssetSize(bytes); }
+
+        /**
+         * The compressor for cache files, or nullptr if the cache has not
+         * been initialized. Files of types that are compressed already are
+         * neither compressed nor checked for a frame header: see
+         * isCompressible().
+         */
+        static LLCacheCompressor* getCompressor();
+        static bool isCompressible(LLAssetType::EType at);
+        void setCompression(bool enabled) { mCompressor.setEnabled(enabled); }
+
         /**
          * Purge the oldest items in the cache so that the combined size of all files
          * is no bigger than mMaxSizeBytes.
@@ -175,6 +307,15 @@ class LLDiskCache :
         uintmax_t mStoredCacheSize{ 0 };
         time_point<system_clock> mLastScanTime{ };
 
+        /**
+         * Name of a cache file relative to sCacheDir, as the index keys it
+         */
+        static std::string metaDataToFilename(const LLUUID& id, LLAssetType::EType at);
+
+        LLDiskCacheIndex mIndex;
+        LLDiskCachePack mPack;
+        LLCacheCompressor mCompressor;
+
     private:
         /**
          * The maximum size of the cache in bytes. After purge is called, the
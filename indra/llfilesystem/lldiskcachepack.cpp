@@ -0,0 +1,601 @@
+/**
+ * @file   lldiskcachepack.cpp
+ * @date   2026-10-18
+ * @brief  Implementation for lldiskcachepack.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lldiskcachepack.h"
+
+#include "lldir.h"
+#include <boost/filesystem.hpp>
+#include <cstring>
+
+namespace
+{
+    const std::string PACK_DIRNAME("asset_packs");
+
+    // Each record is a RecordHeader, then the data padded to 8 bytes.
+    const U32 RECORD_MAGIC = 0x4b504c4c; // "LLPK"
+    const U32 FLAG_TOMBSTONE = 1;
+
+    struct RecordHeader
+    {
+        U32 mMagic;
+        U32 mSize;
+        U32 mFlags;
+        U32 mReserved;
+        U8 mID[UUID_BYTES];
+    };
+    static_assert(sizeof(RecordHeader) == 32, "RecordHeader must not be padded");
+
+    // A full segment's .idx is INDEX_MAGIC, the U64 length of the segment it
+    // describes, a U32 count and that many IndexRecords.
+    const char INDEX_MAGIC[8] = { 'L', 'L', 'P', 'K', 'I', 'D', 'X', '1' };
+
+    struct IndexRecord
+    {
+        U8 mID[UUID_BYTES];
+        // of the record header
+        U32 mOffset;
+        U32 mSize;
+        U32 mFlags;
+    };
+
+    U32 padded(U32 size)
+    {
+        return (size + 7) & ~7U;
+    }
+
+    // Walk the records in a segment, returning the length of the valid
+    // prefix: a crash can leave a partial record at the end.
+    size_t scan_records(const U8* data, size_t size, std::vector<IndexRecord>& records)
+    {
+        size_t pos = 0;
+        while (size - pos >= sizeof(RecordHeader))
+        {
+            RecordHeader header;
+            memcpy(&header, data + pos, sizeof(header));
+            if (header.mMagic != RECORD_MAGIC ||
+                sizeof(header) + padded(header.mSize) > size - pos)
+            {
+                break;
+            }
+            IndexRecord record;
+            memcpy(record.mID, header.mID, UUID_BYTES);
+            record.mOffset = (U32)pos;
+            record.mSize = header.mSize;
+            record.mFlags = header.mFlags;
+            records.push_back(record);
+            pos += sizeof(header) + padded(header.mSize);
+        }
+        return pos;
+    }
+
+    boost::filesystem::path fs_path(const std::string& path)
+    {
+#if LL_WINDOWS
+        return boost::filesystem::path(utf8str_to_utf16str(path));
+#else
+        return boost::filesystem::path(path);
+#endif
+    }
+} // anonymous namespace
+
+LLDiskCachePack::LLDiskCachePack(const std::string& cache_dir) :
+    mDir(cache_dir + gDirUtilp->getDirDelimiter() + PACK_DIRNAME)
+{
+}
+
+LLDiskCachePack::~LLDiskCachePack()
+{
+    if (mActive)
+    {
+        fclose(mActive);
+    }
+}
+
+void LLDiskCachePack::open()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mActive)
+    {
+        fclose(mActive);
+        mActive = nullptr;
+    }
+    mSegments.clear();
+    mEntries.clear();
+    mFileBytes = 0;
+    mLiveBytes = 0;
+
+    std::vector<U32> numbers;
+    for (const std::string& name : gDirUtilp->getFilesInDir(mDir))
+    {
+        U32 number = 0;
+        char extension[8] = {};
+        if (sscanf(name.c_str(), "pack_%8u.%3s", &number, extension) == 2 &&
+            ! strcmp(extension, "seg"))
+        {
+            numbers.push_back(number);
+        }
+    }
+    std::sort(numbers.begin(), numbers.end());
+
+    // replay oldest first, so later records and tombstones win
+    for (U32 number : numbers)
+    {
+        auto segment = std::make_unique<Segment>();
+        segment->mNumber = number;
+        Segment& loaded = *mSegments.emplace(number, std::move(segment)).first->second;
+        loadSegment(loaded);
+    }
+
+    if (! mSegments.empty())
+    {
+        LL_INFOS("LLDiskCache") << "Asset packs: " << mEntries.size() << " assets in "
+                                << mSegments.size() << " segments, " << mLiveBytes << " of "
+                                << mFileBytes << " bytes live" << LL_ENDL;
+    }
+}
+
+S32 LLDiskCachePack::getSize(const LLUUID& id) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto found = mEntries.find(id);
+    return found == mEntries.end() ? -1 : (S32)found->second.mSize;
+}
+
+S32 LLDiskCachePack::read(const LLUUID& id, S32 offset, U8* buffer, S32 bytes)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto found = mEntries.find(id);
+    if (found == mEntries.end())
+    {
+        return -1;
+    }
+    const Location& location = found->second;
+    if (offset < 0 || bytes <= 0 || U32(offset) >= location.mSize)
+    {
+        return 0;
+    }
+    const S32 count = llmin(bytes, S32(location.mSize - offset));
+    const U8* data = mapped(*mSegments[location.mSegment], location);
+    if (! data)
+    {
+        LL_WARNS("LLDiskCache") << "Asset pack segment " << location.mSegment
+                                << " is shorter than its index says" << LL_ENDL;
+        return 0;
+    }
+    memcpy(buffer, data + offset, count);
+    return count;
+}
+
+bool LLDiskCachePack::write(const LLUUID& id, const U8* data, S32 bytes)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    Location location;
+    if (bytes < 0 || ! append(id, data, (U32)bytes, false, location))
+    {
+        return false;
+    }
+    apply(id, location.mSegment, location.mOffset, location.mSize, false);
+    return true;
+}
+
+bool LLDiskCachePack::remove(const LLUUID& id)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mEntries.find(id) == mEntries.end())
+    {
+        return false;
+    }
+    // until the tombstone is on disk, replay would bring the asset back
+    Location location;
+    if (! append(id, nullptr, 0, true, location))
+    {
+        return false;
+    }
+    forget(id);
+    return true;
+}
+
+bool LLDiskCachePack::rename(const LLUUID& from, const LLUUID& to)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto found = mEntries.find(from);
+    if (found == mEntries.end())
+    {
+        return false;
+    }
+    const Location from_location = found->second;
+    const U8* data = mapped(*mSegments[from_location.mSegment], from_location);
+    if (! data)
+    {
+        return false;
+    }
+    // append() may remap segments, so copy first
+    std::vector<U8> copy(data, data + from_location.mSize);
+    Location location;
+    if (! append(to, copy.data(), (U32)copy.size(), false, location))
+    {
+        return false;
+    }
+    apply(to, location.mSegment, location.mOffset, location.mSize, false);
+    if (! append(from, nullptr, 0, true, location))
+    {
+        // both records are live on disk, so keep both here too
+        return false;
+    }
+    forget(from);
+    return true;
+}
+
+bool LLDiskCachePack::take(const LLUUID& id, std::vector<U8>& data)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto found = mEntries.find(id);
+    if (found == mEntries.end())
+    {
+        return false;
+    }
+    const Location location = found->second;
+    const U8* bytes = mapped(*mSegments[location.mSegment], location);
+    if (bytes)
+    {
+        data.assign(bytes, bytes + location.mSize);
+    }
+    Location tombstone;
+    if (! append(id, nullptr, 0, true, tombstone))
+    {
+        // still packed, so the caller mustn't carry on with a loose copy
+        data.clear();
+        return false;
+    }
+    forget(id);
+    return bytes != nullptr;
+}
+
+void LLDiskCachePack::compact()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    // The last segment is the one being appended to, so leave it be.
+    while (mSegments.size() > 1)
+    {
+        auto oldest = mSegments.begin();
+        Segment& segment = *oldest->second;
+        if (segment.mLiveBytes * 2 >= segment.mBytes)
+        {
+            break;
+        }
+
+        std::vector<std::pair<LLUUID, Location>> survivors;
+        for (const auto& entry : mEntries)
+        {
+            if (entry.second.mSegment == segment.mNumber)
+            {
+                survivors.push_back(entry);
+            }
+        }
+        U64 moved = 0;
+        bool ok = true;
+        for (const auto& survivor : survivors)
+        {
+            // Appends only ever touch the newest segment, so this mapping
+            // of the oldest stays put.
+            const U8* data = mapped(segment, survivor.second);
+            Location location;
+            if (data && ! append(survivor.first, data, survivor.second.mSize, false, location))
+            {
+                ok = false;
+                break;
+            }
+            if (data)
+            {
+                apply(survivor.first, location.mSegment, location.mOffset, location.mSize, false);
+                moved += location.mSize;
+            }
+        }
+        if (! ok)
+        {
+            break;
+        }
+        LL_INFOS("LLDiskCache") << "Compacted asset pack segment " << segment.mNumber << ": kept "
+                                << survivors.size() << " assets, " << moved << " of "
+                                << segment.mBytes << " bytes" << LL_ENDL;
+        dropSegment(oldest);
+    }
+}
+
+void LLDiskCachePack::trim(U64 max_bytes)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    while (mFileBytes > max_bytes && ! mSegments.empty())
+    {
+        LL_INFOS("LLDiskCache") << "Dropping asset pack segment " << mSegments.begin()->first
+                                << " to fit " << max_bytes << " bytes" << LL_ENDL;
+        dropSegment(mSegments.begin());
+    }
+}
+
+void LLDiskCachePack::clear()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    while (! mSegments.empty())
+    {
+        dropSegment(mSegments.begin());
+    }
+}
+
+U64 LLDiskCachePack::getFileBytes() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mFileBytes;
+}
+
+U64 LLDiskCachePack::getLiveBytes() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mLiveBytes;
+}
+
+size_t LLDiskCachePack::size() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+std::string LLDiskCachePack::segmentPath(U32 number, const char* extension) const
+{
+    return mDir + gDirUtilp->getDirDelimiter() + llformat("pack_%08u.%s", number, extension);
+}
+
+void LLDiskCachePack::loadSegment(Segment& segment)
+{
+    const std::string path = segmentPath(segment.mNumber, "seg");
+    llstat file_stat;
+    if (LLFile::stat(path, &file_stat) != 0)
+    {
+        return;
+    }
+    U64 file_size = file_stat.st_size;
+
+    // A full segment has its index beside it, as long as the two agree.
+    std::vector<IndexRecord> records;
+    bool indexed = false;
+    if (LLFILE* index = LLFile::fopen(segmentPath(segment.mNumber, "idx"), "rb"))
+    {
+        char magic[sizeof(INDEX_MAGIC)];
+        U64 indexed_size = 0;
+        U32 count = 0;
+        if (fread(magic, sizeof(magic), 1, index) == 1 && ! memcmp(magic, INDEX_MAGIC, sizeof(magic)) &&
+            fread(&indexed_size, sizeof(indexed_size), 1, index) == 1 && indexed_size == file_size &&
+            fread(&count, sizeof(count), 1, index) == 1 && count <= file_size / sizeof(RecordHeader))
+        {
+            records.resize(count);
+            indexed = fread(records.data(), sizeof(IndexRecord), count, index) == count;
+        }
+        fclose(index);
+    }
+
+    if (indexed)
+    {
+        segment.mSealed = true;
+    }
+    else
+    {
+        records.clear();
+        if (segment.mMapping.map(path))
+        {
+            const size_t valid = scan_records(segment.mMapping.data(), segment.mMapping.size(), records);
+            if (valid < file_size)
+            {
+                LL_WARNS("LLDiskCache") << "Truncating damaged asset pack " << path << " from "
+                                        << file_size << " to " << valid << " bytes" << LL_ENDL;
+                segment.mMapping.unmap();
+                boost::system::error_code ec;
+                boost::filesystem::resize_file(fs_path(path), valid, ec);
+                file_size = valid;
+            }
+        }
+    }
+    segment.mBytes = file_size;
+    mFileBytes += file_size;
+
+    LLUUID id;
+    for (const IndexRecord& record : records)
+    {
+        memcpy(id.mData, record.mID, UUID_BYTES);
+        apply(id, segment.mNumber, record.mOffset + sizeof(RecordHeader), record.mSize,
+              record.mFlags & FLAG_TOMBSTONE);
+    }
+}
+
+void LLDiskCachePack::apply(const LLUUID& id, U32 segment, U32 offset, U32 size, bool tombstone)
+{
+    forget(id);
+    if (! tombstone)
+    {
+        mEntries[id] = Location{ segment, offset, size };
+        mSegments[segment]->mLiveBytes += size;
+        mLiveBytes += size;
+    }
+}
+
+void LLDiskCachePack::forget(const LLUUID& id)
+{
+    auto found = mEntries.find(id);
+    if (found != mEntries.end())
+    {
+        auto segment = mSegments.find(found->second.mSegment);
+        if (segment != mSegments.end())
+        {
+            segment->second->mLiveBytes -= found->second.mSize;
+        }
+        mLiveBytes -= found->second.mSize;
+        mEntries.erase(found);
+    }
+}
+
+bool LLDiskCachePack::append(const LLUUID& id, const U8* data, U32 size, bool tombstone, Location& location)
+{
+    const U32 length = sizeof(RecordHeader) + padded(size);
+    Segment* active = mSegments.empty() ? nullptr : mSegments.rbegin()->second.get();
+    if (active && (active->mSealed || (active->mBytes && active->mBytes + length > SEGMENT_SIZE)))
+    {
+        if (! active->mSealed)
+        {
+            seal(*active);
+        }
+        active = nullptr;
+    }
+    if (! active)
+    {
+        if (mActive)
+        {
+            fclose(mActive);
+            mActive = nullptr;
+        }
+        LLFile::mkdir(mDir);
+        const U32 number = mSegments.empty() ? 1 : mSegments.rbegin()->first + 1;
+        auto segment = std::make_unique<Segment>();
+        segment->mNumber = number;
+        active = mSegments.emplace(number, std::move(segment)).first->second.get();
+    }
+    if (! mActive)
+    {
+        mActive = LLFile::fopen(segmentPath(active->mNumber, "seg"), "ab");
+        if (! mActive)
+        {
+            LL_WARNS("LLDiskCache") << "Can't open asset pack segment " << active->mNumber << LL_ENDL;
+            return false;
+        }
+    }
+
+    RecordHeader header{ RECORD_MAGIC, size, tombstone ? FLAG_TOMBSTONE : 0, 0, {} };
+    memcpy(header.mID, id.mData, UUID_BYTES);
+    static const U8 padding[8] = {};
+    const size_t pad = length - sizeof(header) - size;
+    const bool written = fwrite(&header, sizeof(header), 1, mActive) == 1 &&
+                         (! size || fwrite(data, 1, size, mActive) == size) &&
+                         (! pad || fwrite(padding, 1, pad, mActive) == pad) &&
+                         // readers map the file, so it must reach the OS now
+                         fflush(mActive) == 0;
+    if (! written)
+    {
+        LL_WARNS("LLDiskCache") << "Failed to append to asset pack segment " << active->mNumber << LL_ENDL;
+        // cut off whatever part of the record made it, so later appends
+        // don't land after garbage; a mapped file can't be truncated
+        // (Windows) or may fault when touched past its end (POSIX), and
+        // mapped() maps it again on demand
+        fclose(mActive);
+        mActive = nullptr;
+        active->mMapping.unmap();
+        boost::system::error_code ec;
+        boost::filesystem::resize_file(fs_path(segmentPath(active->mNumber, "seg")), active->mBytes, ec);
+        return false;
+    }
+
+    location = Location{ active->mNumber, U32(active->mBytes + sizeof(header)), size };
+    active->mBytes += length;
+    mFileBytes += length;
+    return true;
+}
+
+void LLDiskCachePack::seal(Segment& segment)
+{
+    // only ever the last segment, which mActive is open on
+    if (mActive)
+    {
+        fclose(mActive);
+        mActive = nullptr;
+    }
+    std::vector<IndexRecord> records;
+    if (segment.mMapping.map(segmentPath(segment.mNumber, "seg")))
+    {
+        scan_records(segment.mMapping.data(), segment.mMapping.size(), records);
+    }
+    const U64 bytes = segment.mBytes;
+    const U32 count = (U32)records.size();
+    const std::string index_path = segmentPath(segment.mNumber, "idx");
+    LLFILE* index = LLFile::fopen(index_path, "wb");
+    bool written = index &&
+                   fwrite(INDEX_MAGIC, sizeof(INDEX_MAGIC), 1, index) == 1 &&
+                   fwrite(&bytes, sizeof(bytes), 1, index) == 1 &&
+                   fwrite(&count, sizeof(count), 1, index) == 1 &&
+                   fwrite(records.data(), sizeof(IndexRecord), count, index) == count;
+    if (index)
+    {
+        written = (fclose(index) == 0) && written;
+    }
+    if (! written)
+    {
+        // harmless: the segment gets scanned at startup instead
+        LL_WARNS("LLDiskCache") << "Failed to write " << index_path << LL_ENDL;
+        LLFile::remove(index_path, ENOENT);
+    }
+    segment.mSealed = true;
+}
+
+const U8* LLDiskCachePack::mapped(Segment& segment, const Location& location)
+{
+    const size_t end = size_t(location.mOffset) + location.mSize;
+    if (segment.mMapping.size() < end)
+    {
+        // not mapped yet, or appended to since
+        segment.mMapping.map(segmentPath(segment.mNumber, "seg"));
+        if (segment.mMapping.size() < end)
+        {
+            return nullptr;
+        }
+    }
+    return segment.mMapping.data() + location.mOffset;
+}
+
+void LLDiskCachePack::dropSegment(segments_t::iterator it)
+{
+    Segment& segment = *it->second;
+    for (auto entry = mEntries.begin(); entry != mEntries.end(); )
+    {
+        if (entry->second.mSegment == segment.mNumber)
+        {
+            mLiveBytes -= entry->second.mSize;
+            entry = mEntries.erase(entry);
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+    if (mActive && std::next(it) == mSegments.end())
+    {
+        fclose(mActive);
+        mActive = nullptr;
+    }
+    segment.mMapping.unmap();
+    mFileBytes -= segment.mBytes;
+    LLFile::remove(segmentPath(segment.mNumber, "seg"), ENOENT);
+    LLFile::remove(segmentPath(segment.mNumber, "idx"), ENOENT);
+    mSegments.erase(it);
+}
@@ -0,0 +1,151 @@
+/**
+ * @file   lldiskcachepack.h
+ * @date   2026-10-18
+ * @brief  Segment-file storage for small disk cache assets.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLDISKCACHEPACK_H
+#define LL_LLDISKCACHEPACK_H
+
+#include "llfile.h"
+#include "llmappedfile.h"
+#include "lluuid.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * LLDiskCachePack keeps small cached assets as records appended to a few
+ * large segment files instead of a file apiece, saving an open/close per
+ * read and an inode per asset. Segments live in their own folder under the
+ * cache folder, so listing them doesn't mean listing the loose files.
+ *
+ * The asset ID to segment offset map is held in memory. At startup it is
+ * rebuilt from the .idx file written beside each full segment, plus a scan
+ * of the one segment still being appended to. Reads copy straight out of a
+ * read-only mapping of the segment.
+ *
+ * Records are never rewritten in place: writing an asset again appends a
+ * new record and removing one appends a tombstone. compact() reclaims the
+ * dead space by moving the live records out of the oldest segment, and
+ * trim() keeps the total within a budget by dropping the oldest segments
+ * whole. Because both only ever retire the oldest segment, no tombstone can
+ * outlive a record it hides.
+ *
+ * LLFileSystem decides which assets are stored here. All methods are thread
+ * safe.
+ */
+class LLDiskCachePack
+{
+public:
+    LLDiskCachePack(const std::string& cache_dir);
+    ~LLDiskCachePack();
+
+    LLDiskCachePack(const LLDiskCachePack&) = delete;
+    LLDiskCachePack& operator=(const LLDiskCachePack&) = delete;
+
+    /// load any existing segments
+    void open();
+
+    /// Largest asset write() should be given; 0 sends everything to loose
+    /// files. Packed assets stay readable either way.
+    void setMaxAssetSize(U32 bytes) { mMaxAssetSize = bytes; }
+    bool accepts(S32 bytes) const { return bytes > 0 && U32(bytes) <= mMaxAssetSize; }
+
+    /// size of a packed asset, or -1 if it isn't packed
+    S32 getSize(const LLUUID& id) const;
+    /// Copy up to bytes from offset into buffer, returning how many were
+    /// copied, or -1 if the asset isn't packed.
+    S32 read(const LLUUID& id, S32 offset, U8* buffer, S32 bytes);
+    /// store (or replace) a whole asset
+    bool write(const LLUUID& id, const U8* data, S32 bytes);
+    /// false if the asset wasn't packed, or its tombstone couldn't be
+    /// written, in which case it's still packed
+    bool remove(const LLUUID& id);
+    /// false if from wasn't packed; any packed 'to' is replaced. If from's
+    /// tombstone can't be written, returns false with both packed.
+    bool rename(const LLUUID& from, const LLUUID& to);
+    /// move a packed asset's contents out of the pack; false, leaving it
+    /// packed, if its tombstone can't be written
+    bool take(const LLUUID& id, std::vector<U8>& data);
+
+    /// Move the live records out of the oldest segments while less than
+    /// half of each is live.
+    void compact();
+    /// drop oldest segments until the files take no more than max_bytes
+    void trim(U64 max_bytes);
+    /// delete every segment
+    void clear();
+
+    U64 getFileBytes() const;
+    U64 getLiveBytes() const;
+    size_t size() const;
+
+    static const U32 SEGMENT_SIZE = 16 * 1024 * 1024;
+
+private:
+    struct Location
+    {
+        U32 mSegment;
+        // of the data, past the record header
+        U32 mOffset;
+        U32 mSize;
+    };
+    struct Segment
+    {
+        U32 mNumber;
+        U64 mBytes{ 0 };
+        U64 mLiveBytes{ 0 };
+        // full, with its .idx written
+        bool mSealed{ false };
+        LLMappedFile mMapping;
+    };
+    typedef std::map<U32, std::unique_ptr<Segment>> segments_t;
+
+    // the caller holds mMutex for all of these
+    std::string segmentPath(U32 number, const char* extension) const;
+    void loadSegment(Segment& segment);
+    void apply(const LLUUID& id, U32 segment, U32 offset, U32 size, bool tombstone);
+    void forget(const LLUUID& id);
+    bool append(const LLUUID& id, const U8* data, U32 size, bool tombstone, Location& location);
+    void seal(Segment& segment);
+    const U8* mapped(Segment& segment, const Location& location);
+    void dropSegment(segments_t::iterator it);
+
+    const std::string mDir;
+    std::atomic<U32> mMaxAssetSize{ 0 };
+
+    mutable std::mutex mMutex;
+    segments_t mSegments;
+    std::unordered_map<LLUUID, Location> mEntries;
+    // last segment, once opened for appending
+    LLFILE* mActive{ nullptr };
+    U64 mFileBytes{ 0 };
+    U64 mLiveBytes{ 0 };
+};
+
+#endif // LL_LLDISKCACHEPACK_H
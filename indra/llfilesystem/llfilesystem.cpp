@@ -31,6 +31,7 @@
 
 #include "lldir.h"
 #include "llfilesystem.h"
+#include "llcachestats.h"
 #include "llfasttimer.h"
 #include "lldiskcache.h"
 
@@ -43,6 +44,15 @@ constexpr S32 LLFileSystem::APPEND      = 0x00000006;  // 0x00000004 & LLFileSys
 
 static LLTrace::BlockTimerStatHandle FTM_VFILE_WAIT("VFile Wait");
 
+namespace
+{
+    // meshes are counted by LLMeshRepository, as a tier of their own
+    bool is_asset_tier(LLAssetType::EType type)
+    {
+        return type != LLAssetType::AT_MESH;
+    }
+}
+
 LLFileSystem::LLFileSystem(const LLUUID& file_id, const LLAssetType::EType file_type, S32 mode)
 {
     mFileType = file_type;
@@ -56,6 +66,17 @@ LLFileSystem::LLFileSystem(const LLUUID& file_id, const LLAssetType::EType file_
     // we decided to follow Henri's suggestion and move the code to update the last access time here.
     if (mode == LLFileSystem::READ)
     {
+        // small assets may be packed rather than in a file of their own
+        LLDiskCachePack* pack = LLDiskCache::getPack();
+        if (pack && pack->getSize(mFileID) >= 0)
+        {
+            if (is_asset_tier(mFileType))
+            {
+                LLCacheStats::hit(LLCacheStats::ASSET);
+            }
+            return;
+        }
+
         // build the filename (TODO: we do this in a few places - perhaps we should factor into a single function)
         const std::string filename = LLDiskCache::metaDataToFilepath(mFileID, mFileType);
 
@@ -67,6 +88,18 @@ LLFileSystem::LLFileSystem(const LLUUID& file_id, const LLAssetType::EType file_
         if (exists)
         {
             updateFileAccessTime(filename);
+            LLDiskCache::noteRead(mFileID, mFileType);
+        }
+        if (is_asset_tier(mFileType))
+        {
+            if (exists)
+            {
+                LLCacheStats::hit(LLCacheStats::ASSET);
+            }
+            else
+            {
+                LLCacheStats::miss(LLCacheStats::ASSET);
+            }
         }
     }
 }
@@ -75,6 +108,12 @@ LLFileSystem::LLFileSystem(const LLUUID& file_id, const LLAssetType::EType file_
 bool LLFileSystem::getExists(const LLUUID& file_id, const LLAssetType::EType file_type)
 {
     LL_PROFILE_ZONE_SCOPED;
+    LLDiskCachePack* pack = LLDiskCache::getPack();
+    if (pack && pack->getSize(file_id) > 0)
+    {
+        return true;
+    }
+
     const std::string filename = LLDiskCache::metaDataToFilepath(file_id, file_type);
 
     // <FS:Ansariel> IO-streams replacement
@@ -100,7 +139,14 @@ bool LLFileSystem::removeFile(const LLUUID& file_id, const LLAssetType::EType fi
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
     const std::string filename = LLDiskCache::metaDataToFilepath(file_id, file_type);
 
+    LLDiskCachePack* pack = LLDiskCache::getPack();
+    if (pack && pack->remove(file_id))
+    {
+        // a packed asset has no loose file as well
+        suppress_error = ENOENT;
+    }
     LLFile::remove(filename.c_str(), suppress_error);
+    LLDiskCache::noteRemove(file_id, file_type);
 
     return true;
 }
@@ -116,6 +162,12 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
     // Rename needs the new file to not exist.
     LLFileSystem::removeFile(new_file_id, new_file_type, ENOENT);
 
+    LLDiskCachePack* pack = LLDiskCache::getPack();
+    if (pack && pack->rename(old_file_id, new_file_id))
+    {
+        return true;
+    }
+
     if (LLFile::rename(old_filename, new_filename) != 0)
     {
         // We would like to return false here indicating the operation
@@ -124,6 +176,10 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
         //return false;
         LL_WARNS() << "Failed to rename " << old_file_id << " to " << new_file_id << " reason: " << strerror(errno) << LL_ENDL;
     }
+    else
+    {
+        LLDiskCache::noteRename(old_file_id, old_file_type, new_file_id, new_file_type);
+    }
 
     return true;
 }
@@ -132,9 +188,16 @@ bool LLFileSystem::renameFile(const LLUUID& old_file_id, const LLAssetType::ETyp
 S32 LLFileSystem::getFileSize(const LLUUID& file_id, const LLAssetType::EType file_type)
 {
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    LLDiskCachePack* pack = LLDiskCache::getPack();
+    S32 file_size = pack ? pack->getSize(file_id) : -1;
+    if (file_size >= 0)
+    {
+        return file_size;
+    }
+
     const std::string filename = LLDiskCache::metaDataToFilepath(file_id, file_type);
 
-    S32 file_size = 0;
+    file_size = 0;
     // <FS:Ansariel> IO-streams replacement
     //llifstream file(filename, std::ios::binary);
     //if (file.is_open())
@@ -149,14 +212,59 @@ S32 LLFileSystem::getFileSize(const LLUUID& file_id, const LLAssetType::EType fi
     }
     // </FS:Ansariel>
 
+    // a compressed file is as big as it will be once inflated
+    if (file_size >= (S32)LLCacheCompressor::FRAME_HEADER_SIZE && LLDiskCache::isCompressible(file_type))
+    {
+        LLFILE* file = LLFile::fopen(filename, "rb");
+        if (file)
+        {
+            U8 header[LLCacheCompressor::FRAME_HEADER_SIZE];
+            U32 raw_size = 0;
+            if (fread(header, 1, sizeof(header), file) == sizeof(header)
+                && LLCacheCompressor::readFrameHeader(header, sizeof(header), raw_size))
+            {
+                file_size = (S32)raw_size;
+            }
+            fclose(file);
+        }
+    }
+
     return file_size;
 }
 
 bool LLFileSystem::read(U8* buffer, S32 bytes)
 {
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    LLCacheStats::Timer timer;
+    const bool success = readFile(buffer, bytes);
+    if (success && is_asset_tier(mFileType))
+    {
+        LLCacheStats::read(LLCacheStats::ASSET, mBytesRead, timer.getMicros());
+    }
+    return success;
+}
+
+bool LLFileSystem::readFile(U8* buffer, S32 bytes)
+{
     bool success = false;
 
+    LLDiskCachePack* pack = LLDiskCache::getPack();
+    if (pack)
+    {
+        const S32 bytes_read = pack->read(mFileID, mPosition, buffer, bytes);
+        if (bytes_read >= 0)
+        {
+            mBytesRead = bytes_read;
+            mPosition += mBytesRead;
+            return mBytesRead > 0;
+        }
+    }
+
+    if (mDecoded)
+    {
+        return readDecoded(buffer, bytes);
+    }
+
     const std::string filename = LLDiskCache::metaDataToFilepath(mFileID, mFileType);
 
     // <FS:Ansariel> IO-streams replacement
@@ -187,6 +295,12 @@ bool LLFileSystem::read(U8* buffer, S32 bytes)
     LLFILE* file = LLFile::fopen(filename, "rb");
     if (file)
     {
+        if (LLDiskCache::isCompressible(mFileType) && decodeFile(file))
+        {
+            fclose(file);
+            return readDecoded(buffer, bytes);
+        }
+
         if (fseek(file, mPosition, SEEK_SET) == 0)
         {
             mBytesRead = static_cast<S32>(fread(buffer, 1, bytes, file));
@@ -206,6 +320,80 @@ bool LLFileSystem::read(U8* buffer, S32 bytes)
     return success;
 }
 
+bool LLFileSystem::decodeFile(LLFILE* file)
+{
+    U8 header[LLCacheCompressor::FRAME_HEADER_SIZE];
+    U32 raw_size = 0;
+    if (fread(header, 1, sizeof(header), file) != sizeof(header)
+        || ! LLCacheCompressor::readFrameHeader(header, sizeof(header), raw_size))
+    {
+        return false;
+    }
+
+    std::vector<U8> frame(header, header + sizeof(header));
+    if (fseek(file, 0, SEEK_END) == 0)
+    {
+        const long file_size = ftell(file);
+        if (file_size > (long)sizeof(header) && fseek(file, sizeof(header), SEEK_SET) == 0)
+        {
+            frame.resize(file_size);
+            frame.resize(sizeof(header) + fread(frame.data() + sizeof(header), 1, file_size - sizeof(header), file));
+        }
+    }
+
+    // a file that won't inflate reads as empty, and will be fetched again
+    mDecoded = std::make_shared<std::vector<U8>>();
+    LLCacheCompressor* compressor = LLDiskCache::getCompressor();
+    if (! compressor || ! compressor->decompressFrame(frame.data(), frame.size(), *mDecoded))
+    {
+        LL_WARNS() << "Failed to decompress cache file for " << mFileID << LL_ENDL;
+        mDecoded->clear();
+    }
+    return true;
+}
+
+bool LLFileSystem::readDecoded(U8* buffer, S32 bytes)
+{
+    mBytesRead = llclamp((S32)mDecoded->size() - mPosition, 0, bytes);
+    if (mBytesRead > 0)
+    {
+        memcpy(buffer, mDecoded->data() + mPosition, mBytesRead);
+    }
+    mPosition += mBytesRead;
+    return mBytesRead > 0;
+}
+
+void LLFileSystem::expandFile(const std::string& filename)
+{
+    LLFILE* file = LLFile::fopen(filename, "rb");
+    if (! file)
+    {
+        return;
+    }
+    const bool compressed = decodeFile(file);
+    fclose(file);
+    if (! compressed)
+    {
+        return;
+    }
+
+    std::shared_ptr<std::vector<U8>> decoded;
+    decoded.swap(mDecoded);
+    LLFILE* ofs = decoded->empty() ? nullptr : LLFile::fopen(filename, "wb");
+    if (ofs)
+    {
+        const bool written = fwrite(decoded->data(), 1, decoded->size(), ofs) == decoded->size();
+        if ((fclose(ofs) == 0) && written)
+        {
+            LLDiskCache::noteWrite(mFileID, mFileType, decoded->size(), true);
+            return;
+        }
+    }
+    // there's nothing to build on
+    LLFile::remove(filename, ENOENT);
+    LLDiskCache::noteRemove(mFileID, mFileType);
+}
+
 S32 LLFileSystem::getLastBytesRead() const
 {
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
@@ -224,6 +412,71 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
     const std::string filename = LLDiskCache::metaDataToFilepath(mFileID, mFileType);
 
     bool success = false;
+    mDecoded.reset();
+
+    LLDiskCachePack* pack = LLDiskCache::getPack();
+    if (pack)
+    {
+        if (mMode == WRITE && pack->accepts(bytes) && pack->write(mFileID, buffer, bytes))
+        {
+            // the packed copy replaces any loose file
+            LLFile::remove(filename, ENOENT);
+            LLDiskCache::noteRemove(mFileID, mFileType);
+            mPosition = bytes;
+            if (is_asset_tier(mFileType))
+            {
+                LLCacheStats::wrote(LLCacheStats::ASSET, bytes);
+            }
+            return true;
+        }
+
+        std::vector<U8> packed;
+        if (pack->take(mFileID, packed) && mMode != WRITE)
+        {
+            // appending to or patching a packed asset: carry on with it as
+            // a loose file
+            LLFILE* ofs = LLFile::fopen(filename, "wb");
+            if (ofs)
+            {
+                if (!packed.empty())
+                {
+                    fwrite(packed.data(), 1, packed.size(), ofs);
+                }
+                fclose(ofs);
+                LLDiskCache::noteWrite(mFileID, mFileType, packed.size(), true);
+            }
+        }
+    }
+
+    if (LLDiskCache::isCompressible(mFileType))
+    {
+        LLCacheCompressor* compressor = LLDiskCache::getCompressor();
+        std::vector<U8> frame;
+        if (mMode != WRITE)
+        {
+            expandFile(filename);
+        }
+        // a plain write is always the whole file, so can be compressed
+        else if (compressor && compressor->compressFrame(buffer, bytes, frame))
+        {
+            LLFILE* ofs = LLFile::fopen(filename, "wb");
+            if (ofs)
+            {
+                const bool written = fwrite(frame.data(), 1, frame.size(), ofs) == frame.size();
+                if ((fclose(ofs) == 0) && written)
+                {
+                    mPosition = bytes;
+                    LLDiskCache::noteWrite(mFileID, mFileType, frame.size(), true);
+                    if (is_asset_tier(mFileType))
+                    {
+                        LLCacheStats::wrote(LLCacheStats::ASSET, frame.size());
+                    }
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
 
     // <FS:Ansariel> IO-streams replacement
     //if (mMode == APPEND)
@@ -322,6 +575,17 @@ bool LLFileSystem::write(const U8* buffer, S32 bytes)
     }
     // </FS:Ansariel>
 
+    if (success)
+    {
+        // mPosition is now the end of what we wrote; only a plain WRITE
+        // truncates the file first
+        LLDiskCache::noteWrite(mFileID, mFileType, mPosition, mMode == WRITE);
+        if (is_asset_tier(mFileType))
+        {
+            LLCacheStats::wrote(LLCacheStats::ASSET, bytes);
+        }
+    }
+
     return success;
 }
 
@@ -365,6 +629,10 @@ S32 LLFileSystem::tell() const
 S32 LLFileSystem::getSize() const
 {
     LL_PROFILE_ZONE_COLOR(tracy::Color::Gold); // <FS:Beq> measure cache performance
+    if (mDecoded)
+    {
+        return (S32)mDecoded->size();
+    }
     return LLFileSystem::getFileSize(mFileID, mFileType);
 }
 
@@ -33,6 +33,8 @@
 #include "lluuid.h"
 #include "llassettype.h"
 #include "lldiskcache.h"
+#include <memory>
+#include <vector>
 
 class LLFileSystem
 {
@@ -72,12 +74,23 @@ class LLFileSystem
         static const S32 READ_WRITE;
         static const S32 APPEND;
 
+    protected:
+        // read() without the cache statistics
+        bool readFile(U8* buffer, S32 bytes);
+        // A compressed file is inflated whole on the first read(), on the
+        // reading thread; read() and seek() then work on the inflated copy.
+        bool decodeFile(LLFILE* file);
+        bool readDecoded(U8* buffer, S32 bytes);
+        // Before appending to or patching a compressed file, store it as is.
+        void expandFile(const std::string& filename);
+
     protected:
         LLAssetType::EType mFileType;
         LLUUID  mFileID;
         S32     mPosition;
         S32     mMode;
         S32     mBytesRead;
+        std::shared_ptr<std::vector<U8>> mDecoded;
 };
 
 #endif  // LL_FILESYSTEM_H
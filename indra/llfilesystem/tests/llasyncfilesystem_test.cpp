@@ -0,0 +1,168 @@
+/**
+ * @file   llasyncfilesystem_test.cpp
+ * @date   2026-10-18
+ * @brief  Test for llasyncfilesystem.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llasyncfilesystem.h"
+#include "../lldiskcache.h"
+#include "../llfilesystem.h"
+
+#include "../test/lltut.h"
+#include "../test/namedtempdir.h"
+#include <future>
+#include <thread>
+
+namespace tut
+{
+    struct llasyncfilesystem_data
+    {
+        llasyncfilesystem_data()
+        {
+            // LLDiskCache is a singleton, so every test in the group shares
+            // one cache directory, removed when the test program exits.
+            static NamedTempDir sCacheDir("llasyncfilesystem_test_");
+            if (! LLDiskCache::instanceExists())
+            {
+                LLDiskCache::initParamSingleton(sCacheDir.getName(), 64 * 1024 * 1024, false, 95.f, 70.f);
+            }
+            LLAsyncFileSystem::createInstance(3);
+        }
+
+        ~llasyncfilesystem_data()
+        {
+            LLAsyncFileSystem::deleteSingleton();
+            LLDiskCache::instance().clearCache();
+        }
+
+        static std::string pattern(S32 size, U8 seed)
+        {
+            std::string data(size, '\0');
+            for (S32 i = 0; i < size; ++i)
+            {
+                data[i] = char(seed + i * 7);
+            }
+            return data;
+        }
+
+        static void store(const LLUUID& id, const std::string& data)
+        {
+            LLFileSystem file(id, LLAssetType::AT_MESH, LLFileSystem::WRITE);
+            ensure("store", file.write((const U8*)data.data(), (S32)data.size()));
+        }
+
+        static std::string contents(const LLAsyncFileSystem::Request& request)
+        {
+            return std::string(request.mData.begin(), request.mData.end());
+        }
+    };
+    typedef test_group<llasyncfilesystem_data> llasyncfilesystem_group;
+    typedef llasyncfilesystem_group::object object;
+    llasyncfilesystem_group llasyncfilesystemgrp("llasyncfilesystem");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("batched reads with coalescing");
+        const LLUUID a(LLUUID::generateNewID("a")), b(LLUUID::generateNewID("b")),
+                     missing(LLUUID::generateNewID("missing"));
+        const std::string data_a(pattern(100000, 1)), data_b(pattern(3000, 2));
+        store(a, data_a);
+        store(b, data_b);
+
+        LLAsyncFileSystem::batch_t batch;
+        // three nearby ranges of a, one far off, in no particular order
+        batch.emplace_back(a, LLAssetType::AT_MESH, 5000, 1000);
+        batch.emplace_back(a, LLAssetType::AT_MESH, 0, 4000);
+        batch.emplace_back(b, LLAssetType::AT_MESH);
+        batch.emplace_back(a, LLAssetType::AT_MESH, 4500, 2000);
+        batch.emplace_back(a, LLAssetType::AT_MESH, 90000, 20000);
+        batch.emplace_back(missing, LLAssetType::AT_MESH, 0, 10);
+
+        std::promise<LLAsyncFileSystem::batch_t> done;
+        ensure("posted", LLAsyncFileSystem::instance().read(std::move(batch),
+            [&done](LLAsyncFileSystem::batch_t&& results) { done.set_value(std::move(results)); }));
+        auto results = done.get_future().get();
+
+        ensure_equals("count", results.size(), 6);
+        ensure_equals("a 5000", contents(results[0]), data_a.substr(5000, 1000));
+        ensure_equals("a 0", contents(results[1]), data_a.substr(0, 4000));
+        ensure_equals("b whole", contents(results[2]), data_b);
+        ensure_equals("a 4500", contents(results[3]), data_a.substr(4500, 2000));
+        ensure_equals("a clipped", results[4].mResult, 10000);
+        ensure_equals("a tail", contents(results[4]), data_a.substr(90000));
+        ensure_equals("missing", results[5].mResult, -1);
+        ensure("coalesced", LLAsyncFileSystem::instance().getCoalescedCount() >= 2);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("writes, with the reply on a WorkQueue");
+        const LLUUID a(LLUUID::generateNewID("write a")), b(LLUUID::generateNewID("write b"));
+        LLAsyncFileSystem::batch_t batch;
+        for (const LLUUID& id : { a, b })
+        {
+            LLAsyncFileSystem::Request whole(id, LLAssetType::AT_MESH);
+            whole.mMode = LLFileSystem::WRITE;
+            const std::string data(pattern(5000, 3));
+            whole.mData.assign(data.begin(), data.end());
+            batch.push_back(whole);
+            // patch the middle, after the whole write
+            LLAsyncFileSystem::Request patch(id, LLAssetType::AT_MESH, 100);
+            patch.mData.assign(10, 'z');
+            batch.push_back(patch);
+        }
+
+        auto reply = std::make_shared<LL::WorkQueue>("llasyncfilesystem reply");
+        bool called = false;
+        ensure("posted", LLAsyncFileSystem::instance().write(std::move(batch), reply->getWeak(),
+            [&called](LLAsyncFileSystem::batch_t&& results)
+            {
+                called = true;
+                for (const auto& result : results)
+                {
+                    ensure_equals("written", result.mResult, (S32)result.mData.size());
+                }
+            }));
+        for (int i = 0; i < 500 && ! called; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            reply->runPending();
+        }
+        ensure("callback ran on the reply queue", called);
+
+        std::string expected(pattern(5000, 3));
+        expected.replace(100, 10, 10, 'z');
+        for (const LLUUID& id : { a, b })
+        {
+            LLFileSystem file(id, LLAssetType::AT_MESH);
+            std::string data(file.getSize(), '\0');
+            file.read((U8*)data.data(), (S32)data.size());
+            ensure_equals("contents", data, expected);
+        }
+    }
+} // namespace tut
@@ -0,0 +1,204 @@
+/**
+ * @file   llcachecompressor_test.cpp
+ * @date   2026-10-18
+ * @brief  Test for llcachecompressor.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llcachecompressor.h"
+#include "llfile.h"
+
+#include "../test/lltut.h"
+#include "../test/namedtempdir.h"
+#include <cstring>
+
+namespace tut
+{
+    struct llcachecompressor_data
+    {
+        NamedTempDir mTempDir{ "llcachecompressor_test_" };
+        std::string mDir{ mTempDir.getName() };
+        U32 mSeed{ 1 };
+
+        U32 random()
+        {
+            mSeed = mSeed * 1664525 + 1013904223;
+            return mSeed >> 8;
+        }
+
+        // something like a packed object update: mostly the same fields,
+        // with a few that differ from one object to the next
+        std::string makeEntry()
+        {
+            static const char* names[] = { "Object", "Chair", "Wall segment", "Prim", "Tree" };
+            std::string entry;
+            for (int i = 0; i < 12; ++i)
+            {
+                const U32 value = (i % 3) ? 0x3f800000 : random();
+                entry.append((const char*)&value, sizeof(value));
+            }
+            entry += names[random() % 5];
+            entry += "\nPCode 9 Material 3 ClickAction 0 Scale <0.5, 0.5, 0.5> Flags 0x0100";
+            entry += "\nTextureEntry 89556747-24cb-43ed-920b-47caed15465f default";
+            entry.append(16 + random() % 16, (char)(random() % 4));
+            return entry;
+        }
+
+        void roundTrip(LLCacheCompressor& compressor, const std::string& entry,
+                       std::vector<U8>& compressed, U32& dictionary_id)
+        {
+            ensure("compressed", compressor.compress((const U8*)entry.data(), entry.size(), compressed, dictionary_id));
+            std::string decoded(entry.size(), '\0');
+            ensure("decompressed", compressor.decompress(compressed.data(), compressed.size(), dictionary_id,
+                                                         (U8*)&decoded[0], decoded.size()));
+            ensure("same", decoded == entry);
+        }
+    };
+    typedef test_group<llcachecompressor_data> llcachecompressor_group;
+    typedef llcachecompressor_group::object object;
+    llcachecompressor_group llcachecompressorgrp("LLCacheCompressor");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("compress and decompress without a dictionary");
+        LLCacheCompressor compressor(16 * 1024);
+        const std::string entry(std::string(4096, 'a') + "tail");
+        std::vector<U8> compressed;
+        U32 dictionary_id = 1;
+        ensure("off by default", ! compressor.compress((const U8*)entry.data(), entry.size(), compressed, dictionary_id));
+
+        compressor.setEnabled(true);
+        roundTrip(compressor, entry, compressed, dictionary_id);
+        ensure_equals("no dictionary", dictionary_id, 0);
+        ensure("smaller", compressed.size() < entry.size() / 10);
+
+        // random bytes don't shrink, so are left alone
+        std::string noise;
+        for (int i = 0; i < 4096; ++i)
+        {
+            noise += (char)random();
+        }
+        ensure("noise", ! compressor.compress((const U8*)noise.data(), noise.size(), compressed, dictionary_id));
+
+        const LLCacheCompressor::Stats stats = compressor.getStats();
+        ensure_equals("compressed count", stats.mCompressed, 1);
+        ensure_equals("stored count", stats.mStored, 1);
+        ensure_equals("decoded count", stats.mDecoded, 1);
+        ensure("ratio", stats.getRatio() > 10.f);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("frames");
+        LLCacheCompressor compressor;
+        compressor.setEnabled(true);
+        const std::string entry(std::string(1000, 'x') + std::string(1000, 'y'));
+        std::vector<U8> frame;
+        ensure("compressed", compressor.compressFrame((const U8*)entry.data(), entry.size(), frame));
+        U32 raw_size = 0;
+        ensure("frame", LLCacheCompressor::readFrameHeader(frame.data(), frame.size(), raw_size));
+        ensure_equals("raw size", raw_size, entry.size());
+        ensure("not a frame", ! LLCacheCompressor::readFrameHeader((const U8*)entry.data(), entry.size(), raw_size));
+        ensure("short", ! LLCacheCompressor::readFrameHeader(frame.data(), LLCacheCompressor::FRAME_HEADER_SIZE - 1, raw_size));
+
+        std::vector<U8> decoded;
+        ensure("decompressed", compressor.decompressFrame(frame.data(), frame.size(), decoded));
+        ensure("same", std::string(decoded.begin(), decoded.end()) == entry);
+
+        frame.resize(frame.size() / 2);
+        ensure("truncated", ! compressor.decompressFrame(frame.data(), frame.size(), decoded));
+        ensure_equals("failed", compressor.getStats().mFailed, 1);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("training a dictionary for small entries");
+        const std::string dictionary_file(mDir + "/test.dict");
+        LLCacheCompressor compressor(8 * 1024, true);
+        compressor.setDictionaryFile(dictionary_file);
+        compressor.setEnabled(true);
+
+        // entries are only sampled until there is enough to train on, which
+        // happens inline without a "General" work queue
+        std::vector<U8> compressed;
+        U32 dictionary_id = 0;
+        int entries = 0;
+        for (; ! compressor.getDictionaryID() && entries < 10000; ++entries)
+        {
+            const std::string entry(makeEntry());
+            ensure("needs a dictionary", ! compressor.compress((const U8*)entry.data(), entry.size(), compressed, dictionary_id));
+        }
+        ensure("trained", compressor.getDictionaryID() != 0);
+        ensure("saved", LLFile::isfile(dictionary_file));
+
+        size_t raw_bytes = 0, compressed_bytes = 0;
+        std::vector<std::pair<std::string, std::vector<U8>>> stored;
+        for (int i = 0; i < 100; ++i)
+        {
+            const std::string entry(makeEntry());
+            roundTrip(compressor, entry, compressed, dictionary_id);
+            ensure_equals("dictionary", dictionary_id, compressor.getDictionaryID());
+            raw_bytes += entry.size();
+            compressed_bytes += compressed.size();
+            stored.emplace_back(entry, compressed);
+        }
+        ensure("worth it", compressed_bytes * 3 < raw_bytes);
+
+        // the dictionary comes back with the file
+        LLCacheCompressor reloaded(8 * 1024, true);
+        reloaded.setDictionaryFile(dictionary_file);
+        ensure_equals("reloaded", reloaded.getDictionaryID(), dictionary_id);
+        std::string decoded(stored[0].first.size(), '\0');
+        ensure("decoded", reloaded.decompress(stored[0].second.data(), stored[0].second.size(), dictionary_id,
+                                              (U8*)&decoded[0], decoded.size()));
+        ensure("same", decoded == stored[0].first);
+
+        // and without it, entries that need it can't be read
+        reloaded.reset();
+        ensure("removed", ! LLFile::isfile(dictionary_file));
+        ensure_equals("forgotten", reloaded.getDictionaryID(), 0);
+        ensure("unknown dictionary", ! reloaded.decompress(stored[0].second.data(), stored[0].second.size(), dictionary_id,
+                                                           (U8*)&decoded[0], decoded.size()));
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("trainDictionary");
+        std::vector<std::string> samples;
+        ensure("nothing to train on", LLCacheCompressor::trainDictionary(samples, 4096, 64).empty());
+        for (int i = 0; i < 200; ++i)
+        {
+            samples.push_back(makeEntry());
+        }
+        const std::string dictionary(LLCacheCompressor::trainDictionary(samples, 4096, 64));
+        ensure("trained", ! dictionary.empty());
+        ensure("fits", dictionary.size() <= 4096);
+        ensure("common text", dictionary.find("TextureEntry") != std::string::npos);
+    }
+} // namespace tut
@@ -0,0 +1,108 @@
+/**
+ * @file   llcachestats_test.cpp
+ * @date   2026-10-18
+ * @brief  Test for llcachestats.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../llcachestats.h"
+
+#include "../test/lltut.h"
+#include <thread>
+#include <vector>
+
+namespace tut
+{
+    struct llcachestats_data
+    {
+    };
+    typedef test_group<llcachestats_data> llcachestats_group;
+    typedef llcachestats_group::object object;
+    llcachestats_group llcachestatsgrp("llcachestats");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("counts and latency buckets");
+        const LLCacheStats::Counts before = LLCacheStats::get(LLCacheStats::MESH);
+        LLCacheStats::hit(LLCacheStats::MESH);
+        LLCacheStats::hit(LLCacheStats::MESH, 2);
+        LLCacheStats::miss(LLCacheStats::MESH);
+        LLCacheStats::read(LLCacheStats::MESH, 1000, 50);      // 0.05ms
+        LLCacheStats::read(LLCacheStats::MESH, 3000, 2000);    // 2ms
+        LLCacheStats::read(LLCacheStats::MESH, 0, 1000000);    // 1s
+        LLCacheStats::wrote(LLCacheStats::MESH, 4096);
+        LLCacheStats::evicted(LLCacheStats::MESH, 5);
+        const LLCacheStats::Counts diff = LLCacheStats::get(LLCacheStats::MESH) - before;
+
+        ensure_equals("hits", diff.mHits, 3);
+        ensure_equals("misses", diff.mMisses, 1);
+        ensure_equals("hit rate", diff.getHitRate(), 0.75f);
+        ensure_equals("read", diff.mBytesRead, 4000);
+        ensure_equals("written", diff.mBytesWritten, 4096);
+        ensure_equals("evictions", diff.mEvictions, 5);
+        ensure_equals("reads", diff.mReads, 3);
+        ensure_equals("read time", diff.mReadMicros, 1002050);
+        ensure_equals("0.1ms bucket", diff.mLatency[0], 1);
+        ensure_equals("3ms bucket", diff.mLatency[3], 1);
+        ensure_equals("open bucket", diff.mLatency[LLCacheStats::NUM_LATENCY_BUCKETS - 1], 1);
+
+        const LLCacheStats::Counts other = LLCacheStats::get(LLCacheStats::ASSET) - LLCacheStats::get(LLCacheStats::ASSET);
+        ensure_equals("tiers kept apart", other.mHits, 0);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("recording from many threads");
+        const LLCacheStats::Counts before = LLCacheStats::get(LLCacheStats::OBJECT);
+        const int threads = 8, reads = 10000;
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([reads]()
+                {
+                    for (int i = 0; i < reads; ++i)
+                    {
+                        LLCacheStats::hit(LLCacheStats::OBJECT);
+                        LLCacheStats::read(LLCacheStats::OBJECT, 10, i % 1000);
+                    }
+                });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        const LLCacheStats::Counts diff = LLCacheStats::get(LLCacheStats::OBJECT) - before;
+        ensure_equals("hits", diff.mHits, threads * reads);
+        ensure_equals("read", diff.mBytesRead, 10 * threads * reads);
+        U64 bucketed = 0;
+        for (S32 i = 0; i < LLCacheStats::NUM_LATENCY_BUCKETS; ++i)
+        {
+            bucketed += diff.mLatency[i];
+        }
+        ensure_equals("bucketed", bucketed, threads * reads);
+    }
+} // namespace tut
@@ -0,0 +1,139 @@
+/**
+ * @file   lldiskcache_test.cpp
+ * @date   2026-10-18
+ * @brief  Test for the LLDiskCacheIndex.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lldir.h"
+#include "../lldiskcache.h"
+
+#include "../test/lltut.h"
+#include "../test/namedtempdir.h"
+#include "stringize.h"
+
+namespace tut
+{
+    struct lldiskcache_data
+    {
+        NamedTempDir mTempDir{ "lldiskcache_test_" };
+        std::string mDir{ mTempDir.getName() };
+
+        void writeFile(const std::string& name, size_t size)
+        {
+            LLFILE* file = LLFile::fopen(mDir + gDirUtilp->getDirDelimiter() + name, "wb");
+            ensure(name, file != NULL);
+            std::string data(size, 'x');
+            fwrite(data.data(), 1, size, file);
+            fclose(file);
+        }
+    };
+    typedef test_group<lldiskcache_data> lldiskcache_group;
+    typedef lldiskcache_group::object object;
+    lldiskcache_group lldiskcachegrp("LLDiskCacheIndex");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("LRU order and eviction");
+        LLDiskCacheIndex index(mDir, "sl_cache");
+        index.noteWrite("sl_cache_a", 100, true);
+        index.noteWrite("sl_cache_b", 200, true);
+        index.noteWrite("sl_cache_c", 300, true);
+        // an appending write can only grow a file, a truncating one sets it
+        index.noteWrite("sl_cache_c", 50, false);
+        ensure_equals("total", index.getTotalBytes(), 600);
+        index.noteWrite("sl_cache_c", 50, true);
+        ensure_equals("truncated", index.getTotalBytes(), 350);
+        // reading a makes b the oldest
+        index.noteRead("sl_cache_a");
+        index.noteRename("sl_cache_c", "sl_cache_d");
+        ensure_equals("renamed", index.size(), 3);
+
+        U32 spared = 0;
+        auto evicted = index.evict(200, {}, spared);
+        ensure_equals("evicted", evicted.size(), 1);
+        ensure_equals("oldest", evicted[0].first, "sl_cache_b");
+        ensure_equals("size", evicted[0].second, 200);
+        ensure_equals("remaining", index.getTotalBytes(), 150);
+
+        // spared entries move to the recent end instead
+        evicted = index.evict(0, [](const std::string& name) { return name == "sl_cache_a"; }, spared);
+        ensure_equals("spared", spared, 1);
+        ensure_equals("evicted the rest", evicted.size(), 1);
+        ensure_equals("evicted d", evicted[0].first, "sl_cache_d");
+        ensure_equals("a left", index.getTotalBytes(), 100);
+        index.noteRemove("sl_cache_a");
+        ensure_equals("empty", index.size(), 0);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("journal round trip");
+        {
+            LLDiskCacheIndex index(mDir, "sl_cache");
+            ensure("no journal yet", ! index.load());
+            index.rescan();
+            index.noteWrite("sl_cache_a", 10, true);
+            index.noteWrite("sl_cache_b", 20, true);
+            index.flush();
+            index.noteWrite("sl_cache_c", 30, true);
+            index.noteRemove("sl_cache_a");
+            index.close();
+        }
+        {
+            LLDiskCacheIndex index(mDir, "sl_cache");
+            ensure("clean journal loads", index.load());
+            ensure_equals("entries", index.size(), 2);
+            ensure_equals("total", index.getTotalBytes(), 50);
+            U32 spared = 0;
+            auto evicted = index.evict(30, {}, spared);
+            ensure_equals("order kept", evicted[0].first, "sl_cache_b");
+            index.flush();
+            // no close(): as if we crashed
+        }
+        LLDiskCacheIndex index(mDir, "sl_cache");
+        ensure("unclean journal is not trusted", ! index.load());
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("rescan");
+        writeFile("sl_cache_one_0.asset", 1000);
+        writeFile("sl_cache_two_0.asset", 2000);
+        writeFile("unrelated.txt", 5000);
+        LLDiskCacheIndex index(mDir, "sl_cache");
+        index.rescan();
+        ensure_equals("entries", index.size(), 2);
+        ensure_equals("total", index.getTotalBytes(), 3000);
+        index.close();
+
+        LLDiskCacheIndex reloaded(mDir, "sl_cache");
+        ensure("load", reloaded.load());
+        ensure_equals("reloaded total", reloaded.getTotalBytes(), 3000);
+    }
+} // namespace tut
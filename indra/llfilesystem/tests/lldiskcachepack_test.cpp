@@ -0,0 +1,180 @@
+/**
+ * @file   lldiskcachepack_test.cpp
+ * @date   2026-10-18
+ * @brief  Test for lldiskcachepack.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lldir.h"
+#include "../lldiskcachepack.h"
+
+#include "../test/lltut.h"
+#include "../test/namedtempdir.h"
+
+namespace tut
+{
+    struct lldiskcachepack_data
+    {
+        NamedTempDir mTempDir{ "lldiskcachepack_test_" };
+        std::string mDir{ mTempDir.getName() };
+
+        std::string readAll(LLDiskCachePack& pack, const LLUUID& id)
+        {
+            const S32 size = pack.getSize(id);
+            ensure("packed", size >= 0);
+            std::string data(size, '\0');
+            ensure_equals("read", pack.read(id, 0, (U8*)data.data(), size), size);
+            return data;
+        }
+
+        bool write(LLDiskCachePack& pack, const LLUUID& id, const std::string& data)
+        {
+            return pack.write(id, (const U8*)data.data(), (S32)data.size());
+        }
+    };
+    typedef test_group<lldiskcachepack_data> lldiskcachepack_group;
+    typedef lldiskcachepack_group::object object;
+    lldiskcachepack_group lldiskcachepackgrp("LLDiskCachePack");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("write, read, replace, remove, rename");
+        LLDiskCachePack pack(mDir);
+        pack.open();
+        const LLUUID a(LLUUID::generateNewID("a")), b(LLUUID::generateNewID("b")),
+                     c(LLUUID::generateNewID("c"));
+        ensure_equals("absent", pack.getSize(a), -1);
+        ensure_equals("read absent", pack.read(a, 0, nullptr, 0), -1);
+
+        ensure("write a", write(pack, a, "first"));
+        ensure("write b", write(pack, b, "second asset"));
+        ensure_equals("a", readAll(pack, a), "first");
+        U8 buffer[4];
+        ensure_equals("partial read", pack.read(b, 7, buffer, sizeof(buffer)), 4);
+        ensure("partial contents", ! memcmp(buffer, "asse", 4));
+        ensure_equals("read past end", pack.read(b, 20, buffer, sizeof(buffer)), 0);
+
+        ensure("replace a", write(pack, a, "replaced"));
+        ensure_equals("replaced", readAll(pack, a), "replaced");
+        ensure_equals("live", pack.getLiveBytes(), 8 + 12);
+
+        ensure("rename", pack.rename(b, c));
+        ensure_equals("renamed away", pack.getSize(b), -1);
+        ensure_equals("renamed", readAll(pack, c), "second asset");
+
+        ensure("remove", pack.remove(a));
+        ensure_not("remove again", pack.remove(a));
+        ensure_equals("size", pack.size(), 1);
+
+        std::vector<U8> taken;
+        ensure("take", pack.take(c, taken));
+        ensure_equals("taken", std::string(taken.begin(), taken.end()), "second asset");
+        ensure_equals("empty", pack.size(), 0);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("reopen, including a damaged tail");
+        const LLUUID a(LLUUID::generateNewID("a")), b(LLUUID::generateNewID("b"));
+        {
+            LLDiskCachePack pack(mDir);
+            pack.open();
+            write(pack, a, "kept");
+            write(pack, b, "dropped");
+            pack.remove(b);
+        }
+        {
+            LLDiskCachePack pack(mDir);
+            pack.open();
+            ensure_equals("a survives", readAll(pack, a), "kept");
+            ensure_equals("tombstone survives", pack.getSize(b), -1);
+        }
+
+        // a crash part way through an append leaves a partial record
+        const std::string segment = mDir + gDirUtilp->getDirDelimiter() + "asset_packs" +
+                                    gDirUtilp->getDirDelimiter() + "pack_00000001.seg";
+        LLFILE* file = LLFile::fopen(segment, "ab");
+        ensure("segment", file != nullptr);
+        fwrite("LLPK garbage", 1, 12, file);
+        fclose(file);
+        {
+            LLDiskCachePack pack(mDir);
+            pack.open();
+            ensure_equals("a after damage", readAll(pack, a), "kept");
+            ensure("append after damage", write(pack, b, "again"));
+        }
+        LLDiskCachePack pack(mDir);
+        pack.open();
+        ensure_equals("a", readAll(pack, a), "kept");
+        ensure_equals("b", readAll(pack, b), "again");
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("segments, compact and trim");
+        const std::string data(LLDiskCachePack::SEGMENT_SIZE / 8, 'x');
+        std::vector<LLUUID> ids;
+        {
+            LLDiskCachePack pack(mDir);
+            pack.open();
+            for (int i = 0; i < 20; ++i)
+            {
+                ids.push_back(LLUUID::generateNewID(std::to_string(i)));
+                ensure("write", write(pack, ids.back(), data));
+            }
+            ensure("rolled over", pack.getFileBytes() > LLDiskCachePack::SEGMENT_SIZE * 2);
+
+            // most of the first segment dies
+            for (size_t i = 0; i < 6; ++i)
+            {
+                pack.remove(ids[i]);
+            }
+            const U64 before = pack.getFileBytes();
+            pack.compact();
+            ensure("compacted", pack.getFileBytes() < before);
+            ensure_equals("kept", pack.size(), ids.size() - 6);
+            ensure_equals("moved", readAll(pack, ids[6]), data);
+        }
+
+        // full segments come back from their index
+        LLDiskCachePack pack(mDir);
+        pack.open();
+        ensure_equals("reopened", pack.size(), ids.size() - 6);
+        for (size_t i = 6; i < ids.size(); ++i)
+        {
+            ensure_equals("contents", readAll(pack, ids[i]), data);
+        }
+
+        pack.trim(LLDiskCachePack::SEGMENT_SIZE);
+        ensure("trimmed", pack.getFileBytes() <= LLDiskCachePack::SEGMENT_SIZE);
+        ensure("newest kept", pack.getSize(ids.back()) >= 0);
+        pack.clear();
+        ensure_equals("cleared", pack.size(), 0);
+        ensure_equals("no bytes", pack.getFileBytes(), 0);
+    }
+} // namespace tut
@@ -32,6 +32,8 @@
 #include "llpointer.h"
 #include "lltrace.h"
 
+#include <atomic>
+
 constexpr S32 MIN_IMAGE_MIP =  2; // 4x4, only used for expand/contract power of 2
 constexpr S32 MAX_IMAGE_MIP = 12; // 4096x4096
 
@@ -149,12 +151,27 @@ public:
     void disableOverSize() {mAllowOverSize = false; }
 
 protected:
-    // special accessor to allow direct setting of mData and mDataSize by LLImageFormatted
-    void setDataAndSize(U8 *data, S32 size);
+    // special accessor to allow direct setting of mData and mDataSize by LLImageFormatted;
+    // capacity is nonzero when data came from LLImageBufferPool::allocate()
+    void setDataAndSize(U8 *data, S32 size, S32 capacity = 0);
 
 public:
     static void generateMip(const U8 *indata, U8* mipdata, int width, int height, S32 nchannels);
 
+    // Build mip levels 1 to levels of a width x height base image in one
+    // pass, into a single buffer of getMipChainSize() bytes. Each level
+    // follows the one above it, so level n starts at
+    // getMipChainSize(width, height, nchannels, n - 1). Sides halve, rounding
+    // down, until the image is 1x1. With srgb, color channels are averaged
+    // as linear light and alpha as stored. Returns the number of levels built.
+    static S32 generateMipChain(const U8* base, U8* chain, S32 width, S32 height, S32 nchannels, S32 levels, bool srgb = false);
+    static S32 getMipChainSize(S32 width, S32 height, S32 nchannels, S32 levels);
+    // Let generateMipChain() share base images of at least min_pixels with
+    // up to helpers threads serving the named work queue. Name the queue
+    // before images are in flight; an empty name, safe at any time, keeps
+    // all the work on the calling thread from then on.
+    static void setMipWorkQueue(const std::string& name, S32 helpers, S32 min_pixels = 512 * 512);
+
     // Function for calculating the download priority for textures
     // <= 0 priority means that there's no need for more data.
     static F32 calc_download_priority(F32 virtual_size, F32 visible_area, S32 bytes_sent);
@@ -166,6 +183,8 @@ public:
 private:
     U8 *mData;
     S32 mDataSize;
+    // size of mData's LLImageBufferPool class, 0 if it is plain heap
+    S32 mDataCapacity;
 
     U16 mWidth;
     U16 mHeight;
@@ -195,6 +214,11 @@ public:
 private:
     static U32 sAllocationErrors;
     // </FS:ND>
+
+    // sMipWorkQueue is only written while sMipHelpers is 0
+    static std::string sMipWorkQueue;
+    static std::atomic<S32> sMipHelpers;
+    static std::atomic<S32> sMipParallelMinPixels;
 };
 
 using LLImageDataLock = LLImageBase::DataLock<false>;
@@ -313,9 +337,7 @@ protected:
     void copyLineScaled( const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len, S32 in_pixel_step, S32 out_pixel_step );
     void compositeRowScaled4onto3( const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len );
 
-    static U8 fastFractionalMult(U8 a, U8 b);
-
-    void setDataAndSize(U8 *data, S32 width, S32 height, S8 components) ;
+    void setDataAndSize(U8 *data, S32 width, S32 height, S8 components, S32 capacity = 0) ;
 
 public:
     static S32 sRawImageCount;
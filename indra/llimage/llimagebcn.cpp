@@ -0,0 +1,800 @@
+/**
+ * @file   llimagebcn.cpp
+ * @date   2026-10-18
+ * @brief  Block compression (BC1, BC3, BC7) of image texels.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llimagebcn.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+    // BC7 interpolation weights for 4 bit indices, out of 64
+    const S32 BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // Share of the first endpoint in each BC1 four color mode index
+    const F32 BC1_WEIGHTS[4] = { 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+
+    F32 clamp_channel(F32 value)
+    {
+        return llclamp(value, 0.f, 255.f);
+    }
+
+    // Find where the block's texels start and end along their principal axis,
+    // using the first channels (3 or 4) of each texel. With no iterations the
+    // axis is the diagonal of their bounding box.
+    void fit_axis(const U8* texels, S32 channels, S32 iterations, F32* lo, F32* hi)
+    {
+        F32 mean[4] = { 0.f, 0.f, 0.f, 0.f };
+        F32 minv[4] = { 255.f, 255.f, 255.f, 255.f };
+        F32 maxv[4] = { 0.f, 0.f, 0.f, 0.f };
+        for (S32 i = 0; i < 16; ++i)
+        {
+            for (S32 c = 0; c < channels; ++c)
+            {
+                const F32 v = texels[i * 4 + c];
+                mean[c] += v;
+                minv[c] = llmin(minv[c], v);
+                maxv[c] = llmax(maxv[c], v);
+            }
+        }
+
+        F32 cov[4][4] = {};
+        for (S32 c = 0; c < channels; ++c)
+        {
+            mean[c] /= 16.f;
+        }
+        for (S32 i = 0; i < 16; ++i)
+        {
+            F32 d[4];
+            for (S32 c = 0; c < channels; ++c)
+            {
+                d[c] = texels[i * 4 + c] - mean[c];
+            }
+            for (S32 a = 0; a < channels; ++a)
+            {
+                for (S32 b = a; b < channels; ++b)
+                {
+                    cov[a][b] += d[a] * d[b];
+                }
+            }
+        }
+        for (S32 a = 0; a < channels; ++a)
+        {
+            for (S32 b = 0; b < a; ++b)
+            {
+                cov[a][b] = cov[b][a];
+            }
+        }
+
+        F32 axis[4] = { 0.f, 0.f, 0.f, 0.f };
+        for (S32 c = 0; c < channels; ++c)
+        {
+            axis[c] = maxv[c] - minv[c];
+        }
+        for (S32 iteration = 0; iteration < iterations; ++iteration)
+        {
+            F32 next[4] = { 0.f, 0.f, 0.f, 0.f };
+            F32 norm = 0.f;
+            for (S32 a = 0; a < channels; ++a)
+            {
+                for (S32 b = 0; b < channels; ++b)
+                {
+                    next[a] += cov[a][b] * axis[b];
+                }
+                norm = llmax(norm, fabsf(next[a]));
+            }
+            if (norm < 1e-6f)
+            {
+                break;
+            }
+            for (S32 c = 0; c < channels; ++c)
+            {
+                axis[c] = next[c] / norm;
+            }
+        }
+
+        F32 length = 0.f;
+        for (S32 c = 0; c < channels; ++c)
+        {
+            length += axis[c] * axis[c];
+        }
+        if (length < 1e-12f)
+        {
+            // a flat block
+            for (S32 c = 0; c < 4; ++c)
+            {
+                lo[c] = hi[c] = c < channels ? mean[c] : 255.f;
+            }
+            return;
+        }
+        length = sqrtf(length);
+        for (S32 c = 0; c < channels; ++c)
+        {
+            axis[c] /= length;
+        }
+
+        F32 tmin = 1e9f, tmax = -1e9f;
+        for (S32 i = 0; i < 16; ++i)
+        {
+            F32 t = 0.f;
+            for (S32 c = 0; c < channels; ++c)
+            {
+                t += (texels[i * 4 + c] - mean[c]) * axis[c];
+            }
+            tmin = llmin(tmin, t);
+            tmax = llmax(tmax, t);
+        }
+        for (S32 c = 0; c < 4; ++c)
+        {
+            lo[c] = c < channels ? clamp_channel(mean[c] + tmin * axis[c]) : 255.f;
+            hi[c] = c < channels ? clamp_channel(mean[c] + tmax * axis[c]) : 255.f;
+        }
+    }
+
+    // The endpoints lo and hi whose interpolation by weights (the share of hi
+    // in each texel) best fits the texels, by least squares. False when the
+    // weights can't tell the endpoints apart.
+    bool fit_endpoints(const U8* texels, S32 channels, const F32* weights, F32* lo, F32* hi)
+    {
+        F32 aa = 0.f, ab = 0.f, bb = 0.f;
+        F32 ax[4] = { 0.f, 0.f, 0.f, 0.f };
+        F32 bx[4] = { 0.f, 0.f, 0.f, 0.f };
+        for (S32 i = 0; i < 16; ++i)
+        {
+            const F32 b = weights[i];
+            const F32 a = 1.f - b;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (S32 c = 0; c < channels; ++c)
+            {
+                ax[c] += a * texels[i * 4 + c];
+                bx[c] += b * texels[i * 4 + c];
+            }
+        }
+        const F32 det = aa * bb - ab * ab;
+        if (fabsf(det) < 1e-6f)
+        {
+            return false;
+        }
+        for (S32 c = 0; c < channels; ++c)
+        {
+            lo[c] = clamp_channel((ax[c] * bb - bx[c] * ab) / det);
+            hi[c] = clamp_channel((bx[c] * aa - ax[c] * ab) / det);
+        }
+        return true;
+    }
+
+    //------------------------------------------------------------------------
+    // BC1 color
+
+    U16 pack_565(const F32* color)
+    {
+        const S32 r = llclamp((S32)(color[0] * 31.f / 255.f + 0.5f), 0, 31);
+        const S32 g = llclamp((S32)(color[1] * 63.f / 255.f + 0.5f), 0, 63);
+        const S32 b = llclamp((S32)(color[2] * 31.f / 255.f + 0.5f), 0, 31);
+        return (U16)((r << 11) | (g << 5) | b);
+    }
+
+    void unpack_565(U16 packed, S32* color)
+    {
+        const S32 r = (packed >> 11) & 31;
+        const S32 g = (packed >> 5) & 63;
+        const S32 b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    // Four color mode palette, whichever endpoint is larger
+    void bc1_palette(U16 c0, U16 c1, S32 palette[4][3])
+    {
+        unpack_565(c0, palette[0]);
+        unpack_565(c1, palette[1]);
+        for (S32 c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+    }
+
+    // Nearest palette entry for each texel, returns the total squared error.
+    S32 bc1_indices(const U8* texels, const S32 palette[4][3], U8* indices)
+    {
+        S32 error = 0;
+        for (S32 i = 0; i < 16; ++i)
+        {
+            S32 best = 0, best_error = S32_MAX;
+            for (S32 k = 0; k < 4; ++k)
+            {
+                S32 e = 0;
+                for (S32 c = 0; c < 3; ++c)
+                {
+                    const S32 d = texels[i * 4 + c] - palette[k][c];
+                    e += d * d;
+                }
+                if (e < best_error)
+                {
+                    best = k;
+                    best_error = e;
+                }
+            }
+            indices[i] = (U8)best;
+            error += best_error;
+        }
+        return error;
+    }
+
+    // The color half of a BC1 or BC3 block, always in four color mode.
+    void encode_bc1_color(const U8* texels, U8* block, bool high)
+    {
+        F32 lo[4], hi[4];
+        fit_axis(texels, 3, high ? 8 : 2, lo, hi);
+        U16 c0 = pack_565(hi);
+        U16 c1 = pack_565(lo);
+        S32 palette[4][3];
+        U8 indices[16];
+        bc1_palette(c0, c1, palette);
+        S32 error = bc1_indices(texels, palette, indices);
+
+        for (S32 pass = 0; high && pass < 2 && error > 0; ++pass)
+        {
+            F32 weights[16];
+            for (S32 i = 0; i < 16; ++i)
+            {
+                weights[i] = BC1_WEIGHTS[indices[i]];
+            }
+            if (!fit_endpoints(texels, 3, weights, lo, hi))
+            {
+                break;
+            }
+            const U16 n0 = pack_565(hi);
+            const U16 n1 = pack_565(lo);
+            U8 new_indices[16];
+            bc1_palette(n0, n1, palette);
+            const S32 new_error = bc1_indices(texels, palette, new_indices);
+            if (new_error >= error)
+            {
+                break;
+            }
+            c0 = n0;
+            c1 = n1;
+            error = new_error;
+            memcpy(indices, new_indices, sizeof(indices));
+        }
+
+        if (c0 < c1)
+        {
+            // four color mode needs c0 > c1: swapping them swaps 0 with 1 and 2 with 3
+            std::swap(c0, c1);
+            for (S32 i = 0; i < 16; ++i)
+            {
+                indices[i] ^= 1;
+            }
+        }
+        else if (c0 == c1)
+        {
+            // would read as three color mode, where index 3 is transparent
+            memset(indices, 0, sizeof(indices));
+        }
+
+        U32 bits = 0;
+        for (S32 i = 0; i < 16; ++i)
+        {
+            bits |= (U32)indices[i] << (2 * i);
+        }
+        block[0] = (U8)c0;
+        block[1] = (U8)(c0 >> 8);
+        block[2] = (U8)c1;
+        block[3] = (U8)(c1 >> 8);
+        for (S32 i = 0; i < 4; ++i)
+        {
+            block[4 + i] = (U8)(bits >> (8 * i));
+        }
+    }
+
+    // BC3 color blocks are read in four color mode whatever their endpoints.
+    void decode_bc1_color(const U8* block, U8* texels, bool four_color)
+    {
+        const U16 c0 = (U16)(block[0] | (block[1] << 8));
+        const U16 c1 = (U16)(block[2] | (block[3] << 8));
+        S32 palette[4][4];
+        unpack_565(c0, palette[0]);
+        unpack_565(c1, palette[1]);
+        palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+        for (S32 c = 0; c < 3; ++c)
+        {
+            if (four_color || c0 > c1)
+            {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            else
+            {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+        if (!four_color && c0 <= c1)
+        {
+            palette[3][3] = 0;
+        }
+
+        const U32 bits = block[4] | (block[5] << 8) | (block[6] << 16) | ((U32)block[7] << 24);
+        for (S32 i = 0; i < 16; ++i)
+        {
+            const S32* color = palette[(bits >> (2 * i)) & 3];
+            for (S32 c = 0; c < 4; ++c)
+            {
+                texels[i * 4 + c] = (U8)color[c];
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // BC3 alpha
+
+    void bc3_alpha_palette(S32 a0, S32 a1, S32* palette)
+    {
+        palette[0] = a0;
+        palette[1] = a1;
+        if (a0 > a1)
+        {
+            for (S32 i = 1; i < 7; ++i)
+            {
+                palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+            }
+        }
+        else
+        {
+            for (S32 i = 1; i < 5; ++i)
+            {
+                palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    void encode_bc3_alpha(const U8* texels, U8* block)
+    {
+        S32 amin = 255, amax = 0;
+        for (S32 i = 0; i < 16; ++i)
+        {
+            amin = llmin(amin, (S32)texels[i * 4 + 3]);
+            amax = llmax(amax, (S32)texels[i * 4 + 3]);
+        }
+        block[0] = (U8)amax;
+        block[1] = (U8)amin;
+        memset(block + 2, 0, 6);
+        if (amax == amin)
+        {
+            // every index 0
+            return;
+        }
+
+        S32 palette[8];
+        bc3_alpha_palette(amax, amin, palette);
+        U64 bits = 0;
+        for (S32 i = 0; i < 16; ++i)
+        {
+            S32 best = 0, best_error = S32_MAX;
+            for (S32 k = 0; k < 8; ++k)
+            {
+                const S32 e = abs(texels[i * 4 + 3] - palette[k]);
+                if (e < best_error)
+                {
+                    best = k;
+                    best_error = e;
+                }
+            }
+            bits |= (U64)best << (3 * i);
+        }
+        for (S32 i = 0; i < 6; ++i)
+        {
+            block[2 + i] = (U8)(bits >> (8 * i));
+        }
+    }
+
+    void decode_bc3_alpha(const U8* block, U8* texels)
+    {
+        S32 palette[8];
+        bc3_alpha_palette(block[0], block[1], palette);
+        U64 bits = 0;
+        for (S32 i = 0; i < 6; ++i)
+        {
+            bits |= (U64)block[2 + i] << (8 * i);
+        }
+        for (S32 i = 0; i < 16; ++i)
+        {
+            texels[i * 4 + 3] = (U8)palette[(bits >> (3 * i)) & 7];
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // BC7, mode 6
+
+    // Reads and writes a block's fields, least significant bit first.
+    struct BlockBits
+    {
+        U8* mBlock;
+        S32 mPos;
+
+        void put(U32 value, S32 count)
+        {
+            for (S32 i = 0; i < count; ++i, ++mPos)
+            {
+                if ((value >> i) & 1)
+                {
+                    mBlock[mPos >> 3] |= (U8)(1 << (mPos & 7));
+                }
+            }
+        }
+
+        U32 get(S32 count)
+        {
+            U32 value = 0;
+            for (S32 i = 0; i < count; ++i, ++mPos)
+            {
+                value |= (U32)((mBlock[mPos >> 3] >> (mPos & 7)) & 1) << i;
+            }
+            return value;
+        }
+    };
+
+    void bc7_palette(const U8 endpoints[2][4], S32 palette[16][4])
+    {
+        for (S32 k = 0; k < 16; ++k)
+        {
+            for (S32 c = 0; c < 4; ++c)
+            {
+                palette[k][c] = ((64 - BC7_WEIGHTS[k]) * endpoints[0][c] + BC7_WEIGHTS[k] * endpoints[1][c] + 32) >> 6;
+            }
+        }
+    }
+
+    S32 texel_error(const U8* texel, const S32* color)
+    {
+        S32 e = 0;
+        for (S32 c = 0; c < 4; ++c)
+        {
+            const S32 d = texel[c] - color[c];
+            e += d * d;
+        }
+        return e;
+    }
+
+    // 7 bits per channel plus a low bit shared by the whole endpoint
+    void bc7_quantize_endpoint(const F32* color, S32 pbit, U8* endpoint)
+    {
+        for (S32 c = 0; c < 4; ++c)
+        {
+            const S32 q = llclamp((S32)((color[c] - pbit) * 0.5f + 0.5f), 0, 127);
+            endpoint[c] = (U8)((q << 1) | pbit);
+        }
+    }
+
+    S32 bc7_endpoint_error(const F32* color, const U8* endpoint)
+    {
+        F32 e = 0.f;
+        for (S32 c = 0; c < 4; ++c)
+        {
+            const F32 d = color[c] - endpoint[c];
+            e += d * d;
+        }
+        return (S32)e;
+    }
+
+    // Indices for endpoints, returns the total squared error. Exhaustive
+    // searches the whole palette; otherwise texels are projected onto the
+    // line between the endpoints.
+    S32 bc7_indices(const U8* texels, const U8 endpoints[2][4], bool exhaustive, U8* indices)
+    {
+        S32 palette[16][4];
+        bc7_palette(endpoints, palette);
+
+        S32 dir[4];
+        S32 dir_length = 0;
+        for (S32 c = 0; c < 4; ++c)
+        {
+            dir[c] = endpoints[1][c] - endpoints[0][c];
+            dir_length += dir[c] * dir[c];
+        }
+
+        S32 error = 0;
+        for (S32 i = 0; i < 16; ++i)
+        {
+            const U8* texel = texels + i * 4;
+            S32 best = 0;
+            S32 best_error = S32_MAX;
+            if (exhaustive || dir_length == 0)
+            {
+                for (S32 k = 0; k < 16; ++k)
+                {
+                    const S32 e = texel_error(texel, palette[k]);
+                    if (e < best_error)
+                    {
+                        best = k;
+                        best_error = e;
+                    }
+                }
+            }
+            else
+            {
+                S32 dot = 0;
+                for (S32 c = 0; c < 4; ++c)
+                {
+                    dot += (texel[c] - endpoints[0][c]) * dir[c];
+                }
+                best = llclamp((S32)((F32)dot * 15.f / (F32)dir_length + 0.5f), 0, 15);
+                best_error = texel_error(texel, palette[best]);
+            }
+            indices[i] = (U8)best;
+            error += best_error;
+        }
+        return error;
+    }
+
+    // Quantize lo and hi to mode 6 endpoints and pick indices for them,
+    // returns the total squared error.
+    S32 bc7_quantize(const U8* texels, const F32* lo, const F32* hi, bool high,
+                     U8 endpoints[2][4], U8* indices)
+    {
+        if (!high)
+        {
+            // each endpoint takes the low bit that suits it best
+            for (S32 e = 0; e < 2; ++e)
+            {
+                const F32* color = e ? hi : lo;
+                U8 even[4], odd[4];
+                bc7_quantize_endpoint(color, 0, even);
+                bc7_quantize_endpoint(color, 1, odd);
+                memcpy(endpoints[e], bc7_endpoint_error(color, even) <= bc7_endpoint_error(color, odd) ? even : odd, 4);
+            }
+            return bc7_indices(texels, endpoints, false, indices);
+        }
+
+        // try every pair of low bits against the block itself
+        S32 best_error = S32_MAX;
+        for (S32 pbits = 0; pbits < 4; ++pbits)
+        {
+            U8 candidate[2][4];
+            bc7_quantize_endpoint(lo, pbits & 1, candidate[0]);
+            bc7_quantize_endpoint(hi, pbits >> 1, candidate[1]);
+            const S32 error = bc7_indices(texels, candidate, false, indices);
+            if (error < best_error)
+            {
+                best_error = error;
+                memcpy(endpoints, candidate, sizeof(candidate));
+            }
+        }
+        return bc7_indices(texels, endpoints, false, indices);
+    }
+
+    void encode_bc7(const U8* texels, U8* block, bool high)
+    {
+        F32 lo[4], hi[4];
+        fit_axis(texels, 4, high ? 8 : 2, lo, hi);
+        U8 endpoints[2][4];
+        U8 indices[16];
+        S32 error = bc7_quantize(texels, lo, hi, high, endpoints, indices);
+
+        for (S32 pass = 0; high && pass < 2 && error > 0; ++pass)
+        {
+            F32 weights[16];
+            for (S32 i = 0; i < 16; ++i)
+            {
+                weights[i] = BC7_WEIGHTS[indices[i]] / 64.f;
+            }
+            if (!fit_endpoints(texels, 4, weights, lo, hi))
+            {
+                break;
+            }
+            U8 new_endpoints[2][4];
+            U8 new_indices[16];
+            const S32 new_error = bc7_quantize(texels, lo, hi, high, new_endpoints, new_indices);
+            if (new_error >= error)
+            {
+                break;
+            }
+            error = new_error;
+            memcpy(endpoints, new_endpoints, sizeof(endpoints));
+            memcpy(indices, new_indices, sizeof(indices));
+        }
+        if (high)
+        {
+            bc7_indices(texels, endpoints, true, indices);
+        }
+
+        if (indices[0] & 8)
+        {
+            // the first index is stored without its top bit
+            for (S32 c = 0; c < 4; ++c)
+            {
+                std::swap(endpoints[0][c], endpoints[1][c]);
+            }
+            for (S32 i = 0; i < 16; ++i)
+            {
+                indices[i] = (U8)(15 - indices[i]);
+            }
+        }
+
+        memset(block, 0, 16);
+        BlockBits bits = { block, 0 };
+        bits.put(1 << 6, 7); // mode 6
+        for (S32 c = 0; c < 4; ++c)
+        {
+            bits.put(endpoints[0][c] >> 1, 7);
+            bits.put(endpoints[1][c] >> 1, 7);
+        }
+        bits.put(endpoints[0][0] & 1, 1);
+        bits.put(endpoints[1][0] & 1, 1);
+        bits.put(indices[0], 3);
+        for (S32 i = 1; i < 16; ++i)
+        {
+            bits.put(indices[i], 4);
+        }
+    }
+
+    void decode_bc7(const U8* block, U8* texels)
+    {
+        BlockBits bits = { const_cast<U8*>(block), 0 };
+        if (bits.get(7) != (1 << 6))
+        {
+            // not a mode this encoder writes: transparent black, like an invalid block
+            memset(texels, 0, 64);
+            return;
+        }
+        U8 endpoints[2][4];
+        for (S32 c = 0; c < 4; ++c)
+        {
+            endpoints[0][c] = (U8)(bits.get(7) << 1);
+            endpoints[1][c] = (U8)(bits.get(7) << 1);
+        }
+        const U8 p0 = (U8)bits.get(1);
+        const U8 p1 = (U8)bits.get(1);
+        for (S32 c = 0; c < 4; ++c)
+        {
+            endpoints[0][c] |= p0;
+            endpoints[1][c] |= p1;
+        }
+        S32 palette[16][4];
+        bc7_palette(endpoints, palette);
+        for (S32 i = 0; i < 16; ++i)
+        {
+            const S32* color = palette[bits.get(i ? 4 : 3)];
+            for (S32 c = 0; c < 4; ++c)
+            {
+                texels[i * 4 + c] = (U8)color[c];
+            }
+        }
+    }
+}
+
+//static
+S32 LLImageBCn::getImageBytes(EFormat format, S32 width, S32 height)
+{
+    return ((width + 3) / 4) * ((height + 3) / 4) * getBlockBytes(format);
+}
+
+//static
+void LLImageBCn::encodeBlock(EFormat format, const U8* texels, U8* block, EQuality quality)
+{
+    const bool high = quality == HIGH;
+    switch (format)
+    {
+      case BC1:
+        encode_bc1_color(texels, block, high);
+        break;
+      case BC3:
+        encode_bc3_alpha(texels, block);
+        encode_bc1_color(texels, block + 8, high);
+        break;
+      case BC7:
+        encode_bc7(texels, block, high);
+        break;
+    }
+}
+
+//static
+void LLImageBCn::decodeBlock(EFormat format, const U8* block, U8* texels)
+{
+    switch (format)
+    {
+      case BC1:
+        decode_bc1_color(block, texels, false);
+        break;
+      case BC3:
+        decode_bc1_color(block + 8, texels, true);
+        decode_bc3_alpha(block, texels);
+        break;
+      case BC7:
+        decode_bc7(block, texels);
+        break;
+    }
+}
+
+//static
+void LLImageBCn::encodeImage(EFormat format, const U8* data, S32 width, S32 height, S32 ncomponents,
+                             U8* blocks, EQuality quality)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    llassert(ncomponents == 3 || ncomponents == 4);
+    const S32 block_bytes = getBlockBytes(format);
+    U8 texels[64];
+    for (S32 by = 0; by < height; by += 4)
+    {
+        for (S32 bx = 0; bx < width; bx += 4)
+        {
+            for (S32 y = 0; y < 4; ++y)
+            {
+                const S32 sy = llmin(by + y, height - 1);
+                for (S32 x = 0; x < 4; ++x)
+                {
+                    const S32 sx = llmin(bx + x, width - 1);
+                    const U8* src = data + (sy * width + sx) * ncomponents;
+                    U8* dst = texels + (y * 4 + x) * 4;
+                    dst[0] = src[0];
+                    dst[1] = src[1];
+                    dst[2] = src[2];
+                    dst[3] = ncomponents == 4 ? src[3] : 255;
+                }
+            }
+            encodeBlock(format, texels, blocks, quality);
+            blocks += block_bytes;
+        }
+    }
+}
+
+//static
+void LLImageBCn::decodeImage(EFormat format, const U8* blocks, S32 width, S32 height, S32 ncomponents,
+                             U8* data)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    llassert(ncomponents == 3 || ncomponents == 4);
+    const S32 block_bytes = getBlockBytes(format);
+    U8 texels[64];
+    for (S32 by = 0; by < height; by += 4)
+    {
+        for (S32 bx = 0; bx < width; bx += 4)
+        {
+            decodeBlock(format, blocks, texels);
+            blocks += block_bytes;
+            for (S32 y = 0; y < 4 && by + y < height; ++y)
+            {
+                for (S32 x = 0; x < 4 && bx + x < width; ++x)
+                {
+                    memcpy(data + ((by + y) * width + bx + x) * ncomponents, texels + (y * 4 + x) * 4, ncomponents);
+                }
+            }
+        }
+    }
+}
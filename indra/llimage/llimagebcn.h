@@ -0,0 +1,81 @@
+/**
+ * @file   llimagebcn.h
+ * @date   2026-10-18
+ * @brief  Block compression (BC1, BC3, BC7) of image texels.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLIMAGEBCN_H
+#define LL_LLIMAGEBCN_H
+
+#include "stdtypes.h"
+
+/**
+ * LLImageBCn compresses 4x4 blocks of texels to the formats GPUs sample
+ * directly, and expands them again: BC1 (DXT1, opaque RGB in 8 bytes),
+ * BC3 (DXT5, BC1 color plus 8 bytes of alpha) and BC7 (BPTC, RGBA in 16
+ * bytes with far less banding than BC3).
+ *
+ * The encoders are meant to keep up with texture decoding, not to compete
+ * with offline compressors. Endpoints come from the principal axis of the
+ * block's colors; HIGH quality searches that axis harder, refits the
+ * endpoints to the chosen indices by least squares and picks every index by
+ * exhaustive search. BC7 is written in mode 6 only (one subset, 7 bit RGBA
+ * endpoints with a shared low bit, 4 bit indices), and decodeBlock() only
+ * reads BC7 blocks in that mode.
+ */
+class LLImageBCn
+{
+public:
+    enum EFormat
+    {
+        BC1,
+        BC3,
+        BC7,
+    };
+
+    enum EQuality
+    {
+        FAST,
+        HIGH,
+    };
+
+    static S32 getBlockBytes(EFormat format) { return format == BC1 ? 8 : 16; }
+    // Bytes for a width x height image, in whole blocks.
+    static S32 getImageBytes(EFormat format, S32 width, S32 height);
+
+    // texels are 16 RGBA texels, row by row.
+    static void encodeBlock(EFormat format, const U8* texels, U8* block, EQuality quality);
+    static void decodeBlock(EFormat format, const U8* block, U8* texels);
+
+    // Compress a width x height image with 3 or 4 components into
+    // getImageBytes() of blocks, row by row. Blocks overhanging the image
+    // repeat its edge texels; a 3 component image is opaque.
+    static void encodeImage(EFormat format, const U8* data, S32 width, S32 height, S32 ncomponents,
+                            U8* blocks, EQuality quality);
+    // Expand blocks back to a width x height image of 3 or 4 components.
+    static void decodeImage(EFormat format, const U8* blocks, S32 width, S32 height, S32 ncomponents,
+                            U8* data);
+};
+
+#endif // LL_LLIMAGEBCN_H
@@ -0,0 +1,300 @@
+/**
+ * @file   llimagebufferpool.cpp
+ * @date   2026-10-18
+ * @brief  Size-class pool recycling LLImageBase data buffers.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llimagebufferpool.h"
+
+#include "llmemory.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    // Size classes run four to each power of two: (2^n, 2^(n+1)] splits at
+    // 1.25, 1.5, 1.75 and 2 times 2^n. MIN_POOLED_SIZE falls in the octave
+    // above 2^11 and MAX_POOLED_SIZE in the one above 2^25.
+    const S32 CLASSES_PER_OCTAVE = 4;
+    const S32 MIN_OCTAVE = 11;
+    const S32 MAX_OCTAVE = 25;
+    const S32 NUM_CLASSES = (MAX_OCTAVE - MIN_OCTAVE + 1) * CLASSES_PER_OCTAVE;
+
+    // free lists per shard; each thread sticks to one shard
+    const S32 NUM_SHARDS = 8;
+
+    // class serving size bytes, or -1 if size bypasses the pool
+    S32 class_index(S32 size)
+    {
+        if (size < LLImageBufferPool::MIN_POOLED_SIZE || size > LLImageBufferPool::MAX_POOLED_SIZE)
+        {
+            return -1;
+        }
+        S32 octave = 0;
+        for (U32 bits = (U32)(size - 1) >> 1; bits; bits >>= 1)
+        {
+            ++octave;
+        }
+        const S32 base = 1 << octave;
+        const S32 quarter = base / CLASSES_PER_OCTAVE;
+        const S32 step = (size - base + quarter - 1) / quarter;
+        return (octave - MIN_OCTAVE) * CLASSES_PER_OCTAVE + step - 1;
+    }
+
+    S32 class_capacity(S32 index)
+    {
+        const S32 base = 1 << (MIN_OCTAVE + index / CLASSES_PER_OCTAVE);
+        return base + (index % CLASSES_PER_OCTAVE + 1) * (base / CLASSES_PER_OCTAVE);
+    }
+
+    class BufferPool
+    {
+    public:
+        static BufferPool& instance()
+        {
+            static BufferPool* sInstance = new BufferPool;
+            return *sInstance;
+        }
+
+        U8* allocate(S32 size, S32& capacity)
+        {
+            const S32 index = class_index(size);
+            if (index < 0 || ! mLimit.load())
+            {
+                capacity = 0;
+                return (U8*)ll_aligned_malloc_16(size);
+            }
+            capacity = class_capacity(index);
+            U8* data = take(index, capacity);
+            if (data)
+            {
+                ++mReused;
+            }
+            else
+            {
+                data = (U8*)ll_aligned_malloc_16(capacity);
+                if (! data && mPooledBytes.load())
+                {
+                    // idle buffers are the first thing to go when the heap
+                    // is exhausted
+                    trim(0);
+                    data = (U8*)ll_aligned_malloc_16(capacity);
+                }
+                if (! data)
+                {
+                    capacity = 0;
+                    return NULL;
+                }
+                ++mAllocated;
+            }
+            ++mLive;
+            const size_t total = (mLiveBytes += capacity) + mPooledBytes.load();
+            size_t peak = mPeakBytes.load();
+            while (total > peak && ! mPeakBytes.compare_exchange_weak(peak, total))
+            {
+            }
+            return data;
+        }
+
+        void release(U8* data, S32 capacity)
+        {
+            if (! data)
+            {
+                return;
+            }
+            const S32 index = class_index(capacity);
+            if (index < 0 || class_capacity(index) != capacity)
+            {
+                ll_aligned_free_16(data);
+                return;
+            }
+            --mLive;
+            mLiveBytes -= capacity;
+
+            // reserve room under the limit before publishing the buffer, so
+            // that concurrent releases cannot overshoot it together
+            size_t pooled = mPooledBytes.load();
+            do
+            {
+                if (pooled + capacity > mLimit.load())
+                {
+                    ll_aligned_free_16(data);
+                    return;
+                }
+            } while (! mPooledBytes.compare_exchange_weak(pooled, pooled + capacity));
+
+            Shard& shard = mShards[getShard()];
+            std::lock_guard<std::mutex> lock(shard.mMutex);
+            shard.mFree[index].push_back(data);
+            ++mPooled;
+        }
+
+        void setLimit(size_t bytes)
+        {
+            mLimit = bytes;
+            trim(bytes);
+        }
+
+        size_t getLimit() const
+        {
+            return mLimit.load();
+        }
+
+        // release idle buffers, largest classes first, until no more than
+        // keep bytes remain
+        void trim(size_t keep)
+        {
+            std::vector<U8*> freed;
+            for (S32 index = NUM_CLASSES - 1; index >= 0 && mPooledBytes.load() > keep; --index)
+            {
+                const S32 capacity = class_capacity(index);
+                for (Shard& shard : mShards)
+                {
+                    std::lock_guard<std::mutex> lock(shard.mMutex);
+                    std::vector<U8*>& free_list = shard.mFree[index];
+                    while (! free_list.empty() && mPooledBytes.load() > keep)
+                    {
+                        freed.push_back(free_list.back());
+                        free_list.pop_back();
+                        --mPooled;
+                        mPooledBytes -= capacity;
+                        mTrimmedBytes += capacity;
+                    }
+                }
+            }
+            for (U8* data : freed)
+            {
+                ll_aligned_free_16(data);
+            }
+        }
+
+        LLImageBufferPool::Stats getStats() const
+        {
+            LLImageBufferPool::Stats stats;
+            stats.mLive = mLive.load();
+            stats.mLiveBytes = mLiveBytes.load();
+            stats.mPooled = mPooled.load();
+            stats.mPooledBytes = mPooledBytes.load();
+            stats.mPeakBytes = mPeakBytes.load();
+            stats.mReused = mReused.load();
+            stats.mAllocated = mAllocated.load();
+            stats.mTrimmedBytes = mTrimmedBytes.load();
+            return stats;
+        }
+
+    private:
+        struct Shard
+        {
+            std::mutex mMutex;
+            std::vector<U8*> mFree[NUM_CLASSES];
+        };
+
+        static S32 getShard()
+        {
+            static std::atomic<U32> sNextShard{ 0 };
+            static thread_local S32 sShard = (S32)(sNextShard++ % NUM_SHARDS);
+            return sShard;
+        }
+
+        // pop an idle buffer of class index, trying this thread's shard
+        // before the others
+        U8* take(S32 index, S32 capacity)
+        {
+            const S32 first = getShard();
+            for (S32 i = 0; i < NUM_SHARDS; ++i)
+            {
+                Shard& shard = mShards[(first + i) % NUM_SHARDS];
+                std::lock_guard<std::mutex> lock(shard.mMutex);
+                std::vector<U8*>& free_list = shard.mFree[index];
+                if (! free_list.empty())
+                {
+                    U8* data = free_list.back();
+                    free_list.pop_back();
+                    --mPooled;
+                    mPooledBytes -= capacity;
+                    return data;
+                }
+            }
+            return NULL;
+        }
+
+        Shard mShards[NUM_SHARDS];
+        std::atomic<size_t> mLimit{ LLImageBufferPool::DEFAULT_LIMIT };
+        std::atomic<size_t> mLive{ 0 };
+        std::atomic<size_t> mLiveBytes{ 0 };
+        std::atomic<size_t> mPooled{ 0 };
+        std::atomic<size_t> mPooledBytes{ 0 };
+        std::atomic<size_t> mPeakBytes{ 0 };
+        std::atomic<U64> mReused{ 0 };
+        std::atomic<U64> mAllocated{ 0 };
+        std::atomic<U64> mTrimmedBytes{ 0 };
+    };
+} // anonymous namespace
+
+//static
+U8* LLImageBufferPool::allocate(S32 size, S32& capacity)
+{
+    return BufferPool::instance().allocate(size, capacity);
+}
+
+//static
+void LLImageBufferPool::release(U8* data, S32 capacity)
+{
+    BufferPool::instance().release(data, capacity);
+}
+
+//static
+S32 LLImageBufferPool::getCapacity(S32 size)
+{
+    const S32 index = class_index(size);
+    return index < 0 ? 0 : class_capacity(index);
+}
+
+//static
+void LLImageBufferPool::setLimit(size_t bytes)
+{
+    BufferPool::instance().setLimit(bytes);
+}
+
+//static
+size_t LLImageBufferPool::getLimit()
+{
+    return BufferPool::instance().getLimit();
+}
+
+//static
+void LLImageBufferPool::trim(size_t keep)
+{
+    BufferPool::instance().trim(keep);
+}
+
+//static
+LLImageBufferPool::Stats LLImageBufferPool::getStats()
+{
+    return BufferPool::instance().getStats();
+}
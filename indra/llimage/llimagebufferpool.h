@@ -0,0 +1,101 @@
+/**
+ * @file   llimagebufferpool.h
+ * @date   2026-10-18
+ * @brief  Size-class pool recycling LLImageBase data buffers.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLIMAGEBUFFERPOOL_H
+#define LL_LLIMAGEBUFFERPOOL_H
+
+#include "stdtypes.h"
+
+/**
+ * LLImageBufferPool recycles the data buffers of LLImageRaw and
+ * LLImageFormatted. Image sizes repeat constantly (power-of-two squares
+ * times 3 or 4 components), so a released buffer is kept on a free list for
+ * its size class and handed to the next image needing that class instead of
+ * going back to the heap.
+ *
+ * Sizes round up to one of four classes per power of two, so raw images fit
+ * their class exactly and other sizes waste at most a quarter. Sizes below
+ * MIN_POOLED_SIZE or above MAX_POOLED_SIZE bypass the pool, as does
+ * everything while the limit is 0. Buffers are ordinary
+ * ll_aligned_malloc_16() allocations, so one that is not given back may
+ * still be freed with ll_aligned_free_16().
+ *
+ * The free lists are split into shards, each with its own lock, and every
+ * thread releases into and allocates from its own shard first, so decode
+ * threads rarely contend. A thread finding its shard empty takes from the
+ * others before allocating. At most setLimit() bytes are kept idle across
+ * all shards; trim() gives idle buffers back to the heap, e.g. when system
+ * memory runs low.
+ *
+ * The pool is shared by every thread and never destroyed, since images may
+ * still be released during static destruction.
+ */
+class LLImageBufferPool
+{
+public:
+    static constexpr S32 MIN_POOLED_SIZE = 4096;
+    static constexpr S32 MAX_POOLED_SIZE = 64 * 1024 * 1024;
+    static constexpr size_t DEFAULT_LIMIT = 128 * 1024 * 1024;
+
+    // Returns a 16 byte aligned buffer of at least size bytes, or NULL. If it
+    // came from the pool, capacity is set to its true size, to be passed back
+    // to release(); otherwise capacity is 0 and the buffer is plain heap.
+    static U8* allocate(S32 size, S32& capacity);
+    // Takes back a buffer from allocate(), keeping it for reuse when there
+    // is room under the limit. With capacity 0 the buffer is simply freed.
+    static void release(U8* data, S32 capacity);
+
+    // size of the class serving size bytes, or 0 if it bypasses the pool
+    static S32 getCapacity(S32 size);
+
+    /// cap on bytes of idle buffers kept for reuse (0 disables pooling)
+    static void setLimit(size_t bytes);
+    static size_t getLimit();
+    /// release idle buffers until no more than keep bytes remain
+    static void trim(size_t keep = 0);
+
+    struct Stats
+    {
+        // buffers currently owned by an LLImageBase, and their capacity
+        size_t mLive{ 0 };
+        size_t mLiveBytes{ 0 };
+        // released buffers waiting on the free lists, summed over all shards
+        size_t mPooled{ 0 };
+        size_t mPooledBytes{ 0 };
+        // high-water mark of live plus free-list bytes, to size the limit
+        size_t mPeakBytes{ 0 };
+        // allocate() calls that found a free buffer of the right size class,
+        // and those that had to go to ll_aligned_malloc_16()
+        U64 mReused{ 0 };
+        U64 mAllocated{ 0 };
+        // free-list bytes handed back to the heap by trim() or setLimit()
+        U64 mTrimmedBytes{ 0 };
+    };
+    static Stats getStats();
+};
+
+#endif /* ! defined(LL_LLIMAGEBUFFERPOOL_H) */
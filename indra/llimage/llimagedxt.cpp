@@ -26,12 +26,31 @@
 #include "linden_common.h"
 
 #include "llimagedxt.h"
+#include "llfile.h"
 #include "llmemory.h"
 
+#include <memory>
+#include <new>
+
+namespace
+{
+    // The LLImageBCn format holding the blocks of a DXR format, if it has one
+    bool block_format(LLImageDXT::EFileFormat format, LLImageBCn::EFormat& bcn_format)
+    {
+        switch (format)
+        {
+          case LLImageDXT::FORMAT_DXR1: bcn_format = LLImageBCn::BC1; return true;
+          case LLImageDXT::FORMAT_DXR5: bcn_format = LLImageBCn::BC3; return true;
+          case LLImageDXT::FORMAT_DXR7: bcn_format = LLImageBCn::BC7; return true;
+          default:                      return false;
+        }
+    }
+}
+
 //static
 void LLImageDXT::checkMinWidthHeight(EFileFormat format, S32& width, S32& height)
 {
-    S32 mindim = (format >= FORMAT_DXT1 && format <= FORMAT_DXR5) ? 4 : 1;
+    S32 mindim = (format >= FORMAT_DXT1 && format <= FORMAT_DXR7) ? 4 : 1;
     width = llmax(width, mindim);
     height = llmax(height, mindim);
 }
@@ -49,6 +68,7 @@ S32 LLImageDXT::formatBits(EFileFormat format)
       case FORMAT_DXR3:     return 8;
       case FORMAT_DXR5:     return 8;
       case FORMAT_DXT5:     return 8;
+      case FORMAT_DXR7:     return 8;
       case FORMAT_RGB8:     return 24;
       case FORMAT_RGBA8:    return 32;
       default:
@@ -79,6 +99,7 @@ S32 LLImageDXT::formatComponents(EFileFormat format)
       case FORMAT_DXR3:     return 4;
       case FORMAT_DXT5:     return 4;
       case FORMAT_DXR5:     return 4;
+      case FORMAT_DXR7:     return 4;
       case FORMAT_RGB8:     return 3;
       case FORMAT_RGBA8:    return 4;
       default:
@@ -101,6 +122,7 @@ LLImageDXT::EFileFormat LLImageDXT::getFormat(S32 fourcc)
         case 0x33525844: return FORMAT_DXR3;
         case 0x34525844: return FORMAT_DXR4;
         case 0x35525844: return FORMAT_DXR5;
+        case 0x37525844: return FORMAT_DXR7;
         case 0x31545844: return FORMAT_DXT1;
         case 0x32545844: return FORMAT_DXT2;
         case 0x33545844: return FORMAT_DXT3;
@@ -124,6 +146,7 @@ S32 LLImageDXT::getFourCC(EFileFormat format)
         case FORMAT_DXR3: return 0x33525844;
         case FORMAT_DXR4: return 0x34525844;
         case FORMAT_DXR5: return 0x35525844;
+        case FORMAT_DXR7: return 0x37525844;
         case FORMAT_DXT1: return 0x31545844;
         case FORMAT_DXT2: return 0x32545844;
         case FORMAT_DXT3: return 0x33545844;
@@ -187,6 +210,12 @@ bool LLImageDXT::updateData()
         return false;
     }
 
+    if (data_size < (S32)sizeof(dxtfile_header_old_t))
+    {
+        setLastError("LLImageDXT: not enough data");
+        return false;
+    }
+
     S32 width, height, miplevelmax;
     dxtfile_header_t* header = (dxtfile_header_t*)data;
     if (header->fourcc != 0x20534444)
@@ -209,7 +238,29 @@ bool LLImageDXT::updateData()
 
     if (data_size < mHeaderSize)
     {
-        LL_ERRS() << "LLImageDXT: not enough data" << LL_ENDL;
+        setLastError("LLImageDXT: not enough data");
+        return false;
+    }
+    // only formats getMipOffset() can find the mips of
+    switch (mFileFormat)
+    {
+      case FORMAT_I8:
+      case FORMAT_A8:
+      case FORMAT_RGB8:
+      case FORMAT_RGBA8:
+      case FORMAT_DXR1:
+      case FORMAT_DXR3:
+      case FORMAT_DXR5:
+      case FORMAT_DXR7:
+        break;
+      default:
+        setLastError("LLImageDXT: unsupported format");
+        return false;
+    }
+    if (width <= 0 || height <= 0 || width > MAX_IMAGE_SIZE || height > MAX_IMAGE_SIZE)
+    {
+        setLastError("LLImageDXT: bad dimensions");
+        return false;
     }
     S32 ncomponents = formatComponents(mFileFormat);
     setSize(width, height, ncomponents);
@@ -265,7 +316,9 @@ bool LLImageDXT::decode(LLImageRaw* raw_image, F32 time)
     //  but we don't use it any more!
     llassert_always(raw_image);
 
-    if (mFileFormat >= FORMAT_DXT1 && mFileFormat <= FORMAT_DXR5)
+    // only the formats LLImageBCn reads (not DXT or DXR3) come out raw
+    LLImageBCn::EFormat bcn_format = LLImageBCn::BC1;
+    if (isCompressed() && !block_format(mFileFormat, bcn_format))
     {
         LL_WARNS() << "Attempt to decode compressed LLImageDXT to Raw (unsupported)" << LL_ENDL;
         return false;
@@ -274,6 +327,28 @@ bool LLImageDXT::decode(LLImageRaw* raw_image, F32 time)
     LLImageDataSharedLock lockIn(this);
     LLImageDataLock lockOut(raw_image);
 
+    if (isCompressed())
+    {
+        // expand the blocks of one mip
+        S32 discard = llclamp((S32)mDiscardLevel, 0, calcNumMips(getWidth(), getHeight()) - 1);
+        S32 width = llmax(getWidth() >> discard, 1);
+        S32 height = llmax(getHeight() >> discard, 1);
+        S32 ncomponents = getComponents();
+        U8* data = getData() + getMipOffset(discard);
+        if (!getData() || data + formatBytes(mFileFormat, width, height) > getData() + getDataSize())
+        {
+            setLastError("LLImageDXT trying to decode an image with not enough data!");
+            return false;
+        }
+        if (!raw_image->resize(width, height, ncomponents))
+        {
+            setLastError("llImageDXT failed to resize image!");
+            return false;
+        }
+        LLImageBCn::decodeImage(bcn_format, data, width, height, ncomponents, raw_image->getData());
+        return true;
+    }
+
     S32 width = getWidth(), height = getHeight();
     S32 ncomponents = getComponents();
     U8* data = NULL;
@@ -418,6 +493,167 @@ bool LLImageDXT::encode(const LLImageRaw* raw_image, F32 time)
     return encodeDXT(raw_image, time, false);
 }
 
+bool LLImageDXT::encodeBlocks(const LLImageRaw* raw_image, EFileFormat format, LLImageBCn::EQuality quality)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    llassert_always(raw_image);
+
+    LLImageDataSharedLock lockIn(raw_image);
+
+    S32 ncomponents = raw_image->getComponents();
+    S32 width = raw_image->getWidth();
+    S32 height = raw_image->getHeight();
+    LLImageBCn::EFormat bcn_format = LLImageBCn::BC1;
+    if (!block_format(format, bcn_format) || formatComponents(format) != ncomponents)
+    {
+        setLastError("LLImageDXT can't compress these components to that format");
+        return false;
+    }
+    if (width <= 0 || height <= 0 || (width & (width - 1)) || (height & (height - 1)) || !raw_image->getData())
+    {
+        setLastError("LLImageDXT can only compress power of two images");
+        return false;
+    }
+
+    // every mip below the top one, built in a single pass
+    S32 nmips = calcNumMips(width, height);
+    std::unique_ptr<U8[]> chain;
+    if (nmips > 1)
+    {
+        chain.reset(new(std::nothrow) U8[getMipChainSize(width, height, ncomponents, nmips - 1)]);
+        if (!chain)
+        {
+            setLastError("LLImageDXT out of memory for mips");
+            return false;
+        }
+        generateMipChain(raw_image->getData(), chain.get(), width, height, ncomponents, nmips - 1);
+    }
+
+    LLImageDataLock lock(this);
+
+    setSize(width, height, ncomponents);
+    mHeaderSize = sizeof(dxtfile_header_t);
+    mFileFormat = format;
+
+    S32 totbytes = mHeaderSize;
+    for (S32 mip = 0; mip < nmips; mip++)
+    {
+        totbytes += formatBytes(format, width >> mip, height >> mip);
+    }
+    U8* data = allocateData(totbytes);
+    if (!data)
+    {
+        setLastError("LLImageDXT out of memory");
+        return false;
+    }
+
+    dxtfile_header_t* header = (dxtfile_header_t*)data;
+    memset(header, 0, mHeaderSize);
+    header->fourcc = 0x20534444;
+    header->header_size = mHeaderSize;
+    header->pixel_fmt.fourcc = getFourCC(format);
+    header->num_mips = nmips;
+    header->maxwidth = width;
+    header->maxheight = height;
+
+    for (S32 mip = 0; mip < nmips; mip++)
+    {
+        const U8* mipdata = mip ? chain.get() + getMipChainSize(width, height, ncomponents, mip - 1) : raw_image->getData();
+        LLImageBCn::encodeImage(bcn_format, mipdata, width >> mip, height >> mip, ncomponents,
+                                data + getMipOffset(mip), quality);
+    }
+    setDiscardLevel(0);
+
+    return true;
+}
+
+//static
+LLImageDXT::EFileFormat LLImageDXT::getBlockFormat(S32 ncomponents, LLImageBCn::EQuality quality, bool allow_bc7)
+{
+    switch (ncomponents)
+    {
+      case 3:
+        return FORMAT_DXR1;
+      case 4:
+        return quality == LLImageBCn::HIGH && allow_bc7 ? FORMAT_DXR7 : FORMAT_DXR5;
+      default:
+        return FORMAT_UNKNOWN;
+    }
+}
+
+//static
+LLPointer<LLImageDXT> LLImageDXT::createBlocks(const LLImageRaw* raw_image, EFileFormat format, LLImageBCn::EQuality quality,
+                                               const std::string& filename, U32 unique_id)
+{
+    LLPointer<LLImageDXT> image = new LLImageDXT();
+    if (!image->encodeBlocks(raw_image, format, quality))
+    {
+        return NULL;
+    }
+
+    if (!filename.empty())
+    {
+        // write beside it and move it into place, so a reader never finds half a file
+        std::string temp_file = filename + llformat(".%u", unique_id);
+        bool saved = image->save(temp_file);
+        if (saved)
+        {
+            LLFile::remove(filename, ENOENT);
+            saved = LLFile::rename(temp_file, filename) == 0;
+        }
+        if (!saved)
+        {
+            LLFile::remove(temp_file, ENOENT);
+        }
+    }
+    return image;
+}
+
+//static
+LLPointer<LLImageDXT> LLImageDXT::loadBlocks(const std::string& filename, EFileFormat format, S32 width, S32 height,
+                                             S32 discard_level, LLImageRaw* raw_image)
+{
+    if (filename.empty() || !LLFile::isfile(filename))
+    {
+        return NULL;
+    }
+
+    LLPointer<LLImageDXT> image = new LLImageDXT();
+    if (!image->load(filename) || !image->isCompressed() || image->getDiscardLevel() != 0)
+    {
+        // damaged or cut short: the caller decodes and replaces it
+        return NULL;
+    }
+    if (image->getFileFormat() != format)
+    {
+        // made with other settings
+        return NULL;
+    }
+
+    // The file holds the image from some discard level down
+    S32 file_discard = 0;
+    while (file_discard < MAX_IMAGE_MIP && (width >> file_discard) > image->getWidth())
+    {
+        ++file_discard;
+    }
+    if ((width >> file_discard) != image->getWidth() || (height >> file_discard) != image->getHeight())
+    {
+        return NULL;
+    }
+    S32 mip = llmax(discard_level, 0) - file_discard;
+    if (mip < 0 || mip >= calcNumMips(image->getWidth(), image->getHeight()))
+    {
+        return NULL;
+    }
+
+    image->setDiscardLevel(mip);
+    if (!image->decode(raw_image, 0.f))
+    {
+        return NULL;
+    }
+    return image;
+}
+
 // virtual
 bool LLImageDXT::convertToDXR()
 {
@@ -27,6 +27,7 @@
 #define LL_LLIMAGEDXT_H
 
 #include "llimage.h"
+#include "llimagebcn.h"
 #include "llpointer.h"
 
 // This class decodes and encodes LL DXT files (which may unclude uncompressed RGB or RGBA mipped data)
@@ -51,6 +52,7 @@ public:
         FORMAT_DXR3,
         FORMAT_DXR4,
         FORMAT_DXR5,
+        FORMAT_DXR7, // BC7, smallest mip first like the other DXR formats
         FORMAT_NOFILE = 0xff,
     };
 
@@ -113,7 +115,25 @@ public:
     S32 getMipOffset(S32 discard);
 
     EFileFormat getFileFormat() { return mFileFormat; }
-    bool isCompressed() { return (mFileFormat >= FORMAT_DXT1 && mFileFormat <= FORMAT_DXR5); }
+    bool isCompressed() { return (mFileFormat >= FORMAT_DXT1 && mFileFormat <= FORMAT_DXR7); }
+
+    // Compress raw_image and its mips, down to 1 pixel on the shorter side,
+    // to format: FORMAT_DXR1 for 3 components, FORMAT_DXR5 or FORMAT_DXR7
+    // for 4. Sides must be powers of two.
+    bool encodeBlocks(const LLImageRaw* raw_image, EFileFormat format, LLImageBCn::EQuality quality);
+    // The format encodeBlocks() takes for an image of ncomponents, or
+    // FORMAT_UNKNOWN if there is none.
+    static EFileFormat getBlockFormat(S32 ncomponents, LLImageBCn::EQuality quality, bool allow_bc7);
+    // encodeBlocks() raw_image into a new image and, unless filename is
+    // empty, save it there. unique_id names the temporary file. NULL on
+    // failure; a failed save still returns the image.
+    static LLPointer<LLImageDXT> createBlocks(const LLImageRaw* raw_image, EFileFormat format, LLImageBCn::EQuality quality,
+                                              const std::string& filename, U32 unique_id);
+    // Load a file from createBlocks() for an image of width x height and
+    // decode discard_level from it into raw_image. NULL if the file is
+    // missing, damaged, of another format or doesn't reach discard_level.
+    static LLPointer<LLImageDXT> loadBlocks(const std::string& filename, EFileFormat format, S32 width, S32 height,
+                                            S32 discard_level, LLImageRaw* raw_image);
 
     bool convertToDXR(); // convert from DXT to DXR
 
@@ -53,6 +53,7 @@ std::string LLImageJ2C::getEngineInfo()
 
 LLImageJ2C::LLImageJ2C() :  LLImageFormatted(IMG_CODEC_J2C),
                             mMaxBytes(0),
+                            mDecodeThreads(1),
                             mRawDiscardLevel(-1),
                             mRate(DEFAULT_COMPRESSION_RATE),
                             mReversible(false),
@@ -0,0 +1,384 @@
+/**
+ * @file   llimagemip.cpp
+ * @date   2026-10-18
+ * @brief  Mip level generation for LLImageBase.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llimage.h"
+
+#include "llimagesimd.h"
+#include "llmath.h"
+#include "workqueue.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+//static
+void LLImageBase::generateMip(const U8* indata, U8* mipdata, S32 width, S32 height, S32 nchannels)
+{
+    llassert(width > 0 && height > 0);
+    if (nchannels < 1 || nchannels > 4)
+    {
+        LL_WARNS() << "generateMmip called with bad num channels: " << nchannels << LL_ENDL;
+        return;
+    }
+    const LLImageSIMD::Kernels& kernels = LLImageSIMD::get();
+    const S32 in_row = width * 2 * nchannels;
+    for (S32 h=0; h<height; h++)
+    {
+        kernels.downsample2x2(indata, indata + in_row, mipdata, width, nchannels);
+        indata += in_row * 2; // skip odd lines
+        mipdata += width * nchannels;
+    }
+}
+
+std::string LLImageBase::sMipWorkQueue;
+std::atomic<S32> LLImageBase::sMipHelpers{ 0 };
+std::atomic<S32> LLImageBase::sMipParallelMinPixels{ 512 * 512 };
+
+namespace
+{
+    // Levels built strip by strip: a strip of 1 << MIP_STRIP_LEVELS base
+    // rows yields whole rows down to that level, and stays in cache while it
+    // does. Smaller levels are built from the last strip level afterwards.
+    const S32 MIP_STRIP_LEVELS = 5;
+    // strips per job grab
+    const S32 MIP_STRIPS_PER_GRAB = 4;
+
+    // sRGB to and from 16 bit linear light; the reverse table is indexed by
+    // linear value >> 2.
+    struct MipGammaTables
+    {
+        U16 mToLinear[256];
+        U8 mFromLinear[1 << 14];
+
+        MipGammaTables()
+        {
+            for (S32 i = 0; i < 256; ++i)
+            {
+                const F32 c = i / 255.f;
+                const F32 linear = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+                mToLinear[i] = (U16)ll_round(linear * 65535.f);
+            }
+            for (S32 i = 0; i < (1 << 14); ++i)
+            {
+                const F32 linear = (i * 4 + 2) / 65535.f;
+                const F32 c = linear <= 0.0031308f ? linear * 12.92f : 1.055f * powf(linear, 1.f / 2.4f) - 0.055f;
+                mFromLinear[i] = (U8)llclamp(ll_round(c * 255.f), 0, 255);
+            }
+        }
+    };
+
+    const MipGammaTables& mip_gamma_tables()
+    {
+        static const MipGammaTables sTables;
+        return sTables;
+    }
+
+    struct MipLevel
+    {
+        U8* mData;
+        S32 mWidth;
+        S32 mHeight;
+    };
+
+    // Builds destination rows of one level from the level above.
+    class MipRowBuilder
+    {
+    public:
+        MipRowBuilder(S32 nchannels, bool srgb)
+        :   mKernels(LLImageSIMD::get()),
+            mChannels(nchannels),
+            // RGB is padded to RGBA in linear light for the vector kernels
+            mLinearChannels(nchannels == 3 ? 4 : nchannels),
+            mSRGB(srgb),
+            mGamma(srgb ? &mip_gamma_tables() : NULL)
+        {
+        }
+
+        void buildRows(const MipLevel& src, const MipLevel& dst, S32 begin, S32 end)
+        {
+            if (src.mWidth < 2 || src.mHeight < 2)
+            {
+                buildClampedRows(src, dst, begin, end);
+                return;
+            }
+            const S32 src_row = src.mWidth * mChannels;
+            const S32 dst_row = dst.mWidth * mChannels;
+            for (S32 y = begin; y < end; ++y)
+            {
+                const U8* row0 = src.mData + (y * 2) * src_row;
+                const U8* row1 = row0 + src_row;
+                U8* out = dst.mData + y * dst_row;
+                if (! mSRGB)
+                {
+                    mKernels.downsample2x2(row0, row1, out, dst.mWidth, mChannels);
+                    continue;
+                }
+                const S32 values = dst.mWidth * 2 * mLinearChannels;
+                mLinear0.resize(values);
+                mLinear1.resize(values);
+                mLinearOut.resize(dst.mWidth * mLinearChannels);
+                toLinear(row0, &mLinear0[0], dst.mWidth * 2);
+                toLinear(row1, &mLinear1[0], dst.mWidth * 2);
+                mKernels.downsample2x2U16(&mLinear0[0], &mLinear1[0], &mLinearOut[0], dst.mWidth, mLinearChannels);
+                fromLinear(&mLinearOut[0], out, dst.mWidth);
+            }
+        }
+
+    private:
+        bool isAlpha(S32 channel) const
+        {
+            return (mChannels == 4 && channel == 3) || (mChannels == 2 && channel == 1);
+        }
+
+        U16 decode(U8 value, S32 channel) const
+        {
+            return isAlpha(channel) ? U16(value * 257) : mGamma->mToLinear[value];
+        }
+
+        U8 encode(U32 linear, S32 channel) const
+        {
+            return isAlpha(channel) ? U8((linear + 128) / 257) : mGamma->mFromLinear[linear >> 2];
+        }
+
+        void toLinear(const U8* in, U16* out, S32 pixels) const
+        {
+            for (S32 i = 0; i < pixels; ++i, in += mChannels, out += mLinearChannels)
+            {
+                for (S32 c = 0; c < mChannels; ++c)
+                {
+                    out[c] = decode(in[c], c);
+                }
+                if (mLinearChannels != mChannels)
+                {
+                    out[3] = 0;
+                }
+            }
+        }
+
+        void fromLinear(const U16* in, U8* out, S32 pixels) const
+        {
+            for (S32 i = 0; i < pixels; ++i, in += mLinearChannels, out += mChannels)
+            {
+                for (S32 c = 0; c < mChannels; ++c)
+                {
+                    out[c] = encode(in[c], c);
+                }
+            }
+        }
+
+        // Levels where one side is already 1 pixel: that side repeats its
+        // only row or column.
+        void buildClampedRows(const MipLevel& src, const MipLevel& dst, S32 begin, S32 end) const
+        {
+            for (S32 y = begin; y < end; ++y)
+            {
+                const U8* row0 = src.mData + llmin(y * 2, src.mHeight - 1) * src.mWidth * mChannels;
+                const U8* row1 = src.mData + llmin(y * 2 + 1, src.mHeight - 1) * src.mWidth * mChannels;
+                U8* out = dst.mData + y * dst.mWidth * mChannels;
+                for (S32 x = 0; x < dst.mWidth; ++x)
+                {
+                    const S32 x0 = llmin(x * 2, src.mWidth - 1) * mChannels;
+                    const S32 x1 = llmin(x * 2 + 1, src.mWidth - 1) * mChannels;
+                    for (S32 c = 0; c < mChannels; ++c)
+                    {
+                        if (mSRGB)
+                        {
+                            const U32 sum = decode(row0[x0 + c], c) + decode(row0[x1 + c], c) + decode(row1[x0 + c], c) + decode(row1[x1 + c], c);
+                            *out++ = encode((sum + 2) >> 2, c);
+                        }
+                        else
+                        {
+                            *out++ = U8(((U32)row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c]) >> 2);
+                        }
+                    }
+                }
+            }
+        }
+
+        const LLImageSIMD::Kernels& mKernels;
+        const S32 mChannels;
+        const S32 mLinearChannels;
+        const bool mSRGB;
+        const MipGammaTables* mGamma;
+        std::vector<U16> mLinear0, mLinear1, mLinearOut;
+    };
+
+    // The strip levels of a chain, shared between the calling thread and any
+    // helpers on the work queue. Helpers that start after every strip has
+    // been taken return without touching the image, so the caller never waits
+    // on queued work, only on strips in progress.
+    class MipStrips
+    {
+    public:
+        MipStrips(const std::vector<MipLevel>& levels, S32 strip_levels, S32 nchannels, bool srgb)
+        :   mLevels(levels.begin(), levels.begin() + strip_levels + 1),
+            mStripLevels(strip_levels),
+            mStrips(levels[0].mHeight >> strip_levels),
+            mChannels(nchannels),
+            mSRGB(srgb),
+            mNext(0),
+            mDone(0)
+        {
+        }
+
+        void run()
+        {
+            MipRowBuilder builder(mChannels, mSRGB);
+            S32 first;
+            while ((first = mNext.fetch_add(MIP_STRIPS_PER_GRAB)) < mStrips)
+            {
+                const S32 last = llmin(first + MIP_STRIPS_PER_GRAB, mStrips);
+                for (S32 strip = first; strip < last; ++strip)
+                {
+                    for (S32 level = 1; level <= mStripLevels; ++level)
+                    {
+                        const S32 rows = 1 << (mStripLevels - level);
+                        builder.buildRows(mLevels[level - 1], mLevels[level], strip * rows, (strip + 1) * rows);
+                    }
+                }
+                if (mDone.fetch_add(last - first) + (last - first) == mStrips)
+                {
+                    std::lock_guard<std::mutex> lock(mMutex);
+                    mCondition.notify_all();
+                }
+            }
+        }
+
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this]() { return mDone.load() == mStrips; });
+        }
+
+        S32 getStrips() const { return mStrips; }
+
+    private:
+        const std::vector<MipLevel> mLevels;
+        const S32 mStripLevels;
+        const S32 mStrips;
+        const S32 mChannels;
+        const bool mSRGB;
+        std::atomic<S32> mNext;
+        std::atomic<S32> mDone;
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+    };
+} // anonymous namespace
+
+//static
+S32 LLImageBase::getMipChainSize(S32 width, S32 height, S32 nchannels, S32 levels)
+{
+    S32 size = 0;
+    for (S32 level = 0; level < levels && (width > 1 || height > 1); ++level)
+    {
+        width = llmax(width >> 1, 1);
+        height = llmax(height >> 1, 1);
+        size += width * height * nchannels;
+    }
+    return size;
+}
+
+//static
+S32 LLImageBase::generateMipChain(const U8* base, U8* chain, S32 width, S32 height, S32 nchannels, S32 levels, bool srgb)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    llassert(width > 0 && height > 0);
+    if (nchannels < 1 || nchannels > 4)
+    {
+        LL_WARNS() << "generateMipChain called with bad num channels: " << nchannels << LL_ENDL;
+        return 0;
+    }
+
+    // the chain never writes to level 0
+    std::vector<MipLevel> mips(1, MipLevel{ const_cast<U8*>(base), width, height });
+    for (S32 level = 1; level <= levels && (width > 1 || height > 1); ++level)
+    {
+        MipLevel mip{ chain, llmax(width >> 1, 1), llmax(height >> 1, 1) };
+        chain += mip.mWidth * mip.mHeight * nchannels;
+        mips.push_back(mip);
+        width = mip.mWidth;
+        height = mip.mHeight;
+    }
+    const S32 built = (S32)mips.size() - 1;
+
+    // Strip levels need every level above them to halve exactly.
+    S32 strip_levels = 0;
+    while (strip_levels < llmin(built, MIP_STRIP_LEVELS)
+           && mips[strip_levels].mWidth >= 2
+           && mips[strip_levels].mHeight >= 2
+           && ! (mips[strip_levels].mHeight & 1))
+    {
+        ++strip_levels;
+    }
+
+    if (strip_levels > 0)
+    {
+        auto strips = std::make_shared<MipStrips>(mips, strip_levels, nchannels, srgb);
+        // sMipHelpers first: the queue name is only read while it is set
+        const S32 max_helpers = sMipHelpers.load(std::memory_order_acquire);
+        if (max_helpers > 0 && mips[0].mWidth * mips[0].mHeight >= sMipParallelMinPixels.load(std::memory_order_relaxed))
+        {
+            auto queue = LL::WorkQueueBase::getInstance(sMipWorkQueue);
+            const S32 helpers = llmin(max_helpers, strips->getStrips() / MIP_STRIPS_PER_GRAB - 1);
+            for (S32 i = 0; queue && i < helpers; ++i)
+            {
+                if (! queue->post([strips]() { strips->run(); }, LL::WorkQueueBase::PRIORITY_URGENT))
+                {
+                    break;
+                }
+            }
+        }
+        strips->run();
+        strips->wait();
+    }
+
+    MipRowBuilder builder(nchannels, srgb);
+    for (S32 level = strip_levels + 1; level <= built; ++level)
+    {
+        builder.buildRows(mips[level - 1], mips[level], 0, mips[level].mHeight);
+    }
+    return built;
+}
+
+//static
+void LLImageBase::setMipWorkQueue(const std::string& name, S32 helpers, S32 min_pixels)
+{
+    // Clearing can come while GL threads are inside generateMipChain(), so
+    // it leaves the name alone: they may still be reading it.
+    sMipHelpers.store(0, std::memory_order_release);
+    if (name.empty())
+    {
+        return;
+    }
+    sMipWorkQueue = name;
+    sMipParallelMinPixels.store(min_pixels, std::memory_order_relaxed);
+    sMipHelpers.store(llmax(helpers, 0), std::memory_order_release);
+}
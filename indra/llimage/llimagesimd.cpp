@@ -0,0 +1,1176 @@
+/**
+ * @file   llimagesimd.cpp
+ * @date   2026-10-18
+ * @brief  Scalar reference kernels and CPU dispatch for LLImageSIMD.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llimagesimd.h"
+
+#include "llmath.h"
+
+#include <atomic>
+#include <cstring>
+#include <boost/preprocessor.hpp>
+
+#if LL_IMAGE_SIMD_X86 && LL_WINDOWS
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace LLImageSIMD
+{
+// The scalar kernels are LLImageRaw's original loops, kept as they were so
+// the vector versions have something to be checked against.
+ScalePoints::ScalePoints(const U8 *src, U32 srcW, U32 srcH, U32 dstW, U32 dstH, U32 srcStride)
+    : xup_yup((dstW >= srcW) + ((dstH >= srcH) << 1))
+{
+    calc_x_points(srcW, dstW);
+    calc_y_strides(src, srcStride, srcH, dstH);
+    calc_aa_points(srcW, dstW, xup_yup&1, xapoints);
+    calc_aa_points(srcH, dstH, xup_yup&2, yapoints);
+}
+//...........................................................................................
+void ScalePoints::calc_x_points(U32 srcW, U32 dstW)
+{
+    xpoints.resize(dstW+1);
+
+    S32 val = dstW >= srcW ? 0x8000 * srcW / dstW - 0x8000 : 0;
+    S32 inc = (srcW << 16) / dstW;
+
+    for(U32 i = 0, j = 0; i < dstW; ++i, ++j, val += inc)
+    {
+        xpoints[j] = llmax(0, val >> 16);
+    }
+}
+//...........................................................................................
+void ScalePoints::calc_y_strides(const U8 *src, U32 srcStride, U32 srcH, U32 dstH)
+{
+    ystrides.resize(dstH+1);
+
+    S32 val = dstH >= srcH ? 0x8000 * srcH / dstH - 0x8000 : 0;
+    S32 inc = (srcH << 16) / dstH;
+
+    for(U32 i = 0, j = 0; i < dstH; ++i, ++j, val += inc)
+    {
+        ystrides[j] = src + llmax(0, val >> 16) * srcStride;
+    }
+}
+//...........................................................................................
+void ScalePoints::calc_aa_points(U32 srcSz, U32 dstSz, bool scale_up, std::vector<S32> &vp)
+{
+    vp.resize(dstSz);
+
+    if(scale_up)
+    {
+        S32 val = 0x8000 * srcSz / dstSz - 0x8000;
+        S32 inc = (srcSz << 16) / dstSz;
+        U32 pos;
+
+        for(U32 i = 0, j = 0; i < dstSz; ++i, ++j, val += inc)
+        {
+            pos = val >> 16;
+
+            if (pos >= (srcSz - 1))
+                vp[j] = 0;
+            else
+                vp[j] = (val >> 8) - ((val >> 8) & 0xffffff00);
+        }
+    }
+    else
+    {
+        S32 inc = (srcSz << 16) / dstSz;
+        S32 Cp = ((dstSz << 14) / srcSz) + 1;
+        S32 ap;
+
+        for(U32 i = 0, j = 0, val = 0; i < dstSz; ++i, ++j, val += inc)
+        {
+            ap = ((0x100 - ((val >> 8) & 0xff)) * Cp) >> 8;
+            vp[j] = ap | (Cp << 16);
+        }
+    }
+}
+
+namespace scalar
+{
+namespace
+{
+//..................................................................................
+//..................................................................................
+// Helper macrose's for generate cycle unwrap templates
+//..................................................................................
+#define _UNROL_GEN_TPL_arg_0(arg)
+#define _UNROL_GEN_TPL_arg_1(arg) arg
+
+#define _UNROL_GEN_TPL_comma_0
+#define _UNROL_GEN_TPL_comma_1 BOOST_PP_COMMA()
+//..................................................................................
+#define _UNROL_GEN_TPL_ARGS_macro(z,n,seq) \
+    BOOST_PP_CAT(_UNROL_GEN_TPL_arg_, BOOST_PP_MOD(n, 2))(BOOST_PP_SEQ_ELEM(n, seq)) BOOST_PP_CAT(_UNROL_GEN_TPL_comma_, BOOST_PP_AND(BOOST_PP_MOD(n, 2), BOOST_PP_NOT_EQUAL(BOOST_PP_INC(n), BOOST_PP_SEQ_SIZE(seq))))
+
+#define _UNROL_GEN_TPL_ARGS(seq) \
+    BOOST_PP_REPEAT(BOOST_PP_SEQ_SIZE(seq), _UNROL_GEN_TPL_ARGS_macro, seq)
+//..................................................................................
+
+#define _UNROL_GEN_TPL_TYPE_ARGS_macro(z,n,seq) \
+    BOOST_PP_SEQ_ELEM(n, seq) BOOST_PP_CAT(_UNROL_GEN_TPL_comma_, BOOST_PP_AND(BOOST_PP_MOD(n, 2), BOOST_PP_NOT_EQUAL(BOOST_PP_INC(n), BOOST_PP_SEQ_SIZE(seq))))
+
+#define _UNROL_GEN_TPL_TYPE_ARGS(seq) \
+    BOOST_PP_REPEAT(BOOST_PP_SEQ_SIZE(seq), _UNROL_GEN_TPL_TYPE_ARGS_macro, seq)
+//..................................................................................
+#define _UNROLL_GEN_TPL_foreach_ee(z, n, seq) \
+    executor<n>(_UNROL_GEN_TPL_ARGS(seq));
+
+#define _UNROLL_GEN_TPL(name, args_seq, operation, spec) \
+    template<> struct name<spec> { \
+    private: \
+        template<S32 _idx> inline void executor(_UNROL_GEN_TPL_TYPE_ARGS(args_seq)) { \
+            BOOST_PP_SEQ_ENUM(operation) ; \
+        } \
+    public: \
+        inline void operator()(_UNROL_GEN_TPL_TYPE_ARGS(args_seq)) { \
+            BOOST_PP_REPEAT(spec, _UNROLL_GEN_TPL_foreach_ee, args_seq) \
+        } \
+};
+//..................................................................................
+#define _UNROLL_GEN_TPL_foreach_seq_macro(r, data, elem) \
+    _UNROLL_GEN_TPL(BOOST_PP_SEQ_ELEM(0, data), BOOST_PP_SEQ_ELEM(1, data), BOOST_PP_SEQ_ELEM(2, data), elem)
+
+#define UNROLL_GEN_TPL(name, args_seq, operation, spec_seq) \
+    /*general specialization - should not be implemented!*/ \
+    template<U8> struct name { inline void operator()(_UNROL_GEN_TPL_TYPE_ARGS(args_seq)) { /*static_assert(!"Should not be instantiated.");*/  } }; \
+    BOOST_PP_SEQ_FOR_EACH(_UNROLL_GEN_TPL_foreach_seq_macro, (name)(args_seq)(operation), spec_seq)
+//..................................................................................
+//..................................................................................
+
+
+//..................................................................................
+// Generated unrolling loop templates with specializations
+//..................................................................................
+//example: for(c = 0; c < ch; ++c) comp[c] = cx[0] = 0;
+UNROLL_GEN_TPL(uroll_zeroze_cx_comp, (S32 *)(cx)(S32 *)(comp), (cx[_idx] = comp[_idx] = 0), (1)(3)(4));
+//example: for(c = 0; c < ch; ++c) comp[c] >>= 4;
+UNROLL_GEN_TPL(uroll_comp_rshftasgn_constval, (S32 *)(comp)(const S32)(cval), (comp[_idx] >>= cval), (1)(3)(4));
+//example: for(c = 0; c < ch; ++c) comp[c] = (cx[c] >> 5) * yap;
+UNROLL_GEN_TPL(uroll_comp_asgn_cx_rshft_cval_all_mul_val, (S32 *)(comp)(S32 *)(cx)(const S32)(cval)(S32)(val), (comp[_idx] = (cx[_idx] >> cval) * val), (1)(3)(4));
+//example: for(c = 0; c < ch; ++c) comp[c] += (cx[c] >> 5) * Cy;
+UNROLL_GEN_TPL(uroll_comp_plusasgn_cx_rshft_cval_all_mul_val, (S32 *)(comp)(S32 *)(cx)(const S32)(cval)(S32)(val), (comp[_idx] += (cx[_idx] >> cval) * val), (1)(3)(4));
+//example: for(c = 0; c < ch; ++c) comp[c] += pix[c] * info.xapoints[x];
+UNROLL_GEN_TPL(uroll_inp_plusasgn_pix_mul_val, (S32 *)(comp)(const U8 *)(pix)(S32)(val), (comp[_idx] += pix[_idx] * val), (1)(3)(4));
+//example: for(c = 0; c < ch; ++c) cx[c] = pix[c] * info.xapoints[x];
+UNROLL_GEN_TPL(uroll_inp_asgn_pix_mul_val, (S32 *)(comp)(const U8 *)(pix)(S32)(val), (comp[_idx] = pix[_idx] * val), (1)(3)(4));
+//example: for(c = 0; c < ch; ++c) comp[c] = ((cx[c] * info.yapoints[y]) + (comp[c] * (256 - info.yapoints[y]))) >> 16;
+UNROLL_GEN_TPL(uroll_comp_asgn_cx_mul_apoint_plus_comp_mul_inv_apoint_allshifted_16_r, (S32 *)(comp)(S32 *)(cx)(S32)(apoint), (comp[_idx] = ((cx[_idx] * apoint) + (comp[_idx] * (256 - apoint))) >> 16), (1)(3)(4));
+//example: for(c = 0; c < ch; ++c) comp[c] = (comp[c] + pix[c] * info.yapoints[y]) >> 8;
+UNROLL_GEN_TPL(uroll_comp_asgn_comp_plus_pix_mul_apoint_allshifted_8_r, (S32 *)(comp)(const U8 *)(pix)(S32)(apoint), (comp[_idx] = (comp[_idx] + pix[_idx] * apoint) >> 8), (1)(3)(4));
+//example: for(c = 0; c < ch; ++c) comp[c] = ((comp[c]*(256 - info.xapoints[x])) + ((cx[c] * info.xapoints[x]))) >> 12;
+UNROLL_GEN_TPL(uroll_comp_asgn_comp_mul_inv_apoint_plus_cx_mul_apoint_allshifted_12_r, (S32 *)(comp)(S32)(apoint)(S32 *)(cx), (comp[_idx] = ((comp[_idx] * (256-apoint)) + (cx[_idx] * apoint)) >> 12), (1)(3)(4));
+//example: for(c = 0; c < ch; ++c) *dptr++ = comp[c]&0xff;
+UNROLL_GEN_TPL(uroll_uref_dptr_inc_asgn_comp_and_ff, (U8 *&)(dptr)(S32 *)(comp), (*dptr++ = comp[_idx]&0xff), (1)(3)(4));
+//example: for(c = 0; c < ch; ++c) *dptr++ = (sptr[info.xpoints[x]*ch + c])&0xff;
+UNROLL_GEN_TPL(uroll_uref_dptr_inc_asgn_sptr_apoint_plus_idx_alland_ff, (U8 *&)(dptr)(const U8 *)(sptr)(S32)(apoint), (*dptr++ = sptr[apoint + _idx]&0xff), (1)(3)(4));
+//example: for(c = 0; c < ch; ++c) *dptr++ = (comp[c]>>10)&0xff;
+UNROLL_GEN_TPL(uroll_uref_dptr_inc_asgn_comp_rshft_cval_and_ff, (U8 *&)(dptr)(S32 *)(comp)(const S32)(cval), (*dptr++ = (comp[_idx]>>cval)&0xff), (1)(3)(4));
+//..................................................................................
+
+template<U8 ch>
+struct scale_info : public LLImageSIMD::ScalePoints
+{
+public:
+    //unrolling loop types declaration
+    typedef uroll_zeroze_cx_comp<ch>                                                        uroll_zeroze_cx_comp_t;
+    typedef uroll_comp_rshftasgn_constval<ch>                                               uroll_comp_rshftasgn_constval_t;
+    typedef uroll_comp_asgn_cx_rshft_cval_all_mul_val<ch>                                   uroll_comp_asgn_cx_rshft_cval_all_mul_val_t;
+    typedef uroll_comp_plusasgn_cx_rshft_cval_all_mul_val<ch>                               uroll_comp_plusasgn_cx_rshft_cval_all_mul_val_t;
+    typedef uroll_inp_plusasgn_pix_mul_val<ch>                                              uroll_inp_plusasgn_pix_mul_val_t;
+    typedef uroll_inp_asgn_pix_mul_val<ch>                                                  uroll_inp_asgn_pix_mul_val_t;
+    typedef uroll_comp_asgn_cx_mul_apoint_plus_comp_mul_inv_apoint_allshifted_16_r<ch>      uroll_comp_asgn_cx_mul_apoint_plus_comp_mul_inv_apoint_allshifted_16_r_t;
+    typedef uroll_comp_asgn_comp_plus_pix_mul_apoint_allshifted_8_r<ch>                     uroll_comp_asgn_comp_plus_pix_mul_apoint_allshifted_8_r_t;
+    typedef uroll_comp_asgn_comp_mul_inv_apoint_plus_cx_mul_apoint_allshifted_12_r<ch>      uroll_comp_asgn_comp_mul_inv_apoint_plus_cx_mul_apoint_allshifted_12_r_t;
+    typedef uroll_uref_dptr_inc_asgn_comp_and_ff<ch>                                        uroll_uref_dptr_inc_asgn_comp_and_ff_t;
+    typedef uroll_uref_dptr_inc_asgn_sptr_apoint_plus_idx_alland_ff<ch>                     uroll_uref_dptr_inc_asgn_sptr_apoint_plus_idx_alland_ff_t;
+    typedef uroll_uref_dptr_inc_asgn_comp_rshft_cval_and_ff<ch>                             uroll_uref_dptr_inc_asgn_comp_rshft_cval_and_ff_t;
+
+public:
+    scale_info(const U8 *src, U32 srcW, U32 srcH, U32 dstW, U32 dstH, U32 srcStride)
+        : LLImageSIMD::ScalePoints(src, srcW, srcH, dstW, dstH, srcStride)
+    {
+    }
+};
+
+template<U8 ch>
+inline void bilinear_scale(
+    const U8 *src, U32 srcW, U32 srcH, U32 srcStride
+    , U8 *dst, U32 dstW, U32 dstH, U32 dstStride
+    )
+{
+    typedef scale_info<ch> scale_info_t;
+
+    scale_info_t info(src, srcW, srcH, dstW, dstH, srcStride);
+
+    const U8 *sptr;
+    U8 *dptr;
+    U32 x, y;
+    const U8 *pix;
+
+    S32 cx[ch], comp[ch];
+
+
+    if(3 == info.xup_yup)
+    { //scale x/y - up
+        for(y = 0; y < dstH; ++y)
+        {
+            dptr = dst + (y * dstStride);
+            sptr = info.ystrides[y];
+
+            if(0 < info.yapoints[y])
+            {
+                for(x = 0; x < dstW; ++x)
+                {
+                    //for(c = 0; c < ch; ++c) cx[c] = comp[c] = 0;
+                    typename scale_info_t::uroll_zeroze_cx_comp_t()(cx, comp);
+
+                    if(0 < info.xapoints[x])
+                    {
+                        pix = info.ystrides[y] + info.xpoints[x] * ch;
+
+                        //for(c = 0; c < ch; ++c) comp[c] = pix[c] * (256 - info.xapoints[x]);
+                        typename scale_info_t::uroll_inp_asgn_pix_mul_val_t()(comp, pix, 256 - info.xapoints[x]);
+
+                        pix += ch;
+
+                        //for(c = 0; c < ch; ++c) comp[c] += pix[c] * info.xapoints[x];
+                        typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(comp, pix, info.xapoints[x]);
+
+                        pix += srcStride;
+
+                        //for(c = 0; c < ch; ++c) cx[c] = pix[c] * info.xapoints[x];
+                        typename scale_info_t::uroll_inp_asgn_pix_mul_val_t()(cx, pix, info.xapoints[x]);
+
+                        pix -= ch;
+
+                        //for(c = 0; c < ch; ++c) {
+                        //  cx[c] += pix[c] * (256 - info.xapoints[x]);
+                        //  comp[c] = ((cx[c] * info.yapoints[y]) + (comp[c] * (256 - info.yapoints[y]))) >> 16;
+                        //  *dptr++ = comp[c]&0xff;
+                        //}
+                        typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(cx, pix, 256 - info.xapoints[x]);
+                        typename scale_info_t::uroll_comp_asgn_cx_mul_apoint_plus_comp_mul_inv_apoint_allshifted_16_r_t()(comp, cx, info.yapoints[y]);
+                        typename scale_info_t::uroll_uref_dptr_inc_asgn_comp_and_ff_t()(dptr, comp);
+                    }
+                    else
+                    {
+                        pix = info.ystrides[y] + info.xpoints[x] * ch;
+
+                        //for(c = 0; c < ch; ++c) comp[c] = pix[c] * (256 - info.yapoints[y]);
+                        typename scale_info_t::uroll_inp_asgn_pix_mul_val_t()(comp, pix, 256-info.yapoints[y]);
+
+                        pix += srcStride;
+
+                        //for(c = 0; c < ch; ++c) {
+                        //  comp[c] = (comp[c] + pix[c] * info.yapoints[y]) >> 8;
+                        //  *dptr++ = comp[c]&0xff;
+                        //}
+                        typename scale_info_t::uroll_comp_asgn_comp_plus_pix_mul_apoint_allshifted_8_r_t()(comp, pix, info.yapoints[y]);
+                        typename scale_info_t::uroll_uref_dptr_inc_asgn_comp_and_ff_t()(dptr, comp);
+                    }
+                }
+            }
+            else
+            {
+                for(x = 0; x < dstW; ++x)
+                {
+                    if(0 < info.xapoints[x])
+                    {
+                        pix = info.ystrides[y] + info.xpoints[x] * ch;
+
+                        //for(c = 0; c < ch; ++c) {
+                        //  comp[c] = pix[c] * (256 - info.xapoints[x]);
+                        //  comp[c] = (comp[c] + pix[c] * info.xapoints[x]) >> 8;
+                        //  *dptr++ = comp[c]&0xff;
+                        //}
+                        typename scale_info_t::uroll_inp_asgn_pix_mul_val_t()(comp, pix, 256 - info.xapoints[x]);
+                        typename scale_info_t::uroll_comp_asgn_comp_plus_pix_mul_apoint_allshifted_8_r_t()(comp, pix, info.xapoints[x]);
+                        typename scale_info_t::uroll_uref_dptr_inc_asgn_comp_and_ff_t()(dptr, comp);
+                    }
+                    else
+                    {
+                        //for(c = 0; c < ch; ++c) *dptr++ = (sptr[info.xpoints[x]*ch + c])&0xff;
+                        typename scale_info_t::uroll_uref_dptr_inc_asgn_sptr_apoint_plus_idx_alland_ff_t()(dptr, sptr, info.xpoints[x]*ch);
+                    }
+                }
+            }
+        }
+    }
+    else if(info.xup_yup == 1)
+    { //scaling down vertically
+        S32 Cy, j;
+        S32 yap;
+
+        for(y = 0; y < dstH; y++)
+        {
+            Cy = info.yapoints[y] >> 16;
+            yap = info.yapoints[y] & 0xffff;
+
+            dptr = dst + (y * dstStride);
+
+            for(x = 0; x < dstW; x++)
+            {
+                pix = info.ystrides[y] + info.xpoints[x] * ch;
+
+                //for(c = 0; c < ch; ++c) comp[c] = pix[c] * yap;
+                typename scale_info_t::uroll_inp_asgn_pix_mul_val_t()(comp, pix, yap);
+
+                pix += srcStride;
+
+                for(j = (1 << 14) - yap; j > Cy; j -= Cy, pix += srcStride)
+                {
+                    //for(c = 0; c < ch; ++c) comp[c] += pix[c] * Cy;
+                    typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(comp, pix, Cy);
+                }
+
+                if(j > 0)
+                {
+                    //for(c = 0; c < ch; ++c) comp[c] += pix[c] * j;
+                    typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(comp, pix, j);
+                }
+
+                if(info.xapoints[x] > 0)
+                {
+                    pix = info.ystrides[y] + info.xpoints[x]*ch + ch;
+                    //for(c = 0; c < ch; ++c) cx[c] = pix[c] * yap;
+                    typename scale_info_t::uroll_inp_asgn_pix_mul_val_t()(cx, pix, yap);
+
+                    pix += srcStride;
+                    for(j = (1 << 14) - yap; j > Cy; j -= Cy)
+                    {
+                        //for(c = 0; c < ch; ++c) cx[c] += pix[c] * Cy;
+                        typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(cx, pix, Cy);
+                        pix += srcStride;
+                    }
+
+                    if(j > 0)
+                    {
+                        //for(c = 0; c < ch; ++c) cx[c] += pix[c] * j;
+                        typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(cx, pix, j);
+                    }
+
+                    //for(c = 0; c < ch; ++c) comp[c] = ((comp[c]*(256 - info.xapoints[x])) + ((cx[c] * info.xapoints[x]))) >> 12;
+                    typename scale_info_t::uroll_comp_asgn_comp_mul_inv_apoint_plus_cx_mul_apoint_allshifted_12_r_t()(comp, info.xapoints[x], cx);
+                }
+                else
+                {
+                    //for(c = 0; c < ch; ++c) comp[c] >>= 4;
+                    typename scale_info_t::uroll_comp_rshftasgn_constval_t()(comp, 4);
+                }
+
+                //for(c = 0; c < ch; ++c) *dptr++ = (comp[c]>>10)&0xff;
+                typename scale_info_t::uroll_uref_dptr_inc_asgn_comp_rshft_cval_and_ff_t()(dptr, comp, 10);
+            }
+        }
+    }
+    else if(info.xup_yup == 2)
+    { // scaling down horizontally
+        S32 Cx, j;
+        S32 xap;
+
+        for(y = 0; y < dstH; y++)
+        {
+            dptr = dst + (y * dstStride);
+
+            for(x = 0; x < dstW; x++)
+            {
+                Cx = info.xapoints[x] >> 16;
+                xap = info.xapoints[x] & 0xffff;
+
+                pix = info.ystrides[y] + info.xpoints[x] * ch;
+
+                //for(c = 0; c < ch; ++c) comp[c] = pix[c] * xap;
+                typename scale_info_t::uroll_inp_asgn_pix_mul_val_t()(comp, pix, xap);
+
+                pix+=ch;
+                for(j = (1 << 14) - xap; j > Cx; j -= Cx)
+                {
+                    //for(c = 0; c < ch; ++c) comp[c] += pix[c] * Cx;
+                    typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(comp, pix, Cx);
+                    pix+=ch;
+                }
+
+                if(j > 0)
+                {
+                    //for(c = 0; c < ch; ++c) comp[c] += pix[c] * j;
+                    typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(comp, pix, j);
+                }
+
+                if(info.yapoints[y] > 0)
+                {
+                    pix = info.ystrides[y] + info.xpoints[x]*ch + srcStride;
+                    //for(c = 0; c < ch; ++c) cx[c] = pix[c] * xap;
+                    typename scale_info_t::uroll_inp_asgn_pix_mul_val_t()(cx, pix, xap);
+
+                    pix+=ch;
+                    for(j = (1 << 14) - xap; j > Cx; j -= Cx)
+                    {
+                        //for(c = 0; c < ch; ++c) cx[c] += pix[c] * Cx;
+                        typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(cx, pix, Cx);
+                        pix+=ch;
+                    }
+
+                    if(j > 0)
+                    {
+                        //for(c = 0; c < ch; ++c) cx[c] += pix[c] * j;
+                        typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(cx, pix, j);
+                    }
+
+                    //for(c = 0; c < ch; ++c) comp[c] = ((comp[c] * (256 - info.yapoints[y])) + ((cx[c] * info.yapoints[y]))) >> 12;
+                    typename scale_info_t::uroll_comp_asgn_comp_mul_inv_apoint_plus_cx_mul_apoint_allshifted_12_r_t()(comp, info.yapoints[y], cx);
+                }
+                else
+                {
+                    //for(c = 0; c < ch; ++c) comp[c] >>= 4;
+                    typename scale_info_t::uroll_comp_rshftasgn_constval_t()(comp, 4);
+                }
+
+                //for(c = 0; c < ch; ++c) *dptr++ = (comp[c]>>10)&0xff;
+                typename scale_info_t::uroll_uref_dptr_inc_asgn_comp_rshft_cval_and_ff_t()(dptr, comp, 10);
+            }
+        }
+    }
+    else
+    { //scale x/y - down
+        S32 Cx, Cy, i, j;
+        S32 xap, yap;
+
+        for(y = 0; y < dstH; y++)
+        {
+            Cy = info.yapoints[y] >> 16;
+            yap = info.yapoints[y] & 0xffff;
+
+            dptr = dst + (y * dstStride);
+            for(x = 0; x < dstW; x++)
+            {
+                Cx = info.xapoints[x] >> 16;
+                xap = info.xapoints[x] & 0xffff;
+
+                sptr = info.ystrides[y] + info.xpoints[x] * ch;
+                pix = sptr;
+                sptr += srcStride;
+
+                //for(c = 0; c < ch; ++c) cx[c] = pix[c] * xap;
+                typename scale_info_t::uroll_inp_asgn_pix_mul_val_t()(cx, pix, xap);
+
+                pix+=ch;
+                for(i = (1 << 14) - xap; i > Cx; i -= Cx)
+                {
+                    //for(c = 0; c < ch; ++c) cx[c] += pix[c] * Cx;
+                    typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(cx, pix, Cx);
+                    pix+=ch;
+                }
+
+                if(i > 0)
+                {
+                    //for(c = 0; c < ch; ++c) cx[c] += pix[c] * i;
+                    typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(cx, pix, i);
+                }
+
+                //for(c = 0; c < ch; ++c) comp[c] = (cx[c] >> 5) * yap;
+                typename scale_info_t::uroll_comp_asgn_cx_rshft_cval_all_mul_val_t()(comp, cx, 5, yap);
+
+                for(j = (1 << 14) - yap; j > Cy; j -= Cy)
+                {
+                    pix = sptr;
+                    sptr += srcStride;
+
+                    //for(c = 0; c < ch; ++c) cx[c] = pix[c] * xap;
+                    typename scale_info_t::uroll_inp_asgn_pix_mul_val_t()(cx, pix, xap);
+
+                    pix+=ch;
+                    for(i = (1 << 14) - xap; i > Cx; i -= Cx)
+                    {
+                        //for(c = 0; c < ch; ++c) cx[c] += pix[c] * Cx;
+                        typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(cx, pix, Cx);
+                        pix+=ch;
+                    }
+
+                    if(i > 0)
+                    {
+                        //for(c = 0; c < ch; ++c) cx[c] += pix[c] * i;
+                        typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(cx, pix, i);
+                    }
+
+                    //for(c = 0; c < ch; ++c) comp[c] += (cx[c] >> 5) * Cy;
+                    typename scale_info_t::uroll_comp_plusasgn_cx_rshft_cval_all_mul_val_t()(comp, cx, 5, Cy);
+                }
+
+                if(j > 0)
+                {
+                    pix = sptr;
+                    sptr += srcStride;
+
+                    //for(c = 0; c < ch; ++c) cx[c] = pix[c] * xap;
+                    typename scale_info_t::uroll_inp_asgn_pix_mul_val_t()(cx, pix, xap);
+
+                    pix+=ch;
+                    for(i = (1 << 14) - xap; i > Cx; i -= Cx)
+                    {
+                        //for(c = 0; c < ch; ++c) cx[c] += pix[c] * Cx;
+                        typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(cx, pix, Cx);
+                        pix+=ch;
+                    }
+
+                    if(i > 0)
+                    {
+                        //for(c = 0; c < ch; ++c) cx[c] += pix[c] * i;
+                        typename scale_info_t::uroll_inp_plusasgn_pix_mul_val_t()(cx, pix, i);
+                    }
+
+                    //for(c = 0; c < ch; ++c) comp[c] += (cx[c] >> 5) * j;
+                    typename scale_info_t::uroll_comp_plusasgn_cx_rshft_cval_all_mul_val_t()(comp, cx, 5, j);
+                }
+
+                //for(c = 0; c < ch; ++c) *dptr++ = (comp[c]>>23)&0xff;
+                typename scale_info_t::uroll_uref_dptr_inc_asgn_comp_rshft_cval_and_ff_t()(dptr, comp, 23);
+            }
+        }
+    } //else
+}
+
+void bilinearScale(const U8 *src, U32 srcW, U32 srcH, U32 srcStride, U8 *dst, U32 dstW, U32 dstH, U32 dstStride, U32 components)
+{
+    switch(components)
+    {
+    case 1:
+        bilinear_scale<1>(src, srcW, srcH, srcStride, dst, dstW, dstH, dstStride);
+        break;
+    case 3:
+        bilinear_scale<3>(src, srcW, srcH, srcStride, dst, dstW, dstH, dstStride);
+        break;
+    case 4:
+        bilinear_scale<4>(src, srcW, srcH, srcStride, dst, dstW, dstH, dstStride);
+        break;
+    default:
+        llassert(!"Implement if need");
+        break;
+    }
+}
+
+// Calculates (U8)(255*(a/255.f)*(b/255.f) + 0.5f).  Thanks, Jim Blinn!
+inline U8 fast_fractional_mult(U8 a, U8 b)
+{
+    U32 i = a * b + 128;
+    return U8((i + (i>>8)) >> 8);
+}
+
+void fill(U8* data, S32 pixels, S32 components, const U8* color)
+{
+    if( 4 == components )
+    {
+        U32 rgbaColor;
+        memcpy(&rgbaColor, color, sizeof(rgbaColor));
+        U32* data32 = (U32*) data;
+        for( S32 i = 0; i < pixels; i++ )
+        {
+            data32[ i ] = rgbaColor;
+        }
+    }
+    else
+    if( 3 == components )
+    {
+        for( S32 i = 0; i < pixels; i++ )
+        {
+            data[0] = color[0];
+            data[1] = color[1];
+            data[2] = color[2];
+            data += 3;
+        }
+    }
+}
+
+void tint(U8* data, S32 pixels, S32 components, const F32* color)
+{
+    for( S32 i = 0; i < pixels; i++ )
+    {
+        const float c0 = data[0] * color[0];
+        const float c1 = data[1] * color[1];
+        const float c2 = data[2] * color[2];
+        data[0] = U8(llclamp(c0, 0.f, 255.f));
+        data[1] = U8(llclamp(c1, 0.f, 255.f));
+        data[2] = U8(llclamp(c2, 0.f, 255.f));
+        data += components;
+    }
+}
+
+void copy4onto3(const U8* src_data, U8* dst_data, S32 pixels)
+{
+    for( S32 i=0; i<pixels; i++ )
+    {
+        dst_data[0] = src_data[0];
+        dst_data[1] = src_data[1];
+        dst_data[2] = src_data[2];
+        src_data += 4;
+        dst_data += 3;
+    }
+}
+
+void copy3onto4(const U8* src_data, U8* dst_data, S32 pixels)
+{
+    for( S32 i=0; i<pixels; i++ )
+    {
+        dst_data[0] = src_data[0];
+        dst_data[1] = src_data[1];
+        dst_data[2] = src_data[2];
+        dst_data[3] = 255;
+        src_data += 3;
+        dst_data += 4;
+    }
+}
+
+void composite4onto3(const U8* src_data, U8* dst_data, S32 pixels)
+{
+    while( pixels-- )
+    {
+        U8 alpha = src_data[3];
+        if( alpha )
+        {
+            if( 255 == alpha )
+            {
+                dst_data[0] = src_data[0];
+                dst_data[1] = src_data[1];
+                dst_data[2] = src_data[2];
+            }
+            else
+            {
+
+                U8 transparency = 255 - alpha;
+                dst_data[0] = fast_fractional_mult( dst_data[0], transparency ) + fast_fractional_mult( src_data[0], alpha );
+                dst_data[1] = fast_fractional_mult( dst_data[1], transparency ) + fast_fractional_mult( src_data[1], alpha );
+                dst_data[2] = fast_fractional_mult( dst_data[2], transparency ) + fast_fractional_mult( src_data[2], alpha );
+            }
+        }
+
+        src_data += 4;
+        dst_data += 3;
+    }
+}
+
+void copyLineScaled( const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len, S32 in_pixel_step, S32 out_pixel_step, S32 components )
+{
+    llassert( components >= 1 && components <= 4 );
+
+    const F32 ratio = F32(in_pixel_len) / out_pixel_len; // ratio of old to new
+    const F32 norm_factor = 1.f / ratio;
+
+    S32 goff = components >= 2 ? 1 : 0;
+    S32 boff = components >= 3 ? 2 : 0;
+    for( S32 x = 0; x < out_pixel_len; x++ )
+    {
+        // Sample input pixels in range from sample0 to sample1.
+        // Avoid floating point accumulation error... don't just add ratio each time.  JC
+        const F32 sample0 = x * ratio;
+        const F32 sample1 = (x+1) * ratio;
+        const S32 index0 = llfloor(sample0);            // left integer (floor)
+        const S32 index1 = llfloor(sample1);            // right integer (floor)
+        const F32 fract0 = 1.f - (sample0 - F32(index0));   // spill over on left
+        const F32 fract1 = sample1 - F32(index1);           // spill-over on right
+
+        if( index0 == index1 )
+        {
+            // Interval is embedded in one input pixel
+            S32 t0 = x * out_pixel_step * components;
+            S32 t1 = index0 * in_pixel_step * components;
+            U8* outp = out + t0;
+            const U8* inp = in + t1;
+            for (S32 i = 0; i < components; ++i)
+            {
+                *outp = *inp;
+                ++outp;
+                ++inp;
+            }
+        }
+        else
+        {
+            // Left straddle
+            S32 t1 = index0 * in_pixel_step * components;
+            F32 r = in[t1 + 0] * fract0;
+            F32 g = in[t1 + goff] * fract0;
+            F32 b = in[t1 + boff] * fract0;
+            F32 a = 0;
+            if( components == 4)
+            {
+                a = in[t1 + 3] * fract0;
+            }
+
+            // Central interval
+            if (components < 4)
+            {
+                for( S32 u = index0 + 1; u < index1; u++ )
+                {
+                    S32 t2 = u * in_pixel_step * components;
+                    r += in[t2 + 0];
+                    g += in[t2 + goff];
+                    b += in[t2 + boff];
+                }
+            }
+            else
+            {
+                for( S32 u = index0 + 1; u < index1; u++ )
+                {
+                    S32 t2 = u * in_pixel_step * components;
+                    r += in[t2 + 0];
+                    g += in[t2 + 1];
+                    b += in[t2 + 2];
+                    a += in[t2 + 3];
+                }
+            }
+
+            // right straddle
+            // Watch out for reading off of end of input array.
+            if( fract1 && index1 < in_pixel_len )
+            {
+                S32 t3 = index1 * in_pixel_step * components;
+                if (components < 4)
+                {
+                    U8 in0 = in[t3 + 0];
+                    U8 in1 = in[t3 + goff];
+                    U8 in2 = in[t3 + boff];
+                    r += in0 * fract1;
+                    g += in1 * fract1;
+                    b += in2 * fract1;
+                }
+                else
+                {
+                    U8 in0 = in[t3 + 0];
+                    U8 in1 = in[t3 + 1];
+                    U8 in2 = in[t3 + 2];
+                    U8 in3 = in[t3 + 3];
+                    r += in0 * fract1;
+                    g += in1 * fract1;
+                    b += in2 * fract1;
+                    a += in3 * fract1;
+                }
+            }
+
+            r *= norm_factor;
+            g *= norm_factor;
+            b *= norm_factor;
+            a *= norm_factor;  // skip conditional
+
+            S32 t4 = x * out_pixel_step * components;
+            out[t4 + 0] = U8(ll_round(r));
+            if (components >= 2)
+                out[t4 + 1] = U8(ll_round(g));
+            if (components >= 3)
+                out[t4 + 2] = U8(ll_round(b));
+            if( components == 4)
+                out[t4 + 3] = U8(ll_round(a));
+        }
+    }
+}
+
+void compositeRowScaled4onto3( const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len )
+{
+    const S32 IN_COMPONENTS = 4;
+    const S32 OUT_COMPONENTS = 3;
+
+    const F32 ratio = F32(in_pixel_len) / out_pixel_len; // ratio of old to new
+    const F32 norm_factor = 1.f / ratio;
+
+    for( S32 x = 0; x < out_pixel_len; x++ )
+    {
+        // Sample input pixels in range from sample0 to sample1.
+        // Avoid floating point accumulation error... don't just add ratio each time.  JC
+        const F32 sample0 = x * ratio;
+        const F32 sample1 = (x+1) * ratio;
+        const S32 index0 = S32(sample0);            // left integer (floor)
+        const S32 index1 = S32(sample1);            // right integer (floor)
+        const F32 fract0 = 1.f - (sample0 - F32(index0));   // spill over on left
+        const F32 fract1 = sample1 - F32(index1);           // spill-over on right
+
+        U8 in_scaled_r;
+        U8 in_scaled_g;
+        U8 in_scaled_b;
+        U8 in_scaled_a;
+
+        if( index0 == index1 )
+        {
+            // Interval is embedded in one input pixel
+            S32 t1 = index0 * IN_COMPONENTS;
+            in_scaled_r = in[t1 + 0];
+            in_scaled_g = in[t1 + 0];
+            in_scaled_b = in[t1 + 0];
+            in_scaled_a = in[t1 + 0];
+        }
+        else
+        {
+            // Left straddle
+            S32 t1 = index0 * IN_COMPONENTS;
+            F32 r = in[t1 + 0] * fract0;
+            F32 g = in[t1 + 1] * fract0;
+            F32 b = in[t1 + 2] * fract0;
+            F32 a = in[t1 + 3] * fract0;
+
+            // Central interval
+            for( S32 u = index0 + 1; u < index1; u++ )
+            {
+                S32 t2 = u * IN_COMPONENTS;
+                r += in[t2 + 0];
+                g += in[t2 + 1];
+                b += in[t2 + 2];
+                a += in[t2 + 3];
+            }
+
+            // right straddle
+            // Watch out for reading off of end of input array.
+            if( fract1 && index1 < in_pixel_len )
+            {
+                S32 t3 = index1 * IN_COMPONENTS;
+                r += in[t3 + 0] * fract1;
+                g += in[t3 + 1] * fract1;
+                b += in[t3 + 2] * fract1;
+                a += in[t3 + 3] * fract1;
+            }
+
+            r *= norm_factor;
+            g *= norm_factor;
+            b *= norm_factor;
+            a *= norm_factor;
+
+            in_scaled_r = U8(ll_round(r));
+            in_scaled_g = U8(ll_round(g));
+            in_scaled_b = U8(ll_round(b));
+            in_scaled_a = U8(ll_round(a));
+        }
+
+        if( in_scaled_a )
+        {
+            if( 255 == in_scaled_a )
+            {
+                out[0] = in_scaled_r;
+                out[1] = in_scaled_g;
+                out[2] = in_scaled_b;
+            }
+            else
+            {
+                U8 transparency = 255 - in_scaled_a;
+                out[0] = fast_fractional_mult( out[0], transparency ) + fast_fractional_mult( in_scaled_r, in_scaled_a );
+                out[1] = fast_fractional_mult( out[1], transparency ) + fast_fractional_mult( in_scaled_g, in_scaled_a );
+                out[2] = fast_fractional_mult( out[2], transparency ) + fast_fractional_mult( in_scaled_b, in_scaled_a );
+            }
+        }
+        out += OUT_COMPONENTS;
+    }
+}
+
+void downsample2x2(const U8* row0, const U8* row1, U8* dst, S32 dst_width, S32 components)
+{
+    for (S32 x = 0; x < dst_width; ++x)
+    {
+        for (S32 c = 0; c < components; ++c)
+        {
+            *dst++ = (U8)(((U32)(row0[c]) + row0[components + c] + row1[c] + row1[components + c]) >> 2);
+        }
+        row0 += components * 2;
+        row1 += components * 2;
+    }
+}
+
+void downsample2x2U16(const U16* row0, const U16* row1, U16* dst, S32 dst_width, S32 components)
+{
+    for (S32 x = 0; x < dst_width; ++x)
+    {
+        for (S32 c = 0; c < components; ++c)
+        {
+            *dst++ = (U16)(((U32)(row0[c]) + row0[components + c] + row1[c] + row1[components + c] + 2) >> 2);
+        }
+        row0 += components * 2;
+        row1 += components * 2;
+    }
+}
+} // anonymous namespace
+
+const Kernels* getKernels()
+{
+    static const Kernels sKernels =
+    {
+        fill,
+        tint,
+        copy4onto3,
+        copy3onto4,
+        composite4onto3,
+        copyLineScaled,
+        compositeRowScaled4onto3,
+        bilinearScale,
+        downsample2x2,
+        downsample2x2U16
+    };
+    return &sKernels;
+}
+} // namespace scalar
+} // namespace LLImageSIMD
+
+#if LL_IMAGE_SIMD_X86
+#define LL_IMAGE_SIMD_NS sse2
+#include "llimagesimdimpl.h"
+#undef LL_IMAGE_SIMD_NS
+
+namespace LLImageSIMD
+{
+    // llimagesimdavx2.cpp
+    namespace avx2
+    {
+        const Kernels* getKernels();
+    }
+}
+#endif // LL_IMAGE_SIMD_X86
+
+#if defined(__ARM_NEON)
+// NEON's interleaving loads and stores do the channel shuffles directly; the
+// box filters, bilinear scaling and mip downsampling stay scalar on ARM for
+// now.
+namespace LLImageSIMD
+{
+namespace neon
+{
+namespace
+{
+    void fill(U8* data, S32 pixels, S32 components, const U8* color)
+    {
+        S32 i = 0;
+        if (4 == components)
+        {
+            const uint8x16x4_t v = { { vdupq_n_u8(color[0]), vdupq_n_u8(color[1]), vdupq_n_u8(color[2]), vdupq_n_u8(color[3]) } };
+            for (; i + 16 <= pixels; i += 16)
+            {
+                vst4q_u8(data + i * 4, v);
+            }
+        }
+        else if (3 == components)
+        {
+            const uint8x16x3_t v = { { vdupq_n_u8(color[0]), vdupq_n_u8(color[1]), vdupq_n_u8(color[2]) } };
+            for (; i + 16 <= pixels; i += 16)
+            {
+                vst3q_u8(data + i * 3, v);
+            }
+        }
+        else
+        {
+            return;
+        }
+        scalar::getKernels()->fill(data + i * components, pixels - i, components, color);
+    }
+
+    void copy4onto3(const U8* src, U8* dst, S32 pixels)
+    {
+        S32 i = 0;
+        for (; i + 16 <= pixels; i += 16)
+        {
+            const uint8x16x4_t s = vld4q_u8(src + i * 4);
+            const uint8x16x3_t d = { { s.val[0], s.val[1], s.val[2] } };
+            vst3q_u8(dst + i * 3, d);
+        }
+        scalar::getKernels()->copy4onto3(src + i * 4, dst + i * 3, pixels - i);
+    }
+
+    void copy3onto4(const U8* src, U8* dst, S32 pixels)
+    {
+        S32 i = 0;
+        for (; i + 16 <= pixels; i += 16)
+        {
+            const uint8x16x3_t s = vld3q_u8(src + i * 3);
+            const uint8x16x4_t d = { { s.val[0], s.val[1], s.val[2], vdupq_n_u8(255) } };
+            vst4q_u8(dst + i * 4, d);
+        }
+        scalar::getKernels()->copy3onto4(src + i * 3, dst + i * 4, pixels - i);
+    }
+
+    // fast_fractional_mult() on 8 lanes
+    inline uint16x8_t fractional_mult(uint8x8_t a, uint8x8_t b)
+    {
+        const uint16x8_t i = vaddq_u16(vmull_u8(a, b), vdupq_n_u16(128));
+        return vshrq_n_u16(vaddq_u16(i, vshrq_n_u16(i, 8)), 8);
+    }
+
+    inline uint8x16_t blend(uint8x16_t dst, uint8x16_t src, uint8x16_t alpha, uint8x16_t transparency)
+    {
+        const uint16x8_t lo = vaddq_u16(fractional_mult(vget_low_u8(dst), vget_low_u8(transparency)),
+                                        fractional_mult(vget_low_u8(src), vget_low_u8(alpha)));
+        const uint16x8_t hi = vaddq_u16(fractional_mult(vget_high_u8(dst), vget_high_u8(transparency)),
+                                        fractional_mult(vget_high_u8(src), vget_high_u8(alpha)));
+        return vcombine_u8(vmovn_u16(lo), vmovn_u16(hi));
+    }
+
+    // Branchless: alpha 0 and 255 come out of the blend unchanged, as the
+    // scalar version's special cases do.
+    void composite4onto3(const U8* src, U8* dst, S32 pixels)
+    {
+        S32 i = 0;
+        for (; i + 16 <= pixels; i += 16)
+        {
+            const uint8x16x4_t s = vld4q_u8(src + i * 4);
+            uint8x16x3_t d = vld3q_u8(dst + i * 3);
+            const uint8x16_t transparency = vmvnq_u8(s.val[3]);
+            d.val[0] = blend(d.val[0], s.val[0], s.val[3], transparency);
+            d.val[1] = blend(d.val[1], s.val[1], s.val[3], transparency);
+            d.val[2] = blend(d.val[2], s.val[2], s.val[3], transparency);
+            vst3q_u8(dst + i * 3, d);
+        }
+        scalar::getKernels()->composite4onto3(src + i * 4, dst + i * 3, pixels - i);
+    }
+} // anonymous namespace
+
+    const Kernels* getKernels()
+    {
+        const Kernels* reference = scalar::getKernels();
+        static const Kernels sKernels =
+        {
+            fill,
+            reference->tint,
+            copy4onto3,
+            copy3onto4,
+            composite4onto3,
+            reference->copyLineScaled,
+            reference->compositeRowScaled4onto3,
+            reference->bilinearScale,
+            reference->downsample2x2,
+            reference->downsample2x2U16
+        };
+        return &sKernels;
+    }
+} // namespace neon
+} // namespace LLImageSIMD
+#endif // __ARM_NEON
+
+namespace LLImageSIMD
+{
+namespace
+{
+    bool cpu_has_avx2()
+    {
+#if ! LL_IMAGE_SIMD_X86
+        return false;
+#elif LL_WINDOWS
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+        // the OS must also save the YMM registers on context switches
+        __cpuid(info, 1);
+        const int OSXSAVE = 1 << 27, AVX = 1 << 28;
+        if ((info[2] & (OSXSAVE | AVX)) != (OSXSAVE | AVX) || (_xgetbv(0) & 6) != 6)
+        {
+            return false;
+        }
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    const Kernels* kernels_for(ELevel level)
+    {
+        static const bool sHasAVX2 = cpu_has_avx2();
+        switch (level)
+        {
+        case SCALAR:
+            return scalar::getKernels();
+#if LL_IMAGE_SIMD_X86
+        case SSE2:
+            // every x86 build targets SSE2
+            return sse2::getKernels();
+        case AVX2:
+            return sHasAVX2 ? avx2::getKernels() : NULL;
+#endif
+#if defined(__ARM_NEON)
+        case NEON:
+            return neon::getKernels();
+#endif
+        default:
+            return NULL;
+        }
+    }
+
+    std::atomic<ELevel>& current_level()
+    {
+        static std::atomic<ELevel> sLevel(getBestLevel());
+        return sLevel;
+    }
+} // anonymous namespace
+
+const Kernels& get()
+{
+    return *kernels_for(current_level().load(std::memory_order_relaxed));
+}
+
+ELevel getLevel()
+{
+    return current_level().load(std::memory_order_relaxed);
+}
+
+ELevel getBestLevel()
+{
+    for (S32 level = NUM_LEVELS - 1; level > SCALAR; --level)
+    {
+        if (isSupported(ELevel(level)))
+        {
+            return ELevel(level);
+        }
+    }
+    return SCALAR;
+}
+
+bool isSupported(ELevel level)
+{
+    return kernels_for(level) != NULL;
+}
+
+bool setLevel(ELevel level)
+{
+    if (! isSupported(level))
+    {
+        return false;
+    }
+    current_level().store(level, std::memory_order_relaxed);
+    return true;
+}
+
+const char* getLevelName(ELevel level)
+{
+    switch (level)
+    {
+    case SCALAR:    return "scalar";
+    case SSE2:      return "SSE2";
+    case AVX2:      return "AVX2";
+    case NEON:      return "NEON";
+    default:        return "unknown";
+    }
+}
+} // namespace LLImageSIMD
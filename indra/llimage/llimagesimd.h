@@ -0,0 +1,127 @@
+/**
+ * @file   llimagesimd.h
+ * @date   2026-10-18
+ * @brief  Vectorized pixel kernels for LLImageRaw with runtime CPU dispatch.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLIMAGESIMD_H
+#define LL_LLIMAGESIMD_H
+
+#include "stdtypes.h"
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LL_IMAGE_SIMD_X86 1
+#else
+#define LL_IMAGE_SIMD_X86 0
+#endif
+
+/**
+ * The per-pixel loops behind LLImageRaw's fill, tint, channel conversion,
+ * compositing and scaling, and behind LLImageBase's mip generation, in one
+ * table per instruction set. The best table the CPU supports is picked on
+ * first use; the scalar one stays available as the reference the vector
+ * versions are tested against.
+ *
+ * The integer kernels match the scalar ones bit for bit. The box filters
+ * (copyLineScaled, compositeRowScaled4onto3) do the same float operations in
+ * the same order, so they match too unless the compiler contracts the scalar
+ * version into fused multiply-adds.
+ */
+namespace LLImageSIMD
+{
+    enum ELevel
+    {
+        SCALAR,
+        SSE2,
+        AVX2,
+        NEON,
+        NUM_LEVELS
+    };
+
+    struct Kernels
+    {
+        // Set 3 or 4 component pixels to color[0..components).
+        void (*fill)(U8* data, S32 pixels, S32 components, const U8* color);
+        // Multiply the first 3 components of each pixel by color[0..2].
+        void (*tint)(U8* data, S32 pixels, S32 components, const F32* color);
+        void (*copy4onto3)(const U8* src, U8* dst, S32 pixels);
+        // Alpha is set to 255.
+        void (*copy3onto4)(const U8* src, U8* dst, S32 pixels);
+        // Blend 4 component src over 3 component dst.
+        void (*composite4onto3)(const U8* src, U8* dst, S32 pixels);
+        // Box filter one row or column; see LLImageRaw::copyLineScaled().
+        void (*copyLineScaled)(const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len,
+                               S32 in_pixel_step, S32 out_pixel_step, S32 components);
+        // Box filter a 4 component row and blend it over a 3 component row.
+        void (*compositeRowScaled4onto3)(const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len);
+        // Resample a 1, 3 or 4 component image.
+        void (*bilinearScale)(const U8* src, U32 srcW, U32 srcH, U32 srcStride,
+                              U8* dst, U32 dstW, U32 dstH, U32 dstStride, U32 components);
+        // Average the 2x2 blocks of two rows into dst_width pixels of 1 to 4
+        // components, rounding down as LLImageBase::generateMip() always has.
+        void (*downsample2x2)(const U8* row0, const U8* row1, U8* dst, S32 dst_width, S32 components);
+        // The same for 1, 2 or 4 component 16 bit values, rounding to nearest.
+        void (*downsample2x2U16)(const U16* row0, const U16* row1, U16* dst, S32 dst_width, S32 components);
+    };
+
+    // Kernels for the current level.
+    const Kernels& get();
+
+    ELevel getLevel();
+    // Best level this build and CPU support.
+    ELevel getBestLevel();
+    bool isSupported(ELevel level);
+    // Switch levels, e.g. to SCALAR for comparison. Returns false, leaving
+    // the level alone, if the build or CPU lacks the instruction set.
+    bool setLevel(ELevel level);
+    const char* getLevelName(ELevel level);
+
+    namespace scalar
+    {
+        // The reference kernels, which the vector tables also fall back on
+        // for cases they don't cover.
+        const Kernels* getKernels();
+    }
+
+    // Sample positions and weights for bilinearScale(), independent of the
+    // number of components. Fixed point as in imlib2, which it came from.
+    struct ScalePoints
+    {
+        ScalePoints(const U8* src, U32 srcW, U32 srcH, U32 dstW, U32 dstH, U32 srcStride);
+
+        std::vector<S32> xpoints;
+        std::vector<const U8*> ystrides;
+        std::vector<S32> xapoints, yapoints;
+        // bit 0: scaling up horizontally, bit 1: scaling up vertically
+        S32 xup_yup;
+
+    private:
+        void calc_x_points(U32 srcW, U32 dstW);
+        void calc_y_strides(const U8* src, U32 srcStride, U32 srcH, U32 dstH);
+        void calc_aa_points(U32 srcSz, U32 dstSz, bool scale_up, std::vector<S32>& vp);
+    };
+}
+
+#endif // LL_LLIMAGESIMD_H
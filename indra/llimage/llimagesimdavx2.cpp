@@ -0,0 +1,70 @@
+/**
+ * @file   llimagesimdavx2.cpp
+ * @date   2026-10-18
+ * @brief  AVX2 build of the LLImageSIMD kernels.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llimagesimd.h"
+
+#if LL_IMAGE_SIMD_X86
+// Everything the kernels include is pulled in first, outside the target
+// region, so that only the kernels themselves may use AVX2. They run only
+// once llimagesimd.cpp has checked the CPU.
+#include "llmath.h"
+#include <cstring>
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#define LL_IMAGE_SIMD_NS avx2
+#define LL_IMAGE_SIMD_AVX2 1
+#include "llimagesimdimpl.h"
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#else // ! LL_IMAGE_SIMD_X86
+
+namespace LLImageSIMD
+{
+namespace avx2
+{
+    const Kernels* getKernels()
+    {
+        return NULL;
+    }
+}
+}
+
+#endif // LL_IMAGE_SIMD_X86
@@ -0,0 +1,895 @@
+/**
+ * @file   llimagesimdimpl.h
+ * @date   2026-10-18
+ * @brief  x86 vector kernels, compiled once per instruction set.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// No include guard: llimagesimd.cpp includes this for the SSE2 baseline and
+// llimagesimdavx2.cpp again under a target("avx2") pragma with
+// LL_IMAGE_SIMD_AVX2 set. Each defines its own LL_IMAGE_SIMD_NS, and the
+// kernels sit in an anonymous namespace, so no function compiled for AVX2
+// can be picked by the linker for a caller on the SSE2 path.
+#if ! defined(LL_IMAGE_SIMD_NS)
+#error "Define LL_IMAGE_SIMD_NS before including llimagesimdimpl.h"
+#endif
+#if ! defined(LL_IMAGE_SIMD_AVX2)
+#define LL_IMAGE_SIMD_AVX2 0
+#endif
+
+#include "llimagesimd.h"
+#include "llmath.h"
+
+#include <cstring>
+#include <emmintrin.h>
+#if LL_IMAGE_SIMD_AVX2
+#include <immintrin.h>
+#endif
+
+namespace LLImageSIMD
+{
+namespace LL_IMAGE_SIMD_NS
+{
+namespace
+{
+    inline U32 load_u32(const U8* p) { U32 v; memcpy(&v, p, sizeof(v)); return v; }
+    inline U64 load_u64(const U8* p) { U64 v; memcpy(&v, p, sizeof(v)); return v; }
+    inline void store_u32(U8* p, U32 v) { memcpy(p, &v, sizeof(v)); }
+    inline void store_u64(U8* p, U64 v) { memcpy(p, &v, sizeof(v)); }
+
+    inline U8 fast_fractional_mult(U8 a, U8 b)
+    {
+        U32 i = a * b + 128;
+        return U8((i + (i >> 8)) >> 8);
+    }
+
+    // 4 pixels of 3 components to 4 components, alpha left 0 (or'ed in by callers)
+    inline void expand_3to4(const U8* src, U8* dst)
+    {
+        const U64 a = load_u64(src);
+        const U32 b = load_u32(src + 8);
+        store_u64(dst, (a & 0xffffff) | ((a << 8) & 0x00ffffff00000000ULL));
+        store_u64(dst + 8, (a >> 48) | (U64(b & 0xff) << 16) | (U64(b >> 8) << 32));
+    }
+
+    // 4 pixels of 4 components to 3 components
+    inline void compact_4to3(const U8* src, U8* dst)
+    {
+        const U64 a = load_u64(src);
+        const U64 b = load_u64(src + 8);
+        store_u64(dst, (a & 0xffffff) | ((a >> 8) & 0x0000ffffff000000ULL) | (b << 48));
+        store_u32(dst + 8, U32((b >> 16) & 0xff) | U32(((b >> 32) & 0xffffff) << 8));
+    }
+
+#if LL_IMAGE_SIMD_AVX2
+    // AVX2 implies SSSE3 and SSE4.1: byte shuffles do the (de)interleaving.
+    inline __m128i rgba_to_rgb_mask()
+    {
+        return _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    }
+
+    inline __m128i rgb_to_rgba_mask()
+    {
+        return _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    }
+
+    // 16 pixels of 4 components, shuffled to 12 bytes each, into 48 bytes
+    inline void store_rgb16(U8* dst, __m128i a, __m128i b, __m128i c, __m128i d)
+    {
+        _mm_storeu_si128((__m128i*)dst, _mm_or_si128(a, _mm_slli_si128(b, 12)));
+        _mm_storeu_si128((__m128i*)(dst + 16), _mm_or_si128(_mm_srli_si128(b, 4), _mm_slli_si128(c, 8)));
+        _mm_storeu_si128((__m128i*)(dst + 32), _mm_or_si128(_mm_srli_si128(c, 8), _mm_slli_si128(d, 4)));
+    }
+
+    // 48 bytes of 3 component pixels into 4 vectors of 4 pixels
+    inline void load_rgb16(const U8* src, __m128i out[4])
+    {
+        const __m128i mask = rgb_to_rgba_mask();
+        const __m128i a = _mm_loadu_si128((const __m128i*)src);
+        const __m128i b = _mm_loadu_si128((const __m128i*)(src + 16));
+        const __m128i c = _mm_loadu_si128((const __m128i*)(src + 32));
+        out[0] = _mm_shuffle_epi8(a, mask);
+        out[1] = _mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), mask);
+        out[2] = _mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), mask);
+        out[3] = _mm_shuffle_epi8(_mm_srli_si128(c, 4), mask);
+    }
+#endif
+
+    //------------------------------------------------------------------------
+    // fill
+    //------------------------------------------------------------------------
+    void fill(U8* data, S32 pixels, S32 components, const U8* color)
+    {
+        if (components != 3 && components != 4)
+        {
+            return;
+        }
+
+        // 96 bytes hold a whole number of 3 or 4 byte pixels and of vectors
+        alignas(32) U8 pattern[96];
+        for (S32 i = 0; i < 96; ++i)
+        {
+            pattern[i] = color[i % components];
+        }
+
+        U8* p = data;
+        U8* const end = data + (size_t)pixels * components;
+#if LL_IMAGE_SIMD_AVX2
+        const __m256i v0 = _mm256_load_si256((const __m256i*)pattern);
+        const __m256i v1 = _mm256_load_si256((const __m256i*)(pattern + 32));
+        const __m256i v2 = _mm256_load_si256((const __m256i*)(pattern + 64));
+        for (; end - p >= 96; p += 96)
+        {
+            _mm256_storeu_si256((__m256i*)p, v0);
+            _mm256_storeu_si256((__m256i*)(p + 32), v1);
+            _mm256_storeu_si256((__m256i*)(p + 64), v2);
+        }
+#else
+        __m128i v[6];
+        for (S32 i = 0; i < 6; ++i)
+        {
+            v[i] = _mm_load_si128((const __m128i*)(pattern + 16 * i));
+        }
+        for (; end - p >= 96; p += 96)
+        {
+            for (S32 i = 0; i < 6; ++i)
+            {
+                _mm_storeu_si128((__m128i*)(p + 16 * i), v[i]);
+            }
+        }
+#endif
+        // every 96 bytes start on a pixel, so the pattern lines up again
+        memcpy(p, pattern, end - p);
+    }
+
+    //------------------------------------------------------------------------
+    // tint
+    //------------------------------------------------------------------------
+    void tint(U8* data, S32 pixels, S32 components, const F32* color)
+    {
+        // 48 bytes hold a whole number of pixels and of vectors; each byte
+        // gets the multiplier for its channel, 1 for alpha.
+        alignas(16) F32 mult[48];
+        for (S32 i = 0; i < 48; ++i)
+        {
+            const S32 c = i % components;
+            mult[i] = c < 3 ? color[c] : 1.f;
+        }
+
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 lo_clamp = _mm_setzero_ps();
+        const __m128 hi_clamp = _mm_set1_ps(255.f);
+        U8* p = data;
+        U8* const end = data + (size_t)pixels * components;
+        for (; end - p >= 48; p += 48)
+        {
+            for (S32 v = 0; v < 3; ++v)
+            {
+                const __m128i bytes = _mm_loadu_si128((const __m128i*)(p + 16 * v));
+                const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+                const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+                __m128i q[4] = { _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+                                 _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero) };
+                for (S32 k = 0; k < 4; ++k)
+                {
+                    __m128 f = _mm_mul_ps(_mm_cvtepi32_ps(q[k]), _mm_load_ps(mult + 16 * v + 4 * k));
+                    f = _mm_min_ps(_mm_max_ps(f, lo_clamp), hi_clamp);
+                    q[k] = _mm_cvttps_epi32(f);
+                }
+                _mm_storeu_si128((__m128i*)(p + 16 * v),
+                                 _mm_packus_epi16(_mm_packs_epi32(q[0], q[1]), _mm_packs_epi32(q[2], q[3])));
+            }
+        }
+        for (S32 i = 0; p < end; ++p, ++i)
+        {
+            *p = U8(llclamp(*p * mult[i], 0.f, 255.f));
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // channel conversion
+    //------------------------------------------------------------------------
+    void copy4onto3(const U8* src, U8* dst, S32 pixels)
+    {
+        S32 i = 0;
+#if LL_IMAGE_SIMD_AVX2
+        const __m128i mask = rgba_to_rgb_mask();
+        for (; i + 16 <= pixels; i += 16, src += 64, dst += 48)
+        {
+            store_rgb16(dst,
+                        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), mask),
+                        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + 16)), mask),
+                        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + 32)), mask),
+                        _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + 48)), mask));
+        }
+#endif
+        for (; i + 4 <= pixels; i += 4, src += 16, dst += 12)
+        {
+            compact_4to3(src, dst);
+        }
+        for (; i < pixels; ++i, src += 4, dst += 3)
+        {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+        }
+    }
+
+    void copy3onto4(const U8* src, U8* dst, S32 pixels)
+    {
+        S32 i = 0;
+#if LL_IMAGE_SIMD_AVX2
+        const __m128i alpha = _mm_set1_epi32((int)0xff000000);
+        for (; i + 16 <= pixels; i += 16, src += 48, dst += 64)
+        {
+            __m128i rgba[4];
+            load_rgb16(src, rgba);
+            for (S32 k = 0; k < 4; ++k)
+            {
+                _mm_storeu_si128((__m128i*)(dst + 16 * k), _mm_or_si128(rgba[k], alpha));
+            }
+        }
+#endif
+        for (; i + 4 <= pixels; i += 4, src += 12, dst += 16)
+        {
+            expand_3to4(src, dst);
+            store_u64(dst, load_u64(dst) | 0xff000000ff000000ULL);
+            store_u64(dst + 8, load_u64(dst + 8) | 0xff000000ff000000ULL);
+        }
+        for (; i < pixels; ++i, src += 3, dst += 4)
+        {
+            dst[0] = src[0];
+            dst[1] = src[1];
+            dst[2] = src[2];
+            dst[3] = 255;
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // compositing
+    //------------------------------------------------------------------------
+
+#if LL_IMAGE_SIMD_AVX2
+    // (a * b + 128 + ((a * b + 128) >> 8)) >> 8 on 16 bit lanes, as
+    // fast_fractional_mult(); a * b + 128 never exceeds 16 bits.
+    inline __m128i fractional_mult_epi16(__m128i a, __m128i b)
+    {
+        const __m128i i = _mm_add_epi16(_mm_mullo_epi16(a, b), _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(i, _mm_srli_epi16(i, 8)), 8);
+    }
+
+    // Blend 4 RGBA src pixels over 4 dst pixels held in 4 byte slots. With
+    // alpha 0 and 255 the formula gives back dst and src exactly, so no
+    // branches are needed to match the scalar code.
+    inline __m128i blend4(__m128i src, __m128i dst)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i full = _mm_set1_epi16(255);
+        const __m128i s_lo = _mm_unpacklo_epi8(src, zero);
+        const __m128i s_hi = _mm_unpackhi_epi8(src, zero);
+        const __m128i a_lo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128i a_hi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s_hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128i r_lo = _mm_add_epi16(fractional_mult_epi16(_mm_unpacklo_epi8(dst, zero), _mm_sub_epi16(full, a_lo)),
+                                           fractional_mult_epi16(s_lo, a_lo));
+        const __m128i r_hi = _mm_add_epi16(fractional_mult_epi16(_mm_unpackhi_epi8(dst, zero), _mm_sub_epi16(full, a_hi)),
+                                           fractional_mult_epi16(s_hi, a_hi));
+        return _mm_packus_epi16(r_lo, r_hi);
+    }
+
+    // Only built with pshufb: repacking 3 byte pixels with plain SSE2 costs
+    // more than the blend saves, so the SSE2 table uses the scalar loop.
+    void composite4onto3(const U8* src, U8* dst, S32 pixels)
+    {
+        S32 i = 0;
+        const __m128i mask = rgba_to_rgb_mask();
+        for (; i + 16 <= pixels; i += 16, src += 64, dst += 48)
+        {
+            __m128i d[4];
+            load_rgb16(dst, d);
+            for (S32 k = 0; k < 4; ++k)
+            {
+                d[k] = _mm_shuffle_epi8(blend4(_mm_loadu_si128((const __m128i*)(src + 16 * k)), d[k]), mask);
+            }
+            store_rgb16(dst, d[0], d[1], d[2], d[3]);
+        }
+        scalar::getKernels()->composite4onto3(src, dst, pixels - i);
+    }
+#endif // LL_IMAGE_SIMD_AVX2
+
+    //------------------------------------------------------------------------
+    // box filters: one pixel's components per vector
+    //------------------------------------------------------------------------
+    template<S32 C>
+    inline __m128i load_pixel_epi32(const U8* p)
+    {
+        U32 v;
+        if (C == 4)
+        {
+            v = load_u32(p);
+        }
+        else
+        {
+            v = p[0];
+            if (C > 1) v |= U32(p[1]) << 8;
+            if (C > 2) v |= U32(p[2]) << 16;
+        }
+        const __m128i zero = _mm_setzero_si128();
+        return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)v), zero), zero);
+    }
+
+    template<S32 C>
+    inline __m128 load_pixel_ps(const U8* p)
+    {
+        return _mm_cvtepi32_ps(load_pixel_epi32<C>(p));
+    }
+
+    // low byte of each lane, as the scalar code's U8 casts and & 0xff
+    inline U32 pack_low_bytes(__m128i v)
+    {
+        v = _mm_and_si128(v, _mm_set1_epi32(0xff));
+        v = _mm_packs_epi32(v, v);
+        return (U32)_mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+    }
+
+    template<S32 C>
+    inline void store_pixel(U8* p, U32 v)
+    {
+        if (C == 4)
+        {
+            store_u32(p, v);
+        }
+        else
+        {
+            p[0] = U8(v);
+            if (C > 1) p[1] = U8(v >> 8);
+            if (C > 2) p[2] = U8(v >> 16);
+        }
+    }
+
+    // U8(ll_round(v)) per lane; the filtered values are never negative, so
+    // truncating v + 0.5 is the floor.
+    inline U32 round_to_bytes(__m128 v)
+    {
+        return pack_low_bytes(_mm_cvttps_epi32(_mm_add_ps(v, _mm_set1_ps(0.5f))));
+    }
+
+    template<S32 C>
+    void copy_line_scaled(const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len, S32 in_pixel_step, S32 out_pixel_step)
+    {
+        const F32 ratio = F32(in_pixel_len) / out_pixel_len; // ratio of old to new
+        const F32 norm_factor = 1.f / ratio;
+        const __m128 norm = _mm_set1_ps(norm_factor);
+        const S32 in_stride = in_pixel_step * C;
+
+        for (S32 x = 0; x < out_pixel_len; x++)
+        {
+            const F32 sample0 = x * ratio;
+            const F32 sample1 = (x + 1) * ratio;
+            const S32 index0 = llfloor(sample0);
+            const S32 index1 = llfloor(sample1);
+            const F32 fract0 = 1.f - (sample0 - F32(index0));
+            const F32 fract1 = sample1 - F32(index1);
+
+            U8* outp = out + x * out_pixel_step * C;
+            const U8* inp = in + index0 * in_stride;
+            if (index0 == index1)
+            {
+                for (S32 i = 0; i < C; ++i)
+                {
+                    outp[i] = inp[i];
+                }
+                continue;
+            }
+
+            __m128 sum = _mm_mul_ps(load_pixel_ps<C>(inp), _mm_set1_ps(fract0));
+            for (S32 u = index0 + 1; u < index1; u++)
+            {
+                inp += in_stride;
+                sum = _mm_add_ps(sum, load_pixel_ps<C>(inp));
+            }
+            if (fract1 && index1 < in_pixel_len)
+            {
+                sum = _mm_add_ps(sum, _mm_mul_ps(load_pixel_ps<C>(in + index1 * in_stride), _mm_set1_ps(fract1)));
+            }
+            store_pixel<C>(outp, round_to_bytes(_mm_mul_ps(sum, norm)));
+        }
+    }
+
+    void copyLineScaled(const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len,
+                        S32 in_pixel_step, S32 out_pixel_step, S32 components)
+    {
+        switch (components)
+        {
+        case 1:
+            copy_line_scaled<1>(in, out, in_pixel_len, out_pixel_len, in_pixel_step, out_pixel_step);
+            break;
+        case 2:
+            copy_line_scaled<2>(in, out, in_pixel_len, out_pixel_len, in_pixel_step, out_pixel_step);
+            break;
+        case 3:
+            copy_line_scaled<3>(in, out, in_pixel_len, out_pixel_len, in_pixel_step, out_pixel_step);
+            break;
+        case 4:
+            copy_line_scaled<4>(in, out, in_pixel_len, out_pixel_len, in_pixel_step, out_pixel_step);
+            break;
+        default:
+            llassert(!"Unsupported component count");
+            break;
+        }
+    }
+
+    void compositeRowScaled4onto3(const U8* in, U8* out, S32 in_pixel_len, S32 out_pixel_len)
+    {
+        const F32 ratio = F32(in_pixel_len) / out_pixel_len; // ratio of old to new
+        const F32 norm_factor = 1.f / ratio;
+        const __m128 norm = _mm_set1_ps(norm_factor);
+
+        for (S32 x = 0; x < out_pixel_len; x++, out += 3)
+        {
+            const F32 sample0 = x * ratio;
+            const F32 sample1 = (x + 1) * ratio;
+            const S32 index0 = S32(sample0);
+            const S32 index1 = S32(sample1);
+            const F32 fract0 = 1.f - (sample0 - F32(index0));
+            const F32 fract1 = sample1 - F32(index1);
+
+            U8 scaled[4];
+            if (index0 == index1)
+            {
+                // as the scalar version: all four from the first component
+                scaled[0] = scaled[1] = scaled[2] = scaled[3] = in[index0 * 4];
+            }
+            else
+            {
+                const U8* inp = in + index0 * 4;
+                __m128 sum = _mm_mul_ps(load_pixel_ps<4>(inp), _mm_set1_ps(fract0));
+                for (S32 u = index0 + 1; u < index1; u++)
+                {
+                    inp += 4;
+                    sum = _mm_add_ps(sum, load_pixel_ps<4>(inp));
+                }
+                if (fract1 && index1 < in_pixel_len)
+                {
+                    sum = _mm_add_ps(sum, _mm_mul_ps(load_pixel_ps<4>(in + index1 * 4), _mm_set1_ps(fract1)));
+                }
+                store_u32(scaled, round_to_bytes(_mm_mul_ps(sum, norm)));
+            }
+
+            const U8 alpha = scaled[3];
+            if (alpha)
+            {
+                if (255 == alpha)
+                {
+                    out[0] = scaled[0];
+                    out[1] = scaled[1];
+                    out[2] = scaled[2];
+                }
+                else
+                {
+                    const U8 transparency = 255 - alpha;
+                    out[0] = fast_fractional_mult(out[0], transparency) + fast_fractional_mult(scaled[0], alpha);
+                    out[1] = fast_fractional_mult(out[1], transparency) + fast_fractional_mult(scaled[1], alpha);
+                    out[2] = fast_fractional_mult(out[2], transparency) + fast_fractional_mult(scaled[2], alpha);
+                }
+            }
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // bilinear scale: the scalar algorithm with one pixel's components per
+    // vector of 32 bit lanes
+    //------------------------------------------------------------------------
+
+    // pixel * weight for pixels freshly loaded (< 256) and weights below
+    // 2^15, which all first stage weights are: one madd per pixel.
+    inline __m128i mul_px(__m128i px, S32 weight)
+    {
+        return _mm_madd_epi16(px, _mm_set1_epi32(weight));
+    }
+
+    // 32 bit products for the second stage sums
+    inline __m128i mul32(__m128i a, S32 s)
+    {
+#if LL_IMAGE_SIMD_AVX2
+        return _mm_mullo_epi32(a, _mm_set1_epi32(s));
+#else
+        const __m128i b = _mm_set1_epi32(s);
+        const __m128i even = _mm_mul_epu32(a, b);
+        const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), b);
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+    }
+
+    template<U32 ch>
+    inline void store_px(U8*& dptr, __m128i v)
+    {
+        store_pixel<ch>(dptr, pack_low_bytes(v));
+        dptr += ch;
+    }
+
+    // sum of one source row across a downscaled destination pixel
+    template<U32 ch>
+    inline __m128i row_sum(const U8* pix, S32 Cx, S32 xap)
+    {
+        __m128i cx = mul_px(load_pixel_epi32<ch>(pix), xap);
+        pix += ch;
+        S32 i;
+        for (i = (1 << 14) - xap; i > Cx; i -= Cx)
+        {
+            cx = _mm_add_epi32(cx, mul_px(load_pixel_epi32<ch>(pix), Cx));
+            pix += ch;
+        }
+        if (i > 0)
+        {
+            cx = _mm_add_epi32(cx, mul_px(load_pixel_epi32<ch>(pix), i));
+        }
+        return cx;
+    }
+
+    // sum of one source column across a downscaled destination pixel
+    template<U32 ch>
+    inline __m128i column_sum(const U8* pix, U32 srcStride, S32 Cy, S32 yap)
+    {
+        __m128i sum = mul_px(load_pixel_epi32<ch>(pix), yap);
+        pix += srcStride;
+        S32 j;
+        for (j = (1 << 14) - yap; j > Cy; j -= Cy)
+        {
+            sum = _mm_add_epi32(sum, mul_px(load_pixel_epi32<ch>(pix), Cy));
+            pix += srcStride;
+        }
+        if (j > 0)
+        {
+            sum = _mm_add_epi32(sum, mul_px(load_pixel_epi32<ch>(pix), j));
+        }
+        return sum;
+    }
+
+    template<U32 ch>
+    void bilinear_scale(const U8* src, U32 srcW, U32 srcH, U32 srcStride,
+                        U8* dst, U32 dstW, U32 dstH, U32 dstStride)
+    {
+        const ScalePoints info(src, srcW, srcH, dstW, dstH, srcStride);
+
+        if (3 == info.xup_yup)
+        { // scale x/y - up
+            for (U32 y = 0; y < dstH; ++y)
+            {
+                U8* dptr = dst + (y * dstStride);
+                const U8* sptr = info.ystrides[y];
+                const S32 ya = info.yapoints[y];
+
+                for (U32 x = 0; x < dstW; ++x)
+                {
+                    const S32 xa = info.xapoints[x];
+                    const U8* pix = sptr + info.xpoints[x] * ch;
+                    if (0 < ya && 0 < xa)
+                    {
+                        __m128i comp = _mm_add_epi32(mul_px(load_pixel_epi32<ch>(pix), 256 - xa),
+                                                     mul_px(load_pixel_epi32<ch>(pix + ch), xa));
+                        __m128i cx = _mm_add_epi32(mul_px(load_pixel_epi32<ch>(pix + srcStride + ch), xa),
+                                                   mul_px(load_pixel_epi32<ch>(pix + srcStride), 256 - xa));
+                        store_px<ch>(dptr, _mm_srai_epi32(_mm_add_epi32(mul32(cx, ya), mul32(comp, 256 - ya)), 16));
+                    }
+                    else if (0 < ya)
+                    {
+                        __m128i comp = mul_px(load_pixel_epi32<ch>(pix), 256 - ya);
+                        comp = _mm_add_epi32(comp, mul_px(load_pixel_epi32<ch>(pix + srcStride), ya));
+                        store_px<ch>(dptr, _mm_srai_epi32(comp, 8));
+                    }
+                    else if (0 < xa)
+                    {
+                        // the scalar version weights the same pixel twice here
+                        const __m128i px = load_pixel_epi32<ch>(pix);
+                        store_px<ch>(dptr, _mm_srai_epi32(_mm_add_epi32(mul_px(px, 256 - xa), mul_px(px, xa)), 8));
+                    }
+                    else
+                    {
+                        for (U32 c = 0; c < ch; ++c)
+                        {
+                            *dptr++ = pix[c];
+                        }
+                    }
+                }
+            }
+        }
+        else if (info.xup_yup == 1)
+        { // scaling down vertically
+            for (U32 y = 0; y < dstH; y++)
+            {
+                const S32 Cy = info.yapoints[y] >> 16;
+                const S32 yap = info.yapoints[y] & 0xffff;
+                U8* dptr = dst + (y * dstStride);
+
+                for (U32 x = 0; x < dstW; x++)
+                {
+                    const U8* pix = info.ystrides[y] + info.xpoints[x] * ch;
+                    __m128i comp = column_sum<ch>(pix, srcStride, Cy, yap);
+                    const S32 xa = info.xapoints[x];
+                    if (xa > 0)
+                    {
+                        const __m128i cx = column_sum<ch>(pix + ch, srcStride, Cy, yap);
+                        comp = _mm_srai_epi32(_mm_add_epi32(mul32(comp, 256 - xa), mul32(cx, xa)), 12);
+                    }
+                    else
+                    {
+                        comp = _mm_srai_epi32(comp, 4);
+                    }
+                    store_px<ch>(dptr, _mm_srai_epi32(comp, 10));
+                }
+            }
+        }
+        else if (info.xup_yup == 2)
+        { // scaling down horizontally
+            for (U32 y = 0; y < dstH; y++)
+            {
+                U8* dptr = dst + (y * dstStride);
+                const S32 ya = info.yapoints[y];
+
+                for (U32 x = 0; x < dstW; x++)
+                {
+                    const S32 Cx = info.xapoints[x] >> 16;
+                    const S32 xap = info.xapoints[x] & 0xffff;
+                    const U8* pix = info.ystrides[y] + info.xpoints[x] * ch;
+                    __m128i comp = row_sum<ch>(pix, Cx, xap);
+                    if (ya > 0)
+                    {
+                        const __m128i cx = row_sum<ch>(pix + srcStride, Cx, xap);
+                        comp = _mm_srai_epi32(_mm_add_epi32(mul32(comp, 256 - ya), mul32(cx, ya)), 12);
+                    }
+                    else
+                    {
+                        comp = _mm_srai_epi32(comp, 4);
+                    }
+                    store_px<ch>(dptr, _mm_srai_epi32(comp, 10));
+                }
+            }
+        }
+        else
+        { // scale x/y - down
+            for (U32 y = 0; y < dstH; y++)
+            {
+                const S32 Cy = info.yapoints[y] >> 16;
+                const S32 yap = info.yapoints[y] & 0xffff;
+                U8* dptr = dst + (y * dstStride);
+
+                for (U32 x = 0; x < dstW; x++)
+                {
+                    const S32 Cx = info.xapoints[x] >> 16;
+                    const S32 xap = info.xapoints[x] & 0xffff;
+                    const U8* sptr = info.ystrides[y] + info.xpoints[x] * ch;
+
+                    __m128i comp = mul32(_mm_srai_epi32(row_sum<ch>(sptr, Cx, xap), 5), yap);
+                    sptr += srcStride;
+                    S32 j;
+                    for (j = (1 << 14) - yap; j > Cy; j -= Cy)
+                    {
+                        comp = _mm_add_epi32(comp, mul32(_mm_srai_epi32(row_sum<ch>(sptr, Cx, xap), 5), Cy));
+                        sptr += srcStride;
+                    }
+                    if (j > 0)
+                    {
+                        comp = _mm_add_epi32(comp, mul32(_mm_srai_epi32(row_sum<ch>(sptr, Cx, xap), 5), j));
+                    }
+                    store_px<ch>(dptr, _mm_srai_epi32(comp, 23));
+                }
+            }
+        }
+    }
+
+    void bilinearScale(const U8* src, U32 srcW, U32 srcH, U32 srcStride,
+                       U8* dst, U32 dstW, U32 dstH, U32 dstStride, U32 components)
+    {
+        if (4 == components)
+        {
+            bilinear_scale<4>(src, srcW, srcH, srcStride, dst, dstW, dstH, dstStride);
+        }
+        else
+        {
+            // A vector per 1 or 3 component pixel is mostly wasted lanes and
+            // unaligned loads; the unrolled scalar code measured faster.
+            scalar::getKernels()->bilinearScale(src, srcW, srcH, srcStride, dst, dstW, dstH, dstStride, components);
+        }
+    }
+
+    //------------------------------------------------------------------------
+    // mip downsampling: 16 bytes of each row in, 8 out
+    //------------------------------------------------------------------------
+
+    // Sum each pair of adjacent C component pixels across 16 bit lanes lo
+    // (src bytes 0-7) and hi (8-15), giving 8 lanes of results.
+    template<S32 C>
+    inline __m128i sum_pairs_epi16(__m128i lo, __m128i hi)
+    {
+        if (C == 1)
+        {
+            const __m128i ones = _mm_set1_epi16(1);
+            return _mm_packs_epi32(_mm_madd_epi16(lo, ones), _mm_madd_epi16(hi, ones));
+        }
+        if (C == 2)
+        {
+            const __m128 l = _mm_castsi128_ps(lo), h = _mm_castsi128_ps(hi);
+            return _mm_add_epi16(_mm_castps_si128(_mm_shuffle_ps(l, h, _MM_SHUFFLE(2, 0, 2, 0))),
+                                 _mm_castps_si128(_mm_shuffle_ps(l, h, _MM_SHUFFLE(3, 1, 3, 1))));
+        }
+        return _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+    }
+
+    template<S32 C>
+    inline __m128i downsample_block(__m128i r0, __m128i r1)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(r0, zero), _mm_unpacklo_epi8(r1, zero));
+        const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(r0, zero), _mm_unpackhi_epi8(r1, zero));
+        return _mm_srli_epi16(sum_pairs_epi16<C>(lo, hi), 2);
+    }
+
+    template<S32 C>
+    inline S32 downsample_rows(const U8* row0, const U8* row1, U8* dst, S32 dst_width)
+    {
+        // 32 source bytes of each row make 16 destination bytes
+        const S32 pixels = 16 / C;
+        S32 x = 0;
+        for (; x + pixels <= dst_width; x += pixels, row0 += 32, row1 += 32, dst += 16)
+        {
+            const __m128i a = downsample_block<C>(_mm_loadu_si128((const __m128i*)row0), _mm_loadu_si128((const __m128i*)row1));
+            const __m128i b = downsample_block<C>(_mm_loadu_si128((const __m128i*)(row0 + 16)), _mm_loadu_si128((const __m128i*)(row1 + 16)));
+            _mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(a, b));
+        }
+        return x;
+    }
+
+    // RGB goes through the RGBA path, 4 destination pixels at a time.
+    inline S32 downsample_rows_rgb(const U8* row0, const U8* row1, U8* dst, S32 dst_width)
+    {
+        S32 x = 0;
+#if LL_IMAGE_SIMD_AVX2
+        const __m128i mask = rgba_to_rgb_mask();
+        for (; x + 8 <= dst_width; x += 8, row0 += 48, row1 += 48, dst += 24)
+        {
+            __m128i a[4], b[4];
+            load_rgb16(row0, a);
+            load_rgb16(row1, b);
+            const __m128i lo = _mm_shuffle_epi8(_mm_packus_epi16(downsample_block<4>(a[0], b[0]), downsample_block<4>(a[1], b[1])), mask);
+            const __m128i hi = _mm_shuffle_epi8(_mm_packus_epi16(downsample_block<4>(a[2], b[2]), downsample_block<4>(a[3], b[3])), mask);
+            _mm_storel_epi64((__m128i*)dst, lo);
+            store_u32(dst + 8, (U32)_mm_cvtsi128_si32(_mm_srli_si128(lo, 8)));
+            _mm_storel_epi64((__m128i*)(dst + 12), hi);
+            store_u32(dst + 20, (U32)_mm_cvtsi128_si32(_mm_srli_si128(hi, 8)));
+        }
+#endif
+        alignas(16) U8 expanded[4][16];
+        for (; x + 4 <= dst_width; x += 4, row0 += 24, row1 += 24, dst += 12)
+        {
+            expand_3to4(row0, expanded[0]);
+            expand_3to4(row0 + 12, expanded[1]);
+            expand_3to4(row1, expanded[2]);
+            expand_3to4(row1 + 12, expanded[3]);
+            const __m128i a = downsample_block<4>(_mm_load_si128((const __m128i*)expanded[0]), _mm_load_si128((const __m128i*)expanded[2]));
+            const __m128i b = downsample_block<4>(_mm_load_si128((const __m128i*)expanded[1]), _mm_load_si128((const __m128i*)expanded[3]));
+            _mm_store_si128((__m128i*)expanded[0], _mm_packus_epi16(a, b));
+            compact_4to3(expanded[0], dst);
+        }
+        return x;
+    }
+
+    void downsample2x2(const U8* row0, const U8* row1, U8* dst, S32 dst_width, S32 components)
+    {
+        S32 x;
+        switch (components)
+        {
+        case 1: x = downsample_rows<1>(row0, row1, dst, dst_width); break;
+        case 2: x = downsample_rows<2>(row0, row1, dst, dst_width); break;
+        case 3: x = downsample_rows_rgb(row0, row1, dst, dst_width); break;
+        case 4: x = downsample_rows<4>(row0, row1, dst, dst_width); break;
+        default: return;
+        }
+        const S32 done = x * components;
+        scalar::getKernels()->downsample2x2(row0 + done * 2, row1 + done * 2, dst + done, dst_width - x, components);
+    }
+
+    // 16 bit values: sums of 2 pixels' worth in 32 bit lanes lo (values 0-3)
+    // and hi (4-7), giving 4 lanes of results.
+    template<S32 C>
+    inline __m128i sum_pairs_epi32(__m128i lo, __m128i hi)
+    {
+        if (C == 1)
+        {
+            const __m128 l = _mm_castsi128_ps(lo), h = _mm_castsi128_ps(hi);
+            return _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(l, h, _MM_SHUFFLE(2, 0, 2, 0))),
+                                 _mm_castps_si128(_mm_shuffle_ps(l, h, _MM_SHUFFLE(3, 1, 3, 1))));
+        }
+        if (C == 2)
+        {
+            return _mm_add_epi32(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+        }
+        return _mm_add_epi32(lo, hi);
+    }
+
+    template<S32 C>
+    inline __m128i downsample_block_u16(const U16* row0, const U16* row1)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i r0 = _mm_loadu_si128((const __m128i*)row0);
+        const __m128i r1 = _mm_loadu_si128((const __m128i*)row1);
+        const __m128i lo = _mm_add_epi32(_mm_unpacklo_epi16(r0, zero), _mm_unpacklo_epi16(r1, zero));
+        const __m128i hi = _mm_add_epi32(_mm_unpackhi_epi16(r0, zero), _mm_unpackhi_epi16(r1, zero));
+        return _mm_srli_epi32(_mm_add_epi32(sum_pairs_epi32<C>(lo, hi), _mm_set1_epi32(2)), 2);
+    }
+
+    template<S32 C>
+    inline S32 downsample_rows_u16(const U16* row0, const U16* row1, U16* dst, S32 dst_width)
+    {
+        // no unsigned 32 to 16 bit pack before SSE4.1: bias into signed range
+        const __m128i bias = _mm_set1_epi32(0x8000);
+        const __m128i unbias = _mm_set1_epi16((short)0x8000);
+        const S32 pixels = 8 / C;
+        S32 x = 0;
+        for (; x + pixels <= dst_width; x += pixels, row0 += 16, row1 += 16, dst += 8)
+        {
+            const __m128i a = _mm_sub_epi32(downsample_block_u16<C>(row0, row1), bias);
+            const __m128i b = _mm_sub_epi32(downsample_block_u16<C>(row0 + 8, row1 + 8), bias);
+            _mm_storeu_si128((__m128i*)dst, _mm_xor_si128(_mm_packs_epi32(a, b), unbias));
+        }
+        return x;
+    }
+
+    void downsample2x2U16(const U16* row0, const U16* row1, U16* dst, S32 dst_width, S32 components)
+    {
+        S32 x;
+        switch (components)
+        {
+        case 1: x = downsample_rows_u16<1>(row0, row1, dst, dst_width); break;
+        case 2: x = downsample_rows_u16<2>(row0, row1, dst, dst_width); break;
+        case 4: x = downsample_rows_u16<4>(row0, row1, dst, dst_width); break;
+        default: x = 0; break;
+        }
+        const S32 done = x * components;
+        scalar::getKernels()->downsample2x2U16(row0 + done * 2, row1 + done * 2, dst + done, dst_width - x, components);
+    }
+} // anonymous namespace
+
+    const Kernels* getKernels()
+    {
+        static const Kernels sKernels =
+        {
+            fill,
+            tint,
+            copy4onto3,
+            copy3onto4,
+#if LL_IMAGE_SIMD_AVX2
+            composite4onto3,
+#else
+            scalar::getKernels()->composite4onto3,
+#endif
+            copyLineScaled,
+            compositeRowScaled4onto3,
+            bilinearScale,
+            downsample2x2,
+            downsample2x2U16
+        };
+        return &sKernels;
+    }
+} // namespace LL_IMAGE_SIMD_NS
+} // namespace LLImageSIMD
@@ -28,6 +28,7 @@
 
 #include "llimageworker.h"
 #include "llimagedxt.h"
+#include "llimagej2c.h"
 #include "threadpool.h"
 
 /*--------------------------------------------------------------------------*/
@@ -38,13 +39,22 @@ public:
                  S32 discard,
                  bool needs_aux,
                  const LLPointer<LLImageDecodeThread::Responder>& responder,
-                 U32 request_id);
+                 U32 request_id,
+                 LLImageDecodeThread* owner);
     virtual ~ImageRequest();
 
+    // Compress the decoded image with quality, and save it to file if named
+    void setTranscode(LLImageBCn::EQuality quality, bool allow_bc7, const std::string& file);
+
     /*virtual*/ bool processRequest();
     /*virtual*/ void finishRequest(bool completed);
 
 private:
+    // Decode from the compressed copy in mTranscodeFile, if there is a
+    // good enough one.
+    bool loadTranscoded();
+    void transcode();
+
     // LLPointers stored in ImageRequest MUST be LLPointer instances rather
     // than references: we need to increment the refcount when storing these.
     // input
@@ -52,20 +62,33 @@ private:
     S32 mDiscardLevel;
     U32 mRequestId;
     bool mNeedsAux;
+    bool mTranscode;
+    LLImageBCn::EQuality mTranscodeQuality;
+    bool mTranscodeBC7;
+    std::string mTranscodeFile;
     // output
     LLPointer<LLImageRaw> mDecodedImageRaw;
     LLPointer<LLImageRaw> mDecodedImageAux;
+    LLPointer<LLImageDXT> mTranscodedImage;
     bool mDecodedRaw;
     bool mDecodedAux;
     LLPointer<LLImageDecodeThread::Responder> mResponder;
-    std::string mErrorString;};
+    std::string mErrorString;
+    LLImageDecodeThread* mOwner;};
 
 
 //----------------------------------------------------------------------------
 
 // MAIN THREAD
 LLImageDecodeThread::LLImageDecodeThread(bool /*threaded*/)
-    : mDecodeCount(0)
+    : mDecodeCount(0),
+      mActiveDecodes(0),
+      mBorrowedThreads(0),
+      mMaxThreadsPerImage(1),
+      mMinParallelPixels(512 * 512),
+      mTranscode(false),
+      mTranscodeQuality(LLImageBCn::FAST),
+      mTranscodeBC7(false)
 {
     mThreadPool.reset(new LL::ThreadPool("ImageDecode", 8));
     mThreadPool->start();
@@ -92,7 +115,10 @@ LLImageDecodeThread::handle_t LLImageDecodeThread::decodeImage(
     const LLPointer<LLImageFormatted>& image,
     S32 discard,
     bool needs_aux,
-    const LLPointer<LLImageDecodeThread::Responder>& responder)
+    const LLPointer<LLImageDecodeThread::Responder>& responder,
+    LL::WorkQueue::Priority priority,
+    bool transcode,
+    const std::string& transcode_file)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
 
@@ -100,14 +126,23 @@ LLImageDecodeThread::handle_t LLImageDecodeThread::decodeImage(
     if (decode_id == 0)
         decode_id = ++mDecodeCount;
 
-    // Instantiate the ImageRequest right in the lambda, why not?
+    ImageRequest request(image, discard, needs_aux, responder, decode_id, this);
+    // an aux channel has nowhere to go in a compressed copy
+    if (transcode && mTranscode && !needs_aux)
+    {
+        request.setTranscode(mTranscodeQuality, mTranscodeBC7, transcode_file);
+    }
+
     bool posted = mThreadPool->getQueue().post(
-        [req = ImageRequest(image, discard, needs_aux, responder, decode_id)]
+        [req = std::move(request), this]
         () mutable
         {
+            ++mActiveDecodes;
             auto done = req.processRequest();
+            --mActiveDecodes;
             req.finishRequest(done);
-        });
+        },
+        priority);
     if (! posted)
     {
         LL_DEBUGS() << "Tried to start decoding on shutdown" << LL_ENDL;
@@ -122,6 +157,53 @@ void LLImageDecodeThread::shutdown()
     mThreadPool->close();
 }
 
+void LLImageDecodeThread::setParallelDecode(S32 max_threads_per_image, S32 min_pixels)
+{
+    mMaxThreadsPerImage = llmax(max_threads_per_image, 1);
+    mMinParallelPixels = llmax(min_pixels, 0);
+}
+
+void LLImageDecodeThread::setTranscode(bool enabled, LLImageBCn::EQuality quality, bool allow_bc7)
+{
+    mTranscodeQuality = quality;
+    mTranscodeBC7 = allow_bc7;
+    mTranscode = enabled;
+}
+
+// DECODE THREAD
+S32 LLImageDecodeThread::borrowThreads(S32 pixels)
+{
+    const S32 wanted = mMaxThreadsPerImage - 1;
+    if (wanted <= 0 || pixels < mMinParallelPixels)
+    {
+        return 0;
+    }
+    // Only count pool threads with nothing else to do: the codec's extra
+    // threads compete with them for cores, queued requests would pick them
+    // up shortly, and small textures shouldn't wait behind a big one.
+    const S32 idle = (S32)mThreadPool->getWidth() - mActiveDecodes - (S32)getPending();
+    S32 borrowed = mBorrowedThreads;
+    S32 take;
+    do
+    {
+        take = llmin(wanted, idle - borrowed);
+        if (take <= 0)
+        {
+            return 0;
+        }
+    } while (!mBorrowedThreads.compare_exchange_weak(borrowed, borrowed + take));
+    return take;
+}
+
+// DECODE THREAD
+void LLImageDecodeThread::returnThreads(S32 threads)
+{
+    if (threads > 0)
+    {
+        mBorrowedThreads -= threads;
+    }
+}
+
 LLImageDecodeThread::Responder::~Responder()
 {
 }
@@ -132,14 +214,19 @@ ImageRequest::ImageRequest(const LLPointer<LLImageFormatted>& image,
                            S32 discard,
                            bool needs_aux,
                            const LLPointer<LLImageDecodeThread::Responder>& responder,
-                           U32 request_id)
+                           U32 request_id,
+                           LLImageDecodeThread* owner)
     : mFormattedImage(image),
       mDiscardLevel(discard),
       mNeedsAux(needs_aux),
+      mTranscode(false),
+      mTranscodeQuality(LLImageBCn::FAST),
+      mTranscodeBC7(false),
       mDecodedRaw(false),
       mDecodedAux(false),
       mResponder(responder),
-      mRequestId(request_id)
+      mRequestId(request_id),
+      mOwner(owner)
 {
 }
 
@@ -147,9 +234,18 @@ ImageRequest::~ImageRequest()
 {
     mDecodedImageRaw = NULL;
     mDecodedImageAux = NULL;
+    mTranscodedImage = NULL;
     mFormattedImage = NULL;
 }
 
+void ImageRequest::setTranscode(LLImageBCn::EQuality quality, bool allow_bc7, const std::string& file)
+{
+    mTranscode = true;
+    mTranscodeQuality = quality;
+    mTranscodeBC7 = allow_bc7;
+    mTranscodeFile = file;
+}
+
 //----------------------------------------------------------------------------
 
 
@@ -186,11 +282,25 @@ bool ImageRequest::processRequest()
             {
                 mFormattedImage->setDiscardLevel(mDiscardLevel);
             }
+            if (loadTranscoded())
+            {
+                return true; // done, without decoding
+            }
             mDecodedImageRaw = new LLImageRaw(mFormattedImage->getWidth(),
                                               mFormattedImage->getHeight(),
                                               mFormattedImage->getComponents());
         }
 
+        // Large J2C images split their decode across idle pool threads
+        S32 borrowed = 0;
+        if (mOwner && mFormattedImage->getCodec() == IMG_CODEC_J2C)
+        {
+            S32 discard = llmax(mFormattedImage->getDiscardLevel(), 0);
+            S32 pixels = (mFormattedImage->getWidth() >> discard) * (mFormattedImage->getHeight() >> discard);
+            borrowed = mOwner->borrowThreads(pixels);
+            ((LLImageJ2C*)mFormattedImage.get())->setDecodeThreads(1 + borrowed);
+        }
+
         // <FS:ND> Probably out of memory crash
         // done = mFormattedImage->decode(mDecodedImageRaw, decode_time_slice);
         if( mDecodedImageRaw->getData() )
@@ -203,11 +313,22 @@ bool ImageRequest::processRequest()
         }
         // </FS:ND>
 
+        if (borrowed)
+        {
+            ((LLImageJ2C*)mFormattedImage.get())->setDecodeThreads(1);
+            mOwner->returnThreads(borrowed);
+        }
+
         // some decoders are removing data when task is complete and there were errors
         mDecodedRaw = done && mDecodedImageRaw->getData();
 
         // Pick up errors from decoding
         mErrorString = LLImage::getLastThreadError();
+
+        if (mDecodedRaw && mTranscode)
+        {
+            transcode();
+        }
     }
     if (done && mNeedsAux && !mDecodedAux && mFormattedImage.notNull())
     {
@@ -228,12 +349,47 @@ bool ImageRequest::processRequest()
     return done;
 }
 
+bool ImageRequest::loadTranscoded()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    if (!mTranscode)
+    {
+        return false;
+    }
+
+    LLImageDXT::EFileFormat format = LLImageDXT::getBlockFormat(mFormattedImage->getComponents(), mTranscodeQuality, mTranscodeBC7);
+    LLPointer<LLImageRaw> raw = new LLImageRaw();
+    mTranscodedImage = LLImageDXT::loadBlocks(mTranscodeFile, format, mFormattedImage->getWidth(), mFormattedImage->getHeight(),
+                                              mFormattedImage->getDiscardLevel(), raw);
+    if (mTranscodedImage.isNull())
+    {
+        return false;
+    }
+    mDecodedImageRaw = raw;
+    mDecodedRaw = true;
+    return true;
+}
+
+void ImageRequest::transcode()
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    LLImageDXT::EFileFormat format = LLImageDXT::getBlockFormat(mDecodedImageRaw->getComponents(), mTranscodeQuality, mTranscodeBC7);
+    if (format != LLImageDXT::FORMAT_UNKNOWN)
+    {
+        mTranscodedImage = LLImageDXT::createBlocks(mDecodedImageRaw, format, mTranscodeQuality, mTranscodeFile, mRequestId);
+    }
+}
+
 void ImageRequest::finishRequest(bool completed)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
     if (mResponder.notNull())
     {
         bool success = completed && mDecodedRaw && (!mNeedsAux || mDecodedAux);
+        if (success && mTranscodedImage.notNull())
+        {
+            mResponder->transcoded(mTranscodedImage, mRequestId);
+        }
         mResponder->completed(success, mErrorString, mDecodedImageRaw, mDecodedImageAux, mRequestId);
     }
     // Will automatically be deleted
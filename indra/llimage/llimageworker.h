@@ -28,8 +28,12 @@
 #define LL_LLIMAGEWORKER_H
 
 #include "llimage.h"
+#include "llimagebcn.h"
 #include "llpointer.h"
 #include "threadpool_fwd.h"
+#include <atomic>
+
+class LLImageDXT;
 
 class LLImageDecodeThread
 {
@@ -40,6 +44,10 @@ public:
         virtual ~Responder();
     public:
         virtual void completed(bool success, const std::string& error_message, LLImageRaw* raw, LLImageRaw* aux, U32 request_id) = 0;
+        // Called just before completed() with the block compressed copy of
+        // raw, for requests that asked for one. Its discard level (in its
+        // own mips) is the mip that matches raw.
+        virtual void transcoded(LLImageDXT* image, U32 request_id) {}
     };
 
 public:
@@ -48,15 +56,51 @@ public:
 
     // meant to resemble LLQueuedThread::handle_t
     typedef U32 handle_t;
+    // With transcode (and transcoding turned on by setTranscode()), the
+    // decoded image is also compressed to blocks. If transcode_file holds a
+    // compressed copy at least as sharp as discard, that stands in for
+    // decoding; otherwise the new copy is saved there.
     handle_t decodeImage(const LLPointer<LLImageFormatted>& image,
                          S32 discard, bool needs_aux,
-                         const LLPointer<Responder>& responder);
+                         const LLPointer<Responder>& responder,
+                         LL::WorkQueue::Priority priority = LL::WorkQueue::PRIORITY_NORMAL,
+                         bool transcode = false,
+                         const std::string& transcode_file = std::string());
     size_t getPending();
     size_t update(F32 max_time_ms);
     S32 getTotalDecodeCount() { return mDecodeCount; }
     void shutdown();
 
+    // A J2C image of at least min_pixels (at the requested discard level)
+    // may decode on up to max_threads_per_image threads. The extra threads
+    // are OpenJPEG's own, started per decode; the pool only sets the budget:
+    // a decode gets no more extras than there are idle pool threads, so the
+    // total stays near the pool width. max_threads_per_image <= 1 keeps
+    // every decode on a single thread.
+    void setParallelDecode(S32 max_threads_per_image, S32 min_pixels);
+
+    // Compress decoded RGB images to BC1 and RGBA ones to BC3, or to BC7
+    // for HIGH quality when allow_bc7. Off unless enabled.
+    void setTranscode(bool enabled, LLImageBCn::EQuality quality, bool allow_bc7);
+
 private:
+    friend class ImageRequest;
+
+    // Reserve room for extra codec threads for a decode of this many pixels,
+    // counted against idle pool threads; returns how many were reserved
+    // (possibly 0). Hand them back with returnThreads().
+    S32 borrowThreads(S32 pixels);
+    void returnThreads(S32 threads);
+
+    // decodes currently running on a pool thread
+    std::atomic<S32> mActiveDecodes;
+    // extra threads lent to running decodes
+    std::atomic<S32> mBorrowedThreads;
+    std::atomic<S32> mMaxThreadsPerImage;
+    std::atomic<S32> mMinParallelPixels;
+    std::atomic<bool> mTranscode;
+    std::atomic<LLImageBCn::EQuality> mTranscodeQuality;
+    std::atomic<bool> mTranscodeBC7;
     // As of SL-17483, LLImageDecodeThread is no longer itself an
     // LLQueuedThread - instead this is the API by which we submit work to the
     // "ImageDecode" ThreadPool.
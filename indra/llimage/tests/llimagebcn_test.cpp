@@ -0,0 +1,237 @@
+/**
+ * @file   llimagebcn_test.cpp
+ * @date   2026-10-18
+ * @brief  Test for llimagebcn.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "../llimagebcn.h"
+// STL headers
+#include <vector>
+// std headers
+#include <cmath>
+#include <cstdlib>
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+#include "stringize.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct llimagebcn_data
+    {
+        typedef std::vector<U8> buffer_t;
+
+        llimagebcn_data():
+            mSeed(0x2545f491)
+        {
+        }
+
+        S32 random(S32 range)
+        {
+            mSeed ^= mSeed << 13;
+            mSeed ^= mSeed >> 17;
+            mSeed ^= mSeed << 5;
+            return (S32)(mSeed % (U32)range);
+        }
+
+        // Smooth color ramps with a little noise, like most texture content.
+        buffer_t smooth_image(S32 width, S32 height, S32 nchannels)
+        {
+            buffer_t image(width * height * nchannels);
+            for (S32 y = 0; y < height; ++y)
+            {
+                for (S32 x = 0; x < width; ++x)
+                {
+                    U8* texel = &image[(y * width + x) * nchannels];
+                    for (S32 c = 0; c < nchannels; ++c)
+                    {
+                        const S32 ramp = (c & 1) ? x * 255 / width : y * 255 / height;
+                        texel[c] = (U8)llclamp(ramp / (c + 1) + 40 * c + random(9) - 4, 0, 255);
+                    }
+                }
+            }
+            return image;
+        }
+
+        static F64 psnr(const buffer_t& a, const buffer_t& b)
+        {
+            F64 sum = 0.0;
+            for (size_t i = 0; i < a.size(); ++i)
+            {
+                const F64 d = (F64)a[i] - (F64)b[i];
+                sum += d * d;
+            }
+            const F64 mse = sum / a.size();
+            return mse > 0.0 ? 10.0 * log10(255.0 * 255.0 / mse) : 99.0;
+        }
+
+        buffer_t round_trip(LLImageBCn::EFormat format, const buffer_t& image, S32 width, S32 height,
+                            S32 nchannels, LLImageBCn::EQuality quality)
+        {
+            buffer_t blocks(LLImageBCn::getImageBytes(format, width, height));
+            LLImageBCn::encodeImage(format, &image[0], width, height, nchannels, &blocks[0], quality);
+            buffer_t decoded(image.size());
+            LLImageBCn::decodeImage(format, &blocks[0], width, height, nchannels, &decoded[0]);
+            return decoded;
+        }
+
+        U32 mSeed;
+    };
+    typedef test_group<llimagebcn_data> llimagebcn_group;
+    typedef llimagebcn_group::object object;
+    llimagebcn_group llimagebcngrp("llimagebcn");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("BC1 blocks");
+        // two colors that 5:6:5 holds exactly come back exactly
+        const U8 colors[2][4] = { { 255, 0, 132, 255 }, { 8, 255, 33, 255 } };
+        U8 texels[64];
+        for (S32 i = 0; i < 16; ++i)
+        {
+            memcpy(texels + i * 4, colors[(i * 7) % 3 == 0], 4);
+        }
+        for (S32 quality = LLImageBCn::FAST; quality <= LLImageBCn::HIGH; ++quality)
+        {
+            U8 block[8], decoded[64];
+            LLImageBCn::encodeBlock(LLImageBCn::BC1, texels, block, (LLImageBCn::EQuality)quality);
+            ensure("four color mode", (block[0] | (block[1] << 8)) > (block[2] | (block[3] << 8)));
+            LLImageBCn::decodeBlock(LLImageBCn::BC1, block, decoded);
+            ensure_memory_matches(stringize("two colors, quality ", quality).c_str(), decoded, 64, texels, 64);
+        }
+
+        // a flat block doesn't fall into three color mode, whose index 3 is transparent
+        for (S32 i = 0; i < 16; ++i)
+        {
+            memcpy(texels + i * 4, colors[0], 4);
+        }
+        U8 block[8], decoded[64];
+        LLImageBCn::encodeBlock(LLImageBCn::BC1, texels, block, LLImageBCn::HIGH);
+        LLImageBCn::decodeBlock(LLImageBCn::BC1, block, decoded);
+        ensure_memory_matches("flat", decoded, 64, texels, 64);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("BC3 alpha");
+        U8 texels[64];
+        for (S32 i = 0; i < 16; ++i)
+        {
+            texels[i * 4] = texels[i * 4 + 1] = texels[i * 4 + 2] = 128;
+            texels[i * 4 + 3] = (i & 1) ? 255 : 0;
+        }
+        U8 block[16], decoded[64];
+        LLImageBCn::encodeBlock(LLImageBCn::BC3, texels, block, LLImageBCn::FAST);
+        LLImageBCn::decodeBlock(LLImageBCn::BC3, block, decoded);
+        for (S32 i = 0; i < 16; ++i)
+        {
+            ensure_equals(stringize("cutout alpha ", i), decoded[i * 4 + 3], texels[i * 4 + 3]);
+        }
+
+        // a full ramp lands within half of one of the seven steps
+        for (S32 i = 0; i < 16; ++i)
+        {
+            texels[i * 4 + 3] = (U8)(i * 17);
+        }
+        LLImageBCn::encodeBlock(LLImageBCn::BC3, texels, block, LLImageBCn::FAST);
+        LLImageBCn::decodeBlock(LLImageBCn::BC3, block, decoded);
+        for (S32 i = 0; i < 16; ++i)
+        {
+            ensure(stringize("ramp alpha ", i), abs(decoded[i * 4 + 3] - texels[i * 4 + 3]) <= 19);
+        }
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("BC7 mode 6 blocks");
+        U8 texels[64];
+        for (S32 i = 0; i < 64; ++i)
+        {
+            texels[i] = (U8)random(256);
+        }
+        U8 block[16], decoded[64];
+        LLImageBCn::encodeBlock(LLImageBCn::BC7, texels, block, LLImageBCn::HIGH);
+        ensure_equals("mode 6", block[0] & 0x7f, 0x40);
+
+        // endpoints with the same low bit on every channel round trip exactly
+        const U8 colors[2][4] = { { 200, 100, 50, 254 }, { 20, 40, 60, 0 } };
+        for (S32 i = 0; i < 16; ++i)
+        {
+            memcpy(texels + i * 4, colors[i >= 5 && i != 9], 4);
+        }
+        for (S32 quality = LLImageBCn::FAST; quality <= LLImageBCn::HIGH; ++quality)
+        {
+            LLImageBCn::encodeBlock(LLImageBCn::BC7, texels, block, (LLImageBCn::EQuality)quality);
+            LLImageBCn::decodeBlock(LLImageBCn::BC7, block, decoded);
+            ensure_memory_matches(stringize("two colors, quality ", quality).c_str(), decoded, 64, texels, 64);
+        }
+
+        // other modes aren't read
+        memset(block, 0, sizeof(block));
+        block[0] = 0x01; // mode 0
+        memset(decoded, 0xff, sizeof(decoded));
+        LLImageBCn::decodeBlock(LLImageBCn::BC7, block, decoded);
+        ensure_equals("other mode", decoded[3], 0);
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("whole images");
+        const S32 width = 64, height = 32;
+        const buffer_t rgb = smooth_image(width, height, 3);
+        const buffer_t rgba = smooth_image(width, height, 4);
+
+        const F64 bc1_fast = psnr(rgb, round_trip(LLImageBCn::BC1, rgb, width, height, 3, LLImageBCn::FAST));
+        const F64 bc1_high = psnr(rgb, round_trip(LLImageBCn::BC1, rgb, width, height, 3, LLImageBCn::HIGH));
+        const F64 bc3 = psnr(rgba, round_trip(LLImageBCn::BC3, rgba, width, height, 4, LLImageBCn::FAST));
+        const F64 bc7_fast = psnr(rgba, round_trip(LLImageBCn::BC7, rgba, width, height, 4, LLImageBCn::FAST));
+        const F64 bc7_high = psnr(rgba, round_trip(LLImageBCn::BC7, rgba, width, height, 4, LLImageBCn::HIGH));
+        ensure(stringize("BC1 fast ", bc1_fast, "dB"), bc1_fast > 32.0);
+        ensure(stringize("BC1 high ", bc1_high, "dB vs fast ", bc1_fast), bc1_high >= bc1_fast);
+        ensure(stringize("BC3 ", bc3, "dB"), bc3 > 32.0);
+        ensure(stringize("BC7 fast ", bc7_fast, "dB"), bc7_fast > 32.0);
+        ensure(stringize("BC7 high ", bc7_high, "dB vs BC3 ", bc3), bc7_high > bc3);
+
+        // sides that aren't multiples of 4 repeat their edges into the blocks;
+        // ramps this short are steep, so expect less
+        const buffer_t small = smooth_image(6, 3, 4);
+        ensure_equals("6x3 bytes", LLImageBCn::getImageBytes(LLImageBCn::BC7, 6, 3), 32);
+        const F64 small_bc7 = psnr(small, round_trip(LLImageBCn::BC7, small, 6, 3, 4, LLImageBCn::HIGH));
+        ensure(stringize("6x3 ", small_bc7, "dB"), small_bc7 > 25.0);
+        const buffer_t tiny = smooth_image(2, 1, 3);
+        ensure_equals("2x1 bytes", LLImageBCn::getImageBytes(LLImageBCn::BC1, 2, 1), 8);
+        const F64 tiny_bc1 = psnr(tiny, round_trip(LLImageBCn::BC1, tiny, 2, 1, 3, LLImageBCn::HIGH));
+        ensure(stringize("2x1 ", tiny_bc1, "dB"), tiny_bc1 > 32.0);
+    }
+} // namespace tut
@@ -0,0 +1,227 @@
+/**
+ * @file   llimagebufferpool_test.cpp
+ * @date   2026-10-18
+ * @brief  Test for llimagebufferpool.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "../llimagebufferpool.h"
+// STL headers
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+// std headers
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct llimagebufferpool_data
+    {
+        llimagebufferpool_data()
+        {
+            LLImageBufferPool::setLimit(LLImageBufferPool::DEFAULT_LIMIT);
+            LLImageBufferPool::trim();
+        }
+        ~llimagebufferpool_data()
+        {
+            LLImageBufferPool::setLimit(LLImageBufferPool::DEFAULT_LIMIT);
+            LLImageBufferPool::trim();
+        }
+    };
+    typedef test_group<llimagebufferpool_data> llimagebufferpool_group;
+    typedef llimagebufferpool_group::object object;
+    llimagebufferpool_group llimagebufferpoolgrp("llimagebufferpool");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("size classes");
+        ensure_equals("below pool", LLImageBufferPool::getCapacity(LLImageBufferPool::MIN_POOLED_SIZE - 1), 0);
+        ensure_equals("above pool", LLImageBufferPool::getCapacity(LLImageBufferPool::MAX_POOLED_SIZE + 1), 0);
+        ensure_equals("smallest", LLImageBufferPool::getCapacity(LLImageBufferPool::MIN_POOLED_SIZE), LLImageBufferPool::MIN_POOLED_SIZE);
+        ensure_equals("largest", LLImageBufferPool::getCapacity(LLImageBufferPool::MAX_POOLED_SIZE), LLImageBufferPool::MAX_POOLED_SIZE);
+        ensure_equals("quarter step", LLImageBufferPool::getCapacity(4097), 5120);
+        for (S32 side = 64; side <= 2048; side <<= 1)
+        {
+            // raw images fit their class exactly
+            for (S32 components = 1; components <= 4; ++components)
+            {
+                const S32 size = side * side * components;
+                ensure_equals("raw image", LLImageBufferPool::getCapacity(size), size);
+            }
+        }
+        for (S32 size = LLImageBufferPool::MIN_POOLED_SIZE; size < 4 * 1024 * 1024; size += 997)
+        {
+            const S32 capacity = LLImageBufferPool::getCapacity(size);
+            ensure("holds size", capacity >= size);
+            ensure("wastes at most a quarter", capacity - size < size / 4 + 1);
+        }
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("released buffers are reused");
+        const LLImageBufferPool::Stats before = LLImageBufferPool::getStats();
+        S32 capacity = 0;
+        U8* first = LLImageBufferPool::allocate(256 * 256 * 3, capacity);
+        ensure("allocated", first != NULL);
+        ensure_equals("capacity", capacity, 256 * 256 * 3);
+        ensure("aligned", ((uintptr_t)first & 15) == 0);
+        memset(first, 0x5a, capacity);
+        LLImageBufferPool::release(first, capacity);
+        ensure_equals("pooled", LLImageBufferPool::getStats().mPooledBytes, (size_t)capacity);
+
+        // any size in the same class gets the same buffer back
+        S32 again = 0;
+        U8* second = LLImageBufferPool::allocate(256 * 256 * 3 - 100, again);
+        ensure("same buffer", second == first);
+        ensure_equals("same capacity", again, capacity);
+        const LLImageBufferPool::Stats after = LLImageBufferPool::getStats();
+        ensure_equals("reused", after.mReused - before.mReused, (U64)1);
+        ensure_equals("allocated", after.mAllocated - before.mAllocated, (U64)1);
+        ensure_equals("live", after.mLive - before.mLive, (size_t)1);
+        LLImageBufferPool::release(second, again);
+
+        // small buffers bypass the pool and are simply freed
+        S32 small = 1;
+        U8* unpooled = LLImageBufferPool::allocate(100, small);
+        ensure("small allocated", unpooled != NULL);
+        ensure_equals("small capacity", small, 0);
+        LLImageBufferPool::release(unpooled, small);
+        ensure_equals("small not pooled", LLImageBufferPool::getStats().mPooledBytes, (size_t)capacity);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("limit and trim");
+        const S32 size = 512 * 1024;
+        LLImageBufferPool::setLimit(3 * size);
+        std::vector<U8*> buffers;
+        S32 capacity = 0;
+        for (S32 i = 0; i < 5; ++i)
+        {
+            buffers.push_back(LLImageBufferPool::allocate(size, capacity));
+        }
+        for (U8* buffer : buffers)
+        {
+            LLImageBufferPool::release(buffer, capacity);
+        }
+        LLImageBufferPool::Stats stats = LLImageBufferPool::getStats();
+        ensure_equals("capped", stats.mPooledBytes, (size_t)(3 * size));
+        ensure_equals("capped count", stats.mPooled, (size_t)3);
+
+        const U64 trimmed = stats.mTrimmedBytes;
+        LLImageBufferPool::trim(size);
+        stats = LLImageBufferPool::getStats();
+        ensure_equals("trimmed to keep", stats.mPooledBytes, (size_t)size);
+        ensure_equals("trimmed bytes", stats.mTrimmedBytes - trimmed, (U64)(2 * size));
+
+        LLImageBufferPool::setLimit(0);
+        ensure_equals("disabled", LLImageBufferPool::getStats().mPooledBytes, (size_t)0);
+        U8* buffer = LLImageBufferPool::allocate(size, capacity);
+        LLImageBufferPool::release(buffer, capacity);
+        ensure_equals("not kept", LLImageBufferPool::getStats().mPooledBytes, (size_t)0);
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("buffers released on other threads");
+        const size_t live = LLImageBufferPool::getStats().mLive;
+        // 4 threads x 80 buffers of ~128KB on average are held per batch
+        const S32 threads = 4, batches = 25, rounds = 80;
+        // each thread frees the buffers the one before it allocated, as
+        // decode threads hand images to the main thread
+        std::vector<std::vector<std::pair<U8*, S32>>> handoff(threads);
+        std::atomic<S32> failures{ 0 };
+        for (S32 batch = 0; batch < batches; ++batch)
+        {
+            std::vector<std::thread> workers;
+            for (S32 t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&handoff, &failures, t, batch, rounds]()
+                    {
+                        for (S32 i = 0; i < rounds; ++i)
+                        {
+                            const S32 size = 4096 << ((batch + i + t) % 8);
+                            S32 capacity = 0;
+                            U8* buffer = LLImageBufferPool::allocate(size, capacity);
+                            if (! buffer)
+                            {
+                                ++failures;
+                                continue;
+                            }
+                            memset(buffer, t, size);
+                            LLImageBufferPool::release(buffer, capacity);
+                            buffer = LLImageBufferPool::allocate(size, capacity);
+                            if (! buffer)
+                            {
+                                ++failures;
+                                continue;
+                            }
+                            buffer[size - 1] = (U8)t;
+                            handoff[t].emplace_back(buffer, capacity);
+                        }
+                    });
+            }
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+            workers.clear();
+            for (S32 t = 0; t < threads; ++t)
+            {
+                workers.emplace_back([&handoff, t, threads]()
+                    {
+                        for (auto& buffer : handoff[(t + 1) % threads])
+                        {
+                            LLImageBufferPool::release(buffer.first, buffer.second);
+                        }
+                    });
+            }
+            for (auto& worker : workers)
+            {
+                worker.join();
+            }
+            for (auto& buffers : handoff)
+            {
+                buffers.clear();
+            }
+        }
+        ensure_equals("allocation failures", failures.load(), 0);
+        const LLImageBufferPool::Stats stats = LLImageBufferPool::getStats();
+        ensure_equals("all returned", stats.mLive, live);
+        ensure("under limit", stats.mPooledBytes <= LLImageBufferPool::getLimit());
+    }
+} // namespace tut
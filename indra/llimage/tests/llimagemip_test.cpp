@@ -0,0 +1,247 @@
+/**
+ * @file   llimagemip_test.cpp
+ * @date   2026-10-18
+ * @brief  Test for LLImageBase mip chain generation.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "../llimage.h"
+// STL headers
+#include <thread>
+#include <vector>
+// std headers
+#include <cstdlib>
+// external library headers
+// other Linden headers
+#include "workqueue.h"
+#include "../test/lltut.h"
+#include "stringize.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct llimagemip_data
+    {
+        typedef std::vector<U8> buffer_t;
+
+        llimagemip_data():
+            mSeed(0x6d2b79f5)
+        {
+        }
+
+        buffer_t random_image(S32 width, S32 height, S32 nchannels)
+        {
+            buffer_t image(width * height * nchannels);
+            for (U8& byte : image)
+            {
+                mSeed ^= mSeed << 13;
+                mSeed ^= mSeed >> 17;
+                mSeed ^= mSeed << 5;
+                byte = U8(mSeed);
+            }
+            return image;
+        }
+
+        // Straightforward floor-of-average 2x2 box filter, repeating the
+        // last row or column where a side is already 1.
+        static buffer_t reference_level(const buffer_t& src, S32 width, S32 height, S32 nchannels)
+        {
+            const S32 dst_width = llmax(width >> 1, 1), dst_height = llmax(height >> 1, 1);
+            buffer_t dst;
+            for (S32 y = 0; y < dst_height; ++y)
+            {
+                const S32 y0 = llmin(y * 2, height - 1), y1 = llmin(y * 2 + 1, height - 1);
+                for (S32 x = 0; x < dst_width; ++x)
+                {
+                    const S32 x0 = llmin(x * 2, width - 1), x1 = llmin(x * 2 + 1, width - 1);
+                    for (S32 c = 0; c < nchannels; ++c)
+                    {
+                        const U32 sum = src[(y0 * width + x0) * nchannels + c] + src[(y0 * width + x1) * nchannels + c]
+                                      + src[(y1 * width + x0) * nchannels + c] + src[(y1 * width + x1) * nchannels + c];
+                        dst.push_back(U8(sum >> 2));
+                    }
+                }
+            }
+            return dst;
+        }
+
+        void ensure_reference_chain(S32 width, S32 height, S32 nchannels)
+        {
+            const std::string msg(stringize(width, "x", height, "x", nchannels));
+            const buffer_t base(random_image(width, height, nchannels));
+            buffer_t chain(LLImageBase::getMipChainSize(width, height, nchannels, 100) + 1, 0xcd);
+            const S32 levels = LLImageBase::generateMipChain(&base[0], &chain[0], width, height, nchannels, 100);
+            ensure_equals(msg + " guard", chain.back(), 0xcd);
+
+            buffer_t expected(base);
+            S32 offset = 0, level = 0, w = width, h = height;
+            while (w > 1 || h > 1)
+            {
+                expected = reference_level(expected, w, h, nchannels);
+                w = llmax(w >> 1, 1);
+                h = llmax(h >> 1, 1);
+                ensure_equals(msg + " offset", offset, LLImageBase::getMipChainSize(width, height, nchannels, level));
+                ++level;
+                for (size_t i = 0; i < expected.size(); ++i)
+                {
+                    if (chain[offset + i] != expected[i])
+                    {
+                        fail(stringize(msg, " level ", level, " byte ", i, ": expected ", S32(expected[i]), ", got ", S32(chain[offset + i])));
+                    }
+                }
+                offset += S32(expected.size());
+            }
+            ensure_equals(msg + " levels", levels, level);
+            ensure_equals(msg + " size", offset, S32(chain.size()) - 1);
+        }
+
+        U32 mSeed;
+    };
+    typedef test_group<llimagemip_data> llimagemip_group;
+    typedef llimagemip_group::object object;
+    llimagemip_group llimagemipgrp("llimagemip");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("chain matches generateMip");
+        for (S32 nchannels = 1; nchannels <= 4; ++nchannels)
+        {
+            const S32 width = 256, height = 128;
+            const buffer_t base(random_image(width, height, nchannels));
+            buffer_t chain(LLImageBase::getMipChainSize(width, height, nchannels, 3));
+            ensure_equals("levels", LLImageBase::generateMipChain(&base[0], &chain[0], width, height, nchannels, 3), 3);
+
+            buffer_t previous(base);
+            S32 w = width, h = height, offset = 0;
+            for (S32 level = 1; level <= 3; ++level)
+            {
+                w >>= 1;
+                h >>= 1;
+                buffer_t mip(w * h * nchannels);
+                LLImageBase::generateMip(&previous[0], &mip[0], w, h, nchannels);
+                ensure_equals(stringize("offset ", level), offset, LLImageBase::getMipChainSize(width, height, nchannels, level - 1));
+                ensure(stringize(nchannels, " level ", level), std::equal(mip.begin(), mip.end(), chain.begin() + offset));
+                offset += S32(mip.size());
+                previous.swap(mip);
+            }
+            ensure_equals("size", offset, S32(chain.size()));
+        }
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("odd and thin sizes down to 1x1");
+        ensure_equals("1x1", LLImageBase::getMipChainSize(1, 1, 4, 10), 0);
+        ensure_equals("4x1", LLImageBase::getMipChainSize(4, 1, 3, 10), 2 * 3 + 1 * 3);
+        const S32 sizes[][2] = { { 64, 64 }, { 37, 23 }, { 96, 40 }, { 1, 64 }, { 64, 1 }, { 2, 2 }, { 300, 7 } };
+        for (const auto& size : sizes)
+        {
+            for (S32 nchannels = 1; nchannels <= 4; ++nchannels)
+            {
+                ensure_reference_chain(size[0], size[1], nchannels);
+            }
+        }
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("gamma correct filtering");
+        // flat images stay flat, color and alpha alike
+        for (S32 value = 0; value < 256; ++value)
+        {
+            const buffer_t base(16 * 16 * 4, U8(value));
+            buffer_t chain(LLImageBase::getMipChainSize(16, 16, 4, 10));
+            LLImageBase::generateMipChain(&base[0], &chain[0], 16, 16, 4, 10, true);
+            for (size_t i = 0; i < chain.size(); ++i)
+            {
+                if (chain[i] != value)
+                {
+                    fail(stringize("flat ", value, " byte ", i, ": got ", S32(chain[i])));
+                }
+            }
+        }
+
+        // black and white columns average to half the light, not half the
+        // sRGB value; alpha averages as stored
+        for (S32 nchannels : { 2, 3, 4 })
+        {
+            buffer_t base(8 * 8 * nchannels);
+            for (S32 i = 0; i < 8 * 8; ++i)
+            {
+                for (S32 c = 0; c < nchannels; ++c)
+                {
+                    base[i * nchannels + c] = (i & 1) ? 255 : 0;
+                }
+            }
+            buffer_t chain(LLImageBase::getMipChainSize(8, 8, nchannels, 1));
+            LLImageBase::generateMipChain(&base[0], &chain[0], 8, 8, nchannels, 1, true);
+            for (S32 i = 0; i < 4 * 4; ++i)
+            {
+                for (S32 c = 0; c < nchannels; ++c)
+                {
+                    const bool alpha = (nchannels == 4 && c == 3) || (nchannels == 2 && c == 1);
+                    ensure_equals(stringize(nchannels, " channel ", c), S32(chain[i * nchannels + c]), alpha ? 128 : 188);
+                }
+            }
+        }
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("split across a work queue");
+        LL::WorkQueue queue("llimagemip_test");
+        std::vector<std::thread> workers;
+        for (S32 i = 0; i < 3; ++i)
+        {
+            workers.emplace_back([&queue]() { queue.runUntilClose(); });
+        }
+
+        for (bool srgb : { false, true })
+        {
+            const S32 width = 1024, height = 512, nchannels = 4;
+            const buffer_t base(random_image(width, height, nchannels));
+            buffer_t alone(LLImageBase::getMipChainSize(width, height, nchannels, 20)), shared(alone.size());
+            LLImageBase::setMipWorkQueue(std::string(), 0);
+            LLImageBase::generateMipChain(&base[0], &alone[0], width, height, nchannels, 20, srgb);
+            LLImageBase::setMipWorkQueue("llimagemip_test", 3, 0);
+            LLImageBase::generateMipChain(&base[0], &shared[0], width, height, nchannels, 20, srgb);
+            ensure(stringize("srgb ", srgb), alone == shared);
+        }
+
+        LLImageBase::setMipWorkQueue(std::string(), 0);
+        queue.close();
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+} // namespace tut
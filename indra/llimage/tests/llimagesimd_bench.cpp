@@ -0,0 +1,176 @@
+/**
+ * @file   llimagesimd_bench.cpp
+ * @date   2026-10-18
+ * @brief  Time the LLImageSIMD kernels at each instruction set.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "llimagesimd.h"
+
+namespace
+{
+    typedef std::vector<U8> buffer_t;
+    typedef std::function<void(const LLImageSIMD::Kernels&)> job_t;
+
+    buffer_t make_buffer(S32 size)
+    {
+        buffer_t buffer(size);
+        U32 x = 0x9e3779b9;
+        for (U8& byte : buffer)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            byte = U8(x);
+        }
+        return buffer;
+    }
+
+    // Returns the median time in milliseconds.
+    F64 measure(const job_t& job, const LLImageSIMD::Kernels& kernels, S32 runs)
+    {
+        std::vector<F64> times;
+        for (S32 run = 0; run < runs; ++run)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            job(kernels);
+            const auto stop = std::chrono::steady_clock::now();
+            times.push_back(std::chrono::duration<F64, std::milli>(stop - start).count());
+        }
+        std::sort(times.begin(), times.end());
+        return times[times.size() / 2];
+    }
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    S32 runs = 15;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        if (arg == "--runs" && i + 1 < argc)
+        {
+            runs = llmax(atoi(argv[++i]), 1);
+        }
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--runs N]\n";
+            return 1;
+        }
+    }
+
+    std::vector<LLImageSIMD::ELevel> levels;
+    for (S32 level = LLImageSIMD::SCALAR; level < LLImageSIMD::NUM_LEVELS; ++level)
+    {
+        if (LLImageSIMD::isSupported(LLImageSIMD::ELevel(level)))
+        {
+            levels.push_back(LLImageSIMD::ELevel(level));
+        }
+    }
+
+    std::cout << std::setw(26) << "kernel" << std::setw(6) << "size";
+    for (LLImageSIMD::ELevel level : levels)
+    {
+        std::cout << std::setw(10) << LLImageSIMD::getLevelName(level);
+    }
+    std::cout << std::setw(10) << "speedup" << "   (median ms)\n";
+
+    for (S32 size : { 256, 512, 1024, 2048 })
+    {
+        const S32 pixels = size * size;
+        const buffer_t rgba(make_buffer(pixels * 4));
+        const buffer_t rgb(make_buffer(pixels * 3));
+        buffer_t out(pixels * 4);
+        const U8 color[4] = { 12, 34, 56, 255 };
+        const F32 tint[3] = { 0.9f, 1.1f, 0.5f };
+
+        const std::vector<std::pair<std::string, job_t>> jobs =
+        {
+            { "fill RGBA", [&](const LLImageSIMD::Kernels& k) { k.fill(&out[0], pixels, 4, color); } },
+            { "fill RGB", [&](const LLImageSIMD::Kernels& k) { k.fill(&out[0], pixels, 3, color); } },
+            { "tint RGB", [&](const LLImageSIMD::Kernels& k) { k.tint(&out[0], pixels, 3, tint); } },
+            { "copy4onto3", [&](const LLImageSIMD::Kernels& k) { k.copy4onto3(&rgba[0], &out[0], pixels); } },
+            { "copy3onto4", [&](const LLImageSIMD::Kernels& k) { k.copy3onto4(&rgb[0], &out[0], pixels); } },
+            { "composite4onto3", [&](const LLImageSIMD::Kernels& k)
+                {
+                    out.assign(rgb.begin(), rgb.end());
+                    k.composite4onto3(&rgba[0], &out[0], pixels);
+                } },
+            { "copyLineScaled RGBA 1/2", [&](const LLImageSIMD::Kernels& k)
+                {
+                    for (S32 row = 0; row < size; ++row)
+                    {
+                        k.copyLineScaled(&rgba[row * size * 4], &out[row * size * 2], size, size / 2, 1, 1, 4);
+                    }
+                } },
+            { "compositeRowScaled 1/2", [&](const LLImageSIMD::Kernels& k)
+                {
+                    for (S32 row = 0; row < size; ++row)
+                    {
+                        k.compositeRowScaled4onto3(&rgba[row * size * 4], &out[row * size * 3 / 2], size, size / 2);
+                    }
+                } },
+            { "bilinearScale RGBA 1/2", [&](const LLImageSIMD::Kernels& k)
+                {
+                    k.bilinearScale(&rgba[0], size, size, size * 4, &out[0], size / 2, size / 2, size * 2, 4);
+                } },
+            { "bilinearScale RGB 1/2", [&](const LLImageSIMD::Kernels& k)
+                {
+                    k.bilinearScale(&rgb[0], size, size, size * 3, &out[0], size / 2, size / 2, size * 3 / 2, 3);
+                } },
+            { "bilinearScale RGBA 3/4", [&](const LLImageSIMD::Kernels& k)
+                {
+                    k.bilinearScale(&rgba[0], size / 2, size / 2, size * 2, &out[0], size * 3 / 4, size * 3 / 4, size * 3, 4);
+                } },
+        };
+
+        for (const auto& job : jobs)
+        {
+            std::cout << std::setw(26) << job.first << std::setw(6) << size << std::fixed << std::setprecision(3);
+            F64 scalar_ms = 0.0, best_ms = 0.0;
+            for (LLImageSIMD::ELevel level : levels)
+            {
+                LLImageSIMD::setLevel(level);
+                const F64 ms = measure(job.second, LLImageSIMD::get(), runs);
+                scalar_ms = level == LLImageSIMD::SCALAR ? ms : scalar_ms;
+                best_ms = ms;
+                std::cout << std::setw(10) << ms;
+            }
+            std::cout << std::setprecision(2) << std::setw(9) << (best_ms > 0.0 ? scalar_ms / best_ms : 0.0) << "x" << std::endl;
+        }
+    }
+
+    LLImageSIMD::setLevel(LLImageSIMD::getBestLevel());
+    return 0;
+}
@@ -0,0 +1,302 @@
+/**
+ * @file   llimagesimd_test.cpp
+ * @date   2026-10-18
+ * @brief  Test the vector pixel kernels against the scalar ones.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+// Precompiled header
+#include "linden_common.h"
+// associated header
+#include "../llimagesimd.h"
+// STL headers
+#include <cstdlib>
+#include <vector>
+// std headers
+// external library headers
+// other Linden headers
+#include "../test/lltut.h"
+#include "stringize.h"
+
+/*****************************************************************************
+*   TUT
+*****************************************************************************/
+namespace tut
+{
+    struct llimagesimd_data
+    {
+        typedef std::vector<U8> buffer_t;
+
+        llimagesimd_data():
+            mSavedLevel(LLImageSIMD::getLevel()),
+            mSeed(0x2545f491)
+        {
+            for (S32 level = LLImageSIMD::SCALAR + 1; level < LLImageSIMD::NUM_LEVELS; ++level)
+            {
+                if (LLImageSIMD::isSupported(LLImageSIMD::ELevel(level)))
+                {
+                    mLevels.push_back(LLImageSIMD::ELevel(level));
+                }
+            }
+        }
+
+        ~llimagesimd_data()
+        {
+            LLImageSIMD::setLevel(mSavedLevel);
+        }
+
+        const LLImageSIMD::Kernels& reference() const
+        {
+            return *LLImageSIMD::scalar::getKernels();
+        }
+
+        const LLImageSIMD::Kernels& kernels(LLImageSIMD::ELevel level)
+        {
+            ensure(LLImageSIMD::getLevelName(level), LLImageSIMD::setLevel(level));
+            return LLImageSIMD::get();
+        }
+
+        U32 random()
+        {
+            mSeed ^= mSeed << 13;
+            mSeed ^= mSeed >> 17;
+            mSeed ^= mSeed << 5;
+            return mSeed;
+        }
+
+        buffer_t random_buffer(S32 size)
+        {
+            buffer_t buffer(size);
+            for (U8& byte : buffer)
+            {
+                byte = U8(random());
+            }
+            return buffer;
+        }
+
+        // Random pixels whose alpha is mostly 0 or 255, as in real images.
+        buffer_t random_rgba(S32 pixels)
+        {
+            buffer_t buffer(random_buffer(pixels * 4));
+            for (S32 i = 0; i < pixels; ++i)
+            {
+                const U32 r = random() % 4;
+                buffer[i * 4 + 3] = r == 0 ? 0 : r == 1 ? 255 : buffer[i * 4 + 3];
+            }
+            return buffer;
+        }
+
+        void ensure_near(const std::string& msg, const buffer_t& expected, const buffer_t& actual, S32 tolerance)
+        {
+            ensure_equals(msg + " size", actual.size(), expected.size());
+            for (size_t i = 0; i < expected.size(); ++i)
+            {
+                if (abs(S32(expected[i]) - S32(actual[i])) > tolerance)
+                {
+                    fail(stringize(msg, " byte ", i, ": expected ", S32(expected[i]), ", got ", S32(actual[i])));
+                }
+            }
+        }
+
+        std::vector<LLImageSIMD::ELevel> mLevels;
+        LLImageSIMD::ELevel mSavedLevel;
+        U32 mSeed;
+    };
+    typedef test_group<llimagesimd_data> llimagesimd_group;
+    typedef llimagesimd_group::object object;
+    llimagesimd_group llimagesimdgrp("LLImageSIMD");
+
+    // pixel counts around the vector widths
+    const S32 PIXEL_COUNTS[] = { 1, 3, 4, 5, 15, 16, 17, 31, 32, 33, 100, 1021 };
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("levels");
+        ensure("scalar", LLImageSIMD::isSupported(LLImageSIMD::SCALAR));
+        ensure("best", LLImageSIMD::isSupported(LLImageSIMD::getBestLevel()));
+        ensure("bogus", ! LLImageSIMD::isSupported(LLImageSIMD::NUM_LEVELS));
+        ensure("set bogus", ! LLImageSIMD::setLevel(LLImageSIMD::NUM_LEVELS));
+        ensure_equals("unchanged", LLImageSIMD::getLevel(), mSavedLevel);
+        ensure("set scalar", LLImageSIMD::setLevel(LLImageSIMD::SCALAR));
+        ensure("scalar table", &LLImageSIMD::get() == &reference());
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("fill and tint");
+        for (LLImageSIMD::ELevel level : mLevels)
+        {
+            const LLImageSIMD::Kernels& k = kernels(level);
+            for (S32 components = 3; components <= 4; ++components)
+            {
+                for (S32 pixels : PIXEL_COUNTS)
+                {
+                    const std::string msg(stringize(LLImageSIMD::getLevelName(level), " ", components, "x", pixels));
+                    const buffer_t color(random_buffer(4));
+                    buffer_t expected(random_buffer(pixels * components + 7)), actual(expected);
+                    reference().fill(&expected[0], pixels, components, &color[0]);
+                    k.fill(&actual[0], pixels, components, &color[0]);
+                    ensure_near(msg + " fill", expected, actual, 0);
+
+                    // up to 1.5 to exercise the clamp
+                    const F32 tint[3] = { (random() % 1536) / 1024.f, (random() % 1536) / 1024.f, (random() % 1536) / 1024.f };
+                    expected = actual = random_buffer(pixels * components + 7);
+                    reference().tint(&expected[0], pixels, components, tint);
+                    k.tint(&actual[0], pixels, components, tint);
+                    ensure_near(msg + " tint", expected, actual, 0);
+                }
+            }
+        }
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("channel conversion and compositing");
+        for (LLImageSIMD::ELevel level : mLevels)
+        {
+            const LLImageSIMD::Kernels& k = kernels(level);
+            for (S32 pixels : PIXEL_COUNTS)
+            {
+                const std::string msg(stringize(LLImageSIMD::getLevelName(level), " ", pixels));
+                const buffer_t rgba(random_rgba(pixels));
+                const buffer_t rgb(random_buffer(pixels * 3));
+
+                buffer_t expected(random_buffer(pixels * 3 + 5)), actual(expected);
+                reference().copy4onto3(&rgba[0], &expected[0], pixels);
+                k.copy4onto3(&rgba[0], &actual[0], pixels);
+                ensure_near(msg + " copy4onto3", expected, actual, 0);
+
+                expected = actual = random_buffer(pixels * 4 + 5);
+                reference().copy3onto4(&rgb[0], &expected[0], pixels);
+                k.copy3onto4(&rgb[0], &actual[0], pixels);
+                ensure_near(msg + " copy3onto4", expected, actual, 0);
+
+                expected = actual = rgb;
+                reference().composite4onto3(&rgba[0], &expected[0], pixels);
+                k.composite4onto3(&rgba[0], &actual[0], pixels);
+                ensure_near(msg + " composite4onto3", expected, actual, 0);
+            }
+        }
+    }
+
+    template<> template<>
+    void object::test<4>()
+    {
+        set_test_name("box filters");
+        const S32 lengths[][2] = { { 7, 3 }, { 64, 16 }, { 100, 33 }, { 33, 100 }, { 5, 17 }, { 256, 255 }, { 1000, 7 } };
+        for (LLImageSIMD::ELevel level : mLevels)
+        {
+            const LLImageSIMD::Kernels& k = kernels(level);
+            for (const auto& length : lengths)
+            {
+                const S32 in_len = length[0], out_len = length[1];
+                for (S32 components = 1; components <= 4; ++components)
+                {
+                    // a column of an image 3 pixels wide, as LLImageRaw::composite() walks them
+                    const std::string msg(stringize(LLImageSIMD::getLevelName(level), " ", in_len, "->", out_len, "x", components));
+                    const buffer_t in(random_buffer(in_len * components * 3));
+                    buffer_t expected(random_buffer(out_len * components * 3)), actual(expected);
+                    reference().copyLineScaled(&in[0], &expected[0], in_len, out_len, 3, 3, components);
+                    k.copyLineScaled(&in[0], &actual[0], in_len, out_len, 3, 3, components);
+                    // the float sums may be contracted differently
+                    ensure_near(msg + " copyLineScaled", expected, actual, 1);
+                }
+
+                const std::string msg(stringize(LLImageSIMD::getLevelName(level), " ", in_len, "->", out_len));
+                const buffer_t in(random_rgba(in_len));
+                buffer_t expected(random_buffer(out_len * 3)), actual(expected);
+                reference().compositeRowScaled4onto3(&in[0], &expected[0], in_len, out_len);
+                k.compositeRowScaled4onto3(&in[0], &actual[0], in_len, out_len);
+                ensure_near(msg + " compositeRowScaled4onto3", expected, actual, 1);
+            }
+        }
+    }
+
+    template<> template<>
+    void object::test<5>()
+    {
+        set_test_name("bilinear scaling");
+        // every combination of growing and shrinking in each direction
+        const U32 sizes[][4] = { { 37, 29, 80, 70 }, { 37, 29, 80, 13 }, { 37, 29, 13, 70 }, { 97, 61, 31, 17 },
+                                 { 64, 64, 32, 32 }, { 16, 16, 16, 16 }, { 1, 1, 9, 5 }, { 255, 3, 4, 1 } };
+        for (LLImageSIMD::ELevel level : mLevels)
+        {
+            const LLImageSIMD::Kernels& k = kernels(level);
+            for (const auto& size : sizes)
+            {
+                for (U32 components : { 1U, 3U, 4U })
+                {
+                    const std::string msg(stringize(LLImageSIMD::getLevelName(level), " ", size[0], "x", size[1],
+                                                    "->", size[2], "x", size[3], "x", components));
+                    const buffer_t src(random_buffer(size[0] * size[1] * components));
+                    buffer_t expected(size[2] * size[3] * components), actual(expected);
+                    reference().bilinearScale(&src[0], size[0], size[1], size[0] * components,
+                                              &expected[0], size[2], size[3], size[2] * components, components);
+                    k.bilinearScale(&src[0], size[0], size[1], size[0] * components,
+                                    &actual[0], size[2], size[3], size[2] * components, components);
+                    ensure_near(msg, expected, actual, 0);
+                }
+            }
+        }
+    }
+
+    template<> template<>
+    void object::test<6>()
+    {
+        set_test_name("mip downsampling");
+        for (LLImageSIMD::ELevel level : mLevels)
+        {
+            const LLImageSIMD::Kernels& k = kernels(level);
+            for (S32 components = 1; components <= 4; ++components)
+            {
+                for (S32 pixels : PIXEL_COUNTS)
+                {
+                    const std::string msg(stringize(LLImageSIMD::getLevelName(level), " ", components, "x", pixels));
+                    const buffer_t row0(random_buffer(pixels * components * 2)), row1(random_buffer(pixels * components * 2));
+                    buffer_t expected(random_buffer(pixels * components + 3)), actual(expected);
+                    reference().downsample2x2(&row0[0], &row1[0], &expected[0], pixels, components);
+                    k.downsample2x2(&row0[0], &row1[0], &actual[0], pixels, components);
+                    ensure_near(msg + " downsample2x2", expected, actual, 0);
+
+                    if (3 == components)
+                    {
+                        continue;
+                    }
+                    std::vector<U16> wide0(pixels * components * 2), wide1(wide0.size());
+                    for (size_t i = 0; i < wide0.size(); ++i)
+                    {
+                        wide0[i] = U16(random());
+                        wide1[i] = U16(random());
+                    }
+                    std::vector<U16> expected16(pixels * components + 3, 7), actual16(expected16);
+                    reference().downsample2x2U16(&wide0[0], &wide1[0], &expected16[0], pixels, components);
+                    k.downsample2x2U16(&wide0[0], &wide1[0], &actual16[0], pixels, components);
+                    ensure(msg + " downsample2x2U16", expected16 == actual16);
+                }
+            }
+        }
+    }
+} // namespace tut
@@ -29,6 +29,7 @@
 #include "linden_common.h"
 // Class to test
 #include "../llimageworker.h"
+#include "../llimagedxt.h"
 // For timer class
 #include "../llcommon/lltimer.h"
 // for lltrace class
@@ -61,6 +62,7 @@ void LLImageBase::deleteData() { }
 U8* LLImageBase::allocateData(S32 size) { return NULL; }
 U8* LLImageBase::reallocateData(S32 size) { return NULL; }
 
+LLImageRaw::LLImageRaw() { }
 LLImageRaw::LLImageRaw(U16 width, U16 height, S8 components) { }
 LLImageRaw::~LLImageRaw() { }
 void LLImageRaw::deleteData() { }
@@ -69,6 +71,12 @@ U8* LLImageRaw::reallocateData(S32 size) { return NULL; }
 const U8* LLImageBase::getData() const { return NULL; }
 U8* LLImageBase::getData() { return NULL; }
 const std::string& LLImage::getLastThreadError() { static std::string msg; return msg; }
+S8 LLImageFormatted::getCodec() const { return IMG_CODEC_INVALID; }
+LLImageDXT::EFileFormat LLImageDXT::getBlockFormat(S32 ncomponents, LLImageBCn::EQuality quality, bool allow_bc7) { return FORMAT_UNKNOWN; }
+LLPointer<LLImageDXT> LLImageDXT::createBlocks(const LLImageRaw* raw_image, EFileFormat format, LLImageBCn::EQuality quality,
+                                               const std::string& filename, U32 unique_id) { return NULL; }
+LLPointer<LLImageDXT> LLImageDXT::loadBlocks(const std::string& filename, EFileFormat format, S32 width, S32 height,
+                                             S32 discard_level, LLImageRaw* raw_image) { return NULL; }
 
 // End Stubbing
 // -------------------------------------------------------------------------------------------
@@ -0,0 +1,189 @@
+/**
+ * @file   llimagej2coj_bench.cpp
+ * @date   2026-10-18
+ * @brief  Measure OpenJPEG decode latency against the number of decode threads.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "llimage.h"
+#include "llimagej2c.h"
+#include "llpointer.h"
+
+namespace
+{
+    // The image takes ownership of the buffer, as with the texture fetcher.
+    LLPointer<LLImageJ2C> make_j2c(const U8* data, S32 size)
+    {
+        LLPointer<LLImageJ2C> j2c = new LLImageJ2C;
+        U8* buffer = (U8*)ll_aligned_malloc_16(size);
+        memcpy(buffer, data, size);
+        j2c->setData(buffer, size);
+        if (!j2c->updateData())
+        {
+            return NULL;
+        }
+        return j2c;
+    }
+
+    // A gradient with some noise on top, so the encoder can't make the
+    // code-blocks trivially small and the decode does real work.
+    LLPointer<LLImageJ2C> make_test_image(S32 size)
+    {
+        LLPointer<LLImageRaw> raw = new LLImageRaw(U16(size), U16(size), 3);
+        U8* data = raw->getData();
+        U32 x = 0x9e3779b9;
+        for (S32 row = 0; row < size; ++row)
+        {
+            for (S32 col = 0; col < size; ++col)
+            {
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                U8* pixel = data + (row * size + col) * 3;
+                pixel[0] = U8((col * 255 / size + (x & 0x1f)) & 0xff);
+                pixel[1] = U8((row * 255 / size + ((x >> 8) & 0x1f)) & 0xff);
+                pixel[2] = U8(((col + row) * 127 / size + ((x >> 16) & 0x1f)) & 0xff);
+            }
+        }
+        LLPointer<LLImageJ2C> j2c = new LLImageJ2C;
+        if (!j2c->encode(raw, 0.f))
+        {
+            return NULL;
+        }
+        return make_j2c(j2c->getData(), j2c->getDataSize());
+    }
+
+    LLPointer<LLImageJ2C> load_test_image(const std::string& filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        std::vector<U8> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (bytes.empty())
+        {
+            return NULL;
+        }
+        return make_j2c(bytes.data(), S32(bytes.size()));
+    }
+
+    // Returns the median time in milliseconds of a full resolution decode.
+    F64 measure(LLImageJ2C* source, S32 threads, S32 runs)
+    {
+        // decode from a fresh copy of the stream, as the texture fetcher would
+        LLPointer<LLImageJ2C> j2c = make_j2c(source->getData(), source->getDataSize());
+        j2c->setDecodeThreads(threads);
+
+        std::vector<F64> times;
+        for (S32 run = 0; run < runs; ++run)
+        {
+            j2c->setDiscardLevel(0);
+            LLPointer<LLImageRaw> raw = new LLImageRaw(j2c->getWidth(), j2c->getHeight(), j2c->getComponents());
+            const auto start = std::chrono::steady_clock::now();
+            j2c->decode(raw, 0.f);
+            const auto stop = std::chrono::steady_clock::now();
+            times.push_back(std::chrono::duration<F64, std::milli>(stop - start).count());
+        }
+        std::sort(times.begin(), times.end());
+        return times[times.size() / 2];
+    }
+} // anonymous namespace
+
+int main(int argc, char** argv)
+{
+    S32 runs = 9;
+    S32 max_threads = 8;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg(argv[i]);
+        if (arg == "--runs" && i + 1 < argc)
+        {
+            runs = llmax(atoi(argv[++i]), 1);
+        }
+        else if (arg == "--threads" && i + 1 < argc)
+        {
+            max_threads = llmax(atoi(argv[++i]), 1);
+        }
+        else if (arg == "--file" && i + 1 < argc)
+        {
+            files.push_back(argv[++i]);
+        }
+        else
+        {
+            std::cerr << "usage: " << argv[0] << " [--runs N] [--threads MAX] [--file image.j2c ...]\n";
+            return 1;
+        }
+    }
+
+    LLImage::initClass();
+    std::cout << LLImageJ2C::getEngineInfo() << "\n";
+
+    std::vector<std::pair<std::string, LLPointer<LLImageJ2C>>> images;
+    if (files.empty())
+    {
+        for (S32 size : { 1024, 2048 })
+        {
+            images.emplace_back(llformat("%dx%d", size, size), make_test_image(size));
+        }
+    }
+    for (const std::string& file : files)
+    {
+        images.emplace_back(file, load_test_image(file));
+    }
+
+    std::cout << std::setw(8) << "threads";
+    for (const auto& image : images)
+    {
+        std::cout << std::setw(16) << image.first.substr(0, 15);
+    }
+    std::cout << "   (median ms, discard 0)\n";
+    for (S32 threads = 1; threads <= max_threads; threads *= 2)
+    {
+        std::cout << std::setw(8) << threads << std::fixed << std::setprecision(1);
+        for (const auto& image : images)
+        {
+            if (image.second.isNull())
+            {
+                std::cout << std::setw(16) << "-";
+                continue;
+            }
+            std::cout << std::setw(16) << measure(image.second, threads, runs);
+        }
+        std::cout << std::endl;
+    }
+
+    images.clear();
+    LLImage::cleanupClass();
+    return 0;
+}
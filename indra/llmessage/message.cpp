@@ -2388,7 +2388,6 @@ void process_deny_trusted_circuit(LLMessageSystem *msg, void **)
 
 void dump_prehash_files()
 {
-    U32 i;
     std::string filename("../../indra/llmessage/message_prehash.h");
     LLFILE* fp = LLFile::fopen(filename, "w");  /* Flawfinder: ignore */
     if (fp)
@@ -2410,11 +2409,11 @@ void dump_prehash_files()
             " */\n",
             gMessageSystem->mMessageFileVersionNumber);
         fprintf(fp, "\n\nextern F32 const gPrehashVersionNumber;\n\n");
-        for (i = 0; i < MESSAGE_NUMBER_OF_HASH_BUCKETS; i++)
+        for (const std::string& name : LLMessageStringTable::getInstance()->getStrings())
         {
-            if (!LLMessageStringTable::getInstance()->mEmpty[i] && LLMessageStringTable::getInstance()->mString[i][0] != '.')
+            if (!name.empty() && name[0] != '.')
             {
-                fprintf(fp, "extern char const* const _PREHASH_%s;\n", LLMessageStringTable::getInstance()->mString[i]);
+                fprintf(fp, "extern char const* const _PREHASH_%s;\n", name.c_str());
             }
         }
         fprintf(fp, "\n\n#endif\n");
@@ -2440,11 +2439,11 @@ void dump_prehash_files()
         fprintf(fp, "#include \"linden_common.h\"\n");
         fprintf(fp, "#include \"message.h\"\n\n");
         fprintf(fp, "\n\nF32 const gPrehashVersionNumber = %.3ff;\n\n", gMessageSystem->mMessageFileVersionNumber);
-        for (i = 0; i < MESSAGE_NUMBER_OF_HASH_BUCKETS; i++)
+        for (const std::string& name : LLMessageStringTable::getInstance()->getStrings())
         {
-            if (!LLMessageStringTable::getInstance()->mEmpty[i] && LLMessageStringTable::getInstance()->mString[i][0] != '.')
+            if (!name.empty() && name[0] != '.')
             {
-                fprintf(fp, "char const* const _PREHASH_%s = LLMessageStringTable::getInstance()->getString(\"%s\");\n", LLMessageStringTable::getInstance()->mString[i], LLMessageStringTable::getInstance()->mString[i]);
+                fprintf(fp, "char const* const _PREHASH_%s = LLMessageStringTable::getInstance()->getString(\"%s\");\n", name.c_str(), name.c_str());
             }
         }
         fclose(fp);
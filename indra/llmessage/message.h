@@ -71,11 +71,15 @@ class LLMessageStringTable : public LLSingleton<LLMessageStringTable>
     ~LLMessageStringTable();
 
 public:
+    // Safe to call from any thread. Names longer than
+    // MESSAGE_MAX_STRINGS_LENGTH - 1 are truncated.
     char *getString(const char *str);
 
-    U32  mUsed;
-    bool mEmpty[MESSAGE_NUMBER_OF_HASH_BUCKETS];
-    char mString[MESSAGE_NUMBER_OF_HASH_BUCKETS][MESSAGE_MAX_STRINGS_LENGTH];   /* Flawfinder: ignore */
+    // every name interned so far, sorted
+    std::vector<std::string> getStrings() const;
+
+private:
+    LLConcurrentStringTable mTable;
 };
 
 
@@ -34,6 +34,7 @@
 #include "llerror.h"
 #include "llfasttimer.h"
 #include "llimage.h"
+#include "llimagedxt.h"
 
 #include "llmath.h"
 #include "llgl.h"
@@ -142,6 +143,7 @@ bool LLImageGL::sGlobalUseAnisotropic   = false;
 F32 LLImageGL::sLastFrameTime           = 0.f;
 LLImageGL* LLImageGL::sDefaultGLTexture = NULL ;
 bool LLImageGL::sCompressTextures = false;
+bool LLImageGL::sGammaCorrectMips = false;
 std::unordered_set<LLImageGL*> LLImageGL::sImageList;
 
 
@@ -316,6 +318,7 @@ S32 LLImageGL::dataFormatBits(S32 dataformat)
     case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:    return 8;
     case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:          return 8;
     case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:    return 8;
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:             return 8;
     case GL_LUMINANCE:                              return 8;
     case GL_LUMINANCE8:                             return 8;
     case GL_ALPHA:                                  return 8;
@@ -363,6 +366,7 @@ S64 LLImageGL::dataFormatBytes(S32 dataformat, S32 width, S32 height)
     case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
     case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
     case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
         if (width < 4) width = 4;
         if (height < 4) height = 4;
         break;
@@ -385,6 +389,7 @@ S32 LLImageGL::dataFormatComponents(S32 dataformat)
       case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT: return 4;
       case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:    return 4;
       case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT: return 4;
+      case GL_COMPRESSED_RGBA_BPTC_UNORM:       return 4;
       case GL_LUMINANCE:                        return 1;
       case GL_ALPHA:                            return 1;
       case GL_RED:                              return 1;
@@ -795,6 +800,11 @@ bool LLImageGL::setImage(const U8* data_in, bool data_hasmips /* = false */, S32
                 if (is_compressed)
                 {
                     GLsizei tex_size = (GLsizei)dataFormatBytes(mFormatPrimary, w, h);
+                    if (gl_level == 0)
+                    {
+                        free_cur_tex_image();
+                        alloc_tex_image(w, h, mFormatPrimary, 1);
+                    }
                     glCompressedTexImage2D(mTarget, gl_level, mFormatPrimary, w, h, 0, tex_size, (GLvoid *)data_in);
                     stop_glerror();
                 }
@@ -881,71 +891,45 @@ bool LLImageGL::setImage(const U8* data_in, bool data_hasmips /* = false */, S32
                 S32 nummips = mMaxDiscardLevel - mCurrentDiscardLevel + 1;
                 S32 w = width, h = height;
 
-
-                const U8* new_data = 0;
-                (void)new_data;
-
-                const U8* prev_mip_data = 0;
-                const U8* cur_mip_data = 0;
-#ifdef SHOW_ASSERT
-                S32 cur_mip_size = 0;
-#endif
-                mMipLevels = nummips;
-
-                for (int m=0; m<nummips; m++)
+                // all the levels below the base come out of one pass over
+                // data_in, into one buffer
+                U8* chain_data = NULL;
+                if (nummips > 1)
                 {
-                    if (m==0)
+                    chain_data = new(std::nothrow) U8[LLImageBase::getMipChainSize(width, height, mComponents, nummips - 1)];
+                    if (!chain_data)
                     {
-                        cur_mip_data = data_in;
-#ifdef SHOW_ASSERT
-                        cur_mip_size = width * height * mComponents;
-#endif
+                        stop_glerror();
+                        mGLTextureCreated = false;
+                        return false;
                     }
-                    else
+                    bool srgb = false;
+                    if (sGammaCorrectMips)
                     {
-                        S32 bytes = w * h * mComponents;
-#ifdef SHOW_ASSERT
-                        llassert(prev_mip_data);
-                        llassert(cur_mip_size == bytes*4);
-#endif
-                        U8* new_data = new(std::nothrow) U8[bytes];
-                        if (!new_data)
+                        switch (mFormatInternal)
                         {
-                            stop_glerror();
-
-                            if (prev_mip_data)
-                            {
-                                if (prev_mip_data != cur_mip_data)
-                                    delete[] prev_mip_data;
-                                prev_mip_data = nullptr;
-                            }
-                            if (cur_mip_data)
-                            {
-                                delete[] cur_mip_data;
-                                cur_mip_data = nullptr;
-                            }
-
-                            mGLTextureCreated = false;
-                            return false;
-                        }
-                        else
-                        {
-
-#ifdef SHOW_ASSERT
-                            llassert(prev_mip_data);
-                            llassert(cur_mip_size == bytes * 4);
-#endif
-
-                            LLImageBase::generateMip(prev_mip_data, new_data, w, h, mComponents);
-                            cur_mip_data = new_data;
-#ifdef SHOW_ASSERT
-                            cur_mip_size = bytes;
-#endif
+                        case GL_SRGB:
+                        case GL_SRGB8:
+                        case GL_SRGB_ALPHA:
+                        case GL_SRGB8_ALPHA8:
+                            srgb = true;
+                            break;
+                        default:
+                            break;
                         }
+                    }
+                    nummips = LLImageBase::generateMipChain(data_in, chain_data, width, height, mComponents, nummips - 1, srgb) + 1;
+                }
+                mMipLevels = nummips;
 
+                const U8* cur_mip_data = data_in;
+                for (int m=0; m<nummips; m++)
+                {
+                    if (m > 0)
+                    {
+                        cur_mip_data = chain_data + LLImageBase::getMipChainSize(width, height, mComponents, m - 1);
                     }
                     llassert(w > 0 && h > 0 && cur_mip_data);
-                    (void)cur_mip_data;
                     {
                         if(mFormatSwapBytes)
                         {
@@ -970,19 +954,10 @@ bool LLImageGL::setImage(const U8* data_in, bool data_hasmips /* = false */, S32
                             stop_glerror();
                         }
                     }
-                    if (prev_mip_data && prev_mip_data != data_in)
-                    {
-                        delete[] prev_mip_data;
-                    }
-                    prev_mip_data = cur_mip_data;
-                    w >>= 1;
-                    h >>= 1;
-                }
-                if (prev_mip_data && prev_mip_data != data_in)
-                {
-                    delete[] prev_mip_data;
-                    prev_mip_data = NULL;
+                    w = llmax(w >> 1, 1);
+                    h = llmax(h >> 1, 1);
                 }
+                delete[] chain_data;
             }
         }
         else
@@ -998,6 +973,8 @@ bool LLImageGL::setImage(const U8* data_in, bool data_hasmips /* = false */, S32
         if (is_compressed)
         {
             GLsizei tex_size = (GLsizei)dataFormatBytes(mFormatPrimary, w, h);
+            free_cur_tex_image();
+            alloc_tex_image(w, h, mFormatPrimary, 1);
             glCompressedTexImage2D(mTarget, 0, mFormatPrimary, w, h, 0, tex_size, (GLvoid *)data_in);
             stop_glerror();
         }
@@ -1529,6 +1506,77 @@ bool LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
     checkActiveThread();
 
+    if (!setRawFormat(discard_level, imageraw))
+    {
+        return false;
+    }
+
+    if(!to_create) //not create a gl texture
+    {
+        destroyGLTexture();
+        mCurrentDiscardLevel = discard_level;
+        mLastBindTime = sLastFrameTime;
+        mGLTextureCreated = false;
+        return true ;
+    }
+
+    setCategory(category);
+    const U8* rawdata = imageraw->getData();
+    return createGLTexture(discard_level, rawdata, false, usename, defer_copy, tex_name);
+}
+
+bool LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, LLImageDXT* blocks, S32 usename, S32 category)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    checkActiveThread();
+
+    S32 mip = blocks ? blocks->getDiscardLevel() : -1;
+    if (mip < 0 || !mAllowCompression
+        || (blocks->getFileFormat() == LLImageDXT::FORMAT_DXR7 && !gGLManager.mHasBPTC))
+    {
+        return createGLTexture(discard_level, imageraw, usename, true, category);
+    }
+
+    // the raw image sets the size and the formats alpha analysis and the pick mask read
+    if (!setRawFormat(discard_level, imageraw))
+    {
+        return false;
+    }
+    discard_level = llclamp(discard_level, 0, (S32)mMaxDiscardLevel);
+    if (mHasExplicitFormat
+        || (blocks->getWidth() >> mip) != imageraw->getWidth()
+        || (blocks->getHeight() >> mip) != imageraw->getHeight()
+        || (mUseMipMaps && LLImageDXT::calcNumMips(blocks->getWidth(), blocks->getHeight()) - mip <= mMaxDiscardLevel - discard_level))
+    {
+        // an explicit format wins, and the blocks must match raw and have
+        // every mip GL will ask for
+        setCategory(category);
+        return createGLTexture(discard_level, imageraw->getData(), false, usename);
+    }
+    analyzeAlpha(imageraw->getData(), imageraw->getWidth(), imageraw->getHeight());
+    updatePickMask(imageraw->getWidth(), imageraw->getHeight(), imageraw->getData());
+
+    switch (blocks->getFileFormat())
+    {
+      case LLImageDXT::FORMAT_DXR1:
+        mFormatPrimary = mFormatInternal = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        break;
+      case LLImageDXT::FORMAT_DXR5:
+        mFormatPrimary = mFormatInternal = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        break;
+      default:
+        mFormatPrimary = mFormatInternal = GL_COMPRESSED_RGBA_BPTC_UNORM;
+        break;
+    }
+
+    // smaller mips are stored before the one for discard_level
+    setCategory(category);
+    const U8* data = blocks->getData() + blocks->getMipOffset(mip);
+    return createGLTexture(discard_level, data, mUseMipMaps, usename);
+}
+
+bool LLImageGL::setRawFormat(S32& discard_level, const LLImageRaw* imageraw)
+{
     if (gGLManager.mIsDisabled)
     {
         LL_WARNS() << "Trying to create a texture while GL is disabled!" << LL_ENDL;
@@ -1608,18 +1656,7 @@ bool LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S
         calcAlphaChannelOffsetAndStride() ;
     }
 
-    if(!to_create) //not create a gl texture
-    {
-        destroyGLTexture();
-        mCurrentDiscardLevel = discard_level;
-        mLastBindTime = sLastFrameTime;
-        mGLTextureCreated = false;
-        return true ;
-    }
-
-    setCategory(category);
-    const U8* rawdata = imageraw->getData();
-    return createGLTexture(discard_level, rawdata, false, usename, defer_copy, tex_name);
+    return true;
 }
 
 bool LLImageGL::createGLTexture(S32 discard_level, const U8* data_in, bool data_hasmips, S32 usename, bool defer_copy, LLGLuint* tex_name)
@@ -1892,7 +1929,9 @@ bool LLImageGL::readBackRaw(S32 discard_level, LLImageRaw* imageraw, bool compre
             return false ;
         }
 
-        glGetTexImage(GL_TEXTURE_2D, gl_discard, mFormatPrimary, mFormatType, (GLvoid*)(imageraw->getData()));
+        // blocks are read back expanded
+        const GLenum format = isCompressed() ? (ncomponents == 4 ? GL_RGBA : GL_RGB) : mFormatPrimary;
+        glGetTexImage(GL_TEXTURE_2D, gl_discard, format, mFormatType, (GLvoid*)(imageraw->getData()));
         //stop_glerror();
     }
 
@@ -2298,7 +2337,7 @@ void LLImageGL::freePickMask()
     mPickMaskWidth = mPickMaskHeight = 0;
 }
 
-bool LLImageGL::isCompressed()
+bool LLImageGL::isCompressed() const
 {
     llassert(mFormatPrimary != 0);
     // *NOTE: Not all compressed formats are included here.
@@ -2311,6 +2350,7 @@ bool LLImageGL::isCompressed()
     case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
     case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
     case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM:
         is_compressed = true;
         break;
     default:
@@ -2445,6 +2485,7 @@ bool LLImageGL::scaleDown(S32 desired_discard)
 
     if (mTarget != GL_TEXTURE_2D
         || mFormatInternal == -1 // not initialized
+        || isCompressed() // can't be drawn into or read back as blocks
         )
     {
         return false;
@@ -43,6 +43,7 @@
 
 #define LL_IMAGEGL_THREAD_CHECK 0 //set to 1 to enable thread debugging for ImageGL
 
+class LLImageDXT;
 class LLWindow;
 
 #define BYTES_TO_MEGA_BYTES(x) ((x) >> 20)
@@ -127,6 +128,12 @@ public:
     bool createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S32 usename = 0, bool to_create = true,
         S32 category = sMaxCategories-1, bool defer_copy = false, LLGLuint* tex_name = nullptr);
     bool createGLTexture(S32 discard_level, const U8* data, bool data_hasmips = false, S32 usename = 0, bool defer_copy = false, LLGLuint* tex_name = nullptr);
+    // Upload blocks, the block compressed copy of imageraw (see
+    // LLImageDXT::encodeBlocks(), its discard level picks the mip that
+    // matches imageraw), in place of imageraw where the GL and this texture
+    // allow. imageraw still feeds alpha analysis and the pick mask.
+    bool createGLTexture(S32 discard_level, const LLImageRaw* imageraw, LLImageDXT* blocks, S32 usename = 0,
+        S32 category = sMaxCategories-1);
     void setImage(const LLImageRaw* imageraw);
     bool setImage(const U8* data_in, bool data_hasmips = false, S32 usename = 0);
     // *TODO: This function may not work if the textures is compressed (i.e.
@@ -232,7 +239,10 @@ public:
 private:
     U32 createPickMask(S32 pWidth, S32 pHeight);
     void freePickMask();
-    bool isCompressed();
+    bool isCompressed() const;
+    // Size the texture and pick its formats for imageraw at discard_level
+    // (-1 for the current one), false if it can't be.
+    bool setRawFormat(S32& discard_level, const LLImageRaw* imageraw);
 
     LLPointer<LLImageRaw> mSaveData; // used for destroyGL/restoreGL
     LL::WorkQueue::weak_t mMainQueue;
@@ -292,6 +302,7 @@ public:
     static LLImageGL* sDefaultGLTexture ;
     static bool sAutomatedTest;
     static bool sCompressTextures;          //use GL texture compression
+    static bool sGammaCorrectMips;          //average sRGB texels in linear space when building mips by hand
 #if DEBUG_MISS
     bool mMissed; // Missed on last bind?
     bool getMissed() const { return mMissed; };
@@ -40,7 +40,7 @@
 // LLXmlTree
 
 // static
-LLStdStringTable LLXmlTree::sAttributeKeys(1024);
+LLConcurrentStringTable LLXmlTree::sAttributeKeys(1024);
 
 LLXmlTree::LLXmlTree()
     : mRoot( NULL ),
@@ -69,8 +69,8 @@ public:
     }
 
 public:
-    // global
-    static LLStdStringTable sAttributeKeys;
+    // global, so shared by trees parsed on any thread
+    static LLConcurrentStringTable sAttributeKeys;
 
 protected:
     LLXmlTreeNode* mRoot;
@@ -80,6 +80,7 @@
 #include "llstartup.h"
 #include "llstatusbar.h"
 #include "llteleportflags.h"
+#include "llteleportwarmup.h"
 #include "lltool.h"
 #include "lltoolbarview.h"
 #include "lltoolpie.h"
@@ -4971,6 +4972,7 @@ void LLAgent::startTeleportRequest()
 void LLAgent::handleTeleportFinished()
 {
     LL_INFOS("Teleport") << "Agent handling teleport finished." << LL_ENDL;
+    LLTeleportWarmup::instance().finish(mRegionp ? mRegionp->getHandle() : 0);
     if (mTPNeedsNeabyChatSeparator)
     {
         // parcel is ready at this point
@@ -5016,6 +5018,7 @@ void LLAgent::handleTeleportFinished()
 void LLAgent::handleTeleportFailed()
 {
     LL_WARNS("Teleport") << "Agent handling teleport failure!" << LL_ENDL;
+    LLTeleportWarmup::instance().finish(0);
     if(LLVoiceClient::instanceExists())
     {
         LLVoiceClient::getInstance()->setHidden(false);
@@ -5133,6 +5136,8 @@ void LLAgent::teleportRequest(const U64& region_handle, const LLVector3& pos_loc
 //      }
         msg->addVector3("LookAt", look_at);
         sendReliableMessage();
+
+        LLTeleportWarmup::instance().start(region_handle);
     }
 }
 
@@ -5170,6 +5175,15 @@ void LLAgent::teleportViaLandmark(const LLUUID& landmark_asset_id)
     startTeleportRequest();
 }
 
+// The handle of the region at pos_global for LLTeleportWarmup, or 0 if the
+// world map doesn't know it. Var-regions span several 256m grid tiles, so the
+// tile handle of a position isn't necessarily its region's handle.
+static U64 warmup_region_handle(const LLVector3d& pos_global)
+{
+    LLSimInfo* sim_info = LLWorldMap::getInstance()->simInfoFromPosGlobal(pos_global);
+    return sim_info ? sim_info->getHandle() : 0;
+}
+
 void LLAgent::doTeleportViaLandmark(const LLUUID& landmark_asset_id)
 {
     LLViewerRegion* regionp = getRegion();
@@ -5180,11 +5194,18 @@ void LLAgent::doTeleportViaLandmark(const LLUUID& landmark_asset_id)
     }
 
     bool is_local(false);
-    if (LLLandmark* landmark = gLandmarkList.getAsset(landmark_asset_id, NULL))
+    U64 destination_handle(0);
+    if (landmark_asset_id.isNull())
+    {
+        // home
+        destination_handle = mHaveHomePosition ? mHomeRegionHandle : 0;
+    }
+    else if (LLLandmark* landmark = gLandmarkList.getAsset(landmark_asset_id, NULL))
     {
         LLVector3d pos_global;
-        landmark->getGlobalPos(pos_global);
+        bool known = landmark->getGlobalPos(pos_global);
         is_local = (regionp->getHandle() == to_region_handle_global((F32)pos_global.mdV[VX], (F32)pos_global.mdV[VY]));
+        destination_handle = known ? warmup_region_handle(pos_global) : 0;
     }
 
     if(regionp && teleportCore(is_local))
@@ -5201,6 +5222,8 @@ void LLAgent::doTeleportViaLandmark(const LLUUID& landmark_asset_id)
         msg->addUUIDFast(_PREHASH_SessionID, getSessionID());
         msg->addUUIDFast(_PREHASH_LandmarkID, landmark_asset_id);
         sendReliableMessage();
+
+        LLTeleportWarmup::instance().start(destination_handle);
     }
 }
 
@@ -5415,6 +5438,10 @@ void LLAgent::doTeleportViaLocation(const LLVector3d& pos_global)
         msg->addVector3Fast(_PREHASH_LookAt, pos_local);
 
         sendReliableMessage();
+        if (!is_local)
+        {
+            LLTeleportWarmup::instance().start(warmup_region_handle(pos_global));
+        }
         LL_INFOS("Teleport") << "Sending deprecated TeleportLocationRequest."
                              << " pos_global " << pos_global
                              << " region coord (" << (pos_global.mdV[VX] - pos_local.mV[VX])
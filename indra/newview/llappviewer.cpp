@@ -37,6 +37,7 @@
 #include "llerrorcontrol.h"
 #include "lleventtimer.h"
 #include "llfile.h"
+#include "llframearena.h"
 #include "llviewertexturelist.h"
 #include "llgroupmgr.h"
 #include "llagent.h"
@@ -69,6 +70,7 @@
 #endif
 #include "lltexturestats.h"
 #include "lltrace.h"
+#include "lltracecapture.h"
 #include "lltracethreadrecorder.h"
 #include "llviewerwindow.h"
 #include "llviewerdisplay.h"
@@ -101,6 +103,7 @@
 #include "llprogressview.h"
 #include "llvocache.h"
 #include "lldiskcache.h"
+#include "llasyncfilesystem.h"
 #include "llvopartgroup.h"
 // [SL:KB] - Patch: Appearance-Misc | Checked: 2013-02-12 (Catznip-3.4)
 #include "llappearancemgr.h"
@@ -131,6 +134,7 @@
 #include "llavatarnamecache.h"
 #include "lldiriterator.h"
 #include "llexperiencecache.h"
+#include "llimagebufferpool.h"
 #include "llimagej2c.h"
 #include "llmemory.h"
 #include "llprimitive.h"
@@ -599,6 +603,8 @@ static void settings_to_globals()
     LLRender::sNsightDebugSupport = gSavedSettings.getBOOL("RenderNsightDebugSupport");
     LLImageGL::sGlobalUseAnisotropic    = gSavedSettings.getBOOL("RenderAnisotropic");
     LLImageGL::sCompressTextures        = gSavedSettings.getBOOL("RenderCompressTextures");
+    LLImageGL::sGammaCorrectMips        = gSavedSettings.getBOOL("RenderGammaCorrectMips");
+    LLImageBufferPool::setLimit((size_t)gSavedSettings.getU32("ImageBufferPoolSizeMB") * 1024 * 1024);
     LLVOVolume::sLODFactor              = llclamp(gSavedSettings.getF32("RenderVolumeLODFactor"), 0.01f, MAX_LOD_FACTOR);
     LLVOVolume::sDistanceFactor         = 1.f-LLVOVolume::sLODFactor * 0.1f;
     LLVolumeImplFlexible::sUpdateFactor = gSavedSettings.getF32("RenderFlexTimeFactor");
@@ -1155,6 +1161,12 @@ bool LLAppViewer::init()
 
     LLFolderViewItem::initClass(); // SJB: Needs to happen after initWindow(), not sure why but related to fonts
 
+    // The decode threads only make BC7 if the GPU can take it
+    const U32 transcode_preset = gSavedSettings.getU32("TextureTranscodePreset");
+    LLAppViewer::getImageDecodeThread()->setTranscode(transcode_preset != 0,
+                                                      transcode_preset >= 2 ? LLImageBCn::HIGH : LLImageBCn::FAST,
+                                                      gGLManager.mHasBPTC);
+
     gGLManager.getGLInfo(gDebugInfo);
     gGLManager.printGLInfoString();
 
@@ -1541,6 +1553,10 @@ bool LLAppViewer::frame()
         }
     }
 
+    // Per-frame scratch memory is only good until here, however doFrame()
+    // ended.
+    gFrameArena.reset();
+
     return ret;
 }
 
@@ -1959,6 +1975,16 @@ void LLAppViewer::flushLFSIO()
 
 bool LLAppViewer::cleanup()
 {
+    // write out a capture still running at exit
+    if (LLTrace::TraceCapture::isRecording())
+    {
+        gSavedSettings.setBOOL("TraceCaptureEnabled", false);
+    }
+
+    LL_INFOS("FrameArena") << "Frame arena high water " << gFrameArena.getHighWater()
+                           << " bytes, capacity " << gFrameArena.getCapacity()
+                           << ", " << gFrameArena.getOverflowCount() << " overflowing frames" << LL_ENDL;
+
     LLAtmosphere::cleanupClass();
 
     //ditch LLVOAvatarSelf instance
@@ -2437,6 +2463,7 @@ bool LLAppViewer::cleanup()
     sPurgeDiskCacheThread->shutdown();
     if (mGeneralThreadPool)
     {
+        LLImageBase::setMipWorkQueue(std::string(), 0);
         mGeneralThreadPool->close();
     }
 
@@ -2468,6 +2495,7 @@ bool LLAppViewer::cleanup()
     mFastTimerLogThread = NULL;
     delete sPurgeDiskCacheThread;
     sPurgeDiskCacheThread = NULL;
+    LLAsyncFileSystem::deleteSingleton();
     delete mGeneralThreadPool;
     mGeneralThreadPool = NULL;
 
@@ -2570,12 +2598,20 @@ void LLAppViewer::initGeneralThread()
 
     mGeneralThreadPool = new LL::ThreadPool("General", 3);
     mGeneralThreadPool->start();
+    // large textures share their CPU mip generation with the General pool
+    LLImageBase::setMipWorkQueue("General", (S32)mGeneralThreadPool->getWidth());
 }
 
 bool LLAppViewer::initThreads()
 {
     static const bool enable_threads = true;
 
+    LLTrace::TraceCapture::setThreadName("Main");
+    if (gSavedSettings.getBOOL("TraceCaptureEnabled"))
+    {
+        LLTrace::TraceCapture::start(gSavedSettings.getU32("TraceCaptureBufferSize"));
+    }
+
     LLImage::initClass(gSavedSettings.getBOOL("TextureNewByteRange"),gSavedSettings.getS32("TextureReverseByteRange"));
 
     LLLFSThread::initClass(enable_threads && true); // TODO: fix crashes associated with this shutdo
@@ -2608,11 +2644,21 @@ bool LLAppViewer::initThreads()
         image_decode_count = llclamp((S32)max_decodes, 1, 32);
     }
     // <FS:Ansariel>
-    threadCounts["ImageDecode"] = image_decode_count;
+    // keep any other options (e.g. work_stealing) given in map form
+    if (threadCounts["ImageDecode"].isMap())
+    {
+        threadCounts["ImageDecode"]["width"] = image_decode_count;
+    }
+    else
+    {
+        threadCounts["ImageDecode"] = image_decode_count;
+    }
     gSavedSettings.setLLSD("ThreadPoolSizes", threadCounts);
 
     // Image decoding
     LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && true);
+    LLAppViewer::sImageDecodeThread->setParallelDecode(gSavedSettings.getU32("ImageDecodeMaxThreadsPerImage"),
+                                                       gSavedSettings.getU32("ImageDecodeParallelMinPixels"));
     LLAppViewer::sTextureCache = new LLTextureCache(enable_threads && true);
     LLAppViewer::sTextureFetch = new LLTextureFetch(LLAppViewer::getTextureCache(),
                                                     enable_threads && true,
@@ -2623,6 +2669,9 @@ bool LLAppViewer::initThreads()
 
     LLAppViewer::sPurgeDiskCacheThread = new LLPurgeDiskCacheThread();
 
+    // batched asset cache reads, e.g. for mesh LODs
+    LLAsyncFileSystem::createInstance();
+
     if (LLTrace::BlockTimer::sLog || LLTrace::BlockTimer::sMetricLog)
     {
         LLTrace::BlockTimer::setLogLock(new LLMutex());
@@ -5092,7 +5141,7 @@ U32 LLAppViewer::getObjectCacheVersion()
 {
     // Viewer object cache version, change if object update
     // format changes. JC
-    const U32 INDRA_OBJECT_CACHE_VERSION = 17;
+    const U32 INDRA_OBJECT_CACHE_VERSION = 19;
 
     return INDRA_OBJECT_CACHE_VERSION;
 }
@@ -5207,6 +5256,11 @@ bool LLAppViewer::initCache()
     // LLDiskCache::initParamSingleton(cache_dir, disk_cache_size, enable_cache_debug_info);
     LLDiskCache::initParamSingleton(cache_dir, disk_cache_size, enable_cache_debug_info, gSavedSettings.getF32("FSDiskCacheHighWaterPercent"), gSavedSettings.getF32("FSDiskCacheLowWaterPercent"));
     // </FS:Beq>
+    if (gSavedSettings.getBOOL("DiskCachePackSmallAssets"))
+    {
+        LLDiskCache::getInstance()->setPackMaxAssetSize(gSavedSettings.getU32("DiskCachePackMaxAssetSize"));
+    }
+    LLDiskCache::getInstance()->setCompression(gSavedSettings.getBOOL("DiskCacheCompression"));
 
     if (!read_only)
     {
@@ -610,7 +610,9 @@ void LLGLTFMaterialList::onAssetLoadComplete(const LLUUID& id, LLAssetType::ETyp
             asset_data->mMaterial->materialComplete(true);
 
             delete asset_data;
-        });
+        },
+        // decoding materials mustn't hold up more urgent work on General
+        LL::WorkQueue::PRIORITY_BACKGROUND);
     }
 }
 
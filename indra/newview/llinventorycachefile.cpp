@@ -0,0 +1,559 @@
+/**
+ * @file   llinventorycachefile.cpp
+ * @date   2026-10-18
+ * @brief  Binary columnar inventory cache file.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llinventorycachefile.h"
+
+#include "lldir.h"
+#include "llmappedfile.h"
+#include "llviewerinventory.h"
+#include "workqueue.h"
+
+#include <atomic>
+#include <future>
+
+static const char * const LOG_INV("Inventory");
+
+namespace
+{
+    const char CACHE_MAGIC[8] = { 'L', 'L', 'I', 'N', 'V', 'C', '0', '1' };
+
+    struct CacheHeader
+    {
+        char mMagic[8];
+        S32 mCacheVersion;
+        U32 mCategoryCount;
+        U32 mItemCount;
+        U32 mCategoryOffset;
+        U32 mItemOffset;
+        U32 mHeapOffset;
+        U32 mHeapSize;
+        U32 mReserved;
+    };
+
+    // a name or description in the string heap
+    struct StringRef
+    {
+        U32 mOffset;
+        U32 mLength;
+    };
+
+    // columns start on a 4 byte boundary so they can be read in place
+    const size_t COLUMN_ALIGNMENT = 4;
+
+    // the item section is split into at most this many slices, each at
+    // least MIN_ITEMS_PER_SLICE long; all but the first go to the general
+    // queue
+    const size_t MAX_ITEM_SLICES = 4;
+    const size_t MIN_ITEMS_PER_SLICE = 4096;
+
+    size_t align_column(size_t offset)
+    {
+        return (offset + COLUMN_ALIGNMENT - 1) & ~(COLUMN_ALIGNMENT - 1);
+    }
+
+    class ColumnWriter
+    {
+    public:
+        ColumnWriter(size_t start) : mBuffer(start, 0) {}
+
+        template <typename T, typename ARRAY, typename GETTER>
+        void column(const ARRAY& objects, GETTER get)
+        {
+            size_t offset = align_column(mBuffer.size());
+            mBuffer.resize(offset + objects.size() * sizeof(T), 0);
+            for (const auto& object : objects)
+            {
+                const T value = get(object);
+                memcpy(&mBuffer[offset], &value, sizeof(T));
+                offset += sizeof(T);
+            }
+        }
+
+        StringRef addString(const std::string& str)
+        {
+            StringRef ref = { (U32)mHeap.size(), (U32)str.size() };
+            mHeap.append(str);
+            return ref;
+        }
+
+        size_t size() const { return mBuffer.size(); }
+
+        std::vector<U8> mBuffer;
+        std::string mHeap;
+    };
+
+    class ColumnReader
+    {
+    public:
+        ColumnReader(const U8* data, size_t end, size_t offset) :
+            mData(data),
+            mEnd(end),
+            mOffset(offset)
+        {}
+
+        template <typename T>
+        bool column(const T*& column, size_t count)
+        {
+            mOffset = align_column(mOffset);
+            if (mOffset > mEnd || count > (mEnd - mOffset) / sizeof(T))
+            {
+                return false;
+            }
+            column = reinterpret_cast<const T*>(mData + mOffset);
+            mOffset += count * sizeof(T);
+            return true;
+        }
+
+    private:
+        const U8* mData;
+        size_t mEnd;
+        size_t mOffset;
+    };
+
+    struct StringHeap
+    {
+        const char* mData;
+        size_t mSize;
+
+        bool get(const StringRef& ref, std::string& str) const
+        {
+            if (ref.mOffset > mSize || ref.mLength > mSize - ref.mOffset)
+            {
+                return false;
+            }
+            str.assign(mData + ref.mOffset, ref.mLength);
+            return true;
+        }
+    };
+
+    // write() and read() must visit the columns in the same order
+    struct CategoryColumns
+    {
+        const LLUUID* mID;
+        const LLUUID* mParent;
+        const LLUUID* mThumbnail;
+        const LLUUID* mOwner;
+        const S32* mVersion;
+        const StringRef* mName;
+        const S8* mType;
+        const S8* mPreferredType;
+
+        static void write(ColumnWriter& writer, const LLInventoryCacheFile::cat_array_t& cats)
+        {
+            writer.column<LLUUID>(cats, [](const auto& cat) { return cat->getUUID(); });
+            writer.column<LLUUID>(cats, [](const auto& cat) { return cat->getParentUUID(); });
+            writer.column<LLUUID>(cats, [](const auto& cat) { return cat->getThumbnailUUID(); });
+            writer.column<LLUUID>(cats, [](const auto& cat) { return cat->getOwnerID(); });
+            writer.column<S32>(cats, [](const auto& cat) { return cat->getVersion(); });
+            writer.column<StringRef>(cats, [&writer](const auto& cat) { return writer.addString(cat->getName()); });
+            writer.column<S8>(cats, [](const auto& cat) { return (S8)cat->getActualType(); });
+            writer.column<S8>(cats, [](const auto& cat) { return (S8)cat->getPreferredType(); });
+        }
+
+        bool read(ColumnReader& reader, size_t count)
+        {
+            return reader.column(mID, count)
+                && reader.column(mParent, count)
+                && reader.column(mThumbnail, count)
+                && reader.column(mOwner, count)
+                && reader.column(mVersion, count)
+                && reader.column(mName, count)
+                && reader.column(mType, count)
+                && reader.column(mPreferredType, count);
+        }
+    };
+
+    // Items are written from their own fields, not through the virtual
+    // getters: those follow links to the linked item.
+    struct ItemColumns
+    {
+        const LLUUID* mID;
+        const LLUUID* mParent;
+        const LLUUID* mThumbnail;
+        const LLUUID* mAsset;
+        const LLUUID* mCreator;
+        const LLUUID* mOwner;
+        const LLUUID* mLastOwner;
+        const LLUUID* mGroup;
+        const U32* mMaskBase;
+        const U32* mMaskOwner;
+        const U32* mMaskGroup;
+        const U32* mMaskEveryone;
+        const U32* mMaskNext;
+        const U32* mFlags;
+        const S32* mSalePrice;
+        const S32* mCreationDate;
+        const StringRef* mName;
+        const StringRef* mDescription;
+        const S8* mType;
+        const S8* mInventoryType;
+        const S8* mSaleType;
+
+        static void write(ColumnWriter& writer, const LLInventoryCacheFile::item_array_t& items)
+        {
+            writer.column<LLUUID>(items, [](const auto& item) { return item->LLInventoryItem::getUUID(); });
+            writer.column<LLUUID>(items, [](const auto& item) { return item->getParentUUID(); });
+            writer.column<LLUUID>(items, [](const auto& item) { return item->LLInventoryItem::getThumbnailUUID(); });
+            writer.column<LLUUID>(items, [](const auto& item) { return item->LLInventoryItem::getAssetUUID(); });
+            writer.column<LLUUID>(items, [](const auto& item) { return item->LLInventoryItem::getPermissions().getCreator(); });
+            writer.column<LLUUID>(items, [](const auto& item) { return item->LLInventoryItem::getPermissions().getOwner(); });
+            writer.column<LLUUID>(items, [](const auto& item) { return item->LLInventoryItem::getPermissions().getLastOwner(); });
+            writer.column<LLUUID>(items, [](const auto& item) { return item->LLInventoryItem::getPermissions().getGroup(); });
+            writer.column<U32>(items, [](const auto& item) { return item->LLInventoryItem::getPermissions().getMaskBase(); });
+            writer.column<U32>(items, [](const auto& item) { return item->LLInventoryItem::getPermissions().getMaskOwner(); });
+            writer.column<U32>(items, [](const auto& item) { return item->LLInventoryItem::getPermissions().getMaskGroup(); });
+            writer.column<U32>(items, [](const auto& item) { return item->LLInventoryItem::getPermissions().getMaskEveryone(); });
+            writer.column<U32>(items, [](const auto& item) { return item->LLInventoryItem::getPermissions().getMaskNextOwner(); });
+            writer.column<U32>(items, [](const auto& item) { return item->LLInventoryItem::getFlags(); });
+            writer.column<S32>(items, [](const auto& item) { return item->LLInventoryItem::getSaleInfo().getSalePrice(); });
+            writer.column<S32>(items, [](const auto& item) { return (S32)item->LLInventoryItem::getCreationDate(); });
+            writer.column<StringRef>(items, [&writer](const auto& item) { return writer.addString(item->LLInventoryItem::getName()); });
+            writer.column<StringRef>(items, [&writer](const auto& item) { return writer.addString(item->getActualDescription()); });
+            writer.column<S8>(items, [](const auto& item) { return (S8)item->getActualType(); });
+            writer.column<S8>(items, [](const auto& item) { return (S8)item->LLInventoryItem::getInventoryType(); });
+            writer.column<S8>(items, [](const auto& item) { return (S8)item->LLInventoryItem::getSaleInfo().getSaleType(); });
+        }
+
+        bool read(ColumnReader& reader, size_t count)
+        {
+            return reader.column(mID, count)
+                && reader.column(mParent, count)
+                && reader.column(mThumbnail, count)
+                && reader.column(mAsset, count)
+                && reader.column(mCreator, count)
+                && reader.column(mOwner, count)
+                && reader.column(mLastOwner, count)
+                && reader.column(mGroup, count)
+                && reader.column(mMaskBase, count)
+                && reader.column(mMaskOwner, count)
+                && reader.column(mMaskGroup, count)
+                && reader.column(mMaskEveryone, count)
+                && reader.column(mMaskNext, count)
+                && reader.column(mFlags, count)
+                && reader.column(mSalePrice, count)
+                && reader.column(mCreationDate, count)
+                && reader.column(mName, count)
+                && reader.column(mDescription, count)
+                && reader.column(mType, count)
+                && reader.column(mInventoryType, count)
+                && reader.column(mSaleType, count);
+        }
+    };
+
+    bool decode_categories(const CategoryColumns& columns, const StringHeap& heap, size_t count,
+                           LLInventoryCacheFile::cat_array_t& categories)
+    {
+        LL_PROFILE_ZONE_SCOPED;
+        categories.reserve(count);
+        std::string name;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (!heap.get(columns.mName[i], name))
+            {
+                return false;
+            }
+            LLPointer<LLViewerInventoryCategory> cat = new LLViewerInventoryCategory(columns.mOwner[i]);
+            cat->setUUID(columns.mID[i]);
+            cat->setParent(columns.mParent[i]);
+            cat->setThumbnailUUID(columns.mThumbnail[i]);
+            cat->setType((LLAssetType::EType)columns.mType[i]);
+            cat->setPreferredType((LLFolderType::EType)columns.mPreferredType[i]);
+            cat->rename(name);
+            cat->setVersion(columns.mVersion[i]);
+            categories.push_back(cat);
+        }
+        return true;
+    }
+
+    // Runs on the general queue: builds items without touching the model.
+    bool decode_items(const ItemColumns& columns, const StringHeap& heap, size_t begin, size_t end,
+                      LLInventoryCacheFile::item_array_t& items,
+                      LLInventoryCacheFile::changed_items_t& cats_to_update)
+    {
+        LL_PROFILE_ZONE_SCOPED;
+        items.reserve(end - begin);
+        std::string name;
+        std::string desc;
+        for (size_t i = begin; i < end; ++i)
+        {
+            const LLUUID& item_id = columns.mID[i];
+            if (item_id.isNull())
+            {
+                LL_DEBUGS(LOG_INV) << "Ignoring inventory with null item id" << LL_ENDL;
+                continue;
+            }
+            const LLAssetType::EType type = (LLAssetType::EType)columns.mType[i];
+            if (type == LLAssetType::AT_UNKNOWN)
+            {
+                cats_to_update.insert(columns.mParent[i]);
+                continue;
+            }
+            if (!heap.get(columns.mName[i], name) || !heap.get(columns.mDescription[i], desc))
+            {
+                return false;
+            }
+
+            LLPermissions perm;
+            perm.init(columns.mCreator[i], columns.mOwner[i], columns.mLastOwner[i], columns.mGroup[i]);
+            perm.setMaskBase(columns.mMaskBase[i]);
+            perm.setMaskOwner(columns.mMaskOwner[i]);
+            perm.setMaskEveryone(columns.mMaskEveryone[i]);
+            perm.setMaskGroup(columns.mMaskGroup[i]);
+            perm.setMaskNext(columns.mMaskNext[i]);
+            perm.fix();
+
+            // same repair as LLInventoryItem::fromLLSD()
+            LLInventoryType::EType inv_type = (LLInventoryType::EType)columns.mInventoryType[i];
+            if (LLInventoryType::IT_NONE == inv_type || !inventory_and_asset_types_match(inv_type, type))
+            {
+                inv_type = LLInventoryType::defaultForAssetType(type);
+            }
+
+            LLPointer<LLViewerInventoryItem> item = new LLViewerInventoryItem(
+                item_id, columns.mParent[i], perm, columns.mAsset[i], type, inv_type, name, desc,
+                LLSaleInfo((LLSaleInfo::EForSale)columns.mSaleType[i], columns.mSalePrice[i]),
+                columns.mFlags[i], (time_t)columns.mCreationDate[i]);
+            item->setThumbnailUUID(columns.mThumbnail[i]);
+            // like an item read from the LLSD cache, it still has to be fetched
+            item->setComplete(false);
+            items.push_back(item);
+        }
+        return true;
+    }
+
+    struct ItemSlice
+    {
+        size_t mBegin{ 0 };
+        size_t mEnd{ 0 };
+        LLInventoryCacheFile::item_array_t mItems;
+        LLInventoryCacheFile::changed_items_t mCatsToUpdate;
+        // set by whichever of the general queue and the loading thread
+        // gets to the slice first
+        std::atomic<bool> mClaimed{ false };
+        std::promise<bool> mDecoded;
+    };
+}
+
+// static
+bool LLInventoryCacheFile::save(const std::string& filename,
+                                S32 cache_version,
+                                const cat_array_t& categories,
+                                const item_array_t& items)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    if (filename.empty())
+    {
+        LL_WARNS(LOG_INV) << "Filename is empty, unable to save inventory" << LL_ENDL;
+        return false;
+    }
+
+    LL_INFOS(LOG_INV) << "saving inventory to: (" << filename << ")" << LL_ENDL;
+
+    cat_array_t cached_categories;
+    cached_categories.reserve(categories.size());
+    for (const auto& cat : categories)
+    {
+        if (cat->getVersion() != LLViewerInventoryCategory::VERSION_UNKNOWN)
+        {
+            cached_categories.push_back(cat);
+        }
+    }
+
+    CacheHeader header = {};
+    memcpy(header.mMagic, CACHE_MAGIC, sizeof(header.mMagic));
+    header.mCacheVersion = cache_version;
+    header.mCategoryCount = (U32)cached_categories.size();
+    header.mItemCount = (U32)items.size();
+
+    ColumnWriter writer(sizeof(CacheHeader));
+    header.mCategoryOffset = (U32)writer.size();
+    CategoryColumns::write(writer, cached_categories);
+    header.mItemOffset = (U32)writer.size();
+    ItemColumns::write(writer, items);
+    header.mHeapOffset = (U32)writer.size();
+    header.mHeapSize = (U32)writer.mHeap.size();
+    if ((U64)writer.size() + writer.mHeap.size() > U32_MAX)
+    {
+        LL_WARNS(LOG_INV) << "Inventory too large for the cache file, not saving" << LL_ENDL;
+        return false;
+    }
+    memcpy(&writer.mBuffer[0], &header, sizeof(header));
+
+    // Use a temporary file, then move it over the old cache: another
+    // instance may be reading it.
+    std::string temp_filename = gDirUtilp->getTempFilename();
+    LLFILE* fp = LLFile::fopen(temp_filename, "wb");
+    if (!fp)
+    {
+        LL_WARNS(LOG_INV) << "Failed to open " << temp_filename << ", unable to save inventory" << LL_ENDL;
+        return false;
+    }
+    bool written = fwrite(writer.mBuffer.data(), 1, writer.mBuffer.size(), fp) == writer.mBuffer.size()
+        && fwrite(writer.mHeap.data(), 1, writer.mHeap.size(), fp) == writer.mHeap.size();
+    written = fclose(fp) == 0 && written;
+    if (!written)
+    {
+        LL_WARNS(LOG_INV) << "Failed to write " << temp_filename << ", unable to save inventory" << LL_ENDL;
+        LLFile::remove(temp_filename);
+        return false;
+    }
+
+    // rename() won't replace an existing file on Windows
+    LLFile::remove(filename, ENOENT);
+    if (LLFile::rename(temp_filename, filename) != 0)
+    {
+        LL_WARNS(LOG_INV) << "Failed to move " << temp_filename << " to " << filename << LL_ENDL;
+        LLFile::remove(temp_filename);
+        return false;
+    }
+
+    LL_DEBUGS(LOG_INV) << "Saved " << header.mCategoryCount << " categories and "
+                       << header.mItemCount << " items to " << filename << LL_ENDL;
+    return true;
+}
+
+// static
+bool LLInventoryCacheFile::load(const std::string& filename,
+                                S32 cache_version,
+                                cat_array_t& categories,
+                                item_array_t& items,
+                                changed_items_t& cats_to_update,
+                                bool& is_cache_obsolete)
+{
+    LL_PROFILE_ZONE_SCOPED;
+    LLMappedFile file;
+    if (!file.map(filename))
+    {
+        LL_DEBUGS(LOG_INV) << "No inventory cache at " << filename << LL_ENDL;
+        return false;
+    }
+    LL_INFOS(LOG_INV) << "loading inventory from: (" << filename << ")" << LL_ENDL;
+
+    is_cache_obsolete = true; // Obsolete until proven current
+
+    CacheHeader header;
+    if (file.size() < sizeof(header))
+    {
+        LL_WARNS(LOG_INV) << "Inventory cache is truncated" << LL_ENDL;
+        return false;
+    }
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.mMagic, CACHE_MAGIC, sizeof(header.mMagic)))
+    {
+        LL_WARNS(LOG_INV) << "Not an inventory cache: " << filename << LL_ENDL;
+        return false;
+    }
+    if (header.mCacheVersion != cache_version)
+    {
+        LL_WARNS(LOG_INV) << "Inventory cache is out of date" << LL_ENDL;
+        return false;
+    }
+
+    CategoryColumns cat_columns;
+    ItemColumns item_columns;
+    ColumnReader cat_reader(file.data(), header.mItemOffset, header.mCategoryOffset);
+    ColumnReader item_reader(file.data(), header.mHeapOffset, header.mItemOffset);
+    if (header.mHeapOffset > file.size()
+        || header.mHeapSize > file.size() - header.mHeapOffset
+        || header.mItemOffset > header.mHeapOffset
+        || header.mCategoryOffset > header.mItemOffset
+        || !cat_columns.read(cat_reader, header.mCategoryCount)
+        || !item_columns.read(item_reader, header.mItemCount))
+    {
+        LL_WARNS(LOG_INV) << "Inventory cache is damaged" << LL_ENDL;
+        return false;
+    }
+    const StringHeap heap = { (const char*)file.data() + header.mHeapOffset, header.mHeapSize };
+
+    // Offer all but the first slice of items to the general queue, decode
+    // the categories meanwhile, then decode whatever slices no worker has
+    // started. A queued task shares ownership of its slice because it may
+    // run after this function has returned; it only touches the columns
+    // if it claims the slice, and a claimed slice is always waited for.
+    const size_t item_count = header.mItemCount;
+    const size_t slice_count = llclamp(item_count / MIN_ITEMS_PER_SLICE, (size_t)1, MAX_ITEM_SLICES);
+    std::vector<std::shared_ptr<ItemSlice>> slices;
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    for (size_t i = 0; i < slice_count; ++i)
+    {
+        std::shared_ptr<ItemSlice> slice = std::make_shared<ItemSlice>();
+        slice->mBegin = item_count * i / slice_count;
+        slice->mEnd = item_count * (i + 1) / slice_count;
+        slices.push_back(slice);
+        if (i > 0 && general_queue)
+        {
+            general_queue->post([slice, &item_columns, &heap]()
+                {
+                    if (slice->mClaimed.exchange(true))
+                    {
+                        return;
+                    }
+                    try
+                    {
+                        slice->mDecoded.set_value(decode_items(item_columns, heap, slice->mBegin, slice->mEnd,
+                                                               slice->mItems, slice->mCatsToUpdate));
+                    }
+                    catch (...)
+                    {
+                        slice->mDecoded.set_exception(std::current_exception());
+                    }
+                });
+        }
+    }
+
+    bool decoded = decode_categories(cat_columns, heap, header.mCategoryCount, categories);
+    for (auto& slice : slices)
+    {
+        if (!slice->mClaimed.exchange(true))
+        {
+            decoded = decode_items(item_columns, heap, slice->mBegin, slice->mEnd,
+                                   slice->mItems, slice->mCatsToUpdate) && decoded;
+        }
+        else
+        {
+            decoded = slice->mDecoded.get_future().get() && decoded;
+        }
+    }
+    if (!decoded)
+    {
+        LL_WARNS(LOG_INV) << "Inventory cache is damaged" << LL_ENDL;
+        categories.clear();
+        return false;
+    }
+
+    items.reserve(items.size() + item_count);
+    for (auto& slice : slices)
+    {
+        items.insert(items.end(), slice->mItems.begin(), slice->mItems.end());
+        cats_to_update.insert(slice->mCatsToUpdate.begin(), slice->mCatsToUpdate.end());
+    }
+
+    is_cache_obsolete = false;
+    return true;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file   llinventorycachefile.h
+ * @date   2026-10-18
+ * @brief  Binary columnar inventory cache file.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYCACHEFILE_H
+#define LL_LLINVENTORYCACHEFILE_H
+
+#include "llinventorymodel.h"
+
+/**
+ * LLInventoryCacheFile reads and writes the binary inventory cache, which
+ * replaces the gzipped LLSD notation file as what LLInventoryModel::cache()
+ * saves and loadSkeleton() reads first.
+ *
+ * The file is a fixed header followed by a category section, an item
+ * section and a string heap. Each section stores its fields as columns:
+ * every UUID of one kind, then every version, and so on, with names and
+ * descriptions as offset/length pairs into the heap. Loading maps the file
+ * and builds inventory objects straight from the columns, with slices of
+ * the item section decoded on the "General" work queue while the main
+ * thread decodes the categories.
+ */
+class LLInventoryCacheFile
+{
+public:
+    typedef LLInventoryModel::cat_array_t cat_array_t;
+    typedef LLInventoryModel::item_array_t item_array_t;
+    typedef LLInventoryModel::changed_items_t changed_items_t;
+
+    // Save categories with a known version, and all items. Written to a
+    // temporary file and moved into place, so a reader never sees it half
+    // written.
+    static bool save(const std::string& filename,
+                     S32 cache_version,
+                     const cat_array_t& categories,
+                     const item_array_t& items);
+
+    // Same contract as LLInventoryModel::loadFromFile(): false if the file
+    // is missing or unusable, with is_cache_obsolete set if it exists but
+    // was written for another cache version or is damaged.
+    static bool load(const std::string& filename,
+                     S32 cache_version,
+                     cat_array_t& categories,
+                     item_array_t& items,
+                     changed_items_t& cats_to_update,
+                     bool& is_cache_obsolete);
+};
+
+#endif // LL_LLINVENTORYCACHEFILE_H
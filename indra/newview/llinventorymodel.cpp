@@ -40,6 +40,7 @@
 #include "lldispatcher.h"
 #include "llinventorypanel.h"
 #include "llinventorybridge.h"
+#include "llinventorycachefile.h"
 #include "llinventoryfunctions.h"
 #include "llinventorymodelbackgroundfetch.h"
 #include "llinventoryobserver.h"
@@ -2556,11 +2557,23 @@ void LLInventoryModel::cache(
         items,
         INCLUDE_TRASH,
         can_cache);
+    std::string inventory_filename = getInvCacheAddres(agent_id);
+    std::string binary_filename(inventory_filename);
+    binary_filename.append(".bin");
+    if (LLInventoryCacheFile::save(binary_filename, sCurrentInvCacheVersion, categories, items))
+    {
+        // the binary cache supersedes any gzipped LLSD one
+        std::string gzip_filename(inventory_filename);
+        gzip_filename.append(".gz");
+        LLFile::remove(gzip_filename, ENOENT);
+        return;
+    }
+
     // Use temporary file to avoid potential conflicts with other
     // instances (even a 'read only' instance unzips into a file)
     std::string temp_file = gDirUtilp->getTempFilename();
     saveToFile(temp_file, categories, items);
-    std::string gzip_filename = getInvCacheAddres(agent_id);
+    std::string gzip_filename(inventory_filename);
     gzip_filename.append(".gz");
     if(gzip_file(temp_file, gzip_filename))
     {
@@ -2886,6 +2899,13 @@ bool LLInventoryModel::loadSkeleton(
             LLFile::remove(inventory_filename);
         }
 
+        std::string binary_filename = inventory_filename + ".bin";
+        if (LLFile::isfile(binary_filename))
+        {
+            LL_INFOS("LLInventoryModel") << "Purging inventory cache file: " << binary_filename << LL_ENDL;
+            LLFile::remove(binary_filename);
+        }
+
         inventory_filename.append(".gz");
         if (LLFile::isfile(inventory_filename))
         {
@@ -2905,6 +2925,13 @@ bool LLInventoryModel::loadSkeleton(
             LLFile::remove(inventory_filename);
         }
 
+        binary_filename = inventory_filename + ".bin";
+        if (LLFile::isfile(binary_filename))
+        {
+            LL_INFOS("LLInventoryModel") << "Purging library cache file: " << binary_filename << LL_ENDL;
+            LLFile::remove(binary_filename);
+        }
+
         inventory_filename.append(".gz");
         if (LLFile::isfile(inventory_filename))
         {
@@ -2973,37 +3000,52 @@ bool LLInventoryModel::loadSkeleton(
         const S32 NO_VERSION = LLViewerInventoryCategory::VERSION_UNKNOWN;
         std::string gzip_filename(inventory_filename);
         gzip_filename.append(".gz");
-        LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+        std::string binary_filename(inventory_filename);
+        binary_filename.append(".bin");
         bool remove_inventory_file = false;
-        if (LLAppViewer::instance()->isSecondInstance())
-        {
-            // Safeguard viewer against trying to unpack file twice
-            // ex: user logs into two accounts simultaneously, so two
-            // viewers are trying to unpack library into same file
-            //
-            // Would be better to do it in gunzip_file, but it doesn't
-            // have access to llfilesystem
-            inventory_filename = gDirUtilp->getTempFilename();
-            remove_inventory_file = true;
-        }
-        if(fp)
-        {
-            fclose(fp);
-            fp = NULL;
-            if(gunzip_file(gzip_filename, inventory_filename))
+        bool is_cache_obsolete = false;
+        bool is_binary_cache_obsolete = false;
+        bool is_cache_loaded = LLInventoryCacheFile::load(binary_filename, sCurrentInvCacheVersion,
+                                                          categories, items, categories_to_update,
+                                                          is_binary_cache_obsolete);
+        if (!is_cache_loaded)
+        {
+            // Fall back on a gzipped LLSD cache left by an older viewer
+            categories.clear();
+            items.clear();
+            categories_to_update.clear();
+
+            LLFILE* fp = LLFile::fopen(gzip_filename, "rb");
+            if (LLAppViewer::instance()->isSecondInstance())
             {
-                // we only want to remove the inventory file if it was
-                // gzipped before we loaded, and we successfully
-                // gunziped it.
+                // Safeguard viewer against trying to unpack file twice
+                // ex: user logs into two accounts simultaneously, so two
+                // viewers are trying to unpack library into same file
+                //
+                // Would be better to do it in gunzip_file, but it doesn't
+                // have access to llfilesystem
+                inventory_filename = gDirUtilp->getTempFilename();
                 remove_inventory_file = true;
             }
-            else
+            if(fp)
             {
-                LL_INFOS(LOG_INV) << "Unable to gunzip " << gzip_filename << LL_ENDL;
+                fclose(fp);
+                fp = NULL;
+                if(gunzip_file(gzip_filename, inventory_filename))
+                {
+                    // we only want to remove the inventory file if it was
+                    // gzipped before we loaded, and we successfully
+                    // gunziped it.
+                    remove_inventory_file = true;
+                }
+                else
+                {
+                    LL_INFOS(LOG_INV) << "Unable to gunzip " << gzip_filename << LL_ENDL;
+                }
             }
+            is_cache_loaded = loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete);
         }
-        bool is_cache_obsolete = false;
-        if (loadFromFile(inventory_filename, categories, items, categories_to_update, is_cache_obsolete))
+        if (is_cache_loaded)
         {
             // We were able to find a cache of files. So, use what we
             // found to generate a set of categories we should add. We
@@ -3198,6 +3240,11 @@ bool LLInventoryModel::loadSkeleton(
             LL_WARNS(LOG_INV) << "Inv cache out of date, removing" << LL_ENDL;
             LLFile::remove(gzip_filename);
         }
+        if(is_binary_cache_obsolete && !LLAppViewer::instance()->isSecondInstance())
+        {
+            LL_WARNS(LOG_INV) << "Binary inv cache out of date, removing" << LL_ENDL;
+            LLFile::remove(binary_filename);
+        }
         categories.clear(); // will unref and delete entries
     }
 
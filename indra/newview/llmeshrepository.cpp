@@ -36,6 +36,7 @@
 #include "llagent.h"
 #include "llappviewer.h"
 #include "llbufferstream.h"
+#include "llcachestats.h"
 #include "llcallbacklist.h"
 #include "lldatapacker.h"
 #include "lldeadmantimer.h"
@@ -48,6 +49,7 @@
 #include "llsd.h"
 #include "llsdutil_math.h"
 #include "llsdserialize.h"
+#include "llsdview.h"
 #include "llthread.h"
 #include "llfilesystem.h"
 #include "llviewercontrol.h"
@@ -867,6 +869,7 @@ void log_upload_error(LLCore::HttpStatus status, const LLSD& content,
 void write_preamble(LLFileSystem &file, S32 header_bytes, S32 flags)
 {
     LLMeshRepository::sCacheBytesWritten += CACHE_PREAMBLE_SIZE;
+    LLCacheStats::wrote(LLCacheStats::MESH, CACHE_PREAMBLE_SIZE);
     file.write((U8*)&CACHE_PREAMBLE_VERSION, sizeof(U32));
     file.write((U8*)&header_bytes, sizeof(U32));
     file.write((U8*)&flags, sizeof(U32));
@@ -979,6 +982,7 @@ void LLMeshRepoThread::run()
 
         mSignal->wait();
         LL_PROFILE_ZONE_NAMED("mesh_thread_loop")
+        LL_TRACE_CAPTURE_SCOPE("mesh_thread_loop");
 
         if (LLApp::isExiting())
         {
@@ -1092,6 +1096,11 @@ void LLMeshRepoThread::run()
                     ++LLMeshRepository::sLODProcessing;
                 }
             }
+
+            if (!mLODCacheReads.empty())
+            {
+                readLODsFromCache();
+            }
         }
 
         if (!mHeaderReqQ.empty() && mHttpRequestSet.size() < sRequestHighWater)
@@ -1548,8 +1557,10 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
                 }
                 LLMeshRepository::sCacheBytesRead += size;
                 ++LLMeshRepository::sCacheReads;
+                LLCacheStats::Timer timer;
                 file.seek(disk_ofset);
                 file.read(buffer, size);
+                LLCacheStats::read(LLCacheStats::MESH, size, timer.getMicros());
 
                 //make sure buffer isn't all 0's by checking the first 1KB (reserved block but not written)
                 bool zero = true;
@@ -1607,6 +1618,10 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
                                 gMeshRepo.mThread->mSkinRequests.push_back(req);
                             }
                         }
+                        else
+                        {
+                            LLCacheStats::hit(LLCacheStats::MESH);
+                        }
                         delete[] buffer;
                     });
                     if (posted)
@@ -1616,6 +1631,7 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
                     }
                     else if (skinInfoReceived(mesh_id, buffer, size))
                     {
+                        LLCacheStats::hit(LLCacheStats::MESH);
                         delete[] buffer;
                         return true;
                     }
@@ -1624,6 +1640,7 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
             }
 
             //reading from cache failed for whatever reason, fetch from sim
+            LLCacheStats::miss(LLCacheStats::MESH);
             std::string http_url;
             // <FS:Ansariel> [UDP Assets]
             //constructUrl(mesh_id, &http_url);
@@ -1719,8 +1736,10 @@ bool LLMeshRepoThread::fetchMeshDecomposition(const LLUUID& mesh_id)
                 LLMeshRepository::sCacheBytesRead += size;
                 ++LLMeshRepository::sCacheReads;
 
+                LLCacheStats::Timer timer;
                 file.seek(disk_ofset);
                 file.read(buffer, size);
+                LLCacheStats::read(LLCacheStats::MESH, size, timer.getMicros());
 
                 //make sure buffer isn't all 0's by checking the first 1KB (reserved block but not written)
                 bool zero = true;
@@ -1733,12 +1752,14 @@ bool LLMeshRepoThread::fetchMeshDecomposition(const LLUUID& mesh_id)
                 { //attempt to parse
                     if (decompositionReceived(mesh_id, buffer, size))
                     {
+                        LLCacheStats::hit(LLCacheStats::MESH);
                         return true;
                     }
                 }
             }
 
             //reading from cache failed for whatever reason, fetch from sim
+            LLCacheStats::miss(LLCacheStats::MESH);
             std::string http_url;
             // <FS:Ansariel> [UDP Assets]
             //constructUrl(mesh_id, &http_url);
@@ -1825,8 +1846,10 @@ bool LLMeshRepoThread::fetchMeshPhysicsShape(const LLUUID& mesh_id)
                 {
                     return true;
                 }
+                LLCacheStats::Timer timer;
                 file.seek(disk_ofset);
                 file.read(buffer, size);
+                LLCacheStats::read(LLCacheStats::MESH, size, timer.getMicros());
 
                 //make sure buffer isn't all 0's by checking the first 1KB (reserved block but not written)
                 bool zero = true;
@@ -1839,12 +1862,14 @@ bool LLMeshRepoThread::fetchMeshPhysicsShape(const LLUUID& mesh_id)
                 { //attempt to parse
                     if (physicsShapeReceived(mesh_id, buffer, size) == MESH_OK)
                     {
+                        LLCacheStats::hit(LLCacheStats::MESH);
                         return true;
                     }
                 }
             }
 
             //reading from cache failed for whatever reason, fetch from sim
+            LLCacheStats::miss(LLCacheStats::MESH);
             std::string http_url;
             // <FS:Ansariel> [UDP Assets]
             //constructUrl(mesh_id, &http_url);
@@ -1945,6 +1970,7 @@ bool LLMeshRepoThread::fetchMeshHeader(const LLVolumeParams& mesh_params)
             LLMeshRepository::sCacheBytesRead += bytes;
             ++LLMeshRepository::sCacheReads;
 
+            LLCacheStats::Timer timer;
             file.read(buffer, bytes);
 
             U32 version = 0;
@@ -1958,10 +1984,12 @@ bool LLMeshRepoThread::fetchMeshHeader(const LLVolumeParams& mesh_params)
                     bytes = llmin(size , DISK_MINIMAL_READ * 2);
                     file.read(buffer + DISK_MINIMAL_READ, bytes - DISK_MINIMAL_READ);
                 }
+                LLCacheStats::read(LLCacheStats::MESH, bytes, timer.getMicros());
                 U32 flags = 0;
                 memcpy(&flags, buffer + 2 * sizeof(U32), sizeof(U32));
                 if (headerReceived(mesh_params, buffer + CACHE_PREAMBLE_SIZE, bytes - CACHE_PREAMBLE_SIZE, flags) == MESH_OK)
                 {
+                    LLCacheStats::hit(LLCacheStats::MESH);
                     LL_DEBUGS(LOG_MESH) << "Mesh/Cache: Mesh header for ID " << mesh_params.getSculptID() << " - was retrieved from the cache." << LL_ENDL;
 
                     // Found mesh in cache
@@ -1972,6 +2000,7 @@ bool LLMeshRepoThread::fetchMeshHeader(const LLVolumeParams& mesh_params)
     }
 
     //either cache entry doesn't exist or is corrupt, request header from simulator
+    LLCacheStats::miss(LLCacheStats::MESH);
     bool retval = true;
     std::string http_url;
     // <FS:Ansariel> [UDP Assets]
@@ -2012,6 +2041,111 @@ bool LLMeshRepoThread::fetchMeshHeader(const LLVolumeParams& mesh_params)
     return retval;
 }
 
+void LLMeshRepoThread::readLODsFromCache()
+{
+    LL_PROFILE_ZONE_SCOPED;
+    // One batch for the whole pass: after a teleport that's hundreds of
+    // LODs, read in parallel, with the LODs of each mesh read in one go.
+    auto requests = std::make_shared<std::vector<LODRequest>>();
+    requests->swap(mLODCacheReadRequests);
+    LLAsyncFileSystem::batch_t reads;
+    reads.swap(mLODCacheReads);
+
+    // parse on the mesh thread pool, as for synchronous cache reads
+    LLCacheStats::Timer timer;
+    auto parse = [requests, timer](LLAsyncFileSystem::batch_t&& results)
+        {
+            // every read in the batch waited for the whole batch
+            const U64 micros = timer.getMicros();
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                LLAsyncFileSystem::Request& read = results[i];
+                const LODRequest& req = (*requests)[i];
+                if (read.mResult > 0)
+                {
+                    LLCacheStats::read(LLCacheStats::MESH, read.mResult, micros);
+                }
+
+                //make sure buffer isn't all 0's by checking the first 1KB (reserved block but not written)
+                bool zero = true;
+                for (S32 j = 0; j < llmin(read.mResult, 1024) && zero; ++j)
+                {
+                    zero = read.mData[j] == 0;
+                }
+
+                if (read.mResult == read.mBytes && !zero
+                    && gMeshRepo.mThread->lodReceived(req.mMeshParams, req.mLOD, read.mData.data(), read.mResult) == MESH_OK)
+                {
+                    LLCacheStats::hit(LLCacheStats::MESH);
+                    LL_DEBUGS(LOG_MESH) << "Mesh/Cache: Mesh body for ID " << read.mFileID << " - was retrieved from the cache." << LL_ENDL;
+                }
+                else
+                {
+                    gMeshRepo.mThread->lodCacheMismatch(req.mMeshParams, req.mLOD);
+                }
+            }
+        };
+    if (LLAsyncFileSystem::instance().read(std::move(reads), mMeshThreadPool->getQueue().getWeak(), parse))
+    {
+        return;
+    }
+
+    // The I/O pool is shutting down and handed the batch back: read and
+    // parse it here, as fetchMeshLOD() does when it can't post the parse.
+    for (LLAsyncFileSystem::Request& read : reads)
+    {
+        LLFileSystem file(read.mFileID, read.mFileType);
+        read.mData.resize(read.mBytes);
+        read.mResult = file.seek(read.mOffset) && file.read(read.mData.data(), read.mBytes) ? file.getLastBytesRead() : -1;
+    }
+    parse(std::move(reads));
+}
+
+void LLMeshRepoThread::lodCacheMismatch(const LLVolumeParams& mesh_params, S32 lod)
+{
+    // either header is faulty or something else overwrote the cache
+    const LLUUID& mesh_id = mesh_params.getSculptID();
+    S32 header_size = 0;
+    U32 header_flags = 0;
+    {
+        LL_DEBUGS(LOG_MESH) << "Mesh header for ID " << mesh_id << " cache mismatch." << LL_ENDL;
+
+        LLMutexLock lock(mHeaderMutex);
+
+        auto header_it = mMeshHeader.find(mesh_id);
+        if (header_it != mMeshHeader.end())
+        {
+            LLMeshHeader& header = header_it->second;
+            // for safety just mark everything as missing
+            header.mSkinInCache = false;
+            header.mPhysicsConvexInCache = false;
+            header.mPhysicsMeshInCache = false;
+            for (S32 i = 0; i < LLModel::NUM_LODS; ++i)
+            {
+                header.mLodInCache[i] = false;
+            }
+            header_size = header.mHeaderSize;
+            header_flags = header.getFlags();
+        }
+    }
+
+    if (header_size > 0)
+    {
+        LLFileSystem file(mesh_id, LLAssetType::AT_MESH, LLFileSystem::READ_WRITE);
+        if (file.getMaxSize() >= CACHE_PREAMBLE_SIZE)
+        {
+            write_preamble(file, header_size, header_flags);
+        }
+    }
+
+    {
+        LLMutexLock lock(mMutex);
+        LODRequest req(mesh_params, lod);
+        mLODReqQ.push(req);
+        LLMeshRepository::sLODProcessing++;
+    }
+}
+
 //return false if failed to get mesh lod.
 bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
 {
@@ -2046,6 +2180,16 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
         if (version <= MAX_MESH_VERSION && offset >= 0 && size > 0)
         {
             S32 disk_ofset = offset + CACHE_PREAMBLE_SIZE;
+            if (in_cache && LLAsyncFileSystem::instanceExists())
+            {
+                // read along with the rest of this pass's LODs, see readLODsFromCache()
+                LLMeshRepository::sCacheBytesRead += size;
+                ++LLMeshRepository::sCacheReads;
+                mLODCacheReads.emplace_back(mesh_id, LLAssetType::AT_MESH, disk_ofset, size);
+                mLODCacheReadRequests.emplace_back(mesh_params, lod);
+                return true;
+            }
+
             //check cache for mesh asset
             LLFileSystem file(mesh_id, LLAssetType::AT_MESH);
             if (in_cache && (file.getSize() >= disk_ofset + size))
@@ -2069,8 +2213,10 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
                 }
                 LLMeshRepository::sCacheBytesRead += size;
                 ++LLMeshRepository::sCacheReads;
+                LLCacheStats::Timer timer;
                 file.seek(disk_ofset);
                 file.read(buffer, size);
+                LLCacheStats::read(LLCacheStats::MESH, size, timer.getMicros());
 
                 //make sure buffer isn't all 0's by checking the first 1KB (reserved block but not written)
                 bool zero = true;
@@ -2089,50 +2235,12 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
                     {
                         if (gMeshRepo.mThread->lodReceived(params, lod, buffer, size) == MESH_OK)
                         {
+                            LLCacheStats::hit(LLCacheStats::MESH);
                             LL_DEBUGS(LOG_MESH) << "Mesh/Cache: Mesh body for ID " << mesh_id << " - was retrieved from the cache." << LL_ENDL;
                         }
                         else
                         {
-                            // either header is faulty or something else overwrote the cache
-                            S32 header_size = 0;
-                            U32 header_flags = 0;
-                            {
-                                LL_DEBUGS(LOG_MESH) << "Mesh header for ID " << mesh_id << " cache mismatch." << LL_ENDL;
-
-                                LLMutexLock lock(gMeshRepo.mThread->mHeaderMutex);
-
-                                auto header_it = gMeshRepo.mThread->mMeshHeader.find(mesh_id);
-                                if (header_it != gMeshRepo.mThread->mMeshHeader.end())
-                                {
-                                    LLMeshHeader& header = header_it->second;
-                                    // for safety just mark everything as missing
-                                    header.mSkinInCache = false;
-                                    header.mPhysicsConvexInCache = false;
-                                    header.mPhysicsMeshInCache = false;
-                                    for (S32 i = 0; i < LLModel::NUM_LODS; ++i)
-                                    {
-                                        header.mLodInCache[i] = false;
-                                    }
-                                    header_size = header.mHeaderSize;
-                                    header_flags = header.getFlags();
-                                }
-                            }
-
-                            if (header_size > 0)
-                            {
-                                LLFileSystem file(mesh_id, LLAssetType::AT_MESH, LLFileSystem::READ_WRITE);
-                                if (file.getMaxSize() >= CACHE_PREAMBLE_SIZE)
-                                {
-                                    write_preamble(file, header_size, header_flags);
-                                }
-                            }
-
-                            {
-                                LLMutexLock lock(gMeshRepo.mThread->mMutex);
-                                LODRequest req(params, lod);
-                                gMeshRepo.mThread->mLODReqQ.push(req);
-                                LLMeshRepository::sLODProcessing++;
-                            }
+                            gMeshRepo.mThread->lodCacheMismatch(params, lod);
                         }
                         delete[] buffer;
                     });
@@ -2144,6 +2252,7 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
                     }
                     else if (lodReceived(mesh_params, lod, buffer, size) == MESH_OK)
                     {
+                        LLCacheStats::hit(LLCacheStats::MESH);
                         delete[] buffer;
                         LL_DEBUGS(LOG_MESH) << "Mesh/Cache: Mesh body for ID " << mesh_id << " - was retrieved from the cache." << LL_ENDL;
 
@@ -2156,6 +2265,7 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod)
             }
 
             //reading from cache failed for whatever reason, fetch from sim
+            LLCacheStats::miss(LLCacheStats::MESH);
             std::string http_url;
             // <FS:Ansariel> [UDP Assets]
             //constructUrl(mesh_id, &http_url);
@@ -2211,7 +2321,6 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
 {
     LL_PROFILE_ZONE_SCOPED;
     const LLUUID mesh_id = mesh_params.getSculptID();
-    LLSD header_data;
 
     LLMeshHeader header;
 
@@ -2227,9 +2336,13 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
 
         data_size = (S32)dsize;
 
-        boost::iostreams::stream<boost::iostreams::array_source> stream(result_ptr, data_size);
+        // Only a handful of header keys are ever read, so index the
+        // buffer in place rather than building a full LLSD map.
+        LLPointer<LLSDViewBuffer> header_buffer = new LLSDViewBuffer((const U8*)result_ptr, data_size);
+        LLSDView header_data = header_buffer->root();
+        const size_t header_bytes = header_data.byteSize();
 
-        if (!LLSDSerialize::fromBinary(header_data, stream, data_size))
+        if (!header_bytes)
         {
             LL_WARNS(LOG_MESH) << "Mesh header parse error.  Not a valid mesh asset!  ID:  " << mesh_id
                                << LL_ENDL;
@@ -2252,7 +2365,7 @@ EMeshProcessingResult LLMeshRepoThread::headerReceived(const LLVolumeParams& mes
         // make sure there is at least one lod, function returns -1 and marks as 404 otherwise
         else if (LLMeshRepository::getActualMeshLOD(header, 0) >= 0)
         {
-            header.mHeaderSize = (S32)stream.tellg();
+            header.mHeaderSize = (S32)header_bytes;
             header_size += header.mHeaderSize;
             skin_offset = header.mSkinOffset;
             skin_size = header.mSkinSize;
@@ -3764,6 +3877,7 @@ void LLMeshHeaderHandler::processData(LLCore::BufferArray * /* body */, S32 /* b
             if (file.getMaxSize() >= bytes)
             {
                 LLMeshRepository::sCacheBytesWritten += data_size;
+                LLCacheStats::wrote(LLCacheStats::MESH, data_size);
                 ++LLMeshRepository::sCacheWrites;
 
                 // write preamble
@@ -3865,6 +3979,7 @@ void LLMeshLODHandler::processLod(U8* data, S32 data_size)
             file.seek(offset, 0);
             file.write(data, size);
             LLMeshRepository::sCacheBytesWritten += size;
+            LLCacheStats::wrote(LLCacheStats::MESH, size);
             ++LLMeshRepository::sCacheWrites;
         }
     }
@@ -3954,6 +4069,7 @@ void LLMeshSkinInfoHandler::processSkin(U8* data, S32 data_size)
         if (file.getSize() >= offset + size)
         {
             LLMeshRepository::sCacheBytesWritten += size;
+            LLCacheStats::wrote(LLCacheStats::MESH, size);
             ++LLMeshRepository::sCacheWrites;
 
             S32 header_bytes = 0;
@@ -4068,6 +4184,7 @@ void LLMeshDecompositionHandler::processData(LLCore::BufferArray * /* body */, S
         if (file.getSize() >= offset+size)
         {
             LLMeshRepository::sCacheBytesWritten += size;
+            LLCacheStats::wrote(LLCacheStats::MESH, size);
             ++LLMeshRepository::sCacheWrites;
 
             S32 header_bytes = 0;
@@ -4141,6 +4258,7 @@ void LLMeshPhysicsShapeHandler::processData(LLCore::BufferArray * /* body */, S3
         if (file.getSize() >= offset+size)
         {
             LLMeshRepository::sCacheBytesWritten += size;
+            LLCacheStats::wrote(LLCacheStats::MESH, size);
             ++LLMeshRepository::sCacheWrites;
 
             S32 header_bytes = 0;
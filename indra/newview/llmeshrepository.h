@@ -41,6 +41,7 @@
 #include "httpheaders.h"
 #include "httphandler.h"
 #include "llthread.h"
+#include "llasyncfilesystem.h"
 
 #define LLCONVEXDECOMPINTER_STATIC 1
 
@@ -278,7 +279,9 @@ public:
         fromLLSD(header);
     }
 
-    void fromLLSD(const LLSD& header)
+    // Accepts an LLSD or an LLSDView over the binary header.
+    template <typename SD>
+    void fromLLSD(const SD& header)
     {
         const char* lod[] =
         {
@@ -537,6 +540,10 @@ public:
 
     bool fetchMeshHeader(const LLVolumeParams& mesh_params);
     bool fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod);
+    // Threads:  Repo thread only
+    void readLODsFromCache();
+    // Mark the mesh's cached data as missing and fetch the LOD again
+    void lodCacheMismatch(const LLVolumeParams& mesh_params, S32 lod);
     EMeshProcessingResult headerReceived(const LLVolumeParams& mesh_params, U8* data, S32 data_size, U32 flags = 0);
     EMeshProcessingResult lodReceived(const LLVolumeParams& mesh_params, S32 lod, U8* data, S32 data_size);
     bool skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
@@ -611,6 +618,11 @@ private:
     U8* getDiskCacheBuffer(S32 size);
     S32 mDiskCacheBufferSize = 0;
     U8* mDiskCacheBuffer = nullptr;
+
+    // LOD cache reads gathered by fetchMeshLOD() for readLODsFromCache()
+    // Threads:  Repo thread only
+    LLAsyncFileSystem::batch_t mLODCacheReads;
+    std::vector<LODRequest> mLODCacheReadRequests;
 };
 
 
@@ -0,0 +1,257 @@
+/**
+ * @file   llteleportwarmup.cpp
+ * @date   2026-10-18
+ * @brief  Reads a teleport destination's cached data ahead of arrival.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llteleportwarmup.h"
+
+#include "llagent.h"
+#include "llappviewer.h"
+#include "llcallbacklist.h"
+#include "llmappedfile.h"
+#include "lltexturecache.h"
+#include "llviewercontrol.h"
+#include "llviewerobject.h"
+#include "llviewerobjectlist.h"
+#include "llviewerregion.h"
+#include "llviewertexture.h"
+#include "llvocache.h"
+#include "llworld.h"
+#include "workqueue.h"
+
+#include <atomic>
+
+namespace
+{
+    // how long after arrival prefetched textures wait to be asked for
+    const F32 WARMUP_LINGER_SECONDS = 30.f;
+    const size_t WARMUP_PAGE_SIZE = 4096;
+}
+
+struct LLTeleportWarmup::Job
+{
+    std::string mObjectsFilename;
+    std::string mTexturesFilename;
+    U32 mGeneration{ 0 };
+    S64 mMaxTextureBytes{ 0 };
+    // Kept mapped until the job is dropped, which keeps its pages resident
+    // for the region's own mapping of the file.
+    LLMappedFile mObjectCache;
+    std::atomic<U64> mObjectCacheBytes{ 0 };
+    std::atomic<U32> mTexturesRequested{ 0 };
+
+    // runs on the general queue
+    void run()
+    {
+        LL_PROFILE_ZONE_SCOPED;
+        if (mObjectCache.map(mObjectsFilename))
+        {
+            const volatile U8* data = mObjectCache.data();
+            U8 sink = 0;
+            for (size_t offset = 0; offset < mObjectCache.size(); offset += WARMUP_PAGE_SIZE)
+            {
+                sink ^= data[offset];
+            }
+            (void)sink;
+            mObjectCacheBytes = mObjectCache.size();
+        }
+
+        uuid_vec_t texture_ids;
+        LLTextureCache* texture_cache = LLAppViewer::getTextureCache();
+        if (texture_cache && LLVOCache::readTexturesFromFile(mTexturesFilename, texture_ids) && !texture_ids.empty())
+        {
+            mTexturesRequested = (U32)texture_ids.size();
+            texture_cache->prefetch(texture_ids, mGeneration, mMaxTextureBytes);
+        }
+    }
+};
+
+LLTeleportWarmup::LLTeleportWarmup() :
+    mHandle(0),
+    mArrived(false)
+{
+}
+
+LLTeleportWarmup::~LLTeleportWarmup()
+{
+}
+
+void LLTeleportWarmup::start(U64 handle)
+{
+    static LLCachedControl<bool> enabled(gSavedSettings, "TeleportWarmup", true);
+    static LLCachedControl<U32> texture_memory(gSavedSettings, "TeleportWarmupTextureMemory", 64);
+    if (!enabled || !handle || handle == mHandle || !LLVOCache::instanceExists())
+    {
+        return;
+    }
+    if (LLWorld::getInstance()->getRegionFromHandle(handle))
+    {
+        return; // local teleport, or a neighbour whose caches are loaded already
+    }
+
+    std::shared_ptr<Job> job = std::make_shared<Job>();
+    if (!LLVOCache::instance().getCacheFilenames(handle, job->mObjectsFilename, job->mTexturesFilename))
+    {
+        return; // never been there, or its cache was purged
+    }
+
+    LL::WorkQueue::ptr_t general_queue = LL::WorkQueue::getInstance("General");
+    if (!general_queue)
+    {
+        return;
+    }
+
+    // whatever a previous warm-up loaded is of no use now
+    report();
+
+    LLTextureCache* texture_cache = LLAppViewer::getTextureCache();
+    job->mGeneration = texture_cache ? texture_cache->clearPrefetched() : 0;
+    job->mMaxTextureBytes = (S64)texture_memory * 1024 * 1024;
+    if (!general_queue->post([job]() { job->run(); }))
+    {
+        return;
+    }
+
+    mJob = job;
+    mHandle = handle;
+    mArrived = false;
+    ++mStats.mWarmups;
+    LL_DEBUGS("Teleport") << "Warming caches for region handle " << handle << LL_ENDL;
+}
+
+void LLTeleportWarmup::finish(U64 handle)
+{
+    if (!mJob || mArrived)
+    {
+        return;
+    }
+
+    if (!handle || handle != mHandle)
+    {
+        report();
+        return;
+    }
+
+    // give the arrival scene time to ask for its textures before counting
+    mArrived = true;
+    ++mStats.mArrivals;
+    const U32 generation = mJob->mGeneration;
+    doAfterInterval([generation]()
+        {
+            if (LLTeleportWarmup::instanceExists())
+            {
+                LLTeleportWarmup::instance().end(generation);
+            }
+        }, WARMUP_LINGER_SECONDS);
+}
+
+void LLTeleportWarmup::end(U32 generation)
+{
+    if (mJob && mJob->mGeneration == generation)
+    {
+        report();
+    }
+}
+
+void LLTeleportWarmup::report()
+{
+    if (!mJob)
+    {
+        return;
+    }
+
+    LLTextureCache::PrefetchStats textures;
+    if (LLTextureCache* texture_cache = LLAppViewer::getTextureCache())
+    {
+        textures = texture_cache->getPrefetchStats();
+        texture_cache->clearPrefetched();
+    }
+    const U64 object_bytes = mJob->mObjectCacheBytes;
+    const U32 requested = mJob->mTexturesRequested;
+
+    mStats.mObjectCacheBytes += object_bytes;
+    mStats.mTexturesRequested += requested;
+    mStats.mTexturesLoaded += textures.mLoaded;
+    mStats.mTextureHits += textures.mHits;
+
+    LL_INFOS("Teleport") << "Cache warm-up for region handle " << mHandle
+                         << (mArrived ? " (arrived)" : " (not arrived)") << ": "
+                         << object_bytes << " bytes of object cache, "
+                         << textures.mLoaded << " of " << requested << " textures loaded, "
+                         << textures.mHits << " used" << LL_ENDL;
+
+    mJob.reset();
+    mHandle = 0;
+    mArrived = false;
+}
+
+// static
+void LLTeleportWarmup::collectTextures(LLViewerRegion* regionp, uuid_vec_t& texture_ids)
+{
+    static LLCachedControl<bool> enabled(gSavedSettings, "TeleportWarmup", true);
+    static LLCachedControl<U32> max_textures(gSavedSettings, "TeleportWarmupTextures", 1024);
+    if (!enabled || !max_textures || !regionp)
+    {
+        return;
+    }
+    LL_PROFILE_ZONE_SCOPED;
+
+    std::unordered_map<LLUUID, F32> sizes;
+    for (S32 i = 0; i < gObjectList.getNumObjects(); ++i)
+    {
+        LLViewerObject* objectp = gObjectList.getObject(i);
+        if (!objectp || objectp->isDead() || objectp->getRegion() != regionp)
+        {
+            continue;
+        }
+        for (U8 te = 0; te < objectp->getNumTEs(); ++te)
+        {
+            LLViewerFetchedTexture* texturep = LLViewerTextureManager::staticCastToFetchedTexture(objectp->getTEImage(te));
+            if (texturep && texturep->getFTType() == FTT_DEFAULT)
+            {
+                F32& size = sizes[texturep->getID()];
+                size = llmax(size, texturep->getMaxVirtualSize());
+            }
+        }
+    }
+
+    std::vector<std::pair<F32, LLUUID>> by_size;
+    by_size.reserve(sizes.size());
+    for (const auto& [id, size] : sizes)
+    {
+        by_size.emplace_back(size, id);
+    }
+    const size_t count = llmin(by_size.size(), (size_t)max_textures);
+    std::partial_sort(by_size.begin(), by_size.begin() + count, by_size.end(),
+                      [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    texture_ids.reserve(texture_ids.size() + count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        texture_ids.push_back(by_size[i].second);
+    }
+}
@@ -0,0 +1,86 @@
+/**
+ * @file   llteleportwarmup.h
+ * @date   2026-10-18
+ * @brief  Reads a teleport destination's cached data ahead of arrival.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTELEPORTWARMUP_H
+#define LL_LLTELEPORTWARMUP_H
+
+#include "llsingleton.h"
+#include "lluuid.h"
+
+class LLViewerRegion;
+
+/**
+ * LLTeleportWarmup starts reading a teleport destination's caches as soon
+ * as its region handle is known, long before the region connects: the
+ * object cache file is mapped and paged in, and the textures recorded for
+ * the region when it was last left are loaded from the texture cache's
+ * fast cache into memory (see LLTextureCache::prefetch()). The work runs on
+ * the "General" work queue.
+ *
+ * When the teleport ends, what the warm-up read and how much of it the
+ * arrival scene used is logged and added to getStats().
+ */
+class LLTeleportWarmup : public LLSingleton<LLTeleportWarmup>
+{
+    LLSINGLETON(LLTeleportWarmup);
+    ~LLTeleportWarmup();
+
+public:
+    // Warm the caches of the region at handle. Repeats for the region
+    // being warmed, and regions already connected, are ignored.
+    void start(U64 handle);
+    // The teleport ended in the region at handle, or failed if 0.
+    void finish(U64 handle);
+
+    // Textures on regionp's objects, largest on screen first, for
+    // LLVOCache::writeTexturesToCache(). Call before the objects are killed.
+    static void collectTextures(LLViewerRegion* regionp, uuid_vec_t& texture_ids);
+
+    struct Stats
+    {
+        U32 mWarmups{ 0 };          // warm-ups started
+        U32 mArrivals{ 0 };         // teleports that ended in the warmed region
+        U64 mObjectCacheBytes{ 0 }; // object cache read ahead
+        U32 mTexturesRequested{ 0 };// textures listed for warmed regions
+        U32 mTexturesLoaded{ 0 };   // of those, found and held in memory
+        U32 mTextureHits{ 0 };      // of those, asked for by the fetcher
+    };
+    const Stats& getStats() const { return mStats; }
+
+private:
+    struct Job;
+
+    void end(U32 generation);
+    void report();
+
+    std::shared_ptr<Job> mJob;
+    U64 mHandle;
+    bool mArrived;
+    Stats mStats;
+};
+
+#endif // LL_LLTELEPORTWARMUP_H
@@ -29,33 +29,34 @@
 #include "lltexturecache.h"
 
 #include "llapr.h"
+#include "llcachestats.h"
 #include "lldir.h"
 #include "llimage.h"
 #include "llimagej2c.h" // for version control
 #include "lllfsthread.h"
 #include "llviewercontrol.h"
 
-// Included to allow LLTextureCache::purgeTextures() to pause watchdog timeout
+// Included to allow LLTextureCache::purgeTexturesLazy() to pause watchdog timeout
 #include "llappviewer.h"
 #include "llmemory.h"
 
 // Cache organization:
-// cache/texture.entries
-//  Unordered array of Entry structs
+// cache/texture.index
+//  Memory-mapped hash table of Entry structs (see LLTextureCacheIndex)
 // cache/texture.cache
-//  First TEXTURE_CACHE_ENTRY_SIZE bytes of each texture in texture.entries in same order
+//  First TEXTURE_CACHE_ENTRY_SIZE bytes of each texture, at its slot in texture.index
 // cache/textures/[0-F]/UUID.texture
 //  Actual texture body files
 
 //note: there is no good to define 1024 for TEXTURE_CACHE_ENTRY_SIZE while FIRST_PACKET_SIZE is 600 on sim side.
 const S32 TEXTURE_CACHE_ENTRY_SIZE = FIRST_PACKET_SIZE;//1024;
 const F32 TEXTURE_CACHE_PURGE_AMOUNT = .20f; // % amount to reduce the cache by when it exceeds its limit
-const F32 TEXTURE_CACHE_LRU_SIZE = .10f; // % amount for LRU list (low overhead to regenerate)
+const F32 TEXTURE_CACHE_INDEX_LOAD = .75f; // fraction of the index slots in use at most, to keep lookups short
 const S32 TEXTURE_FAST_CACHE_ENTRY_OVERHEAD = sizeof(S32) * 4; //w, h, c, level
 const S32 TEXTURE_FAST_CACHE_DATA_SIZE = 16 * 16 * 4;
 const S32 TEXTURE_FAST_CACHE_ENTRY_SIZE = TEXTURE_FAST_CACHE_DATA_SIZE + TEXTURE_FAST_CACHE_ENTRY_OVERHEAD;
 const F32 TEXTURE_LAZY_PURGE_TIME_LIMIT = .004f; // 4ms. Would be better to autoadjust, but there is a major cache rework in progress.
-const F32 TEXTURE_PRUNING_MAX_TIME = 15.f;
+const F32 TEXTURE_CACHE_INDEX_COMPACT_INTERVAL = 300.f; // seconds
 
 class LLTextureCacheWorker : public LLWorkerClass
 {
@@ -385,6 +386,7 @@ bool LLTextureCacheRemoteWorker::doRead()
         if (idx < 0)
         {
             // The texture is *not* cached. We're done here...
+            LLCacheStats::miss(LLCacheStats::TEXTURE_HEADER);
             mDataSize = 0; // no data
             done = true;
         }
@@ -397,7 +399,7 @@ bool LLTextureCacheRemoteWorker::doRead()
         }
     }
 
-    // Third state / stage : read data from the header cache (texture.entries) file
+    // Third state / stage : read data from the header cache (texture.cache) file
     if (!done && (mState == HEADER))
     {
         llassert_always(idx >= 0);  // we need an entry here or reading the header makes no sense
@@ -410,6 +412,7 @@ bool LLTextureCacheRemoteWorker::doRead()
         mReadData = (U8*)ll_aligned_malloc_16(size);
         if (mReadData)
         {
+            LLCacheStats::Timer timer;
             S32 bytes_read = LLAPRFile::readEx(mCache->mHeaderDataFileName,
                                                  mReadData, offset, size, mCache->getLocalAPRFilePool());
             if (bytes_read != size)
@@ -417,11 +420,17 @@ bool LLTextureCacheRemoteWorker::doRead()
                 LL_WARNS() << "LLTextureCacheWorker: "  << mID
                         << " incorrect number of bytes read from header: " << bytes_read
                         << " / " << size << LL_ENDL;
+                LLCacheStats::miss(LLCacheStats::TEXTURE_HEADER);
                 ll_aligned_free_16(mReadData);
                 mReadData = NULL;
                 mDataSize = -1; // failed
                 done = true;
             }
+            else
+            {
+                LLCacheStats::hit(LLCacheStats::TEXTURE_HEADER);
+                LLCacheStats::read(LLCacheStats::TEXTURE_HEADER, bytes_read, timer.getMicros());
+            }
             // If we already read all we expected, we're actually done
             if (mDataSize <= bytes_read)
             {
@@ -487,6 +496,7 @@ bool LLTextureCacheRemoteWorker::doRead()
                 mReadData = data;
 
                 // Read the data at last
+                LLCacheStats::Timer timer;
                 S32 bytes_read = LLAPRFile::readEx(filename,
                                                  mReadData + data_offset,
                                                  file_offset, file_size,
@@ -496,11 +506,17 @@ bool LLTextureCacheRemoteWorker::doRead()
                     LL_WARNS() << "LLTextureCacheWorker: "  << mID
                             << " incorrect number of bytes read from body: " << bytes_read
                             << " / " << file_size << LL_ENDL;
+                    LLCacheStats::miss(LLCacheStats::TEXTURE_BODY);
                     ll_aligned_free_16(mReadData);
                     mReadData = NULL;
                     mDataSize = -1; // failed
                     done = true;
                 }
+                else
+                {
+                    LLCacheStats::hit(LLCacheStats::TEXTURE_BODY);
+                    LLCacheStats::read(LLCacheStats::TEXTURE_BODY, bytes_read, timer.getMicros());
+                }
             }
             else
             {
@@ -515,6 +531,7 @@ bool LLTextureCacheRemoteWorker::doRead()
         else
         {
             // No body, we're done.
+            LLCacheStats::miss(LLCacheStats::TEXTURE_BODY);
             mDataSize = llmax(TEXTURE_CACHE_ENTRY_SIZE - mOffset, 0);
             LL_DEBUGS() << "No body file for: " << filename << LL_ENDL;
         }
@@ -558,7 +575,7 @@ bool LLTextureCacheRemoteWorker::doWrite()
 
     // No LOCAL state for write(): because it doesn't make much sense to cache a local file...
 
-    // Second state / stage : set an entry in the headers entry (texture.entries) file
+    // Second state / stage : set an entry in the texture cache index (texture.index)
     if (!done && (mState == CACHE))
     {
         bool alreadyCached = false;
@@ -654,6 +671,10 @@ bool LLTextureCacheRemoteWorker::doWrite()
                 mDataSize = -1; // failed
                 done = true;
             }
+            else
+            {
+                LLCacheStats::wrote(LLCacheStats::TEXTURE_HEADER, bytes_written);
+            }
 
             // If we wrote everything (may be more with padding) in the header cache,
             // we're done so we don't have a body to store
@@ -697,6 +718,10 @@ bool LLTextureCacheRemoteWorker::doWrite()
                     mDataSize = -1; // failed
                     done = true;
                 }
+                else
+                {
+                    LLCacheStats::wrote(LLCacheStats::TEXTURE_BODY, bytes_written);
+                }
             }
 
             // Nothing else to do at that point...
@@ -797,13 +822,13 @@ LLTextureCache::LLTextureCache(bool threaded)
       mHeaderMutex(),
       mListMutex(),
       mFastCacheMutex(),
-      mHeaderAPRFile(NULL),
       mReadOnly(true), //do not allow to change the texture cache until setReadOnly() is called.
-      mTexturesSizeTotal(0),
+      mIndexSlots(0),
       mDoPurge(false),
       mFastCachep(NULL),
       mFastCachePoolp(NULL),
-      mFastCachePadBuffer(NULL)
+      mFastCachePadBuffer(NULL),
+      mPrefetchGeneration(0)
 {
     mHeaderAPRFilePoolp = new LLVolatileAPRPool(); // is_local = true, because this pool is for headers, headers are under own mutex
 }
@@ -811,7 +836,8 @@ LLTextureCache::LLTextureCache(bool threaded)
 LLTextureCache::~LLTextureCache()
 {
     clearDeleteList() ;
-    writeUpdatedEntries() ;
+    mRawCache.close();
+    mIndex.close();
     delete mFastCachep;
     delete mFastCachePoolp;
     delete mHeaderAPRFilePoolp;
@@ -825,7 +851,6 @@ size_t LLTextureCache::update(F32 max_time_ms)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
     static LLFrameTimer timer ;
-    static const F32 MAX_TIME_INTERVAL = 300.f ; //seconds.
 
     size_t res;
     res = LLWorkerThread::update(max_time_ms);
@@ -846,10 +871,10 @@ size_t LLTextureCache::update(F32 max_time_ms)
         responder->completed(success);
     }
 
-    if(!res && timer.getElapsedTimeF32() > MAX_TIME_INTERVAL)
+    if(!res && timer.getElapsedTimeF32() > TEXTURE_CACHE_INDEX_COMPACT_INTERVAL)
     {
         timer.reset() ;
-        writeUpdatedEntries() ;
+        mIndex.compact() ;
     }
 
     return res;
@@ -874,13 +899,18 @@ std::string LLTextureCache::getTextureFileName(const LLUUID& id)
     return filename;
 }
 
+std::string LLTextureCache::getTranscodeFileName(const LLUUID& id)
+{
+    std::string idstr = id.asString();
+    std::string delem = gDirUtilp->getDirDelimiter();
+    std::string filename = mTexturesDirName + delem + idstr[0] + delem + idstr + ".bcn";
+    return filename;
+}
+
 //debug
 bool LLTextureCache::isInCache(const LLUUID& id)
 {
-    LLMutexLock lock(&mHeaderMutex);
-    id_map_t::const_iterator iter = mHeaderIDMap.find(id);
-
-    return (iter != mHeaderIDMap.end()) ;
+    return mIndex.find(id) >= 0;
 }
 
 //debug
@@ -936,7 +966,8 @@ U32 LLTextureCache::sHeaderCacheAddressSize = ADDRESS_SIZE;
 U32 LLTextureCache::sHeaderCacheAddressSize = 32;
 #endif
 
-const char* entries_filename = "texture.entries";
+const char* entries_filename = "texture.entries"; // before texture.index
+const char* index_filename = "texture.index";
 const char* cache_filename = "texture.cache";
 const char* old_textures_dirname = "textures";
 //change the location of the texture cache to prevent from being deleted by old version viewers.
@@ -948,7 +979,7 @@ void LLTextureCache::setDirNames(ELLPath location)
     std::string delem = gDirUtilp->getDirDelimiter();
 
     mCacheParentDirName = gDirUtilp->getExpandedFilename(location,"");
-    mHeaderEntriesFileName = gDirUtilp->getExpandedFilename(location, textures_dirname, entries_filename);
+    mIndexFileName = gDirUtilp->getExpandedFilename(location, textures_dirname, index_filename);
     mHeaderDataFileName = gDirUtilp->getExpandedFilename(location, textures_dirname, cache_filename);
     mTexturesDirName = gDirUtilp->getExpandedFilename(location, textures_dirname);
     mFastCacheFileName =  gDirUtilp->getExpandedFilename(location, textures_dirname, fast_cache_filename);
@@ -961,7 +992,6 @@ void LLTextureCache::purgeCache(ELLPath location, bool remove_dir)
     if (!mReadOnly)
     {
         setDirNames(location);
-        llassert_always(mHeaderAPRFile == NULL);
 
         //remove the legacy cache if exists
         std::string texture_dir = mTexturesDirName ;
@@ -996,10 +1026,17 @@ S64 LLTextureCache::initCache(ELLPath location, S64 max_size, bool texture_cache
 {
     llassert_always(getPending() == 0) ; //should not start accessing the texture cache before initialized.
 
+    // the decoded images come out of the same budget
+    const S64 raw_cache_size = llmin((S64)gSavedSettings.getU32("TextureRawCacheSize") * 1024 * 1024, max_size / 4);
+    max_size -= raw_cache_size;
+
     S64 entries_size = (max_size * 36) / 100; //0.36 * max_size
     S64 max_entries = entries_size / (TEXTURE_CACHE_ENTRY_SIZE + TEXTURE_FAST_CACHE_ENTRY_SIZE);
-    sCacheMaxEntries = (S32)(llmin((S64)sCacheMaxEntries, max_entries));
-    entries_size = sCacheMaxEntries * (TEXTURE_CACHE_ENTRY_SIZE + TEXTURE_FAST_CACHE_ENTRY_SIZE);
+    // every index slot has room reserved in the header and fast cache files,
+    // but only some slots are used at once
+    mIndexSlots = (U32)(llmin((S64)sCacheMaxEntries, max_entries));
+    sCacheMaxEntries = (U32)(mIndexSlots * TEXTURE_CACHE_INDEX_LOAD);
+    entries_size = (S64)mIndexSlots * (TEXTURE_CACHE_ENTRY_SIZE + TEXTURE_FAST_CACHE_ENTRY_SIZE);
     max_size -= entries_size;
     if (sCacheMaxTexturesSize > 0)
         sCacheMaxTexturesSize = llmin(sCacheMaxTexturesSize, max_size);
@@ -1008,7 +1045,8 @@ S64 LLTextureCache::initCache(ELLPath location, S64 max_size, bool texture_cache
     max_size -= sCacheMaxTexturesSize;
 
     LL_INFOS("TextureCache") << "Headers: " << sCacheMaxEntries
-            << " Textures size: " << sCacheMaxTexturesSize / (1024 * 1024) << " MB" << LL_ENDL;
+            << " Textures size: " << sCacheMaxTexturesSize / (1024 * 1024) << " MB"
+            << " Decoded size: " << raw_cache_size / (1024 * 1024) << " MB" << LL_ENDL;
 
     setDirNames(location);
 
@@ -1039,8 +1077,10 @@ S64 LLTextureCache::initCache(ELLPath location, S64 max_size, bool texture_cache
             LLFile::mkdir(dirname);
         }
     }
-    readHeaderCache();
-    purgeTextures(true); // calc mTexturesSize and make some room in the texture cache if we need it
+    openIndex();
+    // make some room in the texture cache on the first write if we need it
+    mDoPurge = mIndex.getBodyBytes() > sCacheMaxTexturesSize;
+    openRawCache(raw_cache_size);
 
     llassert_always(getPending() == 0) ; //should not start accessing the texture cache before initialized.
     openFastCache(true);
@@ -1049,231 +1089,55 @@ S64 LLTextureCache::initCache(ELLPath location, S64 max_size, bool texture_cache
 }
 
 //----------------------------------------------------------------------------
-// mHeaderMutex must be locked for the following functions!
-
-LLAPRFile* LLTextureCache::openHeaderEntriesFile(bool readonly, S32 offset)
-{
-    llassert_always(mHeaderAPRFile == NULL);
-    apr_int32_t flags = readonly ? APR_READ|APR_BINARY : APR_READ|APR_WRITE|APR_BINARY;
-    mHeaderAPRFile = new LLAPRFile(mHeaderEntriesFileName, flags, mHeaderAPRFilePoolp);
-    if(offset > 0)
-    {
-        mHeaderAPRFile->seek(APR_SET, offset);
-    }
-    return mHeaderAPRFile;
-}
 
-void LLTextureCache::closeHeaderEntriesFile()
-{
-    if(!mHeaderAPRFile)
-    {
-        return ;
-    }
-
-    delete mHeaderAPRFile;
-    mHeaderAPRFile = NULL;
-}
-
-void LLTextureCache::readEntriesHeader()
-{
-    // mHeaderEntriesInfo initializes to default values so safe not to read it
-    llassert_always(mHeaderAPRFile == NULL);
-    if (LLAPRFile::isExist(mHeaderEntriesFileName, mHeaderAPRFilePoolp))
-    {
-        LLAPRFile::readEx(mHeaderEntriesFileName, (U8*)&mHeaderEntriesInfo, 0, sizeof(EntriesInfo),
-                          mHeaderAPRFilePoolp);
-    }
-    else //create an empty entries header.
-    {
-        setEntriesHeader();
-        writeEntriesHeader() ;
-    }
-}
-
-void LLTextureCache::setEntriesHeader()
+//static
+std::string LLTextureCache::getIndexVersion()
 {
-    if (sHeaderEncoderStringSize < sHeaderCacheEncoderVersion.size() + 1)
-    {
-        // For simplicity we use predefined size of header, so if version string
-        // doesn't fit, either getEngineInfo() returned malformed string or
-        // sHeaderEncoderStringSize need to be increased.
-        // Also take into accout that c_str() returns additional null character
-        LL_ERRS() << "Version string doesn't fit in header" << LL_ENDL;
-    }
-
-    mHeaderEntriesInfo.mVersion = sHeaderCacheVersion;
-    mHeaderEntriesInfo.mAdressSize = sHeaderCacheAddressSize;
-    strcpy(mHeaderEntriesInfo.mEncoderVersion, sHeaderCacheEncoderVersion.c_str());
-    mHeaderEntriesInfo.mEntries = 0;
+    // any change of version, address size or encoder starts a new index
+    return llformat("%.2f/%u/%s", sHeaderCacheVersion, sHeaderCacheAddressSize,
+                    sHeaderCacheEncoderVersion.c_str());
 }
 
-void LLTextureCache::writeEntriesHeader()
+// Called in the main thread, with no workers running.
+void LLTextureCache::openIndex()
 {
-    llassert_always(mHeaderAPRFile == NULL);
-    if (!mReadOnly)
+    const std::string version = getIndexVersion();
+    LLTextureCacheIndex::EOpenResult result = mIndex.open(mIndexFileName, mIndexSlots, version, mReadOnly);
+    if (result == LLTextureCacheIndex::OPEN_CREATED)
     {
-        LLAPRFile::writeEx(mHeaderEntriesFileName, (U8*)&mHeaderEntriesInfo, 0, sizeof(EntriesInfo),
-                           mHeaderAPRFilePoolp);
+        // the header data, fast cache and bodies there are don't belong to it
+        LL_INFOS("TextureCache") << "New texture cache index, purging." << LL_ENDL;
+        mIndex.close();
+        purgeAllTextures(false);
+        result = mIndex.open(mIndexFileName, mIndexSlots, version, mReadOnly);
     }
-}
-
-//mHeaderMutex is locked before calling this.
-S32 LLTextureCache::openAndReadEntry(const LLUUID& id, Entry& entry, bool create)
-{
-    S32 idx = -1;
-
-    id_map_t::iterator iter1 = mHeaderIDMap.find(id);
-    if (iter1 != mHeaderIDMap.end())
+    if (result == LLTextureCacheIndex::OPEN_FAILED && !mReadOnly)
     {
-        idx = iter1->second;
-    }
-
-    if (idx < 0)
-    {
-        if (create && !mReadOnly)
-        {
-            if (mHeaderEntriesInfo.mEntries < sCacheMaxEntries)
-            {
-                // Add an entry to the end of the list
-                idx = mHeaderEntriesInfo.mEntries++;
-
-            }
-            else if (!mFreeList.empty())
-            {
-                idx = *(mFreeList.begin());
-                mFreeList.erase(mFreeList.begin());
-            }
-            else
-            {
-                // Look for a still valid entry in the LRU
-                for (std::set<LLUUID>::iterator iter2 = mLRU.begin(); iter2 != mLRU.end();)
-                {
-                    std::set<LLUUID>::iterator curiter2 = iter2++;
-                    LLUUID oldid = *curiter2;
-                    // Erase entry from LRU regardless
-                    mLRU.erase(curiter2);
-                    // Look up entry and use it if it is valid
-                    id_map_t::iterator iter3 = mHeaderIDMap.find(oldid);
-                    if (iter3 != mHeaderIDMap.end() && iter3->second >= 0)
-                    {
-                        idx = iter3->second;
-                        removeCachedTexture(oldid) ;//remove the existing cached texture to release the entry index.
-                        break;
-                    }
-                }
-                // if (idx < 0) at this point, we will rebuild the LRU
-                //  and retry if called from setHeaderCacheEntry(),
-                //  otherwise this shouldn't happen and will trigger an error
-            }
-            if (idx >= 0)
-            {
-                entry.mID = id ;
-                entry.mImageSize = -1 ; //mark it is a brand-new entry.
-                entry.mBodySize = 0 ;
-            }
-        }
-    }
-    else
-    {
-        // Remove this entry from the LRU if it exists
-        mLRU.erase(id);
-        // Read the entry
-        idx_entry_map_t::iterator iter = mUpdatedEntryMap.find(idx) ;
-        if(iter != mUpdatedEntryMap.end())
-        {
-            entry = iter->second ;
-        }
-        else
-        {
-            readEntryFromHeaderImmediately(idx, entry) ;
-        }
-        if(entry.mImageSize <= entry.mBodySize)//it happens on 64-bit systems, do not know why
-        {
-            LL_WARNS() << "corrupted entry: " << id << " entry image size: " << entry.mImageSize << " entry body size: " << entry.mBodySize << LL_ENDL ;
-
-            //erase this entry and the cached texture from the cache.
-            std::string tex_filename = getTextureFileName(id);
-            removeEntry(idx, entry, tex_filename) ;
-            mUpdatedEntryMap.erase(idx) ;
-            idx = -1 ;
-        }
+        LL_WARNS("TextureCache") << "Unable to open " << mIndexFileName
+                                 << ", switching the texture cache to read only" << LL_ENDL;
+        setReadOnly(true);
     }
-    return idx;
 }
 
-//mHeaderMutex is locked before calling this.
-void LLTextureCache::writeEntryToHeaderImmediately(S32& idx, Entry& entry, bool write_header)
+// Called in the main thread, with no workers running.
+void LLTextureCache::openRawCache(S64 max_size)
 {
-    LLAPRFile* aprfile ;
-    S32 bytes_written ;
-    S32 offset = sizeof(EntriesInfo) + idx * sizeof(Entry);
-    if(write_header)
+    std::vector<U32> dimensions;
+    for (const std::string& token : LLStringUtil::getTokens(gSavedSettings.getString("TextureRawCacheDimensions"), ", "))
     {
-        aprfile = openHeaderEntriesFile(false, 0);
-        bytes_written = aprfile->write((U8*)&mHeaderEntriesInfo, sizeof(EntriesInfo)) ;
-        if(bytes_written != sizeof(EntriesInfo))
+        U32 dimension = 0;
+        if (LLStringUtil::convertToU32(token, dimension))
         {
-            clearCorruptedCache() ; //clear the cache.
-            idx = -1 ;//mark the idx invalid.
-            return ;
+            dimensions.push_back(dimension);
         }
-
-        mHeaderAPRFile->seek(APR_SET, offset);
-    }
-    else
-    {
-        aprfile = openHeaderEntriesFile(false, offset);
-    }
-    bytes_written = aprfile->write((void*)&entry, (S32)sizeof(Entry));
-    if(bytes_written != sizeof(Entry))
-    {
-        clearCorruptedCache() ; //clear the cache.
-        idx = -1 ;//mark the idx invalid.
-
-        return ;
-    }
-
-    closeHeaderEntriesFile();
-    mUpdatedEntryMap.erase(idx) ;
-}
-
-//mHeaderMutex is locked before calling this.
-void LLTextureCache::readEntryFromHeaderImmediately(S32& idx, Entry& entry)
-{
-    S32 offset = sizeof(EntriesInfo) + idx * sizeof(Entry);
-    LLAPRFile* aprfile = openHeaderEntriesFile(true, offset);
-    S32 bytes_read = aprfile->read((void*)&entry, (S32)sizeof(Entry));
-    closeHeaderEntriesFile();
-
-    if(bytes_read != sizeof(Entry))
-    {
-        clearCorruptedCache() ; //clear the cache.
-        idx = -1 ;//mark the idx invalid.
-    }
-}
-
-//mHeaderMutex is locked before calling this.
-//update an existing entry time stamp, delay writing.
-void LLTextureCache::updateEntryTimeStamp(S32 idx, Entry& entry)
-{
-    static const U32 MAX_ENTRIES_WITHOUT_TIME_STAMP = (U32)(LLTextureCache::sCacheMaxEntries * 0.75f) ;
-
-    if(mHeaderEntriesInfo.mEntries < MAX_ENTRIES_WITHOUT_TIME_STAMP)
-    {
-        return ; //there are enough empty entry index space, no need to stamp time.
     }
-
-    if (idx >= 0)
+    if (max_size > 0 && !dimensions.empty() && mIndex.isOpen())
     {
-        if (!mReadOnly)
-        {
-            entry.mTime = (U32)time(NULL);
-            mUpdatedEntryMap[idx] = entry ;
-        }
+        mRawCache.open(mTexturesDirName, dimensions, max_size, getIndexVersion(), mReadOnly);
     }
 }
 
-//update an existing entry, write to header file immediately.
+//update an existing entry.
 bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32 new_data_size)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
@@ -1283,307 +1147,42 @@ bool LLTextureCache::updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32
     {
         return true ; //nothing changed.
     }
-    else
-    {
-        bool purge = false ;
-
-        lockHeaders() ;
-
-        bool update_header = false ;
-        if(entry.mImageSize < 0) //is a brand-new entry
-        {
-            mHeaderIDMap[entry.mID] = idx;
-            mTexturesSizeMap[entry.mID] = new_body_size ;
-            mTexturesSizeTotal += new_body_size ;
-
-            // Update Header
-            update_header = true ;
-        }
-        else if (entry.mBodySize != new_body_size)
-        {
-            //already in mHeaderIDMap.
-            mTexturesSizeMap[entry.mID] = new_body_size ;
-            mTexturesSizeTotal -= entry.mBodySize ;
-            mTexturesSizeTotal += new_body_size ;
-        }
-        entry.mTime = (U32)time(NULL);
-        entry.mImageSize = new_image_size ;
-        entry.mBodySize = new_body_size ;
-
-        writeEntryToHeaderImmediately(idx, entry, update_header) ;
-
-        if (mTexturesSizeTotal > sCacheMaxTexturesSize)
-        {
-            purge = true;
-        }
-
-        unlockHeaders() ;
-
-        if (purge)
-        {
-            mDoPurge = true;
-        }
-    }
-
-    return false ;
-}
-
-U32 LLTextureCache::openAndReadEntries(std::vector<Entry>& entries)
-{
-    U32 num_entries = mHeaderEntriesInfo.mEntries;
-
-    mHeaderIDMap.clear();
-    mTexturesSizeMap.clear();
-    mFreeList.clear();
-    mTexturesSizeTotal = 0;
 
-    LLAPRFile* aprfile = NULL;
-    if(mUpdatedEntryMap.empty())
-    {
-        aprfile = openHeaderEntriesFile(true, (S32)sizeof(EntriesInfo));
-    }
-    else //update the header file first.
-    {
-        aprfile = openHeaderEntriesFile(false, 0);
-        updatedHeaderEntriesFile() ;
-        if(!aprfile)
-        {
-            return 0;
-        }
-        aprfile->seek(APR_SET, (S32)sizeof(EntriesInfo));
-    }
-    for (U32 idx=0; idx<num_entries; idx++)
+    entry.mTime = (U32)time(NULL);
+    entry.mImageSize = new_image_size ;
+    entry.mBodySize = new_body_size ;
+    if (!mIndex.update(idx, entry.mID, new_image_size, new_body_size, entry.mTime))
     {
-        Entry entry;
-        S32 bytes_read = aprfile->read((void*)(&entry), (S32)sizeof(Entry));
-        if (bytes_read < sizeof(Entry))
-        {
-            LL_WARNS() << "Corrupted header entries, failed at " << idx << " / " << num_entries << LL_ENDL;
-            closeHeaderEntriesFile();
-            purgeAllTextures(false);
-            return 0;
-        }
-        entries.push_back(entry);
-//      LL_INFOS() << "ENTRY: " << entry.mTime << " TEX: " << entry.mID << " IDX: " << idx << " Size: " << entry.mImageSize << LL_ENDL;
-        if(entry.mImageSize > entry.mBodySize)
-        {
-            mHeaderIDMap[entry.mID] = idx;
-            mTexturesSizeMap[entry.mID] = entry.mBodySize;
-            mTexturesSizeTotal += entry.mBodySize;
-        }
-        else
-        {
-            mFreeList.insert(idx);
-        }
-    }
-    closeHeaderEntriesFile();
-    return num_entries;
-}
-
-void LLTextureCache::writeEntriesAndClose(const std::vector<Entry>& entries)
-{
-    auto num_entries = entries.size();
-    llassert_always(num_entries == mHeaderEntriesInfo.mEntries);
-
-    if (!mReadOnly)
-    {
-        LLAPRFile* aprfile = openHeaderEntriesFile(false, (S32)sizeof(EntriesInfo));
-        for (size_t idx=0; idx<num_entries; idx++)
-        {
-            S32 bytes_written = aprfile->write((void*)(&entries[idx]), (S32)sizeof(Entry));
-            if(bytes_written != sizeof(Entry))
-            {
-                clearCorruptedCache() ; //clear the cache.
-                return ;
-            }
-        }
-        closeHeaderEntriesFile();
+        idx = -1 ; //removed or evicted meanwhile.
+        return false;
     }
-}
 
-void LLTextureCache::writeUpdatedEntries()
-{
-    lockHeaders() ;
-    if (!mReadOnly && !mUpdatedEntryMap.empty())
+    if (mIndex.getBodyBytes() > sCacheMaxTexturesSize)
     {
-        openHeaderEntriesFile(false, 0);
-        updatedHeaderEntriesFile() ;
-        closeHeaderEntriesFile();
+        mDoPurge = true;
     }
-    unlockHeaders() ;
+    return false ;
 }
 
-//mHeaderMutex is locked and mHeaderAPRFile is created before calling this.
-void LLTextureCache::updatedHeaderEntriesFile()
-{
-    if (!mReadOnly && !mUpdatedEntryMap.empty() && mHeaderAPRFile)
-    {
-        //entriesInfo
-        mHeaderAPRFile->seek(APR_SET, 0);
-        S32 bytes_written = mHeaderAPRFile->write((U8*)&mHeaderEntriesInfo, sizeof(EntriesInfo)) ;
-        if(bytes_written != sizeof(EntriesInfo))
-        {
-            clearCorruptedCache() ; //clear the cache.
-            return ;
-        }
-
-        //write each updated entry
-        S32 entry_size = (S32)sizeof(Entry) ;
-        S32 prev_idx = -1 ;
-        S32 delta_idx ;
-        for (idx_entry_map_t::iterator iter = mUpdatedEntryMap.begin(); iter != mUpdatedEntryMap.end(); ++iter)
-        {
-            delta_idx = iter->first - prev_idx - 1;
-            prev_idx = iter->first ;
-            if(delta_idx)
-            {
-                mHeaderAPRFile->seek(APR_CUR, delta_idx * entry_size);
-            }
-
-            bytes_written = mHeaderAPRFile->write((void*)(&iter->second), entry_size);
-            if(bytes_written != entry_size)
-            {
-                clearCorruptedCache() ; //clear the cache.
-                return ;
-            }
-        }
-        mUpdatedEntryMap.clear() ;
-    }
-}
-//----------------------------------------------------------------------------
+//////////////////////////////////////////////////////////////////////////////
 
-// Called from either the main thread or the worker thread
-void LLTextureCache::readHeaderCache()
+void LLTextureCache::purgeAllTextures(bool purge_directories)
 {
-    mHeaderMutex.lock();
-
-    mLRU.clear(); // always clear the LRU
-
-    readEntriesHeader();
-
-    if (mHeaderEntriesInfo.mVersion != sHeaderCacheVersion
-        || mHeaderEntriesInfo.mAdressSize != sHeaderCacheAddressSize
-        || strcmp(mHeaderEntriesInfo.mEncoderVersion, sHeaderCacheEncoderVersion.c_str()) != 0)
+    if (!mReadOnly)
     {
-        if (!mReadOnly)
+        // An open index may be in use by the workers: empty it in place
+        // rather than deleting it under them.
+        const bool keep_index = mIndex.isOpen();
+        if (keep_index)
         {
-            LL_INFOS() << "Texture Cache version mismatch, Purging." << LL_ENDL;
-            purgeAllTextures(false);
+            mIndex.clear();
+            mRawCache.clear();
         }
-    }
-    else
-    {
-        std::vector<Entry> entries;
-        U32 num_entries = openAndReadEntries(entries);
-        if (num_entries)
-        {
-            U32 empty_entries = 0;
-            typedef std::pair<U32, S32> lru_data_t;
-            std::set<lru_data_t> lru;
-            std::set<U32> purge_list;
-            for (U32 i=0; i<num_entries; i++)
-            {
-                Entry& entry = entries[i];
-                if (entry.mImageSize <= 0)
-                {
-                    // This will be in the Free List, don't put it in the LRU
-                    ++empty_entries;
-                }
-                else
-                {
-                    lru.insert(std::make_pair(entry.mTime, i));
-                    if (entry.mBodySize > 0)
-                    {
-                        if (entry.mBodySize > entry.mImageSize)
-                        {
-                            // Shouldn't happen, failsafe only
-                            LL_WARNS() << "Bad entry: " << i << ": " << entry.mID << ": BodySize: " << entry.mBodySize << LL_ENDL;
-                            purge_list.insert(i);
-                        }
-                    }
-                }
-            }
-            if (num_entries - empty_entries > sCacheMaxEntries)
-            {
-                // Special case: cache size was reduced, need to remove entries
-                U32 entries_to_purge = (num_entries - empty_entries) - sCacheMaxEntries;
-                LL_INFOS() << "Texture Cache Entries: " << num_entries << " Max: " << sCacheMaxEntries << " Empty: " << empty_entries << " Purging: " << entries_to_purge << LL_ENDL;
-                // We can exit the following loop with the given condition, since if we'd reach the end of the lru set we'd have:
-                // purge_list.size() = lru.size() = num_entries - empty_entries = entries_to_purge + sCacheMaxEntries >= entries_to_purge
-                // So, it's certain that iter will never reach lru.end() first.
-                std::set<lru_data_t>::iterator iter = lru.begin();
-                while (purge_list.size() < entries_to_purge)
-                {
-                    purge_list.insert(iter->second);
-                    ++iter;
-                }
-            }
-
-            {
-                S32 lru_entries = (S32)((F32)sCacheMaxEntries * TEXTURE_CACHE_LRU_SIZE);
-                for (std::set<lru_data_t>::iterator iter = lru.begin(); iter != lru.end(); ++iter)
-                {
-                    mLRU.insert(entries[iter->second].mID);
-//                  LL_INFOS() << "LRU: " << iter->first << " : " << iter->second << LL_ENDL;
-                    if (--lru_entries <= 0)
-                        break;
-                }
-            }
-
-            if (purge_list.size() > 0)
-            {
-                LLTimer timer;
-                for (std::set<U32>::iterator iter = purge_list.begin(); iter != purge_list.end(); ++iter)
-                {
-                    std::string tex_filename = getTextureFileName(entries[*iter].mID);
-                    removeEntry((S32)*iter, entries[*iter], tex_filename);
-
-                    //make sure that pruning entries doesn't take too much time
-                    if (timer.getElapsedTimeF32() > TEXTURE_PRUNING_MAX_TIME)
-                    {
-                        break;
-                    }
-                }
-                writeEntriesAndClose(entries);
-            }
-            else
-            {
-                //entries are not changed, nothing here.
-            }
-        }
-    }
-    mHeaderMutex.unlock();
-}
-
-//////////////////////////////////////////////////////////////////////////////
-
-//the header mutex is locked before calling this.
-void LLTextureCache::clearCorruptedCache()
-{
-    LL_WARNS() << "the texture cache is corrupted, need to be cleared." << LL_ENDL ;
-
-    closeHeaderEntriesFile();//close possible file handler
-    purgeAllTextures(false) ; //clear the cache.
-
-    if (!mReadOnly) //regenerate the directory tree if not exists.
-    {
-        LLFile::mkdir(mTexturesDirName);
-
-        const char* subdirs = "0123456789abcdef";
-        for (S32 i=0; i<16; i++)
+        else
         {
-            std::string dirname = mTexturesDirName + gDirUtilp->getDirDelimiter() + subdirs[i];
-            LLFile::mkdir(dirname);
+            mRawCache.close();
         }
-    }
-
-    return ;
-}
-
-void LLTextureCache::purgeAllTextures(bool purge_directories)
-{
-    if (!mReadOnly)
-    {
+        clearPrefetched();
 // <FS:ND> Windows can be really slow deleting a huge texture cache.
 // In case of a full purge rename the directory and then purge this using a low priority background thread.
 #if LL_WINDOWS
@@ -1629,7 +1228,15 @@ void LLTextureCache::purgeAllTextures(bool purge_directories)
         if (LLFile::isdir(mTexturesDirName))
         {
         // </FS:Ansariel>
-        gDirUtilp->deleteFilesInDir(mTexturesDirName, mask); // headers, fast cache
+        if (keep_index)
+        {
+            gDirUtilp->deleteFilesInDir(mTexturesDirName, "*.cache"); // headers, fast cache
+            LLFile::remove(mTexturesDirName + gDirUtilp->getDirDelimiter() + entries_filename, ENOENT);
+        }
+        else
+        {
+            gDirUtilp->deleteFilesInDir(mTexturesDirName, mask); // index, headers, fast cache
+        }
         if (purge_directories)
         {
             LLFile::rmdir(mTexturesDirName);
@@ -1639,16 +1246,7 @@ void LLTextureCache::purgeAllTextures(bool purge_directories)
         // </FS:Ansariel>
         }
     }
-    mHeaderIDMap.clear();
-    mTexturesSizeMap.clear();
-    mTexturesSizeTotal = 0;
-    mFreeList.clear();
-    mTexturesSizeTotal = 0;
-    mUpdatedEntryMap.clear();
-
-    // Info with 0 entries
-    setEntriesHeader();
-    writeEntriesHeader();
+    mPurgeEntryList.clear();
 
     LL_INFOS() << "The entire texture cache is cleared." << LL_ENDL ;
 }
@@ -1670,45 +1268,33 @@ void LLTextureCache::purgeTexturesLazy(F32 time_limit_sec)
 
     if (mPurgeEntryList.empty())
     {
-        // Read the entries list and form list of textures to purge
-        std::vector<Entry> entries;
-        U32 num_entries = openAndReadEntries(entries);
-        if (!num_entries)
+        // Collect the entries with bodies, least recently used first
+        LLTextureCacheIndex::slot_entry_vector_t entries;
+        mIndex.getEntries(entries);
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [](const std::pair<S32, Entry>& slot_entry)
+                                     {
+                                         return slot_entry.second.mBodySize <= 0;
+                                     }),
+                      entries.end());
+        if (entries.empty())
         {
             return; // nothing to purge
         }
+        std::sort(entries.begin(), entries.end(),
+                  [](const std::pair<S32, Entry>& a, const std::pair<S32, Entry>& b)
+                  {
+                      return a.second.mTime < b.second.mTime;
+                  });
 
-        // Use mTexturesSizeMap to collect UUIDs of textures with bodies
-        typedef std::set<std::pair<U32, S32> > time_idx_set_t;
-        std::set<std::pair<U32, S32> > time_idx_set;
-        for (size_map_t::iterator iter1 = mTexturesSizeMap.begin();
-            iter1 != mTexturesSizeMap.end(); ++iter1)
-        {
-            if (iter1->second > 0)
-            {
-                id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
-                if (iter2 != mHeaderIDMap.end())
-                {
-                    S32 idx = iter2->second;
-                    time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
-                }
-                else
-                {
-                    LL_ERRS("TextureCache") << "mTexturesSizeMap / mHeaderIDMap corrupted." << LL_ENDL;
-                }
-            }
-        }
-
-        S64 cache_size = mTexturesSizeTotal;
+        S64 cache_size = mIndex.getBodyBytes();
         S64 purged_cache_size = (llmax(cache_size, sCacheMaxTexturesSize) * (S64)((1.f - TEXTURE_CACHE_PURGE_AMOUNT) * 100)) / 100;
-        for (time_idx_set_t::iterator iter = time_idx_set.begin();
-            iter != time_idx_set.end(); ++iter)
+        for (const auto& slot_entry : entries)
         {
-            S32 idx = iter->second;
             if (cache_size >= purged_cache_size)
             {
-                cache_size -= entries[idx].mBodySize;
-                mPurgeEntryList.push_back(std::pair<S32, Entry>(idx, entries[idx]));
+                cache_size -= slot_entry.second.mBodySize;
+                mPurgeEntryList.push_back(slot_entry);
             }
             else
             {
@@ -1726,134 +1312,16 @@ void LLTextureCache::purgeTexturesLazy(F32 time_limit_sec)
             S32 idx = mPurgeEntryList.back().first;
             Entry entry = mPurgeEntryList.back().second;
             mPurgeEntryList.pop_back();
-            // make sure record is still valid
-            id_map_t::iterator iter_header = mHeaderIDMap.find(entry.mID);
-            if (iter_header != mHeaderIDMap.end() && iter_header->second == idx)
+            // only if the slot still holds that texture
+            if (removeEntry(idx, entry))
             {
-                std::string tex_filename = getTextureFileName(entry.mID);
-                removeEntry(idx, entry, tex_filename);
-                writeEntryToHeaderImmediately(idx, entry);
+                LLCacheStats::evicted(LLCacheStats::TEXTURE_HEADER);
+                LLCacheStats::evicted(LLCacheStats::TEXTURE_BODY);
             }
         }
     }
 }
 
-void LLTextureCache::purgeTextures(bool validate)
-{
-    if (mReadOnly)
-    {
-        return;
-    }
-
-    if (!mThreaded)
-    {
-        // *FIX:Mani - watchdog off.
-        LLAppViewer::instance()->pauseMainloopTimeout();
-    }
-
-    LLMutexLock lock(&mHeaderMutex);
-
-    LL_INFOS() << "TEXTURE CACHE: Purging." << LL_ENDL;
-
-    // Read the entries list
-    std::vector<Entry> entries;
-    U32 num_entries = openAndReadEntries(entries);
-    if (!num_entries)
-    {
-        return; // nothing to purge
-    }
-
-    // Use mTexturesSizeMap to collect UUIDs of textures with bodies
-    typedef std::set<std::pair<U32,S32> > time_idx_set_t;
-    std::set<std::pair<U32,S32> > time_idx_set;
-    for (size_map_t::iterator iter1 = mTexturesSizeMap.begin();
-         iter1 != mTexturesSizeMap.end(); ++iter1)
-    {
-        if (iter1->second > 0)
-        {
-            id_map_t::iterator iter2 = mHeaderIDMap.find(iter1->first);
-            if (iter2 != mHeaderIDMap.end())
-            {
-                S32 idx = iter2->second;
-                time_idx_set.insert(std::make_pair(entries[idx].mTime, idx));
-//              LL_INFOS() << "TIME: " << entries[idx].mTime << " TEX: " << entries[idx].mID << " IDX: " << idx << " Size: " << entries[idx].mImageSize << LL_ENDL;
-            }
-            else
-            {
-                LL_ERRS() << "mTexturesSizeMap / mHeaderIDMap corrupted." << LL_ENDL ;
-            }
-        }
-    }
-
-    // Validate 1/256th of the files on startup
-    U32 validate_idx = 0;
-    if (validate)
-    {
-        validate_idx = gSavedSettings.getU32("CacheValidateCounter");
-        U32 next_idx = (validate_idx + 1) % 256;
-        gSavedSettings.setU32("CacheValidateCounter", next_idx);
-        LL_DEBUGS("TextureCache") << "TEXTURE CACHE: Validating: " << validate_idx << LL_ENDL;
-    }
-
-    S64 cache_size = mTexturesSizeTotal;
-    S64 purged_cache_size = (llmax(cache_size, sCacheMaxTexturesSize) * (S64)((1.f - TEXTURE_CACHE_PURGE_AMOUNT) * 100)) / 100;
-    S32 purge_count = 0;
-    for (time_idx_set_t::iterator iter = time_idx_set.begin();
-         iter != time_idx_set.end(); ++iter)
-    {
-        S32 idx = iter->second;
-        bool purge_entry = false;
-
-        if (cache_size >= purged_cache_size)
-        {
-            purge_entry = true;
-        }
-        else if (validate)
-        {
-            // make sure file exists and is the correct size
-            U32 uuididx = entries[idx].mID.mData[0];
-            if (uuididx == validate_idx)
-            {
-                std::string filename = getTextureFileName(entries[idx].mID);
-                LL_DEBUGS("TextureCache") << "Validating: " << filename << "Size: " << entries[idx].mBodySize << LL_ENDL;
-                // mHeaderAPRFilePoolp because this is under header mutex in main thread
-                S32 bodysize = LLAPRFile::size(filename, mHeaderAPRFilePoolp);
-                if (bodysize != entries[idx].mBodySize)
-                {
-                    LL_WARNS("TextureCache") << "TEXTURE CACHE BODY HAS BAD SIZE: " << bodysize << " != " << entries[idx].mBodySize << filename << LL_ENDL;
-                    purge_entry = true;
-                }
-            }
-        }
-        else
-        {
-            break;
-        }
-
-        if (purge_entry)
-        {
-            purge_count++;
-            std::string filename = getTextureFileName(entries[idx].mID);
-            LL_DEBUGS("TextureCache") << "PURGING: " << filename << LL_ENDL;
-            cache_size -= entries[idx].mBodySize;
-            removeEntry(idx, entries[idx], filename) ;
-        }
-    }
-
-    LL_DEBUGS("TextureCache") << "TEXTURE CACHE: Writing Entries: " << num_entries << LL_ENDL;
-
-    writeEntriesAndClose(entries);
-
-    // *FIX:Mani - watchdog back on.
-    LLAppViewer::instance()->resumeMainloopTimeout();
-
-    LL_INFOS("TextureCache") << "TEXTURE CACHE:"
-            << " PURGED: " << purge_count
-            << " ENTRIES: " << num_entries
-            << " CACHE SIZE: " << mTexturesSizeTotal / (1024 * 1024) << " MB"
-            << LL_ENDL;
-}
-
 //////////////////////////////////////////////////////////////////////////////
 
 // call lockWorkers() first!
@@ -1888,11 +1356,22 @@ LLTextureCacheWorker* LLTextureCache::getWriter(handle_t handle)
 S32 LLTextureCache::getHeaderCacheEntry(const LLUUID& id, Entry& entry)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
-    LLMutexLock lock(&mHeaderMutex);
-    S32 idx = openAndReadEntry(id, entry, false);
+    S32 idx = mIndex.lookup(id, entry);
     if (idx >= 0)
     {
-        updateEntryTimeStamp(idx, entry); // updates time
+        if(entry.mImageSize <= entry.mBodySize)//it happens on 64-bit systems, do not know why
+        {
+            LL_WARNS() << "corrupted entry: " << id << " entry image size: " << entry.mImageSize << " entry body size: " << entry.mBodySize << LL_ENDL ;
+
+            //erase this entry and the cached texture from the cache.
+            removeEntry(idx, entry);
+            return -1;
+        }
+        if (!mReadOnly)
+        {
+            entry.mTime = (U32)time(NULL);
+            mIndex.touch(idx, id, entry.mTime); // updates time
+        }
     }
     return idx;
 }
@@ -1901,29 +1380,37 @@ S32 LLTextureCache::getHeaderCacheEntry(const LLUUID& id, Entry& entry)
 S32 LLTextureCache::setHeaderCacheEntry(const LLUUID& id, Entry& entry, S32 imagesize, S32 datasize)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
-    mHeaderMutex.lock();
-    S32 idx = openAndReadEntry(id, entry, true); // read or create
-    mHeaderMutex.unlock();
-
-    if(idx < 0) // retry once
+    if (mReadOnly)
     {
-        readHeaderCache(); // We couldn't write an entry, so refresh the LRU
+        return -1;
+    }
 
-        mHeaderMutex.lock();
-        idx = openAndReadEntry(id, entry, true);
-        mHeaderMutex.unlock();
+    // Make room: each eviction takes the least recently used of a sample
+    Entry evicted;
+    while (mIndex.size() >= sCacheMaxEntries && mIndex.evict(evicted))
+    {
+        removeTextureFile(evicted.mID, evicted.mBodySize);
+        LLCacheStats::evicted(LLCacheStats::TEXTURE_HEADER);
+        if (evicted.mBodySize > 0)
+        {
+            LLCacheStats::evicted(LLCacheStats::TEXTURE_BODY);
+        }
     }
 
+    S32 body_size = llmax(0, datasize - TEXTURE_CACHE_ENTRY_SIZE);
+    S32 idx = mIndex.insert(id, imagesize, body_size, (U32)time(NULL), entry); // read or create
     if (idx >= 0)
     {
+        // another worker may have created it first
         updateEntry(idx, entry, imagesize, datasize);
+        if (mIndex.getBodyBytes() > sCacheMaxTexturesSize)
+        {
+            mDoPurge = true;
+        }
     }
     else
     {
         LL_WARNS() << "Failed to set cache entry for image: " << id << LL_ENDL;
-        // We couldn't write to file, switch to read only mode and clear data
-        setReadOnly(true);
-        clearCorruptedCache(); // won't remove files due to "read only"
     }
 
     return idx;
@@ -2033,18 +1520,53 @@ LLTextureCache::handle_t LLTextureCache::writeToCache(const LLUUID& id,
 //called in the main thread
 LLPointer<LLImageRaw> LLTextureCache::readFromFastCache(const LLUUID& id, S32& discardlevel)
 {
-    U32 offset;
+    LLCacheStats::Timer timer;
+    LLPointer<LLImageRaw> image;
     {
-        LLMutexLock lock(&mHeaderMutex);
-        id_map_t::const_iterator iter = mHeaderIDMap.find(id);
-        if(iter == mHeaderIDMap.end())
+        LLMutexLock lock(&mPrefetchMutex);
+        if (!mPrefetched.empty())
         {
-            return NULL; //not in the cache
+            auto iter = mPrefetched.find(id);
+            if (iter != mPrefetched.end())
+            {
+                image = iter->second.mImage;
+                discardlevel = iter->second.mDiscardLevel;
+                mPrefetched.erase(iter);
+                ++mPrefetchStats.mHits;
+            }
         }
+    }
+    if (image.isNull())
+    {
+        image = readFastCacheEntry(id, discardlevel);
+    }
 
-        offset = iter->second;
+    if (image.notNull())
+    {
+        LLCacheStats::hit(LLCacheStats::TEXTURE_FAST);
+        LLCacheStats::read(LLCacheStats::TEXTURE_FAST, image->getDataSize(), timer.getMicros());
     }
-    offset *= TEXTURE_FAST_CACHE_ENTRY_SIZE;
+    else
+    {
+        LLCacheStats::miss(LLCacheStats::TEXTURE_FAST);
+    }
+    return image;
+}
+
+LLPointer<LLImageRaw> LLTextureCache::readFastCacheEntry(const LLUUID& id, S32& discardlevel)
+{
+    LLPointer<LLImageRaw> decoded = mRawCache.read(id, discardlevel);
+    if (decoded.notNull())
+    {
+        return decoded;
+    }
+
+    S32 idx = mIndex.find(id);
+    if (idx < 0)
+    {
+        return NULL; //not in the cache
+    }
+    U32 offset = (U32)idx * TEXTURE_FAST_CACHE_ENTRY_SIZE;
 
     U8* data;
     S32 head[4];
@@ -2111,6 +1633,80 @@ LLPointer<LLImageRaw> LLTextureCache::readFromFastCache(const LLUUID& id, S32& d
     return raw;
 }
 
+void LLTextureCache::writeToRawCache(const LLUUID& id, LLImageRaw* raw, S32 discardlevel)
+{
+    mRawCache.write(id, raw, discardlevel);
+}
+
+void LLTextureCache::prefetch(const uuid_vec_t& ids, U32 generation, S64 max_bytes)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    {
+        LLMutexLock lock(&mPrefetchMutex);
+        if (generation != mPrefetchGeneration)
+        {
+            return;
+        }
+        mPrefetchStats.mRequested += (U32)ids.size();
+    }
+
+    // Headers aren't kept: reading them leaves them in the OS file cache
+    // for the workers that will read them shortly.
+    LLFILE* header_file = LLFile::fopen(mHeaderDataFileName, "rb");
+    U8 header[TEXTURE_CACHE_ENTRY_SIZE];
+    S64 bytes = 0;
+    for (const LLUUID& id : ids)
+    {
+        S32 idx = mIndex.find(id);
+        if (idx < 0)
+        {
+            continue;
+        }
+        if (header_file && !fseek(header_file, (long)idx * TEXTURE_CACHE_ENTRY_SIZE, SEEK_SET))
+        {
+            fread(header, 1, TEXTURE_CACHE_ENTRY_SIZE, header_file);
+        }
+
+        S32 discardlevel = 0;
+        LLPointer<LLImageRaw> image = readFastCacheEntry(id, discardlevel);
+        if (image.isNull())
+        {
+            continue;
+        }
+        bytes += image->getDataSize();
+
+        LLMutexLock lock(&mPrefetchMutex);
+        if (generation != mPrefetchGeneration)
+        {
+            break;
+        }
+        mPrefetched[id] = { image, discardlevel };
+        ++mPrefetchStats.mLoaded;
+        if (bytes >= max_bytes)
+        {
+            break;
+        }
+    }
+    if (header_file)
+    {
+        fclose(header_file);
+    }
+}
+
+U32 LLTextureCache::clearPrefetched()
+{
+    LLMutexLock lock(&mPrefetchMutex);
+    mPrefetched.clear();
+    mPrefetchStats = PrefetchStats();
+    return ++mPrefetchGeneration;
+}
+
+LLTextureCache::PrefetchStats LLTextureCache::getPrefetchStats()
+{
+    LLMutexLock lock(&mPrefetchMutex);
+    return mPrefetchStats;
+}
+
 //return the fast cache location
 bool LLTextureCache::writeToFastCache(LLUUID image_id, S32 id, LLPointer<LLImageRaw> raw, S32 discardlevel)
 {
@@ -2183,7 +1779,10 @@ bool LLTextureCache::writeToFastCache(LLUUID image_id, S32 id, LLPointer<LLImage
         //no need to do this assertion check. When it fails, let it fail quietly.
         //this failure could happen because other viewer removes the fast cache file when clearing cache.
         //--> llassert_always(mFastCachep->write(mFastCachePadBuffer, TEXTURE_FAST_CACHE_ENTRY_SIZE) == TEXTURE_FAST_CACHE_ENTRY_SIZE);
-        mFastCachep->write(mFastCachePadBuffer, TEXTURE_FAST_CACHE_ENTRY_SIZE);
+        if (mFastCachep->write(mFastCachePadBuffer, TEXTURE_FAST_CACHE_ENTRY_SIZE) == TEXTURE_FAST_CACHE_ENTRY_SIZE)
+        {
+            LLCacheStats::wrote(LLCacheStats::TEXTURE_FAST, TEXTURE_FAST_CACHE_ENTRY_SIZE);
+        }
 
         closeFastCache(true);
     }
@@ -2276,54 +1875,37 @@ void LLTextureCache::addCompleted(Responder* responder, bool success)
 
 //////////////////////////////////////////////////////////////////////////////
 
-//called after mHeaderMutex is locked.
-void LLTextureCache::removeCachedTexture(const LLUUID& id)
+// Removes the body file of a texture that is no longer in the index.
+void LLTextureCache::removeTextureFile(const LLUUID& id, S32 body_size)
 {
-    if(mTexturesSizeMap.find(id) != mTexturesSizeMap.end())
-    {
-        mTexturesSizeTotal -= mTexturesSizeMap[id] ;
-        mTexturesSizeMap.erase(id);
-    }
-    mHeaderIDMap.erase(id);
-    // We are inside header's mutex so mHeaderAPRFilePoolp is safe to use,
+    std::string filename = getTextureFileName(id);
+    LLFile::remove(getTranscodeFileName(id), ENOENT);
+    // mHeaderAPRFilePoolp is safe to use under header's mutex,
     // but getLocalAPRFilePool() is not safe, it might be in use by worker
-    LLAPRFile::remove(getTextureFileName(id), mHeaderAPRFilePoolp);
-}
-
-//called after mHeaderMutex is locked.
-void LLTextureCache::removeEntry(S32 idx, Entry& entry, std::string& filename)
-{
-    bool file_maybe_exists = true;  // Always attempt to remove when idx is invalid.
-
-    if(idx >= 0) //valid entry
+    LLMutexLock lock(&mHeaderMutex);
+    if (body_size == 0)   // Always attempt to remove when mBodySize > 0.
     {
-        if (entry.mBodySize == 0)   // Always attempt to remove when mBodySize > 0.
+        // Sanity check. Shouldn't exist when body size is 0.
+        if (!LLAPRFile::isExist(filename, mHeaderAPRFilePoolp))
         {
-          // Sanity check. Shouldn't exist when body size is 0.
-          // We are inside header's mutex so mHeaderAPRFilePoolp is safe to use,
-          // but getLocalAPRFilePool() is not safe, it might be in use by worker
-          if (LLAPRFile::isExist(filename, mHeaderAPRFilePoolp))
-          {
-              LL_WARNS("TextureCache") << "Entry has body size of zero but file " << filename << " exists. Deleting this file, too." << LL_ENDL;
-          }
-          else
-          {
-              file_maybe_exists = false;
-          }
+            return;
         }
-        mTexturesSizeTotal -= entry.mBodySize;
-
-        entry.mImageSize = -1;
-        entry.mBodySize = 0;
-        mHeaderIDMap.erase(entry.mID);
-        mTexturesSizeMap.erase(entry.mID);
-        mFreeList.insert(idx);
+        LL_WARNS("TextureCache") << "Entry has body size of zero but file " << filename << " exists. Deleting this file, too." << LL_ENDL;
     }
+    LLAPRFile::remove(filename, mHeaderAPRFilePoolp);
+}
 
-    if (file_maybe_exists)
+// The slot is retired before the body goes, so that the index never points
+// at a body that has been deleted.
+bool LLTextureCache::removeEntry(S32 idx, Entry& entry)
+{
+    Entry removed;
+    if (mIndex.remove(idx, entry.mID, &removed))
     {
-        LLAPRFile::remove(filename, mHeaderAPRFilePoolp);
+        removeTextureFile(entry.mID, removed.mBodySize);
+        return true;
     }
+    return false;
 }
 
 bool LLTextureCache::removeFromCache(const LLUUID& id)
@@ -2332,19 +1914,22 @@ bool LLTextureCache::removeFromCache(const LLUUID& id)
     bool ret = false ;
     if (!mReadOnly)
     {
-        lockHeaders() ;
-
+        {
+            LLMutexLock lock(&mPrefetchMutex);
+            mPrefetched.erase(id);
+        }
         Entry entry;
-        S32 idx = openAndReadEntry(id, entry, false);
-        std::string tex_filename = getTextureFileName(id);
-        removeEntry(idx, entry, tex_filename) ;
-        if (idx >= 0)
+        S32 idx = mIndex.lookup(id, entry);
+        if (idx >= 0 && mIndex.remove(idx, id, &entry))
         {
-            writeEntryToHeaderImmediately(idx, entry);
+            removeTextureFile(id, entry.mBodySize);
             ret = true;
         }
-
-        unlockHeaders() ;
+        else
+        {
+            // Always attempt to remove when there is no valid entry.
+            removeTextureFile(id, -1);
+        }
     }
     return ret ;
 }
@@ -33,6 +33,10 @@
 #include "lluuid.h"
 
 #include "llworkerthread.h"
+#include "lltexturecacheindex.h"
+#include "lltexturerawcache.h"
+
+#include <unordered_map>
 
 class LLImageFormatted;
 class LLTextureCacheWorker;
@@ -46,41 +50,7 @@ class LLTextureCache : public LLWorkerThread
 
 private:
 
-#if LL_WINDOWS
-#pragma pack(push,1)
-#endif
-
-    // Entries
-    static const U32 sHeaderEncoderStringSize = 32;
-    struct EntriesInfo
-    {
-        EntriesInfo() : mVersion(0.f), mAdressSize(0), mEntries(0) { memset(mEncoderVersion, 0, sHeaderEncoderStringSize); }
-        F32 mVersion;
-        U32 mAdressSize;
-        char mEncoderVersion[sHeaderEncoderStringSize];
-        U32 mEntries;
-    };
-    struct Entry
-    {
-            Entry() :
-                mBodySize(0),
-            mImageSize(0),
-            mTime(0)
-        {
-        }
-        Entry(const LLUUID& id, S32 imagesize, S32 bodysize, U32 time) :
-            mID(id), mImageSize(imagesize), mBodySize(bodysize), mTime(time) {}
-        void init(const LLUUID& id, U32 time) { mID = id, mImageSize = 0; mBodySize = 0; mTime = time; }
-        Entry& operator=(const Entry& entry) {mID = entry.mID, mImageSize = entry.mImageSize; mBodySize = entry.mBodySize; mTime = entry.mTime; return *this;}
-        LLUUID mID; // 16 bytes
-        S32 mImageSize; // total size of image if known
-        S32 mBodySize; // size of body file in body cache
-        U32 mTime; // seconds since 1/1/1970
-    };
-
-#if LL_WINDOWS
-#pragma pack(pop)
-#endif
+    typedef LLTextureCacheIndex::Entry Entry;
 
 public:
 
@@ -128,9 +98,31 @@ public:
     handle_t writeToCache(const LLUUID& id, const U8* data, S32 datasize, S32 imagesize, LLPointer<LLImageRaw> rawimage, S32 discardlevel,
                           WriteResponder* responder);
     LLPointer<LLImageRaw> readFromFastCache(const LLUUID& id, S32& discardlevel);
+    // Keep decoded images for readFromFastCache(). Called by the fetch
+    // workers; raw is only read.
+    void writeToRawCache(const LLUUID& id, LLImageRaw* raw, S32 discardlevel);
+    // Where the decode threads keep the BCn copy of a texture. It sits
+    // beside the body, goes with it and isn't counted in the cache size.
+    std::string getTranscodeFileName(const LLUUID& id);
     bool writeComplete(handle_t handle, bool abort = false);
     void prioritizeWrite(handle_t handle);
 
+    // Teleport warm-up: read the headers and fast cache entries of ids ahead
+    // of readFromFastCache(), which then hands the images out from memory.
+    // Runs off the main thread; stops once the images reach max_bytes or
+    // clearPrefetched() has moved on to another generation.
+    void prefetch(const uuid_vec_t& ids, U32 generation, S64 max_bytes);
+    // Drop what prefetch() kept and reset its counts. Returns the generation
+    // for the next prefetch().
+    U32 clearPrefetched();
+    struct PrefetchStats
+    {
+        U32 mRequested{ 0 };    // ids passed to prefetch()
+        U32 mLoaded{ 0 };       // images it kept in memory
+        U32 mHits{ 0 };         // of those, handed out by readFromFastCache()
+    };
+    PrefetchStats getPrefetchStats();
+
     bool removeFromCache(const LLUUID& id);
 
     // For LLTextureCacheWorker::Responder
@@ -142,12 +134,15 @@ public:
     // debug
     S32 getNumReads() { return static_cast<S32>(mReaders.size()); }
     S32 getNumWrites() { return static_cast<S32>(mWriters.size()); }
-    S64Bytes getUsage() { return S64Bytes(mTexturesSizeTotal); }
+    S64Bytes getUsage() { return S64Bytes(mIndex.getBodyBytes()); }
     S64Bytes getMaxUsage() { return S64Bytes(sCacheMaxTexturesSize); }
-    U32 getEntries() { return mHeaderEntriesInfo.mEntries; }
+    U32 getEntries() { return mIndex.size(); }
     U32 getMaxEntries() { return sCacheMaxEntries; };
+    S64Bytes getRawCacheUsage() { return S64Bytes(mRawCache.getBytes()); }
+    U32 getRawCacheEntries() { return mRawCache.getEntries(); }
     bool isInCache(const LLUUID& id) ;
     bool isInLocal(const LLUUID& id) ; //not thread safe at the moment
+    bool isReadOnly() const { return mReadOnly; }
 
 protected:
     // Accessed by LLTextureCacheWorker
@@ -160,48 +155,35 @@ protected:
 
 private:
     void setDirNames(ELLPath location);
-    void readHeaderCache();
-    void clearCorruptedCache();
+    static std::string getIndexVersion();
+    void openIndex();
+    void openRawCache(S64 max_size);
     void purgeAllTextures(bool purge_directories);
     void purgeTexturesLazy(F32 time_limit_sec);
-    void purgeTextures(bool validate);
-    LLAPRFile* openHeaderEntriesFile(bool readonly, S32 offset);
-    void closeHeaderEntriesFile();
-    void readEntriesHeader();
-    void setEntriesHeader();
-    void writeEntriesHeader();
-    S32 openAndReadEntry(const LLUUID& id, Entry& entry, bool create);
     bool updateEntry(S32& idx, Entry& entry, S32 new_image_size, S32 new_body_size);
-    void updateEntryTimeStamp(S32 idx, Entry& entry) ;
-    U32 openAndReadEntries(std::vector<Entry>& entries);
-    void writeEntriesAndClose(const std::vector<Entry>& entries);
-    void readEntryFromHeaderImmediately(S32& idx, Entry& entry) ;
-    void writeEntryToHeaderImmediately(S32& idx, Entry& entry, bool write_header = false) ;
-    void removeEntry(S32 idx, Entry& entry, std::string& filename);
-    void removeCachedTexture(const LLUUID& id) ;
+    bool removeEntry(S32 idx, Entry& entry);
+    void removeTextureFile(const LLUUID& id, S32 body_size);
     S32 getHeaderCacheEntry(const LLUUID& id, Entry& entry);
     S32 setHeaderCacheEntry(const LLUUID& id, Entry& entry, S32 imagesize, S32 datasize);
-    void writeUpdatedEntries() ;
-    void updatedHeaderEntriesFile() ;
-    void lockHeaders() { mHeaderMutex.lock(); }
-    void unlockHeaders() { mHeaderMutex.unlock(); }
 
     void openFastCache(bool first_time = false);
     void closeFastCache(bool forced = false);
     bool writeToFastCache(LLUUID image_id, S32 cache_id, LLPointer<LLImageRaw> raw, S32 discardlevel);
+    LLPointer<LLImageRaw> readFastCacheEntry(const LLUUID& id, S32& discardlevel);
 
 private:
     // Internal
     LLMutex mWorkersMutex;
+    // held by the main thread's bulk operations (purges) and for the pool
+    // below; per texture lookups and updates go to mIndex without it
     LLMutex mHeaderMutex;
     LLMutex mListMutex;
     LLMutex mFastCacheMutex;
-    LLAPRFile* mHeaderAPRFile;
     LLVolatileAPRPool* mFastCachePoolp;
 
     // mLocalAPRFilePoolp is not thread safe and is meant only for workers
-    // howhever mHeaderEntriesFileName is accessed not from workers' threads
-    // so it needs own pool (not thread safe by itself, relies onto header's mutex)
+    // however body files are also removed from other threads, which use
+    // this pool (not thread safe by itself, relies onto header's mutex)
     LLVolatileAPRPool*   mHeaderAPRFilePoolp;
 
     typedef std::map<handle_t, LLTextureCacheWorker*> handle_map_t;
@@ -219,30 +201,36 @@ private:
     std::string mCacheParentDirName;
 
     // HEADERS (Include first mip)
-    std::string mHeaderEntriesFileName;
+    std::string mIndexFileName;
     std::string mHeaderDataFileName;
     std::string mFastCacheFileName;
-    EntriesInfo mHeaderEntriesInfo;
-    std::set<S32> mFreeList; // deleted entries
-    std::set<LLUUID> mLRU;
-    typedef std::map<LLUUID, S32> id_map_t;
-    id_map_t mHeaderIDMap;
+    // entries by texture id; an entry's slot is its index into the header
+    // data and fast cache files
+    LLTextureCacheIndex mIndex;
+    U32 mIndexSlots;
+    // decoded images at a few sizes, tried before the fast cache
+    LLTextureRawCache mRawCache;
 
     LLAPRFile*   mFastCachep;
     LLFrameTimer mFastCacheTimer;
     U8*          mFastCachePadBuffer;
 
+    // images loaded by prefetch() and not yet asked for
+    struct Prefetched
+    {
+        LLPointer<LLImageRaw> mImage;
+        S32 mDiscardLevel;
+    };
+    LLMutex mPrefetchMutex;
+    std::unordered_map<LLUUID, Prefetched> mPrefetched;
+    PrefetchStats mPrefetchStats;
+    U32 mPrefetchGeneration;
+
     // BODIES (TEXTURES minus headers)
     std::string mTexturesDirName;
-    typedef std::map<LLUUID,S32> size_map_t;
-    size_map_t mTexturesSizeMap;
-    S64 mTexturesSizeTotal;
     LLAtomicBool mDoPurge;
 
-    typedef std::map<S32, Entry> idx_entry_map_t;
-    idx_entry_map_t mUpdatedEntryMap;
-    typedef std::vector<std::pair<S32, Entry> > idx_entry_vector_t;
-    idx_entry_vector_t mPurgeEntryList;
+    LLTextureCacheIndex::slot_entry_vector_t mPurgeEntryList;
 
     // Statics
     static F32 sHeaderCacheVersion;
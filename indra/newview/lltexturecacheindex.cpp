@@ -0,0 +1,618 @@
+/**
+ * @file   lltexturecacheindex.cpp
+ * @date   2026-10-18
+ * @brief  Memory-mapped hash index of the texture cache entries.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "lltexturecacheindex.h"
+
+#include "llfile.h"
+
+namespace
+{
+    const char INDEX_MAGIC[8] = { 'L', 'L', 'T', 'X', 'I', 'D', 'X', '1' };
+    const U32 INDEX_VERSION_SIZE = 96;
+
+    struct IndexHeader
+    {
+        char mMagic[8];
+        U32 mCapacity;
+        U32 mClean;
+        U32 mCount;
+        U32 mTombstones;
+        S64 mBodyBytes;
+        char mVersion[INDEX_VERSION_SIZE];
+    };
+    const size_t INDEX_HEADER_SIZE = sizeof(IndexHeader);
+    static_assert(INDEX_HEADER_SIZE == 128, "index header layout changed");
+
+    // Slot state words: the kind in the low bits, a generation count above
+    // it that changes on every write, so that a reader can tell whether the
+    // slot changed while it was copying it.
+    const U32 SLOT_EMPTY = 0;
+    const U32 SLOT_LIVE = 1;
+    const U32 SLOT_DELETED = 2;
+    const U32 SLOT_BUSY = 3;
+    const U32 SLOT_KIND_MASK = 3;
+
+    inline U32 slot_kind(U32 state)
+    {
+        return state & SLOT_KIND_MASK;
+    }
+
+    inline U32 next_state(U32 state, U32 kind)
+    {
+        return ((state & ~SLOT_KIND_MASK) + (SLOT_KIND_MASK + 1)) | kind;
+    }
+
+    // entries sampled per evict() call
+    const U32 EVICT_WINDOW = 32;
+    const U32 EVICT_MAX_WINDOWS = 64;
+
+    void split_id(const LLUUID& id, U64 words[2])
+    {
+        memcpy(words, id.mData, sizeof(U64) * 2);
+    }
+
+    std::string make_version(const std::string& version)
+    {
+        std::string result(version, 0, INDEX_VERSION_SIZE - 1);
+        result.resize(INDEX_VERSION_SIZE, '\0');
+        return result;
+    }
+
+    bool header_matches(const U8* data, size_t size, size_t bytes, U32 capacity,
+                        const std::string& version)
+    {
+        if (!data || size < bytes)
+        {
+            return false;
+        }
+        const IndexHeader* header = (const IndexHeader*)data;
+        return !memcmp(header->mMagic, INDEX_MAGIC, sizeof(INDEX_MAGIC))
+               && header->mCapacity == capacity
+               && !memcmp(header->mVersion, version.data(), INDEX_VERSION_SIZE);
+    }
+}
+
+static_assert(sizeof(std::atomic<U64>) == sizeof(U64) && std::atomic<U64>::is_always_lock_free,
+              "index slots need plain lock-free 64-bit atomics");
+
+LLTextureCacheIndex::LLTextureCacheIndex()
+    : mSlots(nullptr),
+      mCapacity(0),
+      mReadOnly(true),
+      mCount(0),
+      mTombstones(0),
+      mBodyBytes(0),
+      mEvictCursor(0)
+{
+    static_assert(sizeof(Slot) == 32, "index slot layout changed");
+}
+
+LLTextureCacheIndex::~LLTextureCacheIndex()
+{
+    close();
+}
+
+LLTextureCacheIndex::EOpenResult LLTextureCacheIndex::open(const std::string& filename, U32 capacity,
+                                                           const std::string& version, bool read_only)
+{
+    close();
+    if (!capacity)
+    {
+        return OPEN_FAILED;
+    }
+
+    const std::string padded_version = make_version(version);
+    const size_t bytes = INDEX_HEADER_SIZE + (size_t)capacity * sizeof(Slot);
+    bool existing = false;
+    {
+        LLMappedFile probe;
+        if (probe.map(filename))
+        {
+            existing = header_matches(probe.data(), probe.size(), bytes, capacity, padded_version);
+        }
+    }
+
+    mReadOnly = read_only;
+    if (read_only)
+    {
+        if (!existing || !mFile.map(filename)
+            || !header_matches(mFile.data(), mFile.size(), bytes, capacity, padded_version))
+        {
+            mFile.unmap();
+            return OPEN_FAILED;
+        }
+    }
+    else
+    {
+        if (!existing)
+        {
+            LLFile::remove(filename, ENOENT);
+        }
+        if (!mFile.mapWritable(filename, bytes))
+        {
+            LL_WARNS("TextureCache") << "Unable to map the texture cache index " << filename << LL_ENDL;
+            return OPEN_FAILED;
+        }
+    }
+
+    IndexHeader* header = (IndexHeader*)mFile.data();
+    mSlots = (Slot*)(mFile.data() + INDEX_HEADER_SIZE);
+    mCapacity = capacity;
+    mEvictCursor = 0;
+    if (!existing)
+    {
+        // a new file reads as zeroes: every slot is empty
+        memcpy(header->mMagic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        header->mCapacity = capacity;
+        memcpy(header->mVersion, padded_version.data(), INDEX_VERSION_SIZE);
+        mCount = 0;
+        mTombstones = 0;
+        mBodyBytes = 0;
+    }
+    else if (header->mClean)
+    {
+        mCount = header->mCount;
+        mTombstones = header->mTombstones;
+        mBodyBytes = header->mBodyBytes;
+    }
+    else
+    {
+        // not closed cleanly: the counts in the header may be stale
+        LL_INFOS("TextureCache") << "Texture cache index was not closed cleanly, recounting" << LL_ENDL;
+        recount();
+    }
+
+    if (!mReadOnly)
+    {
+        compact();
+        // dirty until close(), so a crash makes the next open() recount
+        header->mClean = 0;
+        storeCounts();
+        mFile.flush();
+    }
+
+    LL_INFOS("TextureCache") << "Texture cache index: " << mCount << " entries in " << mCapacity
+                             << " slots, " << mBodyBytes / (1024 * 1024) << " MB of bodies" << LL_ENDL;
+    return existing ? OPEN_EXISTING : OPEN_CREATED;
+}
+
+void LLTextureCacheIndex::close()
+{
+    if (!mSlots)
+    {
+        return;
+    }
+    if (!mReadOnly)
+    {
+        storeCounts();
+        ((IndexHeader*)mFile.data())->mClean = 1;
+        mFile.flush();
+    }
+    mFile.unmap();
+    mSlots = nullptr;
+    mCapacity = 0;
+    mCount = 0;
+    mTombstones = 0;
+    mBodyBytes = 0;
+}
+
+void LLTextureCacheIndex::storeCounts()
+{
+    IndexHeader* header = (IndexHeader*)mFile.data();
+    header->mCount = mCount;
+    header->mTombstones = mTombstones;
+    header->mBodyBytes = mBodyBytes;
+}
+
+void LLTextureCacheIndex::recount()
+{
+    U32 count = 0;
+    U32 tombstones = 0;
+    S64 body_bytes = 0;
+    for (U32 i = 0; i < mCapacity; ++i)
+    {
+        Slot& slot = mSlots[i];
+        U32 state = slot.mState.load(std::memory_order_relaxed);
+        switch (slot_kind(state))
+        {
+        case SLOT_LIVE:
+            ++count;
+            body_bytes += slot.mBodySize.load(std::memory_order_relaxed);
+            break;
+        case SLOT_BUSY:
+            // interrupted mid-write: retire it, a tombstone keeps the
+            // probe chains through it intact
+            if (!mReadOnly)
+            {
+                slot.mState.store(next_state(state, SLOT_DELETED), std::memory_order_relaxed);
+            }
+            ++tombstones;
+            break;
+        case SLOT_DELETED:
+            ++tombstones;
+            break;
+        default:
+            break;
+        }
+    }
+    mCount = count;
+    mTombstones = tombstones;
+    mBodyBytes = body_bytes;
+}
+
+//static
+U64 LLTextureCacheIndex::hash(const LLUUID& id)
+{
+    // texture ids are random enough, but spread them over all the bits
+    return id.getDigest64() * 0x9e3779b97f4a7c15ULL;
+}
+
+bool LLTextureCacheIndex::holds(const Slot& slot, const LLUUID& id) const
+{
+    U64 words[2];
+    split_id(id, words);
+    return slot.mID[0].load(std::memory_order_relaxed) == words[0]
+           && slot.mID[1].load(std::memory_order_relaxed) == words[1];
+}
+
+bool LLTextureCacheIndex::read(const Slot& slot, const LLUUID* id, Entry& entry) const
+{
+    for (;;)
+    {
+        const U32 before = slot.mState.load(std::memory_order_acquire);
+        if (slot_kind(before) != SLOT_LIVE)
+        {
+            return false;
+        }
+        U64 words[2];
+        words[0] = slot.mID[0].load(std::memory_order_relaxed);
+        words[1] = slot.mID[1].load(std::memory_order_relaxed);
+        entry.mImageSize = slot.mImageSize.load(std::memory_order_relaxed);
+        entry.mBodySize = slot.mBodySize.load(std::memory_order_relaxed);
+        entry.mTime = slot.mTime.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.mState.load(std::memory_order_relaxed) == before)
+        {
+            memcpy(entry.mID.mData, words, sizeof(words));
+            return !id || entry.mID == *id;
+        }
+        // rewritten while we copied it: try again
+    }
+}
+
+S32 LLTextureCacheIndex::find(const LLUUID& id) const
+{
+    Entry entry;
+    return lookup(id, entry);
+}
+
+S32 LLTextureCacheIndex::lookup(const LLUUID& id, Entry& entry) const
+{
+    if (!mSlots)
+    {
+        return -1;
+    }
+    U32 idx = home(hash(id));
+    for (U32 probes = 0; probes < mCapacity; ++probes)
+    {
+        const Slot& slot = mSlots[idx];
+        const U32 kind = slot_kind(slot.mState.load(std::memory_order_acquire));
+        if (kind == SLOT_EMPTY)
+        {
+            break;
+        }
+        if (kind == SLOT_LIVE && holds(slot, id) && read(slot, &id, entry))
+        {
+            return (S32)idx;
+        }
+        if (++idx == mCapacity)
+        {
+            idx = 0;
+        }
+    }
+    return -1;
+}
+
+S32 LLTextureCacheIndex::findLocked(const LLUUID& id, U64 id_hash) const
+{
+    U32 idx = home(id_hash);
+    for (U32 probes = 0; probes < mCapacity; ++probes)
+    {
+        const Slot& slot = mSlots[idx];
+        const U32 kind = slot_kind(slot.mState.load(std::memory_order_acquire));
+        if (kind == SLOT_EMPTY)
+        {
+            break;
+        }
+        // entries of this id only change under our stripe
+        if (kind == SLOT_LIVE && holds(slot, id))
+        {
+            return (S32)idx;
+        }
+        if (++idx == mCapacity)
+        {
+            idx = 0;
+        }
+    }
+    return -1;
+}
+
+void LLTextureCacheIndex::touch(S32 idx, const LLUUID& id, U32 time)
+{
+    if (!mSlots || mReadOnly || idx < 0 || (U32)idx >= mCapacity)
+    {
+        return;
+    }
+    // A race with an eviction could stamp the slot's next owner instead,
+    // which only makes that one look a little younger.
+    Slot& slot = mSlots[idx];
+    if (holds(slot, id))
+    {
+        slot.mTime.store(time, std::memory_order_relaxed);
+    }
+}
+
+S32 LLTextureCacheIndex::insert(const LLUUID& id, S32 image_size, S32 body_size, U32 time, Entry& entry)
+{
+    if (!mSlots || mReadOnly)
+    {
+        return -1;
+    }
+    const U64 id_hash = hash(id);
+    std::lock_guard<std::mutex> lock(stripe(id_hash));
+
+    S32 found = findLocked(id, id_hash);
+    if (found >= 0)
+    {
+        read(mSlots[found], &id, entry);
+        return found;
+    }
+    // keep probe chains short
+    if (mCount >= mCapacity - mCapacity / 8)
+    {
+        return -1;
+    }
+
+    U64 words[2];
+    split_id(id, words);
+    U32 idx = home(id_hash);
+    for (U32 probes = 0; probes < mCapacity; ++probes)
+    {
+        Slot& slot = mSlots[idx];
+        U32 state = slot.mState.load(std::memory_order_acquire);
+        const U32 kind = slot_kind(state);
+        // writers of other stripes may be claiming slots in this chain too
+        if ((kind == SLOT_EMPTY || kind == SLOT_DELETED)
+            && slot.mState.compare_exchange_strong(state, next_state(state, SLOT_BUSY),
+                                                   std::memory_order_acquire))
+        {
+            slot.mID[0].store(words[0], std::memory_order_relaxed);
+            slot.mID[1].store(words[1], std::memory_order_relaxed);
+            slot.mImageSize.store(image_size, std::memory_order_relaxed);
+            slot.mBodySize.store(body_size, std::memory_order_relaxed);
+            slot.mTime.store(time, std::memory_order_relaxed);
+            slot.mState.store(next_state(next_state(state, SLOT_BUSY), SLOT_LIVE),
+                              std::memory_order_release);
+            ++mCount;
+            if (kind == SLOT_DELETED)
+            {
+                --mTombstones;
+            }
+            mBodyBytes += body_size;
+            entry = Entry(id, image_size, body_size, time);
+            return (S32)idx;
+        }
+        if (++idx == mCapacity)
+        {
+            idx = 0;
+        }
+    }
+    return -1;
+}
+
+bool LLTextureCacheIndex::update(S32 idx, const LLUUID& id, S32 image_size, S32 body_size, U32 time)
+{
+    if (!mSlots || mReadOnly || idx < 0 || (U32)idx >= mCapacity)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(stripe(hash(id)));
+    Slot& slot = mSlots[idx];
+    const U32 state = slot.mState.load(std::memory_order_acquire);
+    if (slot_kind(state) != SLOT_LIVE || !holds(slot, id))
+    {
+        return false;
+    }
+    const S32 old_body_size = slot.mBodySize.load(std::memory_order_relaxed);
+    // busy while the fields change, so readers retry rather than mix them
+    const U32 busy = next_state(state, SLOT_BUSY);
+    slot.mState.store(busy, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.mImageSize.store(image_size, std::memory_order_relaxed);
+    slot.mBodySize.store(body_size, std::memory_order_relaxed);
+    slot.mTime.store(time, std::memory_order_relaxed);
+    slot.mState.store(next_state(busy, SLOT_LIVE), std::memory_order_release);
+    mBodyBytes += body_size - old_body_size;
+    return true;
+}
+
+bool LLTextureCacheIndex::remove(S32 idx, const LLUUID& id, Entry* removed)
+{
+    if (!mSlots || mReadOnly || idx < 0 || (U32)idx >= mCapacity)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(stripe(hash(id)));
+    return removeLocked(idx, id, removed);
+}
+
+bool LLTextureCacheIndex::removeLocked(S32 idx, const LLUUID& id, Entry* removed)
+{
+    Slot& slot = mSlots[idx];
+    Entry entry;
+    if (!read(slot, &id, entry))
+    {
+        return false;
+    }
+    const U32 state = slot.mState.load(std::memory_order_relaxed);
+    slot.mState.store(next_state(state, SLOT_DELETED), std::memory_order_release);
+    --mCount;
+    ++mTombstones;
+    mBodyBytes -= entry.mBodySize;
+    if (removed)
+    {
+        *removed = entry;
+    }
+    return true;
+}
+
+bool LLTextureCacheIndex::evict(Entry& evicted)
+{
+    if (!mSlots || mReadOnly)
+    {
+        return false;
+    }
+    for (U32 window = 0; window < EVICT_MAX_WINDOWS; ++window)
+    {
+        const U32 start = mEvictCursor.fetch_add(EVICT_WINDOW, std::memory_order_relaxed) % mCapacity;
+        S32 oldest = -1;
+        Entry oldest_entry;
+        for (U32 i = 0; i < EVICT_WINDOW; ++i)
+        {
+            const U32 idx = (start + i) % mCapacity;
+            Entry entry;
+            if (read(mSlots[idx], nullptr, entry)
+                && (oldest < 0 || entry.mTime < oldest_entry.mTime))
+            {
+                oldest = (S32)idx;
+                oldest_entry = entry;
+            }
+        }
+        if (oldest >= 0)
+        {
+            std::lock_guard<std::mutex> lock(stripe(hash(oldest_entry.mID)));
+            if (removeLocked(oldest, oldest_entry.mID, &evicted))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void LLTextureCacheIndex::getEntries(slot_entry_vector_t& entries) const
+{
+    entries.clear();
+    if (!mSlots)
+    {
+        return;
+    }
+    entries.reserve(mCount);
+    for (U32 i = 0; i < mCapacity; ++i)
+    {
+        Entry entry;
+        if (read(mSlots[i], nullptr, entry))
+        {
+            entries.emplace_back((S32)i, entry);
+        }
+    }
+}
+
+void LLTextureCacheIndex::clear()
+{
+    if (!mSlots || mReadOnly)
+    {
+        return;
+    }
+    std::vector<std::unique_lock<std::mutex> > locks;
+    locks.reserve(NUM_STRIPES);
+    for (U32 i = 0; i < NUM_STRIPES; ++i)
+    {
+        locks.emplace_back(mStripes[i]);
+    }
+    for (U32 i = 0; i < mCapacity; ++i)
+    {
+        Slot& slot = mSlots[i];
+        const U32 state = slot.mState.load(std::memory_order_relaxed);
+        if (slot_kind(state) != SLOT_EMPTY)
+        {
+            slot.mState.store(next_state(state, SLOT_EMPTY), std::memory_order_release);
+        }
+    }
+    mCount = 0;
+    mTombstones = 0;
+    mBodyBytes = 0;
+}
+
+void LLTextureCacheIndex::compact()
+{
+    if (!mSlots || mReadOnly || mTombstones < mCapacity / 16)
+    {
+        return;
+    }
+    std::vector<std::unique_lock<std::mutex> > locks;
+    locks.reserve(NUM_STRIPES);
+    for (U32 i = 0; i < NUM_STRIPES; ++i)
+    {
+        locks.emplace_back(mStripes[i]);
+    }
+
+    // Walking backwards from an empty slot, a tombstone followed by an empty
+    // slot ends every probe chain through it and can become empty itself.
+    U32 empty = 0;
+    while (empty < mCapacity && slot_kind(mSlots[empty].mState.load(std::memory_order_relaxed)) != SLOT_EMPTY)
+    {
+        ++empty;
+    }
+    if (empty == mCapacity)
+    {
+        return;
+    }
+    U32 reclaimed = 0;
+    bool next_empty = true;
+    U32 idx = empty;
+    for (U32 i = 1; i < mCapacity; ++i)
+    {
+        idx = idx ? idx - 1 : mCapacity - 1;
+        Slot& slot = mSlots[idx];
+        const U32 state = slot.mState.load(std::memory_order_relaxed);
+        const U32 kind = slot_kind(state);
+        if (kind == SLOT_DELETED && next_empty)
+        {
+            slot.mState.store(next_state(state, SLOT_EMPTY), std::memory_order_release);
+            ++reclaimed;
+        }
+        else
+        {
+            next_empty = (kind == SLOT_EMPTY);
+        }
+    }
+    mTombstones -= reclaimed;
+    LL_DEBUGS("TextureCache") << "Reclaimed " << reclaimed << " index tombstones" << LL_ENDL;
+}
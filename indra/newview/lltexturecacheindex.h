@@ -0,0 +1,167 @@
+/**
+ * @file   lltexturecacheindex.h
+ * @date   2026-10-18
+ * @brief  Memory-mapped hash index of the texture cache entries.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTEXTURECACHEINDEX_H
+#define LL_LLTEXTURECACHEINDEX_H
+
+#include "llmappedfile.h"
+#include "lluuid.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * LLTextureCacheIndex keeps the texture cache entries in an open-addressed
+ * hash table that lives in a memory-mapped file, so the cache starts without
+ * reading or validating anything and nothing has to be written back at exit
+ * but a header.
+ *
+ * The slot an entry lands in never changes while it lives: it is the entry's
+ * index into texture.cache and the fast cache. Lookups and time stamps are
+ * lock-free; slots carry a state word with a generation count that readers
+ * check before and after copying an entry out, so they never see a half
+ * written one. Inserts, updates and removals lock one of a set of stripes
+ * chosen by the texture id, so writers of different textures don't contend.
+ *
+ * An entry is written before its slot is published and a slot is retired
+ * before the caller deletes its body, so after a crash the index may hold
+ * at worst entries whose files are short, which the readers already detect.
+ * The counts in the header are only trusted when the index was closed
+ * cleanly; otherwise open() recounts them from the slots.
+ */
+class LLTextureCacheIndex
+{
+public:
+    struct Entry
+    {
+        Entry() :
+            mImageSize(0),
+            mBodySize(0),
+            mTime(0)
+        {
+        }
+        Entry(const LLUUID& id, S32 imagesize, S32 bodysize, U32 time) :
+            mID(id), mImageSize(imagesize), mBodySize(bodysize), mTime(time) {}
+        LLUUID mID;
+        S32 mImageSize; // total size of image if known
+        S32 mBodySize; // size of body file in body cache
+        U32 mTime; // seconds since 1/1/1970
+    };
+    typedef std::vector<std::pair<S32, Entry> > slot_entry_vector_t;
+
+    enum EOpenResult
+    {
+        OPEN_FAILED,
+        OPEN_EXISTING,
+        // the index is new and empty: files it would have described are stale
+        OPEN_CREATED
+    };
+
+    LLTextureCacheIndex();
+    ~LLTextureCacheIndex();
+
+    LLTextureCacheIndex(const LLTextureCacheIndex&) = delete;
+    LLTextureCacheIndex& operator=(const LLTextureCacheIndex&) = delete;
+
+    // Map filename with room for capacity slots. A missing index, or one
+    // made for another capacity or version, is replaced by an empty one,
+    // except when read_only, which only maps a matching existing index.
+    EOpenResult open(const std::string& filename, U32 capacity,
+                     const std::string& version, bool read_only);
+    // Record the counts, mark the index cleanly closed and unmap it.
+    void close();
+    bool isOpen() const { return mSlots != nullptr; }
+    bool isReadOnly() const { return mReadOnly; }
+
+    // Slot holding id, or -1. Lock-free.
+    S32 find(const LLUUID& id) const;
+    // Slot holding id, with its entry copied out, or -1. Lock-free.
+    S32 lookup(const LLUUID& id, Entry& entry) const;
+    // Set the time of slot idx if it still holds id. Lock-free.
+    void touch(S32 idx, const LLUUID& id, U32 time);
+
+    // Add id, or find it if it is already there: entry gets what the slot
+    // holds either way. -1 if the table is full or read only.
+    S32 insert(const LLUUID& id, S32 image_size, S32 body_size, U32 time, Entry& entry);
+    // Set the sizes and time of slot idx if it still holds id.
+    bool update(S32 idx, const LLUUID& id, S32 image_size, S32 body_size, U32 time);
+    // Retire slot idx if it still holds id; removed gets what it held.
+    bool remove(S32 idx, const LLUUID& id, Entry* removed = nullptr);
+    // Remove the least recently used of a window of entries, the window
+    // moving on each call.
+    bool evict(Entry& evicted);
+    // Every entry with its slot, in slot order.
+    void getEntries(slot_entry_vector_t& entries) const;
+    // Remove every entry.
+    void clear();
+    // Turn tombstones that end a probe chain back into empty slots, if
+    // there are enough of them to lengthen lookups. Blocks writers.
+    void compact();
+
+    U32 size() const { return mCount; }
+    U32 getCapacity() const { return mCapacity; }
+    S64 getBodyBytes() const { return mBodyBytes; }
+    U32 getTombstones() const { return mTombstones; }
+
+private:
+    struct Slot
+    {
+        std::atomic<U32> mState;
+        std::atomic<U32> mTime;
+        std::atomic<S32> mImageSize;
+        std::atomic<S32> mBodySize;
+        std::atomic<U64> mID[2];
+    };
+
+    static const U32 NUM_STRIPES = 64;
+
+    static U64 hash(const LLUUID& id);
+    U32 home(U64 hash) const { return (U32)(hash % mCapacity); }
+    std::mutex& stripe(U64 hash) { return mStripes[(hash >> 58) & (NUM_STRIPES - 1)]; }
+    bool holds(const Slot& slot, const LLUUID& id) const;
+    // Copy slot out if it holds id (any id if null), consistently.
+    bool read(const Slot& slot, const LLUUID* id, Entry& entry) const;
+    S32 findLocked(const LLUUID& id, U64 hash) const;
+    bool removeLocked(S32 idx, const LLUUID& id, Entry* removed);
+    void recount();
+    void storeCounts();
+
+    LLMappedFile mFile;
+    Slot* mSlots;
+    U32 mCapacity;
+    bool mReadOnly;
+    std::atomic<U32> mCount;
+    std::atomic<U32> mTombstones;
+    std::atomic<S64> mBodyBytes;
+    std::atomic<U32> mEvictCursor;
+    std::mutex mStripes[NUM_STRIPES];
+};
+
+#endif // LL_LLTEXTURECACHEINDEX_H
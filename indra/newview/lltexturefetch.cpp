@@ -36,6 +36,7 @@
 #include "lldir.h"
 #include "llhttpconstants.h"
 #include "llimage.h"
+#include "llimagedxt.h"
 #include "llimagej2c.h"
 #include "llimageworker.h"
 #include "llworkerthread.h"
@@ -247,6 +248,11 @@ static const S32 HTTP_REQUESTS_RANGE_END_MAX = 20000000;
 static const S32 MAX_CAP_MISSING_RETRIES = 720;
 static const S32 CAP_MISSING_EXPIRATION_DELAY = 1; // seconds
 
+// Decodes of textures with at least this priority (virtual size: what they
+// cover on screen, scaled up near the camera and for boosted textures) go
+// ahead of other decode work.
+static const F32 URGENT_DECODE_PRIORITY = 512.f * 512.f;
+
 //////////////////////////////////////////////////////////////////////////////
 namespace
 {
@@ -352,6 +358,12 @@ private:
         {
         }
 
+        // Threads:  Tid
+        virtual void transcoded(LLImageDXT* image, U32 request_id)
+        {
+            mTranscodedImage = image;
+        }
+
         // Threads:  Tid
         virtual void completed(bool success, const std::string& error_message, LLImageRaw* raw, LLImageRaw* aux, U32 request_id)
         {
@@ -359,12 +371,13 @@ private:
             LLTextureFetchWorker* worker = mFetcher->getWorker(mID);
             if (worker)
             {
-                worker->callbackDecoded(success, error_message, raw, aux, request_id);
+                worker->callbackDecoded(success, error_message, raw, aux, mTranscodedImage, request_id);
             }
         }
     private:
         LLTextureFetch* mFetcher;
         LLUUID mID;
+        LLPointer<LLImageDXT> mTranscodedImage;
     };
 
     struct Compare
@@ -403,7 +416,7 @@ public:
     void callbackCacheWrite(bool success);
 
     // Threads:  Tid
-    void callbackDecoded(bool success, const std::string& error_message, LLImageRaw* raw, LLImageRaw* aux, S32 decode_id);
+    void callbackDecoded(bool success, const std::string& error_message, LLImageRaw* raw, LLImageRaw* aux, LLImageDXT* blocks, S32 decode_id);
 
     // Threads:  T*
     void setGetStatus(LLCore::HttpStatus status, const std::string& reason)
@@ -553,6 +566,7 @@ private:
     LLPointer<LLImageFormatted> mFormattedImage;
     LLPointer<LLImageRaw>       mRawImage,
                                 mAuxImage;
+    LLPointer<LLImageDXT>       mTranscodedImage;           // mRawImage in BCn, if the decode thread made it
     FTType mFTType;
     LLUUID mID;
     LLHost mHost;
@@ -1221,6 +1235,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
         }
         mSkippedStatesTime = 0;
         mRawImage = NULL ;
+        mTranscodedImage = NULL;
         mRequestedDiscard = -1;
         mLoadedDiscard = -1;
         mDecodedDiscard = -1;
@@ -1966,6 +1981,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
         mDecodeTimer.reset();
         mRawImage = NULL;
         mAuxImage = NULL;
+        mTranscodedImage = NULL;
         llassert_always(mFormattedImage.notNull());
 
         // if we have the entire image data (and the image is not J2C), decode the full res image
@@ -1976,13 +1992,29 @@ bool LLTextureFetchWorker::doWork(S32 param)
         LL_DEBUGS(LOG_TXT) << mID << ": Decoding. Bytes: " << mFormattedImage->getDataSize() << " Discard: " << discard
                            << " All Data: " << mHaveAllData << LL_ENDL;
 
+        bool transcode = mFormattedImage->getCodec() == IMG_CODEC_J2C;
+        // The BCn copy only goes beside a cache body we may write, for a
+        // fixed asset id: map tiles and other url textures can change under
+        // the same id and are never cached, so they transcode in memory only.
+        static LLCachedControl<bool> transcode_cache(gSavedSettings, "TextureTranscodeCache", true);
+        std::string transcode_file;
+        if (transcode && transcode_cache && mFTType == FTT_DEFAULT && mWriteToCacheState != NOT_WRITE
+            && !mFetcher->mTextureCache->isReadOnly())
+        {
+            transcode_file = mFetcher->mTextureCache->getTranscodeFileName(mID);
+        }
+
         // In case worked manages to request decode, be shut down,
         // then init and request decode again with first decode
         // still in progress, assign a sufficiently unique id
         mDecodeHandle = LLAppViewer::getImageDecodeThread()->decodeImage(mFormattedImage,
                                                                        discard,
                                                                        mNeedsAux,
-                                                                       new DecodeResponder(mFetcher, mID, this));
+                                                                       new DecodeResponder(mFetcher, mID, this),
+                                                                       mImagePriority >= URGENT_DECODE_PRIORITY ? LL::WorkQueue::PRIORITY_URGENT
+                                                                                                                : LL::WorkQueue::PRIORITY_NORMAL,
+                                                                       transcode,
+                                                                       transcode_file);
         if (mDecodeHandle == 0)
         {
             // Abort, failed to put into queue.
@@ -2025,6 +2057,12 @@ bool LLTextureFetchWorker::doWork(S32 param)
                 llassert_always(mRawImage.notNull());
                 LL_DEBUGS(LOG_TXT) << mID << ": Decoded. Discard: " << mDecodedDiscard
                                    << " Raw Image: " << llformat("%dx%d",mRawImage->getWidth(),mRawImage->getHeight()) << LL_ENDL;
+                // whether fetched or read from the cache, keep the decoded
+                // image so a later visit can skip the decode
+                if (!mInLocalCache)
+                {
+                    mFetcher->mTextureCache->writeToRawCache(mID, mRawImage, mDecodedDiscard);
+                }
                 setState(WRITE_TO_CACHE);
             }
             // fall through
@@ -2561,7 +2599,7 @@ void LLTextureFetchWorker::callbackCacheWrite(bool success)
 //////////////////////////////////////////////////////////////////////////////
 
 // Threads:  Tid
-void LLTextureFetchWorker::callbackDecoded(bool success, const std::string &error_message, LLImageRaw* raw, LLImageRaw* aux, S32 decode_id)
+void LLTextureFetchWorker::callbackDecoded(bool success, const std::string &error_message, LLImageRaw* raw, LLImageRaw* aux, LLImageDXT* blocks, S32 decode_id)
 {
     LLMutexLock lock(&mWorkMutex);                                      // +Mw
     if (mDecodeHandle == 0)
@@ -2590,6 +2628,7 @@ void LLTextureFetchWorker::callbackDecoded(bool success, const std::string &erro
         llassert_always(raw);
         mRawImage = raw;
         mAuxImage = aux;
+        mTranscodedImage = blocks;
         mDecodedDiscard = mFormattedImage->getDiscardLevel();
         if (mDecodedDiscard < mDesiredDiscard)
         {
@@ -3061,6 +3100,7 @@ LLTextureFetchWorker* LLTextureFetch::getWorker(const LLUUID& id)
 // Threads:  T*
 bool LLTextureFetch::getRequestFinished(const LLUUID& id, S32& discard_level, S32& worker_state,
                                         LLPointer<LLImageRaw>& raw, LLPointer<LLImageRaw>& aux,
+                                        LLPointer<LLImageDXT>& blocks,
                                         LLCore::HttpStatus& last_http_get_status)
 {
     LL_PROFILE_ZONE_SCOPED;
@@ -3096,6 +3136,7 @@ bool LLTextureFetch::getRequestFinished(const LLUUID& id, S32& discard_level, S3
             discard_level = worker->mDecodedDiscard;
             raw = worker->mRawImage;
             aux = worker->mAuxImage;
+            blocks = worker->mTranscodedImage;
 
             decode_time = worker->mDecodeTime;
             fetch_time = worker->mFetchTime;
@@ -3141,6 +3182,7 @@ bool LLTextureFetch::getRequestFinished(const LLUUID& id, S32& discard_level, S3
                 discard_level = worker->mDecodedDiscard;
                 raw = worker->mRawImage;
                 aux = worker->mAuxImage;
+                blocks = worker->mTranscodedImage;
             }
             worker->unlockWorkMutex();                                  // -Mw
         }
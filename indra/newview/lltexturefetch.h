@@ -46,6 +46,7 @@
 class LLViewerTexture;
 class LLTextureFetchWorker;
 class LLImageDecodeThread;
+class LLImageDXT;
 class LLHost;
 class LLViewerAssetStats;
 class LLTextureCache;
@@ -103,8 +104,10 @@ public:
 
     // Threads:  T*
     // keep in mind that if fetcher isn't done, it still might need original raw image
+    // blocks is raw compressed to BCn by the decode thread, or NULL.
     bool getRequestFinished(const LLUUID& id, S32& discard_level, S32& worker_state,
                             LLPointer<LLImageRaw>& raw, LLPointer<LLImageRaw>& aux,
+                            LLPointer<LLImageDXT>& blocks,
                             LLCore::HttpStatus& last_http_get_status);
 
     // Threads:  T*
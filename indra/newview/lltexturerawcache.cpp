@@ -0,0 +1,335 @@
+/**
+ * @file   lltexturerawcache.cpp
+ * @date   2026-10-18
+ * @brief  Memory-mapped cache of decoded textures at a few fixed sizes.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "lltexturerawcache.h"
+
+#include "lldir.h"
+#include "llimage.h"
+
+namespace
+{
+    struct RawSlotHeader
+    {
+        S32 mWidth;
+        S32 mHeight;
+        S32 mComponents;
+        S32 mDiscardLevel;
+    };
+    const size_t RAW_SLOT_HEADER_SIZE = sizeof(RawSlotHeader);
+
+    // like the texture cache, keep a quarter of the slots free so probe
+    // chains stay short
+    const F32 RAW_CACHE_INDEX_LOAD = .75f;
+    // levels too small to hold this many images aren't worth a file
+    const U32 RAW_CACHE_MIN_SLOTS = 16;
+
+    bool isPowerOfTwo(U32 value)
+    {
+        return value && !(value & (value - 1));
+    }
+}
+
+LLTextureRawCache::LLTextureRawCache() :
+    mBytes(0),
+    mReadOnly(true)
+{
+}
+
+LLTextureRawCache::~LLTextureRawCache()
+{
+    close();
+}
+
+// Called in the main thread, with no fetches running.
+void LLTextureRawCache::open(const std::string& dirname, const std::vector<U32>& dimensions, S64 max_bytes,
+                             const std::string& version, bool read_only)
+{
+    close();
+    mReadOnly = read_only;
+
+    std::vector<U32> dims;
+    for (U32 dim : dimensions)
+    {
+        if (isPowerOfTwo(dim) && dim <= MAX_IMAGE_SIZE)
+        {
+            dims.push_back(dim);
+        }
+        else
+        {
+            LL_WARNS("TextureCache") << "Ignoring raw cache level " << dim << ", not a power of two" << LL_ENDL;
+        }
+    }
+    std::sort(dims.begin(), dims.end());
+    dims.erase(std::unique(dims.begin(), dims.end()), dims.end());
+    if (dims.empty() || max_bytes <= 0)
+    {
+        return;
+    }
+
+    const S64 level_bytes = max_bytes / (S64)dims.size();
+    for (U32 dim : dims)
+    {
+        std::unique_ptr<Level> level = std::make_unique<Level>();
+        level->mDimension = dim;
+        level->mSlotSize = RAW_SLOT_HEADER_SIZE + (size_t)dim * dim * 4;
+        const U32 capacity = (U32)llmin(level_bytes / (S64)level->mSlotSize, (S64)S32_MAX);
+        if (capacity < RAW_CACHE_MIN_SLOTS)
+        {
+            LL_INFOS("TextureCache") << "Raw cache level " << dim << " doesn't fit in "
+                                     << level_bytes / (1024 * 1024) << " MB, skipped" << LL_ENDL;
+            continue;
+        }
+        level->mMaxEntries = (U32)(capacity * RAW_CACHE_INDEX_LOAD);
+
+        const std::string basename = dirname + gDirUtilp->getDirDelimiter() + llformat("raw%u", dim);
+        // the slot layout depends on the level's size
+        const std::string level_version = llformat("%s/%u", version.c_str(), dim);
+        if (level->mIndex.open(basename + ".index", capacity, level_version, read_only) == LLTextureCacheIndex::OPEN_FAILED)
+        {
+            continue;
+        }
+        const size_t data_size = (size_t)capacity * level->mSlotSize;
+        const std::string data_filename = basename + ".data";
+        const bool mapped = read_only ? level->mData.map(data_filename) && level->mData.size() >= data_size
+                                      : level->mData.mapWritable(data_filename, data_size);
+        if (!mapped)
+        {
+            LL_WARNS("TextureCache") << "Unable to map " << data_filename << LL_ENDL;
+            level->mIndex.close();
+            continue;
+        }
+
+        LL_INFOS("TextureCache") << "Raw cache level " << dim << ": " << level->mIndex.size() << " of "
+                                 << level->mMaxEntries << " images" << LL_ENDL;
+        mBytes += (S64)data_size;
+        mLevels.push_back(std::move(level));
+    }
+}
+
+void LLTextureRawCache::close()
+{
+    for (auto& level : mLevels)
+    {
+        LLMutexLock lock(&level->mMutex);
+        level->mIndex.close();
+        level->mData.unmap();
+    }
+    mLevels.clear();
+    mBytes = 0;
+}
+
+void LLTextureRawCache::clear()
+{
+    for (auto& level : mLevels)
+    {
+        LLMutexLock lock(&level->mMutex);
+        level->mIndex.clear();
+    }
+}
+
+U32 LLTextureRawCache::getEntries() const
+{
+    U32 entries = 0;
+    for (const auto& level : mLevels)
+    {
+        entries += level->mIndex.size();
+    }
+    return entries;
+}
+
+// Called with level's mutex held.
+S32 LLTextureRawCache::getDiscardLevel(Level& level, const LLUUID& id)
+{
+    LLTextureCacheIndex::Entry entry;
+    const S32 idx = level.mIndex.lookup(id, entry);
+    if (idx < 0 || entry.mImageSize <= 0)
+    {
+        return -1; // absent or not written yet
+    }
+    RawSlotHeader head;
+    memcpy(&head, level.mData.data() + (size_t)idx * level.mSlotSize, RAW_SLOT_HEADER_SIZE);
+    return head.mDiscardLevel;
+}
+
+//called in the main thread
+LLPointer<LLImageRaw> LLTextureRawCache::read(const LLUUID& id, S32& discard_level)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    for (auto it = mLevels.rbegin(); it != mLevels.rend(); ++it)
+    {
+        Level& level = **it;
+        LLMutexLock lock(&level.mMutex);
+
+        LLTextureCacheIndex::Entry entry;
+        const S32 idx = level.mIndex.lookup(id, entry);
+        if (idx < 0 || entry.mImageSize <= 0)
+        {
+            continue;
+        }
+        const U8* slot = level.mData.data() + (size_t)idx * level.mSlotSize;
+        RawSlotHeader head;
+        memcpy(&head, slot, RAW_SLOT_HEADER_SIZE);
+        if (head.mWidth <= 0 || head.mWidth > (S32)level.mDimension
+            || head.mHeight <= 0 || head.mHeight > (S32)level.mDimension
+            || head.mComponents <= 0 || head.mComponents > 4
+            || head.mDiscardLevel < 0
+            || head.mWidth * head.mHeight * head.mComponents != entry.mImageSize)
+        {
+            // data file lost or damaged under the index
+            continue;
+        }
+
+        LLPointer<LLImageRaw> raw = new LLImageRaw(head.mWidth, head.mHeight, head.mComponents);
+        if (raw->isBufferInvalid())
+        {
+            return NULL;
+        }
+        memcpy(raw->getData(), slot + RAW_SLOT_HEADER_SIZE, entry.mImageSize);
+        if (!mReadOnly)
+        {
+            level.mIndex.touch(idx, id, (U32)time(NULL));
+        }
+        discard_level = head.mDiscardLevel;
+        return raw;
+    }
+    return NULL;
+}
+
+//called in the fetch thread
+void LLTextureRawCache::write(const LLUUID& id, LLImageRaw* raw, S32 discard_level)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_TEXTURE;
+    if (mReadOnly || mLevels.empty() || !raw || discard_level < 0)
+    {
+        return;
+    }
+
+    LLImageDataSharedLock lock(raw);
+    if (raw->isBufferInvalid() || !raw->getData())
+    {
+        return;
+    }
+    const S32 width = raw->getWidth();
+    const S32 height = raw->getHeight();
+    const S32 components = raw->getComponents();
+    if (width <= 0 || height <= 0 || components <= 0 || components > 4)
+    {
+        return;
+    }
+
+    // Largest level first, so each downscale starts from the previous one.
+    LLPointer<LLImageRaw> scaled;
+    for (auto it = mLevels.rbegin(); it != mLevels.rend(); ++it)
+    {
+        Level& level = **it;
+        const S32 dim = (S32)level.mDimension;
+        S32 shift = 0;
+        while (llmax(width >> shift, height >> shift) > dim)
+        {
+            ++shift;
+        }
+        if (shift == 0 && llmax(width, height) < dim)
+        {
+            // Smaller than the level: only worth keeping if it is the whole
+            // texture, and then only in the smallest level that holds it.
+            auto smaller = std::next(it);
+            if (discard_level != 0
+                || (smaller != mLevels.rend() && llmax(width, height) <= (S32)(*smaller)->mDimension))
+            {
+                continue;
+            }
+        }
+        const S32 level_discard = discard_level + shift;
+        {
+            LLMutexLock level_lock(&level.mMutex);
+            const S32 held = getDiscardLevel(level, id);
+            if (held >= 0 && held <= level_discard)
+            {
+                continue; // as good or better already there
+            }
+        }
+
+        if (shift == 0)
+        {
+            store(level, id, raw, level_discard);
+            continue;
+        }
+        LLImageRaw* source = scaled.notNull() ? scaled.get() : raw;
+        LLPointer<LLImageRaw> copy = new LLImageRaw(source->getData(), source->getWidth(), source->getHeight(), components);
+        if (copy->isBufferInvalid()
+            || !copy->scale(llmax(1, width >> shift), llmax(1, height >> shift)))
+        {
+            return;
+        }
+        scaled = copy;
+        store(level, id, scaled, level_discard);
+    }
+}
+
+void LLTextureRawCache::store(Level& level, const LLUUID& id, LLImageRaw* raw, S32 discard_level)
+{
+    LLMutexLock lock(&level.mMutex);
+
+    const U32 now = (U32)time(NULL);
+    LLTextureCacheIndex::Entry entry;
+    S32 idx = level.mIndex.lookup(id, entry);
+    if (idx >= 0)
+    {
+        if (entry.mImageSize > 0 && getDiscardLevel(level, id) <= discard_level)
+        {
+            return; // written by someone else meanwhile
+        }
+        // unpublish the slot while its pixels change
+        level.mIndex.update(idx, id, 0, 0, now);
+    }
+    else
+    {
+        LLTextureCacheIndex::Entry evicted;
+        while (level.mIndex.size() >= level.mMaxEntries && level.mIndex.evict(evicted))
+        {
+        }
+        idx = level.mIndex.insert(id, 0, 0, now, entry);
+        if (idx < 0)
+        {
+            return;
+        }
+    }
+
+    RawSlotHeader head;
+    head.mWidth = raw->getWidth();
+    head.mHeight = raw->getHeight();
+    head.mComponents = raw->getComponents();
+    head.mDiscardLevel = discard_level;
+    const S32 bytes = head.mWidth * head.mHeight * head.mComponents;
+    U8* slot = level.mData.writableData() + (size_t)idx * level.mSlotSize;
+    memcpy(slot, &head, RAW_SLOT_HEADER_SIZE);
+    memcpy(slot + RAW_SLOT_HEADER_SIZE, raw->getData(), bytes);
+    // published only once the pixels are all there
+    level.mIndex.update(idx, id, bytes, 0, now);
+}
@@ -0,0 +1,106 @@
+/**
+ * @file   lltexturerawcache.h
+ * @date   2026-10-18
+ * @brief  Memory-mapped cache of decoded textures at a few fixed sizes.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTEXTURERAWCACHE_H
+#define LL_LLTEXTURERAWCACHE_H
+
+#include "llmappedfile.h"
+#include "llmutex.h"
+#include "llpointer.h"
+#include "lltexturecacheindex.h"
+#include "lluuid.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class LLImageRaw;
+
+/**
+ * LLTextureRawCache keeps textures already decoded, downscaled to a few
+ * fixed sizes (levels, e.g. 64 and 256 pixels on the longest side), so a
+ * revisited scene can show them without decoding any J2C. It sits between
+ * the 16x16 fast cache and the body cache.
+ *
+ * Each level is a data file of fixed size slots, mapped writable, indexed
+ * by an LLTextureCacheIndex whose slots are the data slots. A level holds
+ * at most its share of the disk budget; once full, writes evict the least
+ * recently used entries. Everything a level does happens under its mutex,
+ * so readers on the main thread and writers on the fetch thread only
+ * contend when they touch the same level.
+ */
+class LLTextureRawCache
+{
+public:
+    LLTextureRawCache();
+    ~LLTextureRawCache();
+
+    LLTextureRawCache(const LLTextureRawCache&) = delete;
+    LLTextureRawCache& operator=(const LLTextureRawCache&) = delete;
+
+    // Open a level for each of dimensions (powers of two) in dirname,
+    // sharing max_bytes between them. Levels whose files can't be mapped
+    // are left out. Existing levels made for another version are emptied.
+    void open(const std::string& dirname, const std::vector<U32>& dimensions, S64 max_bytes,
+              const std::string& version, bool read_only);
+    void close();
+    bool isOpen() const { return !mLevels.empty(); }
+    // Empty every level.
+    void clear();
+
+    // The largest cached image of id, with the discard level it is at,
+    // or NULL.
+    LLPointer<LLImageRaw> read(const LLUUID& id, S32& discard_level);
+    // Store raw, decoded at discard_level, in each level it is big enough
+    // for and not already held at that level or better. Scales a copy;
+    // raw is left alone.
+    void write(const LLUUID& id, LLImageRaw* raw, S32 discard_level);
+
+    S64 getBytes() const { return mBytes; }
+    U32 getEntries() const;
+
+private:
+    struct Level
+    {
+        U32 mDimension;
+        size_t mSlotSize;
+        U32 mMaxEntries;
+        LLTextureCacheIndex mIndex;
+        LLMappedFile mData;
+        LLMutex mMutex;
+    };
+
+    // Discard level id is held at in level, or -1.
+    S32 getDiscardLevel(Level& level, const LLUUID& id);
+    void store(Level& level, const LLUUID& id, LLImageRaw* raw, S32 discard_level);
+
+    std::vector<std::unique_ptr<Level> > mLevels; // smallest first
+    S64 mBytes;
+    bool mReadOnly;
+};
+
+#endif // LL_LLTEXTURERAWCACHE_H
@@ -34,6 +34,7 @@
 #include "llerror.h"
 #include "lllfsthread.h"
 #include "llui.h"
+#include "llimagebufferpool.h"
 #include "llimageworker.h"
 #include "llrender.h"
 
@@ -656,9 +657,16 @@ void LLGLTexMemBar::draw()
     gl_rect_2d(left, top, right, bottom, color);
     // </FS:Beq>
 
-    text = llformat("Images: %d   Raw: %d (%.2f MB)  Saved: %d (%.2f MB) Aux: %d (%.2f MB)", image_count, raw_image_count, raw_image_bytes_MB,
+    const LLImageBufferPool::Stats pool_stats = LLImageBufferPool::getStats();
+    const U64 pool_requests = pool_stats.mReused + pool_stats.mAllocated;
+    text = llformat("Images: %d   Raw: %d (%.2f MB)  Saved: %d (%.2f MB) Aux: %d (%.2f MB) Pool: %.1f/%.0f MB Live: %.1f MB Reuse: %.0f%% Trim: %.0f MB", image_count, raw_image_count, raw_image_bytes_MB,
         saved_raw_image_count, saved_raw_image_bytes_MB,
-        aux_raw_image_count, aux_raw_image_bytes_MB);
+        aux_raw_image_count, aux_raw_image_bytes_MB,
+        pool_stats.mPooledBytes / (1024.0 * 1024.0),
+        LLImageBufferPool::getLimit() / (1024.0 * 1024.0),
+        pool_stats.mLiveBytes / (1024.0 * 1024.0),
+        pool_requests ? pool_stats.mReused * 100.0 / pool_requests : 0.0,
+        pool_stats.mTrimmedBytes / (1024.0 * 1024.0));
     LLFontGL::getFontMonospace()->renderUTF8(text, 0, 0, v_offset + line_height * 7,
         text_color, LLFontGL::LEFT, LLFontGL::TOP);
 
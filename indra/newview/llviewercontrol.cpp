@@ -117,6 +117,9 @@
 #include "llviewerregion.h"
 #include "NACLantispam.h"
 #include "nd/ndlogthrottle.h"
+#include "lldate.h"
+#include "lldir.h"
+#include "lltracecapture.h"
 // <FS:Zi> Run Prio 0 default bento pose in the background to fix splayed hands, open mouths, etc.
 #include "llanimationstates.h"
 
@@ -1106,6 +1109,12 @@ void handleDiskCacheLowWaterPctChanged(const LLSD& newValue)
 }
 // </FS:Beq>
 
+void handleDiskCachePackChanged(const LLSD& newValue)
+{
+    const bool pack = gSavedSettings.getBOOL("DiskCachePackSmallAssets");
+    LLDiskCache::getInstance()->setPackMaxAssetSize(pack ? gSavedSettings.getU32("DiskCachePackMaxAssetSize") : 0);
+}
+
 void handleTargetFPSChanged(const LLSD& newValue)
 {
     const auto targetFPS = gSavedSettings.getU32("TargetFPS");
@@ -1234,6 +1243,23 @@ static bool handleSDL2IMEEnabledChanged(const LLSD& newvalue)
 #endif
 // </FS:Zi>
 
+// <FS> Trace capture
+static void handleTraceCaptureEnabledChanged(const LLSD& newvalue)
+{
+    if (newvalue.asBoolean())
+    {
+        LLTrace::TraceCapture::start(gSavedSettings.getU32("TraceCaptureBufferSize"));
+    }
+    else if (LLTrace::TraceCapture::isRecording())
+    {
+        LLTrace::TraceCapture::stop();
+        const std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS,
+            "trace_" + LLDate::now().toHTTPDateString("%Y%m%d-%H%M%S") + ".json");
+        LLTrace::TraceCapture::writeChromeTrace(filename);
+    }
+}
+// </FS>
+
 ////////////////////////////////////////////////////////////////////////////
 
 LLPointer<LLControlVariable> setting_get_control(LLControlGroup& group, const std::string& setting)
@@ -1540,12 +1566,18 @@ void settings_setup_listeners()
     // <FS:Zi> Run Prio 0 default bento pose in the background to fix splayed hands, open mouths, etc.
     setting_setup_signal_listener(gSavedSettings, "FSPlayDefaultBentoAnimation", handlePlayBentoIdleAnimationChanged);
 
+    // <FS> Trace capture
+    setting_setup_signal_listener(gSavedSettings, "TraceCaptureEnabled", handleTraceCaptureEnabledChanged);
+    // </FS>
+
     // <FS:Ansariel> Better asset cache size control
     setting_setup_signal_listener(gSavedSettings, "FSDiskCacheSize", handleDiskCacheSizeChanged);
     // <FS:Beq> Better asset cache purge control
     setting_setup_signal_listener(gSavedSettings, "FSDiskCacheHighWaterPercent", handleDiskCacheHighWaterPctChanged);
     setting_setup_signal_listener(gSavedSettings, "FSDiskCacheLowWaterPercent", handleDiskCacheLowWaterPctChanged);
     // </FS:Beq>
+    setting_setup_signal_listener(gSavedSettings, "DiskCachePackSmallAssets", handleDiskCachePackChanged);
+    setting_setup_signal_listener(gSavedSettings, "DiskCachePackMaxAssetSize", handleDiskCachePackChanged);
 
     // <FS:Zi> Handle IME text input getting enabled or disabled
 #if LL_SDL2
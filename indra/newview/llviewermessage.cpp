@@ -44,6 +44,7 @@
 #include "llsd.h"
 #include "llsdserialize.h"
 #include "llteleportflags.h"
+#include "llteleportwarmup.h"
 #include "lltoastnotifypanel.h"
 #include "lltransactionflags.h"
 #include "llfilesystem.h"
@@ -3385,6 +3386,13 @@ void process_teleport_start(LLMessageSystem *msg, void**)
 
         LL_INFOS("Messaging") << "Teleport initiated by remote TeleportStart message with TeleportFlags: " <<  teleport_flags << LL_ENDL;
 
+        // the only destination a remote teleport makes known up front
+        LLVector3d home_pos_global;
+        if ((teleport_flags & TELEPORT_FLAGS_VIA_HOME) && gAgent.getHomePosGlobal(&home_pos_global))
+        {
+            LLTeleportWarmup::instance().start(to_region_handle(home_pos_global));
+        }
+
         // Don't call LLFirstUse::useTeleport here because this could be
         // due to being killed, which would send you home, not to a Telehub
     }
@@ -3588,6 +3596,8 @@ void process_teleport_finish(LLMessageSystem* msg, void**)
     msg->getU64Fast(_PREHASH_Info, _PREHASH_RegionHandle, region_handle);
     U32 teleport_flags;
     msg->getU32Fast(_PREHASH_Info, _PREHASH_TeleportFlags, teleport_flags);
+    // lures only tell us where we're going now
+    LLTeleportWarmup::instance().start(region_handle);
 
 // <FS:CR> Aurora Sim
     U32 region_size_x = 256;
@@ -29,7 +29,9 @@
 #include "llviewerobjectlist.h"
 
 #include "message.h"
+#include "llcachestats.h"
 #include "llfasttimer.h"
+#include "llframearena.h"
 #include "llrender.h"
 #include "llwindow.h"       // decBusyCount()
 
@@ -348,6 +350,7 @@ LLViewerObject* LLViewerObjectList::processObjectUpdateFromCache(LLVOCacheEntry*
 
     // Cache Hit.
     record(LLStatViewer::OBJECT_CACHE_HIT_RATE, LLUnits::Ratio::fromValue(1));
+    LLCacheStats::hit(LLCacheStats::OBJECT);
 
     cached_dpp->reset();
     cached_dpp->unpackUUID(fullid, "ID");
@@ -1033,9 +1036,9 @@ void LLViewerObjectList::update(LLAgent &agent)
     LLViewerObject *objectp = NULL;
 
     // Make a copy of the list in case something in idleUpdate() messes with it
-    static std::vector<LLViewerObject*> idle_list;
+    LLFrameVector<LLViewerObject*> idle_list;
+    idle_list.reserve(mActiveObjects.size());
 
-    U32 idle_count = 0;
     mNumAvatars = 0;
 
     {
@@ -1045,15 +1048,7 @@ void LLViewerObjectList::update(LLAgent &agent)
             objectp = *active_iter;
             if (objectp)
             {
-                if (idle_count >= idle_list.size())
-                {
-                    idle_list.push_back( objectp );
-                }
-                else
-                {
-                    idle_list[idle_count] = objectp;
-                }
-                ++idle_count;
+                idle_list.push_back( objectp );
                 if (objectp->isAvatar())
                 {
                     mNumAvatars++;
@@ -1067,16 +1062,14 @@ void LLViewerObjectList::update(LLAgent &agent)
         }
     }
 
-    std::vector<LLViewerObject*>::iterator idle_end = idle_list.begin()+idle_count;
-
     // <FS:Ansariel> Speed up debug settings
     //if (gSavedSettings.getBOOL("FreezeTime"))
     if (freezeTime)
     // </FS:Ansariel> Speed up debug settings
     {
 
-        for (std::vector<LLViewerObject*>::iterator iter = idle_list.begin();
-            iter != idle_end; iter++)
+        for (LLFrameVector<LLViewerObject*>::iterator iter = idle_list.begin();
+            iter != idle_list.end(); iter++)
         {
             objectp = *iter;
             if (objectp->isAvatar())
@@ -1087,8 +1080,8 @@ void LLViewerObjectList::update(LLAgent &agent)
     }
     else
     {
-        for (std::vector<LLViewerObject*>::iterator idle_iter = idle_list.begin();
-            idle_iter != idle_end; idle_iter++)
+        for (LLFrameVector<LLViewerObject*>::iterator idle_iter = idle_list.begin();
+            idle_iter != idle_list.end(); idle_iter++)
         {
             objectp = *idle_iter;
             llassert(objectp->isActive());
@@ -1170,7 +1163,7 @@ void LLViewerObjectList::update(LLAgent &agent)
     */
 
     sample(LLStatViewer::NUM_OBJECTS, mObjects.size());
-    sample(LLStatViewer::NUM_ACTIVE_OBJECTS, idle_count);
+    sample(LLStatViewer::NUM_ACTIVE_OBJECTS, idle_list.size());
 }
 
 void LLViewerObjectList::fetchObjectCosts()
@@ -32,6 +32,7 @@
 #include "indra_constants.h"
 #include "llaisapi.h"
 #include "llavatarnamecache.h"      // name lookup cap url
+#include "llcachestats.h"
 #include "llfloaterreg.h"
 #include "llmath.h"
 #include "llregionflags.h"
@@ -60,6 +61,7 @@
 #include "llregioninfomodel.h"
 #include "llsdutil.h"
 #include "llstartup.h"
+#include "llteleportwarmup.h"
 #include "lltrans.h"
 #include "llurldispatcher.h"
 #include "llviewerobjectlist.h"
@@ -219,7 +221,8 @@ public:
     // Misc
     LLVLComposition *mCompositionp;     // Composition layer for the surface
 
-    LLVOCacheEntry::vocache_entry_map_t   mCacheMap; //all cached entries
+    LLVOCacheEntry::vocache_entry_map_t   mCacheMap; //all cached entries read so far
+    LLVOCacheFile                         mCacheFile; //the region's cache file, entries are read from it on demand
     LLVOCacheEntry::vocache_entry_set_t   mActiveSet; //all active entries;
     LLVOCacheEntry::vocache_entry_set_t   mWaitingSet; //entries waiting for LLDrawable to be generated.
     std::set< LLPointer<LLViewerOctreeGroup> >      mVisibleGroups; //visible groupa
@@ -781,6 +784,10 @@ LLViewerRegion::~LLViewerRegion()
     disconnectAllNeighbors();
     LLViewerPartSim::getInstance()->cleanupRegion(this);
 
+    // remembered for warming the caches on a later teleport here
+    uuid_vec_t texture_ids;
+    LLTeleportWarmup::collectTextures(this, texture_ids);
+
     {
         LL_RECORD_BLOCK_TIME(FTM_CLEANUP_REGION_OBJECTS);
         gObjectList.killObjects(this);
@@ -798,6 +805,10 @@ LLViewerRegion::~LLViewerRegion()
     {
         LL_RECORD_BLOCK_TIME(FTM_SAVE_REGION_CACHE);
         saveObjectCache();
+        if (!texture_ids.empty() && LLVOCache::instanceExists())
+        {
+            LLVOCache::instance().writeTexturesToCache(mHandle, texture_ids);
+        }
     }
 
     delete mImpl;
@@ -845,10 +856,10 @@ void LLViewerRegion::loadObjectCache()
     {
         LLVOCache & vocache = LLVOCache::instance();
         // Without this a "corrupted" vocache persists until a cache clear or other rewrite. Mark as dirty hereif read fails to force a rewrite.
-        mCacheDirty = !vocache.readFromCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap);
-        vocache.readGenericExtrasFromCache(mHandle, mImpl->mCacheID, mImpl->mGLTFOverridesLLSD, mImpl->mCacheMap);
+        mCacheDirty = !vocache.readFromCache(mHandle, mImpl->mCacheID, mImpl->mCacheFile);
+        vocache.readGenericExtrasFromCache(mHandle, mImpl->mCacheID, mImpl->mGLTFOverridesLLSD, mImpl->mCacheFile);
 
-        if (mImpl->mCacheMap.empty())
+        if (mImpl->mCacheFile.size() == 0)
         {
             mCacheDirty = true;
         }
@@ -863,7 +874,7 @@ void LLViewerRegion::saveObjectCache()
         return;
     }
 
-    if (mImpl->mCacheMap.empty())
+    if (mImpl->mCacheMap.empty() && mImpl->mCacheFile.size() == 0)
     {
         return;
     }
@@ -875,11 +886,12 @@ void LLViewerRegion::saveObjectCache()
 
         LLVOCache & instance = LLVOCache::instance();
 
-        instance.writeToCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap, mCacheDirty, removal_enabled);
+        instance.writeToCache(mHandle, mImpl->mCacheID, mImpl->mCacheMap, mImpl->mCacheFile, mCacheDirty, removal_enabled);
         instance.writeGenericExtrasToCache(mHandle, mImpl->mCacheID, mImpl->mGLTFOverridesLLSD, mCacheDirty, removal_enabled);
         mCacheDirty = false;
     }
 
+    mImpl->mCacheFile.close();
     if (LLAppViewer::instance()->isQuitting())
     {
         mImpl->mCacheMap.clear();
@@ -1853,7 +1865,7 @@ void LLViewerRegion::killInvisibleObjects(F32 max_time)
         max_update /= 2;
     }
 
-    std::vector<LLDrawable*> delete_list;
+    LLFrameVector<LLDrawable*> delete_list;
     auto update_counter = llmin(max_update, mImpl->mActiveSet.size());
     LLVOCacheEntry::vocache_entry_set_t::iterator iter = mImpl->mActiveSet.upper_bound(mLastVisitedEntry);
 
@@ -1904,7 +1916,7 @@ void LLViewerRegion::killInvisibleObjects(F32 max_time)
 #endif
 }
 
-void LLViewerRegion::killObject(LLVOCacheEntry* entry, std::vector<LLDrawable*>& delete_list)
+void LLViewerRegion::killObject(LLVOCacheEntry* entry, LLFrameVector<LLDrawable*>& delete_list)
 {
     //kill the object.
     LLDrawable* drawablep = (LLDrawable*)entry->getEntry()->getDrawable();
@@ -2964,6 +2976,7 @@ LLViewerRegion::eCacheUpdateResult LLViewerRegion::cacheFullUpdate(LLDataPackerB
         result = CACHE_UPDATE_ADDED;
         entry = new LLVOCacheEntry(local_id, crc, dp);
         record(LLStatViewer::OBJECT_CACHE_HIT_RATE, LLUnits::Ratio::fromValue(0));
+        LLCacheStats::miss(LLCacheStats::OBJECT);
 
         mImpl->mCacheMap[local_id] = entry;
 
@@ -3010,12 +3023,24 @@ LLVOCacheEntry* LLViewerRegion::getCacheEntryForOctree(U32 local_id)
 LLVOCacheEntry* LLViewerRegion::getCacheEntry(U32 local_id, bool valid)
 {
     LLVOCacheEntry::vocache_entry_map_t::iterator iter = mImpl->mCacheMap.find(local_id);
-    if(iter != mImpl->mCacheMap.end())
+    if(iter == mImpl->mCacheMap.end())
     {
-        if(!valid || iter->second->isValid())
+        //read it out of the cache file the first time it is asked for;
+        //entries in the file haven't been probed yet, so aren't valid.
+        if(valid)
+        {
+            return NULL;
+        }
+        LLPointer<LLVOCacheEntry> entry = mImpl->mCacheFile.createEntry(local_id);
+        if(entry.isNull())
         {
-            return iter->second;
+            return NULL;
         }
+        iter = mImpl->mCacheMap.emplace(local_id, entry).first;
+    }
+    if(!valid || iter->second->isValid())
+    {
+        return iter->second;
     }
     return NULL;
 }
@@ -3230,9 +3255,15 @@ void LLViewerRegion::dumpCache()
 
 void LLViewerRegion::clearVOCacheFromMemory()
 {
+    mImpl->mCacheFile.close();
     mImpl->mCacheMap.clear();
 }
 
+void LLViewerRegion::closeVOCacheFile()
+{
+    mImpl->mCacheFile.close();
+}
+
 void LLViewerRegion::unpackRegionHandshake()
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
@@ -3438,7 +3469,7 @@ void LLViewerRegion::unpackRegionHandshake()
     {
         flags |= 0x00000001; //set the bit 0 to be 1 to ask sim to send all cacheable objects.
     }
-    if(mImpl->mCacheMap.empty())
+    if(mImpl->mCacheMap.empty() && mImpl->mCacheFile.size() == 0)
     {
         flags |= 0x00000002; //set the bit 1 to be 1 to tell sim the cache file is empty, no need to send cache probes.
     }
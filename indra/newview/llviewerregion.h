@@ -41,6 +41,7 @@
 #include "llweb.h"
 #include "llcapabilityprovider.h"
 #include "m4math.h"                 // LLMatrix4
+#include "llframearena.h"
 #include "llframetimer.h"
 #include "llreflectionmap.h"
 #include "llpointer.h"
@@ -418,6 +419,8 @@ public:
     void clearCachedVisibleObjects();
     void dumpCache();
     void clearVOCacheFromMemory();
+    //unmap the object cache file, so the cache can delete it; entries already read are kept.
+    void closeVOCacheFile();
     void unpackRegionHandshake();
 
     void calculateCenterGlobal();
@@ -465,7 +468,7 @@ public:
 private:
     void addToVOCacheTree(LLVOCacheEntry* entry);
     LLViewerObject* addNewObject(LLVOCacheEntry* entry);
-    void killObject(LLVOCacheEntry* entry, std::vector<LLDrawable*>& delete_list); //adds entry into list if it is safe to move into cache
+    void killObject(LLVOCacheEntry* entry, LLFrameVector<LLDrawable*>& delete_list); //adds entry into list if it is safe to move into cache
     void removeFromVOCacheTree(LLVOCacheEntry* entry);
     void killCacheEntry(LLVOCacheEntry* entry, bool for_rendering = false); //physically delete the cache entry
     void killInvisibleObjects(F32 max_time);
@@ -66,6 +66,7 @@
 #include "llinventorymodel.h"
 #include "lluiusage.h"
 #include "lltranslate.h"
+#include "workqueue.h"
 
 // "Minimal Vulkan" to get max API Version
 
@@ -246,6 +247,28 @@ LLTrace::EventStatHandle<F64Seconds >   AVATAR_EDIT_TIME("avataredittime", "Seco
 
 LLTrace::EventStatHandle<LLUnit<F32, LLUnits::Percent> > OBJECT_CACHE_HIT_RATE("object_cache_hits");
 
+static std::string cache_stat_name(LLCacheStats::ETier tier, const char* figure)
+{
+    return llformat("cache_%s_%s", LLCacheStats::getName(tier), figure);
+}
+
+CacheTierStats::CacheTierStats(LLCacheStats::ETier tier)
+:   mHitRate(cache_stat_name(tier, "hit_rate").c_str()),
+    mHits(cache_stat_name(tier, "hits").c_str()),
+    mMisses(cache_stat_name(tier, "misses").c_str()),
+    mEvictions(cache_stat_name(tier, "evictions").c_str()),
+    mRead(cache_stat_name(tier, "read").c_str()),
+    mWritten(cache_stat_name(tier, "written").c_str()),
+    mReadLatency(cache_stat_name(tier, "read_latency").c_str())
+{}
+
+CacheTierStats CACHE_TIERS[LLCacheStats::NUM_TIERS] = { LLCacheStats::TEXTURE_HEADER,
+                                                        LLCacheStats::TEXTURE_BODY,
+                                                        LLCacheStats::TEXTURE_FAST,
+                                                        LLCacheStats::OBJECT,
+                                                        LLCacheStats::ASSET,
+                                                        LLCacheStats::MESH };
+
 LLTrace::EventStatHandle<F64Seconds >   TEXTURE_FETCH_TIME("texture_fetch_time");
 
 LLTrace::SampleStatHandle<LLUnit<F32, LLUnits::Percent> >  SCENERY_FRAME_PCT("scenery_frame_pct");
@@ -322,6 +345,44 @@ U32Bytes            gTotalTextureBytesPerBoostLevel[LLViewerTexture::MAX_GL_IMAG
 extern U32  gVisCompared;
 extern U32  gVisTested;
 
+// The caches count from whatever thread they run on; LLTrace only takes
+// records on threads with a recorder, so the main thread passes them on.
+static void update_cache_statistics()
+{
+    static LLCacheStats::Counts last_counts[LLCacheStats::NUM_TIERS];
+    for (S32 i = 0; i < LLCacheStats::NUM_TIERS; ++i)
+    {
+        const LLCacheStats::ETier tier = (LLCacheStats::ETier)i;
+        const LLCacheStats::Counts counts = LLCacheStats::get(tier);
+        const LLCacheStats::Counts frame = counts - last_counts[i];
+        last_counts[i] = counts;
+
+        LLStatViewer::CacheTierStats& stats = LLStatViewer::CACHE_TIERS[i];
+        if (frame.mHits + frame.mMisses)
+        {
+            add(stats.mHits, (F64)frame.mHits);
+            add(stats.mMisses, (F64)frame.mMisses);
+            record(stats.mHitRate, LLUnits::Ratio::fromValue(frame.getHitRate()));
+        }
+        if (frame.mBytesRead)
+        {
+            add(stats.mRead, F64Bytes((F64)frame.mBytesRead));
+        }
+        if (frame.mBytesWritten)
+        {
+            add(stats.mWritten, F64Bytes((F64)frame.mBytesWritten));
+        }
+        if (frame.mEvictions)
+        {
+            add(stats.mEvictions, (F64)frame.mEvictions);
+        }
+        if (frame.mReads)
+        {
+            sample(stats.mReadLatency, F64Milliseconds(frame.getMeanLatencyMs()));
+        }
+    }
+}
+
 void update_statistics()
 {
     LL_PROFILE_ZONE_SCOPED;
@@ -379,6 +440,9 @@ void update_statistics()
     }
     add(LLStatViewer::FPS, 1);
 
+    update_cache_statistics();
+    LL::WorkQueueBase::sampleDepthStats();
+
     F64Bits layer_bits = gVLManager.getLandBits() + gVLManager.getWindBits() + gVLManager.getCloudBits();
     add(LLStatViewer::LAYERS_NETWORK_DATA_RECEIVED, layer_bits);
     add(LLStatViewer::OBJECT_NETWORK_DATA_RECEIVED, gObjectData);
@@ -27,6 +27,7 @@
 #ifndef LL_LLVIEWERSTATS_H
 #define LL_LLVIEWERSTATS_H
 
+#include "llcachestats.h"
 #include "lltextureinfo.h"
 #include "lltracerecording.h"
 #include "lltrace.h"
@@ -234,6 +235,23 @@ extern LLTrace::EventStatHandle<F64Seconds >    AVATAR_EDIT_TIME,
 
 extern LLTrace::EventStatHandle<LLUnit<F32, LLUnits::Percent> > OBJECT_CACHE_HIT_RATE;
 
+// The LLCacheStats figures of one cache tier, as "cache_<tier>_hit_rate" and
+// so on. update_statistics() brings in what the caches recorded each frame.
+struct CacheTierStats
+{
+    CacheTierStats(LLCacheStats::ETier tier);
+
+    LLTrace::EventStatHandle<LLUnit<F32, LLUnits::Percent> > mHitRate;
+    LLTrace::CountStatHandle<>                  mHits,
+                                                mMisses,
+                                                mEvictions;
+    LLTrace::CountStatHandle<F64Kilobytes>      mRead,
+                                                mWritten;
+    LLTrace::SampleStatHandle<F64Milliseconds>  mReadLatency;
+};
+
+extern CacheTierStats CACHE_TIERS[LLCacheStats::NUM_TIERS];
+
 }
 
 class LLViewerStats : public LLSingleton<LLViewerStats>
@@ -73,11 +73,20 @@ void LLViewerStatsRecorder::clearStats()
     mTextureFetchCount = 0;
     mMeshLoadedCount = 0;
     mObjectKills = 0;
+    for (S32 i = 0; i < LLCacheStats::NUM_TIERS; ++i)
+    {
+        mCacheCounts[i] = LLCacheStats::get((LLCacheStats::ETier)i);
+    }
 }
 
 
 void LLViewerStatsRecorder::enableObjectStatsRecording(bool enable, bool logging /* false */)
 {
+    if (enable && !mEnableStatsRecording)
+    {
+        // the cache figures run all the time: start from now
+        clearStats();
+    }
     mEnableStatsRecording = enable;
 
     // if logging is stopping, close the file
@@ -160,6 +169,11 @@ void LLViewerStatsRecorder::writeToLog( F32 interval )
         S32 total_events = mObjectCacheHitCount + mObjectCacheMissCrcCount + mObjectCacheMissFullCount + mObjectFullUpdates +
                             mObjectTerseUpdates + mObjectCacheMissRequests + mObjectCacheUpdateDupes +
                             mObjectCacheUpdateChanges + mObjectCacheUpdateAdds + mObjectCacheUpdateReplacements + mObjectUpdateFailures;
+        for (S32 i = 0; i < LLCacheStats::NUM_TIERS; ++i)
+        {
+            const LLCacheStats::Counts counts = LLCacheStats::get((LLCacheStats::ETier)i) - mCacheCounts[i];
+            total_events += (S32)(counts.mHits + counts.mMisses);
+        }
         if (total_events == 0)
         {
             LL_DEBUGS("ILXZeroData") << "ILX: not saving zero data" << LL_ENDL;
@@ -220,8 +234,24 @@ void LLViewerStatsRecorder::writeToLog( F32 interval )
                     << "Update Failures,"
                     << "Texture Count,"
                     << "Mesh Load Count,"
-                    << "Object Kills"
-                    << "\n";
+                    << "Object Kills";
+            // then the same figures for each cache tier
+            for (S32 i = 0; i < LLCacheStats::NUM_TIERS; ++i)
+            {
+                const char* tier = LLCacheStats::getLabel((LLCacheStats::ETier)i);
+                col_headers << "," << tier << " Hits"
+                            << "," << tier << " Misses"
+                            << "," << tier << " Bytes Read"
+                            << "," << tier << " Bytes Written"
+                            << "," << tier << " Evictions"
+                            << "," << tier << " Read Time (ms)";
+                for (S32 bucket = 0; bucket < LLCacheStats::NUM_LATENCY_BUCKETS - 1; ++bucket)
+                {
+                    col_headers << "," << tier << " Reads <= " << LLCacheStats::LATENCY_BUCKET_MS[bucket] << "ms";
+                }
+                col_headers << "," << tier << " Reads > " << LLCacheStats::LATENCY_BUCKET_MS[LLCacheStats::NUM_LATENCY_BUCKETS - 2] << "ms";
+            }
+            col_headers << "\n";
 
             data_size = col_headers.str().size();
             if (fwrite(col_headers.str().c_str(), 1, data_size, mStatsFile ) != data_size)
@@ -258,8 +288,22 @@ void LLViewerStatsRecorder::writeToLog( F32 interval )
         << "," << mObjectUpdateFailures
         << "," << mTextureFetchCount
         << "," << mMeshLoadedCount
-        << "," << mObjectKills
-        << "\n";
+        << "," << mObjectKills;
+    for (S32 i = 0; i < LLCacheStats::NUM_TIERS; ++i)
+    {
+        const LLCacheStats::Counts counts = LLCacheStats::get((LLCacheStats::ETier)i) - mCacheCounts[i];
+        stats_data << "," << counts.mHits
+            << "," << counts.mMisses
+            << "," << counts.mBytesRead
+            << "," << counts.mBytesWritten
+            << "," << counts.mEvictions
+            << "," << (F32)counts.mReadMicros / 1000.f;
+        for (S32 bucket = 0; bucket < LLCacheStats::NUM_LATENCY_BUCKETS; ++bucket)
+        {
+            stats_data << "," << counts.mLatency[bucket];
+        }
+    }
+    stats_data << "\n";
 
     data_size = stats_data.str().size();
     if ( data_size != fwrite(stats_data.str().c_str(), 1, data_size, mStatsFile ))
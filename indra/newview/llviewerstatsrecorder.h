@@ -31,6 +31,7 @@
 // This is a diagnostic class used to record information from the viewer
 // for analysis.
 
+#include "llcachestats.h"
 #include "llframetimer.h"
 #include "llviewerobject.h"
 #include "llviewerregion.h"
@@ -167,6 +168,10 @@ private:
     S32         mMeshLoadedCount;
     S32         mObjectKills;
 
+    // LLCacheStats running totals at the last clearStats(): each row gets
+    // the difference
+    LLCacheStats::Counts mCacheCounts[LLCacheStats::NUM_TIERS];
+
     void    clearStats();
 };
 
@@ -37,6 +37,8 @@
 #include "llhost.h"
 #include "llimage.h"
 #include "llimagebmp.h"
+#include "llimagebufferpool.h"
+#include "llimagedxt.h"
 #include "llimagej2c.h"
 #include "llimagetga.h"
 #include "llstl.h"
@@ -561,6 +563,12 @@ void LLViewerTexture::updateClass()
         }
     }
 
+    if (is_sys_low)
+    {
+        // idle image buffers are the cheapest memory to give back
+        LLImageBufferPool::trim();
+    }
+
     was_low = is_low;
     was_sys_low = is_sys_low;
 
@@ -1275,6 +1283,7 @@ void LLViewerFetchedTexture::loadFromFastCache()
 
     LLTimer fastCacheTimer;
     mRawImage = LLAppViewer::getTextureCache()->readFromFastCache(getID(), mRawDiscardLevel);
+    mTranscodedImage = nullptr;
     if(mRawImage.notNull())
     {
         F32 cachReadTime = fastCacheTimer.getElapsedTimeF32();
@@ -1613,7 +1622,9 @@ bool LLViewerFetchedTexture::createTexture(S32 usename/*= 0*/)
         return false;
     }
 
-    bool res = mGLTexturep->createGLTexture(mRawDiscardLevel, mRawImage, usename, true, mBoostLevel);
+    bool res = mTranscodedImage.notNull()
+        ? mGLTexturep->createGLTexture(mRawDiscardLevel, mRawImage, mTranscodedImage, usename, mBoostLevel)
+        : mGLTexturep->createGLTexture(mRawDiscardLevel, mRawImage, usename, true, mBoostLevel);
 
     return res;
 }
@@ -2107,7 +2118,7 @@ bool LLViewerFetchedTexture::updateFetch()
         if (mAuxRawImage.notNull()) sAuxCount--;
         // keep in mind that fetcher still might need raw image, don't modify original
         bool finished = LLAppViewer::getTextureFetch()->getRequestFinished(getID(), fetch_discard, mFetchState, mRawImage, mAuxRawImage,
-                                                                           mLastHttpGetStatus);
+                                                                           mTranscodedImage, mLastHttpGetStatus);
         if (mRawImage.notNull()) sRawCount++;
         if (mAuxRawImage.notNull())
         {
@@ -2832,6 +2843,7 @@ void LLViewerFetchedTexture::destroyRawImage()
         }
 
         mRawImage = nullptr;
+        mTranscodedImage = nullptr;
 
         mIsRawImageValid = false;
         mRawDiscardLevel = INVALID_DISCARD_LEVEL;
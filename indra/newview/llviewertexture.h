@@ -47,6 +47,7 @@ constexpr F32 MIN_VRAM_BUDGET = 768.f; // <FS:Ansariel> Expose max texture VRAM
 
 class LLFace;
 class LLImageGL ;
+class LLImageDXT;
 class LLImageRaw;
 class LLViewerObject;
 class LLViewerTexture;
@@ -514,6 +515,9 @@ protected:
 
     LLPointer<LLImageRaw> mRawImage;
     S32 mRawDiscardLevel = -1;
+    // mRawImage compressed to BCn by the decode thread, uploaded in its
+    // place when it still matches
+    LLPointer<LLImageDXT> mTranscodedImage;
 
     // Used ONLY for cloth meshes right now.  Make SURE you know what you're
     // doing if you use it for anything else! - djs
@@ -26,6 +26,7 @@
 
 #include "llviewerprecompiledheaders.h"
 #include "llvocache.h"
+#include "llcachestats.h"
 #include "llregionhandle.h"
 #include "llviewercontrol.h"
 #include "llviewerobjectlist.h"
@@ -44,7 +45,6 @@ F32 LLVOCacheEntry::sFrontPixelThreshold = 1.0f;
 F32 LLVOCacheEntry::sRearPixelThreshold = 1.0f;
 bool LLVOCachePartition::sNeedsOcclusionCheck = false;
 
-const S32 ENTRY_HEADER_SIZE = 6 * sizeof(S32);
 const S32 MAX_ENTRY_BODY_SIZE = 10000;
 
 bool check_read(LLAPRFile* apr_file, void* src, S32 n_bytes)
@@ -165,6 +165,7 @@ LLVOCacheEntry::LLVOCacheEntry(U32 local_id, U32 crc, LLDataPackerBinaryBuffer &
     mHitCount(0),
     mDupeCount(0),
     mCRCChangeCount(0),
+    mFileOffset(-1),
     mState(INACTIVE),
     mSceneContrib(0.f),
     mValid(true),
@@ -185,6 +186,7 @@ LLVOCacheEntry::LLVOCacheEntry()
     mDupeCount(0),
     mCRCChangeCount(0),
     mBuffer(NULL),
+    mFileOffset(-1),
     mState(INACTIVE),
     mSceneContrib(0.f),
     mValid(true),
@@ -194,73 +196,6 @@ LLVOCacheEntry::LLVOCacheEntry()
     mDP.assignBuffer(mBuffer, 0);
 }
 
-LLVOCacheEntry::LLVOCacheEntry(LLAPRFile* apr_file)
-:   LLViewerOctreeEntryData(LLViewerOctreeEntry::LLVOCACHEENTRY),
-    mBuffer(NULL),
-    mUpdateFlags(-1),
-    mState(INACTIVE),
-    mSceneContrib(0.f),
-    mValid(false),
-    mParentID(0),
-    mBSphereRadius(-1.0f)
-{
-    S32 size = -1;
-    bool success;
-    static U8 data_buffer[ENTRY_HEADER_SIZE];
-
-    mDP.assignBuffer(mBuffer, 0);
-
-    success = check_read(apr_file, (void *)data_buffer, ENTRY_HEADER_SIZE);
-    if (success)
-    {
-        memcpy(&mLocalID, data_buffer, sizeof(U32));
-        memcpy(&mCRC, data_buffer + sizeof(U32), sizeof(U32));
-        memcpy(&mHitCount, data_buffer + (2 * sizeof(U32)), sizeof(S32));
-        memcpy(&mDupeCount, data_buffer + (3 * sizeof(U32)), sizeof(S32));
-        memcpy(&mCRCChangeCount, data_buffer + (4 * sizeof(U32)), sizeof(S32));
-        memcpy(&size, data_buffer + (5 * sizeof(U32)), sizeof(S32));
-
-        // Corruption in the cache entries
-        if ((size > MAX_ENTRY_BODY_SIZE) || (size < 1))
-        {
-            // We've got a bogus size, skip reading it.
-            // We won't bother seeking, because the rest of this file
-            // is likely bogus, and will be tossed anyway.
-            LL_WARNS() << "Bogus cache entry, size " << size << ", aborting!" << LL_ENDL;
-            success = false;
-        }
-    }
-    if(success && size > 0)
-    {
-        mBuffer = new U8[size];
-        success = check_read(apr_file, mBuffer, size);
-
-        if(success)
-        {
-            mDP.assignBuffer(mBuffer, size);
-        }
-        else
-        {
-            // Improve logging around vocache
-            LL_WARNS() << "Error loading cache entry for " << mLocalID << ", size " << size << " aborting!" << LL_ENDL;
-            delete[] mBuffer ;
-            mBuffer = NULL ;
-        }
-    }
-
-    if(!success)
-    {
-        mLocalID = 0;
-        mCRC = 0;
-        mHitCount = 0;
-        mDupeCount = 0;
-        mCRCChangeCount = 0;
-        mBuffer = NULL;
-        mEntry = NULL;
-        mState = INACTIVE;
-    }
-}
-
 LLVOCacheEntry::~LLVOCacheEntry()
 {
     mDP.freeBuffer();
@@ -275,6 +210,7 @@ void LLVOCacheEntry::updateEntry(U32 crc, LLDataPackerBinaryBuffer &dp)
     }
 
     mDP.freeBuffer();
+    mFileOffset = -1;
 
     llassert_always(dp.getBufferSize() > 0);
     mBuffer = new U8[dp.getBufferSize()];
@@ -432,27 +368,6 @@ void LLVOCacheEntry::dump() const
         << LL_ENDL;
 }
 
-S32 LLVOCacheEntry::writeToBuffer(U8 *data_buffer) const
-{
-    S32 size = mDP.getBufferSize();
-
-    if (size > MAX_ENTRY_BODY_SIZE)
-    {
-        LL_WARNS() << "Failed to write entry with size above allowed limit: " << size << LL_ENDL;
-        return 0;
-    }
-
-    memcpy(data_buffer, &mLocalID, sizeof(U32));
-    memcpy(data_buffer + sizeof(U32), &mCRC, sizeof(U32));
-    memcpy(data_buffer + (2 * sizeof(U32)), &mHitCount, sizeof(S32));
-    memcpy(data_buffer + (3 * sizeof(U32)), &mDupeCount, sizeof(S32));
-    memcpy(data_buffer + (4 * sizeof(U32)), &mCRCChangeCount, sizeof(S32));
-    memcpy(data_buffer + (5 * sizeof(U32)), &size, sizeof(S32));
-    memcpy(data_buffer + ENTRY_HEADER_SIZE, (void*)mBuffer, size);
-
-    return ENTRY_HEADER_SIZE + size;
-}
-
 #ifndef LL_TEST
 //static
 void LLVOCacheEntry::updateDebugSettings()
@@ -1158,18 +1073,369 @@ void LLVOCachePartition::removeOccluder(LLVOCacheGroup* group)
     }
     mOccludedGroups.erase(group);
 }
+//-------------------------------------------------------------------
+//LLVOCacheFile
+//-------------------------------------------------------------------
+//The file holds a header, the entry bodies, then an index of the entries
+//sorted by local id. A save appends the bodies it has no copy of after the
+//index, then writes a new index after them and the header last, so until
+//the header is written the old index still describes the file.
+//Bodies may be deflated with the object cache's dictionary, which the header names.
+static const char OBJECT_CACHE_FILE_MAGIC[8] = { 'L', 'L', 'V', 'O', 'C', 'F', '0', '2' };
+
+struct LLVOCacheFileHeader
+{
+    char mMagic[8];
+    U8   mRegionID[UUID_BYTES];
+    U32  mCount;
+    U32  mIndexOffset;
+    U32  mDictionaryID;
+};
+static const U32 OBJECT_CACHE_FILE_HEADER_SIZE = sizeof(LLVOCacheFileHeader);
+static const U32 OBJECT_CACHE_INDEX_RECORD_SIZE = 8 * sizeof(U32);
+
+LLVOCacheFile::LLVOCacheFile()
+:   mCount(0),
+    mIndexOffset(0),
+    mDictionaryID(0),
+    mCompressor(NULL)
+{
+}
+
+LLVOCacheFile::~LLVOCacheFile()
+{
+    close();
+}
+
+bool LLVOCacheFile::open(const std::string& filename, const LLUUID& id, LLCacheCompressor* compressor)
+{
+    close();
+    if(!mFile.map(filename) || mFile.size() < OBJECT_CACHE_FILE_HEADER_SIZE)
+    {
+        close();
+        return false;
+    }
+
+    LLVOCacheFileHeader header;
+    memcpy(&header, mFile.data(), OBJECT_CACHE_FILE_HEADER_SIZE);
+    if(memcmp(header.mMagic, OBJECT_CACHE_FILE_MAGIC, sizeof(header.mMagic)))
+    {
+        LL_WARNS() << "Not an object cache file: " << filename << LL_ENDL;
+        close();
+        return false;
+    }
+    if(memcmp(header.mRegionID, id.mData, UUID_BYTES))
+    {
+        LL_INFOS() << "Cache ID doesn't match for this region, discarding"<< LL_ENDL;
+        close();
+        return false;
+    }
+    if(header.mIndexOffset < OBJECT_CACHE_FILE_HEADER_SIZE
+       || (U64)header.mIndexOffset + (U64)header.mCount * OBJECT_CACHE_INDEX_RECORD_SIZE > mFile.size())
+    {
+        LL_WARNS() << "Object cache file index out of bounds: " << filename << LL_ENDL;
+        close();
+        return false;
+    }
+    if(header.mDictionaryID && (!compressor || compressor->getDictionaryID() != header.mDictionaryID))
+    {
+        LL_INFOS() << "Object cache file was compressed with another dictionary, discarding: " << filename << LL_ENDL;
+        close();
+        return false;
+    }
+    mCount = header.mCount;
+    mIndexOffset = header.mIndexOffset;
+    mDictionaryID = header.mDictionaryID;
+    mCompressor = compressor;
+
+    //the index is all that is read up front: make sure lookups can trust it.
+    IndexRecord record;
+    U32 last_id = 0;
+    for(U32 i = 0; i < mCount; i++)
+    {
+        getRecord(i, record);
+        if((i > 0 && record.mLocalID <= last_id)
+           || record.mSize < 1 || record.mSize > MAX_ENTRY_BODY_SIZE
+           || record.mRawSize < 0 || record.mRawSize > MAX_ENTRY_BODY_SIZE
+           || (record.mRawSize && !mDictionaryID)
+           || record.mOffset < OBJECT_CACHE_FILE_HEADER_SIZE
+           || (U64)record.mOffset + record.mSize > mIndexOffset)
+        {
+            LL_WARNS() << "Object cache file corruption in " << filename << ", entry " << i << LL_ENDL;
+            close();
+            return false;
+        }
+        last_id = record.mLocalID;
+    }
+    return true;
+}
+
+void LLVOCacheFile::close()
+{
+    mFile.unmap();
+    mCount = 0;
+    mIndexOffset = 0;
+    mDictionaryID = 0;
+}
+
+void LLVOCacheFile::getRecord(U32 i, IndexRecord& record) const
+{
+    static_assert(sizeof(IndexRecord) == OBJECT_CACHE_INDEX_RECORD_SIZE, "object cache index record layout changed");
+    memcpy(&record, mFile.data() + mIndexOffset + i * OBJECT_CACHE_INDEX_RECORD_SIZE, OBJECT_CACHE_INDEX_RECORD_SIZE);
+}
+
+S32 LLVOCacheFile::findRecord(U32 local_id) const
+{
+    U32 low = 0;
+    U32 high = mCount;
+    IndexRecord record;
+    while(low < high)
+    {
+        U32 mid = low + (high - low) / 2;
+        getRecord(mid, record);
+        if(record.mLocalID < local_id)
+        {
+            low = mid + 1;
+        }
+        else if(record.mLocalID > local_id)
+        {
+            high = mid;
+        }
+        else
+        {
+            return (S32)mid;
+        }
+    }
+    return -1;
+}
+
+bool LLVOCacheFile::has(U32 local_id) const
+{
+    return findRecord(local_id) >= 0;
+}
+
+LLPointer<LLVOCacheEntry> LLVOCacheFile::createEntry(U32 local_id) const
+{
+    S32 i = findRecord(local_id);
+    if(i < 0)
+    {
+        return NULL;
+    }
+    LLCacheStats::Timer timer;
+    IndexRecord record;
+    getRecord(i, record);
+
+    LLPointer<LLVOCacheEntry> entry = new LLVOCacheEntry();
+    entry->mLocalID = record.mLocalID;
+    entry->mCRC = record.mCRC;
+    entry->mHitCount = record.mHitCount;
+    entry->mDupeCount = record.mDupeCount;
+    entry->mCRCChangeCount = record.mCRCChangeCount;
+    const S32 size = record.mRawSize ? record.mRawSize : record.mSize;
+    entry->mBuffer = new U8[size];
+    entry->mDP.assignBuffer(entry->mBuffer, size);
+    if(!record.mRawSize)
+    {
+        memcpy(entry->mBuffer, mFile.data() + record.mOffset, size);
+    }
+    //bodies are small enough to inflate here, as the region asks for them.
+    else if(!mCompressor || !mCompressor->decompress(mFile.data() + record.mOffset, record.mSize, mDictionaryID, entry->mBuffer, size))
+    {
+        LL_WARNS() << "Failed to decompress object cache entry " << local_id << LL_ENDL;
+        return NULL;
+    }
+    entry->mFileOffset = (S32)record.mOffset;
+    entry->mValid = false; //not probed by the region yet.
+    LLCacheStats::read(LLCacheStats::OBJECT, size, timer.getMicros());
+    return entry;
+}
+
+bool LLVOCacheFile::write(const std::string& filename, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& entries,
+                          bool removal_enabled, LLCacheCompressor* compressor, LLVolatileAPRPool* pool)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+    //merge the entries in memory with the ones still only in the file, both sorted by local id.
+    std::vector<IndexRecord> index;
+    std::vector<const U8*> bodies; //body of each record, NULL where the file has it
+    std::vector<std::vector<U8> > compressed; //bodies deflated for this save
+    index.reserve(entries.size() + mCount);
+    bodies.reserve(entries.size() + mCount);
+    compressed.reserve(entries.size());
+    S64 kept_size = 0;
+    S64 new_size = 0;
+    U32 dictionary_id = 0; //of the compressed bodies in the new index
+
+    LLVOCacheEntry::vocache_entry_map_t::const_iterator iter = entries.begin();
+    U32 i = 0;
+    IndexRecord record;
+    while(iter != entries.end() || i < mCount)
+    {
+        if(i < mCount)
+        {
+            getRecord(i, record);
+        }
+        if(iter != entries.end() && (i >= mCount || iter->first <= record.mLocalID))
+        {
+            const bool in_file = i < mCount && iter->first == record.mLocalID;
+            if(in_file)
+            {
+                i++; //the entry in memory replaces it
+            }
+            const LLVOCacheEntry* entry = iter->second;
+            ++iter;
+            if(removal_enabled && !entry->isValid())
+            {
+                continue;
+            }
+            S32 size = entry->mDP.getBufferSize();
+            if(size < 1 || size > MAX_ENTRY_BODY_SIZE)
+            {
+                LL_WARNS() << "Failed to write entry " << entry->mLocalID << " with size " << size << " to " << filename << LL_ENDL;
+                continue;
+            }
+            record.mLocalID = entry->mLocalID;
+            record.mCRC = entry->mCRC;
+            record.mHitCount = entry->mHitCount;
+            record.mDupeCount = entry->mDupeCount;
+            record.mCRCChangeCount = entry->mCRCChangeCount;
+            if(in_file && entry->mFileOffset == (S32)record.mOffset)
+            {
+                //the body in the file, compressed or not, is still the entry's.
+                bodies.push_back(NULL);
+                kept_size += record.mSize;
+                if(record.mRawSize)
+                {
+                    dictionary_id = mDictionaryID;
+                }
+            }
+            else
+            {
+                record.mOffset = 0;
+                record.mSize = size;
+                record.mRawSize = 0;
+                std::vector<U8> body;
+                U32 body_dictionary_id = 0;
+                if(compressor && compressor->compress(entry->mBuffer, size, body, body_dictionary_id) && body_dictionary_id)
+                {
+                    record.mSize = (S32)body.size();
+                    record.mRawSize = size;
+                    dictionary_id = body_dictionary_id;
+                    compressed.push_back(std::move(body));
+                    bodies.push_back(compressed.back().data());
+                }
+                else
+                {
+                    bodies.push_back(entry->mBuffer);
+                }
+                new_size += record.mSize;
+            }
+            index.push_back(record);
+        }
+        else
+        {
+            i++;
+            if(removal_enabled)
+            {
+                continue; //not seen since the region was entered: the object may be gone.
+            }
+            index.push_back(record);
+            bodies.push_back(NULL);
+            kept_size += record.mSize;
+            if(record.mRawSize)
+            {
+                dictionary_id = mDictionaryID;
+            }
+        }
+    }
+
+    const U32 count = (U32)index.size();
+    const U32 old_end = isOpen() ? mIndexOffset + mCount * OBJECT_CACHE_INDEX_RECORD_SIZE : OBJECT_CACHE_FILE_HEADER_SIZE;
+    const S64 garbage = (S64)old_end - OBJECT_CACHE_FILE_HEADER_SIZE - kept_size;
+    //the file may also have been removed from under the mapping by a cache purge.
+    const bool rewrite = !isOpen() || garbage > kept_size + new_size || !LLFile::isfile(filename);
+
+    //everything written goes through this buffer: the bodies, then the index.
+    const U32 start = rewrite ? OBJECT_CACHE_FILE_HEADER_SIZE : old_end;
+    std::vector<U8> data;
+    data.reserve((size_t)((rewrite ? kept_size : 0) + new_size) + (size_t)count * OBJECT_CACHE_INDEX_RECORD_SIZE);
+    for(U32 j = 0; j < count; j++)
+    {
+        const U8* body = bodies[j];
+        if(!body && rewrite)
+        {
+            body = mFile.data() + index[j].mOffset;
+        }
+        if(body)
+        {
+            index[j].mOffset = start + (U32)data.size();
+            data.insert(data.end(), body, body + index[j].mSize);
+        }
+    }
+    LLVOCacheFileHeader header;
+    memcpy(header.mMagic, OBJECT_CACHE_FILE_MAGIC, sizeof(header.mMagic));
+    memcpy(header.mRegionID, id.mData, UUID_BYTES);
+    header.mCount = count;
+    header.mIndexOffset = start + (U32)data.size();
+    header.mDictionaryID = dictionary_id;
+    for(const IndexRecord& rec : index)
+    {
+        const U8* bytes = (const U8*)&rec;
+        data.insert(data.end(), bytes, bytes + OBJECT_CACHE_INDEX_RECORD_SIZE);
+    }
+    if((U64)start + data.size() > (U64)S32_MAX)
+    {
+        LL_WARNS() << "Object cache file too large: " << filename << LL_ENDL;
+        close();
+        return false;
+    }
+
+    //nothing is needed from the mapping anymore, and it shouldn't be mapped while it changes.
+    close();
+
+    bool success;
+    if(rewrite)
+    {
+        LLAPRFile apr_file(filename, APR_CREATE|APR_WRITE|APR_BINARY|APR_TRUNCATE, pool);
+        success = check_write(&apr_file, &header, OBJECT_CACHE_FILE_HEADER_SIZE)
+            && check_write(&apr_file, data.data(), (S32)data.size());
+    }
+    else
+    {
+        LLAPRFile apr_file(filename, APR_WRITE|APR_BINARY, pool);
+        success = apr_file.seek(APR_SET, (S32)start) == (S32)start
+            && check_write(&apr_file, data.data(), (S32)data.size())
+            && apr_file.seek(APR_SET, 0) == 0
+            && check_write(&apr_file, &header, OBJECT_CACHE_FILE_HEADER_SIZE);
+    }
+    if(success)
+    {
+        LLCacheStats::wrote(LLCacheStats::OBJECT, OBJECT_CACHE_FILE_HEADER_SIZE + data.size());
+    }
+    LL_DEBUGS("VOCache") << "Wrote " << count << " entries to the primary VOCache file " << filename
+                         << (rewrite ? " (rewritten)" : "") << ", " << new_size << " new body bytes. success = "
+                         << (success ? "True" : "False") << LL_ENDL;
+    return success;
+}
+
 //-------------------------------------------------------------------
 //LLVOCache
 //-------------------------------------------------------------------
 // Format strings used to construct filename for the object cache
 static const char OBJECT_CACHE_FILENAME[] = "objects_%d_%d.slc";
 static const char OBJECT_CACHE_EXTRAS_FILENAME[] = "objects_%d_%d_extras.slec";
+static const char OBJECT_CACHE_TEXTURES_FILENAME[] = "objects_%d_%d_textures.sltc";
+// bumped when the layout of the texture list file changes
+static const U32 OBJECT_CACHE_TEXTURES_VERSION = 1;
+static const U32 MAX_OBJECT_CACHE_TEXTURES = 65536;
 
 const U32 MAX_NUM_OBJECT_ENTRIES = 128 ;
 const U32 MIN_ENTRIES_TO_PURGE = 16 ;
 const U32 INVALID_TIME = 0 ;
 const char* object_cache_dirname = "objectcache";
 const char* header_filename = "object.cache";
+const char* dictionary_filename = "objects.dict";
+//entry bodies are a few hundred bytes: a bigger dictionary costs more per body to compress than it saves
+const size_t OBJECT_CACHE_DICTIONARY_SIZE = 8 * 1024;
 
 
 LLVOCache::LLVOCache(bool read_only) :
@@ -1177,10 +1443,12 @@ LLVOCache::LLVOCache(bool read_only) :
     mReadOnly(read_only),
     mNumEntries(0),
     mCacheSize(1),
-    mEnabled(true)
+    mEnabled(true),
+    mCompressor(OBJECT_CACHE_DICTIONARY_SIZE, true)
 {
 #ifndef LL_TEST
     mEnabled = gSavedSettings.getBOOL("ObjectCacheEnabled");
+    mCompressor.setEnabled(gSavedSettings.getBOOL("ObjectCacheCompression"));
 #endif
     mLocalAPRFilePoolp = new LLVolatileAPRPool() ;
 }
@@ -1221,6 +1489,7 @@ void LLVOCache::initCache(ELLPath location, U32 size, U32 cache_version)
     {
         LLFile::mkdir(mObjectCacheDirName);
     }
+    mCompressor.setDictionaryFile(gDirUtilp->getExpandedFilename(location, object_cache_dirname, dictionary_filename));
     mCacheSize = llclamp(size, MIN_ENTRIES_TO_PURGE, MAX_NUM_OBJECT_ENTRIES);
     mMetaInfo.mVersion = cache_version;
 
@@ -1292,9 +1561,19 @@ void LLVOCache::removeCache()
         return ;
     }
 
+    //unmap the files of the regions we are in first, or they can't be deleted on Windows.
+    if(LLWorld::instanceExists())
+    {
+        for(LLViewerRegion* regionp : LLWorld::instance().getRegionList())
+        {
+            regionp->closeVOCacheFile();
+        }
+    }
+
     std::string mask = "*";
     LL_INFOS() << "Removing object cache at " << mObjectCacheDirName << LL_ENDL;
     gDirUtilp->deleteFilesInDir(mObjectCacheDirName, mask);
+    mCompressor.reset(); //the dictionary file is gone with the rest
 
     clearCacheInMemory() ;
     writeCacheHeader();
@@ -1381,6 +1660,15 @@ std::string LLVOCache::getObjectCacheExtrasFilename(U64 handle)
                llformat(OBJECT_CACHE_EXTRAS_FILENAME, region_x, region_y));
 }
 
+std::string LLVOCache::getObjectCacheTexturesFilename(U64 handle)
+{
+    U32 region_x, region_y;
+
+    grid_from_region_handle(handle, &region_x, &region_y);
+    return gDirUtilp->getExpandedFilename(LL_PATH_CACHE, object_cache_dirname,
+               llformat(OBJECT_CACHE_TEXTURES_FILENAME, region_x, region_y));
+}
+
 void LLVOCache::removeFromCache(HeaderEntryInfo* entry)
 {
     if(mReadOnly)
@@ -1392,6 +1680,12 @@ void LLVOCache::removeFromCache(HeaderEntryInfo* entry)
     std::string filename;
     getObjectCacheFilename(entry->mHandle, filename);
     LL_WARNS("GLTF", "VOCache") << "Removing object cache for handle " << entry->mHandle << "Filename: " << filename << LL_ENDL;
+    //a region we are still in may have the file mapped, which keeps it from being removed on Windows.
+    LLViewerRegion* regionp = LLWorld::instanceExists() ? LLWorld::instance().getRegionFromHandle(entry->mHandle) : NULL;
+    if(regionp)
+    {
+        regionp->closeVOCacheFile();
+    }
     LLAPRFile::remove(filename, mLocalAPRFilePoolp);
 
     // Note: `removeFromCache` should take responsibility for cleaning up all cache artefacts specfic to the handle/entry.
@@ -1400,6 +1694,8 @@ void LLVOCache::removeFromCache(HeaderEntryInfo* entry)
     LL_WARNS("GLTF", "VOCache") << "Removing generic extras for handle " << entry->mHandle << "Filename: " << filename << LL_ENDL;
     LLFile::remove(filename);
 
+    LLFile::remove(getObjectCacheTexturesFilename(entry->mHandle), ENOENT);
+
     entry->mTime = INVALID_TIME ;
     updateEntry(entry) ; //update the head file.
 }
@@ -1551,7 +1847,7 @@ bool LLVOCache::updateEntry(const HeaderEntryInfo* entry)
 
 // we now return bool to trigger dirty cache
 // this in turn forces a rewrite after a partial read due to corruption.
-bool LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map)
+bool LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheFile& cache_file)
 {
 	LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
     if(!mEnabled)
@@ -1568,62 +1864,21 @@ bool LLVOCache::readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::voca
         return false; // arguably no a problem, but we'll mark this as dirty anyway.
     }
 
-    bool success = true ;
-    S32 num_entries = 0 ; // lifted out of inner loop.
-    std::string filename; // lifted out of loop
-    {
-		LL_PROFILE_ZONE_NAMED_CATEGORY_NETWORK("VOCache:loadRegionObjectCache");        
-        LLUUID cache_id;
-        getObjectCacheFilename(handle, filename);
-        LLAPRFile apr_file(filename, APR_READ|APR_BINARY, mLocalAPRFilePoolp);
-
-        success = check_read(&apr_file, cache_id.mData, UUID_BYTES);
-
-        if(success)
-        {
-            LL_PROFILE_ZONE_NAMED_CATEGORY_NETWORK("VOCache:loadCacheForRegion");
-            if(cache_id != id)
-            {
-                LL_INFOS() << "Cache ID doesn't match for this region, discarding"<< LL_ENDL;
-                success = false ;
-            }
-
-            if(success)
-            {
-                success = check_read(&apr_file, &num_entries, sizeof(S32)) ;
-
-                if(success)
-                {
-                    for (S32 i = 0; i < num_entries && apr_file.eof() != APR_EOF; i++)
-                    {
-                        LLPointer<LLVOCacheEntry> entry = new LLVOCacheEntry(&apr_file);
-                        if (!entry->getLocalID())
-                        {
-                            LL_WARNS() << "Aborting cache file load for " << filename << ", cache file corruption!" << LL_ENDL;
-                            success = false ;
-                            break ;
-                        }
-                        cache_entry_map[entry->getLocalID()] = entry;
-                    }
-                }
-            }
-        }
-    }
-
+    // only the index is looked at here, entries are read when the region asks for them.
+    std::string filename;
+    getObjectCacheFilename(handle, filename);
+    bool success = cache_file.open(filename, id, &mCompressor);
     if(!success)
     {
-        if(cache_entry_map.empty())
-        {
-            removeEntry(iter->second) ;
-        }
+        removeEntry(iter->second) ;
     }
 
-    LL_DEBUGS("GLTF", "VOCache") << "Read " << cache_entry_map.size() << " entries from object cache " << filename << ", expected " << num_entries << ", success=" << (success?"True":"False") << LL_ENDL;
+    LL_DEBUGS("GLTF", "VOCache") << "Mapped " << cache_file.size() << " entries from object cache " << filename << ", success=" << (success?"True":"False") << LL_ENDL;
     return success;
 }
 
-// We now pass in the cache entry map, so that we can remove entries from extras that are no longer in the primary cache.
-void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map)
+// We now pass in the primary cache file, so that we can remove entries from extras that are no longer in it.
+void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLVOCacheFile& cache_file)
 {
 	LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
     int loaded= 0;
@@ -1745,7 +2000,7 @@ void LLVOCache::readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCac
         U32 local_id = entry_llsd["local_id"].asInteger();
         // only add entries that exist in the primary cache
         // this is a self-healing test that avoids us polluting the cache with entries that are no longer valid based on the main cache.
-        if(cache_entry_map.find(local_id)!= cache_entry_map.end())
+        if(cache_file.has(local_id))
         {
             // attempt to backfill a null objectId, though these shouldn't be in the persisted cache really
             if(entry.mObjectId.isNull() && pRegion)
@@ -1775,11 +2030,12 @@ void LLVOCache::purgeEntries(U32 size)
         mHeaderEntryQueue.erase(iter) ;
         removeFromCache(entry) ; // This now handles removing extras cache where appropriate.
         delete entry;
+        LLCacheStats::evicted(LLCacheStats::OBJECT);
     }
     mNumEntries = static_cast<U32>(mHandleEntryMap.size());
 }
 
-void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, bool dirty_cache, bool removal_enabled)
+void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, LLVOCacheFile& cache_file, bool dirty_cache, bool removal_enabled)
 {
 	LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
     std::string filename;
@@ -1839,70 +2095,7 @@ void LLVOCache::writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry:
     }
 
     //write to cache file
-    bool success = true ;
-    {
-        std::string filename;
-        getObjectCacheFilename(handle, filename);
-        LLAPRFile apr_file(filename, APR_CREATE|APR_WRITE|APR_BINARY|APR_TRUNCATE, mLocalAPRFilePoolp);
-
-        success = check_write(&apr_file, (void*)id.mData, UUID_BYTES);
-
-        if(success)
-        {
-            S32 num_entries = static_cast<S32>(cache_entry_map.size()); // if removal is enabled num_entries might be wrong
-            success = check_write(&apr_file, &num_entries, sizeof(S32));
-            if (success)
-            {
-                const S32 buffer_size = 32768; //should be large enough for couple MAX_ENTRY_BODY_SIZE
-                U8 data_buffer[buffer_size]; // generaly entries are fairly small, so collect them and drop onto disk in one go
-                S32 size_in_buffer = 0;
-
-                // This can have a lot of entries, so might be better to dump them into buffer first and write in one go.
-                for (LLVOCacheEntry::vocache_entry_map_t::const_iterator iter = cache_entry_map.begin(); success && iter != cache_entry_map.end(); ++iter)
-                {
-                    if (!removal_enabled || iter->second->isValid())
-                    {
-                        S32 size = iter->second->writeToBuffer(data_buffer + size_in_buffer);
-
-                        if (size > ENTRY_HEADER_SIZE) // body is minimum of 1
-                        {
-                            size_in_buffer += size;
-                        }
-                        else
-                        {
-                            LL_WARNS() << "Failed to write cache entry to buffer for " << filename << ", entry number " << iter->second->getLocalID() << LL_ENDL;
-                            success = false;
-                            break;
-                        }
-
-                        // Make sure we have space in buffer for next element
-                        if (buffer_size - size_in_buffer < MAX_ENTRY_BODY_SIZE + ENTRY_HEADER_SIZE)
-                        {
-                            success = check_write(&apr_file, (void*)data_buffer, size_in_buffer);
-                            size_in_buffer = 0;
-                            if (!success)
-                            {
-                                LL_WARNS() << "Failed to write cache to disk " << filename << LL_ENDL;
-                                break;
-                            }
-                        }
-                    }
-                }
-
-                if (success && size_in_buffer > 0)
-                {
-                    // final write
-                    success = check_write(&apr_file, (void*)data_buffer, size_in_buffer);
-                    if(!success)
-                    {
-                        LL_WARNS() << "Failed to write cache entry to disk " << filename << LL_ENDL;
-                    }
-                    size_in_buffer = 0;
-                }
-                LL_DEBUGS("VOCache") << "Wrote " << num_entries << " entries to the primary VOCache file " << filename << ". success = " << (success ? "True":"False") << LL_ENDL;
-            }
-        }
-    }
+    bool success = cache_file.write(filename, id, cache_entry_map, removal_enabled, &mCompressor, mLocalAPRFilePoolp);
 
     if(!success)
     {
@@ -1934,6 +2127,69 @@ void LLVOCache::removeGenericExtrasForHandle(U64 handle)
     }
 }
 
+void LLVOCache::writeTexturesToCache(U64 handle, const uuid_vec_t& texture_ids)
+{
+    LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
+    if(!mEnabled || mReadOnly)
+    {
+        return;
+    }
+    llassert_always(mInitialized);
+
+    if(mHandleEntryMap.find(handle) == mHandleEntryMap.end())
+    {
+        return; // only kept for regions with an object cache
+    }
+
+    std::string filename = getObjectCacheTexturesFilename(handle);
+    const U32 header[2] = { OBJECT_CACHE_TEXTURES_VERSION, (U32)llmin(texture_ids.size(), (size_t)MAX_OBJECT_CACHE_TEXTURES) };
+    llofstream out(filename, std::ios::out | std::ios::binary);
+    out.write((const char*)header, sizeof(header));
+    if (header[1])
+    {
+        out.write((const char*)texture_ids.data(), header[1] * sizeof(LLUUID));
+    }
+    if(!out.good())
+    {
+        LL_WARNS() << "Failed writing texture list for handle " << handle << LL_ENDL;
+        out.close();
+        LLFile::remove(filename);
+    }
+}
+
+bool LLVOCache::getCacheFilenames(U64 handle, std::string& objects_filename, std::string& textures_filename)
+{
+    if(!mEnabled || !mInitialized || mHandleEntryMap.find(handle) == mHandleEntryMap.end())
+    {
+        return false;
+    }
+
+    getObjectCacheFilename(handle, objects_filename);
+    textures_filename = getObjectCacheTexturesFilename(handle);
+    return true;
+}
+
+//static
+bool LLVOCache::readTexturesFromFile(const std::string& filename, uuid_vec_t& texture_ids)
+{
+    llifstream in(filename, std::ios::in | std::ios::binary);
+    U32 header[2];
+    if(!in.read((char*)header, sizeof(header))
+       || header[0] != OBJECT_CACHE_TEXTURES_VERSION
+       || header[1] > MAX_OBJECT_CACHE_TEXTURES)
+    {
+        return false;
+    }
+
+    texture_ids.resize(header[1]);
+    if(header[1] && !in.read((char*)texture_ids.data(), header[1] * sizeof(LLUUID)))
+    {
+        texture_ids.clear();
+        return false;
+    }
+    return true;
+}
+
 void LLVOCache::writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, bool dirty_cache, bool removal_enabled)
 {
 	LL_PROFILE_ZONE_SCOPED_CATEGORY_NETWORK;
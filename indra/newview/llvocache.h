@@ -33,12 +33,15 @@
 #include "llvieweroctree.h"
 #include "llapr.h"
 #include "llgltfmaterial.h"
+#include "llmappedfile.h"
+#include "llcachecompressor.h"
 
 #include <unordered_map>
 
 //---------------------------------------------------------------------------
 // Cache entries
 class LLCamera;
+class LLVOCacheFile;
 
 class LLGLTFOverrideCacheEntry
 {
@@ -59,6 +62,7 @@ class LLVOCacheEntry
 :   public LLViewerOctreeEntryData
 {
     LL_ALIGN_NEW
+    friend class LLVOCacheFile;
 public:
     enum
     {
@@ -109,7 +113,6 @@ protected:
     ~LLVOCacheEntry();
 public:
     LLVOCacheEntry(U32 local_id, U32 crc, LLDataPackerBinaryBuffer &dp);
-    LLVOCacheEntry(LLAPRFile* apr_file);
     LLVOCacheEntry();
 
     void updateEntry(U32 crc, LLDataPackerBinaryBuffer &dp);
@@ -132,7 +135,6 @@ public:
     F32 getSceneContribution() const             { return mSceneContrib;}
 
     void dump() const;
-    S32 writeToBuffer(U8 *data_buffer) const;
     LLDataPackerBinaryBuffer *getDP();
     void recordHit();
     void recordDupe() { mDupeCount++; }
@@ -183,6 +185,7 @@ protected:
     S32                         mCRCChangeCount;
     LLDataPackerBinaryBuffer    mDP;
     U8                          *mBuffer;
+    S32                         mFileOffset; //where mBuffer is in the region's cache file, -1 if it isn't there.
 
     F32                         mSceneContrib; //projected scene contributuion of this object.
     U32                         mState; //high 16 bits reserved for special use.
@@ -201,6 +204,60 @@ public:
     static F32                  sRearPixelThreshold;
 };
 
+//
+//A region's object cache file, mapped. Entries are kept sorted by local id
+//and are only read out of the file when the region first asks for them, so
+//connecting to a region costs no more than mapping its file.
+//The mapping is dropped before the file is rewritten, and the cache closes
+//it before deleting the file, after which the region's unread entries are
+//simply cache misses.
+//
+class LLVOCacheFile
+{
+public:
+    LLVOCacheFile();
+    ~LLVOCacheFile();
+
+    //map filename, if it is a valid cache file for region id. Compressed bodies are inflated with compressor.
+    bool open(const std::string& filename, const LLUUID& id, LLCacheCompressor* compressor);
+    void close();
+    bool isOpen() const { return mFile.isMapped(); }
+
+    U32  size() const { return mCount; }
+    bool has(U32 local_id) const;
+    //a new entry read from the file, or NULL if local_id isn't in it.
+    LLPointer<LLVOCacheEntry> createEntry(U32 local_id) const;
+
+    //save entries, plus the entries of the file nobody asked for unless removal_enabled.
+    //Entry bodies already in the file stay where they are: only new ones and the index are
+    //written, unless the file is more than half garbage, when it is rewritten whole.
+    //New bodies are stored compressed when compressor will. Closes the file.
+    bool write(const std::string& filename, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& entries,
+               bool removal_enabled, LLCacheCompressor* compressor, LLVolatileAPRPool* pool);
+
+private:
+    struct IndexRecord
+    {
+        U32 mLocalID;
+        U32 mCRC;
+        S32 mHitCount;
+        S32 mDupeCount;
+        S32 mCRCChangeCount;
+        S32 mSize;     //in the file
+        S32 mRawSize;  //once inflated, 0 if the body is stored as is
+        U32 mOffset;
+    };
+
+    void getRecord(U32 i, IndexRecord& record) const;
+    S32  findRecord(U32 local_id) const;
+
+    LLMappedFile mFile;
+    U32          mCount;
+    U32          mIndexOffset;
+    U32          mDictionaryID; //of the compressed bodies
+    LLCacheCompressor* mCompressor;
+};
+
 class LLVOCacheGroup : public LLOcclusionCullingGroup
 {
 public:
@@ -292,14 +349,25 @@ public:
     void initCache(ELLPath location, U32 size, U32 cache_version);
     void removeCache(ELLPath location, bool started = false) ;
 
-    bool readFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_entry_map_t& cache_entry_map) ;
-    void readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map);
+    bool readFromCache(U64 handle, const LLUUID& id, LLVOCacheFile& cache_file) ;
+    void readGenericExtrasFromCache(U64 handle, const LLUUID& id, LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, const LLVOCacheFile& cache_file);
 
-    void writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, bool dirty_cache, bool removal_enabled);
+    void writeToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_entry_map_t& cache_entry_map, LLVOCacheFile& cache_file, bool dirty_cache, bool removal_enabled);
     void writeGenericExtrasToCache(U64 handle, const LLUUID& id, const LLVOCacheEntry::vocache_gltf_overrides_map_t& cache_extras_entry_map, bool dirty_cache, bool removal_enabled);
     void removeEntry(U64 handle) ;
     void removeGenericExtrasForHandle(U64 handle);
 
+    // Textures seen in the region, most important first, kept alongside its
+    // object cache so a teleport there can warm the texture cache.
+    void writeTexturesToCache(U64 handle, const uuid_vec_t& texture_ids);
+    // Names of the object cache and texture list files for the region, false
+    // if nothing is cached for it.
+    bool getCacheFilenames(U64 handle, std::string& objects_filename, std::string& textures_filename);
+    // Read a file named by getCacheFilenames(); safe on any thread.
+    static bool readTexturesFromFile(const std::string& filename, uuid_vec_t& texture_ids);
+
+    LLCacheCompressor::Stats getCompressionStats() const { return mCompressor.getStats(); }
+
     U32 getCacheEntries() { return mNumEntries; }
     U32 getCacheEntriesMax() { return mCacheSize; }
 
@@ -308,6 +376,7 @@ private:
     // determine the cache filename for the region from the region handle
     void getObjectCacheFilename(U64 handle, std::string& filename);
     std::string getObjectCacheExtrasFilename(U64 handle);
+    std::string getObjectCacheTexturesFilename(U64 handle);
     void removeFromCache(HeaderEntryInfo* entry);
     void readCacheHeader();
     void writeCacheHeader();
@@ -329,6 +398,7 @@ private:
     LLVolatileAPRPool*   mLocalAPRFilePoolp ;
     header_entry_queue_t mHeaderEntryQueue;
     handle_entry_map_t   mHandleEntryMap;
+    LLCacheCompressor    mCompressor; //for entry bodies, with a dictionary trained on them
 };
 
 #endif
@@ -10119,7 +10119,7 @@ void LLPipeline::renderShadow(const glm::mat4& view, const glm::mat4& proj, LLCa
     LLPipeline::sShadowRender = false;
 }
 
-bool LLPipeline::getVisiblePointCloud(LLCamera& camera, LLVector3& min, LLVector3& max, std::vector<LLVector3>& fp, LLVector3 light_dir)
+bool LLPipeline::getVisiblePointCloud(LLCamera& camera, LLVector3& min, LLVector3& max, LLFrameVector<LLVector3>& fp, LLVector3 light_dir)
 {
     LL_PROFILE_ZONE_SCOPED_CATEGORY_PIPELINE;
     //get point cloud of intersection of frust and min, max
@@ -10139,7 +10139,7 @@ bool LLPipeline::getVisiblePointCloud(LLCamera& camera, LLVector3& min, LLVector
         LLPlane(max, LLVector3(0,0,1))};
 
     //potential points
-    std::vector<LLVector3> pp;
+    LLFrameVector<LLVector3> pp;
 
     //add corners of AABB
     pp.push_back(LLVector3(min.mV[0], min.mV[1], min.mV[2]));
@@ -10490,7 +10490,7 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
     F32 near_clip = 0.f;
     {
         //get visible point cloud
-        std::vector<LLVector3> fp;
+        LLFrameVector<LLVector3> fp;
 
         main_camera.calcAgentFrustumPlanes(main_camera.mAgentFrustum);
 
@@ -10630,7 +10630,7 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
                 mShadowCamera[j] = shadow_cam;
             }
 
-            std::vector<LLVector3> fp;
+            LLFrameVector<LLVector3> fp;
 
             if (!gPipeline.getVisiblePointCloud(shadow_cam, min, max, fp, lightDir)
                 || j > RenderShadowSplits)
@@ -10660,7 +10660,7 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
             {
                 mShadowExtents[j][0] = min;
                 mShadowExtents[j][1] = max;
-                mShadowFrustPoints[j] = fp;
+                mShadowFrustPoints[j].assign(fp.begin(), fp.end());
             }
 
 
@@ -10670,7 +10670,7 @@ void LLPipeline::generateSunShadow(LLCamera& camera)
             //get a temporary view projection
             view[j] = look(camera.getOrigin(), lightDir, -up);
 
-            std::vector<LLVector3> wpf;
+            LLFrameVector<LLVector3> wpf;
 
             for (U32 i = 0; i < fp.size(); i++)
             {
@@ -29,6 +29,7 @@
 
 #include "llcamera.h"
 #include "llerror.h"
+#include "llframearena.h"
 #include "lldrawpool.h"
 #include "llspatialpartition.h"
 #include "m4math.h"
@@ -261,7 +262,7 @@ public:
     void updateMove();
     bool visibleObjectsInFrustum(LLCamera& camera);
     bool getVisibleExtents(LLCamera& camera, LLVector3 &min, LLVector3& max);
-    bool getVisiblePointCloud(LLCamera& camera, LLVector3 &min, LLVector3& max, std::vector<LLVector3>& fp, LLVector3 light_dir = LLVector3(0,0,0));
+    bool getVisiblePointCloud(LLCamera& camera, LLVector3 &min, LLVector3& max, LLFrameVector<LLVector3>& fp, LLVector3 light_dir = LLVector3(0,0,0));
 
     // Populate given LLCullResult with results of a frustum cull of the entire scene against the given LLCamera
     void updateCull(LLCamera& camera, LLCullResult& result, bool hud_attachments = false);
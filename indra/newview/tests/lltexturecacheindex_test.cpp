@@ -0,0 +1,241 @@
+/**
+ * @file   lltexturecacheindex_test.cpp
+ * @date   2026-10-18
+ * @brief  Test for lltexturecacheindex.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "../lltexturecacheindex.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "lltut.h"
+#include "llfile.h"
+#include "stringize.h"
+
+namespace tut
+{
+    struct lltexturecacheindex_data
+    {
+        lltexturecacheindex_data()
+        {
+            static S32 sTests = 0;
+            mFileName = stringize(LLFile::tmpdir(), "lltexturecacheindex_test_", ++sTests, ".index");
+            LLFile::remove(mFileName, ENOENT);
+        }
+        ~lltexturecacheindex_data()
+        {
+            LLFile::remove(mFileName, ENOENT);
+            LLFile::remove(mFileName + ".copy", ENOENT);
+        }
+
+        static LLUUID makeID(S32 n)
+        {
+            return LLUUID::generateNewID(stringize("texture", n));
+        }
+
+        std::string mFileName;
+    };
+    typedef test_group<lltexturecacheindex_data> lltexturecacheindex_group;
+    typedef lltexturecacheindex_group::object object;
+    lltexturecacheindex_group lltexturecacheindexgrp("lltexturecacheindex");
+
+    template<> template<>
+    void object::test<1>()
+    {
+        set_test_name("insert, update, remove, reopen");
+        const LLUUID a(makeID(1)), b(makeID(2));
+        LLTextureCacheIndex::Entry entry;
+        S32 idx_a, idx_b;
+        {
+            LLTextureCacheIndex index;
+            ensure_equals("create", index.open(mFileName, 1000, "v1", false),
+                          LLTextureCacheIndex::OPEN_CREATED);
+            ensure_equals("missing", index.find(a), -1);
+            idx_a = index.insert(a, 5000, 2000, 10, entry);
+            ensure("insert a", idx_a >= 0);
+            ensure_equals("insert again", index.insert(a, 1, 0, 11, entry), idx_a);
+            ensure_equals("existing entry kept", entry.mImageSize, 5000);
+            idx_b = index.insert(b, 800, 0, 12, entry);
+            ensure("insert b", idx_b >= 0 && idx_b != idx_a);
+            ensure("update", index.update(idx_a, a, 6000, 3000, 13));
+            ensure_not("update wrong id", index.update(idx_a, b, 1, 1, 1));
+            index.touch(idx_b, b, 20);
+            ensure_equals("lookup", index.lookup(b, entry), idx_b);
+            ensure_equals("touched", entry.mTime, 20);
+            ensure_equals("size", index.size(), 2);
+            ensure_equals("body bytes", index.getBodyBytes(), 3000);
+        }
+        {
+            LLTextureCacheIndex index;
+            ensure_equals("reopen", index.open(mFileName, 1000, "v1", false),
+                          LLTextureCacheIndex::OPEN_EXISTING);
+            ensure_equals("size kept", index.size(), 2);
+            ensure_equals("body bytes kept", index.getBodyBytes(), 3000);
+            ensure_equals("lookup a", index.lookup(a, entry), idx_a);
+            ensure_equals("image size", entry.mImageSize, 6000);
+            ensure_equals("body size", entry.mBodySize, 3000);
+            LLTextureCacheIndex::Entry removed;
+            ensure("remove", index.remove(idx_a, a, &removed));
+            ensure_equals("removed body", removed.mBodySize, 3000);
+            ensure_not("remove twice", index.remove(idx_a, a));
+            ensure_equals("gone", index.find(a), -1);
+            ensure_equals("b still there", index.find(b), idx_b);
+            ensure_equals("body bytes after remove", index.getBodyBytes(), 0);
+        }
+        {
+            LLTextureCacheIndex index;
+            ensure_equals("read only", index.open(mFileName, 1000, "v1", true),
+                          LLTextureCacheIndex::OPEN_EXISTING);
+            ensure_equals("read only lookup", index.find(b), idx_b);
+            ensure_equals("read only insert", index.insert(a, 1, 0, 1, entry), -1);
+        }
+        LLTextureCacheIndex index;
+        ensure_equals("other version", index.open(mFileName, 1000, "v2", false),
+                      LLTextureCacheIndex::OPEN_CREATED);
+        ensure_equals("other version is empty", index.size(), 0);
+        index.close();
+        ensure_equals("other capacity", index.open(mFileName, 2000, "v2", false),
+                      LLTextureCacheIndex::OPEN_CREATED);
+    }
+
+    template<> template<>
+    void object::test<2>()
+    {
+        set_test_name("eviction, compaction and recount after a crash");
+        LLTextureCacheIndex index;
+        ensure_equals("create", index.open(mFileName, 256, "v1", false),
+                      LLTextureCacheIndex::OPEN_CREATED);
+        LLTextureCacheIndex::Entry entry;
+        for (S32 i = 0; i < 192; ++i)
+        {
+            ensure(stringize("insert ", i), index.insert(makeID(i), 2000, 1000, 100 + i, entry) >= 0);
+        }
+        // the table refuses to fill up past 7/8
+        S32 i = 192;
+        while (index.insert(makeID(i), 2000, 1000, 100 + i, entry) >= 0)
+        {
+            ++i;
+        }
+        ensure_equals("load limit", index.size(), 224);
+
+        LLTextureCacheIndex::Entry evicted;
+        for (S32 n = 0; n < 64; ++n)
+        {
+            ensure("evict", index.evict(evicted));
+            ensure_equals("evicted gone", index.find(evicted.mID), -1);
+        }
+        ensure_equals("size after evict", index.size(), 160);
+        ensure_equals("tombstones", index.getTombstones(), 64);
+        LLTextureCacheIndex::slot_entry_vector_t entries;
+        index.getEntries(entries);
+        ensure_equals("entries", entries.size(), 160);
+        for (const auto& slot_entry : entries)
+        {
+            ensure_equals("still found", index.find(slot_entry.second.mID), slot_entry.first);
+        }
+
+        // while open the file is marked dirty: a copy looks like a crash
+        {
+            llifstream in(mFileName.c_str(), std::ios::binary);
+            llofstream out((mFileName + ".copy").c_str(), std::ios::binary);
+            out << in.rdbuf();
+        }
+        {
+            LLTextureCacheIndex crashed;
+            ensure_equals("open copy", crashed.open(mFileName + ".copy", 256, "v1", false),
+                          LLTextureCacheIndex::OPEN_EXISTING);
+            ensure_equals("recounted size", crashed.size(), 160);
+            ensure_equals("recounted body bytes", crashed.getBodyBytes(), 160 * 1000);
+            ensure_equals("recounted tombstones", crashed.getTombstones(), 64);
+        }
+
+        for (const auto& slot_entry : entries)
+        {
+            ensure("remove", index.remove(slot_entry.first, slot_entry.second.mID));
+        }
+        ensure_equals("tombstones", index.getTombstones(), 224);
+        index.compact();
+        ensure_equals("compacted", index.getTombstones(), 0);
+        ensure_equals("empty", index.size(), 0);
+        ensure("insert after compact", index.insert(makeID(1), 2000, 1000, 1, entry) >= 0);
+    }
+
+    template<> template<>
+    void object::test<3>()
+    {
+        set_test_name("concurrent writers and readers");
+        LLTextureCacheIndex index;
+        ensure_equals("create", index.open(mFileName, 8192, "v1", false),
+                      LLTextureCacheIndex::OPEN_CREATED);
+        const S32 threads = 8, per_thread = 500;
+        std::atomic<S32> bad{ 0 };
+        std::vector<std::thread> workers;
+        for (S32 t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&index, &bad, t]()
+                {
+                    LLTextureCacheIndex::Entry entry;
+                    for (S32 i = 0; i < per_thread; ++i)
+                    {
+                        const LLUUID id(makeID(t * per_thread + i));
+                        const S32 idx = index.insert(id, 4000, 1000, i, entry);
+                        // readers never see an entry half written
+                        if (idx < 0 || !index.update(idx, id, 4000 + i, 2000, i))
+                        {
+                            ++bad;
+                        }
+                        index.touch(idx, id, i + 1);
+                        const LLUUID other(makeID(((t + 1) % threads) * per_thread + i));
+                        if (index.lookup(other, entry) >= 0
+                            && entry.mImageSize <= entry.mBodySize)
+                        {
+                            ++bad;
+                        }
+                        if (i % 2 && !index.remove(idx, id))
+                        {
+                            ++bad;
+                        }
+                    }
+                });
+        }
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+        ensure_equals("failures", bad.load(), 0);
+        ensure_equals("size", index.size(), threads * per_thread / 2);
+        ensure_equals("body bytes", index.getBodyBytes(), (S64)threads * per_thread / 2 * 2000);
+        for (S32 t = 0; t < threads; ++t)
+        {
+            for (S32 i = 0; i < per_thread; ++i)
+            {
+                ensure_equals("present", index.find(makeID(t * per_thread + i)) >= 0, i % 2 == 0);
+            }
+        }
+    }
+} // namespace tut
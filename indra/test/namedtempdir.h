@@ -0,0 +1,48 @@
+/**
+ * @file   namedtempdir.h
+ * @author Nat Goodspeed
+ * @date   2011-12-19
+ * @brief  NamedTempDir class for tests that need a scratch directory.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Copyright (c) 2011, Linden Research, Inc.
+ * $/LicenseInfo$
+ */
+
+#if ! defined(LL_NAMEDTEMPDIR_H)
+#define LL_NAMEDTEMPDIR_H
+
+#include "namedtempfile.h"
+#include <boost/filesystem.hpp>
+#include <boost/noncopyable.hpp>
+#include <string>
+#include <string_view>
+
+/// Create a temporary directory and clean it up later.
+class NamedTempDir: public boost::noncopyable
+{
+public:
+    NamedTempDir(const std::string_view& pfx=""):
+        mPath(NamedTempFile::temp_path(pfx)),
+        mCreated(boost::filesystem::create_directories(mPath))
+    {
+        mPath = boost::filesystem::canonical(mPath);
+    }
+
+    ~NamedTempDir()
+    {
+        if (mCreated)
+        {
+            boost::system::error_code ec;
+            boost::filesystem::remove_all(mPath, ec);
+        }
+    }
+
+    std::string getName() const { return mPath.string(); }
+
+private:
+    boost::filesystem::path mPath;
+    bool mCreated;
+};
+
+#endif /* ! defined(LL_NAMEDTEMPDIR_H) */